@@ -9,6 +9,9 @@
  
     The program takes as input a compressed indexed mesh and outputs it as a
     indexed mesh in binary PLY format.
+
+    With '-stream' the mesh is decompressed a batch at a time (and is not
+    written anywhere) to show how few vertices need to be kept in memory.
   
   PROGRAMMERS:
   
@@ -24,6 +27,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- added '-stream' option for streaming decompression
     14 March 2004 -- created
   
 ===============================================================================
@@ -39,6 +43,7 @@ void usage()
   fprintf(stderr,"usage:\n");
   fprintf(stderr,"decompress -i mesh_compressed.ply -o mesh.ply\n");
   fprintf(stderr,"decompress -i mesh_compressed_12bit.ply\n");
+  fprintf(stderr,"decompress -stream -i mesh_compressed.ply\n");
   fprintf(stderr,"decompress -h\n");
   exit(1);
 }
@@ -48,6 +53,7 @@ int main(int argc, char *argv[])
   int i;
   char* file_name_in = 0;
   char* file_name_out = 0;
+  bool stream = false;
 
   for (i = 1; i < argc; i++)
   {
@@ -61,17 +67,72 @@ int main(int argc, char *argv[])
       i++;
       file_name_out = argv[i];
     }
+    else if (strcmp(argv[i],"-stream") == 0)
+    {
+      stream = true;
+    }
     else
     {
       usage();
     }
   }
 
-  if (file_name_in == 0)
+  if (file_name_in == 0 || (stream && file_name_out))
   {
     usage();
   }
 
+  if (stream)
+  {
+    FILE* file = fopen(file_name_in, "rb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n", file_name_in);
+      exit(1);
+    }
+
+    miStreamDecoder* mistream = new miStreamDecoder();
+    if (!mistream->open(file))
+    {
+      fprintf(stderr,"ERROR: failed to open micodec from %s\n", file_name_in);
+      exit(1);
+    }
+
+    miBatch batch;
+    batch.max_verts = 4096;
+    batch.vertices = (float*)malloc(sizeof(float)*3*batch.max_verts);
+    batch.max_faces = 4096;
+    batch.faces = (int*)malloc(sizeof(int)*3*batch.max_faces);
+    batch.final = (bool*)malloc(sizeof(bool)*3*batch.max_faces);
+
+    // count the vertices that are in use (e.g. not yet finalized)
+
+    int in_use = 0;
+    int max_in_use = 0;
+    while (mistream->next_batch(&batch))
+    {
+      in_use += batch.nverts;
+      if (in_use > max_in_use) max_in_use = in_use;
+      for (i = 0; i < 3*batch.nfaces; i++)
+      {
+        if (batch.final[i]) in_use--;
+      }
+    }
+
+    if (mistream->v_count != mistream->nverts || mistream->f_count != mistream->nfaces)
+    {
+      fprintf(stderr,"ERROR: failed to decompress mesh\n");
+      exit(1);
+    }
+
+    fprintf(stderr,"decompressed %d vertices and %d triangles with at most %d vertices in use\n", mistream->v_count, mistream->f_count, max_in_use);
+
+    mistream->close();
+    delete mistream;
+    fclose(file);
+    return 1;
+  }
+
   miCodec* micodec = loadCodec(file_name_in);
 
   if (micodec == 0)
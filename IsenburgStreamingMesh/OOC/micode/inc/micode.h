@@ -2,41 +2,66 @@
 ===============================================================================
 
   FILE:  micode.h
-  
+
   CONTENTS:
-  
+
     a library for compression and decompression of - optionally non-manifold -
     indexed triangles meshes
-  
+
+    the mesh is sorted along the longest side of its bounding box and cut into
+    chunks of about MI_CHUNK_FACES triangles that are compressed independently
+    (and in parallel) with the streaming compressor of SMwriter_smc. within a
+    chunk the triangles are put into a stream order that walks across the
+    surface, unless their own order compresses better. vertices that are
+    shared by several chunks are stored in each of them. all chunks use the
+    same bounding box so that these copies quantize identically.
+
+    the decompressed mesh has the same triangles, but the vertices (and the
+    triangles) are in the order that they were compressed in. vertices that
+    are not used by any triangle and triangles that use the same vertex twice
+    are not compressed.
+
+    a miStreamDecoder decompresses the codec a batch at a time into buffers
+    of the caller. it only holds one chunk, the vertices of that chunk that
+    are still used, and a table of the vertices that several chunks share.
+    its memory is bounded by the width of the stream, not the mesh size.
+
   PROGRAMMERS:
-  
+
     martin isenburg@cs.unc.edu
-  
+
   COPYRIGHT:
-  
+
     copyright (C) 2001-2004  martin isenburg@cs.unc.edu
-    
+
     This software is distributed for evaluation purposes only
     WITHOUT ANY WARRANTY; without even the implied warranty
     of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
-  
+
   CHANGE HISTORY:
-  
+
+    19 October 2026 -- miStreamDecoder for streaming decompression
+    19 October 2026 -- open-source implementation on top of SMwriter_smc that
+                       leaves the mesh untouched and uses several threads
     12 March 2004 -- created
-  
+
 ===============================================================================
 */
 #ifndef MICODE_H
 #define MICODE_H
 
+#include <stdio.h>
+
+#define MI_CHUNK_FACES 262144
+
 // for handing over mesh
 
 typedef struct miMesh
 {
   int nverts;
-  float* vertices;  // for efficieny the compressor uses (e.g. corrupts) this array
+  float* vertices;  // the compressor does not modify this array
   int nfaces;
-  int* faces;       // for efficieny the compressor uses (e.g. corrupts) this array
+  int* faces;       // the compressor does not modify this array
 } miMesh;
 
 // for handing over codec
@@ -52,19 +77,68 @@ typedef struct miCodec
   unsigned char* bytes;
 } miCodec;
 
-// core functionality
+// core functionality. with threads=0 there is one thread per processor.
 
-miCodec* compress(miMesh* mimesh, int bits=16, const float* bb_min=0, const float* bb_max=0);
+miCodec* compress(const miMesh* mimesh, int bits=16, const float* bb_min=0, const float* bb_max=0, int threads=0);
 
-miMesh* decompress(miCodec* codec);
+miMesh* decompress(const miCodec* micodec, int threads=0);
+
+// streaming decompression. the caller provides the buffers of a batch and
+// next_batch() fills them with the next vertices and triangles. vertices
+// come before the first triangle that uses them and get consecutive indices
+// (the same as in the mesh of decompress()). a triangle corner is 'final'
+// when no later triangle uses its vertex. a stream decoder uses the SMC
+// decoder of the thread that calls it, so each thread can only stream one
+// codec at a time.
+
+typedef struct miBatch
+{
+  int max_verts;     // the size of the vertices buffer (in vertices)
+  float* vertices;
+  int max_faces;     // the size of the faces and final buffers (in triangles)
+  int* faces;
+  bool* final;       // optional. 3 flags per triangle
+  int first_vertex;  // the index of the first vertex in this batch
+  int nverts;
+  int nfaces;
+} miBatch;
+
+struct miStreamState;
+
+class miStreamDecoder
+{
+public:
+  int nverts;
+  int nfaces;
+  int bits;
+  float bb_min[3];
+  float bb_max[3];
+
+  int v_count;
+  int f_count;
+
+  bool open(const miCodec* micodec);    // the codec must stay around until close()
+  bool open(FILE* file);                // a codec file written by saveCodec()
+  bool next_batch(miBatch* batch);      // false once all is decoded (or on error)
+  void close();
+
+  miStreamDecoder();
+  ~miStreamDecoder();
+
+private:
+  miStreamState* state;
+};
 
 // helpful utilities
 
 miMesh* loadMesh(const char* file_name);
-int saveMesh(miMesh* mimesh, const char* file_name);
+int saveMesh(const miMesh* mimesh, const char* file_name);
 
 miCodec* loadCodec(const char* file_name);
-int saveCodec(miCodec* micodec, const char* file_name);
+int saveCodec(const miCodec* micodec, const char* file_name);
+
+void deleteMesh(miMesh* mimesh);
+void deleteCodec(miCodec* micodec);
 
 // allows you to check how quantization affects your data. if no explicit bounding box info
 // is provided (e.g. bb_min & bb_max) a bounding box is computed from the vertices array.
@@ -0,0 +1,73 @@
+/*
+===============================================================================
+
+  FILE:  SMreader_micode.h
+
+  CONTENTS:
+
+    Reads a mesh that was compressed with micode as a Streaming Mesh. This
+    way everything that takes an SMreader can consume micode codecs without
+    ever holding the entire mesh in memory.
+
+    the vertices come in the order of the decompressed mesh of decompress()
+    (e.g. v_idx is the index there) and are finalized once the last triangle
+    that uses them was read.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed for evaluation purposes only
+    WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created on top of miStreamDecoder
+
+===============================================================================
+*/
+#ifndef SMREADER_MICODE_H
+#define SMREADER_MICODE_H
+
+#include "smreader.h"
+#include "micode.h"
+
+#define SM_MICODE_BATCH 1024
+
+class SMreader_micode : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  // smreader_micode functions
+
+  bool open(const miCodec* micodec);  // the codec must stay around until close()
+  bool open(FILE* file);              // a codec file written by saveCodec()
+
+  SMreader_micode();
+  ~SMreader_micode();
+
+private:
+  miStreamDecoder* decoder;
+  miBatch batch;
+  int next_vertex;
+  int next_face;
+  int have_finalized, next_finalized;
+  int finalized_vertices[3];
+
+  bool start();
+  bool next();
+};
+
+#endif
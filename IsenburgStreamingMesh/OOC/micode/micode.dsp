@@ -0,0 +1,208 @@
+# Microsoft Developer Studio Project File - Name="micode" - Package Owner=<4>
+# Microsoft Developer Studio Generated Build File, Format Version 6.00
+# ** DO NOT EDIT **
+
+# TARGTYPE "Win32 (x86) Static Library" 0x0104
+
+CFG=micode - Win32 Debug
+!MESSAGE This is not a valid makefile. To build this project using NMAKE,
+!MESSAGE use the Export Makefile command and run
+!MESSAGE 
+!MESSAGE NMAKE /f "micode.mak".
+!MESSAGE 
+!MESSAGE You can specify a configuration when running NMAKE
+!MESSAGE by defining the macro CFG on the command line. For example:
+!MESSAGE 
+!MESSAGE NMAKE /f "micode.mak" CFG="micode - Win32 Debug"
+!MESSAGE 
+!MESSAGE Possible choices for configuration are:
+!MESSAGE 
+!MESSAGE "micode - Win32 Release" (based on "Win32 (x86) Static Library")
+!MESSAGE "micode - Win32 Debug" (based on "Win32 (x86) Static Library")
+!MESSAGE 
+
+# Begin Project
+# PROP AllowPerConfigDependencies 0
+# PROP Scc_ProjName ""
+# PROP Scc_LocalPath ""
+CPP=cl.exe
+RSC=rc.exe
+
+!IF  "$(CFG)" == "micode - Win32 Release"
+
+# PROP BASE Use_MFC 0
+# PROP BASE Use_Debug_Libraries 0
+# PROP BASE Output_Dir "Release"
+# PROP BASE Intermediate_Dir "Release"
+# PROP BASE Target_Dir ""
+# PROP Use_MFC 0
+# PROP Use_Debug_Libraries 0
+# PROP Output_Dir "Release"
+# PROP Intermediate_Dir "Release"
+# PROP Target_Dir ""
+# ADD BASE CPP /nologo /W3 /GX /O2 /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
+# ADD CPP /nologo /MT /W3 /GX /O2 /I "inc" /I "..\psreader_dist\inc" /I "..\psreader_dist\src" /I "..\psreader_dist\stl" /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
+# ADD BASE RSC /l 0x409 /d "NDEBUG"
+# ADD RSC /l 0x409 /d "NDEBUG"
+BSC32=bscmake.exe
+# ADD BASE BSC32 /nologo
+# ADD BSC32 /nologo
+LIB32=link.exe -lib
+# ADD BASE LIB32 /nologo
+# ADD LIB32 /nologo
+# Begin Special Build Tool
+SOURCE="$(InputPath)"
+PostBuild_Cmds=copy Release\micode.lib lib\micode.lib
+# End Special Build Tool
+
+!ELSEIF  "$(CFG)" == "micode - Win32 Debug"
+
+# PROP BASE Use_MFC 0
+# PROP BASE Use_Debug_Libraries 1
+# PROP BASE Output_Dir "Debug"
+# PROP BASE Intermediate_Dir "Debug"
+# PROP BASE Target_Dir ""
+# PROP Use_MFC 0
+# PROP Use_Debug_Libraries 1
+# PROP Output_Dir "Debug"
+# PROP Intermediate_Dir "Debug"
+# PROP Target_Dir ""
+# ADD BASE CPP /nologo /W3 /Gm /GX /ZI /Od /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
+# ADD CPP /nologo /MTd /W3 /Gm /GX /ZI /Od /I "inc" /I "..\psreader_dist\inc" /I "..\psreader_dist\src" /I "..\psreader_dist\stl" /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
+# ADD BASE RSC /l 0x409 /d "_DEBUG"
+# ADD RSC /l 0x409 /d "_DEBUG"
+BSC32=bscmake.exe
+# ADD BASE BSC32 /nologo
+# ADD BSC32 /nologo
+LIB32=link.exe -lib
+# ADD BASE LIB32 /nologo
+# ADD LIB32 /nologo
+# Begin Special Build Tool
+SOURCE="$(InputPath)"
+PostBuild_Cmds=copy Debug\micode.lib lib\micode.lib
+# End Special Build Tool
+
+!ENDIF 
+
+# Begin Target
+
+# Name "micode - Win32 Release"
+# Name "micode - Win32 Debug"
+# Begin Group "Source Files"
+
+# PROP Default_Filter "cpp;c;cxx;rc;def;r;odl;idl;hpj;bat"
+# Begin Source File
+
+SOURCE=.\src\micode.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smreader_micode.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\floatcompressor.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\integercompressor_new.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\ply.c
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\rangedecoder.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\rangeencoder.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\rangemodel.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\smreader_ply.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\smreader_smc.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\smstats.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\smtrace.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\smwriter_smc.cpp
+# End Source File
+# End Group
+# Begin Group "Header Files"
+
+# PROP Default_Filter "h;hpp;hxx;hm;inl"
+# Begin Source File
+
+SOURCE=.\inc\micode.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smreader_micode.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\floatcompressor.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\integercompressor_new.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\poolallocator.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\positionquantizer_new.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\rangedecoder.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\rangeencoder.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\src\rangemodel.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\inc\smreader_ply.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\inc\smreader_smc.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\inc\smstats.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\inc\smtrace.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\psreader_dist\inc\smwriter_smc.h
+# End Source File
+# End Group
+# End Target
+# End Project
@@ -0,0 +1,1905 @@
+/*
+===============================================================================
+
+  FILE:  micode.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed for evaluation purposes only
+    WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "micode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "smreader_ply.h"
+#include "smreader_smc.h"
+#include "smwriter_smc.h"
+
+#include "rangeencoder.h"
+#include "rangedecoder.h"
+#include "positionquantizer_new.h"
+
+#include "vec3fv.h"
+#include "vec3iv.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#endif
+
+#define MI_VERSION 1
+#define MI_MAX_THREADS 64
+
+#ifdef _WIN32
+typedef hash_map<int, int> my_index_hash;
+#else
+typedef hash_map<int, int, __gnu_cxx::hash<int>, std::equal_to<int>, PoolAllocator<int> > my_index_hash;
+#endif
+
+// the worker threads stay around between calls. this way the (per thread)
+// free lists of the pool allocator get reused instead of being lost with
+// every thread that exits.
+
+typedef void (*miJob)(void* data, int i);
+
+static bool workers_init = false;
+static int workers_number = 0;
+
+static miJob job = 0;
+static void* job_data = 0;
+static int jobs_number = 0;
+static int jobs_next = 0;
+
+#ifdef _WIN32
+static volatile LONG run_lock = 0;
+static CRITICAL_SECTION jobs_lock;
+static HANDLE work_sem;
+static HANDLE done_sem;
+
+static void lock_run() { while (InterlockedExchange(&run_lock, 1)) Sleep(0); }
+static void unlock_run() { InterlockedExchange(&run_lock, 0); }
+static void lock_jobs() { EnterCriticalSection(&jobs_lock); }
+static void unlock_jobs() { LeaveCriticalSection(&jobs_lock); }
+static void post_work() { ReleaseSemaphore(work_sem, 1, 0); }
+static void wait_work() { WaitForSingleObject(work_sem, INFINITE); }
+static void post_done() { ReleaseSemaphore(done_sem, 1, 0); }
+static void wait_done() { WaitForSingleObject(done_sem, INFINITE); }
+
+static void init_workers()
+{
+  InitializeCriticalSection(&jobs_lock);
+  work_sem = CreateSemaphore(0, 0, MI_MAX_THREADS, 0);
+  done_sem = CreateSemaphore(0, 0, MI_MAX_THREADS, 0);
+}
+
+static int number_of_processors()
+{
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors;
+}
+#else
+static pthread_mutex_t run_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static sem_t work_sem;
+static sem_t done_sem;
+
+static void lock_run() { pthread_mutex_lock(&run_lock); }
+static void unlock_run() { pthread_mutex_unlock(&run_lock); }
+static void lock_jobs() { pthread_mutex_lock(&jobs_lock); }
+static void unlock_jobs() { pthread_mutex_unlock(&jobs_lock); }
+static void post_work() { sem_post(&work_sem); }
+static void wait_work() { while (sem_wait(&work_sem)) ; }
+static void post_done() { sem_post(&done_sem); }
+static void wait_done() { while (sem_wait(&done_sem)) ; }
+
+static void init_workers()
+{
+  sem_init(&work_sem, 0, 0);
+  sem_init(&done_sem, 0, 0);
+}
+
+static int number_of_processors()
+{
+  return (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+#endif
+
+static void work()
+{
+  int i;
+  while (true)
+  {
+    lock_jobs();
+    i = jobs_next++;
+    unlock_jobs();
+    if (i >= jobs_number)
+    {
+      break;
+    }
+    job(job_data, i);
+  }
+}
+
+#ifdef _WIN32
+static unsigned __stdcall worker(void* arg)
+#else
+static void* worker(void* arg)
+#endif
+{
+  while (true)
+  {
+    wait_work();
+    work();
+    post_done();
+  }
+  return 0;
+}
+
+static bool start_worker()
+{
+#ifdef _WIN32
+  HANDLE thread = (HANDLE)_beginthreadex(0, 0, worker, 0, 0, 0);
+  if (thread == 0)
+  {
+    return false;
+  }
+  CloseHandle(thread);
+#else
+  pthread_t thread;
+  if (pthread_create(&thread, 0, worker, 0))
+  {
+    return false;
+  }
+  pthread_detach(thread);
+#endif
+  return true;
+}
+
+// calls func(data, i) for i = 0 ... njobs-1 with (at most) nthreads threads
+
+static void run(miJob func, void* data, int njobs, int nthreads)
+{
+  int i, nworkers;
+
+  if (nthreads <= 0)
+  {
+    nthreads = number_of_processors();
+  }
+  if (nthreads > njobs)
+  {
+    nthreads = njobs;
+  }
+  if (nthreads > MI_MAX_THREADS)
+  {
+    nthreads = MI_MAX_THREADS;
+  }
+
+  // the calling thread works too
+  nworkers = nthreads - 1;
+
+  if (nworkers <= 0)
+  {
+    for (i = 0; i < njobs; i++)
+    {
+      func(data, i);
+    }
+    return;
+  }
+
+  lock_run();
+
+  if (!workers_init)
+  {
+    init_workers();
+    workers_init = true;
+  }
+  while (workers_number < nworkers && start_worker())
+  {
+    workers_number++;
+  }
+  if (nworkers > workers_number)
+  {
+    nworkers = workers_number;
+  }
+
+  job = func;
+  job_data = data;
+  jobs_number = njobs;
+  jobs_next = 0;
+
+  for (i = 0; i < nworkers; i++)
+  {
+    post_work();
+  }
+  work();
+  for (i = 0; i < nworkers; i++)
+  {
+    wait_done();
+  }
+
+  unlock_run();
+}
+
+// the codec bytes start with a table of contents that is stored in
+// little-endian order so that it reads the same on all platforms
+
+static void put_int(unsigned char* bytes, int i)
+{
+  bytes[0] = (unsigned char)(i & 255);
+  bytes[1] = (unsigned char)((i >> 8) & 255);
+  bytes[2] = (unsigned char)((i >> 16) & 255);
+  bytes[3] = (unsigned char)((i >> 24) & 255);
+}
+
+static int get_int(const unsigned char* bytes)
+{
+  return (int)((unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24));
+}
+
+static bool put_float(FILE* file, float f)
+{
+  unsigned char bytes[4];
+  int i;
+  memcpy(&i, &f, 4);
+  put_int(bytes, i);
+  return (fwrite(bytes, 1, 4, file) == 4);
+}
+
+static bool get_float(FILE* file, float* f)
+{
+  unsigned char bytes[4];
+  int i;
+  if (fread(bytes, 1, 4, file) != 4)
+  {
+    return false;
+  }
+  i = get_int(bytes);
+  memcpy(f, &i, 4);
+  return true;
+}
+
+static void compute_bounding_box(int nverts, const float* vertices, float* bb_min, float* bb_max)
+{
+  VecCopy3fv(bb_min, vertices);
+  VecCopy3fv(bb_max, vertices);
+  for (int i = 1; i < nverts; i++)
+  {
+    VecUpdateMinMax3fv(bb_min, bb_max, &(vertices[3*i]));
+  }
+}
+
+// compression
+
+typedef struct miChunk
+{
+  int nverts;                // number of vertices used by the chunk
+  int nfaces;
+  int nseams;                // number of vertices already in an earlier chunk
+  int* vertices;             // the mesh vertex of each chunk vertex (in the order written)
+  int* index_map;            // the index the decoder will give to each chunk vertex
+  int nbytes;
+  unsigned char* bytes;      // the chunk as SMC
+  int seam_nbytes;
+  unsigned char* seam_bytes; // for each seam vertex its chunk index and its index in the mesh
+} miChunk;
+
+typedef struct miCompressor
+{
+  const miMesh* mimesh;
+  const int* order;          // the triangles sorted along the longest side of the bounding box
+  const int* first;          // where in the order each chunk starts
+  int bits;
+  float bb_min[3];
+  float bb_max[3];
+  miChunk* chunks;
+} miCompressor;
+
+// puts the triangles of a chunk into stream order with a traversal like
+// that of Edgebreaker: from each triangle it goes on to the one across the
+// right edge and remembers the one across the left edge for when it gets
+// stuck. the traversal spirals around the first triangle, so the vertices
+// are finalized one turn after they are first used, and almost every next
+// triangle shares an edge with the previous one, which is what the little
+// cache of SMC hits best. 'corners' has the vertices of the triangles
+// numbered from 0 to nverts-1 and 'sorted' gets the new order.
+
+// the triangle that is not done and shares edge e of triangle t. the gate
+// of that triangle is the index of this edge in it.
+
+static int across_edge(const int* corners, const int* around_start, const int* around, const bool* done, int t, int e, int* gate)
+{
+  int i, f, j;
+  int a = corners[3*t+e];
+  int b = corners[3*t+(e+1)%3];
+  for (i = around_start[a]; i < around_start[a+1]; i++)
+  {
+    f = around[i];
+    if (done[f]) continue;
+    for (j = 0; j < 3; j++)
+    {
+      if ((corners[3*f+j] == b && corners[3*f+(j+1)%3] == a) || (corners[3*f+j] == a && corners[3*f+(j+1)%3] == b))
+      {
+        *gate = j;
+        return f;
+      }
+    }
+  }
+  return -1;
+}
+
+static void stream_order(int nfaces, int nverts, const int* corners, int* sorted)
+{
+  int i, v, k, t, gate, right, right_gate, left, left_gate, start;
+
+  // the triangles around each vertex
+
+  int* around_start = (int*)malloc(sizeof(int)*(nverts+1));
+  int* around = (int*)malloc(sizeof(int)*3*nfaces);
+  memset(around_start, 0, sizeof(int)*(nverts+1));
+  for (i = 0; i < 3*nfaces; i++)
+  {
+    around_start[corners[i]+1]++;
+  }
+  for (v = 0; v < nverts; v++)
+  {
+    around_start[v+1] += around_start[v];
+  }
+  for (i = 0; i < 3*nfaces; i++)
+  {
+    around[around_start[corners[i]]++] = i/3;
+  }
+  for (v = nverts; v > 0; v--)
+  {
+    around_start[v] = around_start[v-1];
+  }
+  around_start[0] = 0;
+
+  bool* done = (bool*)malloc(sizeof(bool)*nfaces);
+  memset(done, 0, sizeof(bool)*nfaces);
+
+  // the triangles across left edges with their gates
+
+  int* stack = (int*)malloc(sizeof(int)*2*nfaces);
+  int stack_size = 0;
+
+  k = 0;
+  t = -1;
+  gate = 0;
+  start = 0;
+  while (k < nfaces)
+  {
+    if (t == -1)
+    {
+      while (stack_size)
+      {
+        stack_size -= 2;
+        if (!done[stack[stack_size]])
+        {
+          t = stack[stack_size];
+          gate = stack[stack_size+1];
+          break;
+        }
+      }
+      if (t == -1)
+      {
+        // start a new component with the next triangle not yet in the order
+        while (done[start]) start++;
+        t = start;
+        gate = 0;
+      }
+    }
+    done[t] = true;
+    sorted[k++] = t;
+    right = across_edge(corners, around_start, around, done, t, (gate+1)%3, &right_gate);
+    left = across_edge(corners, around_start, around, done, t, (gate+2)%3, &left_gate);
+    if (right != -1)
+    {
+      if (left != -1)
+      {
+        stack[stack_size++] = left;
+        stack[stack_size++] = left_gate;
+      }
+      t = right;
+      gate = right_gate;
+    }
+    else if (left != -1)
+    {
+      t = left;
+      gate = left_gate;
+    }
+    else
+    {
+      t = -1;
+    }
+  }
+
+  free(around_start);
+  free(around);
+  free(done);
+  free(stack);
+}
+
+// the width of the front of a stream order is the largest number of
+// vertices that are used but not yet finalized. an order whose front is
+// wider than that of stream_order() is not worth trying.
+
+static int front_width(int nfaces, int nverts, const int* corners, const int* sorted, int* last)
+{
+  int f, i, idx, front, width;
+  for (i = 0; i < nverts; i++)
+  {
+    last[i] = -1;
+  }
+  for (f = 0; f < nfaces; f++)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      last[corners[3*sorted[f]+i]] = f;
+    }
+  }
+  front = 0;
+  width = 0;
+  for (f = 0; f < nfaces; f++)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      idx = corners[3*sorted[f]+i];
+      if (last[idx] >= 0)
+      {
+        last[idx] = -2 - last[idx];
+        front++;
+      }
+    }
+    if (front > width) width = front;
+    for (i = 0; i < 3; i++)
+    {
+      idx = corners[3*sorted[f]+i];
+      if (last[idx] == -2 - f)
+      {
+        last[idx] = -1;
+        front--;
+      }
+    }
+  }
+  return width;
+}
+
+// writes the triangles of a chunk in the given order as SMC into 'bytes'.
+// the vertices are written when they are first used and get finalized with
+// the last triangle that uses them. 'vertices' gets the mesh vertex of each
+// written vertex and 'index_map' the index the decoder will give it.
+
+static void encode_chunk(const miCompressor* compressor, int nfaces, int nverts, const int* corners, const int* mesh_index, const int* sorted, int* vertices, int* index_map, unsigned char** bytes, int* nbytes)
+{
+  int f, i, idx, written;
+  bool t_final[3];
+  SMidx t_idx[3];
+
+  int* renumber = (int*)malloc(sizeof(int)*nverts);
+  int* last = (int*)malloc(sizeof(int)*nverts);
+
+  for (i = 0; i < nverts; i++)
+  {
+    renumber[i] = -1;
+  }
+  for (f = 0; f < nfaces; f++)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      last[corners[3*sorted[f]+i]] = f;
+    }
+  }
+
+  // all chunks use the same bounding box so that shared vertices quantize the same
+
+  SMwriter_smc* smwriter = new SMwriter_smc();
+  smwriter->open(bytes, nbytes, compressor->bits);
+  smwriter->set_boundingbox(compressor->bb_min, compressor->bb_max);
+  smwriter->set_nverts(nverts);
+  smwriter->set_nfaces(nfaces);
+  smwriter->set_index_map(index_map);
+
+  written = 0;
+  for (f = 0; f < nfaces; f++)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      idx = corners[3*sorted[f]+i];
+      if (renumber[idx] == -1)
+      {
+        renumber[idx] = written;
+        vertices[written] = mesh_index[idx];
+        smwriter->write_vertex(&(compressor->mimesh->vertices[3*mesh_index[idx]]));
+        written++;
+      }
+      t_idx[i] = renumber[idx];
+      t_final[i] = (last[idx] == f);
+    }
+    smwriter->write_triangle(t_idx, t_final);
+  }
+
+  smwriter->close();
+  delete smwriter;
+
+  free(renumber);
+  free(last);
+}
+
+static void compress_chunk(void* data, int c)
+{
+  miCompressor* compressor = (miCompressor*)data;
+  miChunk* chunk = &(compressor->chunks[c]);
+  const int* order = &(compressor->order[compressor->first[c]]);
+  const int* faces = compressor->mimesh->faces;
+  int nfaces = compressor->first[c+1] - compressor->first[c];
+  int f, i, idx;
+
+  int* corners = (int*)malloc(sizeof(int)*3*nfaces);
+  int* mesh_index = (int*)malloc(sizeof(int)*3*nfaces);
+
+  // give the vertices chunk indices
+
+  my_index_hash* index_hash = new my_index_hash;
+  my_index_hash::iterator hash_element;
+
+  chunk->nverts = 0;
+  for (f = 0; f < nfaces; f++)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      idx = faces[3*order[f]+i];
+      hash_element = index_hash->find(idx);
+      if (hash_element == index_hash->end())
+      {
+        index_hash->insert(my_index_hash::value_type(idx, chunk->nverts));
+        mesh_index[chunk->nverts] = idx;
+        corners[3*f+i] = chunk->nverts;
+        chunk->nverts++;
+      }
+      else
+      {
+        corners[3*f+i] = (*hash_element).second;
+      }
+    }
+  }
+
+  delete index_hash;
+
+  chunk->nfaces = nfaces;
+  chunk->vertices = (int*)malloc(sizeof(int)*chunk->nverts);
+  chunk->index_map = (int*)malloc(sizeof(int)*chunk->nverts);
+
+  // write the triangles in stream order
+
+  int* sorted = (int*)malloc(sizeof(int)*nfaces);
+  int* last = (int*)malloc(sizeof(int)*chunk->nverts);
+
+  stream_order(nfaces, chunk->nverts, corners, sorted);
+  encode_chunk(compressor, nfaces, chunk->nverts, corners, mesh_index, sorted, chunk->vertices, chunk->index_map, &(chunk->bytes), &(chunk->nbytes));
+  int width = front_width(nfaces, chunk->nverts, corners, sorted, last);
+
+  // the order the triangles have may be a stream order already (e.g. the
+  // rows of a grid). if its front is narrower it is tried as well and kept
+  // when it compresses better.
+
+  for (f = 0; f < nfaces; f++)
+  {
+    sorted[f] = f;
+  }
+  if (front_width(nfaces, chunk->nverts, corners, sorted, last) < width)
+  {
+    int* vertices = (int*)malloc(sizeof(int)*chunk->nverts);
+    int* index_map = (int*)malloc(sizeof(int)*chunk->nverts);
+    unsigned char* bytes;
+    int nbytes;
+    encode_chunk(compressor, nfaces, chunk->nverts, corners, mesh_index, sorted, vertices, index_map, &bytes, &nbytes);
+    if (nbytes < chunk->nbytes)
+    {
+      free(chunk->vertices);
+      free(chunk->index_map);
+      free(chunk->bytes);
+      chunk->vertices = vertices;
+      chunk->index_map = index_map;
+      chunk->bytes = bytes;
+      chunk->nbytes = nbytes;
+    }
+    else
+    {
+      free(vertices);
+      free(index_map);
+      free(bytes);
+    }
+  }
+
+  free(sorted);
+  free(last);
+  free(corners);
+  free(mesh_index);
+}
+
+miCodec* compress(const miMesh* mimesh, int bits, const float* bb_min, const float* bb_max, int threads)
+{
+  int i, c, f, axis, nbuckets, ncoded, nchunks;
+
+  if (mimesh == 0 || mimesh->nverts <= 0 || mimesh->vertices == 0 || mimesh->nfaces < 0 || (mimesh->nfaces && mimesh->faces == 0))
+  {
+    fprintf(stderr,"ERROR: no mesh to compress\n");
+    return 0;
+  }
+  if (bits < 1 || bits > 24)
+  {
+    fprintf(stderr,"ERROR: %d bits are not supported. use 1 to 24\n", bits);
+    return 0;
+  }
+  for (i = 0; i < 3*mimesh->nfaces; i++)
+  {
+    if (mimesh->faces[i] < 0 || mimesh->faces[i] >= mimesh->nverts)
+    {
+      fprintf(stderr,"ERROR: triangle %d uses vertex %d but there are only %d vertices\n", i/3, mimesh->faces[i], mimesh->nverts);
+      return 0;
+    }
+  }
+
+  miCompressor compressor;
+  compressor.mimesh = mimesh;
+  compressor.bits = bits;
+
+  if (bb_min && bb_max)
+  {
+    VecCopy3fv(compressor.bb_min, bb_min);
+    VecCopy3fv(compressor.bb_max, bb_max);
+  }
+  else
+  {
+    compute_bounding_box(mimesh->nverts, mimesh->vertices, compressor.bb_min, compressor.bb_max);
+  }
+
+  // sort the triangles along the longest side of the bounding box with a
+  // bucket sort
+
+  axis = 0;
+  if (compressor.bb_max[1]-compressor.bb_min[1] > compressor.bb_max[axis]-compressor.bb_min[axis]) axis = 1;
+  if (compressor.bb_max[2]-compressor.bb_min[2] > compressor.bb_max[axis]-compressor.bb_min[axis]) axis = 2;
+
+  nbuckets = mimesh->nfaces/4 + 1;
+  double scale = (compressor.bb_max[axis] > compressor.bb_min[axis] ? nbuckets / (3.0*((double)compressor.bb_max[axis] - (double)compressor.bb_min[axis])) : 0.0);
+
+  int* bucket = (int*)malloc(sizeof(int)*(mimesh->nfaces+1));
+  int* bucket_start = (int*)malloc(sizeof(int)*(nbuckets+1));
+  int* order = (int*)malloc(sizeof(int)*(mimesh->nfaces+1));
+
+  if (bucket == 0 || bucket_start == 0 || order == 0)
+  {
+    fprintf(stderr,"ERROR: malloc for sorting %d triangles failed\n", mimesh->nfaces);
+    free(bucket);
+    free(bucket_start);
+    free(order);
+    return 0;
+  }
+
+  memset(bucket_start, 0, sizeof(int)*(nbuckets+1));
+
+  ncoded = 0;
+  for (f = 0; f < mimesh->nfaces; f++)
+  {
+    const int* t_idx = &(mimesh->faces[3*f]);
+    if (t_idx[0] == t_idx[1] || t_idx[1] == t_idx[2] || t_idx[2] == t_idx[0])
+    {
+      bucket[f] = -1;
+      continue;
+    }
+    double key = (double)mimesh->vertices[3*t_idx[0]+axis] + (double)mimesh->vertices[3*t_idx[1]+axis] + (double)mimesh->vertices[3*t_idx[2]+axis] - 3.0*compressor.bb_min[axis];
+    i = (int)(scale * key);
+    if (i < 0) i = 0;
+    else if (i >= nbuckets) i = nbuckets-1;
+    bucket[f] = i;
+    bucket_start[i+1]++;
+    ncoded++;
+  }
+
+  if (ncoded < mimesh->nfaces)
+  {
+    fprintf(stderr,"WARNING: skipping %d degenerate triangles\n", mimesh->nfaces - ncoded);
+  }
+
+  for (i = 0; i < nbuckets; i++)
+  {
+    bucket_start[i+1] += bucket_start[i];
+  }
+  for (f = 0; f < mimesh->nfaces; f++)
+  {
+    if (bucket[f] != -1)
+    {
+      order[bucket_start[bucket[f]]++] = f;
+    }
+  }
+
+  // cut the sorted triangles into chunks of about the same size
+
+  nchunks = (ncoded + MI_CHUNK_FACES - 1) / MI_CHUNK_FACES;
+
+  int* first = (int*)malloc(sizeof(int)*(nchunks+1));
+  first[0] = 0;
+  for (c = 1; c <= nchunks; c++)
+  {
+    first[c] = c*(ncoded/nchunks) + (c < ncoded%nchunks ? c : ncoded%nchunks);
+  }
+
+  // within a chunk the triangles keep the order they have in the mesh
+  // until compress_chunk() puts them into stream order.
+
+  for (c = 0; c < nchunks; c++)
+  {
+    for (i = first[c]; i < first[c+1]; i++)
+    {
+      bucket[order[i]] = c;
+    }
+    bucket_start[c] = first[c];
+  }
+  for (f = 0; f < mimesh->nfaces; f++)
+  {
+    if (bucket[f] != -1)
+    {
+      order[bucket_start[bucket[f]]++] = f;
+    }
+  }
+
+  free(bucket);
+  free(bucket_start);
+
+  compressor.order = order;
+  compressor.first = first;
+  compressor.chunks = (miChunk*)malloc(sizeof(miChunk)*(nchunks ? nchunks : 1));
+
+  run(compress_chunk, &compressor, nchunks, threads);
+
+  free(order);
+  free(first);
+
+  // now that the order of the decoder is known the vertices get their index
+  // in the decompressed mesh. the copies of a vertex in later chunks become
+  // seam vertices that refer to that index.
+
+  int* global_index = (int*)malloc(sizeof(int)*mimesh->nverts);
+  for (i = 0; i < mimesh->nverts; i++)
+  {
+    global_index[i] = -1;
+  }
+
+  int nglobal = 0;
+  int nbytes = 2*4 + nchunks*5*4;
+
+  for (c = 0; c < nchunks; c++)
+  {
+    miChunk* chunk = &(compressor.chunks[c]);
+    int* decoded = (int*)malloc(sizeof(int)*chunk->nverts);
+    int nglobal_before = nglobal;
+    int last = 0;
+
+    for (i = 0; i < chunk->nverts; i++)
+    {
+      decoded[chunk->index_map[i]] = chunk->vertices[i];
+    }
+
+    RangeEncoder* re_seam = new RangeEncoder(0);
+
+    chunk->nseams = 0;
+    for (i = 0; i < chunk->nverts; i++)
+    {
+      if (global_index[decoded[i]] == -1)
+      {
+        global_index[decoded[i]] = nglobal;
+        nglobal++;
+      }
+      else
+      {
+        re_seam->encode(chunk->nverts - last, i - last);
+        re_seam->encode(nglobal_before, global_index[decoded[i]]);
+        last = i + 1;
+        chunk->nseams++;
+      }
+    }
+
+    re_seam->done();
+
+    if (chunk->nseams)
+    {
+      chunk->seam_nbytes = re_seam->getNumberChars();
+      chunk->seam_bytes = (unsigned char*)malloc(sizeof(unsigned char)*chunk->seam_nbytes);
+      memcpy(chunk->seam_bytes, re_seam->getChars(), chunk->seam_nbytes);
+    }
+    else
+    {
+      chunk->seam_nbytes = 0;
+      chunk->seam_bytes = 0;
+    }
+
+    delete re_seam;
+
+    free(decoded);
+    free(chunk->vertices);
+    free(chunk->index_map);
+
+    nbytes += chunk->nbytes + chunk->seam_nbytes;
+  }
+
+  free(global_index);
+
+  // put together the codec
+
+  miCodec* micodec = (miCodec*)malloc(sizeof(miCodec));
+  micodec->nverts = nglobal;
+  micodec->nfaces = ncoded;
+  micodec->bits = bits;
+  VecCopy3fv(micodec->bb_min, compressor.bb_min);
+  VecCopy3fv(micodec->bb_max, compressor.bb_max);
+  micodec->nbytes = nbytes;
+  micodec->bytes = (unsigned char*)malloc(sizeof(unsigned char)*nbytes);
+
+  unsigned char* bytes = micodec->bytes;
+  put_int(bytes, MI_VERSION); bytes += 4;
+  put_int(bytes, nchunks); bytes += 4;
+  for (c = 0; c < nchunks; c++)
+  {
+    miChunk* chunk = &(compressor.chunks[c]);
+    put_int(bytes, chunk->nverts); bytes += 4;
+    put_int(bytes, chunk->nfaces); bytes += 4;
+    put_int(bytes, chunk->nseams); bytes += 4;
+    put_int(bytes, chunk->nbytes); bytes += 4;
+    put_int(bytes, chunk->seam_nbytes); bytes += 4;
+  }
+  for (c = 0; c < nchunks; c++)
+  {
+    miChunk* chunk = &(compressor.chunks[c]);
+    memcpy(bytes, chunk->bytes, chunk->nbytes);
+    bytes += chunk->nbytes;
+    if (chunk->seam_nbytes)
+    {
+      memcpy(bytes, chunk->seam_bytes, chunk->seam_nbytes);
+      bytes += chunk->seam_nbytes;
+    }
+    free(chunk->bytes);
+    free(chunk->seam_bytes);
+  }
+
+  free(compressor.chunks);
+
+  return micodec;
+}
+
+// decompression
+
+typedef struct miChunkDecoder
+{
+  int nverts;
+  int nfaces;
+  int nseams;
+  int nbytes;
+  const unsigned char* bytes;
+  int seam_nbytes;
+  const unsigned char* seam_bytes;
+  int vertex_offset;         // index of the first vertex that is new in this chunk
+  int face_offset;
+  int offset;                // where the chunk starts (after the table of contents)
+} miChunkDecoder;
+
+// checks the version in the first 8 bytes of a codec and returns its number of chunks
+
+static int get_nchunks(const unsigned char* bytes, int nbytes)
+{
+  if (get_int(bytes) != MI_VERSION)
+  {
+    fprintf(stderr,"ERROR: codec has version %d but decompressor wants %d\n", get_int(bytes), MI_VERSION);
+    return -1;
+  }
+  int nchunks = get_int(bytes+4);
+  if (nchunks < 0 || nchunks > (nbytes - 8) / 20)
+  {
+    fprintf(stderr,"ERROR: codec is corrupt\n");
+    return -1;
+  }
+  return nchunks;
+}
+
+// reads the table of contents of a codec that has 'nbytes' bytes after it
+
+static bool read_table_of_contents(const unsigned char* toc, int nchunks, int nbytes, miChunkDecoder* chunks, int* nverts, int* nfaces)
+{
+  int c, offset;
+
+  *nverts = 0;
+  *nfaces = 0;
+  offset = 0;
+  for (c = 0; c < nchunks; c++)
+  {
+    miChunkDecoder* chunk = &(chunks[c]);
+    chunk->nverts = get_int(toc);
+    chunk->nfaces = get_int(toc+4);
+    chunk->nseams = get_int(toc+8);
+    chunk->nbytes = get_int(toc+12);
+    chunk->seam_nbytes = get_int(toc+16);
+    toc += 20;
+    chunk->vertex_offset = *nverts;
+    chunk->face_offset = *nfaces;
+    chunk->offset = offset;
+    if (chunk->nverts < 0 || chunk->nfaces < 0 || chunk->nseams < 0 || chunk->nseams > chunk->nverts || (c == 0 && chunk->nseams) || chunk->nbytes < 2 || chunk->seam_nbytes < 0 || chunk->nbytes > nbytes - offset || chunk->seam_nbytes > nbytes - offset - chunk->nbytes)
+    {
+      fprintf(stderr,"ERROR: chunk %d of codec is corrupt\n", c);
+      return false;
+    }
+    offset += chunk->nbytes + chunk->seam_nbytes;
+    *nverts += chunk->nverts - chunk->nseams;
+    *nfaces += chunk->nfaces;
+  }
+  return true;
+}
+
+// the seam table of a chunk lists in increasing order those of its vertices
+// that are already in an earlier chunk together with their index there
+
+typedef struct miSeams
+{
+  RangeDecoder* rd;
+  int nverts;
+  int vertex_offset;
+  int left;
+  int idx;                   // the next seam vertex of the chunk (or -1)
+  int global;                // and its index in the mesh
+} miSeams;
+
+static void next_seam(miSeams* seams)
+{
+  if (seams->left)
+  {
+    seams->idx = seams->idx + 1 + seams->rd->decode(seams->nverts - (seams->idx + 1));
+    seams->global = seams->rd->decode(seams->vertex_offset);
+    seams->left--;
+  }
+  else
+  {
+    seams->idx = -1;
+  }
+}
+
+static void init_seams(miSeams* seams, const miChunkDecoder* chunk, const unsigned char* seam_bytes)
+{
+  seams->rd = (chunk->nseams ? new RangeDecoder((unsigned char*)seam_bytes, chunk->seam_nbytes) : 0);
+  seams->nverts = chunk->nverts;
+  seams->vertex_offset = chunk->vertex_offset;
+  seams->left = chunk->nseams;
+  seams->idx = -1;
+  next_seam(seams);
+}
+
+static void done_seams(miSeams* seams)
+{
+  if (seams->rd)
+  {
+    seams->rd->done();
+    delete seams->rd;
+    seams->rd = 0;
+  }
+}
+
+typedef struct miDecompressor
+{
+  miChunkDecoder* chunks;
+  miMesh* mimesh;
+  bool failed;
+} miDecompressor;
+
+static void decompress_chunk(void* data, int c)
+{
+  miDecompressor* decompressor = (miDecompressor*)data;
+  miChunkDecoder* chunk = &(decompressor->chunks[c]);
+  float* vertices = decompressor->mimesh->vertices;
+  int* faces = &(decompressor->mimesh->faces[3*chunk->face_offset]);
+  int i, f, next;
+
+  int* global_index = (int*)malloc(sizeof(int)*(chunk->nverts ? chunk->nverts : 1));
+
+  // the seam vertices refer to vertices of earlier chunks. the others are new.
+
+  miSeams seams;
+  init_seams(&seams, chunk, chunk->seam_bytes);
+
+  next = chunk->vertex_offset;
+  for (i = 0; i < chunk->nverts; i++)
+  {
+    if (i == seams.idx)
+    {
+      global_index[i] = seams.global;
+      next_seam(&seams);
+    }
+    else
+    {
+      global_index[i] = next;
+      next++;
+    }
+  }
+
+  done_seams(&seams);
+
+  SMreader_smc* smreader = new SMreader_smc();
+  smreader->open(chunk->bytes, chunk->nbytes);
+
+  f = 0;
+  SMevent event;
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    if (event == SM_VERTEX)
+    {
+      if (smreader->v_idx < 0 || smreader->v_idx >= chunk->nverts)
+      {
+        decompressor->failed = true;
+        break;
+      }
+      i = global_index[smreader->v_idx];
+      if (i >= chunk->vertex_offset)
+      {
+        VecCopy3fv(&(vertices[3*i]), smreader->v_pos_f);
+      }
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      if (f == chunk->nfaces)
+      {
+        decompressor->failed = true;
+        break;
+      }
+      for (i = 0; i < 3; i++)
+      {
+        faces[3*f+i] = global_index[smreader->t_idx[i]];
+      }
+      f++;
+    }
+  }
+
+  if (f != chunk->nfaces)
+  {
+    decompressor->failed = true;
+  }
+
+  smreader->close();
+  delete smreader;
+
+  free(global_index);
+}
+
+miMesh* decompress(const miCodec* micodec, int threads)
+{
+  int c, nchunks, nverts, nfaces;
+
+  if (micodec == 0 || micodec->bytes == 0 || micodec->nbytes < 8)
+  {
+    fprintf(stderr,"ERROR: no codec to decompress\n");
+    return 0;
+  }
+
+  const unsigned char* bytes = micodec->bytes;
+  nchunks = get_nchunks(bytes, micodec->nbytes);
+  if (nchunks < 0)
+  {
+    return 0;
+  }
+
+  // read the table of contents and figure out where the chunks go
+
+  miDecompressor decompressor;
+  decompressor.chunks = (miChunkDecoder*)malloc(sizeof(miChunkDecoder)*(nchunks ? nchunks : 1));
+  decompressor.failed = false;
+
+  const unsigned char* chunk_bytes = bytes + 8 + 20*nchunks;
+  if (!read_table_of_contents(bytes + 8, nchunks, micodec->nbytes - 8 - 20*nchunks, decompressor.chunks, &nverts, &nfaces))
+  {
+    free(decompressor.chunks);
+    return 0;
+  }
+  for (c = 0; c < nchunks; c++)
+  {
+    miChunkDecoder* chunk = &(decompressor.chunks[c]);
+    chunk->bytes = chunk_bytes + chunk->offset;
+    chunk->seam_bytes = chunk->bytes + chunk->nbytes;
+  }
+
+  if (nverts != micodec->nverts || nfaces != micodec->nfaces)
+  {
+    fprintf(stderr,"ERROR: codec has %d vertices and %d triangles but its chunks have %d and %d\n", micodec->nverts, micodec->nfaces, nverts, nfaces);
+    free(decompressor.chunks);
+    return 0;
+  }
+
+  miMesh* mimesh = (miMesh*)malloc(sizeof(miMesh));
+  mimesh->nverts = nverts;
+  mimesh->nfaces = nfaces;
+  mimesh->vertices = (float*)malloc(sizeof(float)*3*(nverts ? nverts : 1));
+  mimesh->faces = (int*)malloc(sizeof(int)*3*(nfaces ? nfaces : 1));
+  decompressor.mimesh = mimesh;
+
+  run(decompress_chunk, &decompressor, nchunks, threads);
+
+  free(decompressor.chunks);
+
+  if (decompressor.failed)
+  {
+    fprintf(stderr,"ERROR: codec is corrupt\n");
+    deleteMesh(mimesh);
+    return 0;
+  }
+
+  return mimesh;
+}
+
+// streaming decompression
+
+static bool read_codec_header(FILE* file, miCodec* micodec, const char* file_name);
+
+struct miStreamState
+{
+  FILE* file;                // the chunks are either read from a file
+  long file_start;           // where the first chunk starts in the file
+  unsigned char* buffer;     // and the current chunk is read into here
+  int buffer_size;
+  const unsigned char* bytes; // or the chunks are in memory
+  int nchunks;
+  miChunkDecoder* chunks;
+  int chunk;                 // the chunk that is decoded (or nchunks at the end)
+  bool chunk_open;
+  SMreader_smc* smreader;
+  miSeams seams;
+  int chunk_v_count;         // vertices of the chunk decoded so far
+  int next_vertex;           // the index of the next new vertex
+  my_index_hash* index_hash; // the vertices of the chunk still in use and their index in the mesh
+  my_index_hash* seam_hash;  // the vertices in several chunks and the last chunk that uses them
+  bool pending;              // the last element did not fit into the last batch
+  SMevent event;
+  int idx[3];
+  bool final[3];
+  float pos[3];
+  bool failed;
+};
+
+static const unsigned char* read_chunk_bytes(miStreamState* state, int offset, int size)
+{
+  if (state->file == 0)
+  {
+    return state->bytes + offset;
+  }
+  if (size > state->buffer_size)
+  {
+    free(state->buffer);
+    state->buffer = (unsigned char*)malloc(sizeof(unsigned char)*size);
+    state->buffer_size = (state->buffer ? size : 0);
+    if (state->buffer == 0)
+    {
+      fprintf(stderr,"ERROR: malloc for %d bytes of codec failed\n", size);
+      return 0;
+    }
+  }
+  if (fseek(state->file, state->file_start + offset, SEEK_SET) || (int)fread(state->buffer, 1, size, state->file) != size)
+  {
+    fprintf(stderr,"ERROR: codec file is truncated\n");
+    return 0;
+  }
+  return state->buffer;
+}
+
+static bool open_chunk(miStreamState* state)
+{
+  miChunkDecoder* chunk = &(state->chunks[state->chunk]);
+  const unsigned char* chunk_bytes = read_chunk_bytes(state, chunk->offset, chunk->nbytes + chunk->seam_nbytes);
+  if (chunk_bytes == 0 || !state->smreader->open(chunk_bytes, chunk->nbytes))
+  {
+    return false;
+  }
+  init_seams(&(state->seams), chunk, chunk_bytes + chunk->nbytes);
+  state->chunk_v_count = 0;
+  state->chunk_open = true;
+  return true;
+}
+
+static void close_chunk(miStreamState* state)
+{
+  state->smreader->close();
+  done_seams(&(state->seams));
+  state->index_hash->clear();
+  state->chunk_open = false;
+}
+
+// a vertex that is no longer used by its chunk may still be used by a later one
+
+static bool is_final(miStreamState* state, int idx)
+{
+  my_index_hash::iterator hash_element = state->seam_hash->find(idx);
+  if (hash_element == state->seam_hash->end())
+  {
+    return true;
+  }
+  if ((*hash_element).second == state->chunk)
+  {
+    state->seam_hash->erase(hash_element);
+    return true;
+  }
+  return false;
+}
+
+static bool start_stream(miStreamState* state, const unsigned char* toc, int nbytes, int nverts, int nfaces)
+{
+  int c, chunk_nverts, chunk_nfaces;
+
+  if (!read_table_of_contents(toc, state->nchunks, nbytes, state->chunks, &chunk_nverts, &chunk_nfaces))
+  {
+    return false;
+  }
+  if (chunk_nverts != nverts || chunk_nfaces != nfaces)
+  {
+    fprintf(stderr,"ERROR: codec has %d vertices and %d triangles but its chunks have %d and %d\n", nverts, nfaces, chunk_nverts, chunk_nfaces);
+    return false;
+  }
+
+  // find the last chunk that uses each of the vertices that are in several chunks
+
+  for (c = 0; c < state->nchunks; c++)
+  {
+    miChunkDecoder* chunk = &(state->chunks[c]);
+    if (chunk->nseams == 0)
+    {
+      continue;
+    }
+    const unsigned char* seam_bytes = read_chunk_bytes(state, chunk->offset + chunk->nbytes, chunk->seam_nbytes);
+    if (seam_bytes == 0)
+    {
+      return false;
+    }
+    miSeams seams;
+    init_seams(&seams, chunk, seam_bytes);
+    while (seams.idx != -1)
+    {
+      (*(state->seam_hash))[seams.global] = c;
+      next_seam(&seams);
+    }
+    done_seams(&seams);
+  }
+
+  state->chunk = 0;
+  state->next_vertex = 0;
+  if (state->nchunks && !open_chunk(state))
+  {
+    return false;
+  }
+  return true;
+}
+
+// decodes the next new vertex or triangle
+
+static SMevent read_stream(miStreamState* state)
+{
+  my_index_hash::iterator hash_element;
+  SMevent event;
+  int i;
+
+  while (!state->failed && state->chunk < state->nchunks)
+  {
+    miChunkDecoder* chunk = &(state->chunks[state->chunk]);
+    SMreader_smc* smreader = state->smreader;
+    event = smreader->read_element();
+    if (event == SM_VERTEX)
+    {
+      if (smreader->v_idx != state->chunk_v_count || state->chunk_v_count == chunk->nverts)
+      {
+        break;
+      }
+      state->chunk_v_count++;
+      if (smreader->v_idx == state->seams.idx)
+      {
+        // this vertex was already decoded with an earlier chunk
+        state->index_hash->insert(my_index_hash::value_type(smreader->v_idx, state->seams.global));
+        next_seam(&(state->seams));
+        continue;
+      }
+      state->index_hash->insert(my_index_hash::value_type(smreader->v_idx, state->next_vertex));
+      state->idx[0] = state->next_vertex;
+      VecCopy3fv(state->pos, smreader->v_pos_f);
+      state->next_vertex++;
+      return SM_VERTEX;
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      for (i = 0; i < 3; i++)
+      {
+        hash_element = state->index_hash->find(smreader->t_idx[i]);
+        if (hash_element == state->index_hash->end())
+        {
+          break;
+        }
+        state->idx[i] = (*hash_element).second;
+      }
+      if (i < 3)
+      {
+        break;
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader->t_final[i])
+        {
+          state->index_hash->erase(smreader->t_idx[i]);
+          state->final[i] = is_final(state, state->idx[i]);
+        }
+        else
+        {
+          state->final[i] = false;
+        }
+      }
+      return SM_TRIANGLE;
+    }
+    else if (event == SM_EOF)
+    {
+      if (state->chunk_v_count != chunk->nverts || smreader->f_count != chunk->nfaces)
+      {
+        break;
+      }
+      close_chunk(state);
+      state->chunk++;
+      if (state->chunk < state->nchunks && !open_chunk(state))
+      {
+        break;
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  if (state->chunk < state->nchunks && !state->failed)
+  {
+    fprintf(stderr,"ERROR: chunk %d of codec is corrupt\n", state->chunk);
+    state->failed = true;
+  }
+  return (state->failed ? SM_ERROR : SM_EOF);
+}
+
+static miStreamState* new_stream_state(int nchunks)
+{
+  miStreamState* state = new miStreamState;
+  state->file = 0;
+  state->file_start = 0;
+  state->buffer = 0;
+  state->buffer_size = 0;
+  state->bytes = 0;
+  state->nchunks = nchunks;
+  state->chunks = (miChunkDecoder*)malloc(sizeof(miChunkDecoder)*(nchunks ? nchunks : 1));
+  state->chunk = 0;
+  state->chunk_open = false;
+  state->smreader = new SMreader_smc();
+  state->seams.rd = 0;
+  state->index_hash = new my_index_hash;
+  state->seam_hash = new my_index_hash;
+  state->pending = false;
+  state->failed = false;
+  return state;
+}
+
+bool miStreamDecoder::open(const miCodec* micodec)
+{
+  close();
+
+  if (micodec == 0 || micodec->bytes == 0 || micodec->nbytes < 8)
+  {
+    fprintf(stderr,"ERROR: no codec to decompress\n");
+    return false;
+  }
+  int nchunks = get_nchunks(micodec->bytes, micodec->nbytes);
+  if (nchunks < 0)
+  {
+    return false;
+  }
+
+  state = new_stream_state(nchunks);
+  state->bytes = micodec->bytes + 8 + 20*nchunks;
+
+  nverts = micodec->nverts;
+  nfaces = micodec->nfaces;
+  bits = micodec->bits;
+  VecCopy3fv(bb_min, micodec->bb_min);
+  VecCopy3fv(bb_max, micodec->bb_max);
+
+  if (!start_stream(state, micodec->bytes + 8, micodec->nbytes - 8 - 20*nchunks, nverts, nfaces))
+  {
+    close();
+    return false;
+  }
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+bool miStreamDecoder::open(FILE* file)
+{
+  unsigned char bytes[8];
+  miCodec micodec;
+
+  close();
+
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: no codec file\n");
+    return false;
+  }
+  if (!read_codec_header(file, &micodec, "the codec file"))
+  {
+    return false;
+  }
+  if (micodec.nbytes < 8 || fread(bytes, 1, 8, file) != 8)
+  {
+    fprintf(stderr,"ERROR: codec file is truncated\n");
+    return false;
+  }
+  int nchunks = get_nchunks(bytes, micodec.nbytes);
+  if (nchunks < 0)
+  {
+    return false;
+  }
+
+  unsigned char* toc = (unsigned char*)malloc(sizeof(unsigned char)*(20*nchunks + 1));
+  if (toc == 0 || (int)fread(toc, 1, 20*nchunks, file) != 20*nchunks)
+  {
+    fprintf(stderr,"ERROR: codec file is truncated\n");
+    free(toc);
+    return false;
+  }
+
+  state = new_stream_state(nchunks);
+  state->file = file;
+  state->file_start = ftell(file);
+
+  nverts = micodec.nverts;
+  nfaces = micodec.nfaces;
+  bits = micodec.bits;
+  VecCopy3fv(bb_min, micodec.bb_min);
+  VecCopy3fv(bb_max, micodec.bb_max);
+
+  bool ok = start_stream(state, toc, micodec.nbytes - 8 - 20*nchunks, nverts, nfaces);
+  free(toc);
+  if (!ok)
+  {
+    close();
+    return false;
+  }
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+bool miStreamDecoder::next_batch(miBatch* batch)
+{
+  batch->first_vertex = v_count;
+  batch->nverts = 0;
+  batch->nfaces = 0;
+
+  if (state == 0)
+  {
+    return false;
+  }
+  if (batch->max_verts <= 0 || batch->max_faces <= 0)
+  {
+    fprintf(stderr,"ERROR: batch has no room for vertices or triangles\n");
+    return false;
+  }
+
+  while (true)
+  {
+    if (!state->pending)
+    {
+      state->event = read_stream(state);
+      if (state->event <= SM_EOF)
+      {
+        break;
+      }
+      state->pending = true;
+    }
+    if (state->event == SM_VERTEX)
+    {
+      if (batch->nverts == batch->max_verts)
+      {
+        break;
+      }
+      VecCopy3fv(&(batch->vertices[3*batch->nverts]), state->pos);
+      batch->nverts++;
+      v_count++;
+    }
+    else
+    {
+      if (batch->nfaces == batch->max_faces)
+      {
+        break;
+      }
+      VecCopy3iv(&(batch->faces[3*batch->nfaces]), state->idx);
+      if (batch->final)
+      {
+        batch->final[3*batch->nfaces+0] = state->final[0];
+        batch->final[3*batch->nfaces+1] = state->final[1];
+        batch->final[3*batch->nfaces+2] = state->final[2];
+      }
+      batch->nfaces++;
+      f_count++;
+    }
+    state->pending = false;
+  }
+
+  return (batch->nverts || batch->nfaces);
+}
+
+void miStreamDecoder::close()
+{
+  if (state)
+  {
+    if (state->chunk_open)
+    {
+      close_chunk(state);
+    }
+    delete state->smreader;
+    delete state->index_hash;
+    delete state->seam_hash;
+    free(state->chunks);
+    free(state->buffer);
+    delete state;
+    state = 0;
+  }
+}
+
+miStreamDecoder::miStreamDecoder()
+{
+  nverts = -1;
+  nfaces = -1;
+  bits = -1;
+  v_count = -1;
+  f_count = -1;
+  state = 0;
+}
+
+miStreamDecoder::~miStreamDecoder()
+{
+  close();
+}
+
+// helpful utilities
+
+miMesh* loadMesh(const char* file_name)
+{
+  int v, f;
+
+  if (file_name == 0)
+  {
+    fprintf(stderr,"ERROR: no file name\n");
+    return 0;
+  }
+  if (strstr(file_name, ".gz"))
+  {
+    fprintf(stderr,"ERROR: cannot open gzipped file '%s'\n", file_name);
+    return 0;
+  }
+
+  FILE* file = fopen(file_name, "rb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s'\n", file_name);
+    return 0;
+  }
+
+  SMreader_ply* smreader = new SMreader_ply();
+  if (!smreader->open(file))
+  {
+    fclose(file);
+    delete smreader;
+    return 0;
+  }
+
+  miMesh* mimesh = (miMesh*)malloc(sizeof(miMesh));
+  mimesh->nverts = smreader->nverts;
+  mimesh->nfaces = smreader->nfaces;
+  mimesh->vertices = (float*)malloc(sizeof(float)*3*(mimesh->nverts ? mimesh->nverts : 1));
+  mimesh->faces = (int*)malloc(sizeof(int)*3*(mimesh->nfaces ? mimesh->nfaces : 1));
+
+  v = 0;
+  f = 0;
+  SMevent event;
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    if (event == SM_VERTEX)
+    {
+      VecCopy3fv(&(mimesh->vertices[3*v]), smreader->v_pos_f);
+      v++;
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      mimesh->faces[3*f+0] = smreader->t_idx[0];
+      mimesh->faces[3*f+1] = smreader->t_idx[1];
+      mimesh->faces[3*f+2] = smreader->t_idx[2];
+      f++;
+    }
+  }
+
+  smreader->close();
+  delete smreader;
+
+  return mimesh;
+}
+
+int saveMesh(const miMesh* mimesh, const char* file_name)
+{
+  int i;
+  unsigned char bytes[13];
+
+  if (mimesh == 0 || file_name == 0)
+  {
+    return 0;
+  }
+
+  FILE* file = fopen(file_name, "wb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for writing\n", file_name);
+    return 0;
+  }
+
+  fprintf(file, "ply\n");
+  fprintf(file, "format binary_little_endian 1.0\n");
+  fprintf(file, "element vertex %d\n", mimesh->nverts);
+  fprintf(file, "property float32 x\n");
+  fprintf(file, "property float32 y\n");
+  fprintf(file, "property float32 z\n");
+  fprintf(file, "element face %d\n", mimesh->nfaces);
+  fprintf(file, "property list uint8 int32 vertex_indices\n");
+  fprintf(file, "end_header\n");
+
+  for (i = 0; i < 3*mimesh->nverts; i++)
+  {
+    put_float(file, mimesh->vertices[i]);
+  }
+  bytes[0] = 3;
+  for (i = 0; i < mimesh->nfaces; i++)
+  {
+    put_int(&(bytes[1]), mimesh->faces[3*i+0]);
+    put_int(&(bytes[5]), mimesh->faces[3*i+1]);
+    put_int(&(bytes[9]), mimesh->faces[3*i+2]);
+    fwrite(bytes, 1, 13, file);
+  }
+
+  if (ferror(file))
+  {
+    fprintf(stderr,"ERROR: failed writing '%s'\n", file_name);
+    fclose(file);
+    return 0;
+  }
+  fclose(file);
+  return 1;
+}
+
+// the codec is stored like the original micode stored its codecs: as a PLY
+// file with an element 'code' whose bytes follow the bounding box
+
+// reads everything but the bytes of a codec file. the file is then at the first byte.
+
+static bool read_codec_header(FILE* file, miCodec* micodec, const char* file_name)
+{
+  char line[256];
+  int nverts = -1;
+  int nfaces = -1;
+  int bits = -1;
+  int nbytes = -1;
+  bool smc = false;
+  int i;
+
+  if (fgets(line, 256, file) == 0 || strncmp(line, "ply", 3) != 0)
+  {
+    fprintf(stderr,"ERROR: %s is not a PLY file\n", file_name);
+    return false;
+  }
+
+  while (fgets(line, 256, file))
+  {
+    if (strncmp(line, "end_header", 10) == 0)
+    {
+      break;
+    }
+    sscanf(line, "comment nverts %d", &nverts);
+    sscanf(line, "comment nfaces %d", &nfaces);
+    sscanf(line, "comment bits %d", &bits);
+    sscanf(line, "element code %d", &nbytes);
+    if (strncmp(line, "comment codec smc", 17) == 0)
+    {
+      smc = true;
+    }
+  }
+
+  if (!smc)
+  {
+    fprintf(stderr,"ERROR: %s was compressed out-of-core. use ps2sm to read it\n", file_name);
+    return false;
+  }
+  if (nverts < 0 || nfaces < 0 || bits < 0 || nbytes < 0)
+  {
+    fprintf(stderr,"ERROR: something is missing in the header of %s\n", file_name);
+    return false;
+  }
+
+  micodec->nverts = nverts;
+  micodec->nfaces = nfaces;
+  micodec->bits = bits;
+  micodec->nbytes = nbytes;
+  micodec->bytes = 0;
+
+  bool ok = true;
+  for (i = 0; ok && i < 3; i++) ok = get_float(file, &(micodec->bb_min[i]));
+  for (i = 0; ok && i < 3; i++) ok = get_float(file, &(micodec->bb_max[i]));
+  if (!ok)
+  {
+    fprintf(stderr,"ERROR: %s is truncated\n", file_name);
+  }
+  return ok;
+}
+
+miCodec* loadCodec(const char* file_name)
+{
+  if (file_name == 0)
+  {
+    fprintf(stderr,"ERROR: no file name\n");
+    return 0;
+  }
+
+  FILE* file = fopen(file_name, "rb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s'\n", file_name);
+    return 0;
+  }
+
+  miCodec* micodec = (miCodec*)malloc(sizeof(miCodec));
+  if (!read_codec_header(file, micodec, file_name))
+  {
+    fclose(file);
+    free(micodec);
+    return 0;
+  }
+
+  micodec->bytes = (unsigned char*)malloc(sizeof(unsigned char)*(micodec->nbytes ? micodec->nbytes : 1));
+
+  bool ok = (micodec->bytes != 0 && (int)fread(micodec->bytes, 1, micodec->nbytes, file) == micodec->nbytes);
+
+  fclose(file);
+
+  if (!ok)
+  {
+    fprintf(stderr,"ERROR: '%s' is truncated\n", file_name);
+    deleteCodec(micodec);
+    return 0;
+  }
+
+  return micodec;
+}
+
+int saveCodec(const miCodec* micodec, const char* file_name)
+{
+  int i;
+
+  if (micodec == 0 || file_name == 0)
+  {
+    return 0;
+  }
+
+  FILE* file = fopen(file_name, "wb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for writing\n", file_name);
+    return 0;
+  }
+
+  fprintf(file, "ply\n");
+  fprintf(file, "format binary_little_endian 1.0\n");
+  fprintf(file, "comment nverts %d\n", micodec->nverts);
+  fprintf(file, "comment nfaces %d\n", micodec->nfaces);
+  fprintf(file, "comment bits %d\n", micodec->bits);
+  fprintf(file, "comment codec smc\n");
+  fprintf(file, "element boundingbox 6\n");
+  fprintf(file, "property float32 minmax\n");
+  fprintf(file, "element code %d\n", micodec->nbytes);
+  fprintf(file, "property uint8 code\n");
+  fprintf(file, "end_header\n");
+
+  for (i = 0; i < 3; i++) put_float(file, micodec->bb_min[i]);
+  for (i = 0; i < 3; i++) put_float(file, micodec->bb_max[i]);
+  fwrite(micodec->bytes, 1, micodec->nbytes, file);
+
+  if (ferror(file))
+  {
+    fprintf(stderr,"ERROR: failed writing '%s'\n", file_name);
+    fclose(file);
+    return 0;
+  }
+  fclose(file);
+  return 1;
+}
+
+void deleteMesh(miMesh* mimesh)
+{
+  if (mimesh)
+  {
+    free(mimesh->vertices);
+    free(mimesh->faces);
+    free(mimesh);
+  }
+}
+
+void deleteCodec(miCodec* micodec)
+{
+  if (micodec)
+  {
+    free(micodec->bytes);
+    free(micodec);
+  }
+}
+
+int quantize(int nverts, float* vertices, int bits, const float* bb_min, const float* bb_max)
+{
+  float min[3], max[3];
+  int q[3];
+
+  if (nverts <= 0 || vertices == 0)
+  {
+    return 0;
+  }
+
+  if (bb_min && bb_max)
+  {
+    VecCopy3fv(min, bb_min);
+    VecCopy3fv(max, bb_max);
+  }
+  else
+  {
+    compute_bounding_box(nverts, vertices, min, max);
+  }
+
+  // exactly what the decompressor will produce
+
+  PositionQuantizerNew pq;
+  pq.SetMinMax(min, max);
+  pq.SetPrecision(bits);
+  pq.SetupQuantizer();
+
+  for (int i = 0; i < nverts; i++)
+  {
+    pq.EnQuantize(&(vertices[3*i]), q);
+    pq.DeQuantize(q, &(vertices[3*i]));
+  }
+
+  return 1;
+}
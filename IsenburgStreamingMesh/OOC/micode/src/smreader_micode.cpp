@@ -0,0 +1,203 @@
+/*
+===============================================================================
+
+  FILE:  SMreader_micode.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed for evaluation purposes only
+    WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreader_micode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vec3fv.h"
+#include "vec3iv.h"
+
+bool SMreader_micode::open(const miCodec* micodec)
+{
+  close();
+  decoder = new miStreamDecoder();
+  if (!decoder->open(micodec))
+  {
+    close();
+    return false;
+  }
+  return start();
+}
+
+bool SMreader_micode::open(FILE* file)
+{
+  close();
+  decoder = new miStreamDecoder();
+  if (!decoder->open(file))
+  {
+    close();
+    return false;
+  }
+  return start();
+}
+
+bool SMreader_micode::start()
+{
+  nverts = decoder->nverts;
+  nfaces = decoder->nfaces;
+
+  bb_min_f = new float[3];
+  bb_max_f = new float[3];
+  VecCopy3fv(bb_min_f, decoder->bb_min);
+  VecCopy3fv(bb_max_f, decoder->bb_max);
+
+  batch.max_verts = SM_MICODE_BATCH;
+  batch.vertices = (float*)malloc(sizeof(float)*3*SM_MICODE_BATCH);
+  batch.max_faces = SM_MICODE_BATCH;
+  batch.faces = (int*)malloc(sizeof(int)*3*SM_MICODE_BATCH);
+  batch.final = (bool*)malloc(sizeof(bool)*3*SM_MICODE_BATCH);
+  batch.nverts = 0;
+  batch.nfaces = 0;
+
+  next_vertex = 0;
+  next_face = 0;
+  have_finalized = next_finalized = 0;
+
+  v_count = 0;
+  f_count = 0;
+
+  return true;
+}
+
+// gets the next batch once all of the current one was read
+
+bool SMreader_micode::next()
+{
+  if (next_vertex < batch.nverts || next_face < batch.nfaces)
+  {
+    return true;
+  }
+  next_vertex = 0;
+  next_face = 0;
+  return decoder->next_batch(&batch);
+}
+
+SMevent SMreader_micode::read_element()
+{
+  if (decoder == 0)
+  {
+    return SM_EOF;
+  }
+  if (!next())
+  {
+    // the decoder stops early when the codec is corrupt
+    return ((decoder->v_count == nverts && decoder->f_count == nfaces) ? SM_EOF : SM_ERROR);
+  }
+  if (next_vertex < batch.nverts)
+  {
+    v_idx = batch.first_vertex + next_vertex;
+    VecCopy3fv(v_pos_f, &(batch.vertices[3*next_vertex]));
+    next_vertex++;
+    v_count++;
+    return SM_VERTEX;
+  }
+  VecCopy3iv(t_idx, &(batch.faces[3*next_face]));
+  t_final[0] = batch.final[3*next_face+0];
+  t_final[1] = batch.final[3*next_face+1];
+  t_final[2] = batch.final[3*next_face+2];
+  next_face++;
+  f_count++;
+  return SM_TRIANGLE;
+}
+
+SMevent SMreader_micode::read_event()
+{
+  if (have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    have_finalized--; next_finalized++;
+    return SM_FINALIZED;
+  }
+  SMevent event = read_element();
+  if (event == SM_TRIANGLE)
+  {
+    next_finalized = 0;
+    for (int i = 0; i < 3; i++)
+    {
+      if (t_final[i])
+      {
+        finalized_vertices[have_finalized] = t_idx[i];
+        have_finalized++;
+      }
+    }
+  }
+  return event;
+}
+
+void SMreader_micode::close()
+{
+  if (decoder)
+  {
+    decoder->close();
+    delete decoder;
+    decoder = 0;
+  }
+  free(batch.vertices);
+  free(batch.faces);
+  free(batch.final);
+  batch.vertices = 0;
+  batch.faces = 0;
+  batch.final = 0;
+  if (bb_min_f) delete [] bb_min_f;
+  if (bb_max_f) delete [] bb_max_f;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  v_count = -1;
+  f_count = -1;
+}
+
+SMreader_micode::SMreader_micode()
+{
+  // init of SMreader interface
+  ncomments = 0;
+  comments = 0;
+
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreader_micode
+  decoder = 0;
+  batch.vertices = 0;
+  batch.faces = 0;
+  batch.final = 0;
+  have_finalized = next_finalized = 0;
+}
+
+SMreader_micode::~SMreader_micode()
+{
+  close();
+}
@@ -41,7 +41,7 @@ RSC=rc.exe
 # PROP Intermediate_Dir "Release"
 # PROP Target_Dir ""
 # ADD BASE CPP /nologo /W3 /GX /O2 /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
-# ADD CPP /nologo /W3 /GX /O2 /I "stl" /I "inc" /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
+# ADD CPP /nologo /MT /W3 /GX /O2 /I "stl" /I "inc" /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
 # ADD BASE RSC /l 0x409 /d "NDEBUG"
 # ADD RSC /l 0x409 /d "NDEBUG"
 BSC32=bscmake.exe
@@ -68,7 +68,7 @@ PostBuild_Cmds=copy Release\PSlib.lib lib\PSlib.lib
 # PROP Intermediate_Dir "Debug"
 # PROP Target_Dir ""
 # ADD BASE CPP /nologo /W3 /Gm /GX /ZI /Od /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
-# ADD CPP /nologo /W3 /Gm /GX /ZI /Od /I "inc" /I "stl" /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
+# ADD CPP /nologo /MTd /W3 /Gm /GX /ZI /Od /I "inc" /I "stl" /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
 # ADD BASE RSC /l 0x409 /d "_DEBUG"
 # ADD RSC /l 0x409 /d "_DEBUG"
 BSC32=bscmake.exe
@@ -101,10 +101,6 @@ SOURCE=.\src\codec_new_dec.h
 # End Source File
 # Begin Source File
 
-SOURCE=.\src\crazyvector_for_pointers.cpp
-# End Source File
-# Begin Source File
-
 SOURCE=.\src\crazyvector_for_pointers.h
 # End Source File
 # Begin Source File
@@ -121,6 +117,10 @@ SOURCE=.\src\ply.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\poolallocator.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\positionquantizer.h
 # End Source File
 # Begin Source File
@@ -153,10 +153,6 @@ SOURCE=.\src\rangemodel.h
 # End Source File
 # Begin Source File
 
-SOURCE=.\src\vector.cpp
-# End Source File
-# Begin Source File
-
 SOURCE=.\src\vector.h
 # End Source File
 # End Group
@@ -181,6 +177,10 @@ SOURCE=.\inc\psreader_oocc.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\inc\smidx.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\inc\smreader.h
 # End Source File
 # Begin Source File
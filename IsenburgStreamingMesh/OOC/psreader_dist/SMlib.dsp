@@ -41,7 +41,7 @@ RSC=rc.exe
 # PROP Intermediate_Dir "Release"
 # PROP Target_Dir ""
 # ADD BASE CPP /nologo /W3 /GX /O2 /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
-# ADD CPP /nologo /W3 /GX /O2 /I "inc" /I "stl" /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
+# ADD CPP /nologo /MT /W3 /GX /O2 /I "inc" /I "stl" /D "WIN32" /D "NDEBUG" /D "_MBCS" /D "_LIB" /YX /FD /c
 # ADD BASE RSC /l 0x409 /d "NDEBUG"
 # ADD RSC /l 0x409 /d "NDEBUG"
 BSC32=bscmake.exe
@@ -68,7 +68,7 @@ PostBuild_Cmds=copy Release\SMlib.lib lib\SMlib.lib
 # PROP Intermediate_Dir "Debug"
 # PROP Target_Dir ""
 # ADD BASE CPP /nologo /W3 /Gm /GX /ZI /Od /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
-# ADD CPP /nologo /W3 /Gm /GX /ZI /Od /I "inc" /I "stl" /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
+# ADD CPP /nologo /MTd /W3 /Gm /GX /ZI /Od /I "inc" /I "stl" /D "WIN32" /D "_DEBUG" /D "_MBCS" /D "_LIB" /YX /FD /GZ /c
 # ADD BASE RSC /l 0x409 /d "_DEBUG"
 # ADD RSC /l 0x409 /d "_DEBUG"
 BSC32=bscmake.exe
@@ -93,14 +93,6 @@ PostBuild_Cmds=copy Debug\SMlib.lib lib\SMlib.lib
 # PROP Default_Filter "cpp;c;cxx;rc;def;r;odl;idl;hpj;bat"
 # Begin Source File
 
-SOURCE=.\src\dynamicqueue.cpp
-# End Source File
-# Begin Source File
-
-SOURCE=.\src\dynamicvector.cpp
-# End Source File
-# Begin Source File
-
 SOURCE=.\src\floatcompressor.cpp
 # End Source File
 # Begin Source File
@@ -129,10 +121,22 @@ SOURCE=.\src\rangemodel.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\smindex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smpipe.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\smconverter.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\smreader_isosurface.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\smreader_ply.cpp
 # End Source File
 # Begin Source File
@@ -157,6 +161,30 @@ SOURCE=.\src\smreader_smd.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\smreader_synthetic.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smreadnormals.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smreadclustered.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smreadcomponents.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smreadsmoothed.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smreadindexed.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\smreadpostascompactpre.cpp
 # End Source File
 # Begin Source File
@@ -169,6 +197,26 @@ SOURCE=.\src\smwritebuffered.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\smwritelod.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smwriteindexed.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smstats.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smtee.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\smtrace.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\smwriter_off.cpp
 # End Source File
 # Begin Source File
@@ -229,6 +277,10 @@ SOURCE=.\src\ply.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\poolallocator.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\positionquantizer.h
 # End Source File
 # Begin Source File
@@ -257,10 +309,30 @@ SOURCE=.\inc\smconverter.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\inc\smidx.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smindex.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smmemory.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smpipe.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\inc\smreader.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\inc\smreader_isosurface.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\inc\smreader_ply.h
 # End Source File
 # Begin Source File
@@ -285,6 +357,30 @@ SOURCE=.\inc\smreader_smd.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\inc\smreader_synthetic.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smreadnormals.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smreadclustered.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smreadcomponents.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smreadsmoothed.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smreadindexed.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\inc\smreadpostascompactpre.h
 # End Source File
 # Begin Source File
@@ -297,6 +393,34 @@ SOURCE=.\inc\smwritebuffered.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\inc\smwritelod.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smwriteindexed.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smstats.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smtee.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smthread.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smtrace.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\inc\smvertexcache.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\inc\smwriter.h
 # End Source File
 # Begin Source File
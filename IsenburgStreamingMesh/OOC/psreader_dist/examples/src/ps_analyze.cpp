@@ -0,0 +1,1073 @@
+/*
+===============================================================================
+
+  FILE:  ps_analyze.cpp
+
+  CONTENTS:
+
+    This program computes what ps_area, ps_angles, ps_normals, and sm_info
+    compute in a single pass over the mesh and writes it as one JSON report.
+    It uses the Processing Sequence API.
+
+    Every metric is a kernel that registers how many bytes of scratch it
+    needs per vertex and per edge. The scratch of all kernels is allocated
+    as one record that is attached to the vertex (or edge) with set_vdata()
+    (or set_edata()) so that there is only one allocation no matter how
+    many kernels run. Each kernel only touches its own slot of the record.
+
+    The triangles are copied in batches. The kernels work through a batch
+    in the order of the triangles. With '-threads' the kernels are spread
+    over several threads that process one batch while the reader already
+    fills the next. Since no two kernels share a slot, they never need to
+    synchronize. The scratch of finalized vertices and of leaving edges is
+    only released once all kernels are done with the batch.
+
+    kernels:
+
+      bounding_box    the bounding box of the vertices
+      area            total, smallest, and largest triangle area
+      crease_angles   distribution of the dihedral angles across edges
+      normals         distribution of the smooth vertex normals
+      stream          the width (active vertices) and span of the stream
+      topology        border, non-manifold, and not-oriented edges/vertices
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to stop decoding the same file four times
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+#include "psreader_oocc.h"
+#include "psreader_lowspan.h"
+#include "psconverter.h"
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smreader_synthetic.h"
+
+#include "vec3fv.h"
+#include "smtrace.h"
+
+#define PS_ANALYZE_BATCH 4096
+#define PS_ANALYZE_MAX_KERNELS 16
+#define PS_ANALYZE_MAX_THREADS 16
+
+#define EPSILON 1.0e-10f
+
+// a triangle as the kernels see it
+
+typedef struct PStriangle
+{
+  float pos[3][3];
+  int idx[3];
+  int vflag[3];
+  int eflag[3];
+  char* vdata[3];   // the scratch record of the vertex
+  char* edata[3];   // the scratch record of an entering or leaving edge (0 otherwise)
+} PStriangle;
+
+// a metric that is computed from the triangles
+
+class PSkernel
+{
+public:
+  const char* name;
+
+  int vertex_bytes;  // how much scratch it needs per vertex
+  int edge_bytes;    // how much scratch it needs per entering edge
+  int vertex_offset; // where its slot starts in the scratch record
+  int edge_offset;
+
+  virtual void process(const PStriangle* triangles, int number) = 0;
+  virtual void write_json(FILE* file, int indent) const = 0;
+
+  PSkernel(const char* name, int vertex_bytes=0, int edge_bytes=0)
+  {
+    this->name = name;
+    this->vertex_bytes = vertex_bytes;
+    this->edge_bytes = edge_bytes;
+    vertex_offset = 0;
+    edge_offset = 0;
+  };
+  virtual ~PSkernel(){};
+};
+
+class PSkernelBoundingBox : public PSkernel
+{
+public:
+  int nverts;
+  float bb_min[3];
+  float bb_max[3];
+
+  void process(const PStriangle* triangles, int number)
+  {
+    for (int t = 0; t < number; t++)
+    {
+      for (int i = 0; i < 3; i++)
+      {
+        if (PS_IS_NEW_VERTEX(triangles[t].vflag[i]))
+        {
+          if (nverts == 0)
+          {
+            VecCopy3fv(bb_min, triangles[t].pos[i]);
+            VecCopy3fv(bb_max, triangles[t].pos[i]);
+          }
+          else
+          {
+            VecUpdateMinMax3fv(bb_min, bb_max, triangles[t].pos[i]);
+          }
+          nverts++;
+        }
+      }
+    }
+  };
+
+  void write_json(FILE* file, int indent) const
+  {
+    fprintf(file, "%*s\"%s\": { \"vertices\": %d, \"min\": [%g, %g, %g], \"max\": [%g, %g, %g] }", indent, "", name, nverts, bb_min[0], bb_min[1], bb_min[2], bb_max[0], bb_max[1], bb_max[2]);
+  };
+
+  PSkernelBoundingBox() : PSkernel("bounding_box")
+  {
+    nverts = 0;
+    VecZero3fv(bb_min);
+    VecZero3fv(bb_max);
+  };
+};
+
+class PSkernelArea : public PSkernel
+{
+public:
+  int nfaces;
+  int zero_area;
+  double total_area;
+  float min_area;
+  float max_area;
+
+  void process(const PStriangle* triangles, int number)
+  {
+    float normal[3];
+    for (int t = 0; t < number; t++)
+    {
+      VecCcwNormal3fv(normal, triangles[t].pos[0], triangles[t].pos[1], triangles[t].pos[2]);
+      float area = 0.5f*VecLength3fv(normal);
+      if (nfaces == 0 || area < min_area) min_area = area;
+      if (nfaces == 0 || area > max_area) max_area = area;
+      if (area < EPSILON) zero_area++;
+      total_area += area;
+      nfaces++;
+    }
+  };
+
+  void write_json(FILE* file, int indent) const
+  {
+    fprintf(file, "%*s\"%s\": { \"faces\": %d, \"total\": %g, \"min\": %g, \"max\": %g, \"zero\": %d }", indent, "", name, nfaces, total_area, min_area, max_area, zero_area);
+  };
+
+  PSkernelArea() : PSkernel("area")
+  {
+    nfaces = 0;
+    zero_area = 0;
+    total_area = 0.0;
+    min_area = 0.0f;
+    max_area = 0.0f;
+  };
+};
+
+// the normal of the triangle that entered an edge waits in the edge slot
+// for the triangle that leaves it
+
+typedef struct PScreaseEdge
+{
+  float normal[3];
+  int valid;
+} PScreaseEdge;
+
+static const float crease_ranges[] = {0.0f, 5.0f, 10.0f, 20.0f, 30.0f, 60.0f, 90.0f, 180.0f};
+
+class PSkernelCreases : public PSkernel
+{
+public:
+  int distribution[8];
+  int skipped_border;
+  int skipped_non_manifold;
+  int skipped_not_oriented;
+  int skipped_zero_normal;
+
+  void process(const PStriangle* triangles, int number)
+  {
+    int i, j;
+    float normal[3];
+    for (int t = 0; t < number; t++)
+    {
+      const PStriangle* triangle = &(triangles[t]);
+      VecCcwNormal3fv(normal, triangle->pos[0], triangle->pos[1], triangle->pos[2]);
+      float length = VecLength3fv(normal);
+      bool valid = (length > EPSILON);
+      if (valid) VecSelfScalarDiv3fv(normal, length);
+
+      for (i = 0; i < 3; i++)
+      {
+        int eflag = triangle->eflag[i];
+        if (PS_IS_ENTERING_EDGE(eflag))
+        {
+          PScreaseEdge* edge = (PScreaseEdge*)(triangle->edata[i] + edge_offset);
+          VecCopy3fv(edge->normal, normal);
+          edge->valid = valid;
+        }
+        else if (PS_IS_LEAVING_EDGE(eflag))
+        {
+          PScreaseEdge* edge = (PScreaseEdge*)(triangle->edata[i] + edge_offset);
+          if (valid && edge->valid)
+          {
+            float dot = VecDotProd3fv(normal, edge->normal);
+            // unlike ps_angles we clamp so that (anti-)parallel normals are not lost
+            if (dot > 1.0f) dot = 1.0f; else if (dot < -1.0f) dot = -1.0f;
+            float angle = (float)(180*acos(dot)/3.141592653);
+            for (j = 0; j < 7; j++)
+            {
+              if (angle < crease_ranges[j]+EPSILON)
+              {
+                break;
+              }
+            }
+            distribution[j]++;
+          }
+          else
+          {
+            skipped_zero_normal++;
+          }
+        }
+        else if (PS_IS_NON_MANIFOLD_EDGE(eflag))
+        {
+          skipped_non_manifold++;
+        }
+        else if (PS_IS_NOT_ORIENTED_EDGE(eflag))
+        {
+          skipped_not_oriented++;
+        }
+        else
+        {
+          skipped_border++;
+        }
+      }
+    }
+  };
+
+  void write_json(FILE* file, int indent) const
+  {
+    fprintf(file, "%*s\"%s\": { \"below_degrees\": [", indent, "", name);
+    for (int j = 0; j < 8; j++)
+    {
+      fprintf(file, "%s%g", (j ? ", " : ""), crease_ranges[j]);
+    }
+    fprintf(file, "], \"edges\": [");
+    for (int j = 0; j < 8; j++)
+    {
+      fprintf(file, "%s%d", (j ? ", " : ""), distribution[j]);
+    }
+    fprintf(file, "], \"skipped_border\": %d, \"skipped_non_manifold\": %d, \"skipped_not_oriented\": %d, \"skipped_zero_normal\": %d }", skipped_border, skipped_non_manifold, skipped_not_oriented, skipped_zero_normal);
+  };
+
+  PSkernelCreases() : PSkernel("crease_angles", 0, sizeof(PScreaseEdge))
+  {
+    memset(distribution, 0, sizeof(distribution));
+    skipped_border = 0;
+    skipped_non_manifold = 0;
+    skipped_not_oriented = 0;
+    skipped_zero_normal = 0;
+  };
+};
+
+// the vertex slot accumulates the (area-weighted) normal of the vertex
+
+typedef struct PSnormalVertex
+{
+  float normal[3];
+  int use;
+} PSnormalVertex;
+
+class PSkernelNormals : public PSkernel
+{
+public:
+  int above_xy_plane;
+  int below_xy_plane;
+  int inside_xy_plane;
+  int zero_normal;
+  int max_use;
+
+  void process(const PStriangle* triangles, int number)
+  {
+    float normal[3];
+    for (int t = 0; t < number; t++)
+    {
+      const PStriangle* triangle = &(triangles[t]);
+      VecCcwNormal3fv(normal, triangle->pos[0], triangle->pos[1], triangle->pos[2]);
+      for (int i = 0; i < 3; i++)
+      {
+        PSnormalVertex* vertex = (PSnormalVertex*)(triangle->vdata[i] + vertex_offset);
+        VecSelfAdd3fv(vertex->normal, normal);
+        vertex->use++;
+        if (PS_IS_FINALIZED_VERTEX(triangle->vflag[i]))
+        {
+          float length = VecLength3fv(vertex->normal);
+          if (length > EPSILON)
+          {
+            float z = vertex->normal[2] / length;
+            if (z > EPSILON) above_xy_plane++;
+            else if (z < -EPSILON) below_xy_plane++;
+            else inside_xy_plane++;
+          }
+          else
+          {
+            zero_normal++;
+          }
+          if (vertex->use > max_use) max_use = vertex->use;
+        }
+      }
+    }
+  };
+
+  void write_json(FILE* file, int indent) const
+  {
+    fprintf(file, "%*s\"%s\": { \"above_xy_plane\": %d, \"below_xy_plane\": %d, \"inside_xy_plane\": %d, \"zero\": %d, \"max_corners_per_vertex\": %d }", indent, "", name, above_xy_plane, below_xy_plane, inside_xy_plane, zero_normal, max_use);
+  };
+
+  PSkernelNormals() : PSkernel("normals", sizeof(PSnormalVertex), 0)
+  {
+    above_xy_plane = 0;
+    below_xy_plane = 0;
+    inside_xy_plane = 0;
+    zero_normal = 0;
+    max_use = 0;
+  };
+};
+
+class PSkernelStream : public PSkernel
+{
+public:
+  int width;
+  int max_width;
+  double sum_width;
+  int max_span;
+  double sum_span;
+  int nfaces;
+
+  void process(const PStriangle* triangles, int number)
+  {
+    for (int t = 0; t < number; t++)
+    {
+      const PStriangle* triangle = &(triangles[t]);
+      int i;
+      for (i = 0; i < 3; i++)
+      {
+        if (PS_IS_NEW_VERTEX(triangle->vflag[i])) width++;
+      }
+      if (width > max_width) max_width = width;
+      sum_width += width;
+      for (i = 0; i < 3; i++)
+      {
+        if (PS_IS_FINALIZED_VERTEX(triangle->vflag[i])) width--;
+      }
+      int span = 1 + (triangle->idx[0] > triangle->idx[1] ? triangle->idx[0] : triangle->idx[1]);
+      if (triangle->idx[2] + 1 > span) span = triangle->idx[2] + 1;
+      int first = (triangle->idx[0] < triangle->idx[1] ? triangle->idx[0] : triangle->idx[1]);
+      if (triangle->idx[2] < first) first = triangle->idx[2];
+      span -= first;
+      if (span > max_span) max_span = span;
+      sum_span += span;
+      nfaces++;
+    }
+  };
+
+  void write_json(FILE* file, int indent) const
+  {
+    fprintf(file, "%*s\"%s\": { \"max_width\": %d, \"avg_width\": %.1f, \"max_span\": %d, \"avg_span\": %.1f }", indent, "", name, max_width, (nfaces ? sum_width/nfaces : 0.0), max_span, (nfaces ? sum_span/nfaces : 0.0));
+  };
+
+  PSkernelStream() : PSkernel("stream")
+  {
+    width = 0;
+    max_width = 0;
+    sum_width = 0.0;
+    max_span = 0;
+    sum_span = 0.0;
+    nfaces = 0;
+  };
+};
+
+class PSkernelTopology : public PSkernel
+{
+public:
+  int interior_edges;
+  int border_edges;
+  int non_manifold_edges;
+  int not_oriented_edges;
+  int border_vertices;
+  int non_manifold_vertices;
+
+  void process(const PStriangle* triangles, int number)
+  {
+    for (int t = 0; t < number; t++)
+    {
+      const PStriangle* triangle = &(triangles[t]);
+      for (int i = 0; i < 3; i++)
+      {
+        int eflag = triangle->eflag[i];
+        if (PS_IS_ENTERING_EDGE(eflag)) interior_edges++;
+        else if (PS_IS_NON_MANIFOLD_EDGE(eflag)) non_manifold_edges++;
+        else if (PS_IS_NOT_ORIENTED_EDGE(eflag)) not_oriented_edges++;
+        else if (PS_IS_BORDER_EDGE(eflag)) border_edges++;
+
+        int vflag = triangle->vflag[i];
+        if (PS_IS_FINALIZED_VERTEX(vflag))
+        {
+          if (PS_IS_NON_MANIFOLD_VERTEX(vflag)) non_manifold_vertices++;
+          else if (PS_IS_BORDER_VERTEX(vflag)) border_vertices++;
+        }
+      }
+    }
+  };
+
+  // non-manifold and not-oriented edges are counted once per triangle side
+
+  void write_json(FILE* file, int indent) const
+  {
+    fprintf(file, "%*s\"%s\": { \"interior_edges\": %d, \"border_edges\": %d, \"non_manifold_edge_sides\": %d, \"not_oriented_edge_sides\": %d, \"border_vertices\": %d, \"non_manifold_vertices\": %d }", indent, "", name, interior_edges, border_edges, non_manifold_edges, not_oriented_edges, border_vertices, non_manifold_vertices);
+  };
+
+  PSkernelTopology() : PSkernel("topology")
+  {
+    interior_edges = 0;
+    border_edges = 0;
+    non_manifold_edges = 0;
+    not_oriented_edges = 0;
+    border_vertices = 0;
+    non_manifold_vertices = 0;
+  };
+};
+
+static PSkernel* kernels[PS_ANALYZE_MAX_KERNELS];
+static int kernels_number = 0;
+
+static PSkernel* create_kernel(const char* name)
+{
+  if (strcmp(name, "bounding_box") == 0) return new PSkernelBoundingBox();
+  if (strcmp(name, "area") == 0) return new PSkernelArea();
+  if (strcmp(name, "crease_angles") == 0) return new PSkernelCreases();
+  if (strcmp(name, "normals") == 0) return new PSkernelNormals();
+  if (strcmp(name, "stream") == 0) return new PSkernelStream();
+  if (strcmp(name, "topology") == 0) return new PSkernelTopology();
+  return 0;
+}
+
+static bool register_kernel(const char* name)
+{
+  if (kernels_number == PS_ANALYZE_MAX_KERNELS)
+  {
+    fprintf(stderr,"ERROR: too many kernels\n");
+    return false;
+  }
+  for (int k = 0; k < kernels_number; k++)
+  {
+    if (strcmp(kernels[k]->name, name) == 0)
+    {
+      return true;
+    }
+  }
+  PSkernel* kernel = create_kernel(name);
+  if (kernel == 0)
+  {
+    fprintf(stderr,"ERROR: unknown kernel '%s'\n", name);
+    return false;
+  }
+  kernels[kernels_number] = kernel;
+  kernels_number++;
+  return true;
+}
+
+// scratch records of a fixed size with a free list through their first bytes
+
+typedef struct PSscratch
+{
+  int size;
+  int alloc;
+  char* next;
+  char* chunks;     // the chunks are linked through their first bytes
+} PSscratch;
+
+static void initScratch(PSscratch* scratch, int size)
+{
+  // round up so that every record can hold the pointer of the free list
+  if (size < (int)sizeof(char*)) size = sizeof(char*);
+  size = (size + sizeof(char*) - 1) / sizeof(char*) * sizeof(char*);
+  scratch->size = size;
+  scratch->alloc = 1024;
+  scratch->next = 0;
+  scratch->chunks = 0;
+}
+
+static char* allocScratch(PSscratch* scratch)
+{
+  if (scratch->next == 0)
+  {
+    char* chunk = (char*)malloc(sizeof(char*) + scratch->size*scratch->alloc);
+    if (chunk == 0)
+    {
+      fprintf(stderr,"ERROR: malloc for scratch failed\n");
+      return 0;
+    }
+    *((char**)chunk) = scratch->chunks;
+    scratch->chunks = chunk;
+    char* record = chunk + sizeof(char*);
+    for (int i = 0; i < scratch->alloc-1; i++)
+    {
+      *((char**)(record + i*scratch->size)) = record + (i+1)*scratch->size;
+    }
+    *((char**)(record + (scratch->alloc-1)*scratch->size)) = 0;
+    scratch->next = record;
+    scratch->alloc *= 2;
+  }
+  char* record = scratch->next;
+  scratch->next = *((char**)record);
+  memset(record, 0, scratch->size);
+  return record;
+}
+
+static void deallocScratch(PSscratch* scratch, char* record)
+{
+  *((char**)record) = scratch->next;
+  scratch->next = record;
+}
+
+static void destroyScratch(PSscratch* scratch)
+{
+  while (scratch->chunks)
+  {
+    char* chunk = scratch->chunks;
+    scratch->chunks = *((char**)chunk);
+    free(chunk);
+  }
+  scratch->next = 0;
+}
+
+static PSscratch vertex_scratch;
+static PSscratch edge_scratch;
+
+// a batch of triangles and the scratch to release once it is processed
+
+typedef struct PSbatch
+{
+  int number;
+  PStriangle triangles[PS_ANALYZE_BATCH];
+  int vertex_release_number;
+  char* vertex_release[3*PS_ANALYZE_BATCH];
+  int edge_release_number;
+  char* edge_release[3*PS_ANALYZE_BATCH];
+} PSbatch;
+
+static void release_batch(PSbatch* batch)
+{
+  int i;
+  for (i = 0; i < batch->vertex_release_number; i++)
+  {
+    deallocScratch(&vertex_scratch, batch->vertex_release[i]);
+  }
+  for (i = 0; i < batch->edge_release_number; i++)
+  {
+    deallocScratch(&edge_scratch, batch->edge_release[i]);
+  }
+  batch->number = 0;
+  batch->vertex_release_number = 0;
+  batch->edge_release_number = 0;
+}
+
+// reads the next batch. returns false once the reader is done
+
+static bool fill_batch(PSreader* psreader, PSbatch* batch)
+{
+  int i;
+  while (batch->number < PS_ANALYZE_BATCH)
+  {
+    if (psreader->read_triangle() <= PS_EOF)
+    {
+      return false;
+    }
+    PStriangle* triangle = &(batch->triangles[batch->number]);
+    for (i = 0; i < 3; i++)
+    {
+      VecCopy3fv(triangle->pos[i], psreader->t_pos_f[i]);
+      triangle->idx[i] = (int)psreader->t_idx[i];
+      triangle->vflag[i] = psreader->t_vflag[i];
+      triangle->eflag[i] = psreader->t_eflag[i];
+
+      if (PS_IS_NEW_VERTEX(psreader->t_vflag[i]))
+      {
+        triangle->vdata[i] = allocScratch(&vertex_scratch);
+        psreader->set_vdata(triangle->vdata[i], i);
+      }
+      else
+      {
+        triangle->vdata[i] = (char*)psreader->get_vdata(i);
+      }
+      if (PS_IS_FINALIZED_VERTEX(psreader->t_vflag[i]))
+      {
+        batch->vertex_release[batch->vertex_release_number++] = triangle->vdata[i];
+      }
+
+      if (PS_IS_ENTERING_EDGE(psreader->t_eflag[i]))
+      {
+        triangle->edata[i] = allocScratch(&edge_scratch);
+        psreader->set_edata(triangle->edata[i], i);
+      }
+      else if (PS_IS_LEAVING_EDGE(psreader->t_eflag[i]))
+      {
+        triangle->edata[i] = (char*)psreader->get_edata(i);
+        batch->edge_release[batch->edge_release_number++] = triangle->edata[i];
+      }
+      else
+      {
+        triangle->edata[i] = 0;
+      }
+    }
+    batch->number++;
+  }
+  return true;
+}
+
+// the threads that run the kernels. thread t runs every threads_number-th
+// kernel starting with kernel t.
+
+static int threads_number = 0;
+static PSbatch* threads_batch = 0;
+static bool threads_quit = false;
+
+#ifdef _WIN32
+static HANDLE threads_start[PS_ANALYZE_MAX_THREADS];
+static HANDLE threads_done;
+#else
+static sem_t threads_start[PS_ANALYZE_MAX_THREADS];
+static sem_t threads_done;
+#endif
+
+#ifdef _WIN32
+static unsigned __stdcall run_kernels(void* arg)
+#else
+static void* run_kernels(void* arg)
+#endif
+{
+  int t = (int)(size_t)arg;
+  while (true)
+  {
+#ifdef _WIN32
+    WaitForSingleObject(threads_start[t], INFINITE);
+#else
+    sem_wait(&(threads_start[t]));
+#endif
+    if (threads_quit)
+    {
+      break;
+    }
+    for (int k = t; k < kernels_number; k += threads_number)
+    {
+      kernels[k]->process(threads_batch->triangles, threads_batch->number);
+    }
+#ifdef _WIN32
+    ReleaseSemaphore(threads_done, 1, 0);
+#else
+    sem_post(&threads_done);
+#endif
+  }
+  return 0;
+}
+
+static void start_batch(PSbatch* batch)
+{
+  threads_batch = batch;
+  for (int t = 0; t < threads_number; t++)
+  {
+#ifdef _WIN32
+    ReleaseSemaphore(threads_start[t], 1, 0);
+#else
+    sem_post(&(threads_start[t]));
+#endif
+  }
+}
+
+static void finish_batch()
+{
+  for (int t = 0; t < threads_number; t++)
+  {
+#ifdef _WIN32
+    WaitForSingleObject(threads_done, INFINITE);
+#else
+    sem_wait(&threads_done);
+#endif
+  }
+}
+
+static bool start_threads()
+{
+  int t;
+#ifdef _WIN32
+  threads_done = CreateSemaphore(0, 0, PS_ANALYZE_MAX_THREADS, 0);
+  for (t = 0; t < threads_number; t++)
+  {
+    threads_start[t] = CreateSemaphore(0, 0, 1, 0);
+    HANDLE thread = (HANDLE)_beginthreadex(0, 0, run_kernels, (void*)(size_t)t, 0, 0);
+    if (thread == 0)
+    {
+      fprintf(stderr,"ERROR: cannot start thread %d\n", t);
+      return false;
+    }
+    CloseHandle(thread);
+  }
+#else
+  sem_init(&threads_done, 0, 0);
+  for (t = 0; t < threads_number; t++)
+  {
+    pthread_t thread;
+    sem_init(&(threads_start[t]), 0, 0);
+    if (pthread_create(&thread, 0, run_kernels, (void*)(size_t)t) != 0)
+    {
+      fprintf(stderr,"ERROR: cannot start thread %d\n", t);
+      return false;
+    }
+    pthread_detach(thread);
+  }
+#endif
+  return true;
+}
+
+static void stop_threads()
+{
+  threads_quit = true;
+  start_batch(0);
+}
+
+static const char* all_kernels[] = {"bounding_box", "area", "crease_angles", "normals", "stream", "topology", 0};
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"ps_analyze mesh.smc\n");
+  fprintf(stderr,"ps_analyze mesh.smb -o report.json\n");
+  fprintf(stderr,"ps_analyze mesh.smc -threads 4 -o report.json\n");
+  fprintf(stderr,"ps_analyze mesh.sma -kernels area,crease_angles\n");
+  fprintf(stderr,"ps_analyze -synthetic terrain,1024,1024 -trace trace.json\n");
+  fprintf(stderr,"ps_analyze -h\n");
+  fprintf(stderr,"kernels:");
+  for (int k = 0; all_kernels[k]; k++) fprintf(stderr," %s", all_kernels[k]);
+  fprintf(stderr,"\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int i, k;
+  char* file_name = 0;
+  char* file_name_out = 0;
+  char* file_name_trace = 0;
+  char* synthetic = 0;
+  char* kernel_names = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-h") == 0)
+    {
+      usage();
+    }
+    else if (strcmp(argv[i],"-i") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name = argv[i];
+    }
+    else if (strcmp(argv[i],"-o") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name_out = argv[i];
+    }
+    else if (strcmp(argv[i],"-kernels") == 0 && i+1 < argc)
+    {
+      i++;
+      kernel_names = argv[i];
+    }
+    else if (strcmp(argv[i],"-threads") == 0 && i+1 < argc)
+    {
+      i++;
+      threads_number = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-trace") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name_trace = argv[i];
+    }
+    else if (strcmp(argv[i],"-synthetic") == 0 && i+1 < argc)
+    {
+      i++;
+      synthetic = argv[i];
+    }
+    else if (file_name == 0 && argv[i][0] != '-')
+    {
+      file_name = argv[i];
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (file_name == 0 && synthetic == 0)
+  {
+    usage();
+  }
+
+  // register the kernels and give each its slots in the scratch records
+
+  if (kernel_names)
+  {
+    char* name = strtok(kernel_names, ",");
+    while (name)
+    {
+      if (!register_kernel(name))
+      {
+        usage();
+      }
+      name = strtok(0, ",");
+    }
+  }
+  else
+  {
+    for (k = 0; all_kernels[k]; k++)
+    {
+      register_kernel(all_kernels[k]);
+    }
+  }
+
+  int vertex_bytes = 0;
+  int edge_bytes = 0;
+  for (k = 0; k < kernels_number; k++)
+  {
+    kernels[k]->vertex_offset = vertex_bytes;
+    vertex_bytes += (kernels[k]->vertex_bytes + 3) & ~3;
+    kernels[k]->edge_offset = edge_bytes;
+    edge_bytes += (kernels[k]->edge_bytes + 3) & ~3;
+  }
+  initScratch(&vertex_scratch, vertex_bytes);
+  initScratch(&edge_scratch, edge_bytes);
+
+  if (threads_number > kernels_number) threads_number = kernels_number;
+  if (threads_number > PS_ANALYZE_MAX_THREADS) threads_number = PS_ANALYZE_MAX_THREADS;
+  if (threads_number < 0) threads_number = 0;
+
+  if (file_name_trace)
+  {
+    sm_trace_open(file_name_trace);
+  }
+
+  PSreader* psreader = 0;
+
+  if (synthetic)
+  {
+    SMreader_synthetic* smreader_synthetic = new SMreader_synthetic();
+    if (!smreader_synthetic->open(synthetic))
+    {
+      exit(1);
+    }
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_synthetic, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".sma") || strstr(file_name, ".obj") || strstr(file_name, ".smf"))
+  {
+    FILE* file = fopen(file_name, "r");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name);
+      exit(1);
+    }
+    SMreader_sma* smreader_sma = new SMreader_sma();
+    smreader_sma->open(file);
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_sma, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".smc") || strstr(file_name, ".sme"))
+  {
+    FILE* file = fopen(file_name, "rb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name);
+      exit(1);
+    }
+    SMreader_smc* smreader_smc = new SMreader_smc();
+    smreader_smc->open(file);
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_smc, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".smb"))
+  {
+    FILE* file = fopen(file_name, "rb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name);
+      exit(1);
+    }
+    SMreader_smb* smreader_smb = new SMreader_smb();
+    smreader_smb->open(file);
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_smb, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, "_compressed") || strstr(file_name, "depthfirst") || strstr(file_name, "depth_first"))
+  {
+    PSreader_oocc* psreader_oocc = new PSreader_oocc();
+    psreader_oocc->open(file_name);
+    psreader = psreader_oocc;
+  }
+  else if (strstr(file_name, "_lowspan") || strstr(file_name, "breadthfirst") || strstr(file_name, "breadth_first"))
+  {
+    PSreader_lowspan* psreader_lowspan = new PSreader_lowspan();
+    psreader_lowspan->open(file_name);
+    psreader = psreader_lowspan;
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: cannot guess input type from file name\n");
+    exit(1);
+  }
+
+  if (threads_number && !start_threads())
+  {
+    exit(1);
+  }
+
+  // while the threads process one batch the reader fills the other
+
+  PSbatch* batches[2];
+  batches[0] = (PSbatch*)malloc(sizeof(PSbatch));
+  batches[1] = (PSbatch*)malloc(sizeof(PSbatch));
+  if (batches[0] == 0 || batches[1] == 0)
+  {
+    fprintf(stderr,"ERROR: malloc for batches failed\n");
+    exit(1);
+  }
+  batches[0]->number = batches[0]->vertex_release_number = batches[0]->edge_release_number = 0;
+  batches[1]->number = batches[1]->vertex_release_number = batches[1]->edge_release_number = 0;
+
+  int b = 0;
+  bool more = true;
+  bool busy = false;
+
+  while (more)
+  {
+    more = fill_batch(psreader, batches[b]);
+    if (busy)
+    {
+      finish_batch();
+      release_batch(batches[1-b]);
+      busy = false;
+    }
+    if (batches[b]->number)
+    {
+      if (threads_number)
+      {
+        start_batch(batches[b]);
+        busy = true;
+      }
+      else
+      {
+        for (k = 0; k < kernels_number; k++)
+        {
+          kernels[k]->process(batches[b]->triangles, batches[b]->number);
+        }
+        release_batch(batches[b]);
+      }
+    }
+    b = 1-b;
+  }
+  if (busy)
+  {
+    finish_batch();
+    release_batch(batches[1-b]);
+  }
+  if (threads_number)
+  {
+    stop_threads();
+  }
+
+  // write the report
+
+  FILE* file_out = stdout;
+  if (file_name_out)
+  {
+    file_out = fopen(file_name_out, "w");
+    if (file_out == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name_out);
+      exit(1);
+    }
+  }
+
+  fprintf(file_out, "{\n");
+  fprintf(file_out, "  \"input\": \"%s\",\n", (file_name ? file_name : synthetic));
+  fprintf(file_out, "  \"v_count\": " SM_IDX_FORMAT ",\n", psreader->v_count);
+  fprintf(file_out, "  \"f_count\": " SM_IDX_FORMAT ",\n", psreader->f_count);
+  fprintf(file_out, "  \"kernels\": {");
+  for (k = 0; k < kernels_number; k++)
+  {
+    fprintf(file_out, "%s\n", (k ? "," : ""));
+    kernels[k]->write_json(file_out, 4);
+  }
+  fprintf(file_out, "\n  }\n");
+  fprintf(file_out, "}\n");
+
+  if (file_name_out)
+  {
+    fclose(file_out);
+  }
+
+  psreader->close();
+
+  if (file_name_trace)
+  {
+    sm_trace_close();
+  }
+
+  for (k = 0; k < kernels_number; k++)
+  {
+    delete kernels[k];
+  }
+  destroyScratch(&vertex_scratch);
+  destroyScratch(&edge_scratch);
+  free(batches[0]);
+  free(batches[1]);
+
+  return 0;
+}
@@ -291,8 +291,8 @@ int main(int argc, char *argv[])
     }
   }
 
-  fprintf(stderr,"number of vertices: %d\n",psreader->nverts);
-  fprintf(stderr,"number of faces: %d\n",psreader->nfaces);
+  fprintf(stderr,"number of vertices: " SM_IDX_FORMAT "\n",psreader->nverts);
+  fprintf(stderr,"number of faces: " SM_IDX_FORMAT "\n",psreader->nfaces);
 
   psreader->close();
 
@@ -25,6 +25,9 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- added '-volume' to pipe the isosurface of a volume into the PSconverter
+    19 October 2026 -- added '-synthetic' to generate the input on the fly
+    19 October 2026 -- added '-trace' to write a Chrome trace of the pipeline
     11 September 2003 -- created initial version just after midnight 
   
 ===============================================================================
@@ -40,8 +43,12 @@
 #include "smreader_sma.h"
 #include "smreader_smb.h"
 #include "smreader_smc.h"
+#include "smreader_synthetic.h"
+#include "smreader_isosurface.h"
+#include "smpipe.h"
 
 #include "vec3fv.h"
+#include "smtrace.h"
 
 float compute_triangle_area(float* v0, float* v1, float* v2)
 {
@@ -55,24 +62,151 @@ float compute_triangle_area(float* v0, float* v1, float* v2)
   return 0.5f*VecLength3fv(v01crossv02);
 }
 
+// the producer of the SMpipe. every call writes the next few thousand
+// elements of the isosurface. with '-pipe_thread' it runs ahead of the
+// PSconverter on a thread of its own, otherwise the SMpipe calls it
+// whenever the PSconverter has read what it wrote so far.
+
+static bool produce_isosurface(SMwriter* smwriter, void* data)
+{
+  SMreader* smreader = (SMreader*)data;
+
+  if (smwriter->v_count == 0 && smwriter->f_count == 0)
+  {
+    if (smreader->bb_min_f && smreader->bb_max_f) smwriter->set_boundingbox(smreader->bb_min_f, smreader->bb_max_f);
+  }
+  for (int i = 0; i < 4096; i++)
+  {
+    switch (smreader->read_element())
+    {
+    case SM_VERTEX:
+      smwriter->write_vertex(smreader->v_pos_f);
+      break;
+    case SM_TRIANGLE:
+      smwriter->write_triangle(smreader->t_idx, smreader->t_final);
+      break;
+    case SM_FINALIZED:
+      smwriter->write_finalized(smreader->final_idx);
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
 int main(int argc, char *argv[])
 {
-  char* file_name;
+  int i;
+  char* file_name = 0;
+  char* file_name_trace = 0;
+  char* synthetic = 0;
+  char* file_name_volume = 0;
+  int volume_size[3];
+  int volume_type = SM_ISO_UCHAR;
+  float iso = 0.0f;
+  bool pipe_thread = false;
 
-  if (argc == 2)
+  for (i = 1; i < argc; i++)
   {
-    file_name = argv[1];
+    if (strcmp(argv[i],"-trace") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name_trace = argv[i];
+    }
+    else if (strcmp(argv[i],"-synthetic") == 0 && i+1 < argc)
+    {
+      i++;
+      synthetic = argv[i];
+    }
+    else if (strcmp(argv[i],"-volume") == 0 && i+5 < argc)
+    {
+      file_name_volume = argv[i+1];
+      volume_size[0] = atoi(argv[i+2]);
+      volume_size[1] = atoi(argv[i+3]);
+      volume_size[2] = atoi(argv[i+4]);
+      if (strcmp(argv[i+5],"ushort") == 0) volume_type = SM_ISO_USHORT;
+      else if (strcmp(argv[i+5],"float") == 0) volume_type = SM_ISO_FLOAT;
+      else volume_type = SM_ISO_UCHAR;
+      i+=5;
+    }
+    else if (strcmp(argv[i],"-iso") == 0 && i+1 < argc)
+    {
+      i++;
+      iso = (float)atof(argv[i]);
+    }
+    else if (strcmp(argv[i],"-pipe_thread") == 0)
+    {
+      pipe_thread = true;
+    }
+    else if (file_name == 0 && argv[i][0] != '-')
+    {
+      file_name = argv[i];
+    }
+    else
+    {
+      file_name = 0;
+      synthetic = 0;
+      file_name_volume = 0;
+      break;
+    }
   }
-  else
+
+  if (file_name == 0 && synthetic == 0 && file_name_volume == 0)
   {
     fprintf(stderr,"usage:\n");
     fprintf(stderr,"ps_area <file_name>\n");
+    fprintf(stderr,"ps_area <file_name> -trace trace.json\n");
+    fprintf(stderr,"ps_area -synthetic torus,1024,500000\n");
+    fprintf(stderr,"ps_area -volume head.raw 256 256 225 uchar -iso 80\n");
+    fprintf(stderr,"ps_area -volume ct.raw 512 512 1000 ushort -iso 1200 -pipe_thread\n");
     exit(1);
   }
 
+  if (file_name_trace)
+  {
+    sm_trace_open(file_name_trace);
+  }
+
   PSreader* psreader = 0;
+  FILE* file_volume = 0;
+  SMreader_isosurface* smreader_isosurface = 0;
+  SMpipe* smpipe = 0;
 
-  if (strstr(file_name, ".sma") || strstr(file_name, ".obj") || strstr(file_name, ".smf"))
+  if (file_name_volume)
+  {
+    file_volume = fopen(file_name_volume, "rb");
+    if (file_volume == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name_volume);
+      exit(1);
+    }
+    smreader_isosurface = new SMreader_isosurface();
+    if (!smreader_isosurface->open(file_volume, volume_type, volume_size[0], volume_size[1], volume_size[2], iso))
+    {
+      exit(1);
+    }
+    smpipe = new SMpipe();
+    if (!smpipe->open(produce_isosurface, smreader_isosurface, pipe_thread))
+    {
+      exit(1);
+    }
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smpipe, 256, 512);
+    psreader = psconverter;
+  }
+  else if (synthetic)
+  {
+    SMreader_synthetic* smreader_synthetic = new SMreader_synthetic();
+    if (!smreader_synthetic->open(synthetic))
+    {
+      exit(1);
+    }
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_synthetic, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".sma") || strstr(file_name, ".obj") || strstr(file_name, ".smf"))
   {
     FILE* sma_fp = fopen(file_name, "r");
     if (sma_fp == 0)
@@ -143,12 +277,30 @@ int main(int argc, char *argv[])
     total_area += area;
   }
 
-  fprintf(stderr,"v_count %d \n",psreader->v_count);
-  fprintf(stderr,"f_count %d \n",psreader->f_count);
+  fprintf(stderr,"v_count " SM_IDX_FORMAT " \n",psreader->v_count);
+  fprintf(stderr,"f_count " SM_IDX_FORMAT " \n",psreader->f_count);
 
   fprintf(stderr,"total_area %f\n",total_area);
 
   psreader->close();
 
+  if (smpipe)
+  {
+    if (pipe_thread)
+    {
+      fprintf(stderr,"pipe: producer waited %d times and reader %d times\n", smpipe->get_producer_waits(), smpipe->get_reader_waits());
+    }
+    smpipe->close();
+    delete smpipe;
+    smreader_isosurface->close();
+    delete smreader_isosurface;
+    fclose(file_volume);
+  }
+
+  if (file_name_trace)
+  {
+    sm_trace_close();
+  }
+
   return 1;
 }
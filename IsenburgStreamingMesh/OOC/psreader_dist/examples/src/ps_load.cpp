@@ -145,8 +145,8 @@ int main(int argc, char *argv[])
   }
   else
   {
-    fprintf(stderr,"nverts %d\n",psreader->nverts);
-    vertices_alloced = psreader->nverts;
+    fprintf(stderr,"nverts " SM_IDX_FORMAT "\n",psreader->nverts);
+    vertices_alloced = (int)psreader->nverts;
   }
   vertices = allocVertices(0, vertices_alloced);
 
@@ -156,8 +156,8 @@ int main(int argc, char *argv[])
   }
   else
   {
-    fprintf(stderr,"nfaces %d\n",psreader->nfaces);
-    faces_alloced = psreader->nfaces;
+    fprintf(stderr,"nfaces " SM_IDX_FORMAT "\n",psreader->nfaces);
+    faces_alloced = (int)psreader->nfaces;
   }
   faces = allocFaces(0, faces_alloced);
 
@@ -173,7 +173,9 @@ int main(int argc, char *argv[])
     }
 
     // copy new face into memory
-    VecCopy3iv(&(faces[faces_number*3]), psreader->t_idx);
+    faces[faces_number*3+0] = (int)psreader->t_idx[0];
+    faces[faces_number*3+1] = (int)psreader->t_idx[1];
+    faces[faces_number*3+2] = (int)psreader->t_idx[2];
     faces_number++;
 
     for (i = 0; i < 3; i++)
@@ -195,8 +197,8 @@ int main(int argc, char *argv[])
     }
   }
 
-  fprintf(stderr,"vertex counters: %d %d %d (should be equal)\n",vertices_number,psreader->v_count,psreader->nverts);
-  fprintf(stderr,"face counters: %d %d %d (should be equal)\n",faces_number,psreader->f_count,psreader->nfaces);
+  fprintf(stderr,"vertex counters: %d " SM_IDX_FORMAT " " SM_IDX_FORMAT " (should be equal)\n",vertices_number,psreader->v_count,psreader->nverts);
+  fprintf(stderr,"face counters: %d " SM_IDX_FORMAT " " SM_IDX_FORMAT " (should be equal)\n",faces_number,psreader->f_count,psreader->nfaces);
 
   psreader->close();
 
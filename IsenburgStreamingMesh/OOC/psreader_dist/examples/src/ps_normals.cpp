@@ -15,6 +15,7 @@
     
     (*) Note that this would require us to temporarily buffer triangles until
     the computation of smooth normal was completed for all three vertices.
+    For Streaming Meshes the SMreadNormals filter of the library does that.
   
   PROGRAMMERS:
   
@@ -30,6 +31,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- pointing to SMreadNormals for actually using the normals
     11 September 2003 -- created initial version just after midnight 
   
 ===============================================================================
@@ -239,8 +241,8 @@ int main(int argc, char *argv[])
     }
   }
 
-  fprintf(stderr,"number of vertices: %d\n",psreader->nverts);
-  fprintf(stderr,"number of faces: %d\n",psreader->nfaces);
+  fprintf(stderr,"number of vertices: " SM_IDX_FORMAT "\n",psreader->nverts);
+  fprintf(stderr,"number of faces: " SM_IDX_FORMAT "\n",psreader->nfaces);
 
   psreader->close();
 
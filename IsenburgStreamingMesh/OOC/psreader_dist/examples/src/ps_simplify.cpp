@@ -0,0 +1,985 @@
+/*
+===============================================================================
+
+  FILE:  ps_simplify.cpp
+
+  CONTENTS:
+
+    This program simplifies a mesh with quadric-based edge collapses as it
+    streams through the processing sequence as described in "Large Mesh
+    Simplification using Processing Sequences" (see ../../LMSPS). It uses
+    the Processing Sequence API and writes the result with an SMwriter.
+
+    Triangles are read into a buffer of fixed size. Once the buffer is full,
+    the edges in the buffer are collapsed in the order of their quadric error
+    until the triangles read so far are reduced to the requested fraction.
+    Then the oldest triangles are written out until the buffer is half empty.
+    This way the memory is proportional to the size of the buffer and not to
+    the size of the mesh.
+
+    Only edges between two finalized vertices (e.g. all their triangles are
+    in the buffer) whose triangles were not yet written are collapsed. Thus
+    the input boundary (where the mesh still grows) and the output boundary
+    (where it was already written) are never touched. Vertices on a border,
+    around a non-manifold, or around a not-oriented edge are kept. Collapses
+    that would fold over triangles or make the mesh non-manifold are skipped.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to finally implement the paper in LMSPS
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "psreader_oocc.h"
+#include "psreader_lowspan.h"
+#include "psconverter.h"
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smreader_synthetic.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+
+#include "vec3fv.h"
+
+struct PStriangle;
+
+typedef struct PSvertex
+{
+  PSvertex* buffer_next;        // used for efficient memory management
+  float v[3];
+  double q[10];                 // the quadric as A (6), b (3), and c (1)
+  int stamp;                    // changes whenever the vertex changes or dies
+  int index;                    // the index in the output (-1 if not yet written)
+  bool finalized;               // all its triangles were read
+  bool locked;                  // it must not be collapsed
+  int number;                   // how many of its triangles are in the buffer
+  PStriangle* first_triangle;   // its triangles are linked through their corners
+  int first_corner;
+} PSvertex;
+
+typedef struct PStriangle
+{
+  PStriangle* buffer_next;      // used for efficient memory management
+  PStriangle* older;            // the triangles in the buffer in the order they were read
+  PStriangle* newer;
+  PSvertex* vertices[3];
+  PStriangle* next_triangle[3]; // the next triangle around vertices[i]
+  int next_corner[3];
+} PStriangle;
+
+typedef struct PScollapse
+{
+  double cost;
+  PSvertex* u;                  // is removed
+  PSvertex* v;                  // is moved to pos
+  int u_stamp;
+  int v_stamp;
+  float pos[3];
+} PScollapse;
+
+static int stamp = 0;
+
+// the triangles in the buffer
+
+static PStriangle* oldest = 0;
+static PStriangle* newest = 0;
+static int buffer_triangles = 0;
+static int buffer_vertices = 0;
+static int max_buffer_triangles = 0;
+static int max_buffer_vertices = 0;
+
+// efficient memory allocation for vertices
+
+static int vertex_buffer_alloc = 1024;
+static PSvertex* vertex_buffer_next = 0;
+
+static PSvertex* allocVertex()
+{
+  if (vertex_buffer_next == 0)
+  {
+    vertex_buffer_next = (PSvertex*)malloc(sizeof(PSvertex)*vertex_buffer_alloc);
+    if (vertex_buffer_next == 0)
+    {
+      fprintf(stderr,"malloc for vertex buffer failed\n");
+      return 0;
+    }
+    for (int i = 0; i < vertex_buffer_alloc; i++)
+    {
+      vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
+      vertex_buffer_next[i].stamp = 0;
+    }
+    vertex_buffer_next[vertex_buffer_alloc-1].buffer_next = 0;
+    vertex_buffer_alloc = 2*vertex_buffer_alloc;
+  }
+  // get pointer to next available vertex
+  PSvertex* vertex = vertex_buffer_next;
+  vertex_buffer_next = vertex->buffer_next;
+
+  memset(vertex->q, 0, sizeof(double)*10);
+  vertex->stamp = ++stamp;
+  vertex->index = -1;
+  vertex->finalized = false;
+  vertex->locked = false;
+  vertex->number = 0;
+  vertex->first_triangle = 0;
+
+  buffer_vertices++;
+  if (buffer_vertices > max_buffer_vertices) max_buffer_vertices = buffer_vertices;
+
+  return vertex;
+}
+
+static void deallocVertex(PSvertex* vertex)
+{
+  // the free list is never given back so stale collapses can still look at the stamp
+  vertex->stamp = ++stamp;
+  vertex->buffer_next = vertex_buffer_next;
+  vertex_buffer_next = vertex;
+  buffer_vertices--;
+}
+
+// efficient memory allocation for triangles
+
+static int triangle_buffer_alloc = 1024;
+static PStriangle* triangle_buffer_next = 0;
+
+static PStriangle* allocTriangle()
+{
+  if (triangle_buffer_next == 0)
+  {
+    triangle_buffer_next = (PStriangle*)malloc(sizeof(PStriangle)*triangle_buffer_alloc);
+    if (triangle_buffer_next == 0)
+    {
+      fprintf(stderr,"malloc for triangle buffer failed\n");
+      return 0;
+    }
+    for (int i = 0; i < triangle_buffer_alloc; i++)
+    {
+      triangle_buffer_next[i].buffer_next = &(triangle_buffer_next[i+1]);
+    }
+    triangle_buffer_next[triangle_buffer_alloc-1].buffer_next = 0;
+    triangle_buffer_alloc = 2*triangle_buffer_alloc;
+  }
+  // get pointer to next available triangle
+  PStriangle* triangle = triangle_buffer_next;
+  triangle_buffer_next = triangle->buffer_next;
+
+  // the newest triangle in the buffer
+  triangle->newer = 0;
+  triangle->older = newest;
+  if (newest)
+  {
+    newest->newer = triangle;
+  }
+  else
+  {
+    oldest = triangle;
+  }
+  newest = triangle;
+
+  buffer_triangles++;
+  if (buffer_triangles > max_buffer_triangles) max_buffer_triangles = buffer_triangles;
+
+  return triangle;
+}
+
+static void deallocTriangle(PStriangle* triangle)
+{
+  if (triangle->older)
+  {
+    triangle->older->newer = triangle->newer;
+  }
+  else
+  {
+    oldest = triangle->newer;
+  }
+  if (triangle->newer)
+  {
+    triangle->newer->older = triangle->older;
+  }
+  else
+  {
+    newest = triangle->older;
+  }
+  triangle->buffer_next = triangle_buffer_next;
+  triangle_buffer_next = triangle;
+  buffer_triangles--;
+}
+
+// the corners of a vertex
+
+static void linkCorner(PStriangle* triangle, int corner)
+{
+  PSvertex* vertex = triangle->vertices[corner];
+  triangle->next_triangle[corner] = vertex->first_triangle;
+  triangle->next_corner[corner] = vertex->first_corner;
+  vertex->first_triangle = triangle;
+  vertex->first_corner = corner;
+  vertex->number++;
+}
+
+static void unlinkCorner(PStriangle* triangle, int corner)
+{
+  PSvertex* vertex = triangle->vertices[corner];
+  if (vertex->first_triangle == triangle && vertex->first_corner == corner)
+  {
+    vertex->first_triangle = triangle->next_triangle[corner];
+    vertex->first_corner = triangle->next_corner[corner];
+  }
+  else
+  {
+    PStriangle* prev_triangle = vertex->first_triangle;
+    int prev_corner = vertex->first_corner;
+    while (prev_triangle->next_triangle[prev_corner] != triangle || prev_triangle->next_corner[prev_corner] != corner)
+    {
+      PStriangle* next_triangle = prev_triangle->next_triangle[prev_corner];
+      prev_corner = prev_triangle->next_corner[prev_corner];
+      prev_triangle = next_triangle;
+    }
+    prev_triangle->next_triangle[prev_corner] = triangle->next_triangle[corner];
+    prev_triangle->next_corner[prev_corner] = triangle->next_corner[corner];
+  }
+  vertex->number--;
+}
+
+// quadrics
+
+static void addPlaneQuadric(PStriangle* triangle)
+{
+  float normal[3];
+  VecCcwNormal3fv(normal, triangle->vertices[0]->v, triangle->vertices[1]->v, triangle->vertices[2]->v);
+  double length = VecLength3fv(normal);
+  if (length > 0.0)
+  {
+    double area = 0.5*length;
+    double n[3] = {normal[0]/length, normal[1]/length, normal[2]/length};
+    const float* p = triangle->vertices[0]->v;
+    double d = -(n[0]*p[0] + n[1]*p[1] + n[2]*p[2]);
+    for (int i = 0; i < 3; i++)
+    {
+      double* q = triangle->vertices[i]->q;
+      q[0] += area*n[0]*n[0]; q[1] += area*n[0]*n[1]; q[2] += area*n[0]*n[2];
+      q[3] += area*n[1]*n[1]; q[4] += area*n[1]*n[2]; q[5] += area*n[2]*n[2];
+      q[6] -= area*d*n[0]; q[7] -= area*d*n[1]; q[8] -= area*d*n[2];
+      q[9] += area*d*d;
+    }
+  }
+}
+
+static double evaluateQuadric(const double* q, const double* x)
+{
+  return q[0]*x[0]*x[0] + 2*q[1]*x[0]*x[1] + 2*q[2]*x[0]*x[2] + q[3]*x[1]*x[1] + 2*q[4]*x[1]*x[2] + q[5]*x[2]*x[2] - 2*(q[6]*x[0] + q[7]*x[1] + q[8]*x[2]) + q[9];
+}
+
+// the position that minimizes the combined quadric or, if that is not well
+// defined, the best of the two end points and the midpoint
+
+static double placeCollapse(const PSvertex* u, const PSvertex* v, float* pos)
+{
+  int i;
+  double q[10];
+  for (i = 0; i < 10; i++)
+  {
+    q[i] = u->q[i] + v->q[i];
+  }
+
+  double det = q[0]*(q[3]*q[5]-q[4]*q[4]) - q[1]*(q[1]*q[5]-q[4]*q[2]) + q[2]*(q[1]*q[4]-q[3]*q[2]);
+  double trace = q[0] + q[3] + q[5];
+  double x[3];
+
+  if (trace > 0.0 && fabs(det) > 1e-6*trace*trace*trace)
+  {
+    x[0] = (q[6]*(q[3]*q[5]-q[4]*q[4]) - q[1]*(q[7]*q[5]-q[4]*q[8]) + q[2]*(q[7]*q[4]-q[3]*q[8])) / det;
+    x[1] = (q[0]*(q[7]*q[5]-q[8]*q[4]) - q[6]*(q[1]*q[5]-q[4]*q[2]) + q[2]*(q[1]*q[8]-q[7]*q[2])) / det;
+    x[2] = (q[0]*(q[3]*q[8]-q[4]*q[7]) - q[1]*(q[1]*q[8]-q[7]*q[2]) + q[6]*(q[1]*q[4]-q[3]*q[2])) / det;
+    for (i = 0; i < 3; i++) pos[i] = (float)x[i];
+    return evaluateQuadric(q, x);
+  }
+
+  double best = 0.0;
+  for (int k = 0; k < 3; k++)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      x[i] = (k == 0 ? u->v[i] : (k == 1 ? v->v[i] : 0.5*(u->v[i] + v->v[i])));
+    }
+    double cost = evaluateQuadric(q, x);
+    if (k == 0 || cost < best)
+    {
+      best = cost;
+      for (i = 0; i < 3; i++) pos[i] = (float)x[i];
+    }
+  }
+  return best;
+}
+
+// the priority queue of collapses is a binary heap. entries whose vertices
+// changed since are recognized by their stamps and skipped.
+
+static PScollapse* heap = 0;
+static int heap_size = 0;
+static int heap_alloc = 0;
+
+static void pushCollapse(PSvertex* u, PSvertex* v, const float* bb_min, const float* bb_max)
+{
+  if (heap_size == heap_alloc)
+  {
+    heap_alloc = (heap_alloc ? 2*heap_alloc : 1024);
+    heap = (PScollapse*)realloc(heap, sizeof(PScollapse)*heap_alloc);
+    if (heap == 0)
+    {
+      fprintf(stderr,"FATAL ERROR: realloc for heap with %d failed.\n", heap_alloc);
+      exit(1);
+    }
+  }
+  PScollapse collapse;
+  collapse.cost = placeCollapse(u, v, collapse.pos);
+  if (bb_min && bb_max)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      if (collapse.pos[i] < bb_min[i]) collapse.pos[i] = bb_min[i];
+      else if (collapse.pos[i] > bb_max[i]) collapse.pos[i] = bb_max[i];
+    }
+  }
+  collapse.u = u;
+  collapse.v = v;
+  collapse.u_stamp = u->stamp;
+  collapse.v_stamp = v->stamp;
+
+  int i = heap_size++;
+  while (i > 0 && heap[(i-1)/2].cost > collapse.cost)
+  {
+    heap[i] = heap[(i-1)/2];
+    i = (i-1)/2;
+  }
+  heap[i] = collapse;
+}
+
+static void popCollapse(PScollapse* collapse)
+{
+  *collapse = heap[0];
+  heap_size--;
+  PScollapse last = heap[heap_size];
+  int i = 0;
+  while (2*i+1 < heap_size)
+  {
+    int c = 2*i+1;
+    if (c+1 < heap_size && heap[c+1].cost < heap[c].cost) c++;
+    if (heap[c].cost >= last.cost) break;
+    heap[i] = heap[c];
+    i = c;
+  }
+  heap[i] = last;
+}
+
+// a scratch list of the triangles and neighbors around a vertex
+
+static PStriangle** ring_triangles = 0;
+static int* ring_corners = 0;
+static PSvertex** ring_neighbors = 0;
+static int ring_alloc = 0;
+
+static int gatherRing(PSvertex* vertex, int* nneighbors)
+{
+  if (2*vertex->number > ring_alloc)
+  {
+    ring_alloc = 2*vertex->number + 64;
+    ring_triangles = (PStriangle**)realloc(ring_triangles, sizeof(PStriangle*)*ring_alloc);
+    ring_corners = (int*)realloc(ring_corners, sizeof(int)*ring_alloc);
+    ring_neighbors = (PSvertex**)realloc(ring_neighbors, sizeof(PSvertex*)*ring_alloc);
+  }
+  int n = 0;
+  int m = 0;
+  PStriangle* triangle = vertex->first_triangle;
+  int corner = vertex->first_corner;
+  while (triangle)
+  {
+    ring_triangles[n] = triangle;
+    ring_corners[n] = corner;
+    n++;
+    for (int k = 1; k < 3; k++)
+    {
+      PSvertex* neighbor = triangle->vertices[(corner+k)%3];
+      int j;
+      for (j = 0; j < m; j++) if (ring_neighbors[j] == neighbor) break;
+      if (j == m) ring_neighbors[m++] = neighbor;
+    }
+    PStriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+  *nneighbors = m;
+  return n;
+}
+
+static inline bool isCollapsible(const PSvertex* vertex)
+{
+  return vertex->finalized && !vertex->locked && vertex->index == -1;
+}
+
+// checks whether the triangles around 'vertex' that do not contain 'other'
+// would flip when 'vertex' moves to 'pos'
+
+static bool foldsOver(PSvertex* vertex, PSvertex* other, const float* pos)
+{
+  float before[3], after[3];
+  const float* p[3];
+  PStriangle* triangle = vertex->first_triangle;
+  int corner = vertex->first_corner;
+  while (triangle)
+  {
+    if (triangle->vertices[0] != other && triangle->vertices[1] != other && triangle->vertices[2] != other)
+    {
+      VecCcwNormal3fv(before, triangle->vertices[0]->v, triangle->vertices[1]->v, triangle->vertices[2]->v);
+      for (int k = 0; k < 3; k++) p[k] = (k == corner ? pos : triangle->vertices[k]->v);
+      VecCcwNormal3fv(after, p[0], p[1], p[2]);
+      if (VecDotProd3fv(before, after) <= 0.0f)
+      {
+        return true;
+      }
+    }
+    PStriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+  return false;
+}
+
+// collapses u into v at pos if this keeps the mesh manifold and does not
+// fold over any triangles. returns the number of removed triangles.
+
+static int collapseEdge(PSvertex* u, PSvertex* v, const float* pos, const float* bb_min, const float* bb_max)
+{
+  int i, j, k;
+  int u_neighbors, v_neighbors;
+
+  if (!isCollapsible(u) || !isCollapsible(v))
+  {
+    return 0;
+  }
+
+  // both must be closed fans (as many neighbors as triangles)
+  int v_triangles = gatherRing(v, &v_neighbors);
+  if (v_neighbors != v_triangles)
+  {
+    return 0;
+  }
+  PSvertex* v_ring[64];
+  if (v_neighbors > 64)
+  {
+    return 0;
+  }
+  for (i = 0; i < v_neighbors; i++) v_ring[i] = ring_neighbors[i];
+
+  int u_triangles = gatherRing(u, &u_neighbors);
+  if (u_neighbors != u_triangles)
+  {
+    return 0;
+  }
+
+  // the edge must have two triangles whose third vertices were not written
+  int shared = 0;
+  for (i = 0; i < u_triangles; i++)
+  {
+    PStriangle* triangle = ring_triangles[i];
+    int corner = ring_corners[i];
+    if (triangle->vertices[(corner+1)%3] == v || triangle->vertices[(corner+2)%3] == v)
+    {
+      PSvertex* w = triangle->vertices[(corner+1)%3] == v ? triangle->vertices[(corner+2)%3] : triangle->vertices[(corner+1)%3];
+      if (w->index != -1)
+      {
+        return 0;
+      }
+      shared++;
+    }
+  }
+  if (shared != 2)
+  {
+    return 0;
+  }
+
+  // the link condition: u and v share no neighbors other than the two third vertices
+  int common = 0;
+  for (i = 0; i < u_neighbors; i++)
+  {
+    for (j = 0; j < v_neighbors; j++)
+    {
+      if (ring_neighbors[i] == v_ring[j]) common++;
+    }
+  }
+  if (common != 2)
+  {
+    return 0;
+  }
+
+  if (foldsOver(u, v, pos) || foldsOver(v, u, pos))
+  {
+    return 0;
+  }
+
+  // remove the two triangles of the edge and move the others from u to v
+  int removed = 0;
+  for (i = 0; i < u_triangles; i++)
+  {
+    PStriangle* triangle = ring_triangles[i];
+    int corner = ring_corners[i];
+    if (triangle->vertices[(corner+1)%3] == v || triangle->vertices[(corner+2)%3] == v)
+    {
+      for (k = 0; k < 3; k++)
+      {
+        unlinkCorner(triangle, k);
+      }
+      for (k = 0; k < 3; k++)
+      {
+        PSvertex* w = triangle->vertices[k];
+        if (w != u && w != v && w->number == 0 && w->finalized)
+        {
+          deallocVertex(w);
+        }
+      }
+      deallocTriangle(triangle);
+      ring_triangles[i] = 0;
+      removed++;
+    }
+  }
+  for (i = 0; i < u_triangles; i++)
+  {
+    PStriangle* triangle = ring_triangles[i];
+    int corner = ring_corners[i];
+    if (triangle)
+    {
+      unlinkCorner(triangle, corner);
+      triangle->vertices[corner] = v;
+      linkCorner(triangle, corner);
+    }
+  }
+
+  for (i = 0; i < 10; i++)
+  {
+    v->q[i] += u->q[i];
+  }
+  VecCopy3fv(v->v, pos);
+  v->stamp = ++stamp;
+  deallocVertex(u);
+
+  // new collapses for the moved vertex
+  gatherRing(v, &v_neighbors);
+  for (i = 0; i < v_neighbors; i++)
+  {
+    if (isCollapsible(ring_neighbors[i]))
+    {
+      pushCollapse(v, ring_neighbors[i], bb_min, bb_max);
+    }
+  }
+  return removed;
+}
+
+// collapses edges in the order of their error until at most 'target'
+// triangles are left in the buffer
+
+static int simplifyBuffer(int target, const float* bb_min, const float* bb_max)
+{
+  int collapses = 0;
+  heap_size = 0;
+  if (buffer_triangles <= target)
+  {
+    return 0;
+  }
+  // every edge between two collapsible vertices once
+  for (PStriangle* triangle = oldest; triangle; triangle = triangle->newer)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      PSvertex* u = triangle->vertices[i];
+      PSvertex* v = triangle->vertices[(i+1)%3];
+      if (u < v && isCollapsible(u) && isCollapsible(v))
+      {
+        pushCollapse(u, v, bb_min, bb_max);
+      }
+    }
+  }
+  PScollapse collapse;
+  while (buffer_triangles > target && heap_size)
+  {
+    popCollapse(&collapse);
+    if (collapse.u->stamp != collapse.u_stamp || collapse.v->stamp != collapse.v_stamp)
+    {
+      continue;
+    }
+    if (collapseEdge(collapse.u, collapse.v, collapse.pos, bb_min, bb_max))
+    {
+      collapses++;
+    }
+  }
+  return collapses;
+}
+
+// writes the oldest triangle in the buffer. a vertex is finalized in the
+// output with its last triangle.
+
+static void writeOldest(SMwriter* smwriter, int* v_count, int* f_count)
+{
+  int i;
+  SMidx t_idx[3];
+  bool t_final[3];
+  PStriangle* triangle = oldest;
+
+  for (i = 0; i < 3; i++)
+  {
+    PSvertex* vertex = triangle->vertices[i];
+    if (vertex->index == -1)
+    {
+      vertex->index = *v_count;
+      (*v_count)++;
+      if (smwriter) smwriter->write_vertex(vertex->v);
+    }
+    t_idx[i] = vertex->index;
+    unlinkCorner(triangle, i);
+  }
+  for (i = 0; i < 3; i++)
+  {
+    t_final[i] = (triangle->vertices[i]->finalized && triangle->vertices[i]->number == 0);
+  }
+  if (smwriter) smwriter->write_triangle(t_idx, t_final);
+  (*f_count)++;
+  for (i = 0; i < 3; i++)
+  {
+    PSvertex* vertex = triangle->vertices[i];
+    if (t_final[i] && (i < 1 || vertex != triangle->vertices[0]) && (i < 2 || vertex != triangle->vertices[1]))
+    {
+      deallocVertex(vertex);
+    }
+  }
+  deallocTriangle(triangle);
+}
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"ps_simplify -i mesh.smc -o simple.smc -ratio 0.1\n");
+  fprintf(stderr,"ps_simplify -i mesh.smb -o simple.smb -faces 100000 -buffer 200000\n");
+  fprintf(stderr,"ps_simplify -i mesh_compressed.obj -o simple.sma -ratio 0.25\n");
+  fprintf(stderr,"ps_simplify -synthetic terrain,1024,1024 -o simple.smc -ratio 0.05 -bits 16\n");
+  fprintf(stderr,"ps_simplify -h\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int i;
+  char* file_name = 0;
+  char* file_name_out = 0;
+  char* synthetic = 0;
+  float ratio = 0.0f;
+  int faces = 0;
+  int buffer_size = 65536;
+  int bits = 16;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-h") == 0)
+    {
+      usage();
+    }
+    else if (strcmp(argv[i],"-i") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name = argv[i];
+    }
+    else if (strcmp(argv[i],"-o") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name_out = argv[i];
+    }
+    else if (strcmp(argv[i],"-ratio") == 0 && i+1 < argc)
+    {
+      i++;
+      ratio = (float)atof(argv[i]);
+    }
+    else if (strcmp(argv[i],"-faces") == 0 && i+1 < argc)
+    {
+      i++;
+      faces = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-buffer") == 0 && i+1 < argc)
+    {
+      i++;
+      buffer_size = atoi(argv[i]);
+    }
+    else if ((strcmp(argv[i],"-b") == 0 || strcmp(argv[i],"-bits") == 0) && i+1 < argc)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-synthetic") == 0 && i+1 < argc)
+    {
+      i++;
+      synthetic = argv[i];
+    }
+    else if (file_name == 0 && argv[i][0] != '-')
+    {
+      file_name = argv[i];
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if ((file_name == 0 && synthetic == 0) || (ratio <= 0.0f && faces <= 0))
+  {
+    usage();
+  }
+  if (buffer_size < 64)
+  {
+    buffer_size = 64;
+  }
+
+  PSreader* psreader = 0;
+
+  if (synthetic)
+  {
+    SMreader_synthetic* smreader_synthetic = new SMreader_synthetic();
+    if (!smreader_synthetic->open(synthetic))
+    {
+      exit(1);
+    }
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_synthetic, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".sma") || strstr(file_name, ".obj") || strstr(file_name, ".smf"))
+  {
+    FILE* file = fopen(file_name, "r");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name);
+      exit(1);
+    }
+    SMreader_sma* smreader_sma = new SMreader_sma();
+    smreader_sma->open(file);
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_sma, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".smc") || strstr(file_name, ".sme"))
+  {
+    FILE* file = fopen(file_name, "rb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name);
+      exit(1);
+    }
+    SMreader_smc* smreader_smc = new SMreader_smc();
+    smreader_smc->open(file);
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_smc, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, ".smb"))
+  {
+    FILE* file = fopen(file_name, "rb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open %s\n",file_name);
+      exit(1);
+    }
+    SMreader_smb* smreader_smb = new SMreader_smb();
+    smreader_smb->open(file);
+    PSconverter* psconverter = new PSconverter();
+    psconverter->open(smreader_smb, 256, 512);
+    psreader = psconverter;
+  }
+  else if (strstr(file_name, "_compressed") || strstr(file_name, "depthfirst") || strstr(file_name, "depth_first"))
+  {
+    PSreader_oocc* psreader_oocc = new PSreader_oocc();
+    psreader_oocc->open(file_name);
+    psreader = psreader_oocc;
+  }
+  else if (strstr(file_name, "_lowspan") || strstr(file_name, "breadthfirst") || strstr(file_name, "breadth_first"))
+  {
+    PSreader_lowspan* psreader_lowspan = new PSreader_lowspan();
+    psreader_lowspan->open(file_name);
+    psreader = psreader_lowspan;
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: cannot guess input type from file name\n");
+    exit(1);
+  }
+
+  if (faces > 0)
+  {
+    if (psreader->nfaces <= 0)
+    {
+      fprintf(stderr,"ERROR: the input does not say how many faces it has. use '-ratio'\n");
+      exit(1);
+    }
+    ratio = ((float)faces)/psreader->nfaces;
+  }
+  if (ratio > 1.0f)
+  {
+    ratio = 1.0f;
+  }
+
+  SMwriter* smwriter = 0;
+  FILE* file_out = 0;
+
+  if (file_name_out)
+  {
+    if (strstr(file_name_out, ".sma"))
+    {
+      file_out = fopen(file_name_out, "w");
+    }
+    else if (strstr(file_name_out, ".smb") || strstr(file_name_out, ".smc"))
+    {
+      file_out = fopen(file_name_out, "wb");
+    }
+    else
+    {
+      fprintf(stderr,"ERROR: output file name '%s' does not end in .sma .smb or .smc\n",file_name_out);
+      exit(1);
+    }
+    if (file_out == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name_out);
+      exit(1);
+    }
+    if (strstr(file_name_out, ".sma"))
+    {
+      SMwriter_sma* smwriter_sma = new SMwriter_sma();
+      smwriter_sma->open(file_out);
+      smwriter = smwriter_sma;
+    }
+    else if (strstr(file_name_out, ".smb"))
+    {
+      SMwriter_smb* smwriter_smb = new SMwriter_smb();
+      smwriter_smb->open(file_out);
+      smwriter = smwriter_smb;
+    }
+    else
+    {
+      SMwriter_smc* smwriter_smc = new SMwriter_smc();
+      smwriter_smc->open(file_out, bits);
+      smwriter = smwriter_smc;
+    }
+    // the new positions are clamped to the bounding box of the input
+    if (psreader->bb_min_f && psreader->bb_max_f)
+    {
+      smwriter->set_boundingbox(psreader->bb_min_f, psreader->bb_max_f);
+    }
+  }
+
+  // read into the buffer, simplify it once it is full, and write out the
+  // oldest half
+
+  int v_count = 0;
+  int f_count = 0;
+  int read_faces = 0;
+  int phases = 0;
+  int collapses = 0;
+
+  while (psreader->read_triangle() > PS_EOF)
+  {
+    PStriangle* triangle = allocTriangle();
+    for (i = 0; i < 3; i++)
+    {
+      PSvertex* vertex;
+      if (PS_IS_NEW_VERTEX(psreader->t_vflag[i]))
+      {
+        vertex = allocVertex();
+        VecCopy3fv(vertex->v, psreader->t_pos_f[i]);
+        psreader->set_vdata(vertex, i);
+      }
+      else
+      {
+        vertex = (PSvertex*)psreader->get_vdata(i);
+      }
+      triangle->vertices[i] = vertex;
+    }
+    for (i = 0; i < 3; i++)
+    {
+      linkCorner(triangle, i);
+      if (PS_IS_FINALIZED_VERTEX(psreader->t_vflag[i]))
+      {
+        triangle->vertices[i]->finalized = true;
+        if (psreader->t_vflag[i] & (PS_BORDER|PS_NON_MANIFOLD|PS_NOT_ORIENTED))
+        {
+          triangle->vertices[i]->locked = true;
+        }
+      }
+    }
+    // the vertices of a degenerate triangle are never collapsed
+    if (triangle->vertices[0] == triangle->vertices[1] || triangle->vertices[0] == triangle->vertices[2] || triangle->vertices[1] == triangle->vertices[2])
+    {
+      for (i = 0; i < 3; i++) triangle->vertices[i]->locked = true;
+    }
+    addPlaneQuadric(triangle);
+    read_faces++;
+
+    if (buffer_triangles >= buffer_size)
+    {
+      collapses += simplifyBuffer((int)(ratio*read_faces) - f_count, psreader->bb_min_f, psreader->bb_max_f);
+      phases++;
+      while (buffer_triangles > buffer_size/2)
+      {
+        writeOldest(smwriter, &v_count, &f_count);
+      }
+    }
+  }
+
+  // everything is finalized now
+
+  collapses += simplifyBuffer((int)(ratio*read_faces) - f_count, psreader->bb_min_f, psreader->bb_max_f);
+  phases++;
+  while (buffer_triangles)
+  {
+    writeOldest(smwriter, &v_count, &f_count);
+  }
+
+  fprintf(stderr,"input: " SM_IDX_FORMAT " vertices %d faces\n", psreader->v_count, read_faces);
+  fprintf(stderr,"output: %d vertices %d faces (%.1f%%)\n", v_count, f_count, (read_faces ? 100.0f*f_count/read_faces : 0.0f));
+  fprintf(stderr,"%d collapses in %d phases\n", collapses, phases);
+  fprintf(stderr,"maximal buffer: %d triangles %d vertices\n", max_buffer_triangles, max_buffer_vertices);
+  if (buffer_vertices)
+  {
+    fprintf(stderr,"WARNING: %d vertices without triangles were left over\n", buffer_vertices);
+  }
+
+  if (smwriter)
+  {
+    smwriter->close();
+    fclose(file_out);
+    delete smwriter;
+  }
+
+  psreader->close();
+  delete psreader;
+
+  free(heap);
+  free(ring_triangles);
+  free(ring_corners);
+  free(ring_neighbors);
+
+  return 0;
+}
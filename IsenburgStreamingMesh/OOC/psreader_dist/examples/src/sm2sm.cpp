@@ -26,6 +26,20 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- '-cache' re-orders the triangles for every output format
+    19 October 2026 -- '-split' also writes the components as SMC
+    19 October 2026 -- added '-volume' and '-iso' to stream the isosurface of a volume
+    19 October 2026 -- added '-geometry_thread' to decode the SMC geometry on a second thread
+    19 October 2026 -- added '-sections' to write SMC with a separate geometry sub-stream
+    19 October 2026 -- added '-index' and '-roi' to cut regions out of indexed SMB files
+    19 October 2026 -- added '-cache' to re-order for the vertex cache of a GPU
+    19 October 2026 -- added '-smooth' to remove the noise of scans on the fly
+    19 October 2026 -- added '-components' and '-split' to separate the parts of scans
+    19 October 2026 -- added '-lod' to output a pyramid of previews in one pass
+    19 October 2026 -- added '-cluster' to output a simplified preview
+    19 October 2026 -- added '-synthetic' to generate the input on the fly
+    19 October 2026 -- added '-trace' to write a Chrome trace of the pipeline
+    19 October 2026 -- added '-stats' to dump the runtime statistics as JSON
     02 May 2005 -- added OFF output format for Ioannis and our SCCG paper
     05 April 2005 -- old SMC becomes SMC_OLD and SME becomes the new SMC
     24 January 2005 -- improved SME takes place of old SMC
@@ -50,6 +64,8 @@
 #include "smreader_smc.h"
 #include "smreader_smd.h"
 #include "smreader_ply.h"
+#include "smreader_synthetic.h"
+#include "smreader_isosurface.h"
 #include "smwriter_sma.h"
 #include "smwriter_smb.h"
 #include "smwriter_smc.h"
@@ -62,8 +78,21 @@
 
 #include "smreadpreascompactpre.h"
 #include "smreadpostascompactpre.h"
+#include "smreadclustered.h"
+#include "smreadcomponents.h"
+#include "smreadsmoothed.h"
+#include "smreadindexed.h"
+#include "smwriteindexed.h"
 
 #include "smwritebuffered.h"
+#include "smwritelod.h"
+
+#include "smstats.h"
+#include "smtrace.h"
+
+#include "vec3fv.h"
+
+#include <hash_map.h>
 
 #ifdef _WIN32
 extern "C" FILE* fopenGzipped(const char* filename, const char* mode);
@@ -72,14 +101,317 @@ extern "C" int gettime_in_sec();
 extern "C" void settime();
 #endif
 
+// an additional pass over the input for meshes without a bounding box
+
+static bool compute_boundingbox(const char* file_name, float* bb_min, float* bb_max)
+{
+  SMreader* smreader;
+  FILE* file = fopen(file_name, (strstr(file_name, ".sma") ? "r" : "rb"));
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name);
+    return false;
+  }
+  if (strstr(file_name, ".sma"))
+  {
+    SMreader_sma* smreader_sma = new SMreader_sma();
+    smreader_sma->open(file);
+    smreader = smreader_sma;
+  }
+  else if (strstr(file_name, ".smb"))
+  {
+    SMreader_smb* smreader_smb = new SMreader_smb();
+    smreader_smb->open(file);
+    smreader = smreader_smb;
+  }
+  else if (strstr(file_name, ".smd"))
+  {
+    SMreader_smd* smreader_smd = new SMreader_smd();
+    smreader_smd->open(file);
+    smreader = smreader_smd;
+  }
+  else if (strstr(file_name, ".smc") || strstr(file_name, ".sme"))
+  {
+    SMreader_smc* smreader_smc = new SMreader_smc();
+    smreader_smc->open(file);
+    smreader = smreader_smc;
+    file = 0; // closing the SMC reader closes the file
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: cannot compute bounding box of '%s'\n", file_name);
+    fclose(file);
+    return false;
+  }
+
+  fprintf(stderr,"need additional pass to compute bounding box\n");
+
+  SMevent event;
+  bool first = true;
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    if (event == SM_VERTEX)
+    {
+      if (first)
+      {
+        VecCopy3fv(bb_min, smreader->v_pos_f);
+        VecCopy3fv(bb_max, smreader->v_pos_f);
+        first = false;
+      }
+      else
+      {
+        VecUpdateMinMax3fv(bb_min, bb_max, smreader->v_pos_f);
+      }
+    }
+  }
+  smreader->close();
+  if (file) fclose(file);
+  delete smreader;
+  return !first;
+}
+
+// the level l of a pyramid goes to 'mesh_lod0.smc' for the output 'mesh.smc'
+// and component c goes to 'mesh_comp0.smc'.
+
+static FILE* open_numbered(const char* file_name, const char* suffix, int number)
+{
+  char* file_name_numbered = (char*)malloc(strlen(file_name) + strlen(suffix) + 16);
+  const char* extension = strrchr(file_name, '.');
+  int length = (extension ? (int)(extension - file_name) : (int)strlen(file_name));
+  sprintf(file_name_numbered, "%.*s%s%d%s", length, file_name, suffix, number, (extension ? extension : ""));
+  FILE* file = fopen(file_name_numbered, (strstr(file_name_numbered, ".sma") ? "w" : "wb"));
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name_numbered);
+  }
+  else
+  {
+    fprintf(stderr,"writing '%s'\n", file_name_numbered);
+  }
+  free(file_name_numbered);
+  return file;
+}
+
+// the index of 'mesh.smb' is 'mesh.smi' unless it is given
+
+static FILE* open_index(const char* file_name_index, const char* file_name, const char* mode)
+{
+  if (file_name_index)
+  {
+    FILE* file = fopen(file_name_index, mode);
+    if (file == 0) fprintf(stderr,"ERROR: cannot open '%s'\n", file_name_index);
+    return file;
+  }
+  char* file_name_smi = (char*)malloc(strlen(file_name) + 5);
+  const char* extension = strrchr(file_name, '.');
+  int length = (extension ? (int)(extension - file_name) : (int)strlen(file_name));
+  sprintf(file_name_smi, "%.*s.smi", length, file_name);
+  FILE* file = fopen(file_name_smi, mode);
+  if (file == 0) fprintf(stderr,"ERROR: cannot open '%s'\n", file_name_smi);
+  free(file_name_smi);
+  return file;
+}
+
+// builds the index of an existing SMB file in one pass
+
+static bool index_smb(SMreader_smb* smreader_smb, FILE* file_smi, int chunk_size)
+{
+  SMevent event;
+  SMindex* smindex = new SMindex();
+  if (!smindex->open_write(file_smi, chunk_size))
+  {
+    delete smindex;
+    return false;
+  }
+  while (true)
+  {
+    if (smindex->chunk_full()) smindex->set_offset(smreader_smb->tell_block());
+    event = smreader_smb->read_element();
+    if (event == SM_VERTEX)
+    {
+      smindex->add_vertex(smreader_smb->v_pos_f);
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      smindex->add_triangle(smreader_smb->t_idx, smreader_smb->t_final);
+    }
+    else
+    {
+      break;
+    }
+  }
+  bool ok = smindex->close_write();
+  delete smindex;
+  return ok;
+}
+
+// writes every component into its own file. a vertex goes to the component
+// of the first triangle that uses it. when two components with a label were
+// merged a triangle may use a vertex of the other label. such a vertex is
+// written again. the file of a component is closed after its last triangle.
+
+typedef struct SplitVertex
+{
+  float v[3];
+  int label;
+  SMidx index;
+} SplitVertex;
+
+typedef hash_map<SMidx, SplitVertex*> my_split_hash;
+
+static bool write_components(SMreadComponents* smreadcomponents, const char* file_name, int bits)
+{
+  int i;
+  int label;
+  int files_alloc = 256;
+  SMwriter** smwriters = (SMwriter**)malloc(sizeof(SMwriter*)*files_alloc);
+  FILE** files = (FILE**)malloc(sizeof(FILE*)*files_alloc);
+  my_split_hash* split_hash = new my_split_hash;
+  my_split_hash::iterator split_element;
+  SplitVertex* split_vertex;
+  SMwriter* smwriter;
+  SMidx t_idx[3];
+  int duplicated = 0;
+  bool ok = true;
+  SMevent event;
+
+  for (i = 0; i < files_alloc; i++) files[i] = 0;
+
+  while (ok && (event = smreadcomponents->read_element()) > SM_EOF)
+  {
+    label = smreadcomponents->c_idx;
+    if (label >= files_alloc)
+    {
+      smwriters = (SMwriter**)realloc(smwriters, sizeof(SMwriter*)*files_alloc*2);
+      files = (FILE**)realloc(files, sizeof(FILE*)*files_alloc*2);
+      for (i = files_alloc; i < files_alloc*2; i++) files[i] = 0;
+      files_alloc = files_alloc*2;
+    }
+    if (files[label] == 0)
+    {
+      files[label] = open_numbered(file_name, "_comp", label);
+      if (files[label] == 0)
+      {
+        ok = false;
+        break;
+      }
+      if (strstr(file_name, ".sma"))
+      {
+        SMwriter_sma* smwriter_sma = new SMwriter_sma();
+        smwriter_sma->open(files[label]);
+        smwriters[label] = smwriter_sma;
+      }
+      else if (strstr(file_name, ".smc"))
+      {
+        SMwriter_smc* smwriter_smc = new SMwriter_smc();
+        smwriter_smc->open(files[label], bits);
+        smwriters[label] = smwriter_smc;
+      }
+      else
+      {
+        SMwriter_smb* smwriter_smb = new SMwriter_smb();
+        smwriter_smb->open(files[label]);
+        smwriters[label] = smwriter_smb;
+      }
+      if (smreadcomponents->bb_min_f && smreadcomponents->bb_max_f) smwriters[label]->set_boundingbox(smreadcomponents->bb_min_f, smreadcomponents->bb_max_f);
+    }
+    smwriter = smwriters[label];
+
+    if (event == SM_VERTEX)
+    {
+      split_vertex = new SplitVertex;
+      VecCopy3fv(split_vertex->v, smreadcomponents->v_pos_f);
+      split_vertex->label = label;
+      split_vertex->index = smwriter->v_count;
+      smwriter->write_vertex(split_vertex->v);
+      split_hash->insert(my_split_hash::value_type(smreadcomponents->v_idx, split_vertex));
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      for (i = 0; i < 3; i++)
+      {
+        split_element = split_hash->find(smreadcomponents->t_idx[i]);
+        split_vertex = (*split_element).second;
+        if (split_vertex->label != label)
+        {
+          split_vertex->label = label;
+          split_vertex->index = smwriter->v_count;
+          smwriter->write_vertex(split_vertex->v);
+          duplicated++;
+        }
+        t_idx[i] = split_vertex->index;
+      }
+      smwriter->write_triangle(t_idx, smreadcomponents->t_final);
+      for (i = 0; i < 3; i++)
+      {
+        if (smreadcomponents->t_final[i])
+        {
+          split_element = split_hash->find(smreadcomponents->t_idx[i]);
+          delete (*split_element).second;
+          split_hash->erase(split_element);
+        }
+      }
+      if (smreadcomponents->c_last)
+      {
+        smwriter->close();
+        fclose(files[label]);
+        delete smwriter;
+        files[label] = (FILE*)-1;
+      }
+    }
+  }
+
+  // components whose label was merged into an older one end here
+
+  for (label = 0; label < files_alloc; label++)
+  {
+    if (files[label] && files[label] != (FILE*)-1)
+    {
+      smwriters[label]->close();
+      fclose(files[label]);
+      delete smwriters[label];
+    }
+  }
+  for (split_element = split_hash->begin(); split_element != split_hash->end(); split_element++)
+  {
+    delete (*split_element).second;
+  }
+  delete split_hash;
+  free(smwriters);
+  free(files);
+
+  fprintf(stderr,"wrote %d components. %d vertices were written twice.\n", smreadcomponents->c_count, duplicated);
+  return ok;
+}
+
 void usage()
 {
   fprintf(stderr,"usage:\n");
   fprintf(stderr,"sm2sm -i mesh.smb -o mesh.sme \n");
   fprintf(stderr,"sm2sm -i mesh.sma -o mesh.sme -delay 100 -bits 10\n");
+  fprintf(stderr,"sm2sm -i mesh.sma -o mesh.smb -delay 1000 -cache forsyth -cache_size 32\n");
+  fprintf(stderr,"sm2sm -i mesh.sma -o mesh.smb -cache fifo\n");
   fprintf(stderr,"sm2sm -isma -osme < mesh.sma > mesh.sme\n");
   fprintf(stderr,"sm2sm -compact -i mesh.sma -mesh.smd -dry\n");
   fprintf(stderr,"sm2sm -i mesh.sma.gz -o mesh.smc -b 12\n");
+  fprintf(stderr,"sm2sm -i mesh.smb -o mesh.smc -sections 4096\n");
+  fprintf(stderr,"sm2sm -i mesh.smc -o mesh.smb -geometry_thread\n");
+  fprintf(stderr,"sm2sm -i mesh.smc -o mesh.smd -stats stats.json\n");
+  fprintf(stderr,"sm2sm -i mesh.smb -o mesh.smc -trace trace.json\n");
+  fprintf(stderr,"sm2sm -synthetic terrain,1024,500000,seed=7,border=0.01 -o mesh.smc\n");
+  fprintf(stderr,"sm2sm -volume head.raw 256 256 225 uchar -iso 80 -o head.smc\n");
+  fprintf(stderr,"sm2sm -volume ct.raw 512 512 1000 ushort -volume_spacing 0.5 0.5 1 -iso 1200 -iso_threads 4 -o ct.smc\n");
+  fprintf(stderr,"sm2sm -i mesh.smc -o preview.smc -cluster 256\n");
+  fprintf(stderr,"sm2sm -i mesh.smc -o preview.smc -cluster_memory 64\n");
+  fprintf(stderr,"sm2sm -i mesh.smc -o preview.smc -lod 5 -lod_resolution 512\n");
+  fprintf(stderr,"sm2sm -i scan.smc -o cleaned.smc -components 1000\n");
+  fprintf(stderr,"sm2sm -i scan.smc -o part.smb -components 1000 -split\n");
+  fprintf(stderr,"sm2sm -i scan.smc -o part.sma -split -components_buffer 100000\n");
+  fprintf(stderr,"sm2sm -i scan.smc -o smooth.smc -smooth 5\n");
+  fprintf(stderr,"sm2sm -i scan.smc -o smooth.smc -smooth 10 -smooth_lambda 0.33 -smooth_mu -0.34\n");
+  fprintf(stderr,"sm2sm -i scan.sma -o scan.smb -index scan.smi -index_chunk 100000\n");
+  fprintf(stderr,"sm2sm -i scan.smb -index scan.smi\n");
+  fprintf(stderr,"sm2sm -i scan.smb -o part.sma -roi 0.1 0.1 0 0.2 0.2 1\n");
   fprintf(stderr,"sm2sm -h\n");
   exit(1);
 }
@@ -102,11 +434,42 @@ int main(int argc, char *argv[])
   bool osme = 0;
   bool ooff = 0;
   int bits = 16;
+  int sections = 0;
+  bool geometry_thread = false;
   bool delay = false;
   int delay_value = 0;
+  bool cache_reorder = false;
+  int cache = SM_CACHE_LITTLE;
+  int cache_size = 16;
   bool compact = 0;
   char* file_name_in = 0;
   char* file_name_out = 0;
+  char* file_name_stats = 0;
+  char* file_name_trace = 0;
+  char* synthetic = 0;
+  char* file_name_volume = 0;
+  int volume_size[3] = {0, 0, 0};
+  int volume_type = SM_ISO_UCHAR;
+  float volume_spacing[3] = {1.0f, 1.0f, 1.0f};
+  float iso = 0.0f;
+  int iso_threads = 0;
+  FILE* file_volume = 0;
+  int cluster = 0;
+  int cluster_memory = 0;
+  int lod = 0;
+  int lod_resolution = 512;
+  int components = -1;
+  int components_buffer = 1000000;
+  bool split = false;
+  char* file_name_index = 0;
+  int index_chunk = 65536;
+  bool roi = false;
+  float roi_min[3];
+  float roi_max[3];
+  SMreader_smb* smreader_smb_in = 0;
+  int smooth = 0;
+  float smooth_lambda = 0.5f;
+  float smooth_mu = -0.53f;
 
   for (i = 1; i < argc; i++)
   {
@@ -171,6 +534,15 @@ int main(int argc, char *argv[])
       i++;
       bits = atoi(argv[i]);
     }
+    else if (strcmp(argv[i],"-sections") == 0)
+    {
+      i++;
+      sections = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-geometry_thread") == 0)
+    {
+      geometry_thread = true;
+    }
     else if (strcmp(argv[i],"-delay") == 0)
     {
       delay = true;
@@ -183,6 +555,30 @@ int main(int argc, char *argv[])
         }
       }
     }
+    else if (strcmp(argv[i],"-cache") == 0)
+    {
+      i++;
+      cache_reorder = true;
+      if (strcmp(argv[i],"little") == 0) cache = SM_CACHE_LITTLE;
+      else if (strcmp(argv[i],"fifo") == 0) cache = SM_CACHE_FIFO;
+      else if (strcmp(argv[i],"lru") == 0) cache = SM_CACHE_LRU;
+      else if (strcmp(argv[i],"forsyth") == 0) cache = SM_CACHE_FORSYTH;
+      else
+      {
+        fprintf(stderr,"ERROR: unknown cache '%s'. use little, fifo, lru, or forsyth\n", argv[i]);
+        exit(1);
+      }
+    }
+    else if (strcmp(argv[i],"-cache_size") == 0)
+    {
+      i++;
+      cache_size = atoi(argv[i]);
+      if (cache_size < 4 || cache_size > SM_CACHE_MAX_SIZE)
+      {
+        fprintf(stderr,"ERROR: cache size %d is not between 4 and %d\n", cache_size, SM_CACHE_MAX_SIZE);
+        exit(1);
+      }
+    }
     else if (strcmp(argv[i],"-compact") == 0)
     {
       compact = true;
@@ -197,16 +593,169 @@ int main(int argc, char *argv[])
       i++;
       file_name_out = argv[i];
     }
+    else if (strcmp(argv[i],"-stats") == 0)
+    {
+      i++;
+      file_name_stats = argv[i];
+    }
+    else if (strcmp(argv[i],"-trace") == 0)
+    {
+      i++;
+      file_name_trace = argv[i];
+    }
+    else if (strcmp(argv[i],"-synthetic") == 0)
+    {
+      i++;
+      synthetic = argv[i];
+    }
+    else if (strcmp(argv[i],"-volume") == 0)
+    {
+      if (i+5 >= argc)
+      {
+        fprintf(stderr,"ERROR: '-volume' needs a file name, the three sizes, and uchar ushort or float\n");
+        exit(1);
+      }
+      file_name_volume = argv[i+1];
+      volume_size[0] = atoi(argv[i+2]);
+      volume_size[1] = atoi(argv[i+3]);
+      volume_size[2] = atoi(argv[i+4]);
+      if (strcmp(argv[i+5],"uchar") == 0)
+      {
+        volume_type = SM_ISO_UCHAR;
+      }
+      else if (strcmp(argv[i+5],"ushort") == 0)
+      {
+        volume_type = SM_ISO_USHORT;
+      }
+      else if (strcmp(argv[i+5],"float") == 0)
+      {
+        volume_type = SM_ISO_FLOAT;
+      }
+      else
+      {
+        fprintf(stderr,"ERROR: samples of type '%s' are not uchar ushort or float\n", argv[i+5]);
+        exit(1);
+      }
+      i+=5;
+    }
+    else if (strcmp(argv[i],"-volume_spacing") == 0)
+    {
+      if (i+3 >= argc)
+      {
+        fprintf(stderr,"ERROR: '-volume_spacing' needs three numbers: x y z\n");
+        exit(1);
+      }
+      volume_spacing[0] = (float)atof(argv[i+1]);
+      volume_spacing[1] = (float)atof(argv[i+2]);
+      volume_spacing[2] = (float)atof(argv[i+3]);
+      i+=3;
+    }
+    else if (strcmp(argv[i],"-iso") == 0)
+    {
+      i++;
+      iso = (float)atof(argv[i]);
+    }
+    else if (strcmp(argv[i],"-iso_threads") == 0)
+    {
+      i++;
+      iso_threads = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-cluster") == 0)
+    {
+      i++;
+      cluster = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-cluster_memory") == 0)
+    {
+      i++;
+      cluster_memory = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-lod") == 0)
+    {
+      i++;
+      lod = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-lod_resolution") == 0)
+    {
+      i++;
+      lod_resolution = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-components") == 0)
+    {
+      i++;
+      components = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-components_buffer") == 0)
+    {
+      i++;
+      components_buffer = atoi(argv[i]);
+      if (components == -1) components = 0;
+    }
+    else if (strcmp(argv[i],"-split") == 0)
+    {
+      split = true;
+      if (components == -1) components = 0;
+    }
+    else if (strcmp(argv[i],"-index") == 0)
+    {
+      i++;
+      file_name_index = argv[i];
+    }
+    else if (strcmp(argv[i],"-index_chunk") == 0)
+    {
+      i++;
+      index_chunk = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-roi") == 0)
+    {
+      if (i+6 >= argc)
+      {
+        fprintf(stderr,"ERROR: '-roi' needs six numbers: min_x min_y min_z max_x max_y max_z\n");
+        exit(1);
+      }
+      roi = true;
+      roi_min[0] = (float)atof(argv[i+1]);
+      roi_min[1] = (float)atof(argv[i+2]);
+      roi_min[2] = (float)atof(argv[i+3]);
+      roi_max[0] = (float)atof(argv[i+4]);
+      roi_max[1] = (float)atof(argv[i+5]);
+      roi_max[2] = (float)atof(argv[i+6]);
+      i+=6;
+    }
+    else if (strcmp(argv[i],"-smooth") == 0)
+    {
+      i++;
+      smooth = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-smooth_lambda") == 0)
+    {
+      i++;
+      smooth_lambda = (float)atof(argv[i]);
+    }
+    else if (strcmp(argv[i],"-smooth_mu") == 0)
+    {
+      i++;
+      smooth_mu = (float)atof(argv[i]);
+    }
     else
     {
       usage();
     }
   }
 
+  if (file_name_trace)
+  {
+    sm_trace_open(file_name_trace);
+  }
+
   SMreader* smreader;
   FILE* file_in;
   
-  if (file_name_in)
+  if (synthetic || file_name_volume)
+  {
+    file_in = 0;
+  }
+  else if (file_name_in)
   {
     if (strstr(file_name_in, ".gz"))
     {
@@ -277,13 +826,50 @@ int main(int argc, char *argv[])
     }
   }
 
-  if (file_in == 0)
+  if (roi && (file_name_in == 0 || !strstr(file_name_in, ".smb") || strstr(file_name_in, ".gz")))
+  {
+    fprintf(stderr,"ERROR: '-roi' needs an uncompressed SMB input file with an index\n");
+    exit(1);
+  }
+
+  if (file_in == 0 && synthetic == 0 && file_name_volume == 0)
   {
     fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name_in);
     exit(0);
   }
   
-  if (file_name_in)
+  if (synthetic)
+  {
+    SMreader_synthetic* smreader_synthetic = new SMreader_synthetic();
+    if (!smreader_synthetic->open(synthetic))
+    {
+      exit(0);
+    }
+    smreader = smreader_synthetic;
+  }
+  else if (file_name_volume)
+  {
+    if (volume_size[0] < 2 || volume_size[1] < 2 || volume_size[2] < 2)
+    {
+      fprintf(stderr,"ERROR: '-volume' needs three sizes of at least 2 but has %d %d %d\n", volume_size[0], volume_size[1], volume_size[2]);
+      exit(1);
+    }
+    file_volume = fopen(file_name_volume, "rb");
+    if (file_volume == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name_volume);
+      exit(1);
+    }
+    SMreader_isosurface* smreader_isosurface = new SMreader_isosurface();
+    smreader_isosurface->set_spacing(volume_spacing);
+    smreader_isosurface->set_threads(iso_threads);
+    if (!smreader_isosurface->open(file_volume, volume_type, volume_size[0], volume_size[1], volume_size[2], iso))
+    {
+      exit(1);
+    }
+    smreader = smreader_isosurface;
+  }
+  else if (file_name_in)
   {
     if (strstr(file_name_in, ".sma"))
     {
@@ -291,11 +877,23 @@ int main(int argc, char *argv[])
       smreader_sma->open(file_in);
       smreader = smreader_sma;
     }
+    else if (strstr(file_name_in, ".smb") && roi)
+    {
+      FILE* file_smi = open_index(file_name_index, file_name_in, "rb");
+      SMreadIndexed* smreadindexed = new SMreadIndexed();
+      if (file_smi == 0 || !smreadindexed->open(file_in, file_smi, roi_min, roi_max))
+      {
+        fprintf(stderr,"ERROR: cannot query the index of '%s'\n", file_name_in);
+        exit(1);
+      }
+      smreader = smreadindexed;
+    }
     else if (strstr(file_name_in, ".smb"))
     {
       SMreader_smb* smreader_smb = new SMreader_smb();
       smreader_smb->open(file_in);
       smreader = smreader_smb;
+      smreader_smb_in = smreader_smb;
     }
     else if (strstr(file_name_in, ".smc_old"))
     {
@@ -312,6 +910,7 @@ int main(int argc, char *argv[])
     else if (strstr(file_name_in, ".smc") || strstr(file_name_in, ".sme"))
     {
       SMreader_smc* smreader_smc = new SMreader_smc();
+      smreader_smc->set_geometry_thread(geometry_thread);
       smreader_smc->open(file_in);
       smreader = smreader_smc;
     }
@@ -356,6 +955,7 @@ int main(int argc, char *argv[])
     else if (ismc || isme)
     {
       SMreader_smc* smreader_smc = new SMreader_smc();
+      smreader_smc->set_geometry_thread(geometry_thread);
       smreader_smc->open(file_in);
       smreader = smreader_smc;
     }
@@ -366,6 +966,11 @@ int main(int argc, char *argv[])
     }
   }
 
+  const SMstats* stats[6];
+  int num_stats = 0;
+
+  if (smreader->get_stats()) stats[num_stats++] = smreader->get_stats();
+
   if (smreader->post_order)
   {
     fprintf(stderr,"WARNING: applying filter PostAsCompactPre...\n");
@@ -381,10 +986,120 @@ int main(int argc, char *argv[])
     smreader = smreadpreascompactpre;
   }
 
+  if (smooth)
+  {
+    SMreadSmoothed* smreadsmoothed = new SMreadSmoothed();
+    if (!smreadsmoothed->open(smreader, smooth, smooth_lambda, smooth_mu))
+    {
+      fprintf(stderr,"ERROR: cannot apply filter Smoothed\n");
+      exit(1);
+    }
+    smreader = smreadsmoothed;
+    stats[num_stats++] = smreader->get_stats();
+  }
+
+  if (cluster || cluster_memory)
+  {
+    float bb_min[3];
+    float bb_max[3];
+    bool computed = false;
+    if ((smreader->bb_min_f == 0 || smreader->bb_max_f == 0) && file_name_in && !strstr(file_name_in, ".gz"))
+    {
+      computed = compute_boundingbox(file_name_in, bb_min, bb_max);
+    }
+    SMreadClustered* smreadclustered = new SMreadClustered();
+    if (!smreadclustered->open(smreader, cluster, cluster_memory, (computed ? bb_min : 0), (computed ? bb_max : 0)))
+    {
+      fprintf(stderr,"ERROR: cannot apply filter Clustered\n");
+      exit(1);
+    }
+    smreader = smreadclustered;
+    stats[num_stats++] = smreader->get_stats();
+  }
+
+  SMreadComponents* smreadcomponents = 0;
+  if (components != -1)
+  {
+    smreadcomponents = new SMreadComponents();
+    if (!smreadcomponents->open(smreader, components, components_buffer))
+    {
+      fprintf(stderr,"ERROR: cannot apply filter Components\n");
+      exit(1);
+    }
+    smreader = smreadcomponents;
+    stats[num_stats++] = smreader->get_stats();
+  }
+
   SMwriter* smwriter;
+  SMwriter* smwriter_delayed = 0;
   FILE* file_out;
+  FILE* lod_files[SM_LOD_MAX_LEVELS];
+  SMwriter* lod_writers[SM_LOD_MAX_LEVELS];
 
-  if (file_name_out || osma || osmb || osmc || osmc_old || osmd || osme || ooff)
+  if (split)
+  {
+    if (cache_reorder)
+    {
+      fprintf(stderr,"ERROR: '-cache' does not work with '-split'\n");
+      exit(1);
+    }
+    if (file_name_out == 0 || dry || !(strstr(file_name_out, ".sma") || strstr(file_name_out, ".smb") || strstr(file_name_out, ".smc")))
+    {
+      fprintf(stderr,"ERROR: '-split' needs an SMA, SMB, or SMC output file name to derive the names of the components from\n");
+      exit(1);
+    }
+    smwriter = 0;
+    file_out = 0;
+  }
+  else if (lod)
+  {
+    if (file_name_out == 0 || dry || !(strstr(file_name_out, ".smb") || strstr(file_name_out, ".smc")))
+    {
+      fprintf(stderr,"ERROR: '-lod' needs an SMB or SMC output file name to derive the names of the levels from\n");
+      exit(1);
+    }
+    if (lod > SM_LOD_MAX_LEVELS)
+    {
+      fprintf(stderr,"WARNING: only %d levels are supported\n", SM_LOD_MAX_LEVELS);
+      lod = SM_LOD_MAX_LEVELS;
+    }
+    for (i = 0; i < lod; i++)
+    {
+      lod_files[i] = open_numbered(file_name_out, "_lod", i);
+      if (lod_files[i] == 0) exit(1);
+      if (strstr(file_name_out, ".smc"))
+      {
+        SMwriter_smc* smwriter_smc = new SMwriter_smc();
+        smwriter_smc->open(lod_files[i], bits);
+        lod_writers[i] = smwriter_smc;
+      }
+      else
+      {
+        SMwriter_smb* smwriter_smb = new SMwriter_smb();
+        smwriter_smb->open(lod_files[i]);
+        lod_writers[i] = smwriter_smb;
+      }
+    }
+    SMwriteLOD* smwritelod = new SMwriteLOD();
+    if (!smwritelod->open(lod, lod_writers, lod_resolution))
+    {
+      exit(1);
+    }
+    if (smreader->bb_min_f == 0 || smreader->bb_max_f == 0)
+    {
+      float bb_min[3];
+      float bb_max[3];
+      if (file_name_in == 0 || strstr(file_name_in, ".gz") || !compute_boundingbox(file_name_in, bb_min, bb_max))
+      {
+        fprintf(stderr,"ERROR: '-lod' needs a bounding box\n");
+        exit(1);
+      }
+      smwritelod->set_boundingbox(bb_min, bb_max);
+    }
+    smwriter = smwritelod;
+    file_out = 0;
+  }
+  else if (file_name_out || osma || osmb || osmc || osmc_old || osmd || osme || ooff)
   {
     if (dry)
     {
@@ -453,7 +1168,19 @@ int main(int argc, char *argv[])
       }
       else if (strstr(file_name_out, ".smb"))
       {
-        if (file_out)
+        if (file_out && file_name_index)
+        {
+          SMwriter_smb* smwriter_smb = new SMwriter_smb();
+          smwriter_smb->open(file_out);
+          FILE* file_smi = open_index(file_name_index, file_name_out, "wb");
+          SMwriteIndexed* smwriteindexed = new SMwriteIndexed();
+          if (file_smi == 0 || !smwriteindexed->open(smwriter_smb, file_out, file_smi, index_chunk))
+          {
+            exit(1);
+          }
+          smwriter = smwriteindexed;
+        }
+        else if (file_out)
         {
           SMwriter_smb* smwriter_smb = new SMwriter_smb();
           smwriter_smb->open(file_out);
@@ -467,18 +1194,19 @@ int main(int argc, char *argv[])
       else if (strstr(file_name_out, ".smc") || strstr(file_name_out, ".sme"))
       {
         SMwriter_smc* smwriter_smc = new SMwriter_smc();
-        smwriter_smc->open(file_out, bits);
+        smwriter_smc->open(file_out, bits, sections);
         if (delay)
         {
           SMwriteBuffered* smwrite_buffered = new SMwriteBuffered();
           if (delay_value)
           {
-            smwrite_buffered->open(smwriter_smc, delay_value);
+            smwrite_buffered->open(smwriter_smc, delay_value, cache, cache_size);
           }
           else
           {
-            smwrite_buffered->open(smwriter_smc);
+            smwrite_buffered->open(smwriter_smc, 100, cache, cache_size);
           }
+          smwriter_delayed = smwriter_smc;
           smwriter = smwrite_buffered;
         }
         else
@@ -508,12 +1236,13 @@ int main(int argc, char *argv[])
           SMwriteBuffered* smwrite_buffered = new SMwriteBuffered();
           if (delay_value)
           {
-            smwrite_buffered->open(smwriter_smc_old, delay_value);
+            smwrite_buffered->open(smwriter_smc_old, delay_value, cache, cache_size);
           }
           else
           {
-            smwrite_buffered->open(smwriter_smc_old);
+            smwrite_buffered->open(smwriter_smc_old, 100, cache, cache_size);
           }
+          smwriter_delayed = smwriter_smc_old;
           smwriter = smwrite_buffered;
         }
         else
@@ -570,12 +1299,13 @@ int main(int argc, char *argv[])
           SMwriteBuffered* smwrite_buffered = new SMwriteBuffered();
           if (delay_value)
           {
-            smwrite_buffered->open(smwriter_smc_old, delay_value);
+            smwrite_buffered->open(smwriter_smc_old, delay_value, cache, cache_size);
           }
           else
           {
-            smwrite_buffered->open(smwriter_smc_old);
+            smwrite_buffered->open(smwriter_smc_old, 100, cache, cache_size);
           }
+          smwriter_delayed = smwriter_smc_old;
           smwriter = smwrite_buffered;
         }
         else
@@ -599,18 +1329,19 @@ int main(int argc, char *argv[])
       else if (osmc || osme)
       {
         SMwriter_smc* smwriter_smc = new SMwriter_smc();
-        smwriter_smc->open(file_out, bits);
+        smwriter_smc->open(file_out, bits, sections);
         if (delay)
         {
           SMwriteBuffered* smwrite_buffered = new SMwriteBuffered();
           if (delay_value)
           {
-            smwrite_buffered->open(smwriter_smc, delay_value);
+            smwrite_buffered->open(smwriter_smc, delay_value, cache, cache_size);
           }
           else
           {
-            smwrite_buffered->open(smwriter_smc);
+            smwrite_buffered->open(smwriter_smc, 100, cache, cache_size);
           }
+          smwriter_delayed = smwriter_smc;
           smwriter = smwrite_buffered;
         }
         else
@@ -637,6 +1368,25 @@ int main(int argc, char *argv[])
     smwriter = 0;
   }
 
+  // '-cache' re-orders the triangles for any output, not only for those
+  // that '-delay' buffers. the SMC writer re-orders them once more while
+  // it compresses, so only SMA, SMB, and OFF keep the order for the GPU.
+
+  if (cache_reorder && smwriter && smwriter_delayed == 0)
+  {
+    SMwriteBuffered* smwrite_buffered = new SMwriteBuffered();
+    if (delay_value)
+    {
+      smwrite_buffered->open(smwriter, delay_value, cache, cache_size);
+    }
+    else
+    {
+      smwrite_buffered->open(smwriter, 100, cache, cache_size);
+    }
+    smwriter_delayed = smwriter;
+    smwriter = smwrite_buffered;
+  }
+
   int event;
 
 #ifdef _WIN32
@@ -666,28 +1416,90 @@ int main(int argc, char *argv[])
         break;
       }
     }
-    fprintf(stderr,"v_count %d %d\n",smreader->v_count,smwriter->v_count);
-    fprintf(stderr,"f_count %d %d\n",smreader->f_count,smwriter->f_count);
+    fprintf(stderr,"v_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader->v_count,smwriter->v_count);
+    fprintf(stderr,"f_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader->f_count,smwriter->f_count);
+
+    if (smwriter_delayed && smwriter_delayed->get_stats()) stats[num_stats++] = smwriter_delayed->get_stats();
+    if (smwriter->get_stats()) stats[num_stats++] = smwriter->get_stats();
 
     smwriter->close();
     if (file_out && file_name_out) fclose(file_out);
-    delete smwriter;
+    for (i = 0; i < lod; i++)
+    {
+      fclose(lod_files[i]);
+    }
+  }
+  else if (split)
+  {
+    write_components(smreadcomponents, file_name_out, bits);
+
+    fprintf(stderr,"v_count " SM_IDX_FORMAT "\n",smreader->v_count);
+    fprintf(stderr,"f_count " SM_IDX_FORMAT "\n",smreader->f_count);
+  }
+  else if (file_name_index && smreader_smb_in && smreader == smreader_smb_in)
+  {
+    FILE* file_smi = open_index(file_name_index, file_name_in, "wb");
+    if (file_smi == 0 || !index_smb(smreader_smb_in, file_smi, index_chunk))
+    {
+      fprintf(stderr,"ERROR: cannot index '%s'\n", file_name_in);
+      exit(1);
+    }
+    fclose(file_smi);
+
+    fprintf(stderr,"v_count " SM_IDX_FORMAT "\n",smreader->v_count);
+    fprintf(stderr,"f_count " SM_IDX_FORMAT "\n",smreader->f_count);
   }
   else
   {
     while (event = smreader->read_element());
 
-    fprintf(stderr,"v_count %d\n",smreader->v_count);
-    fprintf(stderr,"f_count %d\n",smreader->f_count);
+    fprintf(stderr,"v_count " SM_IDX_FORMAT "\n",smreader->v_count);
+    fprintf(stderr,"f_count " SM_IDX_FORMAT "\n",smreader->f_count);
   }
 
 #ifdef _WIN32
   fprintf(stderr,"needed %6.3f seconds\n",0.001f*gettime_in_msec());
 #endif
 
+  if (file_name_stats)
+  {
+    FILE* file_stats = fopen(file_name_stats, "w");
+    if (file_stats == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name_stats);
+    }
+    else
+    {
+      fprintf(file_stats, "[");
+      for (i = 0; i < num_stats; i++)
+      {
+        fprintf(file_stats, "%s\n", (i ? "," : ""));
+        stats[i]->write_json(file_stats, 2);
+      }
+      fprintf(file_stats, "\n]\n");
+      fclose(file_stats);
+    }
+  }
+
+  // the writers own their statistics, so they are deleted only now
+  if (smwriter)
+  {
+    delete smwriter;
+    for (i = 0; i < lod; i++)
+    {
+      delete lod_writers[i];
+    }
+  }
+
   smreader->close();
   if (file_in && file_name_in) fclose(file_in);
+  if (file_volume) fclose(file_volume);
   delete smreader;
 
+  if (file_name_trace)
+  {
+    sm_trace_close();
+  }
+
   return 1;
 }
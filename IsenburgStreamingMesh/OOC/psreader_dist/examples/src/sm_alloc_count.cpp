@@ -0,0 +1,593 @@
+/*
+===============================================================================
+
+  FILE:  sm_alloc_count.cpp
+
+  CONTENTS:
+
+    This program counts the heap traffic of every streaming reader -> writer
+    pair. It intercepts malloc/calloc/realloc/free, converts the input mesh
+    into a temporary file for each of the SMA, SMB, SMC, and SMD formats, and
+    then streams each of these through the SMA, SMB, SMC, SMD, and OFF writers
+    and through the PSconverter. Allocations are only counted once a warm-up
+    fraction of the elements was streamed (e.g. once the pools have reached
+    the width of the stream) and are reported per million elements. A pair
+    that has reached a zero-allocation steady state reports 0. Non-zero
+    counts come from pools that are still growing because the width of the
+    stream increases after the warm-up. With '-pre' every reader is wrapped
+    by the PreAsCompactPre filter and with '-delay' every writer is wrapped
+    by SMwriteBuffered.
+
+    Intercepting malloc is only supported with the GNU C library. With the
+    debug runtime of Visual C++ the allocation hook of the CRT is used. On
+    other systems only operator new and delete can be counted.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- added '-synthetic' to generate the input on the fly
+    19 October 2026 -- created to hunt down the last allocations per element
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smreader_smd.h"
+#include "smreader_ply.h"
+#include "smreader_synthetic.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+#include "smwriter_smd.h"
+#include "smwriter_off.h"
+
+#include "smreadpreascompactpre.h"
+#include "smreadpostascompactpre.h"
+
+#include "smwritebuffered.h"
+
+#include "psconverter.h"
+
+// the allocation counters
+
+static bool counting = false;
+static int alloc_calls = 0;
+static int free_calls = 0;
+
+#if defined(__GLIBC__)
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+extern "C" void* malloc(size_t size)
+{
+  if (counting) alloc_calls++;
+  return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t n, size_t size)
+{
+  if (counting) alloc_calls++;
+  return __libc_calloc(n, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+  if (counting) alloc_calls++;
+  return __libc_realloc(ptr, size);
+}
+
+extern "C" void free(void* ptr)
+{
+  if (counting && ptr) free_calls++;
+  __libc_free(ptr);
+}
+
+static const char* interposer = "malloc";
+
+#elif defined(_WIN32) && defined(_DEBUG)
+
+#include <crtdbg.h>
+
+static int alloc_hook(int type, void* data, size_t size, int block_use, long request, const unsigned char* file, int line)
+{
+  if (counting && block_use != _CRT_BLOCK)
+  {
+    if (type == _HOOK_FREE)
+    {
+      free_calls++;
+    }
+    else
+    {
+      alloc_calls++;
+    }
+  }
+  return 1;
+}
+
+static const char* interposer = "crt hook";
+
+#else
+
+void* operator new(size_t size)
+{
+  if (counting) alloc_calls++;
+  void* ptr = malloc(size ? size : 1);
+  if (ptr == 0) throw std::bad_alloc();
+  return ptr;
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* ptr)
+{
+  if (counting && ptr) free_calls++;
+  free(ptr);
+}
+
+void operator delete[](void* ptr)
+{
+  operator delete(ptr);
+}
+
+static const char* interposer = "new/delete only";
+
+#endif
+
+// the formats of the temporary files and the writers that are tested
+
+#define NUM_INPUTS 4
+#define NUM_OUTPUTS 6
+
+static const char* format_names[] = {"sma", "smb", "smc", "smd", "off", "ps"};
+
+static SMreader* open_reader(int format, FILE* file)
+{
+  switch (format)
+  {
+  case 0:
+    {
+      SMreader_sma* smreader_sma = new SMreader_sma();
+      smreader_sma->open(file);
+      return smreader_sma;
+    }
+  case 1:
+    {
+      SMreader_smb* smreader_smb = new SMreader_smb();
+      smreader_smb->open(file);
+      return smreader_smb;
+    }
+  case 2:
+    {
+      SMreader_smc* smreader_smc = new SMreader_smc();
+      smreader_smc->open(file);
+      return smreader_smc;
+    }
+  case 3:
+    {
+      SMreader_smd* smreader_smd = new SMreader_smd();
+      smreader_smd->open(file);
+      return smreader_smd;
+    }
+  }
+  return 0;
+}
+
+static SMwriter* open_writer(int format, FILE* file, int bits)
+{
+  switch (format)
+  {
+  case 0:
+    {
+      SMwriter_sma* smwriter_sma = new SMwriter_sma();
+      smwriter_sma->open(file);
+      return smwriter_sma;
+    }
+  case 1:
+    {
+      SMwriter_smb* smwriter_smb = new SMwriter_smb();
+      smwriter_smb->open(file);
+      return smwriter_smb;
+    }
+  case 2:
+    {
+      SMwriter_smc* smwriter_smc = new SMwriter_smc();
+      smwriter_smc->open(file, bits);
+      return smwriter_smc;
+    }
+  case 3:
+    {
+      SMwriter_smd* smwriter_smd = new SMwriter_smd();
+      smwriter_smd->open(file, bits);
+      return smwriter_smd;
+    }
+  case 4:
+    {
+      SMwriter_off* smwriter_off = new SMwriter_off();
+      smwriter_off->open(file);
+      return smwriter_off;
+    }
+  }
+  return 0;
+}
+
+static FILE* open_file(const char* file_name, int format, bool write)
+{
+  if (format == 0 || format == 4)
+  {
+    return fopen(file_name, write ? "w" : "r");
+  }
+  else
+  {
+    return fopen(file_name, write ? "wb" : "rb");
+  }
+}
+
+// the SMC and the SMD reader close their file when their range decoder is deleted
+
+static void close_file(FILE* file, int format)
+{
+  if (format != 2 && format != 3)
+  {
+    fclose(file);
+  }
+}
+
+static void copy_header(SMreader* smreader, SMwriter* smwriter)
+{
+  if (smreader->nverts != -1) smwriter->set_nverts(smreader->nverts);
+  if (smreader->nfaces != -1) smwriter->set_nfaces(smreader->nfaces);
+  if (smreader->bb_min_f || smreader->bb_max_f) smwriter->set_boundingbox(smreader->bb_min_f, smreader->bb_max_f);
+}
+
+static void copy_element(SMevent event, SMreader* smreader, SMwriter* smwriter)
+{
+  switch (event)
+  {
+  case SM_VERTEX:
+    smwriter->write_vertex(smreader->v_pos_f);
+    break;
+  case SM_TRIANGLE:
+    smwriter->write_triangle(smreader->t_idx, smreader->t_final);
+    break;
+  case SM_FINALIZED:
+    smwriter->write_finalized(smreader->final_idx);
+    break;
+  default:
+    break;
+  }
+}
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_alloc_count -i mesh.smb\n");
+  fprintf(stderr,"sm_alloc_count -i mesh.sma -warmup 0.25 -tmp /tmp/alloc\n");
+  fprintf(stderr,"sm_alloc_count -i mesh.smc -pre -delay\n");
+  fprintf(stderr,"sm_alloc_count -synthetic grid,1024,50000\n");
+  fprintf(stderr,"sm_alloc_count -h\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int i;
+  char* file_name_in = 0;
+  char* synthetic = 0;
+  const char* tmp_name = "sm_alloc_count_tmp";
+  float warmup = 0.5f;
+  int bits = 16;
+  bool pre = false;
+  bool delay = false;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-i") == 0 && i+1 < argc)
+    {
+      i++;
+      file_name_in = argv[i];
+    }
+    else if (strcmp(argv[i],"-synthetic") == 0 && i+1 < argc)
+    {
+      i++;
+      synthetic = argv[i];
+    }
+    else if (strcmp(argv[i],"-tmp") == 0 && i+1 < argc)
+    {
+      i++;
+      tmp_name = argv[i];
+    }
+    else if (strcmp(argv[i],"-warmup") == 0 && i+1 < argc)
+    {
+      i++;
+      warmup = (float)atof(argv[i]);
+    }
+    else if (strcmp(argv[i],"-pre") == 0)
+    {
+      pre = true;
+    }
+    else if (strcmp(argv[i],"-delay") == 0)
+    {
+      delay = true;
+    }
+    else if ((strcmp(argv[i],"-b") == 0 || strcmp(argv[i],"-bits") == 0) && i+1 < argc)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (file_name_in == 0 && synthetic == 0)
+  {
+    usage();
+  }
+
+#if !defined(__GLIBC__) && defined(_WIN32) && defined(_DEBUG)
+  _CrtSetAllocHook(alloc_hook);
+#endif
+
+  // open the source mesh
+
+  SMreader* smreader;
+  FILE* file_in;
+
+  if (synthetic)
+  {
+    file_in = 0;
+  }
+  else if (strstr(file_name_in, ".sma"))
+  {
+    file_in = fopen(file_name_in, "r");
+  }
+  else
+  {
+    file_in = fopen(file_name_in, "rb");
+  }
+  if (file_in == 0 && synthetic == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name_in);
+    exit(1);
+  }
+
+  if (synthetic)
+  {
+    SMreader_synthetic* smreader_synthetic = new SMreader_synthetic();
+    if (!smreader_synthetic->open(synthetic))
+    {
+      exit(1);
+    }
+    smreader = smreader_synthetic;
+  }
+  else if (strstr(file_name_in, ".sma"))
+  {
+    smreader = open_reader(0, file_in);
+  }
+  else if (strstr(file_name_in, ".smb"))
+  {
+    smreader = open_reader(1, file_in);
+  }
+  else if (strstr(file_name_in, ".smc"))
+  {
+    smreader = open_reader(2, file_in);
+  }
+  else if (strstr(file_name_in, ".smd"))
+  {
+    smreader = open_reader(3, file_in);
+  }
+  else if (strstr(file_name_in, ".ply"))
+  {
+    SMreader_ply* smreader_ply = new SMreader_ply();
+    smreader_ply->open(file_in);
+    smreader = smreader_ply;
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: cannot determine which reader to use for '%s'\n", file_name_in);
+    exit(1);
+  }
+
+  // the compressors need compact pre-order input
+
+  SMreader* smsource;
+  if (smreader->post_order)
+  {
+    SMreadPostAsCompactPre* smreadpostascompactpre = new SMreadPostAsCompactPre();
+    smreadpostascompactpre->open(smreader);
+    smsource = smreadpostascompactpre;
+  }
+  else
+  {
+    SMreadPreAsCompactPre* smreadpreascompactpre = new SMreadPreAsCompactPre();
+    smreadpreascompactpre->open(smreader);
+    smsource = smreadpreascompactpre;
+  }
+
+  // convert the source into one temporary file per input format
+
+  char file_names[NUM_INPUTS][256];
+  char file_name_out[256];
+  int elements = 0;
+  int ps_elements = 0;
+  int event;
+
+  for (i = 0; i < NUM_INPUTS; i++)
+  {
+    sprintf(file_names[i], "%s.%s", tmp_name, format_names[i]);
+  }
+  sprintf(file_name_out, "%s.out", tmp_name);
+
+  FILE* files[NUM_INPUTS];
+  SMwriter* smwriters[NUM_INPUTS];
+  for (i = 0; i < NUM_INPUTS; i++)
+  {
+    files[i] = open_file(file_names[i], i, true);
+    if (files[i] == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_names[i]);
+      exit(1);
+    }
+    smwriters[i] = open_writer(i, files[i], bits);
+    copy_header(smsource, smwriters[i]);
+  }
+
+  while ((event = smsource->read_element()) > SM_EOF)
+  {
+    for (i = 0; i < NUM_INPUTS; i++)
+    {
+      copy_element((SMevent)event, smsource, smwriters[i]);
+    }
+    elements++;
+  }
+  ps_elements = (int)(smsource->v_count + smsource->f_count);
+
+  for (i = 0; i < NUM_INPUTS; i++)
+  {
+    smwriters[i]->close();
+    fclose(files[i]);
+    delete smwriters[i];
+  }
+  smsource->close();
+  delete smsource;
+  smreader->close();
+  if (file_in) close_file(file_in, strstr(file_name_in, ".smc") ? 2 : (strstr(file_name_in, ".smd") ? 3 : 0));
+  delete smreader;
+
+  if (elements == 0)
+  {
+    fprintf(stderr,"ERROR: no elements in '%s'\n", (synthetic ? synthetic : file_name_in));
+    exit(1);
+  }
+
+  int warmup_elements = (int)(warmup*elements);
+
+  fprintf(stderr,"counting %s calls after %d of %d elements\n", interposer, warmup_elements, elements);
+  fprintf(stdout,"allocations (frees) per million elements in steady state\n");
+  fprintf(stdout,"in\\out ");
+  for (i = 0; i < NUM_OUTPUTS; i++)
+  {
+    fprintf(stdout,"%16s", format_names[i]);
+  }
+  fprintf(stdout,"\n");
+
+  // stream each temporary file through each writer
+
+  int in, out;
+  for (in = 0; in < NUM_INPUTS; in++)
+  {
+    fprintf(stdout,"%-7s", format_names[in]);
+    for (out = 0; out < NUM_OUTPUTS; out++)
+    {
+      int count = 0;
+      int counted = 0;
+      alloc_calls = 0;
+      free_calls = 0;
+
+      file_in = open_file(file_names[in], in, false);
+      smreader = open_reader(in, file_in);
+      SMreader* smfilter = smreader;
+      if (pre)
+      {
+        SMreadPreAsCompactPre* smreadpreascompactpre = new SMreadPreAsCompactPre();
+        smreadpreascompactpre->open(smreader);
+        smfilter = smreadpreascompactpre;
+      }
+
+      if (out < NUM_OUTPUTS-1)
+      {
+        FILE* file_out = open_file(file_name_out, out, true);
+        SMwriter* smwriter = open_writer(out, file_out, bits);
+        SMwriter* smbuffered = smwriter;
+        if (delay)
+        {
+          SMwriteBuffered* smwrite_buffered = new SMwriteBuffered();
+          smwrite_buffered->open(smwriter);
+          smbuffered = smwrite_buffered;
+        }
+        copy_header(smfilter, smbuffered);
+        while ((event = smfilter->read_element()) > SM_EOF)
+        {
+          copy_element((SMevent)event, smfilter, smbuffered);
+          if (count == warmup_elements) counting = true;
+          if (counting) counted++;
+          count++;
+        }
+        counting = false;
+        smbuffered->close();
+        fclose(file_out);
+        if (smbuffered != smwriter) delete smbuffered;
+        delete smwriter;
+      }
+      else
+      {
+        // elements are the vertices and triangles that the converter has output
+        PSconverter* psconverter = new PSconverter();
+        psconverter->open(smfilter);
+        int warmup_ps = (int)(warmup*ps_elements);
+        while (psconverter->read_triangle() > PS_EOF)
+        {
+          count = (int)(psconverter->v_count + psconverter->f_count);
+          if (!counting && count >= warmup_ps)
+          {
+            counting = true;
+            counted = -count;
+          }
+        }
+        counting = false;
+        counted += (int)(psconverter->v_count + psconverter->f_count);
+        psconverter->close();
+        delete psconverter;
+      }
+
+      smfilter->close();
+      close_file(file_in, in);
+      if (smfilter != smreader) delete smfilter;
+      delete smreader;
+
+      if (counted > 0)
+      {
+        char result[64];
+        sprintf(result, "%.1f (%.1f)", 1000000.0*alloc_calls/counted, 1000000.0*free_calls/counted);
+        fprintf(stdout,"%16s", result);
+      }
+      else
+      {
+        fprintf(stdout,"%16s", "-");
+      }
+    }
+    fprintf(stdout,"\n");
+  }
+
+  for (i = 0; i < NUM_INPUTS; i++)
+  {
+    remove(file_names[i]);
+  }
+  remove(file_name_out);
+
+  return 1;
+}
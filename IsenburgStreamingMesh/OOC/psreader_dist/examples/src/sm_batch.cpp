@@ -0,0 +1,812 @@
+/*
+===============================================================================
+
+  FILE:  sm_batch.cpp
+
+  CONTENTS:
+
+    This program converts many streaming meshes at once. It reads a manifest
+    with one conversion per line
+
+      input output [bits [delay]]
+
+    (e.g. 'tile_0017.smb tile_0017.smc 16 100') where the optional bits and
+    delay are used like the '-bits' and '-delay' options of sm2sm. empty
+    lines and lines that start with '#' are skipped. an input of the form
+    'synthetic:terrain,1024,1024' is generated by SMreader_synthetic.
+
+    the conversions run on a pool of threads. every thread has its own
+    queue of jobs and steals from the queues of the other threads once its
+    own queue is empty. every thread keeps its readers and writers from job
+    to job, so their buffers only grow during the first few jobs.
+
+    with '-memory' the memory that the jobs in flight may use together is
+    limited. a streaming conversion never holds more than the entire mesh
+    and the size of the mesh is estimated from the size of the input file
+    before the job starts. a job that is larger than the limit only starts
+    once no other job is in flight.
+
+    with '-csv' one line per job with the time, the compression ratio, and
+    the peak number of elements that the readers and writers buffered is
+    written into a comma-separated file.
+
+    only formats whose readers and writers keep all their state in the
+    reader or writer are supported: SMA, SMB, and SMC (SME) as input and as
+    output. a delay re-orders through SMwriteBuffered and is only used for
+    SMC output.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created for the nightly compression of scan tiles
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smreader_synthetic.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+
+#include "smwritebuffered.h"
+
+#include "smstats.h"
+
+#define SM_BATCH_MAX_THREADS 64
+
+// compressed input files are estimated to expand this much in memory
+
+#define SM_BATCH_SMC_EXPANSION 8
+
+// per vertex of a synthetic mesh
+
+#define SM_BATCH_SYNTHETIC_BYTES 64
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_batch -i manifest.txt\n");
+  fprintf(stderr,"sm_batch -i manifest.txt -threads 8 -memory 2048 -csv timing.csv\n");
+  fprintf(stderr,"sm_batch -i manifest.txt -bits 12 -delay 100\n");
+  fprintf(stderr,"sm_batch -h\n");
+  exit(1);
+}
+
+// a conversion and what came of it
+
+typedef struct SMjob
+{
+  char* file_name_in;
+  char* file_name_out;
+  int bits;
+  int delay;
+  double reserve;            // the memory it may need (in bytes)
+  bool ok;
+  double seconds;
+  SMidx nverts;
+  SMidx nfaces;
+  double bytes_in;
+  double bytes_out;
+  SMcount peak_buffer;
+  int thread;
+} SMjob;
+
+// a thread with its queue of jobs and its readers and writers
+
+typedef struct SMworker
+{
+  int id;
+  int* queue;
+  int queue_first;
+  int queue_last;
+  SMreader_sma* smreader_sma;
+  SMreader_smb* smreader_smb;
+  SMreader_smc* smreader_smc;
+  SMreader_synthetic* smreader_synthetic;
+  SMwriter_sma* smwriter_sma;
+  SMwriter_smb* smwriter_smb;
+  SMwriter_smc* smwriter_smc;
+  SMwriteBuffered* smwrite_buffered;
+} SMworker;
+
+static SMjob* jobs = 0;
+static int jobs_number = 0;
+static int jobs_done = 0;
+
+static SMworker* workers = 0;
+static int workers_number = 0;
+
+static double memory_limit = 0;
+static double memory_in_flight = 0;
+static int jobs_in_flight = 0;
+
+// threads, locks, and time
+
+#ifdef _WIN32
+static CRITICAL_SECTION queue_lock;
+static CRITICAL_SECTION memory_lock;
+
+static void init_locks() { InitializeCriticalSection(&queue_lock); InitializeCriticalSection(&memory_lock); }
+static void lock_queues() { EnterCriticalSection(&queue_lock); }
+static void unlock_queues() { LeaveCriticalSection(&queue_lock); }
+static void lock_memory() { EnterCriticalSection(&memory_lock); }
+static void unlock_memory() { LeaveCriticalSection(&memory_lock); }
+static void wait_a_little() { Sleep(1); }
+
+static double get_time()
+{
+  return 0.001*GetTickCount();
+}
+
+static int number_of_processors()
+{
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors;
+}
+#else
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t memory_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void init_locks() { }
+static void lock_queues() { pthread_mutex_lock(&queue_lock); }
+static void unlock_queues() { pthread_mutex_unlock(&queue_lock); }
+static void lock_memory() { pthread_mutex_lock(&memory_lock); }
+static void unlock_memory() { pthread_mutex_unlock(&memory_lock); }
+static void wait_a_little() { usleep(1000); }
+
+static double get_time()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + 0.000001*tv.tv_usec;
+}
+
+static int number_of_processors()
+{
+  return (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+#endif
+
+// a thread takes jobs from the front of its own queue and steals them from
+// the back of the longest other queue
+
+static int next_job(SMworker* worker)
+{
+  int i, job, victim;
+
+  lock_queues();
+  if (worker->queue_first < worker->queue_last)
+  {
+    job = worker->queue[worker->queue_first];
+    worker->queue_first++;
+  }
+  else
+  {
+    victim = -1;
+    for (i = 0; i < workers_number; i++)
+    {
+      if (workers[i].queue_last - workers[i].queue_first > 0)
+      {
+        if (victim == -1 || workers[i].queue_last - workers[i].queue_first > workers[victim].queue_last - workers[victim].queue_first)
+        {
+          victim = i;
+        }
+      }
+    }
+    if (victim != -1)
+    {
+      workers[victim].queue_last--;
+      job = workers[victim].queue[workers[victim].queue_last];
+    }
+    else
+    {
+      job = -1;
+    }
+  }
+  unlock_queues();
+  return job;
+}
+
+// waits until the memory of a job fits next to the jobs in flight
+
+static void reserve_memory(double bytes)
+{
+  while (true)
+  {
+    lock_memory();
+    if (jobs_in_flight == 0 || memory_limit == 0 || memory_in_flight + bytes <= memory_limit)
+    {
+      memory_in_flight += bytes;
+      jobs_in_flight++;
+      unlock_memory();
+      return;
+    }
+    unlock_memory();
+    wait_a_little();
+  }
+}
+
+static void release_memory(double bytes)
+{
+  lock_memory();
+  memory_in_flight -= bytes;
+  jobs_in_flight--;
+  unlock_memory();
+}
+
+static double file_size(FILE* file)
+{
+  long pos = ftell(file);
+  fseek(file, 0, SEEK_END);
+  double size = (double)ftell(file);
+  fseek(file, pos, SEEK_SET);
+  return size;
+}
+
+// adds up the high-water marks of the buffers (e.g. 'vertex_buffer')
+
+static SMcount peak_buffer(const SMstats* stats)
+{
+  int i;
+  SMcount peak = 0;
+  if (stats)
+  {
+    for (i = 0; i < stats->size(); i++)
+    {
+      const SMstat* stat = stats->get(i);
+      int len = (int)strlen(stat->name);
+      if (stat->type == SM_STATS_LEVEL && len > 7 && strcmp(stat->name + len - 7, "_buffer") == 0)
+      {
+        peak += stat->max;
+      }
+    }
+  }
+  return peak;
+}
+
+// readers and writers only clear the counts and the bounding box in their
+// constructor. a reused one would carry them over from the previous mesh.
+
+static void forget_header(SMreader* smreader)
+{
+  smreader->nverts = -1;
+  smreader->nfaces = -1;
+  if (smreader->bb_min_f) delete [] smreader->bb_min_f;
+  if (smreader->bb_max_f) delete [] smreader->bb_max_f;
+  smreader->bb_min_f = 0;
+  smreader->bb_max_f = 0;
+}
+
+static void forget_header(SMwriter* smwriter)
+{
+  smwriter->nverts = -1;
+  smwriter->nfaces = -1;
+  if (smwriter->bb_min_f) delete [] smwriter->bb_min_f;
+  if (smwriter->bb_max_f) delete [] smwriter->bb_max_f;
+  smwriter->bb_min_f = 0;
+  smwriter->bb_max_f = 0;
+}
+
+static bool convert(SMworker* worker, SMjob* job)
+{
+  const char* file_name_in = job->file_name_in;
+  const char* file_name_out = job->file_name_out;
+  SMreader* smreader = 0;
+  SMwriter* smwriter = 0;
+  SMwriter* smwriter_delayed = 0;
+  FILE* file_in = 0;
+  FILE* file_out = 0;
+  SMevent event;
+
+  // open the input and estimate how much memory the job needs
+
+  if (strncmp(file_name_in, "synthetic:", 10) == 0)
+  {
+    forget_header(worker->smreader_synthetic);
+    if (!worker->smreader_synthetic->open(file_name_in + 10))
+    {
+      return false;
+    }
+    smreader = worker->smreader_synthetic;
+    job->reserve = (smreader->nverts > 0 ? (double)SM_BATCH_SYNTHETIC_BYTES*smreader->nverts : 0);
+  }
+  else
+  {
+    if (strstr(file_name_in, ".sma"))
+    {
+      file_in = fopen(file_name_in, "r");
+    }
+    else if (strstr(file_name_in, ".smb") || strstr(file_name_in, ".smc") || strstr(file_name_in, ".sme"))
+    {
+      file_in = fopen(file_name_in, "rb");
+    }
+    else
+    {
+      fprintf(stderr,"ERROR: input file '%s' name does not end in .sma .smb .smc or .sme. use sm2sm\n", file_name_in);
+      return false;
+    }
+    if (file_in == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name_in);
+      return false;
+    }
+    job->bytes_in = file_size(file_in);
+    job->reserve = job->bytes_in;
+
+    if (strstr(file_name_in, ".sma"))
+    {
+      forget_header(worker->smreader_sma);
+      worker->smreader_sma->open(file_in);
+      smreader = worker->smreader_sma;
+    }
+    else if (strstr(file_name_in, ".smb"))
+    {
+      forget_header(worker->smreader_smb);
+      worker->smreader_smb->open(file_in);
+      smreader = worker->smreader_smb;
+    }
+    else
+    {
+      forget_header(worker->smreader_smc);
+      if (!worker->smreader_smc->open(file_in))
+      {
+        fclose(file_in);
+        return false;
+      }
+      smreader = worker->smreader_smc;
+      file_in = 0; // closing the SMC reader closes the file
+      job->reserve = SM_BATCH_SMC_EXPANSION*job->bytes_in;
+    }
+  }
+
+  if (smreader->post_order)
+  {
+    fprintf(stderr,"ERROR: '%s' is in post-order. use sm2sm\n", file_name_in);
+    smreader->close();
+    if (file_in) fclose(file_in);
+    return false;
+  }
+
+  // open the output
+
+  if (strstr(file_name_out, ".sma"))
+  {
+    file_out = fopen(file_name_out, "w");
+  }
+  else if (strstr(file_name_out, ".smb") || strstr(file_name_out, ".smc") || strstr(file_name_out, ".sme"))
+  {
+    file_out = fopen(file_name_out, "wb");
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: output file name '%s' does not end in .sma .smb .smc or .sme. use sm2sm\n", file_name_out);
+    smreader->close();
+    if (file_in) fclose(file_in);
+    return false;
+  }
+  if (file_out == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name_out);
+    smreader->close();
+    if (file_in) fclose(file_in);
+    return false;
+  }
+
+  if (strstr(file_name_out, ".sma"))
+  {
+    forget_header(worker->smwriter_sma);
+    worker->smwriter_sma->open(file_out);
+    smwriter = worker->smwriter_sma;
+  }
+  else if (strstr(file_name_out, ".smb"))
+  {
+    forget_header(worker->smwriter_smb);
+    worker->smwriter_smb->open(file_out);
+    smwriter = worker->smwriter_smb;
+  }
+  else
+  {
+    forget_header(worker->smwriter_smc);
+    worker->smwriter_smc->open(file_out, job->bits);
+    smwriter = worker->smwriter_smc;
+    if (job->delay)
+    {
+      worker->smwrite_buffered->open(worker->smwriter_smc, job->delay);
+      smwriter_delayed = worker->smwriter_smc;
+      smwriter = worker->smwrite_buffered;
+    }
+  }
+
+  // convert
+
+  reserve_memory(job->reserve);
+
+  double start = get_time();
+
+  if (smreader->nverts != -1) smwriter->set_nverts(smreader->nverts);
+  if (smreader->nfaces != -1) smwriter->set_nfaces(smreader->nfaces);
+  if (smreader->bb_min_f || smreader->bb_max_f) smwriter->set_boundingbox(smreader->bb_min_f, smreader->bb_max_f);
+
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    switch (event)
+    {
+    case SM_VERTEX:
+      smwriter->write_vertex(smreader->v_pos_f);
+      break;
+    case SM_TRIANGLE:
+      smwriter->write_triangle(smreader->t_idx, smreader->t_final);
+      break;
+    case SM_FINALIZED:
+      smwriter->write_finalized(smreader->final_idx);
+      break;
+    default:
+      break;
+    }
+  }
+
+  job->nverts = smreader->v_count;
+  job->nfaces = smreader->f_count;
+
+  smwriter->close();
+  job->bytes_out = (double)ftell(file_out);
+  fclose(file_out);
+
+  job->seconds = get_time() - start;
+
+  release_memory(job->reserve);
+
+  job->peak_buffer = peak_buffer(smreader->get_stats()) + peak_buffer(smwriter->get_stats());
+  if (smwriter_delayed) job->peak_buffer += peak_buffer(smwriter_delayed->get_stats());
+
+  smreader->close();
+  if (file_in) fclose(file_in);
+
+  if (event == SM_ERROR)
+  {
+    fprintf(stderr,"ERROR: failed reading '%s'\n", file_name_in);
+    return false;
+  }
+  return true;
+}
+
+static int compare_jobs(const void* a, const void* b)
+{
+  double size_a = jobs[*((const int*)a)].reserve;
+  double size_b = jobs[*((const int*)b)].reserve;
+  if (size_a > size_b) return -1;
+  if (size_a < size_b) return 1;
+  return 0;
+}
+
+#ifdef _WIN32
+static unsigned __stdcall work(void* arg)
+#else
+static void* work(void* arg)
+#endif
+{
+  SMworker* worker = (SMworker*)arg;
+  int j;
+
+  worker->smreader_sma = new SMreader_sma();
+  worker->smreader_smb = new SMreader_smb();
+  worker->smreader_smc = new SMreader_smc();
+  worker->smreader_synthetic = new SMreader_synthetic();
+  worker->smwriter_sma = new SMwriter_sma();
+  worker->smwriter_smb = new SMwriter_smb();
+  worker->smwriter_smc = new SMwriter_smc();
+  worker->smwrite_buffered = new SMwriteBuffered();
+
+  while ((j = next_job(worker)) != -1)
+  {
+    SMjob* job = &(jobs[j]);
+    job->thread = worker->id;
+    job->ok = convert(worker, job);
+    lock_queues();
+    jobs_done++;
+    fprintf(stderr,"%d of %d %s '%s' -> '%s' (%.3f seconds)\n", jobs_done, jobs_number, (job->ok ? "converted" : "FAILED"), job->file_name_in, job->file_name_out, job->seconds);
+    unlock_queues();
+  }
+
+  delete worker->smreader_sma;
+  delete worker->smreader_smb;
+  delete worker->smreader_smc;
+  delete worker->smreader_synthetic;
+  delete worker->smwriter_sma;
+  delete worker->smwriter_smb;
+  delete worker->smwriter_smc;
+  delete worker->smwrite_buffered;
+
+  return 0;
+}
+
+// reads the manifest. returns the number of jobs or -1
+
+static int read_manifest(const char* file_name, int bits, int delay)
+{
+  char line[2048];
+  char name_in[1024];
+  char name_out[1024];
+  int n, line_number, job_bits, job_delay;
+
+  FILE* file = fopen(file_name, "r");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name);
+    return -1;
+  }
+
+  int jobs_alloc = 1024;
+  jobs = (SMjob*)malloc(sizeof(SMjob)*jobs_alloc);
+  jobs_number = 0;
+  line_number = 0;
+
+  while (fgets(line, 2048, file))
+  {
+    line_number++;
+    job_bits = bits;
+    job_delay = delay;
+    n = sscanf(line, "%1023s %1023s %d %d", name_in, name_out, &job_bits, &job_delay);
+    if (n <= 0 || name_in[0] == '#')
+    {
+      continue;
+    }
+    if (n == 1)
+    {
+      fprintf(stderr,"ERROR: line %d of '%s' has no output\n", line_number, file_name);
+      fclose(file);
+      return -1;
+    }
+    if (jobs_number == jobs_alloc)
+    {
+      jobs_alloc *= 2;
+      jobs = (SMjob*)realloc(jobs, sizeof(SMjob)*jobs_alloc);
+    }
+    SMjob* job = &(jobs[jobs_number]);
+    memset(job, 0, sizeof(SMjob));
+    job->file_name_in = strdup(name_in);
+    job->file_name_out = strdup(name_out);
+    job->bits = job_bits;
+    job->delay = job_delay;
+    job->thread = -1;
+    jobs_number++;
+  }
+
+  fclose(file);
+  return jobs_number;
+}
+
+// names with a comma (e.g. 'synthetic:torus,64,64') are quoted
+
+static void write_csv_name(FILE* file, const char* name)
+{
+  if (strchr(name, ','))
+  {
+    fprintf(file, "\"%s\",", name);
+  }
+  else
+  {
+    fprintf(file, "%s,", name);
+  }
+}
+
+static bool write_csv(const char* file_name)
+{
+  FILE* file = fopen(file_name, "w");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name);
+    return false;
+  }
+  fprintf(file, "input,output,ok,seconds,nverts,nfaces,bytes_in,bytes_out,ratio,peak_buffer,thread\n");
+  for (int j = 0; j < jobs_number; j++)
+  {
+    SMjob* job = &(jobs[j]);
+    write_csv_name(file, job->file_name_in);
+    write_csv_name(file, job->file_name_out);
+    fprintf(file, "%d,%.3f," SM_IDX_FORMAT "," SM_IDX_FORMAT ",%.0f,%.0f,%.3f," SM_COUNT_FORMAT ",%d\n", (job->ok ? 1 : 0), job->seconds, job->nverts, job->nfaces, job->bytes_in, job->bytes_out, (job->ok && job->bytes_out > 0 ? job->bytes_in/job->bytes_out : 0.0), job->peak_buffer, job->thread);
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int i, j;
+  int bits = 16;
+  int delay = 0;
+  int threads = 0;
+  char* file_name_manifest = 0;
+  char* file_name_csv = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-i") == 0)
+    {
+      i++;
+      file_name_manifest = argv[i];
+    }
+    else if (strcmp(argv[i],"-csv") == 0)
+    {
+      i++;
+      file_name_csv = argv[i];
+    }
+    else if (strcmp(argv[i],"-b") == 0 || strcmp(argv[i],"-bits") == 0)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-delay") == 0)
+    {
+      i++;
+      delay = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-threads") == 0)
+    {
+      i++;
+      threads = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-memory") == 0)
+    {
+      i++;
+      memory_limit = 1024.0*1024.0*atof(argv[i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (file_name_manifest == 0 || i > argc)
+  {
+    usage();
+  }
+
+  if (read_manifest(file_name_manifest, bits, delay) < 0)
+  {
+    exit(1);
+  }
+
+  if (threads <= 0)
+  {
+    threads = number_of_processors();
+  }
+  if (threads > SM_BATCH_MAX_THREADS)
+  {
+    threads = SM_BATCH_MAX_THREADS;
+  }
+  if (threads > jobs_number)
+  {
+    threads = (jobs_number ? jobs_number : 1);
+  }
+
+  // the largest jobs go first so that no thread is left with a big job at
+  // the end. then deal them round robin into the queues of the threads
+
+  for (j = 0; j < jobs_number; j++)
+  {
+    FILE* file = fopen(jobs[j].file_name_in, "rb");
+    if (file)
+    {
+      jobs[j].reserve = file_size(file);
+      fclose(file);
+    }
+  }
+  int* order = (int*)malloc(sizeof(int)*(jobs_number+1));
+  for (j = 0; j < jobs_number; j++)
+  {
+    order[j] = j;
+  }
+  qsort(order, jobs_number, sizeof(int), compare_jobs);
+
+  workers_number = threads;
+  workers = (SMworker*)malloc(sizeof(SMworker)*workers_number);
+  for (i = 0; i < workers_number; i++)
+  {
+    workers[i].id = i;
+    workers[i].queue = (int*)malloc(sizeof(int)*(jobs_number/workers_number + 1));
+    workers[i].queue_first = 0;
+    workers[i].queue_last = 0;
+  }
+  for (j = 0; j < jobs_number; j++)
+  {
+    SMworker* worker = &(workers[j%workers_number]);
+    worker->queue[worker->queue_last] = order[j];
+    worker->queue_last++;
+  }
+  free(order);
+
+  init_locks();
+
+  fprintf(stderr,"converting %d meshes with %d threads\n", jobs_number, workers_number);
+
+  double start = get_time();
+
+  // the main thread works as the first thread
+
+#ifdef _WIN32
+  HANDLE handles[SM_BATCH_MAX_THREADS];
+  for (i = 1; i < workers_number; i++)
+  {
+    handles[i] = (HANDLE)_beginthreadex(0, 0, work, &(workers[i]), 0, 0);
+  }
+  work(&(workers[0]));
+  for (i = 1; i < workers_number; i++)
+  {
+    if (handles[i])
+    {
+      WaitForSingleObject(handles[i], INFINITE);
+      CloseHandle(handles[i]);
+    }
+  }
+#else
+  pthread_t handles[SM_BATCH_MAX_THREADS];
+  bool started[SM_BATCH_MAX_THREADS];
+  for (i = 1; i < workers_number; i++)
+  {
+    started[i] = (pthread_create(&(handles[i]), 0, work, &(workers[i])) == 0);
+  }
+  work(&(workers[0]));
+  for (i = 1; i < workers_number; i++)
+  {
+    if (started[i])
+    {
+      pthread_join(handles[i], 0);
+    }
+  }
+#endif
+
+  int failed = 0;
+  for (j = 0; j < jobs_number; j++)
+  {
+    if (!jobs[j].ok) failed++;
+  }
+
+  fprintf(stderr,"converted %d meshes in %.3f seconds. %d failed.\n", jobs_number - failed, get_time() - start, failed);
+
+  if (file_name_csv)
+  {
+    write_csv(file_name_csv);
+  }
+
+  for (i = 0; i < workers_number; i++)
+  {
+    free(workers[i].queue);
+  }
+  free(workers);
+  for (j = 0; j < jobs_number; j++)
+  {
+    free(jobs[j].file_name_in);
+    free(jobs[j].file_name_out);
+  }
+  free(jobs);
+
+  return (failed ? 1 : 0);
+}
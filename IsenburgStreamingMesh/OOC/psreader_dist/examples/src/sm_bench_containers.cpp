@@ -0,0 +1,712 @@
+/*
+===============================================================================
+
+  FILE:  sm_bench_containers.cpp
+
+  CONTENTS:
+
+    This program measures the cost per operation of the intrusive containers
+    (DynamicVector, DynamicQueue, CrazyVector, TSCvector) that are used in the
+    inner loops of the SMC/SMD compressors and the OOCC decompressor. For each
+    container it replays an access pattern like the one of its compressor and
+    compares the inlined templated container against a reference copy of the
+    old out-of-line void* implementation that is kept in this file. The
+    copies only have the operations that the access patterns use.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- also compares CrazyVector and TSCvector with void* copies
+    19 October 2026 -- created to compare templated with void* containers
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dynamicvector.h"
+#include "dynamicqueue.h"
+#include "crazyvector_for_pointers.h"
+#include "vector.h"
+
+#ifdef _WIN32
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+// the element type that is stored in all containers
+
+typedef struct Element
+{
+  union
+  {
+    Element* buffer_next;
+    int dynamicvector;
+  };
+  int index;
+} Element;
+
+typedef DynamicVector<Element,&Element::dynamicvector> my_element_vector;
+typedef DynamicQueue<Element,&Element::dynamicvector> my_element_queue;
+
+// reference copy of the old void* dynamicvector (operations are out-of-line)
+
+class VoidDynamicVector
+{
+public:
+  VoidDynamicVector();
+  ~VoidDynamicVector();
+
+  NOINLINE int size() const;
+  NOINLINE void* getElementWithRelativeIndex(int ri) const;
+  NOINLINE int getRelativeIndex(void* d) const;
+  NOINLINE void addElement(void* d);
+  NOINLINE void removeElement(void* d);
+
+private:
+  void** data;
+  int current_capacity;
+  int current_capacity_mask;
+  int current_begin;
+  int current_end;
+  int current_size;
+};
+
+VoidDynamicVector::VoidDynamicVector()
+{
+  current_capacity = 1024;
+  current_capacity_mask = current_capacity-1;
+  data = (void**) malloc(sizeof(void*)*current_capacity);
+  current_size = 0;
+  current_begin = 0;
+  current_end = 0;
+}
+
+VoidDynamicVector::~VoidDynamicVector()
+{
+  free(data);
+}
+
+int VoidDynamicVector::size() const
+{
+  return current_size;
+}
+
+void* VoidDynamicVector::getElementWithRelativeIndex(int ri) const
+{
+  return data[(ri + current_begin) & current_capacity_mask];
+}
+
+int VoidDynamicVector::getRelativeIndex(void* d) const
+{
+  int ai = ((int*)d)[0];
+  if (current_begin <= ai)
+  {
+    return ai - current_begin;
+  }
+  else
+  {
+    return ai + current_capacity - current_begin;
+  }
+}
+
+void VoidDynamicVector::addElement(void* d)
+{
+  if (current_size == current_capacity)
+  {
+    void** temp = (void**) malloc(sizeof(void*)*current_capacity*2);
+    int rest = current_size-current_begin;
+    memcpy(temp, &(data[current_begin]), sizeof(void*)*rest);
+    memcpy(&(temp[rest]), data, sizeof(void*)*(current_size-rest));
+    free(data);
+    data = temp;
+    for (int i = 0; i < current_size; i++)
+    {
+      ((int*)(data[i]))[0] = i;
+    }
+    current_begin = 0;
+    current_end = current_size;
+    current_capacity = current_capacity * 2;
+    current_capacity_mask = current_capacity - 1;
+  }
+  data[current_end] = d;
+  ((int*)d)[0] = current_end;
+  current_end = (current_end + 1) & current_capacity_mask;
+  current_size++;
+}
+
+void VoidDynamicVector::removeElement(void* d)
+{
+  int ai = ((int*)d)[0];
+  if (ai != current_begin)
+  {
+    data[ai] = data[current_begin];
+    ((int*)(data[ai]))[0] = ai;
+  }
+  current_begin = (current_begin + 1) & current_capacity_mask;
+  current_size--;
+}
+
+// reference copy of the old void* dynamicqueue (operations are out-of-line)
+
+class VoidDynamicQueue
+{
+public:
+  VoidDynamicQueue();
+  ~VoidDynamicQueue();
+
+  NOINLINE int elements() const;
+  NOINLINE void* getAndRemoveFirstElement();
+  NOINLINE void addElement(void* d);
+  NOINLINE void removeElement(const void* d);
+  NOINLINE void removeFirstElement();
+
+private:
+  void** data;
+  int current_capacity;
+  int current_capacity_mask;
+  int current_begin;
+  int current_end;
+  int current_size;
+  int number_elements;
+};
+
+VoidDynamicQueue::VoidDynamicQueue()
+{
+  current_capacity = 1024;
+  current_capacity_mask = current_capacity-1;
+  data = (void**) malloc(sizeof(void*)*current_capacity);
+  current_size = 0;
+  current_begin = 0;
+  current_end = 0;
+  number_elements = 0;
+}
+
+VoidDynamicQueue::~VoidDynamicQueue()
+{
+  free(data);
+}
+
+int VoidDynamicQueue::elements() const
+{
+  return number_elements;
+}
+
+void* VoidDynamicQueue::getAndRemoveFirstElement()
+{
+  void* d = data[current_begin];
+  removeFirstElement();
+  return d;
+}
+
+void VoidDynamicQueue::addElement(void* d)
+{
+  if (current_size == current_capacity)
+  {
+    void** temp = (void**) malloc(sizeof(void*)*current_capacity*2);
+    int rest = current_size-current_begin;
+    memcpy(temp, &(data[current_begin]), sizeof(void*)*rest);
+    memcpy(&(temp[rest]), data, sizeof(void*)*(current_size-rest));
+    free(data);
+    data = temp;
+    for (int i = 0; i < current_size; i++)
+    {
+      if (data[i]) ((int*)(data[i]))[0] = i;
+    }
+    current_begin = 0;
+    current_end = current_size;
+    current_capacity = current_capacity * 2;
+    current_capacity_mask = current_capacity - 1;
+  }
+  data[current_end] = d;
+  ((int*)d)[0] = current_end;
+  current_end = (current_end + 1) & current_capacity_mask;
+  current_size++;
+  number_elements++;
+}
+
+void VoidDynamicQueue::removeElement(const void* d)
+{
+  int i = ((const int*)d)[0];
+  if (i == current_begin)
+  {
+    removeFirstElement();
+  }
+  else
+  {
+    data[i] = 0;
+    number_elements--;
+  }
+}
+
+void VoidDynamicQueue::removeFirstElement()
+{
+  current_begin = (current_begin + 1) & current_capacity_mask;
+  current_size--;
+  number_elements--;
+  while (current_size && (data[current_begin] == 0))
+  {
+    current_begin = (current_begin + 1) & current_capacity_mask;
+    current_size--;
+  }
+}
+
+// reference copy of the old void* crazyvector (operations are out-of-line)
+
+class VoidCrazyVector
+{
+public:
+  VoidCrazyVector();
+  ~VoidCrazyVector();
+
+  NOINLINE int size() const;
+  NOINLINE void* elementAt(int i) const;
+  NOINLINE void addElement(const void* d);
+  NOINLINE void lazyRemoveElementAt(int i);
+
+private:
+  const void** data;
+  int current_capacity;
+  int current_capacity_mask;
+  int current_begin;
+  int current_end;
+  int current_size;
+};
+
+VoidCrazyVector::VoidCrazyVector()
+{
+  current_capacity = 1024;
+  current_capacity_mask = current_capacity-1;
+  data = (const void**) malloc(sizeof(void*)*current_capacity);
+  current_size = 0;
+  current_begin = 0;
+  current_end = 0;
+}
+
+VoidCrazyVector::~VoidCrazyVector()
+{
+  free(data);
+}
+
+int VoidCrazyVector::size() const
+{
+  return current_size;
+}
+
+void* VoidCrazyVector::elementAt(int i) const
+{
+  return (void*)data[((i + current_begin) & current_capacity_mask)];
+}
+
+void VoidCrazyVector::addElement(const void* d)
+{
+  if (current_size == current_capacity)
+  {
+    const void** temp = (const void**) malloc(sizeof(void*)*current_capacity*2);
+    int rest = current_size-current_begin;
+    memcpy(temp, &(data[current_begin]), sizeof(void*)*rest);
+    memcpy(&(temp[rest]), data, sizeof(void*)*(current_size-rest));
+    free(data);
+    data = temp;
+    current_begin = 0;
+    current_end = current_size;
+    current_capacity = current_capacity * 2;
+    current_capacity_mask = current_capacity - 1;
+  }
+  data[current_end] = d;
+  current_end = (current_end + 1) & current_capacity_mask;
+  current_size++;
+}
+
+void VoidCrazyVector::lazyRemoveElementAt(int i)
+{
+  int ri = (i + current_begin)&current_capacity_mask;
+  if (i == 0)
+  {
+    ri = (ri+1)&current_capacity_mask;
+    current_size--;
+    while ((data[ri] == 0) && current_size)
+    {
+      ri = (ri+1)&current_capacity_mask;
+      current_size--;
+    }
+    current_begin = ri;
+  }
+  else
+  {
+    data[ri] = 0;
+  }
+}
+
+// reference copy of the old void* tscvector (operations are out-of-line)
+
+class VoidTSCvector
+{
+public:
+  VoidTSCvector();
+  ~VoidTSCvector();
+
+  NOINLINE int size() const;
+  NOINLINE void* lastElement();
+  NOINLINE void addElement(void* e);
+  NOINLINE void removeLastElement();
+
+private:
+  void** data;
+  int current_capacity;
+  int current_size;
+};
+
+VoidTSCvector::VoidTSCvector()
+{
+  current_size = 0;
+  current_capacity = 1000;
+  data = (void**) malloc(sizeof(void*)*1000);
+}
+
+VoidTSCvector::~VoidTSCvector()
+{
+  free(data);
+}
+
+int VoidTSCvector::size() const
+{
+  return current_size;
+}
+
+void* VoidTSCvector::lastElement()
+{
+  if (current_size == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    return data[current_size-1];
+  }
+}
+
+void VoidTSCvector::addElement(void* e)
+{
+  if (current_capacity == current_size)
+  {
+    void** temp = (void**) malloc(sizeof(void*)*current_capacity*2);
+    for (int i = 0; i < current_size; i++)
+    {
+      temp[i] = data[i];
+    }
+    current_capacity = current_capacity*2;
+    free(data);
+    data = temp;
+  }
+  data[current_size] = e;
+  current_size++;
+}
+
+void VoidTSCvector::removeLastElement()
+{
+  if (current_size > 0)
+  {
+    current_size--;
+  }
+}
+
+// a tiny deterministic random number generator so that both runs are equal
+
+static unsigned int rand_state = 1;
+
+static inline int next_rand(int range)
+{
+  rand_state = rand_state * 1103515245 + 12345;
+  return (int)((rand_state >> 8) % (unsigned int)range);
+}
+
+static float elapsed(clock_t start, int ops)
+{
+  return 1.0e9f * ((float)(clock() - start) / CLOCKS_PER_SEC) / ops;
+}
+
+// the access pattern of the SMC compressor: vertices are added to the vector
+// of active vertices, looked up by relative index, and removed on finalization
+
+static unsigned int bench_dynamicvector_void(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  VoidDynamicVector* dv = new VoidDynamicVector();
+  for (i = 0; i < width; i++) dv->addElement(&elements[i]);
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    Element* e = (Element*)dv->getElementWithRelativeIndex(next_rand(dv->size()));
+    sum += dv->getRelativeIndex(e);
+    dv->removeElement(e);
+    dv->addElement(e);
+  }
+  delete dv;
+  return sum;
+}
+
+static unsigned int bench_dynamicvector(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  my_element_vector* dv = new my_element_vector();
+  for (i = 0; i < width; i++) dv->addElement(&elements[i]);
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    Element* e = dv->getElementWithRelativeIndex(next_rand(dv->size()));
+    sum += dv->getRelativeIndex(e);
+    dv->removeElement(e);
+    dv->addElement(e);
+  }
+  delete dv;
+  return sum;
+}
+
+// the access pattern of the SMD compressor: edges are appended to the
+// traversal queue, some are removed from its middle, the first is popped
+
+static unsigned int bench_dynamicqueue_void(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  VoidDynamicQueue* dq = new VoidDynamicQueue();
+  for (i = 0; i < width; i++) dq->addElement(&elements[i]);
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    Element* e = (Element*)dq->getAndRemoveFirstElement();
+    sum += e->index;
+    if (next_rand(4) == 0)
+    {
+      Element* m = &elements[(e->index + width/2) % width];
+      if (m->dynamicvector >= 0)
+      {
+        dq->removeElement(m);
+        m->dynamicvector = -1;
+      }
+    }
+    dq->addElement(e);
+    if (dq->elements() < width/2) for (int j = 0; j < width; j++) if (elements[j].dynamicvector < 0) dq->addElement(&elements[j]);
+  }
+  delete dq;
+  return sum;
+}
+
+static unsigned int bench_dynamicqueue(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  my_element_queue* dq = new my_element_queue();
+  for (i = 0; i < width; i++) dq->addElement(&elements[i]);
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    Element* e = dq->getAndRemoveFirstElement();
+    sum += e->index;
+    if (next_rand(4) == 0)
+    {
+      Element* m = &elements[(e->index + width/2) % width];
+      if (m->dynamicvector >= 0)
+      {
+        dq->removeElement(m);
+        m->dynamicvector = -1;
+      }
+    }
+    dq->addElement(e);
+    if (dq->elements() < width/2) for (int j = 0; j < width; j++) if (elements[j].dynamicvector < 0) dq->addElement(&elements[j]);
+  }
+  delete dq;
+  return sum;
+}
+
+// the access pattern of the OOCC decompressor: non-manifold vertices are
+// added, looked up by position, and lazily removed
+
+static unsigned int bench_crazyvector_void(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  VoidCrazyVector* cv = new VoidCrazyVector();
+  for (i = 0; i < width; i++) cv->addElement(&elements[i]);
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    cv->addElement(&elements[i % width]);
+    int r = next_rand(cv->size());
+    Element* e = (Element*)cv->elementAt(r);
+    if (e)
+    {
+      sum += e->index;
+      cv->lazyRemoveElementAt(r);
+    }
+    if (cv->size() > 2*width)
+    {
+      cv->lazyRemoveElementAt(0);
+    }
+  }
+  delete cv;
+  return sum;
+}
+
+static unsigned int bench_crazyvector(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  CrazyVector<Element>* cv = new CrazyVector<Element>();
+  for (i = 0; i < width; i++) cv->addElement(&elements[i]);
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    cv->addElement(&elements[i % width]);
+    int r = next_rand(cv->size());
+    Element* e = cv->elementAt(r);
+    if (e)
+    {
+      sum += e->index;
+      cv->lazyRemoveElementAt(r);
+    }
+    if (cv->size() > 2*width)
+    {
+      cv->lazyRemoveElementAt(0);
+    }
+  }
+  delete cv;
+  return sum;
+}
+
+// the access pattern of the boundary stack in the OOCC decompressor
+
+static unsigned int bench_tscvector_void(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  VoidTSCvector* tv = new VoidTSCvector();
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    tv->addElement(&elements[i % width]);
+    if (next_rand(3) == 0 || tv->size() > width)
+    {
+      sum += ((Element*)tv->lastElement())->index;
+      tv->removeLastElement();
+    }
+  }
+  delete tv;
+  return sum;
+}
+
+static unsigned int bench_tscvector(Element* elements, int width, int ops)
+{
+  int i;
+  unsigned int sum = 0;
+  TSCvector<Element>* tv = new TSCvector<Element>();
+  rand_state = 1;
+  for (i = 0; i < ops; i++)
+  {
+    tv->addElement(&elements[i % width]);
+    if (next_rand(3) == 0 || tv->size() > width)
+    {
+      sum += tv->lastElement()->index;
+      tv->removeLastElement();
+    }
+  }
+  delete tv;
+  return sum;
+}
+
+static void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_bench_containers\n");
+  fprintf(stderr,"sm_bench_containers -width 4096 -ops 50000000\n");
+  fprintf(stderr,"sm_bench_containers -h\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int i;
+  int width = 4096;
+  int ops = 20000000;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-width") == 0)
+    {
+      i++;
+      width = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-ops") == 0)
+    {
+      i++;
+      ops = atoi(argv[i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  Element* elements = (Element*)malloc(sizeof(Element)*width);
+  for (i = 0; i < width; i++) elements[i].index = i;
+
+  clock_t start;
+  unsigned int check_void, check;
+  float ns_void, ns;
+
+  fprintf(stderr,"width %d ops %d\n", width, ops);
+
+  start = clock();
+  check_void = bench_dynamicvector_void(elements, width, ops);
+  ns_void = elapsed(start, ops);
+  start = clock();
+  check = bench_dynamicvector(elements, width, ops);
+  ns = elapsed(start, ops);
+  fprintf(stderr,"DynamicVector  void* %6.2f ns/op  templated %6.2f ns/op  speedup %4.2f %s\n", ns_void, ns, ns_void/ns, (check == check_void ? "" : "MISMATCH"));
+
+  for (i = 0; i < width; i++) elements[i].dynamicvector = 0;
+  start = clock();
+  check_void = bench_dynamicqueue_void(elements, width, ops);
+  ns_void = elapsed(start, ops);
+  for (i = 0; i < width; i++) elements[i].dynamicvector = 0;
+  start = clock();
+  check = bench_dynamicqueue(elements, width, ops);
+  ns = elapsed(start, ops);
+  fprintf(stderr,"DynamicQueue   void* %6.2f ns/op  templated %6.2f ns/op  speedup %4.2f %s\n", ns_void, ns, ns_void/ns, (check == check_void ? "" : "MISMATCH"));
+
+  start = clock();
+  check_void = bench_crazyvector_void(elements, width, ops);
+  ns_void = elapsed(start, ops);
+  start = clock();
+  check = bench_crazyvector(elements, width, ops);
+  ns = elapsed(start, ops);
+  fprintf(stderr,"CrazyVector    void* %6.2f ns/op  templated %6.2f ns/op  speedup %4.2f %s\n", ns_void, ns, ns_void/ns, (check == check_void ? "" : "MISMATCH"));
+
+  start = clock();
+  check_void = bench_tscvector_void(elements, width, ops);
+  ns_void = elapsed(start, ops);
+  start = clock();
+  check = bench_tscvector(elements, width, ops);
+  ns = elapsed(start, ops);
+  fprintf(stderr,"TSCvector      void* %6.2f ns/op  templated %6.2f ns/op  speedup %4.2f %s\n", ns_void, ns, ns_void/ns, (check == check_void ? "" : "MISMATCH"));
+
+  free(elements);
+  return 0;
+}
@@ -0,0 +1,424 @@
+/*
+===============================================================================
+
+  FILE:  sm_bench_memory.cpp
+
+  CONTENTS:
+
+    This program measures the latency of serving small meshes the way a tile
+    server does: for every request the mesh is written in one of the formats
+    (SMA, SMB, SMC, SMD) and then read back. It compares writing into and
+    reading from memory (see SMmemory.h) against going through a temporary
+    file. The memory requests reuse one buffer of the caller that is sized
+    by a first request into a buffer that grows.
+
+    The mesh is a small synthetic terrain unless one is given with '-i'. It
+    is held in memory so that only the writing and the reading are timed.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to measure the request latency of a tile server
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smreader_smd.h"
+#include "smreader_synthetic.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+#include "smwriter_smd.h"
+
+#define SM_BENCH_SMA 0
+#define SM_BENCH_SMB 1
+#define SM_BENCH_SMC 2
+#define SM_BENCH_SMD 3
+
+static const char* format_names[4] = {"sma", "smb", "smc", "smd"};
+
+// the mesh that every request writes and reads
+
+typedef struct SMrecord
+{
+  bool vertex;
+  float pos[3];
+  SMidx idx[3];
+  bool final[3];
+} SMrecord;
+
+static SMrecord* records = 0;
+static int records_number = 0;
+static SMidx mesh_nverts = 0;
+static SMidx mesh_nfaces = 0;
+static float* mesh_bb_min = 0;
+static float* mesh_bb_max = 0;
+
+static double get_time()
+{
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + 0.000001*tv.tv_usec;
+#endif
+}
+
+static void record_mesh(SMreader* smreader)
+{
+  int records_alloc = 1024;
+  records = (SMrecord*)malloc(sizeof(SMrecord)*records_alloc);
+  SMevent event;
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    if (records_number == records_alloc)
+    {
+      records_alloc = 2*records_alloc;
+      records = (SMrecord*)realloc(records, sizeof(SMrecord)*records_alloc);
+    }
+    SMrecord* record = &records[records_number];
+    if (event == SM_VERTEX)
+    {
+      record->vertex = true;
+      record->pos[0] = smreader->v_pos_f[0];
+      record->pos[1] = smreader->v_pos_f[1];
+      record->pos[2] = smreader->v_pos_f[2];
+      mesh_nverts++;
+    }
+    else
+    {
+      record->vertex = false;
+      for (int i = 0; i < 3; i++)
+      {
+        record->idx[i] = smreader->t_idx[i];
+        record->final[i] = smreader->t_final[i];
+      }
+      mesh_nfaces++;
+    }
+    records_number++;
+  }
+  if (smreader->bb_min_f && smreader->bb_max_f)
+  {
+    mesh_bb_min = new float[3];
+    mesh_bb_max = new float[3];
+    memcpy(mesh_bb_min, smreader->bb_min_f, sizeof(float)*3);
+    memcpy(mesh_bb_max, smreader->bb_max_f, sizeof(float)*3);
+  }
+}
+
+static void write_mesh(SMwriter* smwriter)
+{
+  smwriter->set_nverts(mesh_nverts);
+  smwriter->set_nfaces(mesh_nfaces);
+  if (mesh_bb_min) smwriter->set_boundingbox(mesh_bb_min, mesh_bb_max);
+  for (int i = 0; i < records_number; i++)
+  {
+    if (records[i].vertex)
+    {
+      smwriter->write_vertex(records[i].pos);
+    }
+    else
+    {
+      smwriter->write_triangle(records[i].idx, records[i].final);
+    }
+  }
+  smwriter->close();
+}
+
+static SMidx read_mesh(SMreader* smreader)
+{
+  SMidx elements = 0;
+  while (smreader->read_element() > SM_EOF) elements++;
+  smreader->close();
+  return elements;
+}
+
+// one request through memory. the writer fills the buffer of the caller
+// and the reader reads it where it is.
+
+static SMidx request_memory(int format, unsigned char* buffer, int nalloc, int* nbytes, int bits)
+{
+  switch (format)
+  {
+  case SM_BENCH_SMA:
+    {
+      SMwriter_sma smwriter;
+      SMreader_sma smreader;
+      smwriter.open(buffer, nalloc, nbytes);
+      write_mesh(&smwriter);
+      if (*nbytes > nalloc) return -1;
+      smreader.open(buffer, *nbytes);
+      return read_mesh(&smreader);
+    }
+  case SM_BENCH_SMB:
+    {
+      SMwriter_smb smwriter;
+      SMreader_smb smreader;
+      smwriter.open(buffer, nalloc, nbytes);
+      write_mesh(&smwriter);
+      if (*nbytes > nalloc) return -1;
+      smreader.open(buffer, *nbytes);
+      return read_mesh(&smreader);
+    }
+  case SM_BENCH_SMC:
+    {
+      SMwriter_smc smwriter;
+      SMreader_smc smreader;
+      smwriter.open(buffer, nalloc, nbytes, bits);
+      write_mesh(&smwriter);
+      if (*nbytes > nalloc) return -1;
+      smreader.open(buffer, *nbytes);
+      return read_mesh(&smreader);
+    }
+  default:
+    {
+      SMwriter_smd smwriter;
+      SMreader_smd smreader;
+      smwriter.open(buffer, nalloc, nbytes, bits);
+      write_mesh(&smwriter);
+      if (*nbytes > nalloc) return -1;
+      smreader.open(buffer, *nbytes);
+      return read_mesh(&smreader);
+    }
+  }
+}
+
+// one request through a temporary file, which is what a server had to do
+// before. the SMC and SMD readers close the file themselves.
+
+static SMidx request_file(int format, int bits)
+{
+  SMidx elements;
+  FILE* file = tmpfile();
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot create a temporary file\n");
+    exit(1);
+  }
+  switch (format)
+  {
+  case SM_BENCH_SMA:
+    {
+      SMwriter_sma smwriter;
+      SMreader_sma smreader;
+      smwriter.open(file);
+      write_mesh(&smwriter);
+      rewind(file);
+      smreader.open(file);
+      elements = read_mesh(&smreader);
+      fclose(file);
+      return elements;
+    }
+  case SM_BENCH_SMB:
+    {
+      SMwriter_smb smwriter;
+      SMreader_smb smreader;
+      smwriter.open(file);
+      write_mesh(&smwriter);
+      rewind(file);
+      smreader.open(file);
+      elements = read_mesh(&smreader);
+      fclose(file);
+      return elements;
+    }
+  case SM_BENCH_SMC:
+    {
+      SMwriter_smc smwriter;
+      SMreader_smc smreader;
+      smwriter.open(file, bits);
+      write_mesh(&smwriter);
+      rewind(file);
+      smreader.open(file);
+      return read_mesh(&smreader);
+    }
+  default:
+    {
+      SMwriter_smd smwriter;
+      SMreader_smd smreader;
+      smwriter.open(file, bits);
+      write_mesh(&smwriter);
+      rewind(file);
+      smreader.open(file);
+      return read_mesh(&smreader);
+    }
+  }
+}
+
+static int compare_doubles(const void* a, const void* b)
+{
+  double d = *((const double*)a) - *((const double*)b);
+  return (d < 0 ? -1 : (d > 0 ? 1 : 0));
+}
+
+static double percentile(double* seconds, int number, int p)
+{
+  int i = (number-1) * p / 100;
+  return 1000.0*seconds[i];
+}
+
+static void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_bench_memory\n");
+  fprintf(stderr,"sm_bench_memory -mesh terrain,64,64 -requests 1000\n");
+  fprintf(stderr,"sm_bench_memory -i tile.smb -requests 200 -bits 12\n");
+  fprintf(stderr,"sm_bench_memory -h\n");
+  exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+  int i;
+  char* file_name_in = 0;
+  const char* mesh = "terrain,64,64";
+  int requests = 500;
+  int bits = 16;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-i") == 0)
+    {
+      i++;
+      file_name_in = argv[i];
+    }
+    else if (strcmp(argv[i],"-mesh") == 0)
+    {
+      i++;
+      mesh = argv[i];
+    }
+    else if (strcmp(argv[i],"-requests") == 0)
+    {
+      i++;
+      requests = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-bits") == 0)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (requests < 1) usage();
+
+  if (file_name_in)
+  {
+    FILE* file = fopen(file_name_in, "rb");
+    if (file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s'\n", file_name_in);
+      exit(1);
+    }
+    if (strstr(file_name_in, ".sma"))
+    {
+      SMreader_sma smreader;
+      smreader.open(file);
+      record_mesh(&smreader);
+      smreader.close();
+      fclose(file);
+    }
+    else if (strstr(file_name_in, ".smb"))
+    {
+      SMreader_smb smreader;
+      smreader.open(file);
+      record_mesh(&smreader);
+      smreader.close();
+      fclose(file);
+    }
+    else if (strstr(file_name_in, ".smc"))
+    {
+      SMreader_smc smreader;
+      smreader.open(file);
+      record_mesh(&smreader);
+      smreader.close();
+    }
+    else
+    {
+      fprintf(stderr,"ERROR: cannot determine the format of '%s'\n", file_name_in);
+      exit(1);
+    }
+  }
+  else
+  {
+    SMreader_synthetic smreader;
+    if (!smreader.open(mesh))
+    {
+      fprintf(stderr,"ERROR: cannot generate mesh '%s'\n", mesh);
+      exit(1);
+    }
+    record_mesh(&smreader);
+    smreader.close();
+  }
+
+  fprintf(stderr,"mesh with " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles. %d requests per format\n", mesh_nverts, mesh_nfaces, requests);
+
+  double* seconds_memory = (double*)malloc(sizeof(double)*requests);
+  double* seconds_file = (double*)malloc(sizeof(double)*requests);
+
+  for (int format = SM_BENCH_SMA; format <= SM_BENCH_SMD; format++)
+  {
+    // a first request into a buffer that grows says how large it must be
+
+    unsigned char* buffer = 0;
+    int nbytes = 0;
+    if (format == SM_BENCH_SMA) { SMwriter_sma smwriter; smwriter.open(&buffer, &nbytes); write_mesh(&smwriter); }
+    else if (format == SM_BENCH_SMB) { SMwriter_smb smwriter; smwriter.open(&buffer, &nbytes); write_mesh(&smwriter); }
+    else if (format == SM_BENCH_SMC) { SMwriter_smc smwriter; smwriter.open(&buffer, &nbytes, bits); write_mesh(&smwriter); }
+    else { SMwriter_smd smwriter; smwriter.open(&buffer, &nbytes, bits); write_mesh(&smwriter); }
+    int nalloc = nbytes;
+
+    bool ok = true;
+    for (i = 0; i < requests; i++)
+    {
+      double start = get_time();
+      if (request_memory(format, buffer, nalloc, &nbytes, bits) != mesh_nverts + mesh_nfaces) ok = false;
+      seconds_memory[i] = get_time() - start;
+      start = get_time();
+      if (request_file(format, bits) != mesh_nverts + mesh_nfaces) ok = false;
+      seconds_file[i] = get_time() - start;
+    }
+    free(buffer);
+
+    qsort(seconds_memory, requests, sizeof(double), compare_doubles);
+    qsort(seconds_file, requests, sizeof(double), compare_doubles);
+
+    fprintf(stderr,"%s %9d bytes  memory p50 %7.3f p99 %7.3f ms  file p50 %7.3f p99 %7.3f ms  speedup %4.2f %s\n", format_names[format], nalloc, percentile(seconds_memory, requests, 50), percentile(seconds_memory, requests, 99), percentile(seconds_file, requests, 50), percentile(seconds_file, requests, 99), percentile(seconds_file, requests, 50)/percentile(seconds_memory, requests, 50), (ok ? "" : "MISMATCH"));
+  }
+
+  free(seconds_memory);
+  free(seconds_file);
+  free(records);
+  if (mesh_bb_min) delete [] mesh_bb_min;
+  if (mesh_bb_max) delete [] mesh_bb_max;
+  return 0;
+}
@@ -181,7 +181,7 @@ Span max_triangle_span;
 int triangle_with_max_vertex_span = -1;
 Span max_vertex_span;
 
-typedef hash_map<int, Span> my_hash;
+typedef hash_map<SMidx, Span> my_hash;
 
 static my_hash* triangle_span_hash = 0;
 
@@ -541,8 +541,8 @@ void vizBegin()
     exit(1);
   }
 
-  nverts = smreader->nverts;
-  nfaces = smreader->nfaces;
+  nverts = (int)smreader->nverts;
+  nfaces = (int)smreader->nfaces;
 
   fprintf(stderr,"nverts %d\n",nverts);
   fprintf(stderr,"nfaces %d\n",nfaces);
@@ -612,11 +612,11 @@ int vizContinue()
       if (smreader->f_count >= NEXT_TRIANGLE)
       {
         // x-coordinate (triangle axis)
-        illustrated_triangles[illustrated_triangles_num*4] = smreader->f_count;
+        illustrated_triangles[illustrated_triangles_num*4] = (int)smreader->f_count;
         for (i = 0; i < 3; i++)
         {
           // y-coordinate (vertex axis)
-          illustrated_triangles[illustrated_triangles_num*4+1+i] = smreader->t_idx[i];
+          illustrated_triangles[illustrated_triangles_num*4+1+i] = (int)smreader->t_idx[i];
         }
         illustrated_triangles_num++;
         NEXT_TRIANGLE += EVERY_NTH_TRIANGLE;
@@ -626,13 +626,13 @@ int vizContinue()
           hash_element = triangle_span_hash->find(smreader->t_idx[i]);
           if (hash_element == triangle_span_hash->end())
           {
-            span.start = smreader->f_count;
-            span.end = smreader->f_count;
+            span.start = (int)smreader->f_count;
+            span.end = (int)smreader->f_count;
             triangle_span_hash->insert(my_hash::value_type(smreader->t_idx[i], span));
           }
           else
           {
-            (*hash_element).second.end = smreader->f_count;
+            (*hash_element).second.end = (int)smreader->f_count;
           }
         }
       }
@@ -643,7 +643,7 @@ int vizContinue()
           hash_element = triangle_span_hash->find(smreader->t_idx[i]);
           if (hash_element != triangle_span_hash->end())
           {
-            (*hash_element).second.end = smreader->f_count;
+            (*hash_element).second.end = (int)smreader->f_count;
           }
         }
       }
@@ -1599,7 +1599,7 @@ void myDisplay()
     for (my_hash::iterator hash_element = triangle_span_hash->begin(); hash_element != triangle_span_hash->end(); hash_element++)
     {
       // y-coordinate (vertex axis)
-      sample[1] = (*hash_element).first;
+      sample[1] = (int)(*hash_element).first;
       // x-coordinate (triangle axis)
       sample[0] = (*hash_element).second.start;
       // start line
@@ -1613,7 +1613,7 @@ void myDisplay()
       {
         if ( ((*hash_element).second.end - (*hash_element).second.start) > (max_triangle_span.end - max_triangle_span.start) )
         {
-          vertex_with_max_triangle_span = (*hash_element).first;
+          vertex_with_max_triangle_span = (int)(*hash_element).first;
           max_triangle_span = (*hash_element).second;
         }
       }
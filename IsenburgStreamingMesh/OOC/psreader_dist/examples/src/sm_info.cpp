@@ -6,6 +6,10 @@
   CONTENTS:
   
     This program inputs a streaming mesh and outputs several statistics.
+
+    It also simulates FIFO and LRU post-transform vertex caches of a GPU
+    that renders the triangles in stream order and reports their average
+    cache miss ratio (ACMR) and average transform to vertex ratio (ATVR).
   
   PROGRAMMERS:
   
@@ -21,6 +25,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- reads only the connectivity and skips the geometry where it can
+    19 October 2026 -- added '-cache' to report the ACMR and ATVR of GPU caches
     19 April 2005 -- changed to compute the triangle width instead
     14 April 2005 -- created after endless discussions about vskip and tskip
   
@@ -45,6 +51,8 @@
 #include "smreadpreascompactpre.h"
 #include "smreadpostascompactpre.h"
 
+#include "smvertexcache.h"
+
 #include "vec3iv.h"
 
 #ifdef _WIN32
@@ -102,7 +110,7 @@ static void deallocVertex(SMvertex* vertex)
   vertex_buffer_size--;
 }
 
-typedef hash_map<int, SMvertex*> my_vertex_hash;
+typedef hash_map<SMidx, SMvertex*> my_vertex_hash;
 
 static my_vertex_hash* vertex_hash;
 
@@ -110,6 +118,7 @@ void usage()
 {
   fprintf(stderr,"usage:\n");
   fprintf(stderr,"sm_info mesh.smb \n");
+  fprintf(stderr,"sm_info -cache 24 mesh.smc \n");
   fprintf(stderr,"sm2sm -h\n");
   exit(1);
 }
@@ -125,10 +134,28 @@ int main(int argc, char *argv[])
   bool isme = 0;
   bool compact = 0;
   char* file_name = 0;
+  int cache_sizes[4] = {16, 32, 0, 0};
+  int num_cache_sizes = 0;
 
   for (i = 1; i < argc; i++)
   {
-    if (strcmp(argv[i],"-isma") == 0)
+    if (strcmp(argv[i],"-cache") == 0)
+    {
+      i++;
+      if (num_cache_sizes == 4)
+      {
+        fprintf(stderr,"ERROR: at most 4 cache sizes\n");
+        exit(1);
+      }
+      cache_sizes[num_cache_sizes] = atoi(argv[i]);
+      if (cache_sizes[num_cache_sizes] < 3 || cache_sizes[num_cache_sizes] > SM_CACHE_MAX_SIZE)
+      {
+        fprintf(stderr,"ERROR: cache size %d is not between 3 and %d\n", cache_sizes[num_cache_sizes], SM_CACHE_MAX_SIZE);
+        exit(1);
+      }
+      num_cache_sizes++;
+    }
+    else if (strcmp(argv[i],"-isma") == 0)
     {
       isma = true;
     }
@@ -254,19 +281,19 @@ int main(int argc, char *argv[])
     else if (strstr(file_name, ".smb"))
     {
       SMreader_smb* smreader_smb = new SMreader_smb();
-      smreader_smb->open(file);
+      smreader_smb->open(file, true);
       smreader = smreader_smb;
     }
     else if (strstr(file_name, ".smd"))
     {
       SMreader_smd* smreader_smd = new SMreader_smd();
-      smreader_smd->open(file);
+      smreader_smd->open(file, true);
       smreader = smreader_smd;
     }
     else if (strstr(file_name, ".smc") || strstr(file_name, ".sme"))
     {
       SMreader_smc* smreader_smc = new SMreader_smc();
-      smreader_smc->open(file);
+      smreader_smc->open(file, true);
       smreader = smreader_smc;
     }
     else if (strstr(file_name, ".ply"))
@@ -292,19 +319,19 @@ int main(int argc, char *argv[])
     else if (ismb)
     {
       SMreader_smb* smreader_smb = new SMreader_smb();
-      smreader_smb->open(file);
+      smreader_smb->open(file, true);
       smreader = smreader_smb;
     }
     else if (ismd)
     {
       SMreader_smd* smreader_smd = new SMreader_smd();
-      smreader_smd->open(file);
+      smreader_smd->open(file, true);
       smreader = smreader_smd;
     }
     else if (ismc || isme)
     {
       SMreader_smc* smreader_smc = new SMreader_smc();
-      smreader_smc->open(file);
+      smreader_smc->open(file, true);
       smreader = smreader_smc;
     }
     else
@@ -345,14 +372,24 @@ int main(int argc, char *argv[])
   SMvertex* first = 0;
   SMvertex* last = 0;
 
-  int min_idx;
-  int max_idx;
-  int index = 0;
+  SMidx min_idx;
+  SMidx max_idx;
+  SMidx index = 0;
   my_vertex_hash::iterator hash_element;
   SMvertex* vertex;
 
   vertex_hash = new my_vertex_hash;
 
+  // a FIFO and an LRU cache for each size
+
+  if (num_cache_sizes == 0) num_cache_sizes = 2;
+  SMvertexCache vertex_caches[8];
+  for (i = 0; i < num_cache_sizes; i++)
+  {
+    vertex_caches[2*i].init(SM_CACHE_FIFO, cache_sizes[i]);
+    vertex_caches[2*i+1].init(SM_CACHE_LRU, cache_sizes[i]);
+  }
+
   while (event = smreader->read_element())
   {
     switch (event)
@@ -360,8 +397,18 @@ int main(int argc, char *argv[])
     case SM_VERTEX:
       break;
     case SM_TRIANGLE:
-      min_idx = VecMin3iv(smreader->t_idx);
-      max_idx = VecMax3iv(smreader->t_idx);
+      for (i = 0; i < 2*num_cache_sizes; i++)
+      {
+        vertex_caches[i].access(smreader->t_idx[0]);
+        vertex_caches[i].access(smreader->t_idx[1]);
+        vertex_caches[i].access(smreader->t_idx[2]);
+      }
+      min_idx = smreader->t_idx[0];
+      if (smreader->t_idx[1] < min_idx) min_idx = smreader->t_idx[1];
+      if (smreader->t_idx[2] < min_idx) min_idx = smreader->t_idx[2];
+      max_idx = smreader->t_idx[0];
+      if (smreader->t_idx[1] > max_idx) max_idx = smreader->t_idx[1];
+      if (smreader->t_idx[2] > max_idx) max_idx = smreader->t_idx[2];
       // allocate all vertices until max_idx
       while (index <= max_idx)
       {
@@ -393,7 +440,7 @@ int main(int argc, char *argv[])
         hash_element = vertex_hash->find(smreader->t_idx[i]);
         if (hash_element == vertex_hash->end())
         {
-          fprintf(stderr, "ERROR: vertex %d not in hash\n", smreader->t_idx[i]);
+          fprintf(stderr, "ERROR: vertex " SM_IDX_FORMAT " not in hash\n", smreader->t_idx[i]);
         }
         else
         {
@@ -460,7 +507,7 @@ int main(int argc, char *argv[])
       hash_element = vertex_hash->find(smreader->final_idx);
       if (hash_element == vertex_hash->end())
       {
-        fprintf(stderr,"WARNING: finalized vertex %d not in hash\n",smreader->final_idx);
+        fprintf(stderr,"WARNING: finalized vertex " SM_IDX_FORMAT " not in hash\n",smreader->final_idx);
         exit(0);
       }
       vertex = (*hash_element).second;
@@ -489,7 +536,7 @@ int main(int argc, char *argv[])
       }
       vertex_hash->erase(hash_element);
 
-      while (first && first->count < 500000000)
+      while (first && first->count < -500000000)
       {
         first->count += 1000000000; // unmark as finalized
         twidth_current += first->count;
@@ -531,8 +578,8 @@ int main(int argc, char *argv[])
     deallocVertex(vertex);
   }
 
-  fprintf(stderr,"v_count %d\n",smreader->v_count);
-  fprintf(stderr,"f_count %d\n",smreader->f_count);
+  fprintf(stderr,"v_count " SM_IDX_FORMAT "\n",smreader->v_count);
+  fprintf(stderr,"f_count " SM_IDX_FORMAT "\n",smreader->f_count);
 
 #ifdef _WIN32
   fprintf(stderr,"needed %6.3f seconds\n",0.001f*gettime_in_msec());
@@ -546,6 +593,11 @@ int main(int argc, char *argv[])
 //  fprintf(stderr,"twidth_current %d twidth_max %d twidth_avg %5.1f\n",twidth_current, twidth_max, 0.0f);
   fprintf(stderr,"twidth_current %d twidth_max %d\n",twidth_current, twidth_max);
 
+  for (i = 0; i < 2*num_cache_sizes; i++)
+  {
+    fprintf(stderr,"%s %2d cache_misses " SM_COUNT_FORMAT " acmr %5.3f atvr %5.3f\n", (vertex_caches[i].type == SM_CACHE_FIFO ? "fifo" : "lru "), vertex_caches[i].size, vertex_caches[i].misses, (smreader->f_count ? (float)vertex_caches[i].misses/smreader->f_count : 0.0f), (smreader->v_count ? (float)vertex_caches[i].misses/smreader->v_count : 0.0f));
+  }
+
   smreader->close();
   if (file && file_name) fclose(file);
   delete smreader;
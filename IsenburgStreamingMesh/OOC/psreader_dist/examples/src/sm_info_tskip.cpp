@@ -101,7 +101,7 @@ static void deallocVertex(SMvertex* vertex)
   vertex_buffer_size--;
 }
 
-typedef hash_map<int, SMvertex*> my_vertex_hash;
+typedef hash_map<SMidx, SMvertex*> my_vertex_hash;
 
 static my_vertex_hash* vertex_hash;
 
@@ -477,7 +477,7 @@ int main(int argc, char *argv[])
       hash_elements[0] = vertex_hash->find(smreader->final_idx);
       if (hash_elements[0] == vertex_hash->end())
       {
-        fprintf(stderr,"WARNING: finalized vertex %d not in hash\n",smreader->final_idx);
+        fprintf(stderr,"WARNING: finalized vertex " SM_IDX_FORMAT " not in hash\n",smreader->final_idx);
         exit(0);
       }
       vertices[0] = (*hash_elements[0]).second;
@@ -505,7 +505,7 @@ int main(int argc, char *argv[])
         vertices[0]->finalized = true; // cannot yet delete vertices that have negative or positive ccount.
       }
       vertex_hash->erase(hash_elements[0]);
-      fprintf(stderr,"erasing %d size %d \n",smreader->final_idx, vertex_hash->size());
+      fprintf(stderr,"erasing " SM_IDX_FORMAT " size %d \n",smreader->final_idx, vertex_hash->size());
 
       while (first && first->finalized)
       {
@@ -530,8 +530,8 @@ int main(int argc, char *argv[])
     }
   }
 
-  fprintf(stderr,"v_count %d\n",smreader->v_count);
-  fprintf(stderr,"f_count %d\n",smreader->f_count);
+  fprintf(stderr,"v_count " SM_IDX_FORMAT "\n",smreader->v_count);
+  fprintf(stderr,"f_count " SM_IDX_FORMAT "\n",smreader->f_count);
 
 #ifdef _WIN32
   fprintf(stderr,"needed %6.3f seconds\n",0.001f*gettime_in_msec());
@@ -0,0 +1,735 @@
+/*
+===============================================================================
+
+  FILE:  sm_merge.cpp
+
+  CONTENTS:
+
+    This program merges the tiles that sm_split wrote back into one
+    streaming mesh. it reads the tile table 'mesh.smt' and welds the copies
+    of every seam vertex into one vertex using the global index that was
+    recorded for each copy. only the seam vertices are held in memory.
+
+    every tile is read by its own thread, so the decompression of the
+    tiles (e.g. from SMC) runs in parallel. the main thread takes the
+    elements from the tiles in blocks round robin and writes them. a seam
+    vertex is written when its first copy comes along and is finalized by
+    the triangle that finalizes its last copy.
+
+    the tiles can be converted after they were split as long as this keeps
+    the order of their vertices. SMA and SMB keep it but SMC does not, so
+    SMC tiles must be written by sm_split itself. all copies of a seam
+    vertex must still have the same position, which catches tiles whose
+    vertices were re-ordered. with '-ext' the tiles are read with another
+    extension than the one they had when they were split (e.g. '-ext .sma'
+    reads 'mesh_tile3.sma' for what was 'mesh_tile3.smb').
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- reads version 2 of the tile table with 64 bit numbers
+    19 October 2026 -- created to reassemble tiles that were processed on many cores
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+
+#include "vec3fv.h"
+#include "smthread.h"
+
+#include <hash_map.h>
+
+#define SM_MERGE_BLOCK_SIZE 1024
+#define SM_MERGE_BLOCKS 4
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_merge -i mesh.smt -o mesh.smb\n");
+  fprintf(stderr,"sm_merge -i mesh.smt -o mesh.smc -bits 16\n");
+  fprintf(stderr,"sm_merge -i mesh.smt -ext .sma -o mesh.sma\n");
+  fprintf(stderr,"sm_merge -h\n");
+  exit(1);
+}
+
+// the elements are passed from the threads of the tiles in blocks
+
+typedef struct SMmergeEvent
+{
+  int event;
+  union
+  {
+    float v[3];
+    SMidx idx[3];
+    SMidx final_idx;
+  };
+  bool final[3];
+} SMmergeEvent;
+
+typedef struct SMmergeBlock
+{
+  int number;
+  bool eof;
+  SMmergeEvent events[SM_MERGE_BLOCK_SIZE];
+} SMmergeBlock;
+
+static double get_time()
+{
+#ifdef _WIN32
+  return 0.001*GetTickCount();
+#else
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + 0.000001*tv.tv_usec;
+#endif
+}
+
+// a seam vertex is finalized once all of its copies are
+
+typedef struct MergeSeam
+{
+  float v[3];
+  SMidx index;               // in the output or -1 until it was written
+  int copies;
+} MergeSeam;
+
+typedef hash_map<SMidx, SMidx> my_index_hash;
+typedef hash_map<SMidx, MergeSeam*> my_seam_hash;
+
+// a tile with the queue of blocks that its thread reads, the output indices
+// of its live vertices, and the global indices of its seam vertices
+
+typedef struct MergeTile
+{
+  char* file_name;
+  SMidx nverts;
+  SMidx nfaces;
+  SMidx v_count;
+  SMidx f_count;
+  my_index_hash* index_hash;
+  my_index_hash* global_hash;
+  SMmergeBlock blocks[SM_MERGE_BLOCKS];
+  SMsemaphore full;
+  SMsemaphore empty;
+  int get_block;
+  int waits;
+  bool done;
+  bool ok;
+  SMthread thread;
+} MergeTile;
+
+static MergeTile** tiles = 0;
+static int tiles_number = 0;
+
+static my_seam_hash* seam_hash = 0;
+
+static float bb_min[3];
+static float bb_max[3];
+
+static int seams_number = 0;
+
+// the thread of a tile opens, reads, and closes the reader of its tile
+
+static SM_THREAD_RESULT read_tile(void* arg)
+{
+  MergeTile* tile = (MergeTile*)arg;
+  SMreader* smreader = 0;
+  SMmergeBlock* block = 0;
+  SMmergeEvent* merge_event;
+  SMevent event = SM_ERROR;
+  int put_block = 0;
+  FILE* file;
+
+  file = fopen(tile->file_name, (strstr(tile->file_name, ".sma") ? "r" : "rb"));
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", tile->file_name);
+  }
+  else if (strstr(tile->file_name, ".sma"))
+  {
+    SMreader_sma* smreader_sma = new SMreader_sma();
+    smreader_sma->open(file);
+    smreader = smreader_sma;
+  }
+  else if (strstr(tile->file_name, ".smb"))
+  {
+    SMreader_smb* smreader_smb = new SMreader_smb();
+    smreader_smb->open(file);
+    smreader = smreader_smb;
+  }
+  else
+  {
+    SMreader_smc* smreader_smc = new SMreader_smc();
+    if (smreader_smc->open(file))
+    {
+      smreader = smreader_smc;
+      file = 0; // closing the SMC reader closes the file
+    }
+    else
+    {
+      delete smreader_smc;
+    }
+  }
+
+  if (smreader)
+  {
+    if (smreader->post_order)
+    {
+      fprintf(stderr,"ERROR: tile '%s' is in post-order\n", tile->file_name);
+    }
+    else
+    {
+      do
+      {
+        if (block == 0)
+        {
+          if (waitSemaphore(&(tile->empty))) tile->waits++;
+          block = &(tile->blocks[put_block]);
+          block->number = 0;
+        }
+        event = smreader->read_element();
+        if (event > SM_EOF)
+        {
+          merge_event = &(block->events[block->number++]);
+          merge_event->event = event;
+          if (event == SM_VERTEX)
+          {
+            VecCopy3fv(merge_event->v, smreader->v_pos_f);
+          }
+          else if (event == SM_TRIANGLE)
+          {
+            merge_event->idx[0] = smreader->t_idx[0];
+            merge_event->idx[1] = smreader->t_idx[1];
+            merge_event->idx[2] = smreader->t_idx[2];
+            merge_event->final[0] = smreader->t_final[0];
+            merge_event->final[1] = smreader->t_final[1];
+            merge_event->final[2] = smreader->t_final[2];
+          }
+          else
+          {
+            merge_event->final_idx = smreader->final_idx;
+          }
+        }
+        if (event <= SM_EOF || block->number == SM_MERGE_BLOCK_SIZE)
+        {
+          block->eof = (event <= SM_EOF);
+          postSemaphore(&(tile->full));
+          block = 0;
+          put_block = (put_block + 1) % SM_MERGE_BLOCKS;
+        }
+      } while (event > SM_EOF);
+    }
+    smreader->close();
+    delete smreader;
+  }
+  if (file) fclose(file);
+
+  tile->ok = (event == SM_EOF);
+
+  // a tile that fails still ends its queue
+
+  if (event != SM_EOF)
+  {
+    if (event == SM_ERROR && smreader) fprintf(stderr,"ERROR: failed reading '%s'\n", tile->file_name);
+    if (block == 0)
+    {
+      waitSemaphore(&(tile->empty));
+      block = &(tile->blocks[put_block]);
+      block->number = 0;
+      block->eof = true;
+      postSemaphore(&(tile->full));
+    }
+  }
+  return 0;
+}
+
+static bool start_tile(MergeTile* tile)
+{
+  tile->v_count = 0;
+  tile->f_count = 0;
+  tile->get_block = 0;
+  tile->waits = 0;
+  tile->done = false;
+  tile->ok = false;
+  initSemaphore(&(tile->full), 0, SM_MERGE_BLOCKS);
+  initSemaphore(&(tile->empty), SM_MERGE_BLOCKS, SM_MERGE_BLOCKS);
+  if (!startThread(&(tile->thread), read_tile, tile))
+  {
+    fprintf(stderr,"ERROR: cannot start thread for '%s'\n", tile->file_name);
+    destroySemaphore(&(tile->full));
+    destroySemaphore(&(tile->empty));
+    return false;
+  }
+  return true;
+}
+
+static void finish_tile(MergeTile* tile)
+{
+  joinThread(&(tile->thread));
+  destroySemaphore(&(tile->full));
+  destroySemaphore(&(tile->empty));
+}
+
+// replaces the extension of a tile name
+
+static char* tile_name(const char* file_name, int length, const char* extension)
+{
+  char* name = (char*)malloc(length + (extension ? strlen(extension) : 0) + 1);
+  memcpy(name, file_name, length);
+  name[length] = '\0';
+  if (extension)
+  {
+    char* dot = strrchr(name, '.');
+    if (dot) *dot = '\0';
+    strcat(name, extension);
+  }
+  return name;
+}
+
+// version 1 of the tile table has 32 bit numbers and version 2 has 64 bit
+// numbers for the vertices and triangles
+
+static SMidx read_number(FILE* file, int version)
+{
+  if (version == 1)
+  {
+    int number = 0;
+    fread(&number, sizeof(int), 1, file);
+    return number;
+  }
+  SMoffset number = 0;
+  fread(&number, sizeof(SMoffset), 1, file);
+  return (SMidx)number;
+}
+
+static bool read_smt(const char* file_name, const char* extension)
+{
+  int t, s, length, endian, n[3], version, seam_tile;
+  SMidx v_count, f_count;
+  SMidx seam[3];
+  char name[1024];
+  my_seam_hash::iterator seam_element;
+
+  FILE* file = fopen(file_name, "rb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name);
+    return false;
+  }
+  if (fgetc(file) != 'S' || fgetc(file) != 'M' || fgetc(file) != 'T')
+  {
+    fprintf(stderr,"ERROR: '%s' is not a tile table\n", file_name);
+    fclose(file);
+    return false;
+  }
+  version = fgetc(file);
+  if (version != 1 && version != 2)
+  {
+    fprintf(stderr,"ERROR: wrong version of tile table '%s'\n", file_name);
+    fclose(file);
+    return false;
+  }
+  if (fread(&endian, sizeof(int), 1, file) != 1 || endian != 1)
+  {
+    fprintf(stderr,"ERROR: tile table '%s' was written with a different endianness\n", file_name);
+    fclose(file);
+    return false;
+  }
+  fread(n, sizeof(int), 3, file);
+  fread(bb_min, sizeof(float), 3, file);
+  fread(bb_max, sizeof(float), 3, file);
+  v_count = read_number(file, version);
+  f_count = read_number(file, version);
+  if (fread(&tiles_number, sizeof(int), 1, file) != 1 || tiles_number != n[0]*n[1]*n[2])
+  {
+    fprintf(stderr,"ERROR: corrupt tile table '%s'\n", file_name);
+    fclose(file);
+    return false;
+  }
+
+  tiles = (MergeTile**)malloc(sizeof(MergeTile*)*tiles_number);
+  for (t = 0; t < tiles_number; t++)
+  {
+    tiles[t] = 0;
+    fread(&length, sizeof(int), 1, file);
+    if (length < 0 || length >= 1024)
+    {
+      fprintf(stderr,"ERROR: corrupt tile table '%s'\n", file_name);
+      fclose(file);
+      return false;
+    }
+    if (length)
+    {
+      fread(name, sizeof(char), length, file);
+      tiles[t] = (MergeTile*)malloc(sizeof(MergeTile));
+      tiles[t]->file_name = tile_name(name, length, extension);
+      tiles[t]->nverts = read_number(file, version);
+      tiles[t]->nfaces = read_number(file, version);
+      tiles[t]->index_hash = new my_index_hash;
+      tiles[t]->global_hash = new my_index_hash;
+    }
+  }
+
+  seam_hash = new my_seam_hash;
+  fread(&seams_number, sizeof(int), 1, file);
+  for (s = 0; s < seams_number; s++)
+  {
+    seam[0] = read_number(file, version);
+    fread(&seam_tile, sizeof(int), 1, file);
+    seam[2] = read_number(file, version);
+    if (feof(file)) seam_tile = -1;
+    seam[1] = seam_tile;
+    if (seam[1] < 0 || seam[1] >= tiles_number || tiles[seam[1]] == 0)
+    {
+      fprintf(stderr,"ERROR: corrupt tile table '%s'\n", file_name);
+      fclose(file);
+      return false;
+    }
+    tiles[seam[1]]->global_hash->insert(my_index_hash::value_type(seam[2], seam[0]));
+    seam_element = seam_hash->find(seam[0]);
+    if (seam_element == seam_hash->end())
+    {
+      MergeSeam* merge_seam = new MergeSeam;
+      merge_seam->index = -1;
+      merge_seam->copies = 1;
+      seam_hash->insert(my_seam_hash::value_type(seam[0], merge_seam));
+    }
+    else
+    {
+      (*seam_element).second->copies++;
+    }
+  }
+  fclose(file);
+  fprintf(stderr,"tile table of %d x %d x %d tiles for " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles with %d seam vertices\n", n[0], n[1], n[2], v_count, f_count, (int)seam_hash->size());
+  return true;
+}
+
+// maps the index of a vertex in a tile to its index in the output and
+// tells whether the tile finalizes it in the output
+
+static SMidx map(MergeTile* tile, SMidx idx, bool tile_final, bool* final)
+{
+  my_index_hash::iterator hash_element = tile->index_hash->find(idx);
+  if (hash_element == tile->index_hash->end())
+  {
+    fprintf(stderr,"ERROR: vertex " SM_IDX_FORMAT " of tile '%s' not in hash\n", idx, tile->file_name);
+    *final = false;
+    return -1;
+  }
+  SMidx index = (*hash_element).second;
+  *final = tile_final;
+  if (tile_final)
+  {
+    tile->index_hash->erase(hash_element);
+    hash_element = tile->global_hash->find(idx);
+    if (hash_element != tile->global_hash->end())
+    {
+      my_seam_hash::iterator seam_element = seam_hash->find((*hash_element).second);
+      MergeSeam* merge_seam = (*seam_element).second;
+      merge_seam->copies--;
+      if (merge_seam->copies)
+      {
+        *final = false;
+      }
+      else
+      {
+        seam_hash->erase(seam_element);
+        delete merge_seam;
+      }
+      tile->global_hash->erase(hash_element);
+    }
+  }
+  return index;
+}
+
+static bool merge_block(MergeTile* tile, SMmergeBlock* block, SMwriter* smwriter)
+{
+  int i, j;
+  SMidx t_idx[3];
+  bool t_final[3];
+  bool final;
+  SMmergeEvent* merge_event;
+  my_index_hash::iterator hash_element;
+
+  for (i = 0; i < block->number; i++)
+  {
+    merge_event = &(block->events[i]);
+    if (merge_event->event == SM_VERTEX)
+    {
+      SMidx index = -1;
+      hash_element = tile->global_hash->find(tile->v_count);
+      if (hash_element != tile->global_hash->end())
+      {
+        MergeSeam* merge_seam = (*(seam_hash->find((*hash_element).second))).second;
+        if (merge_seam->index == -1)
+        {
+          VecCopy3fv(merge_seam->v, merge_event->v);
+          merge_seam->index = smwriter->v_count;
+          smwriter->write_vertex(merge_event->v);
+        }
+        else if (merge_seam->v[0] != merge_event->v[0] || merge_seam->v[1] != merge_event->v[1] || merge_seam->v[2] != merge_event->v[2])
+        {
+          fprintf(stderr,"ERROR: seam vertex " SM_IDX_FORMAT " is elsewhere in tile '%s'. were its vertices re-ordered?\n", (*hash_element).second, tile->file_name);
+          return false;
+        }
+        index = merge_seam->index;
+      }
+      else
+      {
+        index = smwriter->v_count;
+        smwriter->write_vertex(merge_event->v);
+      }
+      tile->index_hash->insert(my_index_hash::value_type(tile->v_count, index));
+      tile->v_count++;
+    }
+    else if (merge_event->event == SM_TRIANGLE)
+    {
+      for (j = 0; j < 3; j++)
+      {
+        t_idx[j] = map(tile, merge_event->idx[j], merge_event->final[j], &(t_final[j]));
+        if (t_idx[j] == -1) return false;
+      }
+      smwriter->write_triangle(t_idx, t_final);
+      tile->f_count++;
+    }
+    else
+    {
+      SMidx index = map(tile, merge_event->final_idx, true, &final);
+      if (index == -1) return false;
+      if (final) smwriter->write_finalized(index);
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int i, t;
+  int bits = 16;
+  char* file_name_smt = 0;
+  char* file_name_out = 0;
+  char* extension = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-i") == 0)
+    {
+      i++;
+      file_name_smt = argv[i];
+    }
+    else if (strcmp(argv[i],"-o") == 0)
+    {
+      i++;
+      file_name_out = argv[i];
+    }
+    else if (strcmp(argv[i],"-ext") == 0)
+    {
+      i++;
+      extension = argv[i];
+    }
+    else if (strcmp(argv[i],"-b") == 0 || strcmp(argv[i],"-bits") == 0)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (file_name_smt == 0 || file_name_out == 0 || i > argc)
+  {
+    usage();
+  }
+
+  if (!read_smt(file_name_smt, extension))
+  {
+    exit(1);
+  }
+
+  // the seam vertices are written once, so they do not add up
+
+  SMidx nverts = 0;
+  SMidx nfaces = 0;
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      nverts += tiles[t]->nverts;
+      nfaces += tiles[t]->nfaces;
+    }
+  }
+  nverts -= (seams_number - (int)seam_hash->size());
+
+  SMwriter* smwriter;
+  FILE* file_out;
+  if (strstr(file_name_out, ".sma"))
+  {
+    file_out = fopen(file_name_out, "w");
+  }
+  else if (strstr(file_name_out, ".smb") || strstr(file_name_out, ".smc") || strstr(file_name_out, ".sme"))
+  {
+    file_out = fopen(file_name_out, "wb");
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: output file name '%s' does not end in .sma .smb .smc or .sme\n", file_name_out);
+    exit(1);
+  }
+  if (file_out == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name_out);
+    exit(1);
+  }
+  if (strstr(file_name_out, ".sma"))
+  {
+    SMwriter_sma* smwriter_sma = new SMwriter_sma();
+    smwriter_sma->open(file_out);
+    smwriter = smwriter_sma;
+  }
+  else if (strstr(file_name_out, ".smb"))
+  {
+    SMwriter_smb* smwriter_smb = new SMwriter_smb();
+    smwriter_smb->open(file_out);
+    smwriter = smwriter_smb;
+  }
+  else
+  {
+    SMwriter_smc* smwriter_smc = new SMwriter_smc();
+    smwriter_smc->open(file_out, bits);
+    smwriter = smwriter_smc;
+  }
+  smwriter->set_nverts(nverts);
+  smwriter->set_nfaces(nfaces);
+  smwriter->set_boundingbox(bb_min, bb_max);
+
+  double start = get_time();
+
+  int active = 0;
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      if (!start_tile(tiles[t]))
+      {
+        exit(1);
+      }
+      active++;
+    }
+  }
+
+  fprintf(stderr,"merging %d tiles into '%s'\n", active, file_name_out);
+
+  // round robin one block from every tile
+
+  bool ok = true;
+  int waits = 0;
+  SMmergeBlock* block;
+  MergeTile* tile;
+
+  while (active)
+  {
+    for (t = 0; t < tiles_number; t++)
+    {
+      tile = tiles[t];
+      if (tile == 0 || tile->done) continue;
+      if (waitSemaphore(&(tile->full))) waits++;
+      block = &(tile->blocks[tile->get_block]);
+      if (ok && !merge_block(tile, block, smwriter)) ok = false;
+      if (block->eof)
+      {
+        tile->done = true;
+        active--;
+      }
+      postSemaphore(&(tile->empty));
+      tile->get_block = (tile->get_block + 1) % SM_MERGE_BLOCKS;
+    }
+  }
+
+  // the tiles are only checked when all of their blocks were merged
+
+  bool merged = ok;
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      finish_tile(tiles[t]);
+      if (!tiles[t]->ok)
+      {
+        ok = false;
+      }
+      else if (!merged)
+      {
+        continue;
+      }
+      else if (tiles[t]->v_count != tiles[t]->nverts || tiles[t]->f_count != tiles[t]->nfaces)
+      {
+        fprintf(stderr,"ERROR: tile '%s' has " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles instead of " SM_IDX_FORMAT " and " SM_IDX_FORMAT "\n", tiles[t]->file_name, tiles[t]->v_count, tiles[t]->f_count, tiles[t]->nverts, tiles[t]->nfaces);
+        ok = false;
+      }
+      else if (tiles[t]->index_hash->size())
+      {
+        fprintf(stderr,"WARNING: %d vertices of tile '%s' were not finalized\n", (int)tiles[t]->index_hash->size(), tiles[t]->file_name);
+      }
+    }
+  }
+  if (ok && seam_hash->size())
+  {
+    fprintf(stderr,"WARNING: %d seam vertices were not finalized in all of their tiles\n", (int)seam_hash->size());
+  }
+
+  SMidx v_count = smwriter->v_count;
+  SMidx f_count = smwriter->f_count;
+  smwriter->close();
+  fclose(file_out);
+  delete smwriter;
+
+  fprintf(stderr,"merged " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles in %.3f seconds. %d times no tile was ready.\n", v_count, f_count, get_time() - start, waits);
+
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      delete tiles[t]->index_hash;
+      delete tiles[t]->global_hash;
+      free(tiles[t]->file_name);
+      free(tiles[t]);
+    }
+  }
+  free(tiles);
+  my_seam_hash::iterator seam_element;
+  for (seam_element = seam_hash->begin(); seam_element != seam_hash->end(); seam_element++)
+  {
+    delete (*seam_element).second;
+  }
+  delete seam_hash;
+
+  return (ok ? 0 : 1);
+}
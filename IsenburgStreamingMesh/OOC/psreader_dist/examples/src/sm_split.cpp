@@ -0,0 +1,951 @@
+/*
+===============================================================================
+
+  FILE:  sm_split.cpp
+
+  CONTENTS:
+
+    This program splits a streaming mesh into a grid of spatial tiles with
+    one pass over it. every triangle goes to the tile that contains its
+    centroid. a vertex goes to every tile that has a triangle using it, so
+    the vertices along the seams between tiles are written more than once.
+    every tile is again a pre-order streaming mesh in which each copy of a
+    vertex is finalized by the last triangle of the tile that uses it.
+
+    to know that a triangle is the last one of its tile that uses a vertex
+    either the next one must come along or the vertex must be finalized in
+    the input. so the triangles of a tile wait in a queue until this is
+    known for all three of their vertices. for vertices inside a tile this
+    is the next triangle around them. for seam vertices this is the end of
+    their life in the input stream.
+
+    every tile is written by its own thread. the main thread reads the input
+    and hands the elements of each tile in blocks to the thread of the tile,
+    so the compression of the tiles (e.g. to SMC) runs in parallel.
+
+    the tile table 'mesh.smt' lists the grid, the bounding box, the tiles,
+    and for every copy of a seam vertex the index it had in the input (its
+    global index), the tile, and its index in the tile. sm_merge uses it to
+    weld the tiles back together. the SMC decoder numbers the vertices of a
+    tile in another order than they were written, so for SMC tiles it is
+    the index that the decoder will give to the copy.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- writes version 2 of the tile table with 64 bit numbers
+    19 October 2026 -- created to compress and simplify tiles on many cores
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+
+#include "vec3fv.h"
+#include "smthread.h"
+
+#include <hash_map.h>
+
+#define SM_SPLIT_MAX_TILES 256
+
+#define SM_SPLIT_BLOCK_SIZE 1024
+#define SM_SPLIT_BLOCKS 4
+
+// a copy is written right before the first triangle that uses it, so the
+// SMC writer meets it long before this many more vertices
+
+#define SM_SPLIT_INDEX_RING 256
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_split -i mesh.smb -o tile.smb -tiles 4 4\n");
+  fprintf(stderr,"sm_split -i mesh.smc -o tile.smc -tiles 4 4 2 -bits 16\n");
+  fprintf(stderr,"sm_split -i mesh.sma -o tile.sma -tiles 8 1 -smt mesh.smt\n");
+  fprintf(stderr,"sm_split -h\n");
+  exit(1);
+}
+
+// the elements are passed to the threads of the tiles in blocks
+
+typedef struct SMsplitEvent
+{
+  int event;
+  union
+  {
+    float v[3];
+    SMidx idx[3];
+  };
+  bool final[3];
+  bool seam[3];
+  SMidx global[3];           // of the copies that are finalized on a seam
+} SMsplitEvent;
+
+typedef struct SMsplitBlock
+{
+  int number;
+  bool eof;
+  SMsplitEvent events[SM_SPLIT_BLOCK_SIZE];
+} SMsplitBlock;
+
+static double get_time()
+{
+#ifdef _WIN32
+  return 0.001*GetTickCount();
+#else
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + 0.000001*tv.tv_usec;
+#endif
+}
+
+// a vertex of the input and its copies in the tiles. a copy remembers the
+// last triangle of its tile that uses it until it is known whether this
+// triangle finalizes it.
+
+struct SplitTriangle;
+
+typedef struct SplitCopy
+{
+  float v[3];
+  SMidx global;
+  int tile;
+  SMidx index;               // in the tile or -1 until it was written
+  bool seam;
+  SplitTriangle* last;
+  int last_corner;
+  SplitCopy* next;           // the next copy of the same vertex
+} SplitCopy;
+
+typedef struct SplitVertex
+{
+  float v[3];
+  int copies;
+  SplitCopy* copy;
+} SplitVertex;
+
+typedef struct SplitTriangle
+{
+  SplitCopy* copy[3];
+  bool final[3];
+  int unresolved;
+  SplitTriangle* next;
+} SplitTriangle;
+
+// a tile with the queue of its waiting triangles and the queue of blocks
+// that its thread writes
+
+typedef struct SplitTile
+{
+  int id;
+  char* file_name;
+  FILE* file;
+  SplitTriangle* first;
+  SplitTriangle* last;
+  int waiting;
+  int max_waiting;
+  SMidx v_count;
+  SMidx f_count;
+  SMsplitBlock blocks[SM_SPLIT_BLOCKS];
+  SMsemaphore full;
+  SMsemaphore empty;
+  int put_block;
+  SMsplitBlock* put;
+  int waits;
+  SMidx* seams;              // global index and index in the tile of each seam copy
+  int seams_number;
+  int seams_alloc;
+  bool ok;
+  SMthread thread;
+} SplitTile;
+
+typedef hash_map<SMidx, SplitVertex*> my_split_hash;
+typedef hash_map<SMidx, SMidx> my_index_hash;
+
+static my_split_hash* split_hash = 0;
+
+static SplitTile** tiles = 0;
+static int tiles_number = 0;
+
+static int bits = 16;
+static float* bb_min = 0;
+static float* bb_max = 0;
+
+static SMidx copies_number = 0;
+
+static void addSeam(SplitTile* tile, SMidx global, SMidx index)
+{
+  if (tile->seams_number == tile->seams_alloc)
+  {
+    tile->seams_alloc = (tile->seams_alloc ? 2*tile->seams_alloc : 1024);
+    tile->seams = (SMidx*)realloc(tile->seams, sizeof(SMidx)*2*tile->seams_alloc);
+  }
+  tile->seams[2*tile->seams_number+0] = global;
+  tile->seams[2*tile->seams_number+1] = index;
+  tile->seams_number++;
+}
+
+// the producer side of the queue of a tile. a full block is only handed
+// over when the next event is put because the caller fills in the event
+// after it was put
+
+static void handOver(SplitTile* tile)
+{
+  postSemaphore(&(tile->full));
+  tile->put = 0;
+  tile->put_block = (tile->put_block + 1) % SM_SPLIT_BLOCKS;
+}
+
+static void nextBlock(SplitTile* tile)
+{
+  if (tile->put && tile->put->number == SM_SPLIT_BLOCK_SIZE)
+  {
+    handOver(tile);
+  }
+  if (tile->put == 0)
+  {
+    if (waitSemaphore(&(tile->empty))) tile->waits++;
+    tile->put = &(tile->blocks[tile->put_block]);
+    tile->put->number = 0;
+    tile->put->eof = false;
+  }
+}
+
+static SMsplitEvent* putEvent(SplitTile* tile, int event)
+{
+  nextBlock(tile);
+  SMsplitEvent* split_event = &(tile->put->events[tile->put->number++]);
+  split_event->event = event;
+  return split_event;
+}
+
+static void putEOF(SplitTile* tile)
+{
+  nextBlock(tile);
+  tile->put->eof = true;
+  handOver(tile);
+}
+
+// the thread of a tile opens, writes, and closes the writer of its tile
+
+static SM_THREAD_RESULT write_tile(void* arg)
+{
+  SplitTile* tile = (SplitTile*)arg;
+  SMwriter* smwriter;
+  SMsplitBlock* block;
+  SMsplitEvent* split_event;
+  int get_block = 0;
+  int i, j;
+  bool eof = false;
+  SMidx* index_ring = 0;
+  my_index_hash* index_hash = 0;
+  my_index_hash::iterator hash_element;
+
+  if (strstr(tile->file_name, ".sma"))
+  {
+    SMwriter_sma* smwriter_sma = new SMwriter_sma();
+    smwriter_sma->open(tile->file);
+    smwriter = smwriter_sma;
+  }
+  else if (strstr(tile->file_name, ".smb"))
+  {
+    SMwriter_smb* smwriter_smb = new SMwriter_smb();
+    smwriter_smb->open(tile->file);
+    smwriter = smwriter_smb;
+  }
+  else
+  {
+    SMwriter_smc* smwriter_smc = new SMwriter_smc();
+    smwriter_smc->open(tile->file, bits);
+    index_ring = (SMidx*)malloc(sizeof(SMidx)*SM_SPLIT_INDEX_RING);
+    index_hash = new my_index_hash;
+    smwriter_smc->set_index_map(index_ring, SM_SPLIT_INDEX_RING);
+    smwriter = smwriter_smc;
+  }
+
+  // all tiles get the bounding box of the input so that they are quantized
+  // the same way and their seams still match after compression
+
+  smwriter->set_boundingbox(bb_min, bb_max);
+
+  while (!eof)
+  {
+    waitSemaphore(&(tile->full));
+    block = &(tile->blocks[get_block]);
+    for (i = 0; i < block->number; i++)
+    {
+      split_event = &(block->events[i]);
+      if (split_event->event == SM_VERTEX)
+      {
+        smwriter->write_vertex(split_event->v);
+      }
+      else
+      {
+        smwriter->write_triangle(split_event->idx, split_event->final);
+        if (index_hash)
+        {
+          // remember the decoder index of the live copies
+          for (j = 0; j < 3; j++)
+          {
+            hash_element = index_hash->find(split_event->idx[j]);
+            if (split_event->final[j])
+            {
+              if (split_event->seam[j]) addSeam(tile, split_event->global[j], (hash_element == index_hash->end() ? index_ring[split_event->idx[j] % SM_SPLIT_INDEX_RING] : (*hash_element).second));
+              if (hash_element != index_hash->end()) index_hash->erase(hash_element);
+            }
+            else if (hash_element == index_hash->end())
+            {
+              index_hash->insert(my_index_hash::value_type(split_event->idx[j], index_ring[split_event->idx[j] % SM_SPLIT_INDEX_RING]));
+            }
+          }
+        }
+        else
+        {
+          for (j = 0; j < 3; j++)
+          {
+            if (split_event->final[j] && split_event->seam[j]) addSeam(tile, split_event->global[j], split_event->idx[j]);
+          }
+        }
+      }
+    }
+    eof = block->eof;
+    postSemaphore(&(tile->empty));
+    get_block = (get_block + 1) % SM_SPLIT_BLOCKS;
+  }
+
+  tile->ok = (smwriter->v_count == tile->v_count && smwriter->f_count == tile->f_count);
+  smwriter->close();
+  delete smwriter;
+  fclose(tile->file);
+  tile->file = 0;
+  if (index_hash)
+  {
+    if (index_hash->size()) tile->ok = false;
+    delete index_hash;
+    free(index_ring);
+  }
+  return 0;
+}
+
+static char* tile_name(const char* file_name, int t)
+{
+  char* file_name_tile = (char*)malloc(strlen(file_name) + 32);
+  const char* extension = strrchr(file_name, '.');
+  int length = (extension ? (int)(extension - file_name) : (int)strlen(file_name));
+  sprintf(file_name_tile, "%.*s_tile%d%s", length, file_name, t, (extension ? extension : ""));
+  return file_name_tile;
+}
+
+static SplitTile* start_tile(const char* file_name, int t)
+{
+  int b;
+  SplitTile* tile = (SplitTile*)malloc(sizeof(SplitTile));
+  tile->id = t;
+  tile->file_name = tile_name(file_name, t);
+  tile->file = fopen(tile->file_name, (strstr(tile->file_name, ".sma") ? "w" : "wb"));
+  if (tile->file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for write\n", tile->file_name);
+    free(tile->file_name);
+    free(tile);
+    return 0;
+  }
+  tile->first = 0;
+  tile->last = 0;
+  tile->waiting = 0;
+  tile->max_waiting = 0;
+  tile->v_count = 0;
+  tile->f_count = 0;
+  for (b = 0; b < SM_SPLIT_BLOCKS; b++)
+  {
+    tile->blocks[b].number = 0;
+    tile->blocks[b].eof = false;
+  }
+  initSemaphore(&(tile->full), 0, SM_SPLIT_BLOCKS);
+  initSemaphore(&(tile->empty), SM_SPLIT_BLOCKS, SM_SPLIT_BLOCKS);
+  tile->put_block = 0;
+  tile->put = 0;
+  tile->waits = 0;
+  tile->seams = 0;
+  tile->seams_number = 0;
+  tile->seams_alloc = 0;
+  tile->ok = false;
+  if (!startThread(&(tile->thread), write_tile, tile))
+  {
+    fprintf(stderr,"ERROR: cannot start thread for '%s'\n", tile->file_name);
+    fclose(tile->file);
+    destroySemaphore(&(tile->full));
+    destroySemaphore(&(tile->empty));
+    free(tile->file_name);
+    free(tile);
+    return 0;
+  }
+  return tile;
+}
+
+static void finish_tile(SplitTile* tile)
+{
+  putEOF(tile);
+  joinThread(&(tile->thread));
+  destroySemaphore(&(tile->full));
+  destroySemaphore(&(tile->empty));
+  if (!tile->ok)
+  {
+    fprintf(stderr,"ERROR: tile '%s' is incomplete\n", tile->file_name);
+  }
+}
+
+// the waiting triangles of a tile are written in the order they came once
+// it is known for all of their vertices whether they finalize them. the
+// copy of a vertex is written right before the first triangle that uses it
+
+static void release(SplitTile* tile)
+{
+  int i;
+  SplitTriangle* triangle;
+  SplitCopy* copy;
+  SplitCopy* done[3];
+  SMsplitEvent* split_event;
+
+  while (tile->first && tile->first->unresolved == 0)
+  {
+    triangle = tile->first;
+    tile->first = triangle->next;
+    if (tile->first == 0) tile->last = 0;
+    tile->waiting--;
+
+    for (i = 0; i < 3; i++)
+    {
+      copy = triangle->copy[i];
+      if (copy->index == -1)
+      {
+        split_event = putEvent(tile, SM_VERTEX);
+        VecCopy3fv(split_event->v, copy->v);
+        copy->index = tile->v_count;
+        tile->v_count++;
+      }
+    }
+    split_event = putEvent(tile, SM_TRIANGLE);
+    for (i = 0; i < 3; i++)
+    {
+      copy = triangle->copy[i];
+      split_event->idx[i] = copy->index;
+      split_event->final[i] = triangle->final[i];
+      split_event->seam[i] = (triangle->final[i] && copy->seam);
+      split_event->global[i] = copy->global;
+      done[i] = (triangle->final[i] ? copy : 0);
+    }
+    tile->f_count++;
+    for (i = 0; i < 3; i++)
+    {
+      if (done[i]) delete done[i];
+    }
+    delete triangle;
+  }
+}
+
+static void resolve(SplitTriangle* triangle, int corner, bool final)
+{
+  triangle->final[corner] = final;
+  triangle->unresolved--;
+}
+
+// once a vertex is finalized in the input the last triangle of every tile
+// that uses it finalizes its copy
+
+static void finalize(SMidx v_idx)
+{
+  my_split_hash::iterator hash_element = split_hash->find(v_idx);
+  if (hash_element == split_hash->end())
+  {
+    fprintf(stderr,"WARNING: finalized vertex " SM_IDX_FORMAT " not in hash\n", v_idx);
+    return;
+  }
+  SplitVertex* vertex = (*hash_element).second;
+  split_hash->erase(hash_element);
+
+  SplitCopy* copy = vertex->copy;
+  SplitCopy* next;
+  while (copy)
+  {
+    next = copy->next;
+    copy->seam = (vertex->copies > 1);
+    resolve(copy->last, copy->last_corner, true);
+    release(tiles[copy->tile]);
+    copy = next;
+  }
+  delete vertex;
+}
+
+static int locate(const float* v, int n, int axis)
+{
+  if (n == 1 || bb_max[axis] <= bb_min[axis]) return 0;
+  int c = (int)(n*(v[axis] - bb_min[axis])/(bb_max[axis] - bb_min[axis]));
+  if (c < 0) return 0;
+  if (c >= n) return n-1;
+  return c;
+}
+
+static SMreader* open_reader(const char* file_name, FILE** file)
+{
+  if (strstr(file_name, ".sma"))
+  {
+    *file = fopen(file_name, "r");
+  }
+  else if (strstr(file_name, ".smb") || strstr(file_name, ".smc") || strstr(file_name, ".sme"))
+  {
+    *file = fopen(file_name, "rb");
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: input file '%s' name does not end in .sma .smb .smc or .sme. use sm2sm\n", file_name);
+    return 0;
+  }
+  if (*file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name);
+    return 0;
+  }
+  if (strstr(file_name, ".sma"))
+  {
+    SMreader_sma* smreader_sma = new SMreader_sma();
+    smreader_sma->open(*file);
+    return smreader_sma;
+  }
+  else if (strstr(file_name, ".smb"))
+  {
+    SMreader_smb* smreader_smb = new SMreader_smb();
+    smreader_smb->open(*file);
+    return smreader_smb;
+  }
+  SMreader_smc* smreader_smc = new SMreader_smc();
+  if (!smreader_smc->open(*file))
+  {
+    delete smreader_smc;
+    fclose(*file);
+    return 0;
+  }
+  *file = 0; // closing the SMC reader closes the file
+  return smreader_smc;
+}
+
+// an additional pass over the input for meshes without a bounding box
+
+static bool compute_boundingbox(const char* file_name)
+{
+  FILE* file;
+  SMreader* smreader = open_reader(file_name, &file);
+  if (smreader == 0) return false;
+  SMevent event;
+  bool first = true;
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    if (event == SM_VERTEX)
+    {
+      if (first)
+      {
+        VecCopy3fv(bb_min, smreader->v_pos_f);
+        VecCopy3fv(bb_max, smreader->v_pos_f);
+        first = false;
+      }
+      else
+      {
+        VecUpdateMinMax3fv(bb_min, bb_max, smreader->v_pos_f);
+      }
+    }
+  }
+  smreader->close();
+  if (file) fclose(file);
+  delete smreader;
+  return !first;
+}
+
+// the numbers of vertices and triangles are written with 64 bits (version 2)
+
+static void write_number(FILE* file, SMidx number)
+{
+  SMoffset n = number;
+  fwrite(&n, sizeof(SMoffset), 1, file);
+}
+
+static bool write_smt(const char* file_name, const int* n, SMidx v_count, SMidx f_count)
+{
+  int t, length;
+  FILE* file = fopen(file_name, "wb");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for write\n", file_name);
+    return false;
+  }
+  int endian = 1;
+  fputc('S', file);
+  fputc('M', file);
+  fputc('T', file);
+  fputc(2, file); // version
+  fwrite(&endian, sizeof(int), 1, file);
+  fwrite(n, sizeof(int), 3, file);
+  fwrite(bb_min, sizeof(float), 3, file);
+  fwrite(bb_max, sizeof(float), 3, file);
+  write_number(file, v_count);
+  write_number(file, f_count);
+  fwrite(&tiles_number, sizeof(int), 1, file);
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      length = (int)strlen(tiles[t]->file_name);
+      fwrite(&length, sizeof(int), 1, file);
+      fwrite(tiles[t]->file_name, sizeof(char), length, file);
+      write_number(file, tiles[t]->v_count);
+      write_number(file, tiles[t]->f_count);
+    }
+    else
+    {
+      length = 0;
+      fwrite(&length, sizeof(int), 1, file);
+    }
+  }
+  int seams_number = 0;
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t]) seams_number += tiles[t]->seams_number;
+  }
+  fwrite(&seams_number, sizeof(int), 1, file);
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      for (int s = 0; s < tiles[t]->seams_number; s++)
+      {
+        write_number(file, tiles[t]->seams[2*s+0]);
+        fwrite(&t, sizeof(int), 1, file);
+        write_number(file, tiles[t]->seams[2*s+1]);
+      }
+    }
+  }
+  bool ok = (ferror(file) == 0);
+  fclose(file);
+  if (!ok)
+  {
+    fprintf(stderr,"ERROR: cannot write '%s'\n", file_name);
+  }
+  return ok;
+}
+
+int main(int argc, char *argv[])
+{
+  int i, t;
+  int n[3] = {1, 1, 1};
+  char* file_name_in = 0;
+  char* file_name_out = 0;
+  char* file_name_smt = 0;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-i") == 0)
+    {
+      i++;
+      file_name_in = argv[i];
+    }
+    else if (strcmp(argv[i],"-o") == 0)
+    {
+      i++;
+      file_name_out = argv[i];
+    }
+    else if (strcmp(argv[i],"-smt") == 0)
+    {
+      i++;
+      file_name_smt = argv[i];
+    }
+    else if (strcmp(argv[i],"-tiles") == 0)
+    {
+      if (i+2 >= argc)
+      {
+        usage();
+      }
+      n[0] = atoi(argv[i+1]);
+      n[1] = atoi(argv[i+2]);
+      i+=2;
+      if (i+1 < argc && argv[i+1][0] != '-')
+      {
+        i++;
+        n[2] = atoi(argv[i]);
+      }
+    }
+    else if (strcmp(argv[i],"-b") == 0 || strcmp(argv[i],"-bits") == 0)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (file_name_in == 0 || file_name_out == 0 || i > argc)
+  {
+    usage();
+  }
+
+  if (n[0] < 1 || n[1] < 1 || n[2] < 1 || n[0]*n[1]*n[2] > SM_SPLIT_MAX_TILES)
+  {
+    fprintf(stderr,"ERROR: need between 1 and %d tiles\n", SM_SPLIT_MAX_TILES);
+    exit(1);
+  }
+
+  if (!strstr(file_name_out, ".sma") && !strstr(file_name_out, ".smb") && !strstr(file_name_out, ".smc") && !strstr(file_name_out, ".sme"))
+  {
+    fprintf(stderr,"ERROR: output file name '%s' does not end in .sma .smb .smc or .sme\n", file_name_out);
+    exit(1);
+  }
+
+  FILE* file_in;
+  SMreader* smreader = open_reader(file_name_in, &file_in);
+  if (smreader == 0)
+  {
+    exit(1);
+  }
+  if (smreader->post_order)
+  {
+    fprintf(stderr,"ERROR: '%s' is in post-order. use sm2sm\n", file_name_in);
+    exit(1);
+  }
+
+  bb_min = new float[3];
+  bb_max = new float[3];
+  if (smreader->bb_min_f && smreader->bb_max_f)
+  {
+    VecCopy3fv(bb_min, smreader->bb_min_f);
+    VecCopy3fv(bb_max, smreader->bb_max_f);
+  }
+  else
+  {
+    fprintf(stderr,"computing bounding box of '%s' ...\n", file_name_in);
+    if (!compute_boundingbox(file_name_in))
+    {
+      fprintf(stderr,"ERROR: '%s' has no vertices\n", file_name_in);
+      exit(1);
+    }
+  }
+
+  tiles_number = n[0]*n[1]*n[2];
+  tiles = (SplitTile**)malloc(sizeof(SplitTile*)*tiles_number);
+  for (t = 0; t < tiles_number; t++) tiles[t] = 0;
+
+  split_hash = new my_split_hash;
+
+  double start = get_time();
+
+  fprintf(stderr,"splitting '%s' into %d x %d x %d tiles\n", file_name_in, n[0], n[1], n[2]);
+
+  SMevent event;
+  my_split_hash::iterator hash_element;
+  SplitVertex* vertex;
+  SplitCopy* copy;
+  SplitTriangle* triangle;
+  SplitTile* tile;
+  float centroid[3];
+  bool ok = true;
+
+  while (ok && (event = smreader->read_element()) > SM_EOF)
+  {
+    if (event == SM_VERTEX)
+    {
+      vertex = new SplitVertex;
+      VecCopy3fv(vertex->v, smreader->v_pos_f);
+      vertex->copies = 0;
+      vertex->copy = 0;
+      split_hash->insert(my_split_hash::value_type(smreader->v_idx, vertex));
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      SplitVertex* vertices[3];
+      for (i = 0; i < 3; i++)
+      {
+        hash_element = split_hash->find(smreader->t_idx[i]);
+        if (hash_element == split_hash->end())
+        {
+          fprintf(stderr,"ERROR: vertex " SM_IDX_FORMAT " of triangle " SM_IDX_FORMAT " not in hash\n", smreader->t_idx[i], smreader->f_count-1);
+          ok = false;
+          break;
+        }
+        vertices[i] = (*hash_element).second;
+      }
+      if (!ok) break;
+
+      VecCopy3fv(centroid, vertices[0]->v);
+      VecSelfAdd3fv(centroid, vertices[1]->v);
+      VecSelfAdd3fv(centroid, vertices[2]->v);
+      VecSelfScalarDiv3fv(centroid, 3.0f);
+      t = (locate(centroid, n[2], 2)*n[1] + locate(centroid, n[1], 1))*n[0] + locate(centroid, n[0], 0);
+
+      if (tiles[t] == 0)
+      {
+        tiles[t] = start_tile(file_name_out, t);
+        if (tiles[t] == 0)
+        {
+          ok = false;
+          break;
+        }
+      }
+      tile = tiles[t];
+
+      triangle = new SplitTriangle;
+      triangle->unresolved = 3;
+      triangle->next = 0;
+      for (i = 0; i < 3; i++)
+      {
+        vertex = vertices[i];
+        copy = vertex->copy;
+        while (copy && copy->tile != t) copy = copy->next;
+        if (copy == 0)
+        {
+          copy = new SplitCopy;
+          VecCopy3fv(copy->v, vertex->v);
+          copy->global = smreader->t_idx[i];
+          copy->tile = t;
+          copy->index = -1;
+          copy->seam = false;
+          copy->last = 0;
+          copy->next = vertex->copy;
+          vertex->copy = copy;
+          vertex->copies++;
+          copies_number++;
+        }
+        else
+        {
+          // the previous triangle of the tile does not finalize it
+          resolve(copy->last, copy->last_corner, false);
+        }
+        copy->last = triangle;
+        copy->last_corner = i;
+        triangle->copy[i] = copy;
+        triangle->final[i] = false;
+      }
+      if (tile->last)
+      {
+        tile->last->next = triangle;
+      }
+      else
+      {
+        tile->first = triangle;
+      }
+      tile->last = triangle;
+      tile->waiting++;
+      if (tile->waiting > tile->max_waiting) tile->max_waiting = tile->waiting;
+
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader->t_final[i]) finalize(smreader->t_idx[i]);
+      }
+      release(tile);
+    }
+    else if (event == SM_FINALIZED)
+    {
+      finalize(smreader->final_idx);
+    }
+  }
+
+  if (event == SM_ERROR)
+  {
+    fprintf(stderr,"ERROR: failed reading '%s'\n", file_name_in);
+    ok = false;
+  }
+
+  // vertices that the input never finalized are finalized at its end
+
+  if (ok && split_hash->size())
+  {
+    fprintf(stderr,"WARNING: %d vertices were not finalized\n", (int)split_hash->size());
+    while (split_hash->size())
+    {
+      finalize((*(split_hash->begin())).first);
+    }
+  }
+
+  SMidx v_count = smreader->v_count;
+  SMidx f_count = smreader->f_count;
+  smreader->close();
+  if (file_in) fclose(file_in);
+  delete smreader;
+
+  int max_waiting = 0;
+  int waits = 0;
+  int used = 0;
+  int seams = 0;
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      finish_tile(tiles[t]);
+      if (!tiles[t]->ok) ok = false;
+      if (tiles[t]->max_waiting > max_waiting) max_waiting = tiles[t]->max_waiting;
+      waits += tiles[t]->waits;
+      seams += tiles[t]->seams_number;
+      used++;
+    }
+  }
+
+  if (ok)
+  {
+    if (file_name_smt)
+    {
+      ok = write_smt(file_name_smt, n, v_count, f_count);
+    }
+    else
+    {
+      char* file_name = (char*)malloc(strlen(file_name_out) + 5);
+      const char* extension = strrchr(file_name_out, '.');
+      int length = (extension ? (int)(extension - file_name_out) : (int)strlen(file_name_out));
+      sprintf(file_name, "%.*s.smt", length, file_name_out);
+      ok = write_smt(file_name, n, v_count, f_count);
+      free(file_name);
+    }
+  }
+
+  fprintf(stderr,"split " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles into %d tiles in %.3f seconds.\n", v_count, f_count, used, get_time() - start);
+  fprintf(stderr,SM_IDX_FORMAT " vertices were written " SM_IDX_FORMAT " times. %d copies are on seams.\n", v_count, copies_number, seams);
+  fprintf(stderr,"at most %d triangles waited in a tile. %d times a tile was busy.\n", max_waiting, waits);
+
+  for (t = 0; t < tiles_number; t++)
+  {
+    if (tiles[t])
+    {
+      free(tiles[t]->file_name);
+      free(tiles[t]->seams);
+      free(tiles[t]);
+    }
+  }
+  free(tiles);
+  delete split_hash;
+  delete [] bb_min;
+  delete [] bb_max;
+
+  return (ok ? 0 : 1);
+}
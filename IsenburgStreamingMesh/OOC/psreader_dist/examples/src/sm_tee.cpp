@@ -0,0 +1,366 @@
+/*
+===============================================================================
+
+  FILE:  sm_tee.cpp
+
+  CONTENTS:
+
+    This program decodes a streaming mesh once and writes it to several
+    outputs at the same time (e.g. an SMB and SMCs with 12 and 16 bits).
+    the '-bits' option applies to the outputs that follow it. with '-info'
+    the number of elements, the bounding box, and the largest number of
+    vertices that were read but not yet finalized are gathered as well.
+
+    every output is written by its own thread, so that the slowest encoder
+    rather than the sum of all of them sets the speed. the number of times
+    the decoder had to wait for an output shows which one that is. every
+    thread opens, writes, and closes its writer, so that it can also tell
+    how much it wrote. the SMD compressor keeps its state per process, so
+    there can only be one SMD output.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to derive several outputs from one decode
+
+===============================================================================
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "smreader_sma.h"
+#include "smreader_smb.h"
+#include "smreader_smc.h"
+#include "smreader_smd.h"
+#include "smwriter_sma.h"
+#include "smwriter_smb.h"
+#include "smwriter_smc.h"
+#include "smwriter_smd.h"
+#include "smtee.h"
+
+#include "vec3fv.h"
+
+void usage()
+{
+  fprintf(stderr,"usage:\n");
+  fprintf(stderr,"sm_tee -i mesh.smb -o mesh.sma -o mesh.smc\n");
+  fprintf(stderr,"sm_tee -i mesh.smc -o mesh.smb -bits 12 -o mesh12.smc -bits 16 -o mesh16.smc\n");
+  fprintf(stderr,"sm_tee -i mesh.smd -o mesh.smc -info\n");
+  fprintf(stderr,"sm_tee -h\n");
+  exit(1);
+}
+
+static double get_time()
+{
+#ifdef _WIN32
+  return 0.001*GetTickCount();
+#else
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + 0.000001*tv.tv_usec;
+#endif
+}
+
+#define SM_TEE_MAX_OUTPUTS (SM_TEE_MAX_SINKS-1)
+
+typedef struct TeeOutput
+{
+  char* file_name;
+  int bits;
+  FILE* file;
+  SMidx v_count;
+  SMidx f_count;
+} TeeOutput;
+
+// opens the writer on the thread of the output, copies the mesh, and
+// remembers the counts before they are reset by close()
+
+static void write_output(SMreader* smreader, void* data)
+{
+  TeeOutput* output = (TeeOutput*)data;
+  SMwriter* smwriter;
+  SMevent event;
+  int i;
+
+  if (strstr(output->file_name, ".sma"))
+  {
+    SMwriter_sma* smwriter_sma = new SMwriter_sma();
+    smwriter_sma->open(output->file);
+    smwriter = smwriter_sma;
+  }
+  else if (strstr(output->file_name, ".smb"))
+  {
+    SMwriter_smb* smwriter_smb = new SMwriter_smb();
+    smwriter_smb->open(output->file);
+    smwriter = smwriter_smb;
+  }
+  else if (strstr(output->file_name, ".smc"))
+  {
+    SMwriter_smc* smwriter_smc = new SMwriter_smc();
+    smwriter_smc->open(output->file, output->bits);
+    smwriter = smwriter_smc;
+  }
+  else
+  {
+    SMwriter_smd* smwriter_smd = new SMwriter_smd();
+    smwriter_smd->open(output->file, output->bits);
+    smwriter = smwriter_smd;
+  }
+
+  for (i = 0; i < smreader->ncomments; i++) smwriter->add_comment(smreader->comments[i]);
+  if (smreader->nverts != -1) smwriter->set_nverts(smreader->nverts);
+  if (smreader->nfaces != -1) smwriter->set_nfaces(smreader->nfaces);
+  if (smreader->bb_min_f && smreader->bb_max_f) smwriter->set_boundingbox(smreader->bb_min_f, smreader->bb_max_f);
+
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    switch (event)
+    {
+    case SM_VERTEX:
+      smwriter->write_vertex(smreader->v_pos_f);
+      break;
+    case SM_TRIANGLE:
+      smwriter->write_triangle(smreader->t_idx, smreader->t_final);
+      break;
+    case SM_FINALIZED:
+      smwriter->write_finalized(smreader->final_idx);
+      break;
+    default:
+      break;
+    }
+  }
+
+  output->v_count = smwriter->v_count;
+  output->f_count = smwriter->f_count;
+  smwriter->close();
+  delete smwriter;
+}
+
+typedef struct TeeInfo
+{
+  SMidx v_count;
+  SMidx f_count;
+  SMidx finalized;
+  SMidx max_live;
+  bool have_bb;
+  float bb_min[3];
+  float bb_max[3];
+} TeeInfo;
+
+static void gather_info(SMreader* smreader, void* data)
+{
+  TeeInfo* info = (TeeInfo*)data;
+  SMevent event;
+
+  info->finalized = 0;
+  info->max_live = 0;
+  info->have_bb = false;
+
+  while ((event = smreader->read_event()) > SM_EOF)
+  {
+    switch (event)
+    {
+    case SM_VERTEX:
+      if (info->have_bb)
+      {
+        VecUpdateMinMax3fv(info->bb_min, info->bb_max, smreader->v_pos_f);
+      }
+      else
+      {
+        VecCopy3fv(info->bb_min, smreader->v_pos_f);
+        VecCopy3fv(info->bb_max, smreader->v_pos_f);
+        info->have_bb = true;
+      }
+      if (smreader->v_count - info->finalized > info->max_live) info->max_live = smreader->v_count - info->finalized;
+      break;
+    case SM_FINALIZED:
+      info->finalized++;
+      break;
+    default:
+      break;
+    }
+  }
+  info->v_count = smreader->v_count;
+  info->f_count = smreader->f_count;
+}
+
+int main(int argc, char *argv[])
+{
+  int i, s;
+  int bits = 16;
+  bool info = false;
+  char* file_name_in = 0;
+  int noutputs = 0;
+  char* file_names_out[SM_TEE_MAX_OUTPUTS];
+  int bits_out[SM_TEE_MAX_OUTPUTS];
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i],"-i") == 0)
+    {
+      i++;
+      file_name_in = argv[i];
+    }
+    else if (strcmp(argv[i],"-o") == 0)
+    {
+      i++;
+      if (noutputs == SM_TEE_MAX_OUTPUTS)
+      {
+        fprintf(stderr,"ERROR: cannot write more than %d outputs\n", SM_TEE_MAX_OUTPUTS);
+        exit(1);
+      }
+      file_names_out[noutputs] = argv[i];
+      bits_out[noutputs] = bits;
+      noutputs++;
+    }
+    else if (strcmp(argv[i],"-b") == 0 || strcmp(argv[i],"-bits") == 0)
+    {
+      i++;
+      bits = atoi(argv[i]);
+    }
+    else if (strcmp(argv[i],"-info") == 0)
+    {
+      info = true;
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  if (file_name_in == 0 || (noutputs == 0 && !info) || i > argc)
+  {
+    usage();
+  }
+
+  SMreader* smreader;
+  FILE* file_in = fopen(file_name_in, (strstr(file_name_in, ".sma") ? "r" : "rb"));
+  if (file_in == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for read\n", file_name_in);
+    exit(1);
+  }
+  if (strstr(file_name_in, ".sma"))
+  {
+    SMreader_sma* smreader_sma = new SMreader_sma();
+    smreader_sma->open(file_in);
+    smreader = smreader_sma;
+  }
+  else if (strstr(file_name_in, ".smb"))
+  {
+    SMreader_smb* smreader_smb = new SMreader_smb();
+    smreader_smb->open(file_in);
+    smreader = smreader_smb;
+  }
+  else if (strstr(file_name_in, ".smc"))
+  {
+    SMreader_smc* smreader_smc = new SMreader_smc();
+    smreader_smc->open(file_in);
+    smreader = smreader_smc;
+  }
+  else if (strstr(file_name_in, ".smd"))
+  {
+    SMreader_smd* smreader_smd = new SMreader_smd();
+    smreader_smd->open(file_in);
+    smreader = smreader_smd;
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: input file name '%s' does not end in .sma .smb .smc or .smd\n", file_name_in);
+    exit(1);
+  }
+
+  SMtee smtee;
+  smtee.open(smreader);
+
+  TeeOutput outputs[SM_TEE_MAX_OUTPUTS];
+  int nsmd = 0;
+
+  for (s = 0; s < noutputs; s++)
+  {
+    outputs[s].file_name = file_names_out[s];
+    outputs[s].bits = bits_out[s];
+    if (strstr(outputs[s].file_name, ".sma"))
+    {
+      outputs[s].file = fopen(outputs[s].file_name, "w");
+    }
+    else if (strstr(outputs[s].file_name, ".smb") || strstr(outputs[s].file_name, ".smc") || strstr(outputs[s].file_name, ".smd"))
+    {
+      outputs[s].file = fopen(outputs[s].file_name, "wb");
+      if (strstr(outputs[s].file_name, ".smd")) nsmd++;
+    }
+    else
+    {
+      fprintf(stderr,"ERROR: output file name '%s' does not end in .sma .smb .smc or .smd\n", outputs[s].file_name);
+      exit(1);
+    }
+    if (nsmd > 1)
+    {
+      fprintf(stderr,"ERROR: cannot write more than one SMD output\n");
+      exit(1);
+    }
+    if (outputs[s].file == 0)
+    {
+      fprintf(stderr,"ERROR: cannot open '%s' for write\n", outputs[s].file_name);
+      exit(1);
+    }
+    if (smtee.add_consumer(write_output, &(outputs[s])) == -1)
+    {
+      exit(1);
+    }
+  }
+
+  TeeInfo tee_info;
+  if (info && smtee.add_consumer(gather_info, &tee_info) == -1)
+  {
+    exit(1);
+  }
+
+  double start = get_time();
+
+  while (smtee.read_element() > SM_EOF);
+
+  SMidx v_count = smtee.v_count;
+  SMidx f_count = smtee.f_count;
+  smtee.close();
+
+  fprintf(stderr,"read " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles once for %d outputs in %.3f seconds\n", v_count, f_count, noutputs, get_time() - start);
+
+  for (s = 0; s < noutputs; s++)
+  {
+    fprintf(stderr,"wrote " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles to '%s', which made the decoder wait %d times\n", outputs[s].v_count, outputs[s].f_count, outputs[s].file_name, smtee.get_waits(s));
+    fclose(outputs[s].file);
+  }
+
+  if (info)
+  {
+    fprintf(stderr,"vertices " SM_IDX_FORMAT " triangles " SM_IDX_FORMAT "\n", tee_info.v_count, tee_info.f_count);
+    if (tee_info.have_bb) fprintf(stderr,"bb (%g %g %g) (%g %g %g)\n", tee_info.bb_min[0], tee_info.bb_min[1], tee_info.bb_min[2], tee_info.bb_max[0], tee_info.bb_max[1], tee_info.bb_max[2]);
+    fprintf(stderr,"at most " SM_IDX_FORMAT " vertices were not finalized\n", tee_info.max_live);
+  }
+
+  // the SMC and SMD readers close their file themselves
+
+  if (strstr(file_name_in, ".sma") || strstr(file_name_in, ".smb")) fclose(file_in);
+  delete smreader;
+
+  return 0;
+}
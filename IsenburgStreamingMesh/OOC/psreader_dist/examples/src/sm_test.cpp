@@ -273,8 +273,8 @@ int main(int argc, char *argv[])
     if (event1 != event2)
     {
       fprintf(stderr,"event1 %d event2 %d\n",event1,event2);
-      fprintf(stderr,"v_count %d %d\n",smreader1->v_count, smreader2->v_count);
-      fprintf(stderr,"f_count %d %d\n",smreader1->f_count, smreader2->f_count);
+      fprintf(stderr,"v_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader1->v_count, smreader2->v_count);
+      fprintf(stderr,"f_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader1->f_count, smreader2->f_count);
       exit(1);
     }
 
@@ -287,8 +287,8 @@ int main(int argc, char *argv[])
         int* p1 = (int*)(smreader1->v_pos_f);
         int* p2 = (int*)(smreader2->v_pos_f);
         fprintf(stderr,"%d %d %d %d %d %d \n",p1[0],p2[0],p1[1],p2[1],p1[2],p2[2]);
-        fprintf(stderr,"v_count %d %d\n",smreader1->v_count, smreader2->v_count);
-        fprintf(stderr,"f_count %d %d\n",smreader1->f_count, smreader2->f_count);
+        fprintf(stderr,"v_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader1->v_count, smreader2->v_count);
+        fprintf(stderr,"f_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader1->f_count, smreader2->f_count);
 
         VecCopy3fv(&(v_pos_f1[resolve*3]), smreader1->v_pos_f);
         VecCopy3fv(&(v_pos_f2[resolve*3]), smreader2->v_pos_f);
@@ -330,8 +330,8 @@ int main(int argc, char *argv[])
     }
   }
 
-  fprintf(stderr,"v_count %d %d\n",smreader1->v_count, smreader2->v_count);
-  fprintf(stderr,"f_count %d %d\n",smreader1->f_count, smreader2->f_count);
+  fprintf(stderr,"v_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader1->v_count, smreader2->v_count);
+  fprintf(stderr,"f_count " SM_IDX_FORMAT " " SM_IDX_FORMAT "\n",smreader1->f_count, smreader2->f_count);
 
 #ifdef _WIN32
   fprintf(stderr,"needed %6.3f seconds\n",0.001f*gettime_in_msec());
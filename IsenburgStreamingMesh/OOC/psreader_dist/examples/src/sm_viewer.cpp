@@ -21,6 +21,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the vertex clustering without display is SMreadClustered
     24 January 2005 -- improved SME takes place of old SMC
     20 January 2005 -- added out-of-core rendering functionality ('r')
     12 January 2005 -- added support for stdin/stdout
@@ -143,6 +144,9 @@ int Time=0;
 
 // efficient memory allocation
 
+// the grid vertices are kept until the end so they can be displayed. see
+// SMreadClustered for the same clustering as a filter with bounded memory
+
 typedef struct GridVertex
 {
   float v[3];
@@ -157,8 +161,8 @@ typedef struct RenderVertex
   float v[3];
 } RenderVertex;
 
-typedef hash_map<int, int> my_hash;
-typedef hash_map<int, RenderVertex*> my_other_hash;
+typedef hash_map<SMidx, int> my_hash;
+typedef hash_map<SMidx, RenderVertex*> my_other_hash;
 
 static my_hash* map_hash;
 static int index_map_size = 0;
@@ -948,8 +952,8 @@ void vizBegin()
   boundingBoxTranslateY = - boundingBoxScale * (smreader->bb_min_f[1] + 0.5f * (smreader->bb_max_f[1]-smreader->bb_min_f[1]));
   boundingBoxTranslateZ = - boundingBoxScale * (smreader->bb_min_f[2] + 0.5f * (smreader->bb_max_f[2]-smreader->bb_min_f[2]));
 
-  nverts = smreader->nverts;
-  nfaces = smreader->nfaces;
+  nverts = (int)smreader->nverts;
+  nfaces = (int)smreader->nfaces;
 
   fprintf(stderr,"nverts %d\n",nverts);
   fprintf(stderr,"nfaces %d\n",nfaces);
@@ -1032,7 +1036,14 @@ int vizContinue()
       }
       if (COMPUTE_VERTEX_SPAN)
       {
-        unsigned short v_span = (unsigned short)((((float)(VecMax3iv(smreader->t_idx) - VecMin3iv(smreader->t_idx)))/((float)nverts))*65535);
+        SMidx v_min = smreader->t_idx[0];
+        SMidx v_max = smreader->t_idx[0];
+        for (i = 1; i < 3; i++)
+        {
+          if (smreader->t_idx[i] < v_min) v_min = smreader->t_idx[i];
+          else if (smreader->t_idx[i] > v_max) v_max = smreader->t_idx[i];
+        }
+        unsigned short v_span = (unsigned short)((((float)(v_max - v_min))/((float)nverts))*65535);
         if (v_span > max_vertex_span) max_vertex_span = v_span;
 
         for (i = 0; i < 3; i++)
@@ -1181,7 +1192,7 @@ void full_resolution_rendering()
 
   if (smreader)
   {
-    f_count = smreader->f_count;
+    f_count = (int)smreader->f_count;
     fprintf(stderr,"out-of-core rendering of %d mesh faces ... \n",f_count);
     smreader->close();
     fclose(file);
@@ -1387,7 +1398,7 @@ void full_resolution_rendering()
 
   if (f_count == 0)
   {
-    f_count = smreader->nfaces;
+    f_count = (int)smreader->nfaces;
   }
 
   int i;
@@ -23,6 +23,9 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- fill_output_buffer() and hash resizes are traced
+    19 October 2026 -- buffer sizes and edge types are kept in runtime statistics
+    19 October 2026 -- hash nodes come from a pool. vertex lists grow by doubling
     21 March 2005 -- fixed a bug in set_vdata() for non-manifold vertices
     21 December 2004 -- moved t_idx_orig to PSreader.h interface
     16 January 2004 -- fixed a mean memory bug under SIG04 deadline stress
@@ -57,6 +60,8 @@ public:
 
   void close();
 
+  const SMstats* get_stats() const;
+
   // psreader_converter functions
 
   bool open(SMreader* smreader, int low=256, int high=512);
@@ -21,6 +21,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- indices and counts are SMidx (64 bits with SM_64BIT_INDICES)
+    19 October 2026 -- added get_stats() for the runtime statistics
     21 December 2004 -- added t_idx_orig which used to be in PSconverter.h
     17 January 2004 -- added virtual destructor to shut up the g++ compiler
     13 January 2004 -- added t_orig which used to be in PSconverter.h
@@ -33,6 +35,10 @@
 #ifndef PSREADER_H
 #define PSREADER_H
 
+#include "smidx.h"
+
+class SMstats;
+
 // events 
 typedef enum {
   PS_ERROR = -1,
@@ -69,15 +75,15 @@ public:
   
   // vertex variables
 
-  int    v_idx;
+  SMidx  v_idx;
   float* v_pos_f;
   int    v_vflag;
 
   // triangle variables
 
-  int    t_orig;
-  int*   t_idx_orig; // may point to the field t_idx[3]
-  int    t_idx[3];
+  SMidx  t_orig;
+  SMidx* t_idx_orig; // may point to the field t_idx[3]
+  SMidx  t_idx[3];
   float* t_pos_f[3];
   int    t_vflag[3];
   int    t_eflag[3];
@@ -87,13 +93,13 @@ public:
   float* bb_min_f;
   float* bb_max_f;
 
-  int nfaces;
-  int nverts;
+  SMidx nfaces;
+  SMidx nverts;
   int ncomps;
 
-  int f_count;
+  SMidx f_count;
   int h_count;
-  int v_count;
+  SMidx v_count;
   int c_count;
 
   int nm_v_count;
@@ -111,6 +117,10 @@ public:
 
   virtual void close() = 0;
 
+  // statistics (e.g. buffer sizes and operation counts). 0 if not collected
+
+  virtual const SMstats* get_stats() const { return 0; };
+
   virtual ~PSreader(){};
 };
 
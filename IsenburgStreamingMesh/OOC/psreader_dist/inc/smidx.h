@@ -0,0 +1,55 @@
+/*
+===============================================================================
+
+  FILE:  SMidx.h
+
+  CONTENTS:
+
+    The integer type of the vertex and triangle indices and of the element
+    counts of SMreader, SMwriter, and PSreader. It is an int unless the
+    library and everything that uses it are compiled with SM_64BIT_INDICES.
+    Then it is 64 bits wide for meshes with more than 2^31 vertices or
+    triangles. This needs a 64 bit build (a 'long' is 64 bits on LP64 Unix
+    systems and the hash_maps of the library know how to hash it).
+
+    SM_IDX_FORMAT prints (or scans) an SMidx with printf (e.g. "%d" or "%ld")
+    and SM_IDX_MAX is its largest value.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created for terrains and isosurfaces with billions of vertices
+
+===============================================================================
+*/
+#ifndef SM_IDX_H
+#define SM_IDX_H
+
+#ifdef SM_64BIT_INDICES
+#if defined(_WIN32)
+typedef __int64 SMidx;
+#define SM_IDX_FORMAT "%I64d"
+#define SM_IDX_MAX 0x7FFFFFFFFFFFFFFF
+#else
+typedef long SMidx;
+#define SM_IDX_FORMAT "%ld"
+#define SM_IDX_MAX 0x7FFFFFFFFFFFFFFFL
+#endif
+#else
+typedef int SMidx;
+#define SM_IDX_FORMAT "%d"
+#define SM_IDX_MAX 0x7FFFFFFF
+#endif
+
+#endif
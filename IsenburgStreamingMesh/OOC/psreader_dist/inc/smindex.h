@@ -0,0 +1,137 @@
+/*
+===============================================================================
+
+  FILE:  SMindex.h
+
+  CONTENTS:
+
+    A sidecar index (.smi) that cuts an SMB file into chunks of consecutive
+    elements so that a region of interest can be extracted by seeking only
+    to the chunks that intersect it (see SMreadIndexed.h). For each chunk it
+    stores the byte offset of its first SMB block, the number of vertices
+    and triangles before and in it, the bounding box of its vertices and of
+    the corners of its triangles, and how it changes the front. The front
+    before a chunk are the vertices of earlier chunks that are not yet
+    finalized. A chunk adds those of its vertices that its own triangles do
+    not finalize, together with their positions, and removes those of the
+    front that its triangles finalize. Each vertex is thus stored at most
+    once, so the positions of the vertices from earlier chunks that a
+    chunk uses are known after the changes of all chunks before it were
+    read, which only touches the index and not the SMB file.
+
+    An index that stored for every chunk all vertices of earlier chunks
+    that it uses would store a vertex again for every chunk that uses it.
+    For a mesh in the order of a scan, whose triangles use vertices across
+    many chunks, this made the index of the bunny three quarters as large
+    as its SMB file. Storing the changes of the front makes it 43% smaller.
+
+    The chunks start at SMB blocks of 32 elements, so 'chunk_size' (the
+    number of elements per chunk) is rounded up to a multiple of 32. The
+    index is built with one pass over the elements, either while they are
+    written (see SMwriteIndexed.h) or while they are read from an existing
+    SMB file (see SMreader_smb::tell_block()). The offset of the block of
+    the next element must be set with set_offset() whenever chunk_full()
+    says that the next element starts a new chunk. The chunks are written
+    to the file as soon as they are complete.
+
+    The state of the builder is kept per index, so any number of indices
+    can be built at the same time on one thread.
+
+    The offsets are 64 bit so that files larger than 2 GB can be indexed and
+    so are the vertex and triangle numbers and the indices of the vertices
+    that a chunk removes from the front. Those that it adds are stored by
+    their position in the chunk.
+    The index is written in the endianness of the machine that builds it.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- version 3 stores how the front changes instead of live vertices
+    19 October 2026 -- keeps the state of the builder per index rather than per thread
+    19 October 2026 -- version 2 stores element numbers and indices with 64 bits
+    19 October 2026 -- created to cut regions out of scans with billions of triangles
+
+===============================================================================
+*/
+#ifndef SM_INDEX_H
+#define SM_INDEX_H
+
+#include <stdio.h>
+
+#include "smidx.h"
+
+#if defined(_WIN32)
+typedef __int64 SMoffset;
+#else
+typedef long long SMoffset;
+#endif
+
+// 64 bit versions of ftell() and fseek(SEEK_SET)
+
+SMoffset sm_ftell(FILE* file);
+bool sm_fseek(FILE* file, SMoffset offset);
+
+typedef struct SMindexChunk
+{
+  SMoffset offset;         // byte offset of its first SMB block
+  SMidx v_start;           // vertices before it
+  SMidx f_start;           // triangles before it
+  int v_number;            // vertices in it
+  int f_number;            // triangles in it
+  float bb_min[3];
+  float bb_max[3];
+  int add_number;          // its vertices that are not finalized in it
+  int remove_number;       // vertices of earlier chunks that are finalized in it
+  SMoffset delta_offset;   // where they are stored in the .smi file
+} SMindexChunk;
+
+struct SMindexer;
+
+class SMindex
+{
+public:
+  int chunk_size;
+  int nchunks;
+  SMindexChunk* chunks;
+
+  // building an index
+
+  bool open_write(FILE* file, int chunk_size=65536);
+  bool chunk_full() const;
+  void set_offset(SMoffset offset);
+  void add_vertex(const float* v_pos_f);
+  void add_triangle(const SMidx* t_idx, const bool* t_final);
+  bool close_write();
+
+  // using an index
+
+  bool read(FILE* file);
+  int query(const float* roi_min, const float* roi_max, int* list) const;
+  bool read_delta(int c, SMidx* add_idx, float* add_pos, SMidx* remove_idx) const;
+
+  SMindex();
+  ~SMindex();
+
+private:
+  FILE* file;
+  int chunks_alloc;
+  SMidx v_count;
+  SMidx f_count;
+  SMoffset offset;
+  SMindexer* indexer;
+
+  bool write_chunk();
+};
+
+#endif
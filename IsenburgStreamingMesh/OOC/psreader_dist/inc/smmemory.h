@@ -0,0 +1,303 @@
+/*
+===============================================================================
+
+  FILE:  SMmemory.h
+
+  CONTENTS:
+
+    The bytes in memory that the SMreaders and SMwriters use instead of a
+    FILE when they are opened on memory (e.g. to serve meshes out of a
+    server without going through temporary files).
+
+    SMmemoryInput reads the bytes of the caller where they are. Whatever it
+    hands out with in_place() points into them, so they must stay around
+    until the reader is closed.
+
+    SMmemoryOutput either grows a buffer that close() hands over to the
+    caller (who must free() it) or fills a buffer of a fixed size that the
+    caller owns. In the second case the bytes that do not fit are counted
+    but dropped, so that close() can say how large the buffer needs to be.
+    Both write straight into the final buffer, so the bytes are never
+    copied once more when the writer is closed.
+
+    All sizes and offsets are size_t, so that meshes of more than 2 GB fit.
+    The size can be handed over in an int as well. Then close() fails when
+    there are more than 2^31-1 bytes.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- sizes and offsets are size_t rather than int
+    19 October 2026 -- created to embed the readers and writers in a tile server
+
+===============================================================================
+*/
+#ifndef SM_MEMORY_H
+#define SM_MEMORY_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+class SMmemoryInput
+{
+public:
+  const unsigned char* bytes;
+  size_t nbytes;
+  size_t current;
+
+  void open(const void* bytes, size_t nbytes)
+  {
+    this->bytes = (const unsigned char*)bytes;
+    this->nbytes = nbytes;
+    current = 0;
+  }
+
+  // like fgetc(), fread(), and fgets()
+
+  inline int get_byte()
+  {
+    return (current < nbytes ? bytes[current++] : EOF);
+  }
+
+  size_t read(void* data, size_t size, size_t number)
+  {
+    size_t available = (nbytes - current) / size;
+    if (number > available) number = available;
+    memcpy(data, bytes + current, size*number);
+    current += size*number;
+    return number;
+  }
+
+  char* get_line(char* line, int size)
+  {
+    int i = 0;
+    if (current == nbytes) return 0;
+    while (i < size-1 && current < nbytes)
+    {
+      line[i] = (char)bytes[current++];
+      if (line[i++] == '\n') break;
+    }
+    line[i] = '\0';
+    return line;
+  }
+
+  // returns where the next 'size' bytes are and moves past them or returns
+  // 0 if there are fewer left
+
+  inline const unsigned char* in_place(size_t size)
+  {
+    if (size > nbytes - current) return 0;
+    current += size;
+    return bytes + current - size;
+  }
+
+  size_t tell() const
+  {
+    return current;
+  }
+
+  bool seek(size_t offset)
+  {
+    if (offset > nbytes) return false;
+    current = offset;
+    return true;
+  }
+
+  SMmemoryInput()
+  {
+    bytes = 0;
+    nbytes = 0;
+    current = 0;
+  }
+};
+
+class SMmemoryOutput
+{
+public:
+
+  // the buffer grows as needed and close() hands it over in *bytes and its
+  // size in *nbytes
+
+  bool open(unsigned char** bytes, size_t* nbytes)
+  {
+    if (bytes == 0 || nbytes == 0)
+    {
+      fprintf(stderr,"ERROR: no place to put the bytes\n");
+      return false;
+    }
+    *bytes = 0;
+    *nbytes = 0;
+    handover_bytes = bytes;
+    handover_nbytes = nbytes;
+    handover_nbytes_int = 0;
+    this->bytes = 0;
+    nalloc = 0;
+    this->nbytes = 0;
+    grow = true;
+    return true;
+  }
+
+  bool open(unsigned char** bytes, int* nbytes)
+  {
+    if (nbytes == 0 || !open(bytes, &handover_size)) return false;
+    *nbytes = 0;
+    handover_nbytes_int = nbytes;
+    return true;
+  }
+
+  // the 'nalloc' bytes of the caller are filled and close() puts into
+  // *nbytes how many bytes there are, which is more than 'nalloc' when
+  // they did not all fit
+
+  bool open(void* bytes, size_t nalloc, size_t* nbytes)
+  {
+    if (bytes == 0 || nbytes == 0)
+    {
+      fprintf(stderr,"ERROR: no place to put the bytes\n");
+      return false;
+    }
+    *nbytes = 0;
+    handover_bytes = 0;
+    handover_nbytes = nbytes;
+    handover_nbytes_int = 0;
+    this->bytes = (unsigned char*)bytes;
+    this->nalloc = nalloc;
+    this->nbytes = 0;
+    grow = false;
+    return true;
+  }
+
+  bool open(unsigned char* bytes, int nalloc, int* nbytes)
+  {
+    if (nalloc < 0 || nbytes == 0)
+    {
+      fprintf(stderr,"ERROR: no place to put the bytes\n");
+      return false;
+    }
+    if (!open(bytes, (size_t)nalloc, &handover_size)) return false;
+    *nbytes = 0;
+    handover_nbytes_int = nbytes;
+    return true;
+  }
+
+  bool is_open() const
+  {
+    return handover_nbytes != 0;
+  }
+
+  // like fputc() and fwrite()
+
+  inline void put_byte(int c)
+  {
+    if (nbytes < nalloc || make_room(1)) bytes[nbytes] = (unsigned char)c;
+    nbytes++;
+  }
+
+  void write(const void* data, size_t size)
+  {
+    if ((nbytes <= nalloc && size <= nalloc - nbytes) || make_room(size)) memcpy(bytes + nbytes, data, size);
+    else if (nbytes < nalloc) memcpy(bytes + nbytes, data, nalloc - nbytes);
+    nbytes += size;
+  }
+
+  // returns false if the bytes did not fit
+
+  bool close()
+  {
+    bool fit = (nbytes <= nalloc);
+    if (!is_open()) return true;
+    if (handover_bytes)
+    {
+      *handover_bytes = bytes;
+      if (!fit) fprintf(stderr,"ERROR: could not grow the output to %.0f bytes\n", (double)nbytes);
+    }
+    else
+    {
+      if (!fit) fprintf(stderr,"ERROR: %.0f bytes do not fit into the %.0f bytes of the output\n", (double)nbytes, (double)nalloc);
+    }
+    *handover_nbytes = nbytes;
+    if (handover_nbytes_int)
+    {
+      if (nbytes > (size_t)INT_MAX)
+      {
+        fprintf(stderr,"ERROR: %.0f bytes are too many for an int. use a size_t for the size\n", (double)nbytes);
+        fit = false;
+      }
+      *handover_nbytes_int = (int)(nbytes > (size_t)INT_MAX ? INT_MAX : nbytes);
+    }
+    handover_bytes = 0;
+    handover_nbytes = 0;
+    handover_nbytes_int = 0;
+    bytes = 0;
+    nalloc = 0;
+    nbytes = 0;
+    return fit;
+  }
+
+  SMmemoryOutput()
+  {
+    handover_bytes = 0;
+    handover_nbytes = 0;
+    handover_nbytes_int = 0;
+    handover_size = 0;
+    bytes = 0;
+    nalloc = 0;
+    nbytes = 0;
+    grow = false;
+  }
+
+  ~SMmemoryOutput()
+  {
+    if (grow && handover_nbytes && bytes) free(bytes);
+  }
+
+private:
+  unsigned char** handover_bytes;
+  size_t* handover_nbytes;
+  int* handover_nbytes_int;
+  size_t handover_size;
+  unsigned char* bytes;
+  size_t nalloc;
+  size_t nbytes;
+  bool grow;
+
+  bool make_room(size_t size)
+  {
+    if (!grow || nbytes > nalloc) return false;
+    if (size > ((size_t)-1) - nbytes) return false;
+    size_t n = (nalloc ? nalloc : 4096);
+    while (n < nbytes + size)
+    {
+      if (n > ((size_t)-1) / 2)
+      {
+        n = nbytes + size;
+        break;
+      }
+      n = 2*n;
+    }
+    unsigned char* more = (unsigned char*)realloc(bytes, sizeof(unsigned char)*n);
+    if (more == 0)
+    {
+      // keep counting what does not fit so that close() reports it
+      return false;
+    }
+    bytes = more;
+    nalloc = n;
+    return true;
+  }
+};
+
+#endif
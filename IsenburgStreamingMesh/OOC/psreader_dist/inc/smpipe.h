@@ -0,0 +1,109 @@
+/*
+===============================================================================
+
+  FILE:  SMpipe.h
+
+  CONTENTS:
+
+    Connects code that pushes a Streaming Mesh into an SMwriter (e.g. a
+    generator such as an isosurface extraction) to code that pulls it from
+    an SMreader (e.g. a PSconverter) without writing it to disk in between.
+
+    The producer is a function that writes the next part of the mesh into
+    the SMwriter that it is given and returns whether there is more to
+    write. The SMpipe is the SMreader at the other end. The elements pass
+    through a bounded buffer in one of two ways:
+
+    With a thread the producer runs on a thread of its own and hands the
+    elements over in a ring of blocks. When all blocks are full it waits
+    until the reader has emptied one (backpressure), so the memory stays
+    bounded no matter how fast the producer is.
+
+    Without a thread the reader calls the producer cooperatively whenever
+    it has read everything that was produced so far. The buffer then holds
+    what one call of the producer writes, which should therefore be a small
+    part of the mesh (e.g. one slab of a volume).
+
+    The header (comments, nverts, nfaces, and the bounding box) must be set
+    before the first element is written. open() returns once it is known.
+    The stream is in post-order if its first element is a triangle. The
+    finalization of vertices is passed on as it was written, with the
+    t_final flags of the triangles or with write_finalized(), where a
+    negative index counts back from the number of vertices written so far.
+
+    Closing the SMpipe before the producer is done makes the writer drop
+    whatever else is written in the current call of the producer, which is
+    not called again.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to feed generated meshes into processing sequences
+
+===============================================================================
+*/
+#ifndef SMPIPE_H
+#define SMPIPE_H
+
+#include "smreader.h"
+#include "smwriter.h"
+
+// writes the next part of the mesh into 'smwriter' and returns true if
+// there is more to write. 'data' is whatever was given to SMpipe::open()
+
+typedef bool (*SMproducer)(SMwriter* smwriter, void* data);
+
+struct SMpipeQueue;
+
+class SMpipe : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  // smpipe functions
+
+  // with 'thread' the producer runs on its own thread and can be up to
+  // 'blocks' blocks of 'block_size' elements ahead of the reader.
+
+  bool open(SMproducer producer, void* data, bool thread=true, int block_size=4096, int blocks=4);
+
+  // with a thread how often the producer found all blocks full and how
+  // often the reader found them all empty (also after close)
+
+  int get_producer_waits() const;
+  int get_reader_waits() const;
+
+  SMpipe();
+  ~SMpipe();
+
+private:
+  SMpipeQueue* queue;
+  int get_block;
+  int next;
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+  int producer_waits;
+  int reader_waits;
+
+  SMevent next_event();
+  bool next_block();
+};
+
+#endif
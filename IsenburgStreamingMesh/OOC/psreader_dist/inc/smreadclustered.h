@@ -0,0 +1,105 @@
+/*
+===============================================================================
+
+  FILE:  SMreadClustered.h
+
+  CONTENTS:
+
+    Reads a *pre-order* Streaming Mesh and simplifies it on the fly with
+    vertex clustering. All vertices that fall into the same cell of a
+    uniform grid over the bounding box are merged into one representative
+    vertex. Triangles whose vertices end up in fewer than three different
+    cells are dropped and so are duplicates of triangles that were already
+    produced. The result is again a pre-order mesh.
+
+    Each cell accumulates the quadrics of the planes of the triangles around
+    its vertices. The representative vertex is placed where it minimizes
+    the quadric error (as in Lindstrom's out-of-core simplification, OoCS),
+    which keeps sharp features sharp. Where this position is ill-defined or
+    outside the cell the average of the vertices of the cell is used.
+
+    Unlike the grid of the vertex clustering in sm_viewer, which keeps all
+    cells until the end, a cell is retired once all vertices that fell into
+    it so far are finalized. Because a later vertex may still fall into the
+    same cell, such cells are kept waiting until 'memory' is used up (or
+    until the number of waiting cells exceeds four times the 'resolution')
+    and the cell that was waiting the longest is retired first. A vertex
+    that falls into a cell that was already retired starts a new cell. Thus
+    the memory is bounded by the width of the stream and not by the size of
+    the output. The more coherent the stream, the fewer cells are split.
+
+    Vertices that are not used by any triangle are dropped.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- keeps the state of the clustering per reader rather than per thread
+    19 October 2026 -- created from the vertex clustering of sm_viewer
+
+===============================================================================
+*/
+#ifndef SMREAD_CLUSTERED_H
+#define SMREAD_CLUSTERED_H
+
+#include "smreader.h"
+
+#define SM_CLUSTERED_MAX_RESOLUTION 1024
+
+struct SMclusterer;
+
+class SMreadClustered : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  const SMstats* get_stats() const;
+
+  // SMreadClustered functions
+
+  // the grid has 'resolution' cells along the longest side of the bounding
+  // box. 'memory' is the number of megabytes for the cells and triangles in
+  // memory. without a resolution it is chosen to fit the memory. a bounding
+  // box must be given if the smreader does not have one.
+
+  bool open(SMreader* smreader, int resolution, int memory=0, const float* bb_min=0, const float* bb_max=0);
+
+  SMreadClustered();
+  ~SMreadClustered();
+
+private:
+  SMreader* smreader;
+  bool eof;
+
+  int resolution;
+  int max_cells;
+  int max_waiting;
+  float cell_size;
+  float grid_min[3];
+  float grid_max[3];
+
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  SMclusterer* clusterer;
+
+  int read_input();
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+===============================================================================
+
+  FILE:  SMreadComponents.h
+
+  CONTENTS:
+
+    Reads a *pre-order* Streaming Mesh and labels its connected components
+    on the fly. The triangles are joined into components with a union-find
+    over the vertices in which the smaller component is always merged into
+    the larger one so that every vertex points directly to its component.
+    Only vertices that are not finalized are kept. A component is resolved
+    once all of its vertices are finalized because then no later triangle
+    can join it anymore.
+
+    The triangles of a component are held back until it is resolved. Then
+    the component gets the next label and its triangles are passed on, or
+    they are dropped if there are fewer than 'min_triangles' of them. This
+    way labels are stable and assigned in the order in which components
+    are resolved. A component that reaches 'min_triangles' is labeled right
+    away and its triangles are passed on from then on because it is known
+    to stay. If more than 'max_buffered' triangles are held back the largest
+    component that is held back is labeled early. When two components that
+    both have a label are joined later, the merged component continues with
+    the older label (this is counted as 'merged_labels').
+
+    The label of the current vertex or triangle is 'c_idx'. A vertex comes
+    right before the first triangle that uses it and has the label of that
+    triangle. 'c_last' marks the last triangle of a component and 'c_count'
+    is the number of labels given out so far. Vertices that are not used by
+    any triangle are dropped. The result is again a pre-order mesh.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- keeps the state of the labeling per reader rather than per thread
+    19 October 2026 -- created to split scans into their connected parts
+
+===============================================================================
+*/
+#ifndef SMREAD_COMPONENTS_H
+#define SMREAD_COMPONENTS_H
+
+#include "smreader.h"
+
+struct SMlabeler;
+
+class SMreadComponents : public SMreader
+{
+public:
+
+  // component variables
+
+  int c_idx;
+  bool c_last;
+  int c_count;
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  const SMstats* get_stats() const;
+
+  // SMreadComponents functions
+
+  bool open(SMreader* smreader, int min_triangles=0, int max_buffered=1000000);
+
+  SMreadComponents();
+  ~SMreadComponents();
+
+private:
+  SMreader* smreader;
+  bool eof;
+
+  int min_triangles;
+  int max_buffered;
+
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  SMlabeler* labeler;
+
+  int read_input();
+};
+
+#endif
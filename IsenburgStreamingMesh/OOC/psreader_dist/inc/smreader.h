@@ -21,6 +21,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- indices and counts are SMidx (64 bits with SM_64BIT_INDICES)
+    19 October 2026 -- added get_stats() for the runtime statistics
     17 January 2004 -- added virtual destructor to shut up the g++ compiler
     30 October 2003 -- switched to enums and bools in peter's office
     02 October 2003 -- added functionality for read_element() 
@@ -31,6 +33,10 @@
 #ifndef SMREADER_H
 #define SMREADER_H
 
+#include "smidx.h"
+
+class SMstats;
+
 // events 
 typedef enum {
   SM_ERROR = -1,
@@ -44,26 +50,26 @@ class SMreader
 {
 public:
   // vertex variables
-  int v_idx;
+  SMidx v_idx;
   float v_pos_f[3];
 
   // triangle variables
-  int t_idx[3];
+  SMidx t_idx[3];
   bool t_final[3];
 
   // finalized variables
-  int final_idx;
+  SMidx final_idx;
 
   // mesh variables
 
   int ncomments;
   char** comments;
 
-  int nverts;
-  int nfaces;
+  SMidx nverts;
+  SMidx nfaces;
 
-  int v_count;
-  int f_count;
+  SMidx v_count;
+  SMidx f_count;
 
   float* bb_min_f;
   float* bb_max_f;
@@ -77,6 +83,10 @@ public:
 
   virtual void close()=0;
 
+  // statistics (e.g. buffer sizes and operation counts). 0 if not collected
+
+  virtual const SMstats* get_stats() const { return 0; };
+
   virtual ~SMreader(){};
 };
 
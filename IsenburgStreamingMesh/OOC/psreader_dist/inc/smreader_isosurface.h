@@ -0,0 +1,122 @@
+/*
+===============================================================================
+
+  FILE:  SMreader_isosurface.h
+
+  CONTENTS:
+
+    Extracts an isosurface from a volume of nx x ny x nz samples with
+    marching cubes and streams it out as a pre-order Streaming Mesh while
+    it is extracted, so that even the isosurfaces of huge CT scans or
+    simulations never have to be held in memory.
+
+    The volume is raw samples (unsigned char, unsigned short, or float in
+    the byte order of the machine) with x varying fastest. It is read slab
+    by slab from a FILE or taken from memory (e.g. a file that the caller
+    has mapped), so only a few layers of nx x ny samples are held at any
+    time. The cells between layer k and k+1 form slab k. A sample that is
+    at least the iso value is inside. The triangles are oriented with their
+    normals pointing to the outside.
+
+    A vertex lies on a cell edge and is shared by all cells around it, also
+    across slabs. It is passed on right before its first triangle and is
+    finalized with its last triangle, which is in the slab above its layer
+    (or in the slab of its vertical edge). So the width of the stream is
+    about two layers of the surface.
+
+    How the 256 cases of the cubes are triangulated is derived from the
+    contours of the surface on the faces of the cube when the reader is
+    first opened. On a face with two opposite inside corners the corners
+    are separated, which is decided the same way by both cells that share
+    the face, so the surface has no cracks.
+
+    With set_threads() the slabs are extracted by that many threads in
+    parallel while they are passed on in order. Each thread works ahead on
+    up to two slabs.
+
+    The bounding box is that of the volume. nverts and nfaces are not
+    known up front.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to stream isosurfaces of volumes straight into compression
+
+===============================================================================
+*/
+#ifndef SMREADER_ISOSURFACE_H
+#define SMREADER_ISOSURFACE_H
+
+#include <stdio.h>
+
+#include "smreader.h"
+
+#define SM_ISO_UCHAR  0
+#define SM_ISO_USHORT 1
+#define SM_ISO_FLOAT  2
+
+struct SMisoVolume;
+struct SMisoSlab;
+
+class SMreader_isosurface : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  // smreader_isosurface functions
+
+  // the position of the first sample and the distances between samples
+  // (default 0 0 0 and 1 1 1)
+
+  void set_origin(const float* origin);
+  void set_spacing(const float* spacing);
+
+  // 0 extracts the slabs on the thread that reads (default)
+
+  void set_threads(int threads);
+
+  bool open(FILE* file, int type, int nx, int ny, int nz, float iso);
+  bool open(const void* samples, int type, int nx, int ny, int nz, float iso);
+
+  SMreader_isosurface();
+  ~SMreader_isosurface();
+
+private:
+  SMisoVolume* volume;
+  SMisoSlab* current;
+  int next_slab;
+  int next_triangle;
+  int next_corner;
+  SMidx* vertex_idx;
+  float origin[3];
+  float spacing[3];
+  float bb_min[3];
+  float bb_max[3];
+  int threads;
+
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  bool open(FILE* file, const void* samples, int type, int nx, int ny, int nz, float iso);
+  bool start_slab();
+  void end_slab();
+};
+
+#endif
@@ -22,6 +22,9 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- can read from memory
+    19 October 2026 -- line is read into a member buffer (no malloc / free)
     15 January 2005 -- fixed valerio's bug (annoying output for empty lines) 
     07 January 2004 -- closing no longer resets comments, nverts, nfaces, bb_min
                        and bb_max. values are still there when re-opening again.
@@ -36,6 +39,7 @@
 #define SMREADER_SMA_H
 
 #include "smreader.h"
+#include "smmemory.h"
 
 #include <stdio.h>
 
@@ -54,15 +58,26 @@ public:
 
   bool open(FILE* fp);
 
+  // reads the lines of an SMA file from memory. the bytes must stay around
+  // until close()
+
+  bool open(const void* bytes, size_t nbytes);
+
   SMreader_sma();
   ~SMreader_sma();
 
 private:
   FILE* file;
+  SMmemoryInput memory;
   int skipped_lines;
-  char* line;
+  char* line;        // points to line_buffer or is 0 at the end of file
+  char line_buffer[256];
   int have_finalized, next_finalized;
-  int finalized_vertices[3];
+  SMidx finalized_vertices[3];
+
+  inline char* get_line() { return (file ? fgets(line, sizeof(char) * 256, file) : memory.get_line(line, sizeof(char) * 256)); }
+
+  bool open_stream();
 };
 
 #endif
@@ -26,6 +26,13 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- reads the far corners that the writer escapes (see SMwriter_smb.h)
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- can read from memory and use its blocks in place
+    19 October 2026 -- can seek past the vertex positions for connectivity-only reading
+    19 October 2026 -- reads the SMB version with 64 bit counts (see SMwriter_smb.h)
+    19 October 2026 -- can tell and seek the blocks of 32 elements for SMindex
+    19 October 2026 -- read_buffer() is recorded as a span when tracing
     1 August 2004 -- initial version created outside at Weaver Street Market
   
 ===============================================================================
@@ -34,6 +41,8 @@
 #define SMREADER_SMB_H
 
 #include "smreader.h"
+#include "smindex.h"
+#include "smmemory.h"
 
 #include <stdio.h>
 
@@ -50,25 +59,53 @@ public:
 
   // smreader_sma functions
 
-  bool open(FILE* fp);
+  // with 'skip_geometry' the vertices are still reported but v_pos_f is not
+  // set. blocks of 32 vertices are seeked over instead of being read.
+
+  bool open(FILE* fp, bool skip_geometry=false);
+
+  // reads the bytes of an SMB file from memory. the elements are used where
+  // they are if they are aligned to 4 bytes, so the bytes must stay around
+  // until close()
+
+  bool open(const void* bytes, size_t nbytes, bool skip_geometry=false);
+
+  // the byte offset of the block of 32 elements that holds the next element.
+  // it is where the next element starts if v_count + f_count is a multiple
+  // of 32. seek_block() continues reading at such an offset as if v_count
+  // vertices and f_count triangles had been read.
+
+  SMoffset tell_block() const;
+  bool seek_block(SMoffset offset, SMidx v_count, SMidx f_count);
 
   SMreader_smb();
   ~SMreader_smb();
 
 private:
   FILE* file;
+  SMmemoryInput memory;
   int have_finalized, next_finalized;
-  int finalized_vertices[3];
+  SMidx finalized_vertices[3];
+
+  inline int get_byte() { return (file ? fgetc(file) : memory.get_byte()); }
+  inline int get(void* data, int size, int number) { return (int)(file ? fread(data, size, number, file) : memory.read(data, size, number)); }
 
-  void read_header();
+  bool open_stream();
+  bool read_header();
   void read_buffer();
 
   bool endian_swap;
+  bool index_64;
+  bool skip_geometry;
 
+  SMoffset block_offset;
   int element_number;
   int element_counter;
   unsigned int element_descriptor;
   int* element_buffer;
+  const int* elements;  // points to element_buffer or into the memory
+  int escape_counter;
+  SMidx* escape_buffer;
 };
 
 #endif
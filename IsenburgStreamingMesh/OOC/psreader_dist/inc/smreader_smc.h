@@ -22,6 +22,13 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- keeps the state of the decompressor per reader rather than per thread
+    19 October 2026 -- can decode the geometry sub-stream with a second thread
+    19 October 2026 -- can skip the geometry for connectivity-only reading
+    19 October 2026 -- reads the version with 64 bit counts (see SMwriter_smc.h)
+    19 October 2026 -- can decompress from memory and from several threads at once
+    19 October 2026 -- the PRINT_CONTROL_OUTPUT counters are runtime statistics
     26 May 2005 -- fixed a Microsoft bug (floating-point in Release/Debug mode)
     05 April 2005 -- finally renamed from SMreader_sme to SMreader_smc
     21 March 2005 -- read_element() calls after EOF will always return SM_EOF 
@@ -41,6 +48,9 @@
 
 #include <stdio.h>
 
+class RangeDecoder;
+struct SMCdecoder;
+
 class SMreader_smc : public SMreader
 {
 public:
@@ -54,17 +64,41 @@ public:
 
   void close();
 
+  const SMstats* get_stats() const;
+
   SMevent read_element();
   SMevent read_event();
 
   // smreader_smc functions
 
-  bool open(FILE* file);
+  // with 'skip_geometry' the vertices are still reported but without
+  // positions (v_pos_f and t_pos_f are not valid). if the geometry was
+  // written as a separate sub-stream (see SMwriter_smc.h) it is skipped
+  // without being decoded. otherwise it is still decoded, but quantized
+  // positions are neither predicted nor dequantized.
+
+  bool open(FILE* file, bool skip_geometry=false);
+
+  // the bytes must stay around until close()
+
+  bool open(const void* bytes, size_t nbytes, bool skip_geometry=false);
+
+  // called before open() this decodes the geometry sub-stream of a stream
+  // with sections (see SMwriter_smc.h) on a second thread while this one
+  // decodes the connectivity up to 2048 triangles ahead. t_pos_f then only
+  // stays valid until the next triangle. streams without sections and
+  // reading with 'skip_geometry' do not use the thread.
+
+  void set_geometry_thread(bool geometry_thread);
 
   SMreader_smc();
   ~SMreader_smc();
 
 private:
+  SMCdecoder* decoder;
+  bool open(RangeDecoder* rd, RangeDecoder* rd_geometry);
+  bool geometry_thread;
+
   int have_new, next_new;
   int new_vertices[3];
   int have_triangle;
@@ -73,6 +107,8 @@ private:
 
   void read_header();
   int decompress_triangle();
+  int next_triangle();
+  bool fill_block();
 };
 
 #endif
@@ -24,6 +24,10 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- can read from memory without copying the bytes
+    19 October 2026 -- can skip the geometry for connectivity-only reading
+    19 October 2026 -- the PRINT_CONTROL_OUTPUT counters are runtime statistics
     26 May 2005 -- fixed a Microsoft bug (floating-point in Release/Debug mode)
     21 March 2005 -- read_element() calls after EOF will always return SM_EOF 
     04 January 2005 -- created after returning on a red-eye from Calgary
@@ -37,6 +41,8 @@
 
 #include <stdio.h>
 
+class RangeDecoder;
+
 class SMreader_smd : public SMreader
 {
 public:
@@ -50,12 +56,24 @@ public:
 
   void close();
 
+  const SMstats* get_stats() const;
+
   SMevent read_element();
   SMevent read_event();
 
   // smreader_smx functions
 
-  bool open(FILE* file);
+  // with 'skip_geometry' the vertices are still reported but without
+  // positions (v_pos_f and t_pos_f are not valid). the geometry is still
+  // decoded because it is interleaved with the connectivity, but quantized
+  // positions are neither predicted nor dequantized.
+
+  bool open(FILE* file, bool skip_geometry=false);
+
+  // reads the bytes of an SMD file from memory without copying them. the
+  // bytes must stay around until close()
+
+  bool open(const void* bytes, size_t nbytes, bool skip_geometry=false);
 
   SMreader_smd();
   ~SMreader_smd();
@@ -67,6 +85,7 @@ private:
   int have_finalized, next_finalized;
   int finalized_vertices[3];
 
+  bool open(RangeDecoder* rd);
   void read_header();
   bool decompress_triangle();
   bool decompress_triangle_waiting();
@@ -0,0 +1,127 @@
+/*
+===============================================================================
+
+  FILE:  SMreader_synthetic.h
+
+  CONTENTS:
+
+    Generates a Streaming Mesh procedurally instead of reading it from disk.
+    This makes it possible to benchmark with meshes of any size (e.g. with a
+    billion triangles) and with a stream of any width.
+
+    The mesh is a width x height grid of quads (each split into two triangles)
+    that is streamed row by row. It is either a flat grid, a noisy terrain,
+    or a torus (that wraps in both directions so that the first row of
+    vertices stays in the stream until the very end). The width of the
+    stream is about the width of the grid.
+
+    Options (all reproducible from the seed):
+
+      post_order      vertices follow their last triangle (finalized) instead
+                      of preceeding their first triangle
+      border          fraction of quads left out (e.g. holes with a border)
+      nonmanifold     fraction of quads that get an extra 'fin' triangle on
+                      their diagonal (e.g. a non-manifold edge)
+
+    nverts and nfaces are only known up front when both fractions are zero.
+
+    The mesh can also be described by a string such as
+
+      "terrain,1024,500000,seed=7,border=0.01,nonmanifold=0.001,post"
+
+    so that command line tools can take it as an argument.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- initial version for benchmarking without sample files
+
+===============================================================================
+*/
+#ifndef SMREADER_SYNTHETIC_H
+#define SMREADER_SYNTHETIC_H
+
+#include "smreader.h"
+
+#define SM_SYNTHETIC_GRID    0
+#define SM_SYNTHETIC_TERRAIN 1
+#define SM_SYNTHETIC_TORUS   2
+
+typedef struct SMsyntheticEvent
+{
+  int type;
+  SMidx idx[3];
+  bool final[3];
+  float pos[3];
+} SMsyntheticEvent;
+
+class SMreader_synthetic : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  // smreader_synthetic functions
+
+  void set_seed(unsigned int seed);
+  void set_post_order(bool post_order);
+  void set_border_fraction(float border_fraction);
+  void set_nonmanifold_fraction(float nonmanifold_fraction);
+
+  bool open(int type, int width, int height);
+  bool open(const char* description);
+
+  SMreader_synthetic();
+  ~SMreader_synthetic();
+
+private:
+  int type;
+  int width, height;
+  int vcols, vrows;
+  unsigned int seed;
+  unsigned int border_threshold;
+  unsigned int nonmanifold_threshold;
+
+  int strip;
+  SMidx next_idx;
+  SMidx* row0_idx;
+  SMidx* row_idx[3];
+  SMidx* fin_idx[2];
+  int* bottom_rem;
+  int* top_rem;
+
+  SMsyntheticEvent* events;
+  int events_number;
+  int events_counter;
+
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  bool quad(int s, int c) const;
+  bool fin(int s, int c) const;
+  int uses(int r, int c, int s) const;
+  SMidx* indices(int r) const;
+  void init_rem(int s);
+  void position(int r, int c, float* pos) const;
+  void fin_position(int s, int c, float* pos) const;
+  int finalize_strip(int s, bool assign);
+  void generate_strip(int s);
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+===============================================================================
+
+  FILE:  SMreadIndexed.h
+
+  CONTENTS:
+
+    Reads the part of an SMB file that lies in a box of interest by seeking
+    only to those chunks of its sidecar index (.smi) whose bounding box
+    intersects the box (see SMindex.h). Of these chunks only the triangles
+    whose bounding box intersects the box are passed on, together with the
+    vertices they use. The positions of the vertices from earlier chunks
+    that a chunk uses come from the front that the index records, so no
+    chunk outside the box is ever read from the SMB file. The changes of
+    the front of every chunk before the last one of the query are read
+    from the index, and the vertices of the front are kept in memory just
+    like a reader of the whole SMB file would keep them. The result is a
+    pre-order mesh whose vertices are re-indexed in the order in which
+    they are passed on.
+
+    A vertex is finalized with its last triangle if that triangle is passed
+    on. Otherwise it is finalized with an SM_FINALIZED event before the
+    next chunk of the query once a chunk in between removes it from the
+    front, or after the last chunk of the query.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- follows the front of the index instead of live vertices
+    19 October 2026 -- keeps the state of the reader per reader rather than per thread
+    19 October 2026 -- created to cut regions out of scans with billions of triangles
+
+===============================================================================
+*/
+#ifndef SMREAD_INDEXED_H
+#define SMREAD_INDEXED_H
+
+#include <stdio.h>
+
+#include "smreader.h"
+#include "smreader_smb.h"
+#include "smindex.h"
+
+struct SMextractor;
+
+class SMreadIndexed : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  const SMstats* get_stats() const;
+
+  // SMreadIndexed functions
+
+  bool open(FILE* file_smb, FILE* file_smi, const float* roi_min, const float* roi_max);
+
+  SMreadIndexed();
+  ~SMreadIndexed();
+
+private:
+  SMreader_smb* smreader_smb;
+  SMindex* smindex;
+  float roi_min[3];
+  float roi_max[3];
+
+  int* selected;
+  int nselected;
+  int current;
+  bool chunk_open;
+  int elements_left;
+  int next_delta;
+
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  SMextractor* extractor;
+
+  bool start_chunk();
+  void end_query();
+};
+
+#endif
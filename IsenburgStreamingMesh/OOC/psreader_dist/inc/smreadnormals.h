@@ -0,0 +1,86 @@
+/*
+===============================================================================
+
+  FILE:  SMreadNormals.h
+
+  CONTENTS:
+
+    Reads a *pre-order* Streaming Mesh and adds a smooth normal to every
+    vertex. The normal of a vertex is the sum of the (unnormalized and thus
+    area-weighted) normals of all its triangles and therefore only known
+    once the vertex is finalized. So a vertex is only passed on when it is
+    finalized and a triangle is only passed on once all three of its
+    vertices were passed on. The result is again a pre-order mesh whose
+    vertices are re-indexed in the order they are passed on.
+
+    Triangles are passed on as soon as they are ready, which may change
+    their order. In return only the vertices and the triangles around the
+    unfinalized vertices are buffered, so the memory is bounded by the width
+    of the stream and not by its span.
+
+    Vertices that are not used by any triangle are passed on followed by an
+    SM_FINALIZED event. Normals of (near) zero length are left unnormalized.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- keeps the state of the filter per reader rather than per thread
+    19 October 2026 -- sums the normals in SSE registers like SMreadSmoothed does
+    19 October 2026 -- created to finally do what ps_normals only talks about
+
+===============================================================================
+*/
+#ifndef SMREAD_NORMALS_H
+#define SMREAD_NORMALS_H
+
+#include "smreader.h"
+
+struct SMnormalizer;
+
+class SMreadNormals : public SMreader
+{
+public:
+  // additional vertex variables
+  float v_nor_f[3];
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  const SMstats* get_stats() const;
+
+  // SMreadNormals functions
+
+  bool open(SMreader* smreader);
+
+  SMreadNormals();
+  ~SMreadNormals();
+
+private:
+  SMreader* smreader;
+  bool eof;
+
+  bool have_isolated;
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  SMnormalizer* normalizer;
+
+  int read_input();
+};
+
+#endif
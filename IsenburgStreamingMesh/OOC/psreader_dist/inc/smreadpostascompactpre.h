@@ -31,6 +31,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- no more malloc per vertex for the nodes of the hash
      6 January 2004 -- setting the 'limit_buffer_size' may fail ungraceful
     17 December 2003 -- completed three days after returning to LLNL.
     10 October 2003 -- initial version created once SM compression worked
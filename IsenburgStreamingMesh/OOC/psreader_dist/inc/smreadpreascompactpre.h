@@ -32,6 +32,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- no more malloc per vertex for the nodes of the hash
     13 January 2005 -- major bug fix for behaviour after smreader had SM_EOF
      6 January 2004 -- setting the 'limit_buffer_size' may fail ungraceful
     25 December 2003 -- realized that there might be a bug for 'preserve_order == false'
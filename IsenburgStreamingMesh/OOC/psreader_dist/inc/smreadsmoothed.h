@@ -0,0 +1,94 @@
+/*
+===============================================================================
+
+  FILE:  SMreadSmoothed.h
+
+  CONTENTS:
+
+    Reads a *pre-order* Streaming Mesh and smoothes it on the fly with k
+    iterations of Taubin's lambda/mu smoothing. Each iteration is a step
+    that moves every vertex by 'lambda' times its umbrella vector followed
+    by a step that moves it by 'mu' times its new umbrella vector, which
+    removes noise without shrinking the mesh. The umbrella vector points
+    from the vertex to the average of the corners of its triangles. Thus
+    neighbors are weighted by the number of triangles they share with it.
+
+    A vertex can do its step s once it is finalized (so that all of its
+    neighbors are known) and once all of its neighbors have done step s-1.
+    So a vertex is only passed on once all vertices in its 2k-ring are
+    finalized. Because a neighbor is never more than one step ahead or
+    behind each vertex keeps only its last two positions. A triangle is
+    passed on once all three of its vertices were passed on, which may
+    change the order of the triangles. The result is again a pre-order
+    mesh whose vertices are re-indexed in the order they are passed on.
+    The memory is bounded by the width of the stream times k. If the input
+    has a bounding box it is not passed on, because the mu steps can push
+    vertices out of it.
+
+    The umbrella vectors are summed in four-wide SSE registers where the
+    compiler supports them.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- keeps the state of the smoothing per reader rather than per thread
+    19 October 2026 -- passes on no bounding box rather than clamping to the one of the input
+    19 October 2026 -- created to denoise scans before they are compressed
+
+===============================================================================
+*/
+#ifndef SMREAD_SMOOTHED_H
+#define SMREAD_SMOOTHED_H
+
+#include "smreader.h"
+
+struct SMsmoother;
+
+class SMreadSmoothed : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  const SMstats* get_stats() const;
+
+  // SMreadSmoothed functions
+
+  bool open(SMreader* smreader, int iterations, float lambda=0.5f, float mu=-0.53f);
+
+  SMreadSmoothed();
+  ~SMreadSmoothed();
+
+private:
+  SMreader* smreader;
+  bool eof;
+
+  int steps;
+  float factors[2];
+
+  bool have_isolated;
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  SMsmoother* smoother;
+
+  int read_input();
+};
+
+#endif
@@ -0,0 +1,176 @@
+/*
+===============================================================================
+
+  FILE:  SMstats.h
+
+  CONTENTS:
+
+    Streaming Mesh Statistics
+
+    A small registry of named counters, levels, and histograms that the
+    readers, writers, and converters update while they stream. The values
+    are always collected (e.g. no recompile with PRINT_CONTROL_OUTPUT is
+    needed) and can be queried through get_stats() of the SMreader,
+    SMwriter, and PSreader interfaces or be dumped in JSON format.
+
+    a counter counts events (e.g. the number of 'start' operations).
+    a level is a current size that also remembers its maximum (e.g. the
+      number of vertices in the buffer and its high-water mark).
+    a histogram counts samples per bin. with SM_STATS_HISTOGRAM sample v
+      goes into bin v (clamped to the last bin). with SM_STATS_LOG2 sample
+      v goes into bin k such that 2^(k-1) <= v < 2^k (and zero into bin 0).
+
+    the values, maxima, and bins are 64 bit so that they do not overflow
+    for streams with billions of elements.
+
+    entries are registered once with add() that returns a handle. updating
+    an entry through its handle is a single array access and an increment.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- the values, maxima, and bins are 64 bit
+    19 October 2026 -- created to replace the PRINT_CONTROL_OUTPUT counters
+
+===============================================================================
+*/
+#ifndef SMSTATS_H
+#define SMSTATS_H
+
+#include <stdio.h>
+
+#define SM_STATS_COUNTER   0
+#define SM_STATS_LEVEL     1
+#define SM_STATS_HISTOGRAM 2
+#define SM_STATS_LOG2      3
+
+#define SM_STATS_MAX_BINS 65
+
+#if defined(_WIN32)
+typedef __int64 SMcount;
+#define SM_COUNT_FORMAT "%I64d"
+#else
+typedef long long SMcount;
+#define SM_COUNT_FORMAT "%lld"
+#endif
+
+typedef struct SMstat
+{
+  const char* name;
+  int type;
+  SMcount value;  // the count, the current level, or the number of samples
+  SMcount max;    // the maximal level or the largest sample
+  int nbins;
+  SMcount bins[SM_STATS_MAX_BINS];
+} SMstat;
+
+class SMstats
+{
+public:
+
+  // registry functions
+
+  int add(const char* name, int type=SM_STATS_COUNTER, int nbins=SM_STATS_MAX_BINS);
+  void reset();
+
+  // query functions
+
+  int size() const;
+  const SMstat* get(int i) const;
+  const SMstat* find(const char* name) const;
+
+  inline SMcount value(int h) const;
+  inline SMcount max(int h) const;
+
+  // update functions
+
+  inline void count(int h);
+  inline void count(int h, SMcount n);
+  inline void up(int h);
+  inline void down(int h);
+  inline void level(int h, SMcount v);
+  inline void sample(int h, SMcount v);
+
+  // output functions
+
+  bool write_json(FILE* file, int indent=0) const;
+
+  const char* name;
+
+  SMstats(const char* name);
+  ~SMstats();
+
+private:
+  SMstat* stats;
+  int nstats;
+  int stats_alloc;
+};
+
+inline SMcount SMstats::value(int h) const
+{
+  return stats[h].value;
+}
+
+inline SMcount SMstats::max(int h) const
+{
+  return stats[h].max;
+}
+
+inline void SMstats::count(int h)
+{
+  stats[h].value++;
+}
+
+inline void SMstats::count(int h, SMcount n)
+{
+  stats[h].value += n;
+}
+
+inline void SMstats::up(int h)
+{
+  stats[h].value++;
+  if (stats[h].value > stats[h].max) stats[h].max = stats[h].value;
+}
+
+inline void SMstats::down(int h)
+{
+  stats[h].value--;
+}
+
+inline void SMstats::level(int h, SMcount v)
+{
+  stats[h].value = v;
+  if (v > stats[h].max) stats[h].max = v;
+}
+
+inline void SMstats::sample(int h, SMcount v)
+{
+  SMstat* stat = &(stats[h]);
+  int bin;
+  if (stat->type == SM_STATS_LOG2)
+  {
+    bin = 0;
+    SMcount u = (v > 0 ? v : 0);
+    while (u) { u = u >> 1; bin++; }
+  }
+  else
+  {
+    bin = (v < 0 ? 0 : (v < stat->nbins ? (int)v : stat->nbins-1));
+  }
+  stat->bins[bin]++;
+  if (stat->value == 0 || v > stat->max) stat->max = v;
+  stat->value++;
+}
+
+#endif
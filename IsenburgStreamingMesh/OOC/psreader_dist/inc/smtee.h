@@ -0,0 +1,112 @@
+/*
+===============================================================================
+
+  FILE:  SMtee.h
+
+  CONTENTS:
+
+    Reads a Streaming Mesh once from any SMreader and passes every element
+    on to several sinks at the same time, so that e.g. an SMB, an SMC with
+    12 bits, and an SMC with 16 bits are derived from one decode of the
+    input. The SMtee is itself an SMreader that returns the elements of its
+    input, so whoever reads it sees the mesh as well.
+
+    A sink is either an SMwriter, which gets the header of the input when
+    it is added and then each element as it is read, or a consumer, which
+    is a function that reads the mesh from an SMreader of its own (e.g. to
+    gather statistics). An SMwriter is either written directly or, like a
+    consumer always is, on a worker thread of its own. Such a sink gets the
+    elements in blocks through a bounded queue. When all of its blocks are
+    full the SMtee waits until the sink has emptied one, so the slowest
+    sink sets the speed rather than the sum of all of them. An SMwriter
+    may be opened on one thread and written on a worker thread. Only the
+    SMwriter_smd keeps its state per process, so there can only be one of
+    them at a time.
+
+    The sinks must be added after open() and before the first element is
+    read. The elements are passed on as the input returns them with its
+    read_element(), which is how sm2sm copies a mesh. The vertices are
+    assumed to be indexed in the order in which they are read.
+
+    Closing the SMtee closes the input, waits for the worker threads, and
+    closes the SMwriters. A consumer that returns early does not hold up the
+    others, and if the SMtee is closed before the end of the input the
+    sinks see the end of the mesh there.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- SMwriter_smc can be written on a worker thread
+    19 October 2026 -- created to derive several outputs from one decode
+
+===============================================================================
+*/
+#ifndef SMTEE_H
+#define SMTEE_H
+
+#include "smreader.h"
+#include "smwriter.h"
+
+#define SM_TEE_MAX_SINKS 16
+
+// reads what it needs from 'smreader'. 'data' is whatever was given to
+// SMtee::add_consumer()
+
+typedef void (*SMconsumer)(SMreader* smreader, void* data);
+
+struct SMteeSink;
+
+class SMtee : public SMreader
+{
+public:
+
+  // smreader interface function implementations
+
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  // smtee functions
+
+  bool open(SMreader* smreader);
+
+  // with 'thread' the sink runs on its own thread and can be up to 'blocks'
+  // blocks of 'block_size' elements behind. returns the number of the sink
+  // or -1
+
+  int add_writer(SMwriter* smwriter, bool thread=false, int block_size=4096, int blocks=4);
+  int add_consumer(SMconsumer consumer, void* data, int block_size=4096, int blocks=4);
+
+  // how often the sink had all of its blocks full when the next element
+  // was passed on (also after close)
+
+  int get_waits(int sink) const;
+
+  SMtee();
+  ~SMtee();
+
+private:
+  SMreader* smreader;
+  SMteeSink* sinks;
+  int nsinks;
+  bool finished;
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  int add_sink(SMwriter* smwriter, SMconsumer consumer, void* data, bool thread, int block_size, int blocks);
+  void finish();
+};
+
+#endif
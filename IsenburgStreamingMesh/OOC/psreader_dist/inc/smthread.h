@@ -0,0 +1,127 @@
+/*
+===============================================================================
+
+  FILE:  SMthread.h
+
+  CONTENTS:
+
+    The counting semaphores and the threads that the threaded readers,
+    writers, and filters use to hand blocks of elements from one thread to
+    another. It wraps the Win32 API under _WIN32 and POSIX threads and
+    semaphores otherwise.
+
+    A bounded queue of blocks has a semaphore that counts the full blocks
+    and one that counts the empty blocks. The producer waits for an empty
+    block, fills it, and posts it as full. The consumer waits for a full
+    block, reads it, and posts it as empty. waitSemaphore() says whether it
+    had to wait, so that the waits can be counted in an SMstats.
+
+    A thread function is declared as 'static SM_THREAD_RESULT run(void* arg)'
+    and returns 0.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created from the copies in the threaded readers and writers
+
+===============================================================================
+*/
+#ifndef SM_THREAD_H
+#define SM_THREAD_H
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <semaphore.h>
+#endif
+
+#ifdef _WIN32
+typedef HANDLE SMsemaphore;
+typedef HANDLE SMthread;
+#define SM_THREAD_RESULT unsigned __stdcall
+typedef unsigned (__stdcall *SMthreadFunction)(void* arg);
+#else
+typedef sem_t SMsemaphore;
+typedef pthread_t SMthread;
+#define SM_THREAD_RESULT void*
+typedef void* (*SMthreadFunction)(void* arg);
+#endif
+
+inline void initSemaphore(SMsemaphore* semaphore, int value, int max)
+{
+#ifdef _WIN32
+  *semaphore = CreateSemaphore(0, value, max, 0);
+#else
+  (void)max; // only windows semaphores have a maximum
+  sem_init(semaphore, 0, value);
+#endif
+}
+
+inline void destroySemaphore(SMsemaphore* semaphore)
+{
+#ifdef _WIN32
+  CloseHandle(*semaphore);
+#else
+  sem_destroy(semaphore);
+#endif
+}
+
+inline void postSemaphore(SMsemaphore* semaphore)
+{
+#ifdef _WIN32
+  ReleaseSemaphore(*semaphore, 1, 0);
+#else
+  sem_post(semaphore);
+#endif
+}
+
+// returns whether it had to wait
+
+inline bool waitSemaphore(SMsemaphore* semaphore)
+{
+#ifdef _WIN32
+  if (WaitForSingleObject(*semaphore, 0) == WAIT_OBJECT_0) return false;
+  WaitForSingleObject(*semaphore, INFINITE);
+#else
+  if (sem_trywait(semaphore) == 0) return false;
+  while (sem_wait(semaphore) != 0);
+#endif
+  return true;
+}
+
+// returns whether the thread was started
+
+inline bool startThread(SMthread* thread, SMthreadFunction function, void* arg)
+{
+#ifdef _WIN32
+  *thread = (HANDLE)_beginthreadex(0, 0, function, arg, 0, 0);
+  return (*thread != 0);
+#else
+  return (pthread_create(thread, 0, function, arg) == 0);
+#endif
+}
+
+inline void joinThread(SMthread* thread)
+{
+#ifdef _WIN32
+  WaitForSingleObject(*thread, INFINITE);
+  CloseHandle(*thread);
+#else
+  pthread_join(*thread, 0);
+#endif
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+===============================================================================
+
+  FILE:  SMtrace.h
+
+  CONTENTS:
+
+    Streaming Mesh Tracing
+
+    Records begin/end spans of the expensive stages of a streaming pipeline
+    (e.g. refilling the input buffer of SMreader_smb, refilling the output
+    buffer of PSconverter, rescaling a RangeModel, resizing a vertex hash)
+    and writes them as a Chrome trace (JSON) that can be loaded into
+    chrome://tracing or ui.perfetto.dev.
+
+    tracing is off until sm_trace_open() is called. while it is off every
+    SM_TRACE_BEGIN / SM_TRACE_END costs a single test of a global flag. while
+    it is on every thread records its spans into its own ring buffer (so no
+    locking is needed) that keeps the most recent 'events_per_thread' events.
+    sm_trace_close() turns tracing off and writes all ring buffers to file.
+    it should only be called once the other threads have stopped streaming.
+
+    example:
+
+      sm_trace_open("trace.json");
+      ... smreader->open() ... read_element() ... smreader->close();
+      sm_trace_close();
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to find out where the time goes in deep pipelines
+
+===============================================================================
+*/
+#ifndef SMTRACE_H
+#define SMTRACE_H
+
+extern volatile bool sm_trace_on;
+
+bool sm_trace_open(const char* file_name, int events_per_thread=65536);
+bool sm_trace_close();
+
+void sm_trace_begin(const char* name, const char* cat);
+void sm_trace_end(const char* name, const char* cat);
+
+#define SM_TRACE_BEGIN(name, cat) do { if (sm_trace_on) sm_trace_begin(name, cat); } while (0)
+#define SM_TRACE_END(name, cat) do { if (sm_trace_on) sm_trace_end(name, cat); } while (0)
+
+// inserts into a hash_map and records a span if this insert resizes the table
+
+template <class H, class V>
+inline void sm_trace_hash_insert(H* hash, const V& value, const char* name)
+{
+  if (sm_trace_on && hash->size() >= hash->bucket_count())
+  {
+    sm_trace_begin(name, "hash");
+    hash->insert(value);
+    sm_trace_end(name, "hash");
+  }
+  else
+  {
+    hash->insert(value);
+  }
+}
+
+#endif
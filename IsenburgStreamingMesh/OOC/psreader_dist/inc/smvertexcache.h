@@ -0,0 +1,172 @@
+/*
+===============================================================================
+
+  FILE:  SMvertexCache.h
+
+  CONTENTS:
+
+    Simulates the post-transform vertex cache of a GPU that renders the
+    triangles of a Streaming Mesh in the order in which they come. The cache
+    holds the 'size' most recent vertex indices and is either a FIFO, where
+    a hit does not change the order, or an LRU, where a hit moves the vertex
+    to the front. Position 0 is the front of the cache.
+
+    Every vertex of a triangle is looked up in turn with access(). A miss
+    counts as one run of the vertex shader, so the average cache miss ratio
+    (ACMR) is misses per triangle and the average transform to vertex ratio
+    (ATVR) is misses per vertex. The optimal ATVR is 1.0.
+
+    A pointer can be stored with each index so that a re-orderer can find
+    the triangles around the cached vertices. forget() clears that pointer
+    once the vertex is gone without changing what the cache holds.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- counts the accesses and misses with 64 bits
+    19 October 2026 -- the cached vertex indices are SMidx
+    19 October 2026 -- created to re-order streams for GPU index buffers
+
+===============================================================================
+*/
+#ifndef SM_VERTEX_CACHE_H
+#define SM_VERTEX_CACHE_H
+
+#include <string.h>
+
+#include "smidx.h"
+#include "smstats.h"
+
+// the cache models that SMwriteBuffered can re-order for. the little cache
+// is its original heuristic that looks at the last triangle only. forsyth
+// scores the vertices of an LRU cache like Tom Forsyth's "Linear-Speed
+// Vertex Cache Optimisation".
+
+#define SM_CACHE_LITTLE   0
+#define SM_CACHE_FIFO     1
+#define SM_CACHE_LRU      2
+#define SM_CACHE_FORSYTH  3
+
+#define SM_CACHE_MAX_SIZE 64
+
+class SMvertexCache
+{
+public:
+  SMvertexCache();
+  ~SMvertexCache();
+
+  inline bool init(int type, int size);
+  inline void reset();
+
+  inline bool access(SMidx i, void* d=0);
+  inline void forget(SMidx i);
+
+  inline int pos(SMidx i) const;
+  inline void* get(int p) const;
+  inline int elements() const;
+
+  int type;
+  int size;
+  SMcount accesses;
+  SMcount misses;
+
+private:
+  int number;
+  SMidx index[SM_CACHE_MAX_SIZE];
+  void* data[SM_CACHE_MAX_SIZE];
+};
+
+inline SMvertexCache::SMvertexCache()
+{
+  type = SM_CACHE_FIFO;
+  size = 16;
+  reset();
+}
+
+inline SMvertexCache::~SMvertexCache()
+{
+}
+
+inline bool SMvertexCache::init(int type, int size)
+{
+  if (size < 3 || size > SM_CACHE_MAX_SIZE)
+  {
+    return false;
+  }
+  this->type = (type == SM_CACHE_LRU || type == SM_CACHE_FORSYTH ? SM_CACHE_LRU : SM_CACHE_FIFO);
+  this->size = size;
+  reset();
+  return true;
+}
+
+inline void SMvertexCache::reset()
+{
+  number = 0;
+  accesses = 0;
+  misses = 0;
+}
+
+// returns true for a cache hit
+
+inline bool SMvertexCache::access(SMidx i, void* d)
+{
+  int p = pos(i);
+  bool hit = (p != -1);
+  accesses++;
+  if (!hit)
+  {
+    // the last entry falls out
+    misses++;
+    if (number < size) number++;
+    p = number - 1;
+  }
+  else if (type == SM_CACHE_FIFO)
+  {
+    data[p] = d;
+    return true;
+  }
+  // move the entries before p back by one and put i in front
+  memmove(&(index[1]), &(index[0]), sizeof(SMidx)*p);
+  memmove(&(data[1]), &(data[0]), sizeof(void*)*p);
+  index[0] = i;
+  data[0] = d;
+  return hit;
+}
+
+inline void SMvertexCache::forget(SMidx i)
+{
+  int p = pos(i);
+  if (p != -1) data[p] = 0;
+}
+
+inline int SMvertexCache::pos(SMidx i) const
+{
+  for (int p = 0; p < number; p++)
+  {
+    if (index[p] == i) return p;
+  }
+  return -1;
+}
+
+inline void* SMvertexCache::get(int p) const
+{
+  return data[p];
+}
+
+inline int SMvertexCache::elements() const
+{
+  return number;
+}
+
+#endif
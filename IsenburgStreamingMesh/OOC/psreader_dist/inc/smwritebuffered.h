@@ -8,6 +8,16 @@
     Writes a Streaming Mesh with a "little-cache" aware greedy reordering of
     triangles that is subject to a constraint of maximal delay of triangles.
 
+    Instead of the little cache the reordering can aim at a post-transform
+    vertex cache of a GPU with 'cache_size' entries (see SMvertexCache.h).
+    For a FIFO or an LRU cache it picks among the buffered triangles around
+    the cached vertices the one with the most hits, preferring those that
+    finalize vertices and then those that use the oldest entries before they
+    fall out. With Forsyth's scoring it picks the triangle whose vertices
+    have the highest sum of a score for their position in an LRU cache and
+    a boost for having few triangles left. Whatever the model, the misses of
+    a cache of that size (a FIFO for the little cache) are counted.
+
   PROGRAMMERS:
   
     martin isenburg@cs.unc.edu
@@ -22,6 +32,11 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- keeps the state of the re-ordering per writer rather than per thread
+    19 October 2026 -- re-orders for FIFO, LRU, or Forsyth-scored GPU caches
+    19 October 2026 -- several threads can re-order their own meshes at once
+    19 October 2026 -- the PRINT_CONTROL_OUTPUT counters are runtime statistics
+    19 October 2026 -- no more malloc per vertex for the nodes of the hash
     15 January 2005 -- radically simplified and improved
     16 December 2004 -- initial version created once all other crap was done
   
@@ -31,6 +46,9 @@
 #define SMWRITE_BUFFERED_H
 
 #include "smwriter.h"
+#include "smvertexcache.h"
+
+struct SMreorder;
 
 class SMwriteBuffered : public SMwriter
 {
@@ -39,27 +57,31 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
+  const SMstats* get_stats() const;
+
   // smwriter_smc functions
 
-  bool open(SMwriter* smwriter, int max_delay=100);
+  bool open(SMwriter* smwriter, int max_delay=100, int cache_type=SM_CACHE_LITTLE, int cache_size=16);
 
   SMwriteBuffered();
   ~SMwriteBuffered();
 
 private:
+  SMreorder* reorder;
   SMwriter* smwriter;
   int max_delay;
+  int cache_type;
 
   void write_triangle_delayed();
 };
@@ -0,0 +1,77 @@
+/*
+===============================================================================
+
+  FILE:  SMwriteIndexed.h
+
+  CONTENTS:
+
+    Writes a Streaming Mesh in SMB and at the same time builds the sidecar
+    index (.smi) that lets SMreadIndexed extract a region of interest from
+    it by seeking only to the chunks that intersect the region. Because the
+    SMB writer buffers a block of 32 elements before it writes them, the
+    byte offset of a chunk is taken from the SMB file right after its first
+    element was written. The SMB writer must therefore write to 'file_smb'
+    and nothing else may write to this file at the same time.
+
+    The SMB format does not support write_finalized() and neither does this
+    writer. Compressed formats such as SMC cannot be indexed because their
+    decoder can only start at the beginning of the stream.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to cut regions out of scans with billions of triangles
+
+===============================================================================
+*/
+#ifndef SMWRITE_INDEXED_H
+#define SMWRITE_INDEXED_H
+
+#include <stdio.h>
+
+#include "smwriter_smb.h"
+#include "smindex.h"
+
+class SMwriteIndexed : public SMwriter
+{
+public:
+  // smwriter interface function implementations
+
+  void add_comment(const char* comment);
+
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
+  void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
+
+  void write_vertex(const float* v_pos_f);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
+
+  void close();
+
+  // SMwriteIndexed functions
+
+  bool open(SMwriter_smb* smwriter_smb, FILE* file_smb, FILE* file_smi, int chunk_size=65536);
+
+  SMwriteIndexed();
+  ~SMwriteIndexed();
+
+private:
+  SMwriter_smb* smwriter_smb;
+  FILE* file_smb;
+  SMindex* smindex;
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*
+===============================================================================
+
+  FILE:  SMwriteLOD.h
+
+  CONTENTS:
+
+    Writes a *pre-order* Streaming Mesh as a pyramid of levels of detail in
+    a single pass. Level 0 is the mesh simplified with vertex clustering on
+    a grid with 'resolution' cells along the longest side of the bounding
+    box. Every further level clusters the output of the level before it on
+    a grid that is twice as coarse. Because the cells of all grids are cubes
+    with the same origin the cells of one level nest in those of the next.
+
+    Each level runs on its own worker thread and writes to its own smwriter
+    while it streams. The levels are connected by bounded queues of blocks
+    of events, so the memory stays bounded by the width of the stream and a
+    slow level holds back the levels before it instead of buffering all of
+    their output. The whole pyramid costs one read of the input.
+
+    The bounding box must be set before the first vertex is written. The
+    smwriters of the levels are opened by the caller, used by the worker
+    threads, and closed by close(). They are not deleted.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- writes the levels to smwriters rather than to files
+    19 October 2026 -- created to build the previews of a mesh in one pass
+
+===============================================================================
+*/
+#ifndef SMWRITE_LOD_H
+#define SMWRITE_LOD_H
+
+#include <stdio.h>
+
+#include "smwriter.h"
+
+#define SM_LOD_MAX_LEVELS 8
+
+struct SMlodLevel;
+
+class SMwriteLOD : public SMwriter
+{
+public:
+  // smwriter interface function implementations
+
+  void add_comment(const char* comment);
+
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
+  void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
+
+  void write_vertex(const float* v_pos_f);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
+
+  void close();
+
+  const SMstats* get_stats() const;
+
+  // SMwriteLOD functions
+
+  // smwriters[l] receives level l, which is clustered on a grid with
+  // 'resolution' >> l cells along the longest side of the bounding box.
+  // any smwriter will do (e.g. an SMwriter_smc with its own precision).
+
+  bool open(int levels, SMwriter** smwriters, int resolution=512);
+
+  SMwriteLOD();
+  ~SMwriteLOD();
+
+private:
+  int levels;
+  int resolution;
+  SMlodLevel* lod_levels;
+  int threads;
+  bool started;
+  bool failed;
+
+  // the waits count how often a producer found all blocks of a queue full
+  SMstats* stats;
+  int stat_input_waits;
+  int stat_vertices[SM_LOD_MAX_LEVELS];
+  int stat_triangles[SM_LOD_MAX_LEVELS];
+  int stat_waits[SM_LOD_MAX_LEVELS];
+
+  bool start();
+};
+
+#endif
@@ -21,6 +21,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- indices and counts are SMidx (64 bits with SM_64BIT_INDICES)
+    19 October 2026 -- added get_stats() for the runtime statistics
     17 January 2004 -- added virtual destructor to shut up the g++ compiler
     15 September 2003 -- initial version created on the Monday after a tough
                          hiking weekend in Yosemite
@@ -30,6 +32,10 @@
 #ifndef SMWRITER_H
 #define SMWRITER_H
 
+#include "smidx.h"
+
+class SMstats;
+
 class SMwriter
 {
 public:
@@ -39,11 +45,11 @@ public:
   int ncomments;
   char** comments;
 
-  int nverts;
-  int nfaces;
+  SMidx nverts;
+  SMidx nfaces;
 
-  int v_count;
-  int f_count;
+  SMidx v_count;
+  SMidx f_count;
 
   float* bb_min_f;
   float* bb_max_f;
@@ -52,17 +58,21 @@ public:
 
   virtual void add_comment(const char* comment)=0;
 
-  virtual void set_nverts(int nverts)=0;
-  virtual void set_nfaces(int nfaces)=0;
+  virtual void set_nverts(SMidx nverts)=0;
+  virtual void set_nfaces(SMidx nfaces)=0;
   virtual void set_boundingbox(const float* bb_min_f, const float* bb_max_f)=0;
 
   virtual void write_vertex(const float* v_pos_f)=0;
-  virtual void write_triangle(const int* t_idx, const bool* t_final)=0;
-  virtual void write_triangle(const int* t_idx)=0;
-  virtual void write_finalized(int final_idx)=0;
+  virtual void write_triangle(const SMidx* t_idx, const bool* t_final)=0;
+  virtual void write_triangle(const SMidx* t_idx)=0;
+  virtual void write_finalized(SMidx final_idx)=0;
 
   virtual void close()=0;
 
+  // statistics (e.g. buffer sizes and operation counts). 0 if not collected
+
+  virtual const SMstats* get_stats() const { return 0; };
+
   virtual ~SMwriter(){};
 };
 
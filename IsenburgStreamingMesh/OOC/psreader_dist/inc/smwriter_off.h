@@ -23,6 +23,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- buffers the triangles with SMidx indices
+    19 October 2026 -- fixed sizeof(float) in the realloc of the triangle buffer
     02 May 2005 -- for creating OFF models for Ioannis and our SCCG paper
   
 ===============================================================================
@@ -42,14 +44,14 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
@@ -63,10 +65,10 @@ public:
 private:
   FILE* file;
   void write_header();
-  int vertex_buffer_alloc;
+  SMidx vertex_buffer_alloc;
   float* vertex_buffer;
-  int triangle_buffer_alloc;
-  int* triangle_buffer;
+  SMidx triangle_buffer_alloc;
+  SMidx* triangle_buffer;
 };
 
 #endif
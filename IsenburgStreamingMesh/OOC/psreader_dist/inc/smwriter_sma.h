@@ -26,6 +26,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- can write into memory (see SMmemory.h)
     02 October 2003 -- initial version created on the Thursday that Germany
                        beat Russia 7:1 in the Women Soccer Worlcup
   
@@ -35,6 +37,7 @@
 #define SMWRITER_SMA_H
 
 #include "smwriter.h"
+#include "smmemory.h"
 
 #include <stdio.h>
 
@@ -46,14 +49,14 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
@@ -61,11 +64,20 @@ public:
 
   bool open(FILE* file);
 
+  // writes into memory like SMwriter_smc::open() does
+
+  bool open(unsigned char** bytes, size_t* nbytes);
+  bool open(void* bytes, size_t nalloc, size_t* nbytes);
+  bool open(unsigned char** bytes, int* nbytes);
+  bool open(unsigned char* bytes, int nalloc, int* nbytes);
+
   SMwriter_sma();
   ~SMwriter_sma();
 
 private:
   FILE* file;
+  SMmemoryOutput memory;
+  void output(const char* format, ...);
   void write_header();
 };
 
@@ -12,6 +12,15 @@
     mesh elements and the rotation of the triangles. But this is not yet
     implemented.
 
+    Compiled with SM_64BIT_INDICES it writes streams that have (or may have)
+    more than 2^31 vertices or triangles in the SMB version with 64 bit
+    counts. It stores each triangle corner relative to the last vertex as
+    twice the distance plus the finalization bit. These still take 32 bits.
+    A corner that is 2^30 or more vertices away is stored as an escape code
+    and twice its index plus the finalization bit follow the block of 32
+    elements as a 64 bit number (in the order of the corners). A last block
+    with such corners is filled up with padding elements to a full block.
+
   PROGRAMMERS:
   
     martin isenburg@cs.unc.edu
@@ -26,6 +35,11 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- corners far from the last vertex are escaped rather than rejected
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- can write into memory (see SMmemory.h)
+    19 October 2026 -- writes the SMB version with 64 bit counts when needed
+    19 October 2026 -- write_buffer() is recorded as a span when tracing
     31 July 2004 -- initial version created after a missed Sushi dinner
   
 ===============================================================================
@@ -34,6 +48,7 @@
 #define SMWRITER_SMB_H
 
 #include "smwriter.h"
+#include "smmemory.h"
 
 #include <stdio.h>
 
@@ -45,14 +60,14 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
@@ -62,21 +77,35 @@ public:
 
   bool open(FILE* file);
 
+  // writes into memory like SMwriter_smc::open() does
+
+  bool open(unsigned char** bytes, size_t* nbytes);
+  bool open(void* bytes, size_t nalloc, size_t* nbytes);
+  bool open(unsigned char** bytes, int* nbytes);
+  bool open(unsigned char* bytes, int nalloc, int* nbytes);
+
   SMwriter_smb();
   ~SMwriter_smb();
 
 private:
   FILE* file;
+  SMmemoryOutput memory;
+
+  inline void put_byte(int c) { if (file) fputc(c, file); else memory.put_byte(c); }
+  inline void put(const void* data, int size, int number) { if (file) fwrite(data, size, number, file); else memory.write(data, size*number); }
 
   void write_header();
   void write_buffer();
   void write_buffer_remaining();
 
   bool endian_swap;
+  bool index_64;
 
   int element_number;
   unsigned int element_descriptor;
   int* element_buffer;
+  int escape_number;
+  SMidx* escape_buffer;
 };
 
 #endif
@@ -22,6 +22,15 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- keeps the state of the compressor per writer rather than per thread
+    19 October 2026 -- can compress into a buffer of the caller without copying the bytes
+    19 October 2026 -- can write the geometry in a separate sub-stream cut into sections
+    19 October 2026 -- writes a version with 64 bit counts when needed (see SMwriter_smb.h)
+    19 October 2026 -- the index map can be a ring for streams of any length
+    19 October 2026 -- can compress into memory and from several threads at once
+    19 October 2026 -- the PRINT_CONTROL_OUTPUT counters are runtime statistics
+    19 October 2026 -- the vertex hash takes its nodes from a pool allocator
     26 May 2005 -- fixed a Microsoft bug (floating-point in Release/Debug mode)
     05 April 2005 -- finally renamed from SMwriter_sme to SMwriter_smc
     04 April 2005 -- fixed mean SMC_END bug after SM paper was rejected ... again 
@@ -43,6 +52,8 @@
 
 #include <stdio.h>
 
+struct SMCencoder;
+
 class SMwriter_smc : public SMwriter
 {
 public:
@@ -53,25 +64,57 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
+  const SMstats* get_stats() const;
+
   // smwriter_smc functions
 
-  bool open(FILE* fd, int bits=16);
+  // with a 'section_size' the connectivity and the geometry are coded into
+  // two separate sub-streams that are cut into sections of that many
+  // triangles. each section stores the number of connectivity and geometry
+  // bytes in front of them, so that a reader can skip the geometry without
+  // decoding it (see SMreader_smc::open()). this costs a few bytes per
+  // section. without it the layout is the classic single stream.
+
+  bool open(FILE* fd, int bits=16, int section_size=0);
+
+  // compresses into memory. the bytes are those that an SMC file would
+  // have. with the first they go into a buffer that grows as needed and
+  // that close() hands over in *bytes (to be freed by the caller) with its
+  // size in *nbytes. with the second they go into the 'nalloc' bytes of the
+  // caller and close() puts the size into *nbytes. if that is more than
+  // 'nalloc' the bytes did not fit (see SMmemory.h). the sizes can be
+  // size_t or int.
+
+  bool open(unsigned char** bytes, size_t* nbytes, int bits=16, int section_size=0);
+  bool open(void* bytes, size_t nalloc, size_t* nbytes, int bits=16, int section_size=0);
+  bool open(unsigned char** bytes, int* nbytes, int bits=16, int section_size=0);
+  bool open(unsigned char* bytes, int nalloc, int* nbytes, int bits=16, int section_size=0);
+
+  // the decoder numbers the vertices in the order it first meets them, which
+  // is not always the order they were written in. after close() the index
+  // the decoder gives to the i-th written vertex is in index_map[i]. with a
+  // size the map is a ring and the index is in index_map[i % size] from the
+  // moment the first triangle that uses the vertex was written until size
+  // more vertices were met.
+
+  void set_index_map(SMidx* index_map, int size=0);
 
   SMwriter_smc();
   ~SMwriter_smc();
 
 private:
+  SMCencoder* encoder;
   void write_header();
 };
 
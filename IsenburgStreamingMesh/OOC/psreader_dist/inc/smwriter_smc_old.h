@@ -22,6 +22,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- refuses meshes with more than 2^31 vertices or triangles
+    19 October 2026 -- the vertex hash takes its nodes from a pool allocator
     05 April 2005 -- slowly removing support for the old SMC reader and writer
     3 January 2004 -- added support for pre-existing bounding box info
     28 October 2003 -- switched from Peter's hash to the STL hash_map
@@ -45,14 +47,14 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
@@ -28,6 +28,11 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the size of the memory can be a size_t
+    19 October 2026 -- can compress into memory (see SMmemory.h)
+    19 October 2026 -- refuses meshes with more than 2^31 vertices or triangles
+    19 October 2026 -- the PRINT_CONTROL_OUTPUT counters are runtime statistics
+    19 October 2026 -- the vertex hash takes its nodes from a pool allocator
     26 May 2005 -- fixed a Microsoft bug (floating-point in Release/Debug mode)
     16 January 2005 -- added the adaptive delay based on the current width
     27 December 2004 -- initial version after experimenting all christmas long
@@ -52,21 +57,30 @@ public:
 
   void add_comment(const char* comment);
 
-  void set_nverts(int nverts);
-  void set_nfaces(int nfaces);
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
   void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
 
   void write_vertex(const float* v_pos_f);
-  void write_triangle(const int* t_idx, const bool* t_final);
-  void write_triangle(const int* t_idx);
-  void write_finalized(int final_idx);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
 
   void close();
 
+  const SMstats* get_stats() const;
+
   // smwriter_smd functions
 
   bool open(FILE* fd, int bits=16, int delay=-3);
 
+  // compresses into memory like SMwriter_smc::open() does
+
+  bool open(unsigned char** bytes, size_t* nbytes, int bits=16, int delay=-3);
+  bool open(void* bytes, size_t nalloc, size_t* nbytes, int bits=16, int delay=-3);
+  bool open(unsigned char** bytes, int* nbytes, int bits=16, int delay=-3);
+  bool open(unsigned char* bytes, int nalloc, int* nbytes, int bits=16, int delay=-3);
+
   SMwriter_smd();
   ~SMwriter_smd();
 
@@ -2,54 +2,168 @@
 ===============================================================================
 
   FILE:  crazyvector_for_pointers.h
-  
+
   CONTENTS:
-  
+
     Triangle Strip Compression - GI 2000 demonstration software
-  
+
+    a circular vector of pointers whose elements are removed lazily. it is
+    templated on the element type so that all operations can be inlined and
+    the callers do not need to cast.
+
   PROGRAMMERS:
-  
+
     Martin Isenburg@cs.unc.edu
-  
+
   COPYRIGHT:
-  
+
     Copyright (C) 2000  Martin Isenburg (isenburg@cs.unc.edu)
-    
+
     This software is distributed in the hope that it will be useful,
     but WITHOUT ANY WARRANTY; without even the implied warranty of
     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
-  
+
   CHANGE HISTORY:
-  
+
+    19 October 2026 -- templated on element type, now inlined
     19 January 2003 -- Martin - finalized for SIGGRAPH 03 submission.
                               - soon to go completely insane
-  
+
 ===============================================================================
 */
 #ifndef CRAZY_VECTOR_FOR_POINTERS_H
 #define CRAZY_VECTOR_FOR_POINTERS_H
 
+#include <stdlib.h>
+#include <string.h>
+
+template <class T>
 class CrazyVector
 {
 public:
   CrazyVector();
   ~CrazyVector();
 
-  int size() const;
-  void* elementAt(int i) const;
-  void* firstElement() const;
-  void addElement(const void* d);
-  void lazyRemoveElementAt(int i);
-  void removeFirstElement();
+  inline int size() const;
+  inline T* elementAt(int i) const;
+  inline T* firstElement() const;
+  inline void addElement(T* d);
+  inline void lazyRemoveElementAt(int i);
+  inline void removeFirstElement();
 
   // should be private
-  
-  const void** data;
+
+  T** data;
   int current_capacity;
   int current_capacity_mask;
   int current_begin;
   int current_end;
   int current_size;
+
+  void grow();
 };
 
+template <class T>
+CrazyVector<T>::CrazyVector()
+{
+  current_capacity = 1024;
+  current_capacity_mask = current_capacity-1;
+  data = (T**) malloc(sizeof(T*)*current_capacity);
+  current_size = 0;
+  current_begin = 0;
+  current_end = 0;
+}
+
+template <class T>
+CrazyVector<T>::~CrazyVector()
+{
+  free(data);
+}
+
+template <class T>
+inline int CrazyVector<T>::size() const
+{
+  return current_size;
+}
+
+template <class T>
+inline T* CrazyVector<T>::elementAt(int i) const
+{
+  return data[((i + current_begin) & current_capacity_mask)];
+}
+
+template <class T>
+inline T* CrazyVector<T>::firstElement() const
+{
+  return data[current_begin];
+}
+
+template <class T>
+inline void CrazyVector<T>::addElement(T* d)
+{
+  if (current_size == current_capacity)
+  {
+    grow();
+  }
+  data[current_end] = d;
+  current_end = (current_end + 1) & current_capacity_mask;
+  current_size++;
+}
+
+template <class T>
+inline void CrazyVector<T>::lazyRemoveElementAt(int i)
+{
+  int ri = (i + current_begin)&current_capacity_mask;
+  if (i == 0)
+  {
+    ri = (ri+1)&current_capacity_mask;
+    current_size--;
+    while ((data[ri] == 0) && current_size)
+    {
+      ri = (ri+1)&current_capacity_mask;
+      current_size--;
+    }
+    current_begin = ri;
+  }
+  else
+  {
+    data[ri] = 0;
+  }
+}
+
+template <class T>
+inline void CrazyVector<T>::removeFirstElement()
+{
+  int i = (current_begin+1)&current_capacity_mask;
+  current_size--;
+  while ((data[i] == 0) && current_size)
+  {
+    i = (i+1)&current_capacity_mask;
+    current_size--;
+  }
+  current_begin = i;
+}
+
+template <class T>
+void CrazyVector<T>::grow()
+{
+  T** temp = (T**) malloc(sizeof(T*)*current_capacity*2);
+  if (current_begin < current_end)
+  {
+    memcpy(temp, &(data[current_begin]), sizeof(T*)*current_size);
+  }
+  else
+  {
+    int rest = current_size-current_begin;
+    memcpy(temp, &(data[current_begin]), sizeof(T*)*rest);
+    memcpy(&(temp[rest]), data, sizeof(T*)*(current_size-rest));
+  }
+  free(data);
+  data = temp;
+  current_begin = 0;
+  current_end = current_size;
+  current_capacity = current_capacity * 2;
+  current_capacity_mask = current_capacity - 1;
+}
+
 #endif
@@ -13,10 +13,11 @@
     actually kept elements if the front elements are never removed, but many
     elements are added and only elements in the middle are deleted.
 
-    the elements are expected to provide a field in which their index within the
-    dynamic queue can be stored. therefore elements are only stored by references
-    (e.g. not by value) in the dynamicqueue. therefore the queue does exclusively
-    operate on void* pointers elements.
+    the elements are expected to provide an int field in which their index
+    within the dynamic queue can be stored. therefore elements are only stored
+    by references (e.g. not by value) in the dynamicqueue. the queue is
+    templated on the element type and on that field (e.g. DynamicQueue<SMedge,
+    &SMedge::dynamicqueue>) so that all operations can be inlined.
 
   PROGRAMMERS:
 
@@ -32,6 +33,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- templated on element type and index field, now inlined
     10 January 2004 -- created after watching 'american sweethearts' with shengi
 
 ===============================================================================
@@ -39,22 +41,28 @@
 #ifndef DYNAMIC_QUEUE_H
 #define DYNAMIC_QUEUE_H
 
+#include <stdlib.h>
+#include <string.h>
+
+template <class T, int T::*index>
 class DynamicQueue
 {
 public:
   DynamicQueue();
   ~DynamicQueue();
 
-  int size() const;
-  int elements() const;
-  void* getFirstElement() const;
-  void* getAndRemoveFirstElement();
-  void addElement(void* d);
-  void removeElement(const void* d);
-  void removeFirstElement();
+  inline int size() const;
+  inline int elements() const;
+  inline T* getFirstElement() const;
+  inline T* getAndRemoveFirstElement();
+  inline void addElement(T* d);
+  inline void removeElement(const T* d);
+  inline void removeFirstElement();
+
+private:
+  void grow();
 
-private:  
-  void** data;
+  T** data;
   int current_capacity;
   int current_capacity_mask;
   int current_begin;
@@ -63,4 +71,116 @@ private:
   int number_elements;
 };
 
+template <class T, int T::*index>
+DynamicQueue<T,index>::DynamicQueue()
+{
+  current_capacity = 1024;
+  current_capacity_mask = current_capacity-1;
+  data = (T**) malloc(sizeof(T*)*current_capacity);
+  current_size = 0;
+  current_begin = 0;
+  current_end = 0;
+  number_elements = 0;
+}
+
+template <class T, int T::*index>
+DynamicQueue<T,index>::~DynamicQueue()
+{
+  free(data);
+}
+
+template <class T, int T::*index>
+inline int DynamicQueue<T,index>::size() const
+{
+  return current_size;
+}
+
+template <class T, int T::*index>
+inline int DynamicQueue<T,index>::elements() const
+{
+  return number_elements;
+}
+
+template <class T, int T::*index>
+inline T* DynamicQueue<T,index>::getFirstElement() const
+{
+  return data[current_begin];
+}
+
+template <class T, int T::*index>
+inline T* DynamicQueue<T,index>::getAndRemoveFirstElement()
+{
+  T* d = data[current_begin];
+  removeFirstElement();
+  return d;
+}
+
+template <class T, int T::*index>
+inline void DynamicQueue<T,index>::addElement(T* d)
+{
+  if (current_size == current_capacity)
+  {
+    grow();
+  }
+  data[current_end] = d;
+  d->*index = current_end; // set absolute index
+  current_end = (current_end + 1) & current_capacity_mask;
+  current_size++;
+  number_elements++;
+}
+
+template <class T, int T::*index>
+inline void DynamicQueue<T,index>::removeElement(const T* d)
+{
+  int i = d->*index;
+  if (i == current_begin)
+  {
+    removeFirstElement();
+  }
+  else
+  {
+    data[i] = 0;
+    number_elements--;
+  }
+}
+
+template <class T, int T::*index>
+inline void DynamicQueue<T,index>::removeFirstElement()
+{
+  current_begin = (current_begin + 1) & current_capacity_mask;
+  current_size--;
+  number_elements--;
+  while (current_size && (data[current_begin] == 0))
+  {
+    current_begin = (current_begin + 1) & current_capacity_mask;
+    current_size--;
+  }
+}
+
+template <class T, int T::*index>
+void DynamicQueue<T,index>::grow()
+{
+  T** temp = (T**) malloc(sizeof(T*)*current_capacity*2);
+  if (current_begin < current_end)
+  {
+    memcpy(temp, &(data[current_begin]), sizeof(T*)*current_size);
+  }
+  else
+  {
+    int rest = current_size-current_begin;
+    memcpy(temp, &(data[current_begin]), sizeof(T*)*rest);
+    memcpy(&(temp[rest]), data, sizeof(T*)*(current_size-rest));
+  }
+  free(data);
+  data = temp;
+  for (int i = 0; i < current_size; i++)
+  {
+    if (data[i]) data[i]->*index = i; // update indices
+  }
+  current_begin = 0;
+  current_end = current_size;
+  current_capacity = current_capacity * 2;
+  current_capacity_mask = current_capacity - 1;
+}
+
 #endif
@@ -6,11 +6,16 @@
   CONTENTS:
 
     the dynamicvector class allows adding and deleting of elements in constant
-    time while keeping the n element indexed though numbers 0 to n-1. as the
-    index of an element may change over time, the elements are expected to
-    provide a field in which their index can be updated. therefore elements are
-    only stored by references (e.g. not by value) in the dynamicvector. therefore
-    the dynamicvector exclusively operates on void* pointers. 
+    time while keeping the n element indexed though numbers 0 to n-1. as both,
+    the absolute and the relative index of an element may change over time, the
+    elements are expected to provide an int field in which their absolute index
+    can be updated. therefore elements are only stored by references (e.g. not
+    by value) in the dynamicvector.
+
+    the dynamicvector is templated on the element type and on the int field
+    that holds the absolute index (e.g. DynamicVector<SMvertex,
+    &SMvertex::dynamicvector>) so that all operations can be inlined into the
+    compressors and no casts are needed by the caller.
 
   PROGRAMMERS:
 
@@ -26,6 +31,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- templated on element type and index field, now inlined
     17 December 2003 -- added efficient handling for first (e.g. oldest) element
     03 October 2003 -- initial version created the day Peter had a sore throat
 
@@ -34,23 +40,29 @@
 #ifndef DYNAMIC_VECTOR_H
 #define DYNAMIC_VECTOR_H
 
+#include <stdlib.h>
+#include <string.h>
+
+template <class T, int T::*index>
 class DynamicVector
 {
 public:
   DynamicVector();
   ~DynamicVector();
 
-  int size() const;
-  void* getFirstElement() const;
-  void* getAndRemoveFirstElement();
-  void* getElementWithRelativeIndex(int ri) const;
-  int getRelativeIndex(void* d) const;
-  void addElement(void* d);
-  void removeElement(void* d);
-  void removeFirstElement();
-
-private:  
-  void** data;
+  inline int size() const;
+  inline T* getFirstElement() const;
+  inline T* getAndRemoveFirstElement();
+  inline T* getElementWithRelativeIndex(int ri) const;
+  inline int getRelativeIndex(const T* d) const;
+  inline void addElement(T* d);
+  inline void removeElement(T* d);
+  inline void removeFirstElement();
+
+private:
+  void grow();
+
+  T** data;
   int current_capacity;
   int current_capacity_mask;
   int current_begin;
@@ -58,4 +70,131 @@ private:
   int current_size;
 };
 
+template <class T, int T::*index>
+DynamicVector<T,index>::DynamicVector()
+{
+  current_capacity = 1024;
+  current_capacity_mask = current_capacity-1;
+  data = (T**) malloc(sizeof(T*)*current_capacity);
+  current_size = 0;
+  current_begin = 0;
+  current_end = 0;
+}
+
+template <class T, int T::*index>
+DynamicVector<T,index>::~DynamicVector()
+{
+  free(data);
+}
+
+template <class T, int T::*index>
+inline int DynamicVector<T,index>::size() const
+{
+  return current_size;
+}
+
+template <class T, int T::*index>
+inline T* DynamicVector<T,index>::getFirstElement() const
+{
+  return data[current_begin];
+}
+
+template <class T, int T::*index>
+inline T* DynamicVector<T,index>::getAndRemoveFirstElement()
+{
+  if (current_size)
+  {
+    T* d = data[current_begin];
+    current_begin = (current_begin + 1) & current_capacity_mask;
+    current_size--;
+    return d;
+  }
+  else
+  {
+    return 0;
+  }
+}
+
+template <class T, int T::*index>
+inline T* DynamicVector<T,index>::getElementWithRelativeIndex(int ri) const
+{
+  return data[(ri + current_begin) & current_capacity_mask];
+}
+
+template <class T, int T::*index>
+inline int DynamicVector<T,index>::getRelativeIndex(const T* d) const
+{
+  int ai = d->*index;
+  if (current_begin <= ai)
+  {
+    return ai - current_begin;
+  }
+  else
+  {
+    return ai + current_capacity - current_begin;
+  }
+}
+
+template <class T, int T::*index>
+inline void DynamicVector<T,index>::addElement(T* d)
+{
+  if (current_size == current_capacity)
+  {
+    grow();
+  }
+  data[current_end] = d;
+  d->*index = current_end; // set absolute index
+  current_end = (current_end + 1) & current_capacity_mask;
+  current_size++;
+}
+
+template <class T, int T::*index>
+inline void DynamicVector<T,index>::removeElement(T* d)
+{
+  int ai = d->*index;
+  if (ai != current_begin) // *not* removing the first element (e.g. the one at current_begin)
+  {
+    data[ai] = data[current_begin];                          // move first element to where the deleted element used to be
+    data[ai]->*index = ai;                                   // update absolute index of first element
+  }
+  current_begin = (current_begin + 1) & current_capacity_mask;
+  current_size--;
+}
+
+template <class T, int T::*index>
+inline void DynamicVector<T,index>::removeFirstElement()
+{
+  if (current_size)
+  {
+    current_begin = (current_begin + 1) & current_capacity_mask;
+    current_size--;
+  }
+}
+
+template <class T, int T::*index>
+void DynamicVector<T,index>::grow()
+{
+  T** temp = (T**) malloc(sizeof(T*)*current_capacity*2);
+  if (current_begin < current_end)
+  {
+    memcpy(temp, &(data[current_begin]), sizeof(T*)*current_size);
+  }
+  else
+  {
+    int rest = current_size-current_begin;
+    memcpy(temp, &(data[current_begin]), sizeof(T*)*rest);
+    memcpy(&(temp[rest]), data, sizeof(T*)*(current_size-rest));
+  }
+  free(data);
+  data = temp;
+  for (int i = 0; i < current_size; i++)
+  {
+    data[i]->*index = i;  // update absolute indices
+  }
+  current_begin = 0;
+  current_end = current_size;
+  current_capacity = current_capacity * 2;
+  current_capacity_mask = current_capacity - 1;
+}
+
 #endif
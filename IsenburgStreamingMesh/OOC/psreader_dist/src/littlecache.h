@@ -20,6 +20,7 @@
 
   CHANGE HISTORY:
 
+    19 October 2026 -- caches SMidx indices
     07 October 2003 -- initial version created the day of the California recall
 
 ===============================================================================
@@ -27,20 +28,22 @@
 #ifndef LITTLE_CACHE_H
 #define LITTLE_CACHE_H
 
+#include "smidx.h"
+
 class LittleCache
 {
 public:
   LittleCache();
   ~LittleCache();
 
-  inline void put(int i0, int i1, int i2);
+  inline void put(SMidx i0, SMidx i1, SMidx i2);
   inline void put(void* d0, void* d1, void* d2);
-  inline void put(int i0, int i1, int i2, void* d0, void* d1, void* d2);
+  inline void put(SMidx i0, SMidx i1, SMidx i2, void* d0, void* d1, void* d2);
   inline void* get(int i);
-  inline int pos(int i);
+  inline int pos(SMidx i);
 
 private:  
-  int index[3];
+  SMidx index[3];
   void* data[3];
 };
 
@@ -58,7 +61,7 @@ inline LittleCache::~LittleCache()
 {
 }
 
-inline void LittleCache::put(int i0, int i1, int i2)
+inline void LittleCache::put(SMidx i0, SMidx i1, SMidx i2)
 {
   index[0] = i0;
   index[1] = i1;
@@ -72,7 +75,7 @@ inline void LittleCache::put(void* d0, void* d1, void* d2)
   data[2] = d2;
 }
 
-inline void LittleCache::put(int i0, int i1, int i2, void* d0, void* d1, void* d2)
+inline void LittleCache::put(SMidx i0, SMidx i1, SMidx i2, void* d0, void* d1, void* d2)
 {
   index[0] = i0;
   index[1] = i1;
@@ -87,7 +90,7 @@ inline void* LittleCache::get(int i)
   return data[i];
 }
 
-inline int LittleCache::pos(int i)
+inline int LittleCache::pos(SMidx i)
 {
   if (i == index[0])
   {
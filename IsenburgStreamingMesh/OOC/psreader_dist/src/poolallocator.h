@@ -0,0 +1,169 @@
+/*
+===============================================================================
+
+  FILE:  poolallocator.h
+
+  CONTENTS:
+
+    an STL allocator that keeps single objects (e.g. the nodes of a hash_map)
+    on a free list instead of returning them to the heap. when the free list
+    runs empty a new block of objects is malloc-ed and chained into the free
+    list. the size of these blocks doubles every time (just like our vertex
+    and triangle buffers do). requests for more than one object (e.g. the
+    bucket vector of a hash_map) go to the heap as usual.
+
+    hence a hash_map that is used for matching the vertices of a streaming
+    mesh does no more heap allocations once it has reached the width of the
+    stream. the free list is kept per thread and per object size and blocks
+    are never returned to the heap.
+
+    the node allocator of the SGI STL does exactly this already, so under
+    _WIN32 the hash_maps continue to use the default allocator.
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    19 October 2026 -- created to make hash_map insert and erase malloc-free
+
+===============================================================================
+*/
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <new>
+
+#ifdef _WIN32
+#define POOL_THREAD __declspec(thread)
+#else
+#define POOL_THREAD __thread
+#endif
+
+template <int size>
+class PoolFreeList
+{
+public:
+  static inline void* alloc();
+  static inline void dealloc(void* p);
+
+private:
+  typedef struct PoolNode
+  {
+    PoolNode* buffer_next;
+  } PoolNode;
+
+  enum { node_size = (size < (int)sizeof(PoolNode) ? (int)sizeof(PoolNode) : size) };
+
+  static void* grow();
+
+  static POOL_THREAD PoolNode* buffer_next;
+  static POOL_THREAD int buffer_alloc;
+};
+
+template <int size>
+POOL_THREAD typename PoolFreeList<size>::PoolNode* PoolFreeList<size>::buffer_next = 0;
+
+template <int size>
+POOL_THREAD int PoolFreeList<size>::buffer_alloc = 256;
+
+template <int size>
+inline void* PoolFreeList<size>::alloc()
+{
+  if (buffer_next == 0)
+  {
+    return grow();
+  }
+  PoolNode* node = buffer_next;
+  buffer_next = node->buffer_next;
+  return node;
+}
+
+template <int size>
+inline void PoolFreeList<size>::dealloc(void* p)
+{
+  PoolNode* node = (PoolNode*)p;
+  node->buffer_next = buffer_next;
+  buffer_next = node;
+}
+
+template <int size>
+void* PoolFreeList<size>::grow()
+{
+  char* block = (char*)malloc(node_size*buffer_alloc);
+  if (block == 0)
+  {
+    throw std::bad_alloc();
+  }
+  for (int i = 1; i < buffer_alloc-1; i++)
+  {
+    ((PoolNode*)(block + i*node_size))->buffer_next = (PoolNode*)(block + (i+1)*node_size);
+  }
+  ((PoolNode*)(block + (buffer_alloc-1)*node_size))->buffer_next = 0;
+  buffer_next = (PoolNode*)(block + node_size);
+  buffer_alloc = 2*buffer_alloc;
+  return block;
+}
+
+template <class T>
+class PoolAllocator
+{
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <class U> struct rebind { typedef PoolAllocator<U> other; };
+
+  PoolAllocator() {}
+  PoolAllocator(const PoolAllocator&) {}
+  template <class U> PoolAllocator(const PoolAllocator<U>&) {}
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  size_type max_size() const { return ((size_t)-1) / sizeof(T); }
+
+  void construct(pointer p, const T& x) { new((void*)p) T(x); }
+  void destroy(pointer p) { p->~T(); }
+
+  pointer allocate(size_type n, const void* = 0)
+  {
+    if (n == 1)
+    {
+      return (pointer)PoolFreeList<sizeof(T)>::alloc();
+    }
+    return (pointer)::operator new(n*sizeof(T));
+  }
+
+  void deallocate(pointer p, size_type n)
+  {
+    if (n == 1)
+    {
+      PoolFreeList<sizeof(T)>::dealloc(p);
+    }
+    else
+    {
+      ::operator delete(p);
+    }
+  }
+
+  bool operator==(const PoolAllocator&) const { return true; }
+  bool operator!=(const PoolAllocator&) const { return false; }
+};
+
+#endif
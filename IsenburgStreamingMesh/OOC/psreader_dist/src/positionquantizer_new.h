@@ -20,6 +20,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- Reset() initializes all members so that a bounding box
+                       without extent quantizes to its minimum
     29 July 2004 -- adapted from the old PositionQuantizer. this one is better
   
 ===============================================================================
@@ -93,6 +95,12 @@ inline void PositionQuantizerNew::Reset()
   m_uBits = 12;
   m_afMin[0] = m_afMin[1] = m_afMin[2] = F32_MAX;
   m_afMax[0] = m_afMax[1] = m_afMax[2] = F32_MIN;
+  // a bounding box without extent quantizes everything to its minimum
+  m_aiQuantMin[0] = m_aiQuantMin[1] = m_aiQuantMin[2] = 0;
+  m_aiQuantMax[0] = m_aiQuantMax[1] = m_aiQuantMax[2] = 0;
+  m_aiQuantRange[0] = m_aiQuantRange[1] = m_aiQuantRange[2] = 1;
+  m_dEnQuantizeMultiplier = 0.0;
+  m_dDeQuantizeMultiplier = 0.0;
 }
 //-----------------------------------------------------------------------------
 
@@ -36,8 +36,11 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smstats.h"
+#include "smtrace.h"
 
 #include <hash_map>
+#include "poolallocator.h"
 
 #define PRINT_CONTROL_OUTPUT
 #undef PRINT_CONTROL_OUTPUT
@@ -48,7 +51,7 @@
 typedef struct PSconnectivityVertex
 {
   float v[3];
-  int index;
+  SMidx index;
   int list_size;
   int list_alloc;
   int* list;
@@ -57,15 +60,19 @@ typedef struct PSconnectivityVertex
 typedef struct PSoutputVertex
 {
   float v[3];
-  int index;
-  int original;
+  SMidx index;
+  SMidx original;
   int vflag;
   int use_count;
   const void* user_data;
   int non_manifold;
 } PSoutputVertex;
 
-typedef std::hash_map<int, int> my_pscv_hash;
+#ifdef _WIN32
+typedef std::hash_map<SMidx, int> my_pscv_hash;
+#else
+typedef std::hash_map<SMidx, int, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<int> > my_pscv_hash;
+#endif
 
 static my_pscv_hash* pscv_hash;
 
@@ -99,27 +106,21 @@ static int pscv_completed;
 
 // statistics
 
-#ifdef PRINT_CONTROL_OUTPUT
-
-static int output_type0;
-static int output_type1;
-static int output_type2;
-static int output_type3;
+static SMstats stats("PSconverter");
 
-static int pscv_buffer_size;
-static int psov_buffer_size;
-static int triangle_buffer_size;
+static int stat_output_type0;
+static int stat_output_type1;
+static int stat_output_type2;
+static int stat_output_type3;
 
-static int pscv_buffer_maxsize;
-static int psov_buffer_maxsize;
-static int triangle_buffer_maxsize;
+static int stat_pscv_buffer;
+static int stat_psov_buffer;
+static int stat_triangle_buffer;
 
-static int number_border_edges;
-static int number_manifold_edges;
-static int number_non_manifold_edges;
-static int number_not_oriented_edges;
-
-#endif
+static int stat_border_edges;
+static int stat_manifold_edges;
+static int stat_non_manifold_edges;
+static int stat_not_oriented_edges;
 
 // efficient memory allocation
 
@@ -128,7 +129,7 @@ static int triangle_buffer_next;
 static int* twinorigin;
 static int* twininv;
 static char* complete;
-static int* original;
+static SMidx* original;
 static int* next_in_outlist;
 static int* prev_in_outlist;
 
@@ -154,7 +155,7 @@ int PSconverter::init_triangle_buffer(int size)
     fprintf(stderr,"ERROR: malloc for complete failed\n");
     return 0;
   }
-  original = (int*)malloc(sizeof(int)*size);
+  original = (SMidx*)malloc(sizeof(SMidx)*size);
   if (original == 0)
   {
     fprintf(stderr,"ERROR: malloc for original failed\n");
@@ -219,7 +220,7 @@ int PSconverter::alloc_triangle() // return index of edge0 of the triangle
       fprintf(stderr,"ERROR: realloc for complete failed\n");
       return -1;
     }
-    original = (int*)realloc(original,sizeof(int)*2*triangle_buffer_alloc);
+    original = (SMidx*)realloc(original,sizeof(SMidx)*2*triangle_buffer_alloc);
     if (original == 0)
     {
       fprintf(stderr,"ERROR: realloc for original failed\n");
@@ -259,10 +260,7 @@ int PSconverter::alloc_triangle() // return index of edge0 of the triangle
   int te0 = triangle_buffer_next;
   triangle_buffer_next = twinorigin[te0];
 
-#ifdef PRINT_CONTROL_OUTPUT
-  triangle_buffer_size++;
-  if (triangle_buffer_size > triangle_buffer_maxsize) triangle_buffer_maxsize = triangle_buffer_size;
-#endif
+  stats.up(stat_triangle_buffer);
 
   twininv[te0] = PS_NOT_INITIALIZED;
   twininv[te0+1] = PS_NOT_INITIALIZED;
@@ -276,9 +274,7 @@ void PSconverter::dealloc_triangle(int te0) // takes index of edge0 of the trian
   twinorigin[te0] = triangle_buffer_next;
   complete[te0/3] = 4;
   triangle_buffer_next = te0;
-#ifdef PRINT_CONTROL_OUTPUT
-  triangle_buffer_size--;
-#endif
+  stats.down(stat_triangle_buffer);
 }
 
 static int pscv_buffer_alloc;
@@ -327,7 +323,7 @@ int PSconverter::alloc_connectivity_vertex()
   }
   // get index of next available vertex
   int pscv_idx = pscv_buffer_next;
-  pscv_buffer_next = pscv_buffer[pscv_idx].index;
+  pscv_buffer_next = (int)pscv_buffer[pscv_idx].index;
   if (pscv_buffer[pscv_idx].list == 0)
   {
     pscv_buffer[pscv_idx].list = (int*)malloc(sizeof(int)*10);
@@ -335,9 +331,7 @@ int PSconverter::alloc_connectivity_vertex()
   }
   pscv_buffer[pscv_idx].list_size = 0;
 
-#ifdef PRINT_CONTROL_OUTPUT
-  pscv_buffer_size++; if (pscv_buffer_size > pscv_buffer_maxsize) pscv_buffer_maxsize = pscv_buffer_size;
-#endif
+  stats.up(stat_pscv_buffer);
 
   return pscv_idx;
 }
@@ -346,9 +340,7 @@ void PSconverter::dealloc_connectivity_vertex(int pscv_idx)
 {
   pscv_buffer[pscv_idx].index = pscv_buffer_next;
   pscv_buffer_next = pscv_idx;
-#ifdef PRINT_CONTROL_OUTPUT
-  pscv_buffer_size--;
-#endif
+  stats.down(stat_pscv_buffer);
 }
 
 static int psov_buffer_alloc;
@@ -396,14 +388,12 @@ int PSconverter::alloc_output_vertex()
   }
   // get index of next available vertex
   int psov_idx = psov_buffer_next;
-  psov_buffer_next = psov_buffer[psov_idx].index;
+  psov_buffer_next = (int)psov_buffer[psov_idx].index;
   psov_buffer[psov_idx].index = -1;
   psov_buffer[psov_idx].use_count = 0;
   psov_buffer[psov_idx].non_manifold = -1;
 
-#ifdef PRINT_CONTROL_OUTPUT
-  psov_buffer_size++; if (psov_buffer_size > psov_buffer_maxsize) psov_buffer_maxsize = psov_buffer_size;
-#endif
+  stats.up(stat_psov_buffer);
 
   return psov_idx;
 }
@@ -412,9 +402,7 @@ void PSconverter::dealloc_output_vertex(int psov_idx)
 {
   psov_buffer[psov_idx].index = psov_buffer_next;
   psov_buffer_next = psov_idx;
-#ifdef PRINT_CONTROL_OUTPUT
-  psov_buffer_size--;
-#endif
+  stats.down(stat_psov_buffer);
 }
 
 static int* sort_edge_list;
@@ -750,9 +738,7 @@ void PSconverter::process_finalized_vertex(int pscv_idx)
       k = j+1;
       if (j == sort_edge_list_size || origin(sort_edge_list[i]&MASK) != origin(sort_edge_list[j]&MASK)) // border
       {
-#ifdef PRINT_CONTROL_OUTPUT
-        number_border_edges++;
-#endif
+        stats.count(stat_border_edges);
         if (sort_edge_list[i]&MARK)
         {
           setinv(sort_edge_list[i]&MASK,PS_BORDER_EDGE);
@@ -769,9 +755,7 @@ void PSconverter::process_finalized_vertex(int pscv_idx)
         {
           if ((sort_edge_list[i] & MARK) ^ (sort_edge_list[j] & MARK)) // manifold and oriented edges
           {
-#ifdef PRINT_CONTROL_OUTPUT
-            number_manifold_edges++;
-#endif
+            stats.count(stat_manifold_edges, 2);
             if (sort_edge_list[i]&MARK)
             {
               setinv(sort_edge_list[i]&MASK,prev(sort_edge_list[j]));
@@ -785,9 +769,7 @@ void PSconverter::process_finalized_vertex(int pscv_idx)
           }
           else // not oriented edges
           {
-#ifdef PRINT_CONTROL_OUTPUT
-            number_not_oriented_edges++;
-#endif
+            stats.count(stat_not_oriented_edges, 2);
             if (sort_edge_list[i]&MARK)
             {
               setinv(sort_edge_list[i]&MASK,PS_NOT_ORIENTED_EDGE);
@@ -809,9 +791,7 @@ void PSconverter::process_finalized_vertex(int pscv_idx)
         }
         else // non-manifold edge
         {
-#ifdef PRINT_CONTROL_OUTPUT
-          number_non_manifold_edges+=2;
-#endif
+          stats.count(stat_non_manifold_edges, 2);
           if (sort_edge_list[i]&MARK)
           {
             setinv(sort_edge_list[i]&MASK,PS_NON_MANIFOLD_EDGE);
@@ -830,9 +810,7 @@ void PSconverter::process_finalized_vertex(int pscv_idx)
           }
           while (k < sort_edge_list_size && origin(sort_edge_list[i]&MASK) == origin(sort_edge_list[k]&MASK))
           {
-#ifdef PRINT_CONTROL_OUTPUT
-            number_non_manifold_edges++;
-#endif
+            stats.count(stat_non_manifold_edges);
             if (sort_edge_list[k]&MARK)
             {
               setinv(sort_edge_list[k]&MASK,PS_NON_MANIFOLD_EDGE);
@@ -972,7 +950,7 @@ int PSconverter::process_event()
     {
       pscv_idx = alloc_connectivity_vertex();
       pscv_buffer[pscv_idx].index = smreader->v_idx;
-      pscv_hash->insert(my_pscv_hash::value_type(smreader->v_idx, pscv_idx));
+      sm_trace_hash_insert(pscv_hash, my_pscv_hash::value_type(smreader->v_idx, pscv_idx), "PSconverter::pscv_hash");
     }
     VecCopy3fv((&(pscv_buffer[pscv_idx]))->v,smreader->v_pos_f);
   }
@@ -990,7 +968,7 @@ int PSconverter::process_event()
       {
         pscv_idx = alloc_connectivity_vertex();
         pscv_buffer[pscv_idx].index = smreader->t_idx[0];
-        pscv_hash->insert(my_pscv_hash::value_type(smreader->t_idx[0], pscv_idx));
+        sm_trace_hash_insert(pscv_hash, my_pscv_hash::value_type(smreader->t_idx[0], pscv_idx), "PSconverter::pscv_hash");
       }
       else
       {
@@ -1005,7 +983,7 @@ int PSconverter::process_event()
     twinorigin[te0] = pscv_idx;
     if (pscv_buffer[pscv_idx].list_alloc == pscv_buffer[pscv_idx].list_size)
     {
-      pscv_buffer[pscv_idx].list_alloc = pscv_buffer[pscv_idx].list_alloc + 2;
+      pscv_buffer[pscv_idx].list_alloc = 2*pscv_buffer[pscv_idx].list_alloc;
       pscv_buffer[pscv_idx].list = (int*)realloc(pscv_buffer[pscv_idx].list, sizeof(int)*pscv_buffer[pscv_idx].list_alloc);
     }
     pscv_buffer[pscv_idx].list[pscv_buffer[pscv_idx].list_size] = te0;
@@ -1020,7 +998,7 @@ int PSconverter::process_event()
       {
         pscv_idx = alloc_connectivity_vertex();
         pscv_buffer[pscv_idx].index = smreader->t_idx[1];
-        pscv_hash->insert(my_pscv_hash::value_type(smreader->t_idx[1], pscv_idx));
+        sm_trace_hash_insert(pscv_hash, my_pscv_hash::value_type(smreader->t_idx[1], pscv_idx), "PSconverter::pscv_hash");
       }
       else
       {
@@ -1035,7 +1013,7 @@ int PSconverter::process_event()
     twinorigin[te0+1] = pscv_idx;
     if (pscv_buffer[pscv_idx].list_alloc == pscv_buffer[pscv_idx].list_size)
     {
-      pscv_buffer[pscv_idx].list_alloc = pscv_buffer[pscv_idx].list_alloc + 2;
+      pscv_buffer[pscv_idx].list_alloc = 2*pscv_buffer[pscv_idx].list_alloc;
       pscv_buffer[pscv_idx].list = (int*)realloc(pscv_buffer[pscv_idx].list, sizeof(int)*pscv_buffer[pscv_idx].list_alloc);
     }
     pscv_buffer[pscv_idx].list[pscv_buffer[pscv_idx].list_size] = te0+1;
@@ -1050,7 +1028,7 @@ int PSconverter::process_event()
       {
         pscv_idx = alloc_connectivity_vertex();
         pscv_buffer[pscv_idx].index = smreader->t_idx[2];
-        pscv_hash->insert(my_pscv_hash::value_type(smreader->t_idx[2], pscv_idx));
+        sm_trace_hash_insert(pscv_hash, my_pscv_hash::value_type(smreader->t_idx[2], pscv_idx), "PSconverter::pscv_hash");
       }
       else
       {
@@ -1065,7 +1043,7 @@ int PSconverter::process_event()
     twinorigin[te0+2] = pscv_idx;
     if (pscv_buffer[pscv_idx].list_alloc == pscv_buffer[pscv_idx].list_size)
     {
-      pscv_buffer[pscv_idx].list_alloc = pscv_buffer[pscv_idx].list_alloc + 2;
+      pscv_buffer[pscv_idx].list_alloc = 2*pscv_buffer[pscv_idx].list_alloc;
       pscv_buffer[pscv_idx].list = (int*)realloc(pscv_buffer[pscv_idx].list, sizeof(int)*pscv_buffer[pscv_idx].list_alloc);
     }
     pscv_buffer[pscv_idx].list[pscv_buffer[pscv_idx].list_size] = te0+2;
@@ -1123,6 +1101,7 @@ int PSconverter::process_event()
 
 void PSconverter::fill_output_buffer()
 {
+  SM_TRACE_BEGIN("PSconverter::fill_output_buffer", "buffer");
   while (output_triangles_available < output_triangles_buffer_high)
   {
     if (process_event() == 0)
@@ -1131,6 +1110,7 @@ void PSconverter::fill_output_buffer()
       output_triangles_buffer_high = -1;
     }
   }
+  SM_TRACE_END("PSconverter::fill_output_buffer", "buffer");
 }
 
 bool PSconverter::open(SMreader* smr, int low, int high)
@@ -1178,25 +1158,23 @@ bool PSconverter::open(SMreader* smr, int low, int high)
 
   pscv_completed = 0;
 
-#ifdef PRINT_CONTROL_OUTPUT
-  output_type0 = 0;
-  output_type1 = 0;
-  output_type2 = 0;
-  output_type3 = 0;
+  stat_output_type0 = stats.add("output_type0");
+  stat_output_type1 = stats.add("output_type1");
+  stat_output_type2 = stats.add("output_type2");
+  stat_output_type3 = stats.add("output_type3");
 
-  pscv_buffer_size = 0;
-  psov_buffer_size = 0;
-  triangle_buffer_size = 0;
+  stat_pscv_buffer = stats.add("pscv_buffer", SM_STATS_LEVEL);
+  stat_psov_buffer = stats.add("psov_buffer", SM_STATS_LEVEL);
+  stat_triangle_buffer = stats.add("triangle_buffer", SM_STATS_LEVEL);
 
-  pscv_buffer_maxsize = 0;
-  psov_buffer_maxsize = 0;
-  triangle_buffer_maxsize = 0;
+  stat_border_edges = stats.add("border_edges");
+  stat_manifold_edges = stats.add("manifold_edges");
+  stat_non_manifold_edges = stats.add("non_manifold_edges");
+  stat_not_oriented_edges = stats.add("not_oriented_edges");
 
-  number_border_edges = 0;
-  number_manifold_edges = 0;
-  number_non_manifold_edges = 0;
-  number_not_oriented_edges = 0;
+  stats.reset();
 
+#ifdef PRINT_CONTROL_OUTPUT
   fprintf(stderr,"starting sequence ...\n");
 #endif
 
@@ -1205,18 +1183,23 @@ bool PSconverter::open(SMreader* smr, int low, int high)
   return true;
 }
 
+const SMstats* PSconverter::get_stats() const
+{
+  return &stats;
+}
+
 void PSconverter::close()
 {
 #ifdef PRINT_CONTROL_OUTPUT
   fprintf(stderr, "done.\n");
 
-  fprintf(stderr,"connectivity vertex buffer: alloc %d maxsize %d size %d\n",pscv_buffer_alloc, pscv_buffer_maxsize,pscv_buffer_size);
-  fprintf(stderr,"output vertex buffer: alloc %d maxsize %d size %d\n",psov_buffer_alloc,psov_buffer_maxsize,psov_buffer_size);
-  fprintf(stderr,"triangle buffer: alloc %d maxsize %d\n",triangle_buffer_alloc,triangle_buffer_maxsize);
+  fprintf(stderr,"connectivity vertex buffer: alloc %d maxsize " SM_COUNT_FORMAT " size " SM_COUNT_FORMAT "\n",pscv_buffer_alloc,stats.max(stat_pscv_buffer),stats.value(stat_pscv_buffer));
+  fprintf(stderr,"output vertex buffer: alloc %d maxsize " SM_COUNT_FORMAT " size " SM_COUNT_FORMAT "\n",psov_buffer_alloc,stats.max(stat_psov_buffer),stats.value(stat_psov_buffer));
+  fprintf(stderr,"triangle buffer: alloc %d maxsize " SM_COUNT_FORMAT "\n",triangle_buffer_alloc,stats.max(stat_triangle_buffer));
 
-  fprintf(stderr,"half-edges: border %d manifold %d not-oriented %d non-manifold %d\n",number_border_edges,number_manifold_edges*2,number_not_oriented_edges*2,number_non_manifold_edges);
+  fprintf(stderr,"half-edges: border " SM_COUNT_FORMAT " manifold " SM_COUNT_FORMAT " not-oriented " SM_COUNT_FORMAT " non-manifold " SM_COUNT_FORMAT "\n",stats.value(stat_border_edges),stats.value(stat_manifold_edges),stats.value(stat_not_oriented_edges),stats.value(stat_non_manifold_edges));
   fprintf(stderr,"%d %d %d %d %d\n",output_triangles_available,outlist3_available,outlist2_available,outlist1_available,outlist0_available);
-  fprintf(stderr,"start %d add+join %d fill %d end %d\n",output_type0,output_type1,output_type2,output_type3);
+  fprintf(stderr,"start " SM_COUNT_FORMAT " add+join " SM_COUNT_FORMAT " fill " SM_COUNT_FORMAT " end " SM_COUNT_FORMAT "\n",stats.value(stat_output_type0),stats.value(stat_output_type1),stats.value(stat_output_type2),stats.value(stat_output_type3));
 #endif
 
   free(sort_edge_list);
@@ -1225,13 +1208,13 @@ void PSconverter::close()
 
   if (nverts != -1 && nverts != v_count)
   {
-    fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+    fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
   }
   nverts = v_count;
   
   if (nfaces != -1 && nfaces != f_count)
   {
-    fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+    fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
   }
   nfaces = f_count;
 }
@@ -1281,9 +1264,7 @@ PSevent PSconverter::read_triangle()
       prev_in_outlist[outlist3] = prev_in_outlist[t];
     }
     outlist3_available--;
-#ifdef PRINT_CONTROL_OUTPUT
-    output_type3++;
-#endif
+    stats.count(stat_output_type3);
   }
   else if (outlist2 != -1) // try get triangle from outlist2 (-> 'fill' operation)
   {
@@ -1300,9 +1281,7 @@ PSevent PSconverter::read_triangle()
       prev_in_outlist[outlist2] = prev_in_outlist[t];
     }
     outlist2_available--;
-#ifdef PRINT_CONTROL_OUTPUT
-    output_type2++;
-#endif
+    stats.count(stat_output_type2);
   }
   else if (outlist1 != -1) // try get triangle from outlist1 (-> 'add/split' operations)
   {
@@ -1319,9 +1298,7 @@ PSevent PSconverter::read_triangle()
       prev_in_outlist[outlist1] = prev_in_outlist[t];
     }
     outlist1_available--;
-#ifdef PRINT_CONTROL_OUTPUT
-    output_type1++;
-#endif
+    stats.count(stat_output_type1);
   }
   else  // try get triangle from outlist0 (-> 'start' operations)
   {
@@ -1353,9 +1330,7 @@ PSevent PSconverter::read_triangle()
       prev_in_outlist[outlist0] = prev_in_outlist[t];
     }
     outlist0_available--;
-#ifdef PRINT_CONTROL_OUTPUT
-    output_type0++;
-#endif
+    stats.count(stat_output_type0);
 //    fprintf(stderr,"using type 0: %d %d %d %d\n",outlist3_available,outlist2_available,outlist1_available,outlist0_available);
   }
 
@@ -1563,7 +1538,7 @@ PSconverter::PSconverter()
   v_idx = PS_UNDEFINED;
   t_orig = PS_UNDEFINED;
 
-  t_idx_orig = new int[3];
+  t_idx_orig = new SMidx[3];
 
   for (i = 0; i < 3; i++)
   {
@@ -40,7 +40,7 @@ static PositionQuantizer* pq;
 // structs used during decompression
 
 typedef struct BoundaryVertex {
-  int index;
+  SMidx index;
   int use_count;
   const void* user_data;
   BoundaryVertex* non_manifold;
@@ -63,7 +63,7 @@ typedef struct Boundary {
   int length;
   int zero_slots;
   int one_slots;
-  int age;
+  SMidx age;
 } Boundary;
 
 // variables uses during decompression
@@ -74,16 +74,16 @@ static int zero_slots;
 static bool has_left_zero_slot;
 static bool was_right_zero_slot;
 static int one_slots;
-static int queue_boundary_age;
+static SMidx queue_boundary_age;
 
 static Boundary* boundary;
 
 static int corr[3];
 static int pred[3];
 
-static CrazyVector* boundaryQueue;
+static CrazyVector<Boundary>* boundaryQueue;
 static TSCcodec* codec;
-static CrazyVector* nonmanifoldDecompress;
+static CrazyVector<BoundaryVertex>* nonmanifoldDecompress;
 
 static BoundaryVertex* output_vertex[3];
 
@@ -171,7 +171,7 @@ static Boundary* boundaries;
 static int numBoundariesAlloced;
 static int maxBoundariesAlloced;
 
-static Boundary* allocBoundary(BoundaryEdge* g, int l, int zs, int os, int a)
+static Boundary* allocBoundary(BoundaryEdge* g, int l, int zs, int os, SMidx a)
 {
   Boundary* boundary = boundaries;
 
@@ -218,23 +218,23 @@ static void addBoundary(Boundary* boundary)
 
 static Boundary* getBoundary()
 {
-  Boundary* boundary = (Boundary*)boundaryQueue->firstElement();
+  Boundary* boundary = boundaryQueue->firstElement();
   boundaryQueue->removeFirstElement();
   return boundary;
 }
 
-static int getQueueBoundaryAge()
+static SMidx getQueueBoundaryAge()
 {
   if (boundaryQueue->size())
   {
     // there is another boundary ... return its age
-    Boundary* boundary = (Boundary*)boundaryQueue->firstElement();
+    Boundary* boundary = boundaryQueue->firstElement();
     return boundary->age;
   }
   else
   {
     // there is no boundary ... return a really 'young' number
-    return (1<<30);
+    return SM_IDX_MAX;
   }
 }
 
@@ -245,12 +245,12 @@ static int hasMoreBoundaries()
 
 static Boundary* getBoundary(int i)
 {
-  return (Boundary*)boundaryQueue->elementAt(i);
+  return boundaryQueue->elementAt(i);
 }
 
 static Boundary* removeBoundary(int i)
 {
-  Boundary* boundary = (Boundary*)boundaryQueue->elementAt(i);
+  Boundary* boundary = boundaryQueue->elementAt(i);
   boundaryQueue->lazyRemoveElementAt(i);
   return boundary;
 }
@@ -656,13 +656,13 @@ static int decompress(PSreader_lowspan* ps)
             readPosition(vertex->origin);  // read vertex position (center predicted)
             ps->v_count++;
             vertex->non_manifold = vertex; // marks vertex as non-manifold
-            nonmanifoldDecompress->addElement((void*)vertex);
+            nonmanifoldDecompress->addElement(vertex);
             ps->nm_v_count++;
           }
           else
           {
             int range = codec->readRange(nonmanifoldDecompress->size());
-            BoundaryVertex* nm_vertex = (BoundaryVertex*) nonmanifoldDecompress->elementAt(range);
+            BoundaryVertex* nm_vertex = nonmanifoldDecompress->elementAt(range);
             // insert into linked list of non-manifolds
             vertex->non_manifold = nm_vertex->non_manifold;
             nm_vertex->non_manifold = vertex;
@@ -718,13 +718,13 @@ static int decompress(PSreader_lowspan* ps)
             readPositionLastPredicted(gate->vertex->origin,vertex->origin); // read vertex position (last predicted)
             ps->v_count++;
             vertex->non_manifold = vertex; // marks vertex as non-manifold
-            nonmanifoldDecompress->addElement((void*)vertex);
+            nonmanifoldDecompress->addElement(vertex);
             ps->nm_v_count++;
           }
           else
           {
             int range = codec->readRange(nonmanifoldDecompress->size());
-            BoundaryVertex* nm_vertex = (BoundaryVertex*) nonmanifoldDecompress->elementAt(range);
+            BoundaryVertex* nm_vertex = nonmanifoldDecompress->elementAt(range);
             // insert into linked list of non-manifolds
             vertex->non_manifold = nm_vertex->non_manifold;
             nm_vertex->non_manifold = vertex;
@@ -1231,7 +1231,7 @@ static int decompress(PSreader_lowspan* ps)
           else
           {
             int range = codec->readRange(nonmanifoldDecompress->size());
-            BoundaryVertex* nm_vertex = (BoundaryVertex*) nonmanifoldDecompress->elementAt(range);
+            BoundaryVertex* nm_vertex = nonmanifoldDecompress->elementAt(range);
             // insert into linked list of non-manifolds
             vertex->non_manifold = nm_vertex->non_manifold;
             nm_vertex->non_manifold = vertex;
@@ -1448,13 +1448,13 @@ bool PSreader_lowspan::open(FILE* fp)
   {
     if (strncmp(in_ply->comments[i],"nverts",6) == 0)
     {
-      sscanf(in_ply->comments[i], "nverts %d", &nverts);
-      PRINT_CONTROL_OUTPUT(stderr,"nverts %d\n",nverts);
+      sscanf(in_ply->comments[i], "nverts " SM_IDX_FORMAT, &nverts);
+      PRINT_CONTROL_OUTPUT(stderr,"nverts " SM_IDX_FORMAT "\n",nverts);
     }
     else if (strncmp(in_ply->comments[i],"nfaces",6) == 0)
     {
-      sscanf(in_ply->comments[i], "nfaces %d", &nfaces);
-      PRINT_CONTROL_OUTPUT(stderr,"nfaces %d\n",nfaces);
+      sscanf(in_ply->comments[i], "nfaces " SM_IDX_FORMAT, &nfaces);
+      PRINT_CONTROL_OUTPUT(stderr,"nfaces " SM_IDX_FORMAT "\n",nfaces);
     }
     else if (strncmp(in_ply->comments[i],"ncomps",6) == 0)
     {
@@ -1471,7 +1471,7 @@ bool PSreader_lowspan::open(FILE* fp)
   if ((nverts == -1) || (nfaces == -1) || (bits == -1))
   {
     fprintf(stderr, "ERROR: something is missing in the comments\n");
-    fprintf(stderr, "nverts == %d  nfaces == %d  bits == %d\n",nverts, nfaces, bits);
+    fprintf(stderr, "nverts == " SM_IDX_FORMAT "  nfaces == " SM_IDX_FORMAT "  bits == %d\n",nverts, nfaces, bits);
     return false;
   }
 
@@ -1553,9 +1553,9 @@ bool PSreader_lowspan::open(FILE* fp)
 
   boundary = 0;
 
-  boundaryQueue = new CrazyVector();
+  boundaryQueue = new CrazyVector<Boundary>();
   codec = new TSCcodec();
-  nonmanifoldDecompress = new CrazyVector();
+  nonmanifoldDecompress = new CrazyVector<BoundaryVertex>();
 
   PRINT_CONTROL_OUTPUT(stderr,"starting decompression ...\n");
   codec->initDec(10,pq->m_uBits,pq->m_aiRangeCode,pq->m_aiAbsRangeCorrector,in_ply->fp);
@@ -1680,7 +1680,7 @@ void* PSreader_lowspan::get_edata(int i) const
 void PSreader_lowspan::close()
 {
   PRINT_CONTROL_OUTPUT(stderr,"v: %d s: %d m: %d\n",codec->v,codec->s,codec->m);
-  PRINT_CONTROL_OUTPUT(stderr,"v_count: %d f_count: %d h_count: %d c_count: %d nm_v_count: %d\n",v_count,f_count,h_count,c_count,nm_v_count);
+  PRINT_CONTROL_OUTPUT(stderr,"v_count: " SM_IDX_FORMAT " f_count: " SM_IDX_FORMAT " h_count: %d c_count: %d nm_v_count: %d\n",v_count,f_count,h_count,c_count,nm_v_count);
   PRINT_CONTROL_OUTPUT(stderr,"\n\n");
 
   PRINT_CONTROL_OUTPUT(stderr,"maxBoundaryVerticesAlloced %d %d\n",maxBoundaryVerticesAlloced, numBoundaryVerticesAlloced);
@@ -1696,11 +1696,11 @@ void PSreader_lowspan::close()
 
   if (v_count != nverts)
   {
-    fprintf(stderr, "ERROR: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+    fprintf(stderr, "ERROR: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
   }
   if (f_count != nfaces)
   {
-    fprintf(stderr, "ERROR: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+    fprintf(stderr, "ERROR: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
   }
   if ((ncomps != -1) && (c_count != ncomps))
   {
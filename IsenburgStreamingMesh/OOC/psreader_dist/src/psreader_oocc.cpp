@@ -67,7 +67,7 @@ static PositionQuantizer* pq;
 // structs used during decompression
 
 typedef struct BoundaryVertex {
-  int index;
+  SMidx index;
   int use_count;
   const void* user_data;
   BoundaryVertex* non_manifold;
@@ -104,9 +104,9 @@ static Boundary* boundary;
 static int corr[3];
 static int pred[3];
 
-static TSCvector* boundaryStack;
+static TSCvector<Boundary>* boundaryStack;
 static TSCcodec* codec;
-static CrazyVector* nonmanifoldDecompress;
+static CrazyVector<BoundaryVertex>* nonmanifoldDecompress;
 
 static BoundaryVertex* output_vertex[3];
 
@@ -240,7 +240,7 @@ static void pushBoundary(Boundary* boundary)
 
 static Boundary* popBoundary()
 {
-  Boundary* boundary = (Boundary*)boundaryStack->lastElement();
+  Boundary* boundary = boundaryStack->lastElement();
   boundaryStack->removeLastElement();
   return boundary;
 }
@@ -252,12 +252,12 @@ static int hasMoreBoundaries()
 
 static Boundary* getBoundary(int i)
 {
-  return (Boundary*)boundaryStack->elementAt(i);
+  return boundaryStack->elementAt(i);
 }
 
 static Boundary* removeBoundary(int i)
 {
-  Boundary* boundary = (Boundary*)boundaryStack->elementAt(i);
+  Boundary* boundary = boundaryStack->elementAt(i);
   boundaryStack->removeElementAt(i);
   return boundary;
 }
@@ -626,13 +626,13 @@ static int decompress(PSreader_oocc* ps)
             readPosition(vertex->origin);  // read vertex position (center predicted)
             ps->v_count++;
             vertex->non_manifold = vertex; // marks vertex as non-manifold
-            nonmanifoldDecompress->addElement((void*)vertex);
+            nonmanifoldDecompress->addElement(vertex);
             ps->nm_v_count++;
           }
           else
           {
             int range = codec->readRange(nonmanifoldDecompress->size());
-            BoundaryVertex* nm_vertex = (BoundaryVertex*) nonmanifoldDecompress->elementAt(range);
+            BoundaryVertex* nm_vertex = nonmanifoldDecompress->elementAt(range);
             // insert into linked list of non-manifolds
             vertex->non_manifold = nm_vertex->non_manifold;
             nm_vertex->non_manifold = vertex;
@@ -688,13 +688,13 @@ static int decompress(PSreader_oocc* ps)
             readPositionLastPredicted(gate->vertex->origin,vertex->origin); // read vertex position (last predicted)
             ps->v_count++;
             vertex->non_manifold = vertex; // marks vertex as non-manifold
-            nonmanifoldDecompress->addElement((void*)vertex);
+            nonmanifoldDecompress->addElement(vertex);
             ps->nm_v_count++;
           }
           else
           {
             int range = codec->readRange(nonmanifoldDecompress->size());
-            BoundaryVertex* nm_vertex = (BoundaryVertex*) nonmanifoldDecompress->elementAt(range);
+            BoundaryVertex* nm_vertex = nonmanifoldDecompress->elementAt(range);
             // insert into linked list of non-manifolds
             vertex->non_manifold = nm_vertex->non_manifold;
             nm_vertex->non_manifold = vertex;
@@ -1196,7 +1196,7 @@ static int decompress(PSreader_oocc* ps)
           else
           {
             int range = codec->readRange(nonmanifoldDecompress->size());
-            BoundaryVertex* nm_vertex = (BoundaryVertex*) nonmanifoldDecompress->elementAt(range);
+            BoundaryVertex* nm_vertex = nonmanifoldDecompress->elementAt(range);
             // insert into linked list of non-manifolds
             vertex->non_manifold = nm_vertex->non_manifold;
             nm_vertex->non_manifold = vertex;
@@ -1380,13 +1380,13 @@ bool PSreader_oocc::open(FILE* fp)
   {
     if (strncmp(in_ply->comments[i],"nverts",6) == 0)
     {
-      sscanf(in_ply->comments[i], "nverts %d", &nverts);
-      PRINT_CONTROL_OUTPUT(stderr,"nverts %d\n",nverts);
+      sscanf(in_ply->comments[i], "nverts " SM_IDX_FORMAT, &nverts);
+      PRINT_CONTROL_OUTPUT(stderr,"nverts " SM_IDX_FORMAT "\n",nverts);
     }
     else if (strncmp(in_ply->comments[i],"nfaces",6) == 0)
     {
-      sscanf(in_ply->comments[i], "nfaces %d", &nfaces);
-      PRINT_CONTROL_OUTPUT(stderr,"nfaces %d\n",nfaces);
+      sscanf(in_ply->comments[i], "nfaces " SM_IDX_FORMAT, &nfaces);
+      PRINT_CONTROL_OUTPUT(stderr,"nfaces " SM_IDX_FORMAT "\n",nfaces);
     }
     else if (strncmp(in_ply->comments[i],"ncomps",6) == 0)
     {
@@ -1403,7 +1403,7 @@ bool PSreader_oocc::open(FILE* fp)
   if ((nverts == -1) || (nfaces == -1) || (bits == -1))
   {
     fprintf(stderr, "ERROR: something is missing in the comments\n");
-    fprintf(stderr, "nverts == %d  nfaces == %d  bits == %d\n",nverts, nfaces, bits);
+    fprintf(stderr, "nverts == " SM_IDX_FORMAT "  nfaces == " SM_IDX_FORMAT "  bits == %d\n",nverts, nfaces, bits);
     return false;
   }
 
@@ -1485,9 +1485,9 @@ bool PSreader_oocc::open(FILE* fp)
 
   boundary = 0;
 
-  boundaryStack = new TSCvector();
+  boundaryStack = new TSCvector<Boundary>();
   codec = new TSCcodec();
-  nonmanifoldDecompress = new CrazyVector();
+  nonmanifoldDecompress = new CrazyVector<BoundaryVertex>();
 
   PRINT_CONTROL_OUTPUT(stderr,"starting decompression ...\n");
   codec->initDec(10,pq->m_uBits,pq->m_aiRangeCode,pq->m_aiAbsRangeCorrector,in_ply->fp);
@@ -1612,7 +1612,7 @@ void* PSreader_oocc::get_edata(int i) const
 void PSreader_oocc::close()
 {
   PRINT_CONTROL_OUTPUT(stderr,"v: %d s: %d m: %d\n",codec->v,codec->s,codec->m);
-  PRINT_CONTROL_OUTPUT(stderr,"v_count: %d f_count: %d h_count: %d c_count: %d nm_v_count: %d\n",v_count,f_count,h_count,c_count,nm_v_count);
+  PRINT_CONTROL_OUTPUT(stderr,"v_count: " SM_IDX_FORMAT " f_count: " SM_IDX_FORMAT " h_count: %d c_count: %d nm_v_count: %d\n",v_count,f_count,h_count,c_count,nm_v_count);
   PRINT_CONTROL_OUTPUT(stderr,"\n\n");
 
   PRINT_CONTROL_OUTPUT(stderr,"maxBoundaryVerticesAlloced %d %d\n",maxBoundaryVerticesAlloced, numBoundaryVerticesAlloced);
@@ -1628,11 +1628,11 @@ void PSreader_oocc::close()
 
   if (v_count != nverts)
   {
-    fprintf(stderr, "ERROR: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+    fprintf(stderr, "ERROR: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
   }
   if (f_count != nfaces)
   {
-    fprintf(stderr, "ERROR: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+    fprintf(stderr, "ERROR: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
   }
   if ((ncomps != -1) && (c_count != ncomps))
   {
@@ -195,12 +195,17 @@ void RangeDecoder::update(unsigned int sy_f, unsigned int lt_f, unsigned int tot
 #endif
 }
 
-RangeDecoder::RangeDecoder(unsigned char* chars, int number_chars)
+RangeDecoder::RangeDecoder(unsigned char* chars, size_t number_chars)
+{
+  fp = 0;
+  restart(chars, number_chars);
+}
+
+void RangeDecoder::restart(unsigned char* chars, size_t number_chars)
 {
   this->chars = chars;
   this->number_chars = number_chars;
   current_char = 0;
-  fp = 0;
 
   buffer = inbyte();
   if (buffer != HEADERBYTE)
@@ -19,6 +19,8 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- the number of characters is a size_t
+    19 October 2026 -- can restart on other characters for streams cut into sections
     14 January 2003 -- adapted from michael schindler's code before SIGGRAPH
   
 ===============================================================================
@@ -35,7 +37,7 @@ class RangeDecoder
 public:
 
 /* Start the decoder                                         */
-  RangeDecoder(unsigned char* chars, int number_chars);
+  RangeDecoder(unsigned char* chars, size_t number_chars);
   RangeDecoder(FILE* fp);
 
   ~RangeDecoder();
@@ -61,6 +63,9 @@ public:
 /* Finish decoding                                           */
   void done();
 
+/* Start again on other characters                           */
+  void restart(unsigned char* chars, size_t number_chars);
+
 private:
 /* Calculate culmulative frequency for next symbol. Does NO update!*/
 /* tot_f is the total frequency                              */
@@ -80,8 +85,8 @@ private:
   FILE* fp;
 
   unsigned char* chars;
-  int current_char;
-  int number_chars;
+  size_t current_char;
+  size_t number_chars;
 
   unsigned int low;         /* low end of interval */
   unsigned int range;       /* length of interval */
@@ -32,6 +32,7 @@
 
 RangeEncoder::RangeEncoder(FILE* fp, bool store_chars)
 {
+  memory = 0;
   if (fp)
   {
     this->fp = fp;
@@ -61,6 +62,19 @@ RangeEncoder::RangeEncoder(FILE* fp, bool store_chars)
   bytecount = 0;
 }
 
+RangeEncoder::RangeEncoder(SMmemoryOutput& memory)
+{
+  fp = 0;
+  this->memory = &memory;
+  chars = 0;
+  number_chars = 0;
+  low = 0;                /* Full code range */
+  range = TOP_VALUE;
+  /* this buffer is written as first byte in the datastream (header,...) */
+  buffer = HEADERBYTE;
+  help = 0;               /* No bytes to follow */
+  bytecount = 0;
+}
 
 void RangeEncoder::encode(RangeModel* rm, unsigned int sym)
 {
@@ -243,7 +257,17 @@ unsigned int RangeEncoder::done()
   outbyte((bytecount>>16) & 0xff);
   outbyte((bytecount>>8) & 0xff);
   outbyte(bytecount & 0xff);
-  return bytecount;
+  return (unsigned int)bytecount;
+}
+
+void RangeEncoder::restart()
+{
+  number_chars = 0;
+  low = 0;
+  range = TOP_VALUE;
+  buffer = HEADERBYTE;
+  help = 0;
+  bytecount = 0;
 }
 
 RangeEncoder::~RangeEncoder()
@@ -264,14 +288,14 @@ int RangeEncoder::getNumberChars()
   return number_chars;
 }
 
-long RangeEncoder::getNumberBits()
+I64 RangeEncoder::getNumberBits()
 {
   return bytecount*8;
 }
 
 int RangeEncoder::getNumberBytes()
 {
-  return bytecount;
+  return (int)bytecount;
 }
 
 inline void RangeEncoder::outbyte(unsigned int c)
@@ -280,6 +304,10 @@ inline void RangeEncoder::outbyte(unsigned int c)
   {
     fputc(c, fp);
   }
+  else if (memory)
+  {
+    memory->put_byte(c);
+  }
   else
   {
     if (chars)
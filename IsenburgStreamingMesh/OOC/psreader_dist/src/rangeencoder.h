@@ -19,6 +19,9 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- can output into memory of the caller (see SMmemory.h)
+    19 October 2026 -- can restart after done() for streams cut into sections
+    19 October 2026 -- counts the bytes with 64 bits for streams beyond 4 GB
     28 June 2004 -- added an option for NOT storing the code characters at all 
     14 January 2003 -- adapted from michael schindler's code before SIGGRAPH
   
@@ -29,7 +32,9 @@
 
 #include <stdio.h>
 
+#include "mydefs.h"
 #include "rangemodel.h"
+#include "smmemory.h"
 
 class RangeEncoder
 {
@@ -37,6 +42,9 @@ public:
 
 /* Start the encoder                                         */
   RangeEncoder(FILE* fp, bool store_chars = true);
+
+/* Start the encoder on an opened memory output              */
+  RangeEncoder(SMmemoryOutput& memory);
   ~RangeEncoder();
 
 /* Encode with modelling                                     */
@@ -60,10 +68,13 @@ public:
 /* Finish encoding, returns number of bytes written          */
   unsigned int done();
 
+/* Start again after done() (drops the stored characters)    */
+  void restart();
+
   unsigned char* getChars();
   int getNumberChars();
 
-  long getNumberBits();
+  I64 getNumberBits();
   int getNumberBytes();
 
 private:
@@ -71,6 +82,7 @@ private:
   inline void outbyte(unsigned int byte);
 
   FILE* fp;
+  SMmemoryOutput* memory;
 
   unsigned char* chars;
   int number_chars;
@@ -81,7 +93,7 @@ private:
   unsigned int help;          /* bytes_to_follow resp. intermediate value */
   unsigned char buffer;       /* buffer for input/output */
   /* the following is used only when encoding */
-  unsigned int bytecount;     /* counter for outputed bytes  */
+  I64 bytecount;              /* counter for outputed bytes  */
 };
 
 #endif
@@ -26,6 +26,7 @@
 ===============================================================================
 */
 #include "rangemodel.h"
+#include "smtrace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -228,7 +229,9 @@ void RangeModel::update(unsigned int sym)
 {
   if (left <= 0)
   {
+    SM_TRACE_BEGIN("RangeModel::dorescale", "model");
     dorescale();
+    SM_TRACE_END("RangeModel::dorescale", "model");
   }
   left--;
   newf[sym] += incr;
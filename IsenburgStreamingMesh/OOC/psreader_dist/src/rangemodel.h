@@ -19,6 +19,7 @@
   
   CHANGE HISTORY:
   
+    19 October 2026 -- rescales are recorded as spans when tracing
     28 June 2004 -- changed constant SEARCHSHIFT to variable searchshift
     28 June 2004 -- changed constant LG_TOTF to variable lg_totf
     28 June 2004 -- changed constant TARGETRESCALE to variable targetrescale
@@ -117,7 +117,7 @@ SMevent SMconverter::read_element()
       {
         if (v_count != nverts)
         {
-          fprintf(stderr,"ERROR: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+          fprintf(stderr,"ERROR: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
         }
       }
       if (nfaces == -1)
@@ -128,7 +128,7 @@ SMevent SMconverter::read_element()
       {
         if (f_count != nfaces)
         {
-          fprintf(stderr,"ERROR: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+          fprintf(stderr,"ERROR: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
         }
       }
       return SM_EOF;
@@ -144,7 +144,9 @@ SMevent SMconverter::read_element()
   }
   else if (have_triangle)
   {
-    VecCopy3iv(t_idx, psreader->t_idx);
+    t_idx[0] = psreader->t_idx[0];
+    t_idx[1] = psreader->t_idx[1];
+    t_idx[2] = psreader->t_idx[2];
     have_triangle = 0;
     f_count++;
     return SM_TRIANGLE;
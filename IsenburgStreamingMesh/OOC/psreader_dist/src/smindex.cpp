@@ -0,0 +1,485 @@
+/*
+===============================================================================
+
+  FILE:  SMindex.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smindex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec3fv.h"
+#include "smtrace.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+#define SMI_VERSION 3
+
+SMoffset sm_ftell(FILE* file)
+{
+#ifdef _WIN32
+  fpos_t pos;
+  if (fgetpos(file, &pos)) return -1;
+  return (SMoffset)pos;
+#else
+  return (SMoffset)ftello(file);
+#endif
+}
+
+bool sm_fseek(FILE* file, SMoffset offset)
+{
+#ifdef _WIN32
+  fpos_t pos = (fpos_t)offset;
+  return (fsetpos(file, &pos) == 0);
+#else
+  return (fseeko(file, (off_t)offset, SEEK_SET) == 0);
+#endif
+}
+
+typedef struct SMindexVertex
+{
+  SMindexVertex* buffer_next; // used for efficient memory management
+  float v[3];
+  int chunk;                  // the chunk it is in
+} SMindexVertex;
+
+#ifdef _WIN32
+typedef hash_map<SMidx, SMindexVertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMindexVertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMindexVertex*> > my_hash;
+#endif
+
+// the state of the builder is kept per index so that several indices can
+// be built on one thread
+
+struct SMindexer
+{
+  my_hash* vertex_hash;
+
+  // the chunk that is being built, its vertices (zero once finalized),
+  // and the vertices of earlier chunks that it finalizes
+
+  SMindexChunk chunk;
+  SMindexVertex** chunk_vertices;
+  int remove_alloc;
+  SMidx* remove_idx;
+
+  // efficient memory allocation. the blocks are only returned to the heap
+  // by the destructor.
+
+  int vertex_buffer_alloc;
+  SMindexVertex* vertex_buffer_next;
+  SMindexVertex** vertex_blocks;
+  int vertex_blocks_number;
+
+  SMindexVertex* allocVertex();
+  void deallocVertex(SMindexVertex* vertex);
+
+  void startChunk(SMidx v_count, SMidx f_count, SMoffset offset);
+  void updateBoundingBox(const float* v);
+
+  SMindexer(int chunk_size);
+  ~SMindexer();
+};
+
+SMindexer::SMindexer(int chunk_size)
+{
+  vertex_hash = new my_hash;
+
+  chunk.v_number = 0;
+  chunk.f_number = 0;
+  chunk_vertices = (SMindexVertex**)malloc(sizeof(SMindexVertex*)*chunk_size);
+  remove_alloc = 1024;
+  remove_idx = (SMidx*)malloc(sizeof(SMidx)*remove_alloc);
+
+  vertex_buffer_alloc = 1024;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_number = 0;
+}
+
+SMindexer::~SMindexer()
+{
+  for (int i = 0; i < vertex_blocks_number; i++)
+  {
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  delete vertex_hash;
+  free(chunk_vertices);
+  free(remove_idx);
+}
+
+// efficient memory allocation for vertices. every block is remembered so
+// that the destructor can give it back.
+
+SMindexVertex* SMindexer::allocVertex()
+{
+  if (vertex_buffer_next == 0)
+  {
+    vertex_buffer_next = (SMindexVertex*)malloc(sizeof(SMindexVertex)*vertex_buffer_alloc);
+    if (vertex_buffer_next == 0)
+    {
+      fprintf(stderr,"malloc for vertex buffer failed\n");
+      return 0;
+    }
+    vertex_blocks = (SMindexVertex**)realloc(vertex_blocks, sizeof(SMindexVertex*)*(vertex_blocks_number+1));
+    vertex_blocks[vertex_blocks_number] = vertex_buffer_next;
+    vertex_blocks_number++;
+    for (int i = 0; i < vertex_buffer_alloc; i++)
+    {
+      vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
+    }
+    vertex_buffer_next[vertex_buffer_alloc-1].buffer_next = 0;
+    vertex_buffer_alloc = 2*vertex_buffer_alloc;
+  }
+  // get pointer to next available vertex
+  SMindexVertex* vertex = vertex_buffer_next;
+  vertex_buffer_next = vertex->buffer_next;
+  return vertex;
+}
+
+void SMindexer::deallocVertex(SMindexVertex* vertex)
+{
+  vertex->buffer_next = vertex_buffer_next;
+  vertex_buffer_next = vertex;
+}
+
+void SMindexer::startChunk(SMidx v_count, SMidx f_count, SMoffset offset)
+{
+  chunk.offset = offset;
+  chunk.v_start = v_count;
+  chunk.f_start = f_count;
+  chunk.v_number = 0;
+  chunk.f_number = 0;
+  chunk.bb_min[0] = chunk.bb_min[1] = chunk.bb_min[2] = 1.0e+30f;
+  chunk.bb_max[0] = chunk.bb_max[1] = chunk.bb_max[2] = -1.0e+30f;
+  chunk.add_number = 0;
+  chunk.remove_number = 0;
+}
+
+void SMindexer::updateBoundingBox(const float* v)
+{
+  for (int i = 0; i < 3; i++)
+  {
+    if (v[i] < chunk.bb_min[i]) chunk.bb_min[i] = v[i];
+    if (v[i] > chunk.bb_max[i]) chunk.bb_max[i] = v[i];
+  }
+}
+
+bool SMindex::open_write(FILE* file, int chunk_size)
+{
+  int endian = 1;
+
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: zero file pointer not supported by SMindex\n");
+    return false;
+  }
+  if (chunk_size < 32)
+  {
+    fprintf(stderr,"ERROR: chunk size %d is less than one SMB block of 32 elements\n", chunk_size);
+    return false;
+  }
+  this->file = file;
+  this->chunk_size = ((chunk_size + 31) / 32) * 32;
+  nchunks = 0;
+  v_count = 0;
+  f_count = 0;
+  offset = -1;
+
+  // write magic, version, endianness, and chunk size
+  fputc('S', file);
+  fputc('M', file);
+  fputc('I', file);
+  fputc(SMI_VERSION, file);
+  fwrite(&endian, sizeof(int), 1, file);
+  fwrite(&(this->chunk_size), sizeof(int), 1, file);
+
+  if (indexer) delete indexer;
+  indexer = new SMindexer(this->chunk_size);
+
+  return true;
+}
+
+bool SMindex::chunk_full() const
+{
+  return ((v_count + f_count) % chunk_size) == 0;
+}
+
+void SMindex::set_offset(SMoffset offset)
+{
+  this->offset = offset;
+}
+
+// writes the chunk that is complete together with the vertices that it
+// adds to the front and those that it removes from it. the vertices it
+// adds are those that are not finalized by its own triangles. they are
+// stored by their position in the chunk.
+
+bool SMindex::write_chunk()
+{
+  int i;
+  SMoffset number;
+  SMindexChunk* chunk = &(indexer->chunk);
+  for (i = 0; i < chunk->v_number; i++)
+  {
+    if (indexer->chunk_vertices[i]) chunk->add_number++;
+  }
+  fwrite(&(chunk->offset), sizeof(SMoffset), 1, file);
+  number = chunk->v_start;
+  fwrite(&number, sizeof(SMoffset), 1, file);
+  number = chunk->f_start;
+  fwrite(&number, sizeof(SMoffset), 1, file);
+  fwrite(&(chunk->v_number), sizeof(int), 1, file);
+  fwrite(&(chunk->f_number), sizeof(int), 1, file);
+  fwrite(chunk->bb_min, sizeof(float), 3, file);
+  fwrite(chunk->bb_max, sizeof(float), 3, file);
+  fwrite(&(chunk->add_number), sizeof(int), 1, file);
+  fwrite(&(chunk->remove_number), sizeof(int), 1, file);
+  for (i = 0; i < chunk->v_number; i++)
+  {
+    if (indexer->chunk_vertices[i])
+    {
+      fwrite(&i, sizeof(int), 1, file);
+      fwrite(indexer->chunk_vertices[i]->v, sizeof(float), 3, file);
+    }
+  }
+  for (i = 0; i < chunk->remove_number; i++)
+  {
+    number = indexer->remove_idx[i];
+    fwrite(&number, sizeof(SMoffset), 1, file);
+  }
+  nchunks++;
+  return (ferror(file) == 0);
+}
+
+void SMindex::add_vertex(const float* v_pos_f)
+{
+  if (chunk_full())
+  {
+    if (v_count + f_count) write_chunk();
+    indexer->startChunk(v_count, f_count, offset);
+  }
+  SMindexVertex* vertex = indexer->allocVertex();
+  VecCopy3fv(vertex->v, v_pos_f);
+  vertex->chunk = nchunks;
+  sm_trace_hash_insert(indexer->vertex_hash, my_hash::value_type(v_count, vertex), "SMindex::vertex_hash");
+  indexer->chunk_vertices[indexer->chunk.v_number] = vertex;
+  indexer->updateBoundingBox(v_pos_f);
+  indexer->chunk.v_number++;
+  v_count++;
+}
+
+void SMindex::add_triangle(const SMidx* t_idx, const bool* t_final)
+{
+  int i;
+  my_hash::iterator hash_element;
+  SMindexVertex* vertex;
+
+  if (chunk_full())
+  {
+    if (v_count + f_count) write_chunk();
+    indexer->startChunk(v_count, f_count, offset);
+  }
+  for (i = 0; i < 3; i++)
+  {
+    hash_element = indexer->vertex_hash->find(t_idx[i]);
+    if (hash_element == indexer->vertex_hash->end())
+    {
+      fprintf(stderr,"FATAL ERROR: vertex " SM_IDX_FORMAT " not in hash. need pre-order mesh\n", t_idx[i]);
+      exit(0);
+    }
+    vertex = (*hash_element).second;
+    indexer->updateBoundingBox(vertex->v);
+    if (t_final[i])
+    {
+      if (vertex->chunk == nchunks)
+      {
+        // a vertex of this chunk never gets into the front
+        indexer->chunk_vertices[t_idx[i] - indexer->chunk.v_start] = 0;
+      }
+      else
+      {
+        // a vertex of an earlier chunk leaves the front with this chunk
+        if (indexer->chunk.remove_number == indexer->remove_alloc)
+        {
+          indexer->remove_alloc *= 2;
+          indexer->remove_idx = (SMidx*)realloc(indexer->remove_idx, sizeof(SMidx)*indexer->remove_alloc);
+        }
+        indexer->remove_idx[indexer->chunk.remove_number] = t_idx[i];
+        indexer->chunk.remove_number++;
+      }
+      indexer->vertex_hash->erase(hash_element);
+      indexer->deallocVertex(vertex);
+    }
+  }
+  indexer->chunk.f_number++;
+  f_count++;
+}
+
+bool SMindex::close_write()
+{
+  bool ok = true;
+
+  if (v_count + f_count) ok = write_chunk();
+
+  delete indexer;
+  indexer = 0;
+
+  fprintf(stderr,"indexed " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles in %d chunks of %d elements\n", v_count, f_count, nchunks, chunk_size);
+
+  file = 0;
+  return ok;
+}
+
+bool SMindex::read(FILE* file)
+{
+  int endian;
+  SMoffset number;
+  SMindexChunk chunk;
+
+  if (file == 0)
+  {
+    return false;
+  }
+  if (fgetc(file) != 'S' || fgetc(file) != 'M' || fgetc(file) != 'I')
+  {
+    fprintf(stderr,"ERROR: this is not an SMI file\n");
+    return false;
+  }
+  if (fgetc(file) != SMI_VERSION)
+  {
+    fprintf(stderr,"ERROR: wrong SMI version (need %d)\n", SMI_VERSION);
+    return false;
+  }
+  if (fread(&endian, sizeof(int), 1, file) != 1 || endian != 1)
+  {
+    fprintf(stderr,"ERROR: SMI file was written on a machine with another endianness\n");
+    return false;
+  }
+  fread(&chunk_size, sizeof(int), 1, file);
+  this->file = file;
+
+  nchunks = 0;
+  while (fread(&(chunk.offset), sizeof(SMoffset), 1, file) == 1)
+  {
+    fread(&number, sizeof(SMoffset), 1, file);
+    chunk.v_start = (SMidx)number;
+    fread(&number, sizeof(SMoffset), 1, file);
+    chunk.f_start = (SMidx)number;
+    fread(&(chunk.v_number), sizeof(int), 1, file);
+    fread(&(chunk.f_number), sizeof(int), 1, file);
+    fread(chunk.bb_min, sizeof(float), 3, file);
+    fread(chunk.bb_max, sizeof(float), 3, file);
+    fread(&(chunk.add_number), sizeof(int), 1, file);
+    if (fread(&(chunk.remove_number), sizeof(int), 1, file) != 1)
+    {
+      fprintf(stderr,"ERROR: SMI file is truncated after %d chunks\n", nchunks);
+      return false;
+    }
+    chunk.delta_offset = sm_ftell(file);
+    // skip the vertices that are added and removed. they are only read
+    // for the chunks up to the last one of a query
+    if (!sm_fseek(file, chunk.delta_offset + (SMoffset)chunk.add_number*(sizeof(int)+3*sizeof(float)) + (SMoffset)chunk.remove_number*sizeof(SMoffset)))
+    {
+      fprintf(stderr,"ERROR: SMI file is truncated after %d chunks\n", nchunks);
+      return false;
+    }
+    if (nchunks == chunks_alloc)
+    {
+      chunks_alloc = (chunks_alloc ? 2*chunks_alloc : 1024);
+      chunks = (SMindexChunk*)realloc(chunks, sizeof(SMindexChunk)*chunks_alloc);
+    }
+    chunks[nchunks] = chunk;
+    nchunks++;
+  }
+  return true;
+}
+
+// lists the chunks whose bounding box intersects the box of interest and
+// returns how many there are. the list must have space for all chunks.
+
+int SMindex::query(const float* roi_min, const float* roi_max, int* list) const
+{
+  int number = 0;
+  for (int c = 0; c < nchunks; c++)
+  {
+    if (chunks[c].bb_min[0] <= roi_max[0] && roi_min[0] <= chunks[c].bb_max[0] &&
+        chunks[c].bb_min[1] <= roi_max[1] && roi_min[1] <= chunks[c].bb_max[1] &&
+        chunks[c].bb_min[2] <= roi_max[2] && roi_min[2] <= chunks[c].bb_max[2])
+    {
+      list[number] = c;
+      number++;
+    }
+  }
+  return number;
+}
+
+// reads the vertices that a chunk adds to the front with their positions
+// and those that it removes from the front. the arrays must be large
+// enough for the numbers of the chunk.
+
+bool SMindex::read_delta(int c, SMidx* add_idx, float* add_pos, SMidx* remove_idx) const
+{
+  int i, offset;
+  SMoffset number;
+  if (!sm_fseek(file, chunks[c].delta_offset))
+  {
+    return false;
+  }
+  for (i = 0; i < chunks[c].add_number; i++)
+  {
+    if (fread(&offset, sizeof(int), 1, file) != 1) return false;
+    add_idx[i] = chunks[c].v_start + offset;
+    if (fread(&(add_pos[3*i]), sizeof(float), 3, file) != 3) return false;
+  }
+  for (i = 0; i < chunks[c].remove_number; i++)
+  {
+    if (fread(&number, sizeof(SMoffset), 1, file) != 1) return false;
+    remove_idx[i] = (SMidx)number;
+  }
+  return true;
+}
+
+SMindex::SMindex()
+{
+  chunk_size = 0;
+  nchunks = 0;
+  chunks = 0;
+  file = 0;
+  chunks_alloc = 0;
+  v_count = 0;
+  f_count = 0;
+  offset = -1;
+  indexer = 0;
+}
+
+SMindex::~SMindex()
+{
+  if (chunks) free(chunks);
+  if (indexer) delete indexer;
+}
@@ -0,0 +1,552 @@
+/*
+===============================================================================
+
+  FILE:  SMpipe.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smpipe.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "vec3fv.h"
+#include "smthread.h"
+
+// the elements are passed from the writer to the reader in blocks
+
+typedef struct SMpipeEvent
+{
+  int event;
+  union
+  {
+    float v[3];
+    SMidx idx[3];
+    SMidx final_idx;
+  };
+  bool final[3];
+} SMpipeEvent;
+
+typedef struct SMpipeBlock
+{
+  int number;
+  int alloc;
+  bool eof;
+  SMpipeEvent* events;
+} SMpipeBlock;
+
+// with a thread the writer fills the blocks in turn and hands each full
+// block to the reader, who gives it back once it has read all of its
+// elements. without a thread there is only one block, which grows to
+// hold whatever one call of the producer writes.
+
+struct SMpipeQueue
+{
+  SMproducer producer;
+  void* data;
+  SMwriter* writer;
+  bool threaded;
+  int blocks;
+  SMpipeBlock* block;
+  SMsemaphore full;
+  SMsemaphore empty;
+  int put_block;
+  SMpipeBlock* put;
+  bool eof;
+  volatile bool closed;
+  SMpipeEvent dropped;
+  int producer_waits;
+  int reader_waits;
+  SMthread thread;
+};
+
+static SMpipeQueue* allocQueue(SMproducer producer, void* data, bool threaded, int block_size, int blocks)
+{
+  int b;
+  SMpipeQueue* queue = (SMpipeQueue*)malloc(sizeof(SMpipeQueue));
+  queue->producer = producer;
+  queue->data = data;
+  queue->threaded = threaded;
+  queue->blocks = (threaded ? blocks : 1);
+  queue->block = (SMpipeBlock*)malloc(sizeof(SMpipeBlock)*queue->blocks);
+  for (b = 0; b < queue->blocks; b++)
+  {
+    queue->block[b].number = 0;
+    queue->block[b].alloc = block_size;
+    queue->block[b].eof = false;
+    queue->block[b].events = (SMpipeEvent*)malloc(sizeof(SMpipeEvent)*block_size);
+  }
+  if (threaded)
+  {
+    initSemaphore(&(queue->full), 0, blocks);
+    initSemaphore(&(queue->empty), blocks, blocks);
+    queue->put = 0;
+  }
+  else
+  {
+    queue->put = &(queue->block[0]);
+  }
+  queue->put_block = 0;
+  queue->eof = false;
+  queue->closed = false;
+  queue->producer_waits = 0;
+  queue->reader_waits = 0;
+  return queue;
+}
+
+static void deallocQueue(SMpipeQueue* queue)
+{
+  int b;
+  if (queue->threaded)
+  {
+    destroySemaphore(&(queue->full));
+    destroySemaphore(&(queue->empty));
+  }
+  for (b = 0; b < queue->blocks; b++)
+  {
+    free(queue->block[b].events);
+  }
+  free(queue->block);
+  free(queue);
+}
+
+static void handOver(SMpipeQueue* queue)
+{
+  postSemaphore(&(queue->full));
+  queue->put = 0;
+  queue->put_block = (queue->put_block + 1) % queue->blocks;
+}
+
+// a full block is only handed over when the next element is put because
+// the caller fills in the element after it was put. returns false once
+// the reader is gone.
+
+static bool nextBlock(SMpipeQueue* queue)
+{
+  if (queue->closed)
+  {
+    return false;
+  }
+  if (!queue->threaded)
+  {
+    if (queue->put->number == queue->put->alloc)
+    {
+      queue->put->alloc = 2*queue->put->alloc;
+      queue->put->events = (SMpipeEvent*)realloc(queue->put->events, sizeof(SMpipeEvent)*queue->put->alloc);
+    }
+    return true;
+  }
+  if (queue->put && queue->put->number == queue->put->alloc)
+  {
+    handOver(queue);
+  }
+  if (queue->put == 0)
+  {
+    if (waitSemaphore(&(queue->empty))) queue->producer_waits++;
+    if (queue->closed) return false;
+    queue->put = &(queue->block[queue->put_block]);
+    queue->put->number = 0;
+    queue->put->eof = false;
+  }
+  return true;
+}
+
+static SMpipeEvent* putEvent(SMpipeQueue* queue, int event)
+{
+  if (!nextBlock(queue)) return &(queue->dropped);
+  SMpipeEvent* pipe_event = &(queue->put->events[queue->put->number++]);
+  pipe_event->event = event;
+  return pipe_event;
+}
+
+static void putEOF(SMpipeQueue* queue)
+{
+  if (!nextBlock(queue)) return;
+  queue->put->eof = true;
+  if (queue->threaded) handOver(queue);
+}
+
+// the writer end of the pipe is what the producer writes into
+
+class SMpipeWriter : public SMwriter
+{
+public:
+  void add_comment(const char* comment);
+
+  void set_nverts(SMidx nverts);
+  void set_nfaces(SMidx nfaces);
+  void set_boundingbox(const float* bb_min_f, const float* bb_max_f);
+
+  void write_vertex(const float* v_pos_f);
+  void write_triangle(const SMidx* t_idx, const bool* t_final);
+  void write_triangle(const SMidx* t_idx);
+  void write_finalized(SMidx final_idx);
+
+  void close();
+
+  SMpipeWriter(SMpipeQueue* queue);
+  ~SMpipeWriter();
+
+private:
+  SMpipeQueue* queue;
+};
+
+void SMpipeWriter::add_comment(const char* comment)
+{
+  if (comments == 0)
+  {
+    comments = (char**)malloc(sizeof(char*)*10);
+    comments[9] = (char*)-1;
+  }
+  else if (comments[ncomments] == (char*)-1)
+  {
+    comments = (char**)realloc(comments,sizeof(char*)*ncomments*2);
+    comments[ncomments*2-1] = (char*)-1;
+  }
+  comments[ncomments] = strdup(comment);
+  ncomments++;
+}
+
+void SMpipeWriter::set_nverts(SMidx nverts)
+{
+  this->nverts = nverts;
+}
+
+void SMpipeWriter::set_nfaces(SMidx nfaces)
+{
+  this->nfaces = nfaces;
+}
+
+void SMpipeWriter::set_boundingbox(const float* bb_min_f, const float* bb_max_f)
+{
+  if (this->bb_min_f == 0) this->bb_min_f = new float[3];
+  if (this->bb_max_f == 0) this->bb_max_f = new float[3];
+  VecCopy3fv(this->bb_min_f, bb_min_f);
+  VecCopy3fv(this->bb_max_f, bb_max_f);
+}
+
+void SMpipeWriter::write_vertex(const float* v_pos_f)
+{
+  SMpipeEvent* pipe_event = putEvent(queue, SM_VERTEX);
+  VecCopy3fv(pipe_event->v, v_pos_f);
+  v_count++;
+}
+
+void SMpipeWriter::write_triangle(const SMidx* t_idx, const bool* t_final)
+{
+  SMpipeEvent* pipe_event = putEvent(queue, SM_TRIANGLE);
+  pipe_event->idx[0] = t_idx[0];
+  pipe_event->idx[1] = t_idx[1];
+  pipe_event->idx[2] = t_idx[2];
+  pipe_event->final[0] = t_final[0];
+  pipe_event->final[1] = t_final[1];
+  pipe_event->final[2] = t_final[2];
+  f_count++;
+}
+
+void SMpipeWriter::write_triangle(const SMidx* t_idx)
+{
+  bool t_final[3] = {false, false, false};
+  write_triangle(t_idx, t_final);
+}
+
+void SMpipeWriter::write_finalized(SMidx final_idx)
+{
+  SMpipeEvent* pipe_event = putEvent(queue, SM_FINALIZED);
+  pipe_event->final_idx = (final_idx < 0 ? v_count + final_idx : final_idx);
+}
+
+// may be called by the producer and again once it returned false
+
+void SMpipeWriter::close()
+{
+  if (queue->eof) return;
+  putEOF(queue);
+  queue->eof = true;
+  if (queue->closed) return;
+
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
+}
+
+SMpipeWriter::SMpipeWriter(SMpipeQueue* queue)
+{
+  // init of SMwriter interface
+  ncomments = 0;
+  comments = 0;
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = 0;
+  f_count = 0;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  // init of SMpipeWriter
+  this->queue = queue;
+}
+
+SMpipeWriter::~SMpipeWriter()
+{
+  int i;
+  for (i = 0; i < ncomments; i++)
+  {
+    free(comments[i]);
+  }
+  if (comments) free(comments);
+  if (bb_min_f) delete [] bb_min_f;
+  if (bb_max_f) delete [] bb_max_f;
+}
+
+
+// the worker calls the producer until it is done or the reader is gone
+
+static SM_THREAD_RESULT run_producer(void* arg)
+{
+  SMpipeQueue* queue = (SMpipeQueue*)arg;
+  while (!queue->closed && queue->producer(queue->writer, queue->data));
+  queue->writer->close();
+  return 0;
+}
+
+// without a worker the producer is called until it wrote something
+
+static void produce(SMpipeQueue* queue)
+{
+  queue->put->number = 0;
+  while (queue->put->number == 0 && !queue->eof)
+  {
+    if (!queue->producer(queue->writer, queue->data)) queue->writer->close();
+  }
+}
+
+bool SMpipe::open(SMproducer producer, void* data, bool thread, int block_size, int blocks)
+{
+  if (producer == 0)
+  {
+    fprintf(stderr,"ERROR: no producer\n");
+    return false;
+  }
+  if (block_size < 1 || blocks < 1)
+  {
+    fprintf(stderr,"ERROR: %d blocks of size %d cannot hold anything\n", blocks, block_size);
+    return false;
+  }
+
+  queue = allocQueue(producer, data, thread, block_size, blocks);
+  queue->writer = new SMpipeWriter(queue);
+
+  if (thread)
+  {
+    if (!startThread(&(queue->thread), run_producer, queue))
+    {
+      fprintf(stderr,"ERROR: cannot start the thread for the producer\n");
+      delete queue->writer;
+      deallocQueue(queue);
+      queue = 0;
+      return false;
+    }
+
+    // the header is known once the first block was handed over
+
+    if (waitSemaphore(&(queue->full))) queue->reader_waits++;
+  }
+  else
+  {
+    // the header is known once the first element was written
+
+    produce(queue);
+  }
+
+  get_block = 0;
+  next = 0;
+  have_finalized = next_finalized = 0;
+
+  ncomments = queue->writer->ncomments;
+  comments = queue->writer->comments;
+  nverts = queue->writer->nverts;
+  nfaces = queue->writer->nfaces;
+  bb_min_f = queue->writer->bb_min_f;
+  bb_max_f = queue->writer->bb_max_f;
+  post_order = (queue->block[0].number && queue->block[0].events[0].event == SM_TRIANGLE);
+
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+// returns false at the end of the stream
+
+bool SMpipe::next_block()
+{
+  SMpipeBlock* get = &(queue->block[get_block]);
+  while (next == get->number)
+  {
+    if (get->eof)
+    {
+      return false;
+    }
+    if (queue->threaded)
+    {
+      postSemaphore(&(queue->empty));
+      get_block = (get_block + 1) % queue->blocks;
+      if (waitSemaphore(&(queue->full))) queue->reader_waits++;
+      get = &(queue->block[get_block]);
+    }
+    else
+    {
+      produce(queue);
+    }
+    next = 0;
+  }
+  return true;
+}
+
+SMevent SMpipe::next_event()
+{
+  int i;
+
+  have_finalized = next_finalized = 0;
+
+  if (queue == 0 || !next_block())
+  {
+    nverts = v_count;
+    nfaces = f_count;
+    return SM_EOF;
+  }
+
+  SMpipeEvent* pipe_event = &(queue->block[get_block].events[next++]);
+  switch (pipe_event->event)
+  {
+  case SM_VERTEX:
+    VecCopy3fv(v_pos_f, pipe_event->v);
+    v_idx = v_count;
+    v_count++;
+    if (post_order) {finalized_vertices[have_finalized] = v_idx; have_finalized++;}
+    return SM_VERTEX;
+  case SM_TRIANGLE:
+    for (i = 0; i < 3; i++)
+    {
+      t_idx[i] = pipe_event->idx[i];
+      t_final[i] = pipe_event->final[i];
+      if (t_final[i])
+      {
+        finalized_vertices[have_finalized] = t_idx[i];
+        have_finalized++;
+      }
+    }
+    f_count++;
+    return SM_TRIANGLE;
+  default:
+    final_idx = pipe_event->final_idx;
+    return SM_FINALIZED;
+  }
+}
+
+SMevent SMpipe::read_element()
+{
+  SMevent event;
+  while ((event = next_event()) == SM_FINALIZED);
+  return event;
+}
+
+SMevent SMpipe::read_event()
+{
+  if (have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    have_finalized--; next_finalized++;
+    return SM_FINALIZED;
+  }
+  else
+  {
+    return next_event();
+  }
+}
+
+int SMpipe::get_producer_waits() const
+{
+  return (queue ? queue->producer_waits : producer_waits);
+}
+
+int SMpipe::get_reader_waits() const
+{
+  return (queue ? queue->reader_waits : reader_waits);
+}
+
+// a producer that is not done yet drops what else it writes and no
+// longer waits for the reader
+
+void SMpipe::close()
+{
+  if (queue)
+  {
+    if (queue->threaded)
+    {
+      queue->closed = true;
+      postSemaphore(&(queue->empty));
+      joinThread(&(queue->thread));
+    }
+    producer_waits = queue->producer_waits;
+    reader_waits = queue->reader_waits;
+    delete queue->writer;
+    deallocQueue(queue);
+    queue = 0;
+  }
+  ncomments = 0;
+  comments = 0;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  v_count = -1;
+  f_count = -1;
+}
+
+SMpipe::SMpipe()
+{
+  // init of SMreader interface
+  ncomments = 0;
+  comments = 0;
+  nverts = -1;
+  nfaces = -1;
+  v_count = -1;
+  f_count = -1;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  post_order = false;
+
+  // init of SMpipe
+  queue = 0;
+  get_block = 0;
+  next = 0;
+  have_finalized = next_finalized = 0;
+  producer_waits = 0;
+  reader_waits = 0;
+}
+
+SMpipe::~SMpipe()
+{
+  if (queue) close();
+}
@@ -0,0 +1,1127 @@
+/*
+===============================================================================
+
+  FILE:  SMreadClustered.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreadclustered.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "vec3fv.h"
+#include "smstats.h"
+#include "smtrace.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+struct SMtriangle;
+
+typedef struct SMcell
+{
+  SMcell* buffer_next;          // used for efficient memory management and the output queue
+  SMcell* waiting_prev;         // the cells whose vertices are all finalized wait in a list
+  SMcell* waiting_next;
+  int key;                      // the position of the cell in the grid
+  double q[10];                 // the quadric as A (6), b (3), and c (1)
+  float sum[3];                 // the sum of its vertices
+  int number;                   // how many vertices fell into it
+  int live;                     // how many of them are not finalized yet
+  bool waiting;
+  bool retired;
+  SMidx index;                  // the index in the output
+  int pending;                  // its triangles that were not yet passed on
+  SMtriangle* first_triangle;   // its triangles are linked through their corners
+  int first_corner;
+  SMtriangle* first_owned;      // the triangles that start with this cell
+} SMcell;
+
+typedef struct SMtriangle
+{
+  SMtriangle* buffer_next;      // used for efficient memory management and the output queue
+  SMcell* cells[3];             // rotated so that the cell with the smallest key comes first
+  SMtriangle* next_triangle[3]; // the next triangle around cells[i]
+  int next_corner[3];
+  SMtriangle* next_owned;       // the next triangle that starts with cells[0]
+  int ready;                    // how many of its cells are retired
+} SMtriangle;
+
+typedef struct SMinput
+{
+  SMinput* buffer_next;         // used for efficient memory management
+  float v[3];
+  SMcell* cell;
+} SMinput;
+
+#ifdef _WIN32
+typedef hash_map<SMidx, SMinput*> my_input_hash;
+typedef hash_map<int, SMcell*> my_cell_hash;
+#else
+typedef hash_map<SMidx, SMinput*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMinput*> > my_input_hash;
+typedef hash_map<int, SMcell*, __gnu_cxx::hash<int>, std::equal_to<int>, PoolAllocator<SMcell*> > my_cell_hash;
+#endif
+
+// the state of the clustering is kept per reader so that several of them
+// can be used on one thread and so that its statistics can be queried from
+// another thread
+
+struct SMclusterer
+{
+  my_input_hash* input_hash;
+  my_cell_hash* cell_hash;
+
+  // cells and triangles that are ready to be passed on. cells go first.
+
+  SMcell* output_cell_first;
+  SMcell* output_cell_last;
+  SMtriangle* output_triangle_first;
+  SMtriangle* output_triangle_last;
+
+  // cells whose vertices are all finalized. the oldest is retired first.
+
+  SMcell* waiting_first;
+  SMcell* waiting_last;
+  int waiting_number;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_in_width;
+  int stat_cell_buffer;
+  int stat_triangle_buffer;
+  int stat_waiting;
+  int stat_degenerate;
+  int stat_duplicate;
+  int stat_feature;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int input_buffer_size;
+  int input_buffer_alloc;
+  SMinput* input_buffer_next;
+  SMinput** input_blocks;
+  int input_blocks_number;
+
+  int cell_buffer_size;
+  int cell_buffer_alloc;
+  SMcell* cell_buffer_next;
+  SMcell** cell_blocks;
+  int cell_blocks_number;
+
+  int triangle_buffer_size;
+  int triangle_buffer_alloc;
+  SMtriangle* triangle_buffer_next;
+  SMtriangle** triangle_blocks;
+  int triangle_blocks_number;
+
+  int initInputBuffer(int size);
+  SMinput* allocInputBlock(int size);
+  SMinput* allocInput();
+  void deallocInput(SMinput* input);
+  int initCellBuffer(int size);
+  SMcell* allocCellBlock(int size);
+  SMcell* allocCell(int key);
+  void deallocCell(SMcell* cell);
+  int initTriangleBuffer(int size);
+  SMtriangle* allocTriangleBlock(int size);
+  SMtriangle* allocTriangle();
+  void deallocTriangle(SMtriangle* triangle);
+
+  void addWaiting(SMcell* cell);
+  void removeWaiting(SMcell* cell);
+  void placeCell(SMcell* cell, float* pos, const float* bb_min, const float* bb_max, float cell_size, int resolution);
+  void retireCell(SMcell* cell);
+  void finalizeInput(SMinput* input);
+
+  SMclusterer();
+  ~SMclusterer();
+};
+
+SMclusterer::SMclusterer()
+{
+  input_hash = 0;
+  cell_hash = 0;
+
+  output_cell_first = output_cell_last = 0;
+  output_triangle_first = output_triangle_last = 0;
+  waiting_first = waiting_last = 0;
+  waiting_number = 0;
+
+  stats = 0;
+
+  input_buffer_size = 0;
+  input_buffer_alloc = 1024;
+  input_buffer_next = 0;
+  input_blocks = 0;
+  input_blocks_number = 0;
+
+  cell_buffer_size = 0;
+  cell_buffer_alloc = 1024;
+  cell_buffer_next = 0;
+  cell_blocks = 0;
+  cell_blocks_number = 0;
+
+  triangle_buffer_size = 0;
+  triangle_buffer_alloc = 1024;
+  triangle_buffer_next = 0;
+  triangle_blocks = 0;
+  triangle_blocks_number = 0;
+}
+
+SMclusterer::~SMclusterer()
+{
+  int i;
+  for (i = 0; i < input_blocks_number; i++)
+  {
+    free(input_blocks[i]);
+  }
+  if (input_blocks) free(input_blocks);
+  for (i = 0; i < cell_blocks_number; i++)
+  {
+    free(cell_blocks[i]);
+  }
+  if (cell_blocks) free(cell_blocks);
+  for (i = 0; i < triangle_blocks_number; i++)
+  {
+    free(triangle_blocks[i]);
+  }
+  if (triangle_blocks) free(triangle_blocks);
+  if (input_hash) delete input_hash;
+  if (cell_hash) delete cell_hash;
+  if (stats) delete stats;
+}
+
+// efficient memory allocation for input vertices. every block is remembered
+// so that the destructor can give it back.
+
+SMinput* SMclusterer::allocInputBlock(int size)
+{
+  SMinput* block = (SMinput*)malloc(sizeof(SMinput)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for input buffer failed\n");
+    return 0;
+  }
+  input_blocks = (SMinput**)realloc(input_blocks, sizeof(SMinput*)*(input_blocks_number+1));
+  input_blocks[input_blocks_number] = block;
+  input_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMclusterer::initInputBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (input_buffer_next)
+  {
+    input_buffer_size = 0;
+    return 1;
+  }
+
+  input_buffer_next = allocInputBlock(size);
+
+  if (input_buffer_next == 0)
+  {
+    return 0;
+  }
+  input_buffer_alloc = size;
+  input_buffer_size = 0;
+  return 1;
+}
+
+SMinput* SMclusterer::allocInput()
+{
+  if (input_buffer_next == 0)
+  {
+    input_buffer_next = allocInputBlock(input_buffer_alloc);
+    if (input_buffer_next == 0)
+    {
+      return 0;
+    }
+    input_buffer_alloc = 2*input_buffer_alloc;
+  }
+  // get pointer to next available input vertex
+  SMinput* input = input_buffer_next;
+  input_buffer_next = input->buffer_next;
+
+  input_buffer_size++;
+
+  return input;
+}
+
+void SMclusterer::deallocInput(SMinput* input)
+{
+  input->buffer_next = input_buffer_next;
+  input_buffer_next = input;
+  input_buffer_size--;
+}
+
+// efficient memory allocation for cells
+
+SMcell* SMclusterer::allocCellBlock(int size)
+{
+  SMcell* block = (SMcell*)malloc(sizeof(SMcell)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for cell buffer failed\n");
+    return 0;
+  }
+  cell_blocks = (SMcell**)realloc(cell_blocks, sizeof(SMcell*)*(cell_blocks_number+1));
+  cell_blocks[cell_blocks_number] = block;
+  cell_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMclusterer::initCellBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (cell_buffer_next)
+  {
+    cell_buffer_size = 0;
+    return 1;
+  }
+
+  cell_buffer_next = allocCellBlock(size);
+
+  if (cell_buffer_next == 0)
+  {
+    return 0;
+  }
+  cell_buffer_alloc = size;
+  cell_buffer_size = 0;
+  return 1;
+}
+
+SMcell* SMclusterer::allocCell(int key)
+{
+  if (cell_buffer_next == 0)
+  {
+    cell_buffer_next = allocCellBlock(cell_buffer_alloc);
+    if (cell_buffer_next == 0)
+    {
+      return 0;
+    }
+    cell_buffer_alloc = 2*cell_buffer_alloc;
+  }
+  // get pointer to next available cell
+  SMcell* cell = cell_buffer_next;
+  cell_buffer_next = cell->buffer_next;
+
+  cell->key = key;
+  memset(cell->q, 0, sizeof(double)*10);
+  VecZero3fv(cell->sum);
+  cell->number = 0;
+  cell->live = 0;
+  cell->waiting = false;
+  cell->retired = false;
+  cell->index = -1;
+  cell->pending = 0;
+  cell->first_triangle = 0;
+  cell->first_owned = 0;
+
+  cell_buffer_size++;
+
+  stats->level(stat_cell_buffer, cell_buffer_size);
+
+  return cell;
+}
+
+void SMclusterer::deallocCell(SMcell* cell)
+{
+  cell->buffer_next = cell_buffer_next;
+  cell_buffer_next = cell;
+  cell_buffer_size--;
+  stats->down(stat_cell_buffer);
+}
+
+// efficient memory allocation for triangles
+
+SMtriangle* SMclusterer::allocTriangleBlock(int size)
+{
+  SMtriangle* block = (SMtriangle*)malloc(sizeof(SMtriangle)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for triangle buffer failed\n");
+    return 0;
+  }
+  triangle_blocks = (SMtriangle**)realloc(triangle_blocks, sizeof(SMtriangle*)*(triangle_blocks_number+1));
+  triangle_blocks[triangle_blocks_number] = block;
+  triangle_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMclusterer::initTriangleBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (triangle_buffer_next)
+  {
+    triangle_buffer_size = 0;
+    return 1;
+  }
+
+  triangle_buffer_next = allocTriangleBlock(size);
+
+  if (triangle_buffer_next == 0)
+  {
+    return 0;
+  }
+  triangle_buffer_alloc = size;
+  triangle_buffer_size = 0;
+  return 1;
+}
+
+SMtriangle* SMclusterer::allocTriangle()
+{
+  if (triangle_buffer_next == 0)
+  {
+    triangle_buffer_next = allocTriangleBlock(triangle_buffer_alloc);
+    if (triangle_buffer_next == 0)
+    {
+      return 0;
+    }
+    triangle_buffer_alloc = 2*triangle_buffer_alloc;
+  }
+  // get pointer to next available triangle
+  SMtriangle* triangle = triangle_buffer_next;
+  triangle_buffer_next = triangle->buffer_next;
+
+  triangle->ready = 0;
+
+  triangle_buffer_size++;
+
+  stats->level(stat_triangle_buffer, triangle_buffer_size);
+
+  return triangle;
+}
+
+void SMclusterer::deallocTriangle(SMtriangle* triangle)
+{
+  triangle->buffer_next = triangle_buffer_next;
+  triangle_buffer_next = triangle;
+  triangle_buffer_size--;
+  stats->down(stat_triangle_buffer);
+}
+
+// the list of cells that wait to be retired
+
+void SMclusterer::addWaiting(SMcell* cell)
+{
+  cell->waiting = true;
+  cell->waiting_next = 0;
+  cell->waiting_prev = waiting_last;
+  if (waiting_last)
+  {
+    waiting_last->waiting_next = cell;
+  }
+  else
+  {
+    waiting_first = cell;
+  }
+  waiting_last = cell;
+  waiting_number++;
+  stats->level(stat_waiting, waiting_number);
+}
+
+void SMclusterer::removeWaiting(SMcell* cell)
+{
+  cell->waiting = false;
+  if (cell->waiting_prev)
+  {
+    cell->waiting_prev->waiting_next = cell->waiting_next;
+  }
+  else
+  {
+    waiting_first = cell->waiting_next;
+  }
+  if (cell->waiting_next)
+  {
+    cell->waiting_next->waiting_prev = cell->waiting_prev;
+  }
+  else
+  {
+    waiting_last = cell->waiting_prev;
+  }
+  waiting_number--;
+  stats->down(stat_waiting);
+}
+
+// the eigenvalues w and eigenvectors (the columns of v) of the symmetric
+// matrix a using Jacobi rotations. a is destroyed.
+
+static void eigen3(double a[3][3], double w[3], double v[3][3])
+{
+  int i, j, k, p, q, sweep;
+  for (i = 0; i < 3; i++)
+  {
+    for (j = 0; j < 3; j++)
+    {
+      v[i][j] = (i == j ? 1.0 : 0.0);
+    }
+  }
+  for (sweep = 0; sweep < 32; sweep++)
+  {
+    double off = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+    if (off < 1e-30)
+    {
+      break;
+    }
+    for (p = 0; p < 2; p++)
+    {
+      for (q = p+1; q < 3; q++)
+      {
+        if (a[p][q] == 0.0)
+        {
+          continue;
+        }
+        double theta = (a[q][q] - a[p][p]) / (2.0*a[p][q]);
+        double t = (theta >= 0.0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta*theta + 1.0));
+        double c = 1.0 / sqrt(t*t + 1.0);
+        double s = t*c;
+        for (k = 0; k < 3; k++)
+        {
+          double akp = a[k][p];
+          double akq = a[k][q];
+          a[k][p] = c*akp - s*akq;
+          a[k][q] = s*akp + c*akq;
+        }
+        for (k = 0; k < 3; k++)
+        {
+          double apk = a[p][k];
+          double aqk = a[q][k];
+          a[p][k] = c*apk - s*aqk;
+          a[q][k] = s*apk + c*aqk;
+        }
+        for (k = 0; k < 3; k++)
+        {
+          double vkp = v[k][p];
+          double vkq = v[k][q];
+          v[k][p] = c*vkp - s*vkq;
+          v[k][q] = s*vkp + c*vkq;
+        }
+      }
+    }
+  }
+  for (i = 0; i < 3; i++)
+  {
+    w[i] = a[i][i];
+  }
+}
+
+// places the representative of a cell. starting from the average of its
+// vertices we move along those directions in which the quadric is well
+// defined (e.g. the pseudo-inverse with small eigenvalues truncated). if the
+// result leaves the cell we stay with the average.
+
+void SMclusterer::placeCell(SMcell* cell, float* pos, const float* bb_min, const float* bb_max, float cell_size, int resolution)
+{
+  int i, j;
+  double mean[3];
+  for (i = 0; i < 3; i++)
+  {
+    mean[i] = cell->sum[i] / cell->number;
+  }
+
+  double* q = cell->q;
+  double a[3][3] = {{q[0], q[1], q[2]}, {q[1], q[3], q[4]}, {q[2], q[4], q[5]}};
+  double r[3];
+  for (i = 0; i < 3; i++)
+  {
+    r[i] = q[6+i] - (a[i][0]*mean[0] + a[i][1]*mean[1] + a[i][2]*mean[2]);
+  }
+
+  double w[3], v[3][3];
+  eigen3(a, w, v);
+  double w_max = fabs(w[0]);
+  if (fabs(w[1]) > w_max) w_max = fabs(w[1]);
+  if (fabs(w[2]) > w_max) w_max = fabs(w[2]);
+
+  double x[3] = {mean[0], mean[1], mean[2]};
+  int rank = 0;
+  for (j = 0; j < 3; j++)
+  {
+    if (w_max > 0.0 && fabs(w[j]) > 1e-3*w_max)
+    {
+      double d = (v[0][j]*r[0] + v[1][j]*r[1] + v[2][j]*r[2]) / w[j];
+      for (i = 0; i < 3; i++)
+      {
+        x[i] += d*v[i][j];
+      }
+      rank++;
+    }
+  }
+
+  int c[3] = {cell->key >> 20, (cell->key >> 10) & 1023, cell->key & 1023};
+  bool inside = true;
+  for (i = 0; i < 3; i++)
+  {
+    double lo = bb_min[i] + c[i]*cell_size;
+    double hi = (c[i] == resolution-1 ? bb_max[i] : lo + cell_size);
+    if (hi > bb_max[i]) hi = bb_max[i];
+    if (x[i] < lo || x[i] > hi) inside = false;
+  }
+  if (!inside)
+  {
+    x[0] = mean[0]; x[1] = mean[1]; x[2] = mean[2];
+  }
+  else if (rank > 1)
+  {
+    stats->count(stat_feature);
+  }
+  for (i = 0; i < 3; i++)
+  {
+    pos[i] = (float)x[i];
+  }
+}
+
+// a retired cell gets no more vertices. it is ready to be passed on and so
+// are those of its triangles whose three cells are now all retired. a cell
+// without any triangles is simply dropped.
+
+void SMclusterer::retireCell(SMcell* cell)
+{
+  cell->retired = true;
+  cell_hash->erase(cell->key);
+  cell->first_owned = 0;
+
+  if (cell->pending == 0)
+  {
+    deallocCell(cell);
+    return;
+  }
+
+  cell->buffer_next = 0;
+  if (output_cell_last)
+  {
+    output_cell_last->buffer_next = cell;
+  }
+  else
+  {
+    output_cell_first = cell;
+  }
+  output_cell_last = cell;
+
+  SMtriangle* triangle = cell->first_triangle;
+  int corner = cell->first_corner;
+  while (triangle)
+  {
+    triangle->ready++;
+    if (triangle->ready == 3)
+    {
+      triangle->buffer_next = 0;
+      if (output_triangle_last)
+      {
+        output_triangle_last->buffer_next = triangle;
+      }
+      else
+      {
+        output_triangle_first = triangle;
+      }
+      output_triangle_last = triangle;
+    }
+    SMtriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+}
+
+// an input vertex is finalized. once all vertices of its cell are, the cell
+// waits to be retired.
+
+void SMclusterer::finalizeInput(SMinput* input)
+{
+  SMcell* cell = input->cell;
+  deallocInput(input);
+  cell->live--;
+  if (cell->live == 0)
+  {
+    addWaiting(cell);
+  }
+}
+
+bool SMreadClustered::open(SMreader* smreader, int resolution, int memory, const float* bb_min, const float* bb_max)
+{
+  if (smreader == 0 || smreader->post_order)
+  {
+    return false;
+  }
+  if ((bb_min == 0 || bb_max == 0) && (smreader->bb_min_f == 0 || smreader->bb_max_f == 0))
+  {
+    fprintf(stderr,"ERROR: SMreadClustered needs the bounding box of the input\n");
+    return false;
+  }
+  if (resolution <= 0 && memory <= 0)
+  {
+    fprintf(stderr,"ERROR: SMreadClustered needs a resolution or a memory budget\n");
+    return false;
+  }
+  this->smreader = smreader;
+  eof = false;
+
+  // the output size is not known in advance
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = 0;
+  f_count = 0;
+
+  // the representatives stay inside the bounding box of the input
+
+  VecCopy3fv(grid_min, (bb_min && bb_max ? bb_min : smreader->bb_min_f));
+  VecCopy3fv(grid_max, (bb_min && bb_max ? bb_max : smreader->bb_max_f));
+  bb_min_f = grid_min;
+  bb_max_f = grid_max;
+
+  // for a surface the stream front crosses in the order of 'resolution'
+  // cells. we leave room for several such fronts before retiring cells.
+
+  if (memory > 0)
+  {
+    int cell_bytes = sizeof(SMcell) + 2*sizeof(SMtriangle) + 4*sizeof(void*);
+    max_cells = (int)(((double)memory)*1024*1024/cell_bytes);
+    max_waiting = max_cells;
+    if (resolution <= 0)
+    {
+      resolution = max_cells / 16;
+    }
+  }
+  else
+  {
+    max_cells = 0x7FFFFFFF;
+    max_waiting = 4*resolution;
+  }
+  if (resolution < 1) resolution = 1;
+  if (resolution > SM_CLUSTERED_MAX_RESOLUTION) resolution = SM_CLUSTERED_MAX_RESOLUTION;
+  this->resolution = resolution;
+
+  float extent = bb_max_f[0] - bb_min_f[0];
+  if (bb_max_f[1] - bb_min_f[1] > extent) extent = bb_max_f[1] - bb_min_f[1];
+  if (bb_max_f[2] - bb_min_f[2] > extent) extent = bb_max_f[2] - bb_min_f[2];
+  cell_size = (extent > 0.0f ? extent / resolution : 1.0f);
+
+  have_finalized = next_finalized = 0;
+
+  if (clusterer->input_hash) delete clusterer->input_hash;
+  clusterer->input_hash = new my_input_hash;
+  if (clusterer->cell_hash) delete clusterer->cell_hash;
+  clusterer->cell_hash = new my_cell_hash;
+
+  clusterer->output_cell_first = clusterer->output_cell_last = 0;
+  clusterer->output_triangle_first = clusterer->output_triangle_last = 0;
+  clusterer->waiting_first = clusterer->waiting_last = 0;
+  clusterer->waiting_number = 0;
+
+  if (clusterer->stats == 0)
+  {
+    clusterer->stats = new SMstats("SMreadClustered");
+    clusterer->stat_in_width = clusterer->stats->add("in_width", SM_STATS_LEVEL);
+    clusterer->stat_cell_buffer = clusterer->stats->add("cell_buffer", SM_STATS_LEVEL);
+    clusterer->stat_triangle_buffer = clusterer->stats->add("triangle_buffer", SM_STATS_LEVEL);
+    clusterer->stat_waiting = clusterer->stats->add("waiting_cells", SM_STATS_LEVEL);
+    clusterer->stat_degenerate = clusterer->stats->add("degenerate_triangles", SM_STATS_COUNTER);
+    clusterer->stat_duplicate = clusterer->stats->add("duplicate_triangles", SM_STATS_COUNTER);
+    clusterer->stat_feature = clusterer->stats->add("feature_cells", SM_STATS_COUNTER);
+  }
+  clusterer->stats->reset();
+
+  if (!clusterer->initInputBuffer(1024) || !clusterer->initCellBuffer(1024) || !clusterer->initTriangleBuffer(2048))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void SMreadClustered::close()
+{
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  smreader->close();
+
+  // put whatever was not passed on back on the free lists
+
+  my_input_hash::iterator input_element;
+  for (input_element = clusterer->input_hash->begin(); input_element != clusterer->input_hash->end(); input_element++)
+  {
+    clusterer->finalizeInput((*input_element).second);
+  }
+  delete clusterer->input_hash;
+  clusterer->input_hash = 0;
+
+  while (clusterer->waiting_first)
+  {
+    SMcell* cell = clusterer->waiting_first;
+    clusterer->removeWaiting(cell);
+    clusterer->retireCell(cell);
+  }
+  delete clusterer->cell_hash;
+  clusterer->cell_hash = 0;
+
+  while (clusterer->output_triangle_first)
+  {
+    SMtriangle* triangle = clusterer->output_triangle_first;
+    clusterer->output_triangle_first = triangle->buffer_next;
+    for (int i = 0; i < 3; i++)
+    {
+      triangle->cells[i]->pending--;
+      if (triangle->cells[i]->pending == 0 && triangle->cells[i]->index != -1)
+      {
+        clusterer->deallocCell(triangle->cells[i]);
+      }
+    }
+    clusterer->deallocTriangle(triangle);
+  }
+  while (clusterer->output_cell_first)
+  {
+    SMcell* cell = clusterer->output_cell_first;
+    clusterer->output_cell_first = cell->buffer_next;
+    if (cell->pending == 0)
+    {
+      clusterer->deallocCell(cell);
+    }
+  }
+  clusterer->output_cell_last = 0;
+  clusterer->output_triangle_last = 0;
+}
+
+const SMstats* SMreadClustered::get_stats() const
+{
+  return clusterer->stats;
+}
+
+// reads from the input until something is ready to be passed on. returns
+// 1 if so, 0 at the end of the input, and -1 on error.
+
+int SMreadClustered::read_input()
+{
+  int i;
+  SMinput* input;
+  SMcell* cell;
+  SMtriangle* triangle;
+  my_input_hash::iterator input_element;
+  my_cell_hash::iterator cell_element;
+
+  while (clusterer->output_cell_first == 0 && clusterer->output_triangle_first == 0)
+  {
+    if (eof)
+    {
+      return 0;
+    }
+
+    // retire the cells that were waiting the longest
+
+    while (clusterer->waiting_first && (clusterer->waiting_number > max_waiting || clusterer->cell_buffer_size > max_cells))
+    {
+      cell = clusterer->waiting_first;
+      clusterer->removeWaiting(cell);
+      clusterer->retireCell(cell);
+    }
+    if (clusterer->output_cell_first || clusterer->output_triangle_first)
+    {
+      break;
+    }
+
+    SMevent event = smreader->read_element();
+
+    if (event == SM_VERTEX)
+    {
+      int c[3];
+      for (i = 0; i < 3; i++)
+      {
+        c[i] = (int)((smreader->v_pos_f[i] - bb_min_f[i]) / cell_size);
+        if (c[i] < 0) c[i] = 0;
+        else if (c[i] >= resolution) c[i] = resolution - 1;
+      }
+      int key = (c[0] << 20) | (c[1] << 10) | c[2];
+
+      cell_element = clusterer->cell_hash->find(key);
+      if (cell_element == clusterer->cell_hash->end())
+      {
+        cell = clusterer->allocCell(key);
+        clusterer->cell_hash->insert(my_cell_hash::value_type(key, cell));
+      }
+      else
+      {
+        cell = (*cell_element).second;
+        if (cell->waiting) clusterer->removeWaiting(cell);
+      }
+      VecSelfAdd3fv(cell->sum, smreader->v_pos_f);
+      cell->number++;
+      cell->live++;
+
+      input = clusterer->allocInput();
+      VecCopy3fv(input->v, smreader->v_pos_f);
+      input->cell = cell;
+      sm_trace_hash_insert(clusterer->input_hash, my_input_hash::value_type(smreader->v_idx, input), "SMreadClustered::input_hash");
+      clusterer->stats->level(clusterer->stat_in_width, clusterer->input_hash->size());
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      SMinput* inputs[3];
+      for (i = 0; i < 3; i++)
+      {
+        input_element = clusterer->input_hash->find(smreader->t_idx[i]);
+        // vertices must preceed triangles in a pre-order mesh
+        if (input_element == clusterer->input_hash->end())
+        {
+          fprintf(stderr, "FATAL ERROR: triangle vertex not in hash. corrupt pre-order mesh.\n");
+          return -1;
+        }
+        inputs[i] = (*input_element).second;
+      }
+
+      // the plane quadric of the triangle weighted by its area goes to all three cells
+
+      float normal[3];
+      VecCcwNormal3fv(normal, inputs[0]->v, inputs[1]->v, inputs[2]->v);
+      double length = VecLength3fv(normal);
+      if (length > 0.0)
+      {
+        double area = 0.5*length;
+        double n[3] = {normal[0]/length, normal[1]/length, normal[2]/length};
+        double d = -(n[0]*inputs[0]->v[0] + n[1]*inputs[0]->v[1] + n[2]*inputs[0]->v[2]);
+        for (i = 0; i < 3; i++)
+        {
+          double* q = inputs[i]->cell->q;
+          q[0] += area*n[0]*n[0]; q[1] += area*n[0]*n[1]; q[2] += area*n[0]*n[2];
+          q[3] += area*n[1]*n[1]; q[4] += area*n[1]*n[2]; q[5] += area*n[2]*n[2];
+          q[6] -= area*d*n[0]; q[7] -= area*d*n[1]; q[8] -= area*d*n[2];
+          q[9] += area*d*d;
+        }
+      }
+
+      SMcell* cells[3] = {inputs[0]->cell, inputs[1]->cell, inputs[2]->cell};
+
+      if (cells[0] == cells[1] || cells[0] == cells[2] || cells[1] == cells[2])
+      {
+        clusterer->stats->count(clusterer->stat_degenerate);
+      }
+      else
+      {
+        // rotate (keeping the orientation) so that the smallest key comes first
+
+        int first = 0;
+        if (cells[1]->key < cells[first]->key) first = 1;
+        if (cells[2]->key < cells[first]->key) first = 2;
+        SMcell* c0 = cells[first];
+        SMcell* c1 = cells[(first+1)%3];
+        SMcell* c2 = cells[(first+2)%3];
+
+        triangle = c0->first_owned;
+        while (triangle && (triangle->cells[1] != c1 || triangle->cells[2] != c2))
+        {
+          triangle = triangle->next_owned;
+        }
+        if (triangle)
+        {
+          clusterer->stats->count(clusterer->stat_duplicate);
+        }
+        else
+        {
+          triangle = clusterer->allocTriangle();
+          triangle->cells[0] = c0;
+          triangle->cells[1] = c1;
+          triangle->cells[2] = c2;
+          triangle->next_owned = c0->first_owned;
+          c0->first_owned = triangle;
+          for (i = 0; i < 3; i++)
+          {
+            cell = triangle->cells[i];
+            // link the corner into the list of the cell
+            triangle->next_triangle[i] = cell->first_triangle;
+            triangle->next_corner[i] = cell->first_corner;
+            cell->first_triangle = triangle;
+            cell->first_corner = i;
+            cell->pending++;
+          }
+        }
+      }
+
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader->t_final[i] && clusterer->input_hash->erase(smreader->t_idx[i]))
+        {
+          clusterer->finalizeInput(inputs[i]);
+        }
+      }
+    }
+    else if (event == SM_FINALIZED)
+    {
+      input_element = clusterer->input_hash->find(smreader->final_idx);
+      // vertices must preceed their finalization in a pre-order mesh
+      if (input_element == clusterer->input_hash->end())
+      {
+        fprintf(stderr, "FATAL ERROR: finalized vertex not in hash. corrupt pre-order mesh.\n");
+        return -1;
+      }
+      input = (*input_element).second;
+      clusterer->input_hash->erase(input_element);
+      clusterer->finalizeInput(input);
+    }
+    else if (event == SM_EOF)
+    {
+      // all remaining vertices are implicitely finalized
+      for (input_element = clusterer->input_hash->begin(); input_element != clusterer->input_hash->end(); input_element++)
+      {
+        clusterer->finalizeInput((*input_element).second);
+      }
+      clusterer->input_hash->clear();
+      while (clusterer->waiting_first)
+      {
+        cell = clusterer->waiting_first;
+        clusterer->removeWaiting(cell);
+        clusterer->retireCell(cell);
+      }
+      eof = true;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+SMevent SMreadClustered::read_element()
+{
+  int i;
+  SMcell* cell;
+
+  have_finalized = next_finalized = 0;
+
+  int ok = read_input();
+  if (ok <= 0)
+  {
+    return (ok == 0 ? SM_EOF : SM_ERROR);
+  }
+
+  if (clusterer->output_cell_first)
+  {
+    cell = clusterer->output_cell_first;
+    clusterer->output_cell_first = cell->buffer_next;
+    if (clusterer->output_cell_first == 0) clusterer->output_cell_last = 0;
+
+    cell->index = v_count;
+    v_idx = v_count;
+    clusterer->placeCell(cell, v_pos_f, bb_min_f, bb_max_f, cell_size, resolution);
+    v_count++;
+    return SM_VERTEX;
+  }
+  else
+  {
+    SMtriangle* triangle = clusterer->output_triangle_first;
+    clusterer->output_triangle_first = triangle->buffer_next;
+    if (clusterer->output_triangle_first == 0) clusterer->output_triangle_last = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+      cell = triangle->cells[i];
+      t_idx[i] = cell->index;
+      cell->pending--;
+      if (cell->pending == 0)
+      {
+        t_final[i] = true;
+        finalized_vertices[have_finalized++] = t_idx[i];
+        clusterer->deallocCell(cell); // it can still be used until the next cell is alloced
+      }
+      else
+      {
+        t_final[i] = false;
+      }
+    }
+    clusterer->deallocTriangle(triangle);
+    f_count++;
+    return SM_TRIANGLE;
+  }
+}
+
+SMevent SMreadClustered::read_event()
+{
+  if (next_finalized < have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    next_finalized++;
+    return SM_FINALIZED;
+  }
+  return read_element();
+}
+
+SMreadClustered::SMreadClustered()
+{
+  // init of SMreader interface
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreadClustered
+  smreader = 0;
+  eof = false;
+
+  resolution = 0;
+  max_cells = 0;
+  max_waiting = 0;
+  cell_size = 0.0f;
+
+  have_finalized = next_finalized = 0;
+
+  clusterer = new SMclusterer();
+}
+
+SMreadClustered::~SMreadClustered()
+{
+  delete clusterer;
+}
@@ -0,0 +1,987 @@
+/*
+===============================================================================
+
+  FILE:  SMreadComponents.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreadcomponents.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "vec3fv.h"
+#include "smstats.h"
+#include "smtrace.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+struct SMcomponent;
+
+typedef struct SMvertex
+{
+  SMvertex* buffer_next;        // used for efficient memory management
+  SMvertex* live_prev;          // the vertices of a component that are not finalized
+  SMvertex* live_next;
+  SMcomponent* component;       // 0 until a triangle uses it
+  float v[3];
+  SMidx index;                  // the index in the output or -1
+  int pending;                  // its triangles that were not yet passed on or dropped
+  bool finalized;
+} SMvertex;
+
+typedef struct SMtriangle
+{
+  SMtriangle* buffer_next;      // used for efficient memory management, the held triangles, and the output queue
+  SMvertex* vertices[3];
+  int label;
+  bool last;
+} SMtriangle;
+
+typedef struct SMcomponent
+{
+  SMcomponent* buffer_next;     // used for efficient memory management
+  SMcomponent* prev;            // all components that are not resolved
+  SMcomponent* next;
+  SMvertex* live_first;
+  int live;                     // how many of its vertices are not finalized
+  int triangles;
+  SMtriangle* held_first;       // its triangles that are held back
+  SMtriangle* held_last;
+  int held;
+  int label;                    // -1 until it gets one
+} SMcomponent;
+
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_vertex_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_vertex_hash;
+#endif
+
+// the state of the labeling is kept per reader so that several of them
+// can be used on one thread and so that its statistics can be queried from
+// another thread
+
+struct SMlabeler
+{
+  my_vertex_hash* vertex_hash;
+
+  // triangles that are ready to be passed on
+
+  SMtriangle* output_triangle_first;
+  SMtriangle* output_triangle_last;
+
+  // the components that are not resolved yet
+
+  SMcomponent* component_first;
+  int held_number;
+  int label_number;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_in_width;
+  int stat_component_buffer;
+  int stat_held_triangles;
+  int stat_components;
+  int stat_dropped_components;
+  int stat_dropped_triangles;
+  int stat_merged_labels;
+  int stat_early_labels;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int vertex_buffer_size;
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int vertex_blocks_number;
+
+  int triangle_buffer_size;
+  int triangle_buffer_alloc;
+  SMtriangle* triangle_buffer_next;
+  SMtriangle** triangle_blocks;
+  int triangle_blocks_number;
+
+  int component_buffer_size;
+  int component_buffer_alloc;
+  SMcomponent* component_buffer_next;
+  SMcomponent** component_blocks;
+  int component_blocks_number;
+
+  int initVertexBuffer(int size);
+  SMvertex* allocVertexBlock(int size);
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+  int initTriangleBuffer(int size);
+  SMtriangle* allocTriangleBlock(int size);
+  SMtriangle* allocTriangle();
+  void deallocTriangle(SMtriangle* triangle);
+  int initComponentBuffer(int size);
+  SMcomponent* allocComponentBlock(int size);
+  SMcomponent* allocComponent();
+  void deallocComponent(SMcomponent* component);
+
+  SMcomponent* mergeComponents(SMcomponent* a, SMcomponent* b);
+  void labelComponent(SMcomponent* component);
+  void passOnComponent(SMcomponent* component, bool last);
+  void dropComponent(SMcomponent* component);
+  void resolveComponent(SMcomponent* component, int min_triangles);
+  bool finalizeVertex(SMvertex* vertex, int min_triangles);
+
+  SMlabeler();
+  ~SMlabeler();
+};
+
+SMlabeler::SMlabeler()
+{
+  vertex_hash = 0;
+
+  output_triangle_first = output_triangle_last = 0;
+  component_first = 0;
+  held_number = 0;
+  label_number = 0;
+
+  stats = 0;
+
+  vertex_buffer_size = 0;
+  vertex_buffer_alloc = 1024;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_number = 0;
+
+  triangle_buffer_size = 0;
+  triangle_buffer_alloc = 2048;
+  triangle_buffer_next = 0;
+  triangle_blocks = 0;
+  triangle_blocks_number = 0;
+
+  component_buffer_size = 0;
+  component_buffer_alloc = 256;
+  component_buffer_next = 0;
+  component_blocks = 0;
+  component_blocks_number = 0;
+}
+
+SMlabeler::~SMlabeler()
+{
+  int i;
+  for (i = 0; i < vertex_blocks_number; i++)
+  {
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  for (i = 0; i < triangle_blocks_number; i++)
+  {
+    free(triangle_blocks[i]);
+  }
+  if (triangle_blocks) free(triangle_blocks);
+  for (i = 0; i < component_blocks_number; i++)
+  {
+    free(component_blocks[i]);
+  }
+  if (component_blocks) free(component_blocks);
+  if (vertex_hash) delete vertex_hash;
+  if (stats) delete stats;
+}
+
+// efficient memory allocation for vertices. every block is remembered so
+// that the destructor can give it back.
+
+SMvertex* SMlabeler::allocVertexBlock(int size)
+{
+  SMvertex* block = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for vertex buffer failed\n");
+    return 0;
+  }
+  vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+  vertex_blocks[vertex_blocks_number] = block;
+  vertex_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMlabeler::initVertexBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (vertex_buffer_next)
+  {
+    vertex_buffer_size = 0;
+    return 1;
+  }
+
+  vertex_buffer_next = allocVertexBlock(size);
+
+  if (vertex_buffer_next == 0)
+  {
+    return 0;
+  }
+  vertex_buffer_alloc = size;
+  vertex_buffer_size = 0;
+  return 1;
+}
+
+SMvertex* SMlabeler::allocVertex()
+{
+  if (vertex_buffer_next == 0)
+  {
+    vertex_buffer_next = allocVertexBlock(vertex_buffer_alloc);
+    if (vertex_buffer_next == 0)
+    {
+      return 0;
+    }
+    vertex_buffer_alloc = 2*vertex_buffer_alloc;
+  }
+  // get pointer to next available vertex
+  SMvertex* vertex = vertex_buffer_next;
+  vertex_buffer_next = vertex->buffer_next;
+
+  vertex->component = 0;
+  vertex->index = -1;
+  vertex->pending = 0;
+  vertex->finalized = false;
+
+  vertex_buffer_size++;
+
+  return vertex;
+}
+
+void SMlabeler::deallocVertex(SMvertex* vertex)
+{
+  vertex->buffer_next = vertex_buffer_next;
+  vertex_buffer_next = vertex;
+  vertex_buffer_size--;
+}
+
+// efficient memory allocation for triangles
+
+SMtriangle* SMlabeler::allocTriangleBlock(int size)
+{
+  SMtriangle* block = (SMtriangle*)malloc(sizeof(SMtriangle)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for triangle buffer failed\n");
+    return 0;
+  }
+  triangle_blocks = (SMtriangle**)realloc(triangle_blocks, sizeof(SMtriangle*)*(triangle_blocks_number+1));
+  triangle_blocks[triangle_blocks_number] = block;
+  triangle_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMlabeler::initTriangleBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (triangle_buffer_next)
+  {
+    triangle_buffer_size = 0;
+    return 1;
+  }
+
+  triangle_buffer_next = allocTriangleBlock(size);
+
+  if (triangle_buffer_next == 0)
+  {
+    return 0;
+  }
+  triangle_buffer_alloc = size;
+  triangle_buffer_size = 0;
+  return 1;
+}
+
+SMtriangle* SMlabeler::allocTriangle()
+{
+  if (triangle_buffer_next == 0)
+  {
+    triangle_buffer_next = allocTriangleBlock(triangle_buffer_alloc);
+    if (triangle_buffer_next == 0)
+    {
+      return 0;
+    }
+    triangle_buffer_alloc = 2*triangle_buffer_alloc;
+  }
+  // get pointer to next available triangle
+  SMtriangle* triangle = triangle_buffer_next;
+  triangle_buffer_next = triangle->buffer_next;
+
+  triangle->buffer_next = 0;
+  triangle->label = -1;
+  triangle->last = false;
+
+  triangle_buffer_size++;
+
+  return triangle;
+}
+
+void SMlabeler::deallocTriangle(SMtriangle* triangle)
+{
+  triangle->buffer_next = triangle_buffer_next;
+  triangle_buffer_next = triangle;
+  triangle_buffer_size--;
+}
+
+// efficient memory allocation for components
+
+SMcomponent* SMlabeler::allocComponentBlock(int size)
+{
+  SMcomponent* block = (SMcomponent*)malloc(sizeof(SMcomponent)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for component buffer failed\n");
+    return 0;
+  }
+  component_blocks = (SMcomponent**)realloc(component_blocks, sizeof(SMcomponent*)*(component_blocks_number+1));
+  component_blocks[component_blocks_number] = block;
+  component_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMlabeler::initComponentBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (component_buffer_next)
+  {
+    component_buffer_size = 0;
+    return 1;
+  }
+
+  component_buffer_next = allocComponentBlock(size);
+
+  if (component_buffer_next == 0)
+  {
+    return 0;
+  }
+  component_buffer_alloc = size;
+  component_buffer_size = 0;
+  return 1;
+}
+
+SMcomponent* SMlabeler::allocComponent()
+{
+  if (component_buffer_next == 0)
+  {
+    component_buffer_next = allocComponentBlock(component_buffer_alloc);
+    if (component_buffer_next == 0)
+    {
+      return 0;
+    }
+    component_buffer_alloc = 2*component_buffer_alloc;
+  }
+  // get pointer to next available component
+  SMcomponent* component = component_buffer_next;
+  component_buffer_next = component->buffer_next;
+
+  component->live_first = 0;
+  component->live = 0;
+  component->triangles = 0;
+  component->held_first = 0;
+  component->held_last = 0;
+  component->held = 0;
+  component->label = -1;
+
+  // link it into the list of unresolved components
+  component->prev = 0;
+  component->next = component_first;
+  if (component_first) component_first->prev = component;
+  component_first = component;
+
+  component_buffer_size++;
+
+  stats->level(stat_component_buffer, component_buffer_size);
+
+  return component;
+}
+
+void SMlabeler::deallocComponent(SMcomponent* component)
+{
+  if (component->prev) component->prev->next = component->next;
+  else component_first = component->next;
+  if (component->next) component->next->prev = component->prev;
+
+  component->buffer_next = component_buffer_next;
+  component_buffer_next = component;
+  component_buffer_size--;
+  stats->down(stat_component_buffer);
+}
+
+// the vertices of a component that are not finalized are linked so that
+// they can be moved when it is merged into a larger component
+
+static void addLive(SMcomponent* component, SMvertex* vertex)
+{
+  vertex->component = component;
+  vertex->live_prev = 0;
+  vertex->live_next = component->live_first;
+  if (component->live_first) component->live_first->live_prev = vertex;
+  component->live_first = vertex;
+  component->live++;
+}
+
+static void removeLive(SMcomponent* component, SMvertex* vertex)
+{
+  if (vertex->live_prev) vertex->live_prev->live_next = vertex->live_next;
+  else component->live_first = vertex->live_next;
+  if (vertex->live_next) vertex->live_next->live_prev = vertex->live_prev;
+  component->live--;
+}
+
+// the smaller component is merged into the larger one
+
+SMcomponent* SMlabeler::mergeComponents(SMcomponent* a, SMcomponent* b)
+{
+  SMcomponent* large = (a->live >= b->live ? a : b);
+  SMcomponent* small = (a->live >= b->live ? b : a);
+
+  while (small->live_first)
+  {
+    SMvertex* vertex = small->live_first;
+    removeLive(small, vertex);
+    addLive(large, vertex);
+  }
+
+  large->triangles += small->triangles;
+
+  if (small->held_first)
+  {
+    if (large->held_first) large->held_last->buffer_next = small->held_first;
+    else large->held_first = small->held_first;
+    large->held_last = small->held_last;
+    large->held += small->held;
+  }
+
+  if (small->label != -1)
+  {
+    if (large->label == -1)
+    {
+      large->label = small->label;
+    }
+    else
+    {
+      if (small->label < large->label) large->label = small->label;
+      stats->count(stat_merged_labels);
+    }
+  }
+
+  deallocComponent(small);
+  return large;
+}
+
+void SMlabeler::labelComponent(SMcomponent* component)
+{
+  component->label = label_number;
+  label_number++;
+  stats->count(stat_components);
+}
+
+// moves the held triangles of a labeled component to the output
+
+void SMlabeler::passOnComponent(SMcomponent* component, bool last)
+{
+  SMtriangle* triangle;
+  for (triangle = component->held_first; triangle; triangle = triangle->buffer_next)
+  {
+    triangle->label = component->label;
+  }
+  if (component->held_first)
+  {
+    if (last) component->held_last->last = true;
+    if (output_triangle_first) output_triangle_last->buffer_next = component->held_first;
+    else output_triangle_first = component->held_first;
+    output_triangle_last = component->held_last;
+  }
+  held_number -= component->held;
+  stats->level(stat_held_triangles, held_number);
+  component->held_first = 0;
+  component->held_last = 0;
+  component->held = 0;
+}
+
+void SMlabeler::dropComponent(SMcomponent* component)
+{
+  int i;
+  SMtriangle* triangle;
+  while (component->held_first)
+  {
+    triangle = component->held_first;
+    component->held_first = triangle->buffer_next;
+    for (i = 0; i < 3; i++)
+    {
+      SMvertex* vertex = triangle->vertices[i];
+      vertex->pending--;
+      if (vertex->pending == 0 && vertex->finalized)
+      {
+        deallocVertex(vertex);
+      }
+    }
+    deallocTriangle(triangle);
+  }
+  held_number -= component->held;
+  stats->level(stat_held_triangles, held_number);
+  stats->count(stat_dropped_components);
+  stats->count(stat_dropped_triangles, component->triangles);
+  component->held_last = 0;
+  component->held = 0;
+}
+
+// a component whose vertices are all finalized can not grow anymore
+
+void SMlabeler::resolveComponent(SMcomponent* component, int min_triangles)
+{
+  if (component->label == -1)
+  {
+    if (component->triangles >= min_triangles)
+    {
+      labelComponent(component);
+      passOnComponent(component, true);
+    }
+    else
+    {
+      dropComponent(component);
+    }
+  }
+  else
+  {
+    passOnComponent(component, true);
+  }
+  deallocComponent(component);
+}
+
+// returns whether this resolved the component of the vertex
+
+bool SMlabeler::finalizeVertex(SMvertex* vertex, int min_triangles)
+{
+  SMcomponent* component = vertex->component;
+  vertex->finalized = true;
+  if (component == 0)
+  {
+    deallocVertex(vertex);
+    return false;
+  }
+  removeLive(component, vertex);
+  if (vertex->pending == 0)
+  {
+    deallocVertex(vertex);
+  }
+  if (component->live == 0)
+  {
+    resolveComponent(component, min_triangles);
+    return true;
+  }
+  return false;
+}
+
+bool SMreadComponents::open(SMreader* smreader, int min_triangles, int max_buffered)
+{
+  if (smreader == 0 || smreader->post_order)
+  {
+    return false;
+  }
+  if (max_buffered < 1)
+  {
+    fprintf(stderr,"ERROR: SMreadComponents needs to hold back at least one triangle\n");
+    return false;
+  }
+  this->smreader = smreader;
+  eof = false;
+
+  this->min_triangles = (min_triangles > 0 ? min_triangles : 0);
+  this->max_buffered = max_buffered;
+
+  // without dropping components all triangles are passed on
+
+  nverts = -1;
+  nfaces = (this->min_triangles ? -1 : smreader->nfaces);
+
+  v_count = 0;
+  f_count = 0;
+
+  bb_min_f = smreader->bb_min_f;
+  bb_max_f = smreader->bb_max_f;
+
+  c_idx = -1;
+  c_last = false;
+  c_count = 0;
+
+  have_finalized = next_finalized = 0;
+
+  if (labeler->vertex_hash) delete labeler->vertex_hash;
+  labeler->vertex_hash = new my_vertex_hash;
+
+  labeler->output_triangle_first = labeler->output_triangle_last = 0;
+  labeler->component_first = 0;
+  labeler->held_number = 0;
+  labeler->label_number = 0;
+
+  if (labeler->stats == 0)
+  {
+    labeler->stats = new SMstats("SMreadComponents");
+    labeler->stat_in_width = labeler->stats->add("in_width", SM_STATS_LEVEL);
+    labeler->stat_component_buffer = labeler->stats->add("component_buffer", SM_STATS_LEVEL);
+    labeler->stat_held_triangles = labeler->stats->add("held_triangles", SM_STATS_LEVEL);
+    labeler->stat_components = labeler->stats->add("components", SM_STATS_COUNTER);
+    labeler->stat_dropped_components = labeler->stats->add("dropped_components", SM_STATS_COUNTER);
+    labeler->stat_dropped_triangles = labeler->stats->add("dropped_triangles", SM_STATS_COUNTER);
+    labeler->stat_merged_labels = labeler->stats->add("merged_labels", SM_STATS_COUNTER);
+    labeler->stat_early_labels = labeler->stats->add("early_labels", SM_STATS_COUNTER);
+  }
+  labeler->stats->reset();
+
+  if (!labeler->initVertexBuffer(1024) || !labeler->initTriangleBuffer(2048) || !labeler->initComponentBuffer(256))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void SMreadComponents::close()
+{
+  int i;
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  smreader->close();
+
+  // put whatever was not passed on back on the free lists
+
+  my_vertex_hash::iterator vertex_element;
+  for (vertex_element = labeler->vertex_hash->begin(); vertex_element != labeler->vertex_hash->end(); vertex_element++)
+  {
+    SMvertex* vertex = (*vertex_element).second;
+    vertex->finalized = true;
+    if (vertex->pending == 0)
+    {
+      labeler->deallocVertex(vertex);
+    }
+  }
+  delete labeler->vertex_hash;
+  labeler->vertex_hash = 0;
+
+  while (labeler->component_first)
+  {
+    SMcomponent* component = labeler->component_first;
+    labeler->dropComponent(component);
+    labeler->deallocComponent(component);
+  }
+
+  while (labeler->output_triangle_first)
+  {
+    SMtriangle* triangle = labeler->output_triangle_first;
+    labeler->output_triangle_first = triangle->buffer_next;
+    for (i = 0; i < 3; i++)
+    {
+      triangle->vertices[i]->pending--;
+      if (triangle->vertices[i]->pending == 0)
+      {
+        labeler->deallocVertex(triangle->vertices[i]);
+      }
+    }
+    labeler->deallocTriangle(triangle);
+  }
+  labeler->output_triangle_last = 0;
+}
+
+const SMstats* SMreadComponents::get_stats() const
+{
+  return labeler->stats;
+}
+
+// reads from the input until something is ready to be passed on. returns
+// 1 if so, 0 at the end of the input, and -1 on error.
+
+int SMreadComponents::read_input()
+{
+  int i;
+  SMvertex* vertex;
+  SMcomponent* component;
+  SMtriangle* triangle;
+  my_vertex_hash::iterator vertex_element;
+
+  while (labeler->output_triangle_first == 0)
+  {
+    if (eof)
+    {
+      return 0;
+    }
+
+    SMevent event = smreader->read_element();
+
+    if (event == SM_VERTEX)
+    {
+      vertex = labeler->allocVertex();
+      VecCopy3fv(vertex->v, smreader->v_pos_f);
+      sm_trace_hash_insert(labeler->vertex_hash, my_vertex_hash::value_type(smreader->v_idx, vertex), "SMreadComponents::vertex_hash");
+      labeler->stats->level(labeler->stat_in_width, labeler->vertex_hash->size());
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      SMvertex* vertices[3];
+      for (i = 0; i < 3; i++)
+      {
+        vertex_element = labeler->vertex_hash->find(smreader->t_idx[i]);
+        // vertices must preceed triangles in a pre-order mesh
+        if (vertex_element == labeler->vertex_hash->end())
+        {
+          fprintf(stderr, "FATAL ERROR: triangle vertex not in hash. corrupt pre-order mesh.\n");
+          return -1;
+        }
+        vertices[i] = (*vertex_element).second;
+      }
+
+      // union the components of its vertices
+
+      component = 0;
+      for (i = 0; i < 3; i++)
+      {
+        if (vertices[i]->component && vertices[i]->component != component)
+        {
+          component = (component ? labeler->mergeComponents(component, vertices[i]->component) : vertices[i]->component);
+        }
+      }
+      if (component == 0)
+      {
+        component = labeler->allocComponent();
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (vertices[i]->component == 0)
+        {
+          addLive(component, vertices[i]);
+        }
+      }
+
+      triangle = labeler->allocTriangle();
+      for (i = 0; i < 3; i++)
+      {
+        triangle->vertices[i] = vertices[i];
+        vertices[i]->pending++;
+      }
+      if (component->held_first) component->held_last->buffer_next = triangle;
+      else component->held_first = triangle;
+      component->held_last = triangle;
+      component->held++;
+      component->triangles++;
+      labeler->held_number++;
+      labeler->stats->level(labeler->stat_held_triangles, labeler->held_number);
+
+      bool resolved = false;
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader->t_final[i] && labeler->vertex_hash->erase(smreader->t_idx[i]))
+        {
+          if (labeler->finalizeVertex(vertices[i], min_triangles)) resolved = true;
+        }
+      }
+
+      if (!resolved)
+      {
+        // a component with enough triangles is known to stay
+        if (component->label == -1 && min_triangles && component->triangles >= min_triangles)
+        {
+          labeler->labelComponent(component);
+        }
+        if (component->label != -1)
+        {
+          labeler->passOnComponent(component, false);
+        }
+      }
+
+      // the largest component that is held back is labeled early
+
+      while (labeler->held_number > max_buffered)
+      {
+        SMcomponent* largest = 0;
+        for (component = labeler->component_first; component; component = component->next)
+        {
+          if (component->label == -1 && (largest == 0 || component->held > largest->held))
+          {
+            largest = component;
+          }
+        }
+        labeler->labelComponent(largest);
+        labeler->passOnComponent(largest, false);
+        labeler->stats->count(labeler->stat_early_labels);
+      }
+    }
+    else if (event == SM_FINALIZED)
+    {
+      vertex_element = labeler->vertex_hash->find(smreader->final_idx);
+      // vertices must preceed their finalization in a pre-order mesh
+      if (vertex_element == labeler->vertex_hash->end())
+      {
+        fprintf(stderr, "FATAL ERROR: finalized vertex not in hash. corrupt pre-order mesh.\n");
+        return -1;
+      }
+      vertex = (*vertex_element).second;
+      labeler->vertex_hash->erase(vertex_element);
+      labeler->finalizeVertex(vertex, min_triangles);
+    }
+    else if (event == SM_EOF)
+    {
+      // all remaining vertices are implicitely finalized
+      for (vertex_element = labeler->vertex_hash->begin(); vertex_element != labeler->vertex_hash->end(); vertex_element++)
+      {
+        labeler->finalizeVertex((*vertex_element).second, min_triangles);
+      }
+      labeler->vertex_hash->clear();
+      eof = true;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+SMevent SMreadComponents::read_element()
+{
+  int i;
+  SMvertex* vertex;
+
+  have_finalized = next_finalized = 0;
+
+  int ok = read_input();
+  if (ok <= 0)
+  {
+    return (ok == 0 ? SM_EOF : SM_ERROR);
+  }
+
+  SMtriangle* triangle = labeler->output_triangle_first;
+  c_count = labeler->label_number;
+
+  // a vertex is passed on right before the first triangle that uses it
+
+  for (i = 0; i < 3; i++)
+  {
+    vertex = triangle->vertices[i];
+    if (vertex->index == -1)
+    {
+      vertex->index = v_count;
+      v_idx = v_count;
+      VecCopy3fv(v_pos_f, vertex->v);
+      c_idx = triangle->label;
+      c_last = false;
+      v_count++;
+      return SM_VERTEX;
+    }
+  }
+
+  labeler->output_triangle_first = triangle->buffer_next;
+  if (labeler->output_triangle_first == 0) labeler->output_triangle_last = 0;
+
+  for (i = 0; i < 3; i++)
+  {
+    vertex = triangle->vertices[i];
+    t_idx[i] = vertex->index;
+    vertex->pending--;
+    if (vertex->pending == 0 && vertex->finalized)
+    {
+      t_final[i] = true;
+      finalized_vertices[have_finalized++] = t_idx[i];
+      labeler->deallocVertex(vertex);
+    }
+    else
+    {
+      t_final[i] = false;
+    }
+  }
+  c_idx = triangle->label;
+  c_last = triangle->last;
+  labeler->deallocTriangle(triangle);
+  f_count++;
+  return SM_TRIANGLE;
+}
+
+SMevent SMreadComponents::read_event()
+{
+  if (next_finalized < have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    next_finalized++;
+    return SM_FINALIZED;
+  }
+  return read_element();
+}
+
+SMreadComponents::SMreadComponents()
+{
+  // init of SMreader interface
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreadComponents
+  c_idx = -1;
+  c_last = false;
+  c_count = 0;
+
+  smreader = 0;
+  eof = false;
+
+  min_triangles = 0;
+  max_buffered = 0;
+
+  have_finalized = next_finalized = 0;
+
+  labeler = new SMlabeler();
+}
+
+SMreadComponents::~SMreadComponents()
+{
+  delete labeler;
+}
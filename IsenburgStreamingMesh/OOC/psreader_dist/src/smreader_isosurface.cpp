@@ -0,0 +1,758 @@
+/*
+===============================================================================
+
+  FILE:  SMreader_isosurface.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreader_isosurface.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec3fv.h"
+#include "smthread.h"
+
+// the corners of a cell are numbered with x in bit 0, y in bit 1, and z
+// in bit 2. the edges are numbered by their axis times 4 plus the index
+// of their lower corner among the 4 corners whose bit of that axis is 0.
+
+static int mc_edge_corner[12];
+static int mc_edge_axis[12];
+static int mc_edge_faces[12];
+
+// the corners of the faces in counterclockwise order seen from outside
+
+static const int mc_faces[6][4] = {{0,4,6,2}, {1,3,7,5}, {0,1,5,4}, {2,6,7,3}, {0,2,3,1}, {4,5,7,6}};
+
+// for each case the edges of its triangles and whether a corner is the
+// last one in the case that is on its edge
+
+static int mc_number[256];
+static signed char mc_edges[256][36];
+static bool mc_last[256][36];
+static bool mc_initialized = false;
+
+static int edge_of(int a, int b)
+{
+  int axis = ((a ^ b) == 1 ? 0 : ((a ^ b) == 2 ? 1 : 2));
+  int lower = (a < b ? a : b);
+  if (axis == 0) return (lower >> 1);
+  if (axis == 1) return 4 + ((lower & 1) | ((lower >> 2) << 1));
+  return 8 + (lower & 3);
+}
+
+// the contour on each face goes from where it enters the inside to where
+// it leaves it, so that two opposite inside corners are separated. every
+// edge that is cut is the start of one such segment on one of its faces
+// and the end of one on the other, so the segments form closed loops.
+// a loop is triangulated as a fan around a corner whose diagonals do not
+// lie in a face of the cube, where the cell next to it could use them too.
+
+static void init_cases()
+{
+  int e, c, f, m, n, i, k, r;
+  int next[12];
+  int loop[12];
+  bool visited[12];
+
+  for (e = 0; e < 12; e++)
+  {
+    for (c = 0; c < 8; c++)
+    {
+      for (k = 0; k < 3; k++)
+      {
+        if ((c & (1 << k)) == 0 && edge_of(c, c | (1 << k)) == e)
+        {
+          mc_edge_corner[e] = c;
+          mc_edge_axis[e] = k;
+        }
+      }
+    }
+  }
+
+  for (e = 0; e < 12; e++)
+  {
+    mc_edge_faces[e] = 0;
+  }
+  for (f = 0; f < 6; f++)
+  {
+    for (m = 0; m < 4; m++)
+    {
+      mc_edge_faces[edge_of(mc_faces[f][m], mc_faces[f][(m+1)%4])] |= (1 << f);
+    }
+  }
+
+  for (c = 0; c < 256; c++)
+  {
+    for (e = 0; e < 12; e++)
+    {
+      next[e] = -1;
+      visited[e] = false;
+    }
+    for (f = 0; f < 6; f++)
+    {
+      for (m = 0; m < 4; m++)
+      {
+        int a = mc_faces[f][m];
+        int b = mc_faces[f][(m+1)%4];
+        if ((c & (1 << a)) == 0 && (c & (1 << b)))
+        {
+          // enters the inside on edge ab and leaves it on the next edge
+          // that goes from inside to outside
+          for (n = 1; n < 4; n++)
+          {
+            int p = mc_faces[f][(m+n)%4];
+            int q = mc_faces[f][(m+n+1)%4];
+            if ((c & (1 << p)) && (c & (1 << q)) == 0)
+            {
+              next[edge_of(a, b)] = edge_of(p, q);
+              break;
+            }
+          }
+        }
+      }
+    }
+    mc_number[c] = 0;
+    for (e = 0; e < 12; e++)
+    {
+      if (next[e] == -1 || visited[e]) continue;
+      n = 0;
+      for (i = e; !visited[i]; i = next[i])
+      {
+        visited[i] = true;
+        loop[n++] = i;
+      }
+      for (r = 0; r < n; r++)
+      {
+        for (i = 2; i < n-1; i++)
+        {
+          if (mc_edge_faces[loop[r]] & mc_edge_faces[loop[(r+i)%n]]) break;
+        }
+        if (i >= n-1) break;
+      }
+      if (r == n) r = 0;
+      for (i = 1; i < n-1; i++)
+      {
+        mc_edges[c][3*mc_number[c]+0] = loop[r];
+        mc_edges[c][3*mc_number[c]+1] = loop[(r+i)%n];
+        mc_edges[c][3*mc_number[c]+2] = loop[(r+i+1)%n];
+        mc_number[c]++;
+      }
+    }
+    for (i = 0; i < 3*mc_number[c]; i++)
+    {
+      mc_last[c][i] = true;
+      for (k = i+1; k < 3*mc_number[c]; k++)
+      {
+        if (mc_edges[c][k] == mc_edges[c][i]) mc_last[c][i] = false;
+      }
+    }
+  }
+  mc_initialized = true;
+}
+
+// a vertex is identified by its edge. the keys of the edges in x and y on
+// the lower and upper layer of a slab and of the edges in z are in five
+// ranges of nx*ny.
+
+#define SM_ISO_LOWER_X 0
+#define SM_ISO_LOWER_Y 1
+#define SM_ISO_UPPER_X 2
+#define SM_ISO_UPPER_Y 3
+#define SM_ISO_Z       4
+
+typedef struct SMisoTriangle
+{
+  int key[3];
+  bool final[3];
+  float pos[3][3];
+} SMisoTriangle;
+
+struct SMisoSlab
+{
+  int slab;
+  int number;
+  int alloc;
+  SMisoTriangle* triangles;
+  SMsemaphore done;
+};
+
+struct SMisoVolume;
+
+typedef struct SMisoWorker
+{
+  SMisoVolume* volume;
+  int first;
+  SMsemaphore todo;
+  SMthread thread;
+} SMisoWorker;
+
+// the slabs are extracted into a ring of 'slots'. slab k needs the layers
+// k and k+1, which are kept in a ring of slots+1 layers.
+
+struct SMisoVolume
+{
+  FILE* file;
+  const unsigned char* samples;
+  int type;
+  int size;
+  int nx, ny, nz;
+  int nslabs;
+  float iso;
+  float origin[3];
+  float spacing[3];
+  int slots;
+  SMisoSlab* slabs;
+  float** layers;
+  void* buffer;
+  int threads;
+  SMisoWorker* workers;
+  volatile bool quit;
+};
+
+// reads layer l of the volume into its slot and converts it to float
+
+static bool read_layer(SMisoVolume* volume, int l)
+{
+  int i, nxy = volume->nx*volume->ny;
+  float* layer = volume->layers[l % (volume->slots+1)];
+  const void* samples;
+
+  if (volume->file)
+  {
+    if ((int)fread(volume->buffer, volume->size, nxy, volume->file) != nxy)
+    {
+      fprintf(stderr,"ERROR: the volume ends in layer %d instead of after layer %d\n", l, volume->nz-1);
+      return false;
+    }
+    samples = volume->buffer;
+  }
+  else
+  {
+    samples = volume->samples + (size_t)l*nxy*volume->size;
+  }
+
+  switch (volume->type)
+  {
+  case SM_ISO_UCHAR:
+    for (i = 0; i < nxy; i++) layer[i] = ((const unsigned char*)samples)[i];
+    break;
+  case SM_ISO_USHORT:
+    for (i = 0; i < nxy; i++) layer[i] = ((const unsigned short*)samples)[i];
+    break;
+  default:
+    memcpy(layer, samples, sizeof(float)*nxy);
+    break;
+  }
+  return true;
+}
+
+// a vertex is finalized in the slab above its layer or in the slab of its
+// edge in z. of that slab it is finalized in the last cell around its
+// edge with the last triangle of that cell that uses it.
+
+static void extract_slab(const SMisoVolume* volume, SMisoSlab* slab)
+{
+  int i, j, c, e, t, m, x, y, z;
+  int nx = volume->nx;
+  int ny = volume->ny;
+  int nxy = nx*ny;
+  int k = slab->slab;
+  bool last_slab = (k == volume->nslabs-1);
+  const float* lower = volume->layers[k % (volume->slots+1)];
+  const float* upper = volume->layers[(k+1) % (volume->slots+1)];
+  float s[8];
+  int keys[12];
+  bool finals[12];
+  float pos[12][3];
+  float iso = volume->iso;
+
+  slab->number = 0;
+
+  for (j = 0; j < ny-1; j++)
+  {
+    for (i = 0; i < nx-1; i++)
+    {
+      int config = 0;
+      for (c = 0; c < 8; c++)
+      {
+        s[c] = ((c & 4) ? upper : lower)[(j + ((c >> 1) & 1))*nx + i + (c & 1)];
+        if (s[c] >= iso) config |= (1 << c);
+      }
+      if (config == 0 || config == 255) continue;
+
+      for (e = 0; e < 12; e++)
+      {
+        c = mc_edge_corner[e];
+        int d = c | (1 << mc_edge_axis[e]);
+        if (((config >> c) & 1) == ((config >> d) & 1)) continue;
+        x = i + (c & 1);
+        y = j + ((c >> 1) & 1);
+        z = (c >> 2) & 1;
+        float u = (iso - s[c]) / (s[d] - s[c]);
+        pos[e][0] = volume->origin[0] + volume->spacing[0]*(x + (mc_edge_axis[e] == 0 ? u : 0.0f));
+        pos[e][1] = volume->origin[1] + volume->spacing[1]*(y + (mc_edge_axis[e] == 1 ? u : 0.0f));
+        pos[e][2] = volume->origin[2] + volume->spacing[2]*(k + z + (mc_edge_axis[e] == 2 ? u : 0.0f));
+        switch (mc_edge_axis[e])
+        {
+        case 0:
+          keys[e] = (z ? SM_ISO_UPPER_X : SM_ISO_LOWER_X)*nxy + y*nx + x;
+          finals[e] = (!z || last_slab) && j == (y < ny-1 ? y : ny-2);
+          break;
+        case 1:
+          keys[e] = (z ? SM_ISO_UPPER_Y : SM_ISO_LOWER_Y)*nxy + y*nx + x;
+          finals[e] = (!z || last_slab) && i == (x < nx-1 ? x : nx-2);
+          break;
+        default:
+          keys[e] = SM_ISO_Z*nxy + y*nx + x;
+          finals[e] = i == (x < nx-1 ? x : nx-2) && j == (y < ny-1 ? y : ny-2);
+          break;
+        }
+      }
+
+      if (slab->number + mc_number[config] > slab->alloc)
+      {
+        slab->alloc = 2*slab->alloc;
+        slab->triangles = (SMisoTriangle*)realloc(slab->triangles, sizeof(SMisoTriangle)*slab->alloc);
+      }
+      for (t = 0; t < mc_number[config]; t++)
+      {
+        SMisoTriangle* triangle = &(slab->triangles[slab->number++]);
+        for (m = 0; m < 3; m++)
+        {
+          e = mc_edges[config][3*t+m];
+          triangle->key[m] = keys[e];
+          triangle->final[m] = finals[e] && mc_last[config][3*t+m];
+          VecCopy3fv(triangle->pos[m], pos[e]);
+        }
+      }
+    }
+  }
+}
+
+// a worker extracts every threads-th slab starting with its first
+
+static SM_THREAD_RESULT run_worker(void* arg)
+{
+  SMisoWorker* worker = (SMisoWorker*)arg;
+  SMisoVolume* volume = worker->volume;
+  int k = worker->first;
+  while (true)
+  {
+    waitSemaphore(&(worker->todo));
+    if (volume->quit) break;
+    SMisoSlab* slab = &(volume->slabs[k % volume->slots]);
+    extract_slab(volume, slab);
+    postSemaphore(&(slab->done));
+    k += volume->threads;
+  }
+  return 0;
+}
+
+// hands slab k to its worker once its upper layer was read. returns false
+// if there is no such slab.
+
+static bool dispatch_slab(SMisoVolume* volume, int k)
+{
+  if (k >= volume->nslabs)
+  {
+    return false;
+  }
+  if (!read_layer(volume, k+1))
+  {
+    volume->nslabs = k;
+    return false;
+  }
+  volume->slabs[k % volume->slots].slab = k;
+  if (volume->threads)
+  {
+    postSemaphore(&(volume->workers[k % volume->threads].todo));
+  }
+  return true;
+}
+
+static void deallocVolume(SMisoVolume* volume)
+{
+  int s, w;
+  if (volume->threads)
+  {
+    volume->quit = true;
+    for (w = 0; w < volume->threads; w++)
+    {
+      if (volume->workers[w].first == -1) continue;
+      postSemaphore(&(volume->workers[w].todo));
+      joinThread(&(volume->workers[w].thread));
+    }
+    for (w = 0; w < volume->threads; w++)
+    {
+      destroySemaphore(&(volume->workers[w].todo));
+    }
+    for (s = 0; s < volume->slots; s++)
+    {
+      destroySemaphore(&(volume->slabs[s].done));
+    }
+    free(volume->workers);
+  }
+  for (s = 0; s < volume->slots; s++)
+  {
+    free(volume->slabs[s].triangles);
+  }
+  free(volume->slabs);
+  for (s = 0; s <= volume->slots; s++)
+  {
+    free(volume->layers[s]);
+  }
+  free(volume->layers);
+  if (volume->buffer) free(volume->buffer);
+  free(volume);
+}
+
+void SMreader_isosurface::set_origin(const float* origin)
+{
+  VecCopy3fv(this->origin, origin);
+}
+
+void SMreader_isosurface::set_spacing(const float* spacing)
+{
+  VecCopy3fv(this->spacing, spacing);
+}
+
+void SMreader_isosurface::set_threads(int threads)
+{
+  this->threads = (threads > 0 ? threads : 0);
+}
+
+bool SMreader_isosurface::open(FILE* file, int type, int nx, int ny, int nz, float iso)
+{
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: no file to read the volume from\n");
+    return false;
+  }
+  return open(file, 0, type, nx, ny, nz, iso);
+}
+
+bool SMreader_isosurface::open(const void* samples, int type, int nx, int ny, int nz, float iso)
+{
+  if (samples == 0)
+  {
+    fprintf(stderr,"ERROR: no samples to read the volume from\n");
+    return false;
+  }
+  return open(0, samples, type, nx, ny, nz, iso);
+}
+
+bool SMreader_isosurface::open(FILE* file, const void* samples, int type, int nx, int ny, int nz, float iso)
+{
+  int s, w, nxy;
+
+  if (type != SM_ISO_UCHAR && type != SM_ISO_USHORT && type != SM_ISO_FLOAT)
+  {
+    fprintf(stderr,"ERROR: unknown type %d of samples\n", type);
+    return false;
+  }
+  if (nx < 2 || ny < 2 || nz < 2)
+  {
+    fprintf(stderr,"ERROR: a volume of %d x %d x %d samples has no cells\n", nx, ny, nz);
+    return false;
+  }
+  if ((double)nx*ny > (double)(1 << 28))
+  {
+    fprintf(stderr,"ERROR: layers of %d x %d samples are too large\n", nx, ny);
+    return false;
+  }
+  nxy = nx*ny;
+
+  if (!mc_initialized) init_cases();
+
+  volume = (SMisoVolume*)malloc(sizeof(SMisoVolume));
+  volume->file = file;
+  volume->samples = (const unsigned char*)samples;
+  volume->type = type;
+  volume->size = (type == SM_ISO_UCHAR ? 1 : (type == SM_ISO_USHORT ? 2 : 4));
+  volume->nx = nx;
+  volume->ny = ny;
+  volume->nz = nz;
+  volume->nslabs = nz-1;
+  volume->iso = iso;
+  VecCopy3fv(volume->origin, origin);
+  VecCopy3fv(volume->spacing, spacing);
+  volume->threads = threads;
+  volume->slots = (threads ? 2*threads : 1);
+  volume->slabs = (SMisoSlab*)malloc(sizeof(SMisoSlab)*volume->slots);
+  for (s = 0; s < volume->slots; s++)
+  {
+    volume->slabs[s].slab = -1;
+    volume->slabs[s].number = 0;
+    volume->slabs[s].alloc = 1024;
+    volume->slabs[s].triangles = (SMisoTriangle*)malloc(sizeof(SMisoTriangle)*volume->slabs[s].alloc);
+  }
+  volume->layers = (float**)malloc(sizeof(float*)*(volume->slots+1));
+  for (s = 0; s <= volume->slots; s++)
+  {
+    volume->layers[s] = (float*)malloc(sizeof(float)*nxy);
+  }
+  volume->buffer = (file ? malloc(volume->size*nxy) : 0);
+  volume->workers = 0;
+  volume->quit = false;
+
+  if (!read_layer(volume, 0))
+  {
+    volume->threads = 0;
+    deallocVolume(volume);
+    volume = 0;
+    return false;
+  }
+
+  if (threads)
+  {
+    for (s = 0; s < volume->slots; s++)
+    {
+      initSemaphore(&(volume->slabs[s].done), 0, 1);
+    }
+    volume->workers = (SMisoWorker*)malloc(sizeof(SMisoWorker)*threads);
+    for (w = 0; w < threads; w++)
+    {
+      volume->workers[w].volume = volume;
+      volume->workers[w].first = w;
+      initSemaphore(&(volume->workers[w].todo), 0, volume->slots);
+    }
+    for (w = 0; w < threads; w++)
+    {
+      if (!startThread(&(volume->workers[w].thread), run_worker, &(volume->workers[w])))
+      {
+        fprintf(stderr,"ERROR: cannot start the thread for worker %d\n", w);
+        for (; w < threads; w++) volume->workers[w].first = -1;
+        deallocVolume(volume);
+        volume = 0;
+        return false;
+      }
+    }
+    for (s = 0; s < volume->slots; s++)
+    {
+      if (!dispatch_slab(volume, s)) break;
+    }
+  }
+
+  vertex_idx = (SMidx*)malloc(sizeof(SMidx)*5*nxy);
+  for (s = 0; s < 5*nxy; s++) vertex_idx[s] = -1;
+
+  current = 0;
+  next_slab = 0;
+  next_triangle = 0;
+  next_corner = 0;
+  have_finalized = next_finalized = 0;
+
+  float corner[3];
+  corner[0] = origin[0] + spacing[0]*(nx-1);
+  corner[1] = origin[1] + spacing[1]*(ny-1);
+  corner[2] = origin[2] + spacing[2]*(nz-1);
+  VecCopy3fv(bb_min, origin);
+  VecCopy3fv(bb_max, origin);
+  VecUpdateMinMax3fv(bb_min, bb_max, corner);
+  bb_min_f = bb_min;
+  bb_max_f = bb_max;
+
+  nverts = -1;
+  nfaces = -1;
+  v_count = 0;
+  f_count = 0;
+  post_order = false;
+  return true;
+}
+
+// waits for the next slab or extracts it. returns false after the last.
+
+bool SMreader_isosurface::start_slab()
+{
+  if (next_slab >= volume->nslabs)
+  {
+    return false;
+  }
+  current = &(volume->slabs[next_slab % volume->slots]);
+  if (volume->threads)
+  {
+    waitSemaphore(&(current->done));
+  }
+  else
+  {
+    if (!dispatch_slab(volume, next_slab))
+    {
+      current = 0;
+      return false;
+    }
+    extract_slab(volume, current);
+  }
+  next_triangle = 0;
+  next_corner = 0;
+  return true;
+}
+
+// the vertices of the upper layer are those of the lower layer of the
+// next slab and the slot goes to the slab that is 'slots' ahead
+
+void SMreader_isosurface::end_slab()
+{
+  int nxy = volume->nx*volume->ny;
+  memcpy(&(vertex_idx[SM_ISO_LOWER_X*nxy]), &(vertex_idx[SM_ISO_UPPER_X*nxy]), sizeof(SMidx)*2*nxy);
+  for (int i = SM_ISO_UPPER_X*nxy; i < 5*nxy; i++) vertex_idx[i] = -1;
+  current = 0;
+  if (volume->threads)
+  {
+    dispatch_slab(volume, next_slab + volume->slots);
+  }
+  next_slab++;
+}
+
+SMevent SMreader_isosurface::read_element()
+{
+  int m;
+
+  have_finalized = next_finalized = 0;
+
+  if (volume == 0)
+  {
+    return SM_EOF;
+  }
+
+  while (true)
+  {
+    if (current == 0 && !start_slab())
+    {
+      nverts = v_count;
+      nfaces = f_count;
+      return SM_EOF;
+    }
+    if (next_triangle == current->number)
+    {
+      end_slab();
+      continue;
+    }
+
+    SMisoTriangle* triangle = &(current->triangles[next_triangle]);
+
+    // the vertices are passed on right before their first triangle
+
+    while (next_corner < 3)
+    {
+      m = next_corner++;
+      if (vertex_idx[triangle->key[m]] == -1)
+      {
+        vertex_idx[triangle->key[m]] = v_count;
+        VecCopy3fv(v_pos_f, triangle->pos[m]);
+        v_idx = v_count;
+        v_count++;
+        return SM_VERTEX;
+      }
+    }
+
+    for (m = 0; m < 3; m++)
+    {
+      t_idx[m] = vertex_idx[triangle->key[m]];
+      t_final[m] = triangle->final[m];
+      if (t_final[m])
+      {
+        finalized_vertices[have_finalized] = t_idx[m];
+        have_finalized++;
+      }
+    }
+    next_triangle++;
+    next_corner = 0;
+    f_count++;
+    return SM_TRIANGLE;
+  }
+}
+
+SMevent SMreader_isosurface::read_event()
+{
+  if (have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    have_finalized--; next_finalized++;
+    return SM_FINALIZED;
+  }
+  else
+  {
+    return read_element();
+  }
+}
+
+void SMreader_isosurface::close()
+{
+  if (volume)
+  {
+    deallocVolume(volume);
+    volume = 0;
+  }
+  if (vertex_idx)
+  {
+    free(vertex_idx);
+    vertex_idx = 0;
+  }
+  current = 0;
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+}
+
+SMreader_isosurface::SMreader_isosurface()
+{
+  // init of SMreader interface
+  ncomments = 0;
+  comments = 0;
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreader_isosurface
+  volume = 0;
+  current = 0;
+  vertex_idx = 0;
+  origin[0] = origin[1] = origin[2] = 0.0f;
+  spacing[0] = spacing[1] = spacing[2] = 1.0f;
+  threads = 0;
+  next_slab = 0;
+  next_triangle = 0;
+  next_corner = 0;
+  have_finalized = next_finalized = 0;
+}
+
+SMreader_isosurface::~SMreader_isosurface()
+{
+  if (volume) close();
+}
@@ -243,7 +243,9 @@ SMevent SMreader_ply::read_element()
     }
 		Face* face = (Face *) malloc (sizeof (Face));
     get_element_ply (in_ply, (void *) face);
-    VecCopy3iv(t_idx, face->verts);
+    t_idx[0] = face->verts[0];
+    t_idx[1] = face->verts[1];
+    t_idx[2] = face->verts[2];
     free(face->verts);
     free(face);
     f_count++;
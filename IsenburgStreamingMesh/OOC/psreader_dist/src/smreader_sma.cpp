@@ -41,12 +41,27 @@ bool SMreader_sma::open(FILE* file)
     return false;
   }
   this->file = file;
+  return open_stream();
+}
 
+bool SMreader_sma::open(const void* bytes, size_t nbytes)
+{
+  if (bytes == 0 || nbytes < 1)
+  {
+    fprintf(stderr,"ERROR: %.0f bytes are too few for an SMA mesh\n", (double)nbytes);
+    return false;
+  }
+  file = 0;
+  memory.open(bytes, nbytes);
+  return open_stream();
+}
+
+bool SMreader_sma::open_stream()
+{
   skipped_lines = 0;
-  line = (char*)malloc(sizeof(char)*256);
-  if (fgets(line, sizeof(char) * 256, file) == 0)
+  line = line_buffer;
+  if (get_line() == 0)
   {
-    free(line);
     line = 0;
     return false;
   }
@@ -58,11 +73,11 @@ bool SMreader_sma::open(FILE* file)
   {
     if (strstr(line, "nverts"))
     {
-      sscanf(&(line[1]), "%s %d", dummy, &nverts);
+      sscanf(&(line[1]), "%s " SM_IDX_FORMAT, dummy, &nverts);
     }
     else if (strstr(line, "nfaces"))
     {
-      sscanf(&(line[1]), "%s %d", dummy, &nfaces);
+      sscanf(&(line[1]), "%s " SM_IDX_FORMAT, dummy, &nfaces);
     }
     else if (strstr(line, "bb_min"))
     {
@@ -118,9 +133,8 @@ bool SMreader_sma::open(FILE* file)
         skipped_lines++;
       }
     }
-    if (fgets(line, sizeof(char) * 256, file) == 0)
+    if (get_line() == 0)
     {
-      free(line);
       line = 0;
       return false;
     }
@@ -153,8 +167,8 @@ void SMreader_sma::close()
   // close of SMreader_sma
   if (skipped_lines) fprintf(stderr,"WARNING: skipped %d lines.\n",skipped_lines);
   file = 0;
+  memory.open(0, 0);
   skipped_lines = 0;
-  free(line);
   line = 0;
   have_finalized = 0; next_finalized = 0;
 }
@@ -170,16 +184,15 @@ SMevent SMreader_sma::read_element()
       sscanf(&(line[1]), "%f %f %f", &(v_pos_f[0]), &(v_pos_f[1]), &(v_pos_f[2]));
       if (post_order) {finalized_vertices[have_finalized] = v_idx; have_finalized++;}
       v_count++;
-      if (fgets(line, sizeof(char) * 256, file) == 0)
+      if (get_line() == 0)
       {
-        free(line);
         line = 0;
       }
       return SM_VERTEX;
     }
     else if ((line[0] == 'f') && (line[1] == ' '))
     {
-      sscanf(&(line[1]), "%d %d %d", &(t_idx[0]), &(t_idx[1]), &(t_idx[2]));
+      sscanf(&(line[1]), SM_IDX_FORMAT " " SM_IDX_FORMAT " " SM_IDX_FORMAT, &(t_idx[0]), &(t_idx[1]), &(t_idx[2]));
       f_count++;
       for (int i = 0; i < 3; i++)
       {
@@ -196,16 +209,15 @@ SMevent SMreader_sma::read_element()
           t_final[i] = false;
         }
       }
-      if (fgets(line, sizeof(char) * 256, file) == 0)
+      if (get_line() == 0)
       {
-        free(line);
         line = 0;
       }
       return SM_TRIANGLE;
     }
     else if ((line[0] == 'x') && (line[1] == ' '))
     {
-      sscanf(&(line[1]), "%d", &(final_idx));
+      sscanf(&(line[1]), SM_IDX_FORMAT, &(final_idx));
       if (final_idx < 0)
       {
         final_idx = v_count+final_idx;
@@ -214,9 +226,8 @@ SMevent SMreader_sma::read_element()
       {
         final_idx = final_idx - 1;
       }
-      if (fgets(line, sizeof(char) * 256, file) == 0)
+      if (get_line() == 0)
       {
-        free(line);
         line = 0;
       }
       return SM_FINALIZED;
@@ -224,9 +235,8 @@ SMevent SMreader_sma::read_element()
     else if (line[0] == '#')
     {
       // comments in the body are silently ignored
-      if (fgets(line, sizeof(char) * 256, file) == 0)
+      if (get_line() == 0)
       {
-        free(line);
         line = 0;
       }
     }
@@ -254,9 +264,8 @@ SMevent SMreader_sma::read_element()
         }
         skipped_lines++;
       }
-      if (fgets(line, sizeof(char) * 256, file) == 0)
+      if (get_line() == 0)
       {
-        free(line);
         line = 0;
       }
     }
@@ -264,12 +273,12 @@ SMevent SMreader_sma::read_element()
 
   if (nverts != -1 && v_count != nverts)
   {
-    fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+    fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
   }
   nverts = v_count;
   if (nfaces != -1 && f_count != nfaces)
   {
-    fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+    fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
   }
   nfaces = f_count;
 
@@ -28,29 +28,54 @@
 #include "smreader_smb.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smtrace.h"
+#include "mydefs.h"
 
 #define SM_VERSION 0 // this is SMB
+#define SM_VERSION_64 4 // this is SMB with 64 bit counts
+#define SMB_FAR_CORNER ((int)0x80000000) // its index follows the block
+#define SMB_PADDING ((int)0x80000001) // fills up the last block
 
-bool SMreader_smb::open(FILE* file)
+bool SMreader_smb::open(FILE* file, bool skip_geometry)
 {
   if (file == 0)
   {
     return false;
   }
   this->file = file;
+  this->skip_geometry = skip_geometry;
+  return open_stream();
+}
+
+bool SMreader_smb::open(const void* bytes, size_t nbytes, bool skip_geometry)
+{
+  if (bytes == 0 || nbytes < 1)
+  {
+    fprintf(stderr,"ERROR: %.0f bytes are too few for an SMB mesh\n", (double)nbytes);
+    return false;
+  }
+  file = 0;
+  memory.open(bytes, nbytes);
+  this->skip_geometry = skip_geometry;
+  return open_stream();
+}
 
-  int input = fgetc(file);
+bool SMreader_smb::open_stream()
+{
+  int input = get_byte();
   // read version
-  if (input != SM_VERSION)
+  if (input != SM_VERSION && input != SM_VERSION_64)
   {
-    fprintf(stderr,"ERROR: wrong SMreader (need %d but this is SMreader_smb %d)\n",input,SM_VERSION);
+    fprintf(stderr,"ERROR: wrong SMreader (need %d but this is SMreader_smb %d or %d)\n",input,SM_VERSION,SM_VERSION_64);
     exit(0);
   }
+  index_64 = (input == SM_VERSION_64);
 
-  read_header();
+  if (!read_header()) return false;
   read_buffer();
 
   if (element_descriptor & 1)
@@ -76,6 +101,7 @@ void SMreader_smb::close()
 
   // close of SMreader_smb
   file = 0;
+  memory.open(0, 0);
   have_finalized = 0; next_finalized = 0;
 
   element_number = 0;
@@ -89,8 +115,11 @@ SMevent SMreader_smb::read_element()
     have_finalized = next_finalized = 0;
     if (element_descriptor & 1) // next element is a vertex
     {
-      if (endian_swap) VecCopy3fv_swap_endian(v_pos_f, (float*)(&element_buffer[element_counter*3]));
-      else VecCopy3fv(v_pos_f, (float*)(&element_buffer[element_counter*3]));
+      if (!skip_geometry)
+      {
+        if (endian_swap) VecCopy3fv_swap_endian(v_pos_f, (const float*)(&elements[element_counter*3]));
+        else VecCopy3fv(v_pos_f, (const float*)(&elements[element_counter*3]));
+      }
       v_idx = v_count;
       v_count++;
       if (post_order) {finalized_vertices[have_finalized] = v_idx; have_finalized++;}
@@ -107,21 +136,48 @@ SMevent SMreader_smb::read_element()
     }
     else // next element is a triangle
     {
-      if (endian_swap) VecCopy3iv_swap_endian(t_idx, (int*)(&element_buffer[element_counter*3]));
-      else VecCopy3iv(t_idx, (int*)(&element_buffer[element_counter*3]));
+      int element[3];
+      if (endian_swap) VecCopy3iv_swap_endian(element, &elements[element_counter*3]);
+      else VecCopy3iv(element, &elements[element_counter*3]);
+      if (index_64 && element[0] == SMB_PADDING) // the rest of the last block
+      {
+        read_buffer();
+        return read_element();
+      }
       f_count++;
       for (int i = 0; i < 3; i++)
       {
-        if (t_idx[i] < 0)
+        if (index_64)
+        {
+          // twice how many vertices it goes back plus one if it is final
+          // or twice the index plus one if it is final after the block
+          if (element[i] == SMB_FAR_CORNER)
+          {
+            t_final[i] = ((escape_buffer[escape_counter] & 1) == 1);
+            t_idx[i] = escape_buffer[escape_counter] / 2;
+            escape_counter++;
+          }
+          else
+          {
+            t_final[i] = ((element[i] & 1) == 1);
+            t_idx[i] = v_count - 1 - (element[i] - (t_final[i] ? 1 : 0)) / 2;
+          }
+          if (t_final[i])
+          {
+            finalized_vertices[have_finalized] = t_idx[i];
+            have_finalized++;
+          }
+        }
+        else if (element[i] < 0)
         {
-          t_idx[i] = v_count+t_idx[i];
+          t_idx[i] = v_count+element[i];
           t_final[i] = true;
           finalized_vertices[have_finalized] = t_idx[i];
           have_finalized++;
         }
         else
         {
-          t_idx[i] = t_idx[i]-1;
+          t_idx[i] = element[i]-1;
           t_final[i] = false;
         }
       }
@@ -140,12 +196,12 @@ SMevent SMreader_smb::read_element()
 
   if (nverts != -1 && v_count != nverts)
   {
-    fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+    fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
   }
   nverts = v_count;
   if (nfaces != -1 && f_count != nfaces)
   {
-    fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+    fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
   }
   nfaces = f_count;
   return SM_EOF;
@@ -185,47 +241,79 @@ static unsigned int swap_endian_uint(unsigned int input)
   return output;
 }
 
+static I64 swap_endian_int64(I64 input)
+{
+  I64 output;
+  for (int i = 0; i < 8; i++)
+  {
+    ((char*)&output)[i] = ((char*)&input)[7-i];
+  }
+  return output;
+}
+
 #define SM_LITTLE_ENDIAN 0
 #define SM_BIG_ENDIAN 1
 
-void SMreader_smb::read_header()
+bool SMreader_smb::read_header()
 {
   int input;
+  I64 input64;
   // read endianness
 #if (defined(i386) || defined(WIN32))   // if little endian machine
-  if (fgetc(file) == SM_LITTLE_ENDIAN) endian_swap = false;
+  if (get_byte() == SM_LITTLE_ENDIAN) endian_swap = false;
   else endian_swap = true;
 #else                                   // else big endian machine
-  if (fgetc(file) == SM_BIG_ENDIAN) endian_swap = false;
+  if (get_byte() == SM_BIG_ENDIAN) endian_swap = false;
   else endian_swap = true;
 #endif
   // read compression flags (not used yet)
-  fgetc(file);
-  fgetc(file);
+  get_byte();
+  get_byte();
   // read comments
-  fread(&input, sizeof(int), 1, file);
+  get(&input, sizeof(int), 1);
   if (endian_swap) ncomments = swap_endian_int(input);
   else ncomments = input;
   if (ncomments)
   {
     for (int i = 0; i < ncomments; i++)
     {
-      fread(&input, sizeof(int), 1, file);
+      get(&input, sizeof(int), 1);
       if (endian_swap) input = swap_endian_int(input);
       comments[i] = (char*)malloc(sizeof(char)*input);
-      fread(comments[i], sizeof(char), input, file);
+      get(comments[i], sizeof(char), input);
     }
   }
-  // read nverts
-  fread(&input, sizeof(int), 1, file);
-  if (endian_swap) input = swap_endian_int(input);
-  if (input != -1) nverts = input;
-  // read nfaces
-  fread(&input, sizeof(int), 1, file);
-  if (endian_swap) input = swap_endian_int(input);
-  if (input != -1) nfaces = input;
+  // read nverts and nfaces
+  if (index_64)
+  {
+    get(&input64, sizeof(I64), 1);
+    if (endian_swap) input64 = swap_endian_int64(input64);
+    if (input64 != -1) nverts = (SMidx)input64;
+    if (input64 != nverts && input64 != -1)
+    {
+      fprintf(stderr,"ERROR: %.0f vertices need a library compiled with SM_64BIT_INDICES\n", (double)input64);
+      return false;
+    }
+    get(&input64, sizeof(I64), 1);
+    if (endian_swap) input64 = swap_endian_int64(input64);
+    if (input64 != -1) nfaces = (SMidx)input64;
+    if (input64 != nfaces && input64 != -1)
+    {
+      fprintf(stderr,"ERROR: %.0f triangles need a library compiled with SM_64BIT_INDICES\n", (double)input64);
+      return false;
+    }
+  }
+  else
+  {
+    get(&input, sizeof(int), 1);
+    if (endian_swap) input = swap_endian_int(input);
+    if (input != -1) nverts = input;
+    get(&input, sizeof(int), 1);
+    if (endian_swap) input = swap_endian_int(input);
+    if (input != -1) nfaces = input;
+  }
   // read bounding box
-  if (getc(file))
+  if (get_byte())
   {
     if (bb_min_f) delete [] bb_min_f;
     if (bb_max_f) delete [] bb_max_f;
@@ -234,25 +322,100 @@ void SMreader_smb::read_header()
     if (endian_swap)
     {
       float temp[3];
-      fread(temp, sizeof(float), 3, file);
+      get(temp, sizeof(float), 3);
       VecCopy3fv_swap_endian(bb_min_f, temp);
-      fread(temp, sizeof(float), 3, file);
+      get(temp, sizeof(float), 3);
       VecCopy3fv_swap_endian(bb_max_f, temp);
     }
     else
     {
-      fread(bb_min_f, sizeof(float), 3, file);
-      fread(bb_max_f, sizeof(float), 3, file);
+      get(bb_min_f, sizeof(float), 3);
+      get(bb_max_f, sizeof(float), 3);
     }
   }
+  return true;
+}
+
+SMoffset SMreader_smb::tell_block() const
+{
+  return block_offset;
+}
+
+bool SMreader_smb::seek_block(SMoffset offset, SMidx v_count, SMidx f_count)
+{
+  if (file ? !sm_fseek(file, offset) : (offset < 0 || !memory.seek((size_t)offset)))
+  {
+    fprintf(stderr,"ERROR: cannot seek to block at offset %.0f\n", (double)offset);
+    return false;
+  }
+  read_buffer();
+  have_finalized = next_finalized = 0;
+  this->v_count = v_count;
+  this->f_count = f_count;
+  return true;
 }
 
 void SMreader_smb::read_buffer()
 {
-  fread(&element_descriptor, sizeof(int), 1, file);
+  SM_TRACE_BEGIN("SMreader_smb::read_buffer", "io");
+  block_offset = (file ? sm_ftell(file) : (SMoffset)memory.tell());
+  if (get(&element_descriptor, sizeof(int), 1) != 1)
+  {
+    element_number = 0;
+    element_counter = 0;
+    SM_TRACE_END("SMreader_smb::read_buffer", "io");
+    return;
+  }
   if (endian_swap) element_descriptor = swap_endian_uint(element_descriptor);
-  element_number = fread(element_buffer, sizeof(int), 32*3, file) / 3;
+  // only a full block has all 32 bits of its descriptor set (the writer
+  // shifts the descriptor of the last block down). a block of 32 vertices
+  // has nothing but positions so it can be seeked over.
+  if (skip_geometry && element_descriptor == 0xFFFFFFFF && block_offset != -1 && (file ? sm_fseek(file, block_offset + 4 + sizeof(int)*32*3) : memory.seek((size_t)block_offset + 4 + sizeof(int)*32*3)))
+  {
+    element_number = 32;
+  }
+  else if (file)
+  {
+    element_number = fread(element_buffer, sizeof(int), 32*3, file) / 3;
+    elements = element_buffer;
+  }
+  else
+  {
+    // the elements are used where they are in memory unless they are not
+    // aligned for reading them as ints and floats
+    size_t available = (memory.nbytes - memory.tell()) / (sizeof(int)*3);
+    element_number = (available > 32 ? 32 : (int)available);
+    elements = (const int*)memory.in_place(sizeof(int)*3*element_number);
+    if (((size_t)elements) & (sizeof(int)-1))
+    {
+      memcpy(element_buffer, elements, sizeof(int)*3*element_number);
+      elements = element_buffer;
+    }
+  }
   element_counter = 0;
+  // the indices of the far corners of a full block follow it
+  escape_counter = 0;
+  if (index_64 && element_number == 32)
+  {
+    int escape_number = 0;
+    for (int i = 0; i < 32; i++)
+    {
+      if ((element_descriptor >> i) & 1) continue;
+      for (int j = 0; j < 3; j++)
+      {
+        int corner = (endian_swap ? swap_endian_int(elements[i*3+j]) : elements[i*3+j]);
+        if (corner == SMB_FAR_CORNER)
+        {
+          I64 input64;
+          get(&input64, sizeof(I64), 1);
+          if (endian_swap) input64 = swap_endian_int64(input64);
+          escape_buffer[escape_number] = (SMidx)input64;
+          escape_number++;
+        }
+      }
+    }
+  }
+  SM_TRACE_END("SMreader_smb::read_buffer", "io");
 }
 
 SMreader_smb::SMreader_smb()
@@ -277,6 +440,12 @@ SMreader_smb::SMreader_smb()
   have_finalized = 0; next_finalized = 0;
 
   element_buffer = (int*)malloc(sizeof(int)*3*32);
+  elements = element_buffer;
+  escape_buffer = (SMidx*)malloc(sizeof(SMidx)*3*32);
+  escape_counter = 0;
+  index_64 = false;
+  skip_geometry = false;
+  block_offset = -1;
   element_number = 0;
   element_counter = 0;
 }
@@ -297,4 +466,5 @@ SMreader_smb::~SMreader_smb()
 
   // clean-up for SMwriter_smb interface
   free (element_buffer);
+  free (escape_buffer);
 }
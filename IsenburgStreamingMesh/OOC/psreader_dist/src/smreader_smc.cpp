@@ -43,12 +43,18 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smstats.h"
+#include "smthread.h"
+#include "mydefs.h"
 
 #define PRINT_CONTROL_OUTPUT
 #undef PRINT_CONTROL_OUTPUT
 
 #define SM_VERSION_SME 1
 #define SM_VERSION_SME_NON_FINALIZED_EOF 3
+#define SM_VERSION_SME_64 5
+#define SM_VERSION_SME_64_NON_FINALIZED_EOF 7
+#define SM_VERSION_SECTIONS 8 // added to any of the above
 
 #define SMC_START 0
 #define SMC_ADD 1
@@ -63,9 +69,13 @@ struct SMedge;
 
 typedef struct SMvertex
 {
-  SMvertex* buffer_next; // used for efficient memory management (and by the dynamic vector)
+  union
+  {
+    SMvertex* buffer_next;  // used for efficient memory management
+    int dynamicvector;      // used by the dynamic vector
+  };
   float v[3];
-  int index;
+  SMidx index;
   int use_count;
   int list_size;
   int list_alloc;
@@ -80,77 +90,448 @@ typedef struct SMedge
   float across[3];
 } SMedge;
 
-static DynamicVector* dv;
-
-static LittleCache* lc;
+typedef DynamicVector<SMvertex,&SMvertex::dynamicvector> my_vertex_vector;
 
-static FloatCompressor* fc[3];
+// with a geometry thread the connectivity is decoded ahead into blocks of
+// pending triangles. for each corner a pending triangle says whether it is
+// a new vertex and how its position is predicted. the geometry thread then
+// decodes the positions of the new vertices, sets the across positions of
+// the new edges, and copies the positions of the corners into 'pos'.
 
-static PositionQuantizerNew* pq;
-static IntegerCompressorNew* ic[3];
+#define SMC_PREDICT_OLD 0
+#define SMC_PREDICT_NONE 1
+#define SMC_PREDICT_LAST 2
+#define SMC_PREDICT_ACROSS 3
 
-// rangecoder and probability tables
+#define SMC_PENDING_BLOCK_SIZE 512
+#define SMC_PENDING_BLOCKS 4
 
-#define MAX_DEGREE_ONE 4
-#define MAX_USE_COUNT 15
+typedef struct SMpending
+{
+  SMvertex* vertices[3];
+  SMedge* edges[3];            // the edges this triangle creates or 0
+  SMedge* across;              // the edge of an across prediction
+  int predict[3];
+  unsigned char* geom_chars;   // the geometry of a new section starts here
+  int geom_nchars;
+  SMidx t_idx[3];
+  bool t_final[3];
+  int have_new;
+  int new_vertices[3];
+  int have_finalized;
+  int finalized_vertices[3];
+  float pos[3][3];
+} SMpending;
+
+typedef struct SMpendingBlock
+{
+  int number;
+  bool eof;
+  SMpending pending[SMC_PENDING_BLOCK_SIZE];
+} SMpendingBlock;
 
-static RangeDecoder* rd_conn;
-static RangeDecoder* rd_conn_op;
-static RangeDecoder* rd_conn_cache;
-static RangeDecoder* rd_conn_index;
-static RangeDecoder* rd_conn_final;
+// what the positions are decoded with. the geometry thread has a copy.
 
-static RangeDecoder* rd_geom;
+struct SMCgeometry
+{
+  PositionQuantizerNew* pq;
+  IntegerCompressorNew* ic[3];
+  FloatCompressor* fc[3];
+  RangeDecoder* rd_geom;
+
+  // with skip_geom the positions are not decoded at all when the geometry
+  // is a separate sub-stream. then there is no rd_geom. otherwise the
+  // correctors must still be decoded, but quantized positions are neither
+  // predicted nor dequantized.
+  bool skip_geom;
+
+  void decompressVertexPosition(float* n);
+  void decompressVertexPosition(const float* l, float* n);
+  void decompressVertexPosition(const float* a, const float* b, const float* c, float* n);
+};
+
+// the blocks form a ring. the connectivity is decoded into the blocks in
+// turn. each is handed to the geometry thread and handed back once it has
+// all positions. at most SMC_PENDING_BLOCKS blocks are in flight.
+
+typedef struct SMgeometryThread
+{
+  SMpendingBlock blocks[SMC_PENDING_BLOCKS];
+  SMsemaphore filled;
+  SMsemaphore decoded;
+  int fill_block;
+  int decode_block;
+  int emit_block;
+  int emit_next;
+  int in_flight;
+  bool eof;
+  // what the geometry thread decodes with
+  SMCgeometry geometry;
+  bool owns_chars;
+  unsigned char* chars;
+  SMthread thread;
+} SMgeometryThread;
 
-// is there more to encode
-static RangeModel* rmDone;
+// rangecoder and probability tables
 
-// we need to handle both versions SME and SME_NON_FINALIZED_EOF
-static int version;
+#define MAX_DEGREE_ONE 4
+#define MAX_USE_COUNT 15
 
-// what was the last operation
-static int last_op;
+// the state of the decompressor. every SMreader_smc has its own so that
+// any number of them can decompress different meshes at the same time and
+// in any thread.
 
-// codes next operation
-static RangeModel** rmOp;
+struct SMCdecoder : public SMCgeometry
+{
+  SMgeometryThread* gt;
+  SMpending* pending;
+
+  my_vertex_vector* dv;
+  LittleCache* lc;
+
+  RangeDecoder* rd_conn;
+  RangeDecoder* rd_conn_op;
+  RangeDecoder* rd_conn_cache;
+  RangeDecoder* rd_conn_index;
+  RangeDecoder* rd_conn_final;
+
+  // with sections (see SMwriter_smc.h) the connectivity and the geometry
+  // are two sub-streams that are cut into sections of triangles_per_section
+  // triangles. their bytes are read into section_conn and section_geom or,
+  // when decompressing from memory, used where they are.
+  int triangles_per_section;
+  int section_triangles;
+  FILE* section_file;
+  const unsigned char* section_bytes;
+  size_t section_nbytes;
+  unsigned char* section_conn;
+  int section_conn_alloc;
+  unsigned char* section_geom;
+  int section_geom_alloc;
+
+  // the decoder numbers the vertices in the order it meets them
+  SMidx v_decoded;
+
+  // is there more to encode
+  RangeModel* rmDone;
+
+  // we need to handle both versions SME and SME_NON_FINALIZED_EOF. each
+  // also exists with 64 bit counts in the header (see SMwriter_smc.h)
+  int version;
+  bool index_64;
+
+  // what was the last operation
+  int last_op;
+
+  // codes next operation
+  RangeModel** rmOp;
+
+  // codes non-manifoldness of start operations
+  RangeModel* rmS_Old;
+
+  // codes cache hits for start operations
+  RangeModel** rmS_Cache;
+
+  // codes add/join operations
+  RangeModel** rmAJ_Cache;
+
+  // codes fill/end operations
+  RangeModel** rmFE_Cache;
+
+  // codes vertex finalization
+  RangeModel*** rmFinalized;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_op_start;
+  int stat_op_add_join;
+  int stat_op_fill_end;
+  int stat_add_miss;
+  int stat_add_hit;
+  int stat_fill_miss;
+  int stat_fill_hit;
+  int stat_start_non_manifold;
+  int stat_add_non_manifold;
+  int stat_vertex_buffer;
+  int stat_edge_buffer;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int vertex_buffer_size;
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int* vertex_blocks_size;
+  int vertex_blocks_number;
+
+  int edge_buffer_size;
+  int edge_buffer_alloc;
+  SMedge* edge_buffer_next;
+  SMedge** edge_blocks;
+  int edge_blocks_number;
+
+  void initDecoder(RangeDecoder* rd, RangeDecoder* rd_geometry);
+  void finishDecoder();
+  bool readSectionInt(int* i);
+  bool readSectionChars(unsigned char** chars, int nchars, unsigned char** buffer, int* alloc);
+  bool skipSectionChars(int nchars);
+  bool readSection(unsigned char** conn, int* conn_nchars, unsigned char** geom, int* geom_nchars);
+  bool initSections(RangeDecoder** rd, RangeDecoder** rd_geometry);
+  bool nextSection();
+  void initModels(int compress);
+  void finishModels();
+
+  int initVertexBuffer(int size);
+  SMvertex* allocVertexBlock(int size);
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+  int initEdgeBuffer(int size);
+  SMedge* allocEdgeBlock(int size);
+  SMedge* allocEdge(const float* v);
+  void deallocEdge(SMedge* edge);
+
+  bool startGeometryThread(unsigned char* chars);
+  void stopGeometryThread();
+
+  SMidx decodeCount(RangeDecoder* rd);
 
-// codes non-manifoldness of start operations
-static RangeModel* rmS_Old;
+#ifdef PRINT_CONTROL_OUTPUT
+  void printStats();
+#endif
 
-// codes cache hits for start operations
-static RangeModel** rmS_Cache;
+  SMCdecoder();
+  ~SMCdecoder();
+};
 
-// codes add/join operations
-static RangeModel** rmAJ_Cache;
+SMCdecoder::SMCdecoder()
+{
+  pq = 0;
+  rd_geom = 0;
+  skip_geom = false;
+  gt = 0;
+  pending = 0;
+  dv = 0;
+  lc = 0;
+  triangles_per_section = 0;
+  section_triangles = 0;
+  section_file = 0;
+  section_bytes = 0;
+  section_nbytes = 0;
+  section_conn = 0;
+  section_conn_alloc = 0;
+  section_geom = 0;
+  section_geom_alloc = 0;
+  stats = 0;
 
-// codes fill/end operations
-static RangeModel** rmFE_Cache;
+  vertex_buffer_size = 0;
+  vertex_buffer_alloc = 16;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_size = 0;
+  vertex_blocks_number = 0;
 
-// codes vertex finalization
-static RangeModel*** rmFinalized;
+  edge_buffer_size = 0;
+  edge_buffer_alloc = 16;
+  edge_buffer_next = 0;
+  edge_blocks = 0;
+  edge_blocks_number = 0;
+}
 
-static void initDecoder(FILE* file)
+SMCdecoder::~SMCdecoder()
 {
-  if (file == 0)
+  int i,j;
+  for (i = 0; i < vertex_blocks_number; i++)
   {
-    fprintf(stderr,"FATAL ERROR: file pointer is zero\n");
-    exit(0);
+    for (j = 0; j < vertex_blocks_size[i]; j++)
+    {
+      if (vertex_blocks[i][j].list) free(vertex_blocks[i][j].list);
+    }
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  if (vertex_blocks_size) free(vertex_blocks_size);
+  for (i = 0; i < edge_blocks_number; i++)
+  {
+    free(edge_blocks[i]);
   }
-  rd_conn = new RangeDecoder(file);
+  if (edge_blocks) free(edge_blocks);
+  if (stats) delete stats;
+}
+
+void SMCdecoder::initDecoder(RangeDecoder* rd, RangeDecoder* rd_geometry)
+{
+  rd_conn = rd;
   rd_conn_op = rd_conn;
   rd_conn_cache = rd_conn;
   rd_conn_index = rd_conn;
   rd_conn_final = rd_conn;
-  rd_geom = rd_conn;
+  rd_geom = rd_geometry;
 }
 
-static void finishDecoder()
+void SMCdecoder::finishDecoder()
 {
   rd_conn->done();
+  if (rd_geom && rd_geom != rd_conn)
+  {
+    rd_geom->done();
+    delete rd_geom;
+  }
   delete rd_conn;
+  if (triangles_per_section)
+  {
+    // the range decoders of the sections do not close the file
+    if (section_file) fclose(section_file);
+    if (section_conn) free(section_conn);
+    if (section_geom) free(section_geom);
+    triangles_per_section = 0;
+    section_file = 0;
+    section_bytes = 0;
+    section_nbytes = 0;
+    section_conn = 0;
+    section_conn_alloc = 0;
+    section_geom = 0;
+    section_geom_alloc = 0;
+  }
+}
+
+// the numbers of the section layout are 4 byte little endian integers
+
+bool SMCdecoder::readSectionInt(int* i)
+{
+  unsigned char bytes[4];
+  if (section_file)
+  {
+    if (fread(bytes, sizeof(unsigned char), 4, section_file) != 4) return false;
+  }
+  else
+  {
+    if (section_nbytes < 4) return false;
+    memcpy(bytes, section_bytes, 4);
+    section_bytes += 4;
+    section_nbytes -= 4;
+  }
+  *i = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
+  return true;
+}
+
+bool SMCdecoder::readSectionChars(unsigned char** chars, int nchars, unsigned char** buffer, int* alloc)
+{
+  if (nchars < 0) return false;
+  if (section_file)
+  {
+    if (nchars > *alloc)
+    {
+      if (*buffer) free(*buffer);
+      *alloc = nchars;
+      *buffer = (unsigned char*)malloc(sizeof(unsigned char)*nchars);
+      if (*buffer == 0)
+      {
+        fprintf(stderr,"ERROR: malloc for %d bytes failed\n", nchars);
+        *alloc = 0;
+        return false;
+      }
+    }
+    if ((int)fread(*buffer, sizeof(unsigned char), nchars, section_file) != nchars) return false;
+    *chars = *buffer;
+  }
+  else
+  {
+    if ((size_t)nchars > section_nbytes) return false;
+    *chars = (unsigned char*)section_bytes;
+    section_bytes += nchars;
+    section_nbytes -= nchars;
+  }
+  return true;
+}
+
+bool SMCdecoder::skipSectionChars(int nchars)
+{
+  if (nchars < 0) return false;
+  if (section_file)
+  {
+    // a pipe cannot seek, so then the bytes are read and dropped
+    if (fseek(section_file, nchars, SEEK_CUR) == 0) return true;
+    unsigned char* chars;
+    return readSectionChars(&chars, nchars, &section_geom, &section_geom_alloc);
+  }
+  if ((size_t)nchars > section_nbytes) return false;
+  section_bytes += nchars;
+  section_nbytes -= nchars;
+  return true;
+}
+
+bool SMCdecoder::readSection(unsigned char** conn, int* conn_nchars, unsigned char** geom, int* geom_nchars)
+{
+  if (!readSectionInt(conn_nchars)) return false;
+  if (!readSectionInt(geom_nchars)) return false;
+  if (!readSectionChars(conn, *conn_nchars, &section_conn, &section_conn_alloc)) return false;
+  if (skip_geom)
+  {
+    *geom = 0;
+    return skipSectionChars(*geom_nchars);
+  }
+  if (gt)
+  {
+    // the geometry thread may still decode the previous section
+    unsigned char* buffer = 0;
+    int alloc = 0;
+    if (readSectionChars(geom, *geom_nchars, &buffer, &alloc)) return true;
+    if (buffer) free(buffer);
+    return false;
+  }
+  return readSectionChars(geom, *geom_nchars, &section_geom, &section_geom_alloc);
+}
+
+bool SMCdecoder::initSections(RangeDecoder** rd, RangeDecoder** rd_geometry)
+{
+  unsigned char* conn;
+  unsigned char* geom;
+  int conn_nchars, geom_nchars;
+  if (!readSectionInt(&triangles_per_section) || triangles_per_section <= 0)
+  {
+    fprintf(stderr,"ERROR: corrupt SMC section header\n");
+    triangles_per_section = 0;
+    return false;
+  }
+  if (!readSection(&conn, &conn_nchars, &geom, &geom_nchars))
+  {
+    fprintf(stderr,"ERROR: first SMC section is truncated\n");
+    return false;
+  }
+  *rd = new RangeDecoder(conn, conn_nchars);
+  *rd_geometry = (geom ? new RangeDecoder(geom, geom_nchars) : 0);
+  section_triangles = 0;
+  return true;
 }
 
-static void initModels(int compress)
+bool SMCdecoder::nextSection()
+{
+  unsigned char* conn;
+  unsigned char* geom;
+  int conn_nchars, geom_nchars;
+  if (!readSection(&conn, &conn_nchars, &geom, &geom_nchars))
+  {
+    fprintf(stderr,"ERROR: SMC section is truncated\n");
+    return false;
+  }
+  rd_conn->restart(conn, conn_nchars);
+  if (gt)
+  {
+    pending->geom_chars = geom;
+    pending->geom_nchars = geom_nchars;
+  }
+  else if (rd_geom)
+  {
+    rd_geom->restart(geom, geom_nchars);
+  }
+  section_triangles = 0;
+  return true;
+}
+
+void SMCdecoder::initModels(int compress)
 {
   int i,j;
 
@@ -211,7 +592,7 @@ static void initModels(int compress)
   }
 }
 
-static void finishModels()
+void SMCdecoder::finishModels()
 {
   int i,j;
 
@@ -262,70 +643,60 @@ static void finishModels()
   free(rmFinalized);
 }
 
-// statistics
-
-#ifdef PRINT_CONTROL_OUTPUT
-
-static int op_start = 0;
-static int op_add_join = 0;
-static int op_fill_end = 0;
-
-static int add_miss = 0;
-static int add_hit[] = {0,0,0,0,0,0};
-
-static int fill_miss = 0;
-static int fill_hit[] = {0,0,0,0,0,0,0,0,0};
-
-static int start_non_manifold = 0;
-static int add_non_manifold = 0;
-
-static int vertex_buffer_maxsize = 0;
-static int edge_buffer_maxsize = 0;
-
-#endif
-
-// efficient memory allocation
-
-static int vertex_buffer_size = 0;
-static int vertex_buffer_alloc = 16;
-static SMvertex* vertex_buffer_next = 0;
+// efficient memory allocation. every block is remembered so that the
+// destructor can give it back.
 
-static int initVertexBuffer(int size)
+SMvertex* SMCdecoder::allocVertexBlock(int size)
 {
-  vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*size);
-
-  if (vertex_buffer_next == 0)
+  SMvertex* block = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  if (block == 0)
   {
     fprintf(stderr,"malloc for vertex buffer failed\n");
     return 0;
   }
+  vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+  vertex_blocks_size = (int*)realloc(vertex_blocks_size, sizeof(int)*(vertex_blocks_number+1));
+  vertex_blocks[vertex_blocks_number] = block;
+  vertex_blocks_size[vertex_blocks_number] = size;
+  vertex_blocks_number++;
   for (int i = 0; i < size; i++)
   {
-    vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
-    vertex_buffer_next[i].list = 0;
+    block[i].buffer_next = &(block[i+1]);
+    block[i].list = 0;
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMCdecoder::initVertexBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (vertex_buffer_next)
+  {
+    vertex_buffer_size = 0;
+    return 1;
+  }
+
+  vertex_buffer_next = allocVertexBlock(size);
+
+  if (vertex_buffer_next == 0)
+  {
+    return 0;
   }
-  vertex_buffer_next[size-1].buffer_next = 0;
   vertex_buffer_alloc = size;
   vertex_buffer_size = 0;
   return 1;
 }
 
-static SMvertex* allocVertex()
+SMvertex* SMCdecoder::allocVertex()
 {
   if (vertex_buffer_next == 0)
   {
-    vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*vertex_buffer_alloc);
+    vertex_buffer_next = allocVertexBlock(vertex_buffer_alloc);
     if (vertex_buffer_next == 0)
     {
-      fprintf(stderr,"malloc for vertex buffer failed\n");
       return 0;
     }
-    for (int i = 0; i < vertex_buffer_alloc; i++)
-    {
-      vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
-      vertex_buffer_next[i].list = 0;
-    }
-    vertex_buffer_next[vertex_buffer_alloc-1].buffer_next = 0;
     vertex_buffer_alloc = 2*vertex_buffer_alloc;
   }
   // get pointer to next available vertex
@@ -342,58 +713,67 @@ static SMvertex* allocVertex()
 
   vertex_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_buffer_size > vertex_buffer_maxsize) vertex_buffer_maxsize = vertex_buffer_size;
-#endif
+  stats->level(stat_vertex_buffer, vertex_buffer_size);
 
   return vertex;
 }
 
-static void deallocVertex(SMvertex* vertex)
+void SMCdecoder::deallocVertex(SMvertex* vertex)
 {
   vertex->buffer_next = vertex_buffer_next;
   vertex_buffer_next = vertex;
   vertex_buffer_size--;
+  stats->down(stat_vertex_buffer);
 }
 
-static int edge_buffer_size = 0;
-static int edge_buffer_alloc = 16;
-static SMedge* edge_buffer_next = 0;
-
-static int initEdgeBuffer(int size)
+SMedge* SMCdecoder::allocEdgeBlock(int size)
 {
-  edge_buffer_next = (SMedge*)malloc(sizeof(SMedge)*size);
-
-  if (edge_buffer_next == 0)
+  SMedge* block = (SMedge*)malloc(sizeof(SMedge)*size);
+  if (block == 0)
   {
     fprintf(stderr,"malloc for edge buffer failed\n");
     return 0;
   }
+  edge_blocks = (SMedge**)realloc(edge_blocks, sizeof(SMedge*)*(edge_blocks_number+1));
+  edge_blocks[edge_blocks_number] = block;
+  edge_blocks_number++;
   for (int i = 0; i < size; i++)
   {
-    edge_buffer_next[i].buffer_next = &(edge_buffer_next[i+1]);
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMCdecoder::initEdgeBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (edge_buffer_next)
+  {
+    edge_buffer_size = 0;
+    return 1;
+  }
+
+  edge_buffer_next = allocEdgeBlock(size);
+
+  if (edge_buffer_next == 0)
+  {
+    return 0;
   }
-  edge_buffer_next[size-1].buffer_next = 0;
   edge_buffer_alloc = size;
   edge_buffer_size = 0;
   return 1;
 }
 
-static SMedge* allocEdge(float* v)
+SMedge* SMCdecoder::allocEdge(const float* v)
 {
   if (edge_buffer_next == 0)
   {
-    edge_buffer_next = (SMedge*)malloc(sizeof(SMedge)*edge_buffer_alloc);
+    edge_buffer_next = allocEdgeBlock(edge_buffer_alloc);
     if (edge_buffer_next == 0)
     {
-      fprintf(stderr,"malloc for edge buffer failed\n");
       return 0;
     }
-    for (int i = 0; i < edge_buffer_alloc; i++)
-    {
-      edge_buffer_next[i].buffer_next = &(edge_buffer_next[i+1]);
-    }
-    edge_buffer_next[edge_buffer_alloc-1].buffer_next = 0;
     edge_buffer_alloc = 2*edge_buffer_alloc;
   }
   // get index of next available vertex
@@ -402,28 +782,40 @@ static SMedge* allocEdge(float* v)
  
   edge->origin = 0;
   edge->target = 0;
-  VecCopy3fv(edge->across,v);
+  if (v) VecCopy3fv(edge->across,v);
 
   edge_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (edge_buffer_size > edge_buffer_maxsize) edge_buffer_maxsize = edge_buffer_size;
-#endif
+  stats->level(stat_edge_buffer, edge_buffer_size);
 
   return edge;
 }
 
-static void deallocEdge(SMedge* edge)
+void SMCdecoder::deallocEdge(SMedge* edge)
 {
   edge->buffer_next = edge_buffer_next;
   edge_buffer_next = edge;
   edge_buffer_size--;
+  stats->down(stat_edge_buffer);
+}
+
+#ifdef PRINT_CONTROL_OUTPUT
+void SMCdecoder::printStats()
+{
+  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize " SM_COUNT_FORMAT "\n",edge_buffer_size,stats->max(stat_edge_buffer));
+  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize " SM_COUNT_FORMAT "\n",vertex_buffer_size,stats->max(stat_vertex_buffer));
+  fprintf(stderr,"op_start " SM_COUNT_FORMAT " op_add_join " SM_COUNT_FORMAT " op_fill_end " SM_COUNT_FORMAT "\n",stats->value(stat_op_start),stats->value(stat_op_add_join),stats->value(stat_op_fill_end));
+  fprintf(stderr,"start_non_manifold " SM_COUNT_FORMAT " add_non_manifold " SM_COUNT_FORMAT "\n",stats->value(stat_start_non_manifold),stats->value(stat_add_non_manifold));
+  fprintf(stderr,"add_miss " SM_COUNT_FORMAT " add_hit " SM_COUNT_FORMAT " (" SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT ")\n",stats->value(stat_add_miss),stats->value(stat_add_hit),stats->get(stat_add_hit)->bins[0],stats->get(stat_add_hit)->bins[1],stats->get(stat_add_hit)->bins[2],stats->get(stat_add_hit)->bins[3],stats->get(stat_add_hit)->bins[4],stats->get(stat_add_hit)->bins[5]);
+  fprintf(stderr,"fill_miss " SM_COUNT_FORMAT " fill_hit " SM_COUNT_FORMAT " (" SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT ")\n",stats->value(stat_fill_miss),stats->value(stat_fill_hit),stats->get(stat_fill_hit)->bins[0],stats->get(stat_fill_hit)->bins[1],stats->get(stat_fill_hit)->bins[2],stats->get(stat_fill_hit)->bins[3],stats->get(stat_fill_hit)->bins[4],stats->get(stat_fill_hit)->bins[5],stats->get(stat_fill_hit)->bins[6],stats->get(stat_fill_hit)->bins[7],stats->get(stat_fill_hit)->bins[8]);
 }
+#endif
 
 // helper functions
 
-static void decompressVertexPosition(float* n)
+void SMCgeometry::decompressVertexPosition(float* n)
 {
+  if (rd_geom == 0) return;
   if (pq)
   {
     int* qn = (int*)n;
@@ -441,8 +833,9 @@ static void decompressVertexPosition(float* n)
   }
 }
 
-static void decompressVertexPosition(const float* l, float* n)
+void SMCgeometry::decompressVertexPosition(const float* l, float* n)
 {
+  if (rd_geom == 0) return;
   if (pq)
   {
     const int* ql = (const int*)l;
@@ -461,8 +854,9 @@ static void decompressVertexPosition(const float* l, float* n)
   }
 }
 
-static void decompressVertexPosition(const float* a, const float* b, const float* c, float* n)
+void SMCgeometry::decompressVertexPosition(const float* a, const float* b, const float* c, float* n)
 {
+  if (rd_geom == 0) return;
   if (pq)
   {
     const int* qa = (const int*)a;
@@ -470,9 +864,17 @@ static void decompressVertexPosition(const float* a, const float* b, const float
     const int* qc = (const int*)c;
     int* qn = (int*)n;
     int pred[3];
-    VecAdd3iv(pred, qa, qc);
-    VecSelfSubtract3iv(pred, qb);
-    pq->Clamp(pred);
+    if (skip_geom)
+    {
+      // only the correctors are needed to stay in sync
+      VecZero3iv(pred);
+    }
+    else
+    {
+      VecAdd3iv(pred, qa, qc);
+      VecSelfSubtract3iv(pred, qb);
+      pq->Clamp(pred);
+    }
     for (int i = 0; i < 3; i++)
     {
       qn[i] = ic[i]->DecompressAcross(pred[i]);
@@ -534,40 +936,240 @@ static void removeEdgeFromVertices(SMedge* edge)
   removeEdgeFromVertex(edge, edge->target);
 }
 
-bool SMreader_smc::open(FILE* file)
+// the geometry thread
+
+// the vertices and edges are only allocated and deallocated by the
+// connectivity decoder, which never touches their positions. a vertex or
+// an edge that it deallocates and allocates again is only written by the
+// geometry thread when it gets to the pending triangle that allocated it
+// again, which is after all pending triangles that used it before.
+
+static SM_THREAD_RESULT run_geometry(void* arg)
+{
+  SMgeometryThread* g = (SMgeometryThread*)arg;
+  SMCgeometry* geometry = &(g->geometry);
+  SMpendingBlock* block;
+  SMpending* p;
+  int i,j;
+
+  while (true)
+  {
+    waitSemaphore(&(g->filled));
+    block = &(g->blocks[g->decode_block]);
+    g->decode_block = (g->decode_block + 1) % SMC_PENDING_BLOCKS;
+    if (block->eof) break;
+    for (j = 0; j < block->number; j++)
+    {
+      p = &(block->pending[j]);
+      if (p->geom_chars)
+      {
+        if (g->owns_chars && g->chars) free(g->chars);
+        g->chars = p->geom_chars;
+        geometry->rd_geom->restart(p->geom_chars, p->geom_nchars);
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (p->predict[i] == SMC_PREDICT_NONE)
+        {
+          geometry->decompressVertexPosition(p->vertices[i]->v);
+        }
+        else if (p->predict[i] == SMC_PREDICT_LAST)
+        {
+          geometry->decompressVertexPosition(p->vertices[0]->v, p->vertices[i]->v);
+        }
+        else if (p->predict[i] == SMC_PREDICT_ACROSS)
+        {
+          geometry->decompressVertexPosition(p->vertices[0]->v, p->across->across, p->vertices[1]->v, p->vertices[i]->v);
+        }
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (p->edges[i]) VecCopy3fv(p->edges[i]->across, p->vertices[(i+2)%3]->v);
+        VecCopy3fv(p->pos[i], p->vertices[i]->v);
+      }
+    }
+    postSemaphore(&(g->decoded));
+  }
+  return 0;
+}
+
+bool SMCdecoder::startGeometryThread(unsigned char* chars)
+{
+  int i;
+  gt = (SMgeometryThread*)malloc(sizeof(SMgeometryThread));
+  if (gt == 0)
+  {
+    fprintf(stderr,"ERROR: malloc for the geometry thread failed\n");
+    return false;
+  }
+  initSemaphore(&(gt->filled), 0, SMC_PENDING_BLOCKS);
+  initSemaphore(&(gt->decoded), 0, SMC_PENDING_BLOCKS);
+  gt->fill_block = 0;
+  gt->decode_block = 0;
+  gt->emit_block = 0;
+  gt->emit_next = -1;
+  gt->in_flight = 0;
+  gt->eof = false;
+  gt->geometry.pq = pq;
+  for (i = 0; i < 3; i++)
+  {
+    gt->geometry.ic[i] = ic[i];
+    gt->geometry.fc[i] = fc[i];
+  }
+  gt->geometry.rd_geom = rd_geom;
+  gt->geometry.skip_geom = false;
+  gt->owns_chars = (section_file != 0);
+  gt->chars = chars;
+  if (!startThread(&(gt->thread), run_geometry, gt))
+  {
+    fprintf(stderr,"WARNING: cannot start the geometry thread. decoding without it\n");
+    destroySemaphore(&(gt->filled));
+    destroySemaphore(&(gt->decoded));
+    free(gt);
+    gt = 0;
+    return false;
+  }
+  return true;
+}
+
+void SMCdecoder::stopGeometryThread()
+{
+  // take back the blocks in flight and hand over one that says stop
+  while (gt->in_flight)
+  {
+    waitSemaphore(&(gt->decoded));
+    gt->in_flight--;
+  }
+  gt->blocks[gt->fill_block].number = 0;
+  gt->blocks[gt->fill_block].eof = true;
+  postSemaphore(&(gt->filled));
+  joinThread(&(gt->thread));
+  if (gt->owns_chars && gt->chars) free(gt->chars);
+  destroySemaphore(&(gt->filled));
+  destroySemaphore(&(gt->decoded));
+  free(gt);
+  gt = 0;
+}
+
+bool SMreader_smc::open(FILE* file, bool skip_geometry)
 {
   if (file == 0)
   {
     return false;
   }
 
-  version = fgetc(file);
   // read version
-  if (version != SM_VERSION_SME && version != SM_VERSION_SME_NON_FINALIZED_EOF)
+  decoder->version = fgetc(file);
+
+  decoder->skip_geom = skip_geometry;
+
+  if (decoder->version != EOF && (decoder->version & SM_VERSION_SECTIONS))
+  {
+    RangeDecoder* rd;
+    RangeDecoder* rd_geometry;
+    decoder->version = decoder->version & ~SM_VERSION_SECTIONS;
+    decoder->section_file = file;
+    decoder->section_bytes = 0;
+    decoder->section_nbytes = 0;
+    if (!decoder->initSections(&rd, &rd_geometry)) return false;
+    return open(rd, rd_geometry);
+  }
+
+  RangeDecoder* rd = new RangeDecoder(file);
+  return open(rd, rd);
+}
+
+bool SMreader_smc::open(const void* data, size_t nbytes, bool skip_geometry)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  if (bytes == 0 || nbytes < 2)
+  {
+    fprintf(stderr,"ERROR: %.0f bytes are too few for an SMC mesh\n", (double)nbytes);
+    return false;
+  }
+
+  // read version
+  decoder->version = bytes[0];
+
+  decoder->skip_geom = skip_geometry;
+
+  if (decoder->version & SM_VERSION_SECTIONS)
+  {
+    RangeDecoder* rd;
+    RangeDecoder* rd_geometry;
+    decoder->version = decoder->version & ~SM_VERSION_SECTIONS;
+    decoder->section_file = 0;
+    decoder->section_bytes = bytes+1;
+    decoder->section_nbytes = nbytes-1;
+    if (!decoder->initSections(&rd, &rd_geometry)) return false;
+    return open(rd, rd_geometry);
+  }
+
+  RangeDecoder* rd = new RangeDecoder((unsigned char*)(bytes+1), nbytes-1);
+  return open(rd, rd);
+}
+
+bool SMreader_smc::open(RangeDecoder* rd, RangeDecoder* rd_geometry)
+{
+  decoder->index_64 = (decoder->version == SM_VERSION_SME_64 || decoder->version == SM_VERSION_SME_64_NON_FINALIZED_EOF);
+  if (decoder->version == SM_VERSION_SME_64) decoder->version = SM_VERSION_SME;
+  else if (decoder->version == SM_VERSION_SME_64_NON_FINALIZED_EOF) decoder->version = SM_VERSION_SME_NON_FINALIZED_EOF;
+
+  if (decoder->version != SM_VERSION_SME && decoder->version != SM_VERSION_SME_NON_FINALIZED_EOF)
   {
-    fprintf(stderr,"ERROR: this is SMreader_smc (%d or %d) but data requires SMreader (%d)\n",SM_VERSION_SME,SM_VERSION_SME_NON_FINALIZED_EOF,version);
+    fprintf(stderr,"ERROR: this is SMreader_smc (%d or %d) but data requires SMreader (%d)\n",SM_VERSION_SME,SM_VERSION_SME_NON_FINALIZED_EOF,decoder->version);
     exit(0);
   }
 
-  initVertexBuffer(1024);
-  initEdgeBuffer(1024);
+  if (decoder->stats == 0)
+  {
+    decoder->stats = new SMstats("SMreader_smc");
+  }
+
+  decoder->stat_op_start = decoder->stats->add("op_start");
+  decoder->stat_op_add_join = decoder->stats->add("op_add_join");
+  decoder->stat_op_fill_end = decoder->stats->add("op_fill_end");
+  decoder->stat_add_miss = decoder->stats->add("add_miss");
+  decoder->stat_add_hit = decoder->stats->add("add_hit", SM_STATS_HISTOGRAM, 6);
+  decoder->stat_fill_miss = decoder->stats->add("fill_miss");
+  decoder->stat_fill_hit = decoder->stats->add("fill_hit", SM_STATS_HISTOGRAM, 9);
+  decoder->stat_start_non_manifold = decoder->stats->add("start_non_manifold");
+  decoder->stat_add_non_manifold = decoder->stats->add("add_non_manifold");
+  decoder->stat_vertex_buffer = decoder->stats->add("vertex_buffer", SM_STATS_LEVEL);
+  decoder->stat_edge_buffer = decoder->stats->add("edge_buffer", SM_STATS_LEVEL);
+  decoder->stats->reset();
 
-  dv = new DynamicVector();
-  lc = new LittleCache();
+  decoder->initVertexBuffer(1024);
+  decoder->initEdgeBuffer(1024);
 
-  initDecoder(file);
-  initModels(0);
+  decoder->dv = new my_vertex_vector();
+  decoder->lc = new LittleCache();
 
-  last_op = 0;
+  decoder->initDecoder(rd, rd_geometry);
+  decoder->initModels(0);
+
+  decoder->last_op = 0;
 
   // read precision
-  nbits = rd_conn->decode(25);
+  nbits = decoder->rd_conn->decode(25);
 
   v_count = 0;
   f_count = 0;
+  decoder->v_decoded = 0;
 
   read_header();
 
+  // the geometry of a stream with sections can be decoded by another thread
+  if (geometry_thread && decoder->triangles_per_section && decoder->rd_geom)
+  {
+    if (decoder->startGeometryThread(decoder->section_geom))
+    {
+      // the geometry thread owns the bytes of the first section
+      decoder->section_geom = 0;
+      decoder->section_geom_alloc = 0;
+    }
+  }
+
   return true;
 }
 
@@ -578,29 +1180,30 @@ void SMreader_smc::close()
   f_count = -1;
 
   // close of SMreader_smc
-  finishDecoder();
-  if (pq)
+  if (decoder->gt) decoder->stopGeometryThread();
+  decoder->finishDecoder();
+  if (decoder->pq)
   {
-    ic[0]->FinishDecompressor();
-    ic[1]->FinishDecompressor();
-    ic[2]->FinishDecompressor();
-    delete ic[0];
-    delete ic[1];
-    delete ic[2];
-    delete pq;
+    decoder->ic[0]->FinishDecompressor();
+    decoder->ic[1]->FinishDecompressor();
+    decoder->ic[2]->FinishDecompressor();
+    delete decoder->ic[0];
+    delete decoder->ic[1];
+    delete decoder->ic[2];
+    delete decoder->pq;
   }
   else
   {
-    delete fc[0];
-    delete fc[1];
-    delete fc[2];
+    delete decoder->fc[0];
+    delete decoder->fc[1];
+    delete decoder->fc[2];
   }
-  finishModels();
+  decoder->finishModels();
 
-  if (dv->size()) fprintf(stderr,"WARNING: there are %d unfinalized vertices\n",dv->size());
+  if (decoder->dv->size()) fprintf(stderr,"WARNING: there are %d unfinalized vertices\n",decoder->dv->size());
 
-  delete dv;
-  delete lc;
+  delete decoder->dv;
+  delete decoder->lc;
 
   nbits = -1;
   have_new = 0; next_new = 0;
@@ -619,56 +1222,83 @@ void SMreader_smc::close()
   }
 
 #ifdef PRINT_CONTROL_OUTPUT
-  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize %d\n",edge_buffer_size,edge_buffer_maxsize);
-  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize %d\n",vertex_buffer_size,vertex_buffer_maxsize);
-  fprintf(stderr,"op_start %d op_add_join %d op_fill_end %d\n",op_start,op_add_join,op_fill_end);
-  fprintf(stderr,"start_non_manifold %d add_non_manifold %d\n",start_non_manifold,add_non_manifold);
-  fprintf(stderr,"add_miss %d add_hit %d (%d %d %d %d %d %d)\n",add_miss,add_hit[0]+add_hit[1]+add_hit[2]+add_hit[3]+add_hit[4]+add_hit[5],add_hit[0],add_hit[1],add_hit[2],add_hit[3],add_hit[4],add_hit[5]);
-  fprintf(stderr,"fill_miss %d fill_hit %d (%d %d %d %d %d %d %d %d %d)\n",fill_miss,fill_hit[0]+fill_hit[1]+fill_hit[2]+fill_hit[3]+fill_hit[4]+fill_hit[5]+fill_hit[6]+fill_hit[7]+fill_hit[8],fill_hit[0],fill_hit[1],fill_hit[2],fill_hit[3],fill_hit[4],fill_hit[5],fill_hit[6],fill_hit[7],fill_hit[8]);
-#endif 
+  decoder->printStats();
+#endif
+}
+
+void SMreader_smc::set_geometry_thread(bool geometry_thread)
+{
+  this->geometry_thread = geometry_thread;
+}
+
+const SMstats* SMreader_smc::get_stats() const
+{
+  return decoder->stats;
+}
+
+// the header counts have 64 bits in the versions with 64 bit counts
+
+SMidx SMCdecoder::decodeCount(RangeDecoder* rd)
+{
+  I64 count;
+  if (index_64)
+  {
+    count = rd->decodeInt();
+    count = count | (((I64)rd->decodeInt()) << 32);
+  }
+  else
+  {
+    count = (int)rd->decodeInt();
+  }
+  if ((SMidx)count != count)
+  {
+    fprintf(stderr,"ERROR: %.0f elements need a library compiled with SM_64BIT_INDICES\n", (double)count);
+    exit(1);
+  }
+  return (SMidx)count;
 }
 
 void SMreader_smc::read_header()
 {
   // read nverts
-  if (rd_conn->decode(2))
+  if (decoder->rd_conn->decode(2))
   {
-    nverts = rd_conn->decodeInt();
+    nverts = decoder->decodeCount(decoder->rd_conn);
 #ifdef PRINT_CONTROL_OUTPUT
-    fprintf(stderr,"nverts: %d\n",nverts);
+    fprintf(stderr,"nverts: " SM_IDX_FORMAT "\n",nverts);
 #endif
   }
 
   // read nfaces
-  if (rd_conn->decode(2))
+  if (decoder->rd_conn->decode(2))
   {
-    nfaces = rd_conn->decodeInt();
+    nfaces = decoder->decodeCount(decoder->rd_conn);
 #ifdef PRINT_CONTROL_OUTPUT
-    fprintf(stderr,"nfaces: %d\n",nfaces);
+    fprintf(stderr,"nfaces: " SM_IDX_FORMAT "\n",nfaces);
 #endif
   }
 
   bool has_bb = true;
 
   // read bounding box
-  if (rd_conn->decode(2))
+  if (decoder->rd_conn->decode(2))
   {
     if (bb_min_f == 0) bb_min_f = new float[3];
-    bb_min_f[0] = rd_conn->decodeFloat();
-    bb_min_f[1] = rd_conn->decodeFloat();
-    bb_min_f[2] = rd_conn->decodeFloat();
+    bb_min_f[0] = decoder->rd_conn->decodeFloat();
+    bb_min_f[1] = decoder->rd_conn->decodeFloat();
+    bb_min_f[2] = decoder->rd_conn->decodeFloat();
   }
   else
   {
     // no bounding box min
     has_bb = false;
   }
-  if (rd_conn->decode(2))
+  if (decoder->rd_conn->decode(2))
   {
     if (bb_max_f == 0) bb_max_f = new float[3];
-    bb_max_f[0] = rd_conn->decodeFloat();
-    bb_max_f[1] = rd_conn->decodeFloat();
-    bb_max_f[2] = rd_conn->decodeFloat();
+    bb_max_f[0] = decoder->rd_conn->decodeFloat();
+    bb_max_f[1] = decoder->rd_conn->decodeFloat();
+    bb_max_f[2] = decoder->rd_conn->decodeFloat();
   }
   else
   {
@@ -677,7 +1307,7 @@ void SMreader_smc::read_header()
   }
 
   // read comments
-  if (rd_conn->decode(2))
+  if (decoder->rd_conn->decode(2))
   {
     /* yet to be implemented */
   }
@@ -686,29 +1316,29 @@ void SMreader_smc::read_header()
 
   if (has_bb && nbits)
   {
-    if (rd_conn->decode(2) == 0) // if want to use integer quantization
+    if (decoder->rd_conn->decode(2) == 0) // if want to use integer quantization
     {
-      pq = new PositionQuantizerNew();
+      decoder->pq = new PositionQuantizerNew();
 
-      pq->SetMinMax(bb_min_f, bb_max_f);
-      pq->SetPrecision(nbits);
-      pq->SetupQuantizer();
+      decoder->pq->SetMinMax(bb_min_f, bb_max_f);
+      decoder->pq->SetPrecision(nbits);
+      decoder->pq->SetupQuantizer();
 
-      ic[0] = new IntegerCompressorNew();
-      ic[1] = new IntegerCompressorNew();
-      ic[2] = new IntegerCompressorNew();
+      decoder->ic[0] = new IntegerCompressorNew();
+      decoder->ic[1] = new IntegerCompressorNew();
+      decoder->ic[2] = new IntegerCompressorNew();
 
-      ic[0]->SetRange(pq->m_aiQuantRange[0]);
-      ic[1]->SetRange(pq->m_aiQuantRange[1]);
-      ic[2]->SetRange(pq->m_aiQuantRange[2]);
+      decoder->ic[0]->SetRange(decoder->pq->m_aiQuantRange[0]);
+      decoder->ic[1]->SetRange(decoder->pq->m_aiQuantRange[1]);
+      decoder->ic[2]->SetRange(decoder->pq->m_aiQuantRange[2]);
 
-      ic[0]->SetPrecision(nbits);
-      ic[1]->SetPrecision(nbits);
-      ic[2]->SetPrecision(nbits);
+      decoder->ic[0]->SetPrecision(nbits);
+      decoder->ic[1]->SetPrecision(nbits);
+      decoder->ic[2]->SetPrecision(nbits);
 
-      ic[0]->SetupDecompressor(rd_geom);
-      ic[1]->SetupDecompressor(rd_geom);
-      ic[2]->SetupDecompressor(rd_geom);
+      decoder->ic[0]->SetupDecompressor(decoder->rd_geom);
+      decoder->ic[1]->SetupDecompressor(decoder->rd_geom);
+      decoder->ic[2]->SetupDecompressor(decoder->rd_geom);
     }
     else
     {
@@ -717,18 +1347,21 @@ void SMreader_smc::read_header()
   }
   else
   {
-    pq = 0;
-    fc[0] = new FloatCompressor();
-    fc[1] = new FloatCompressor();
-    fc[2] = new FloatCompressor();
+    decoder->pq = 0;
+    decoder->fc[0] = new FloatCompressor();
+    decoder->fc[1] = new FloatCompressor();
+    decoder->fc[2] = new FloatCompressor();
 
-    fc[0]->SetPrecision(nbits);
-    fc[1]->SetPrecision(nbits);
-    fc[2]->SetPrecision(nbits);
+    decoder->fc[0]->SetPrecision(nbits);
+    decoder->fc[1]->SetPrecision(nbits);
+    decoder->fc[2]->SetPrecision(nbits);
 
-    fc[0]->SetupDecompressor(rd_geom,0);
-    fc[1]->SetupDecompressor(rd_geom,0);
-    fc[2]->SetupDecompressor(rd_geom,0);
+    if (decoder->rd_geom)
+    {
+      decoder->fc[0]->SetupDecompressor(decoder->rd_geom,0);
+      decoder->fc[1]->SetupDecompressor(decoder->rd_geom,0);
+      decoder->fc[2]->SetupDecompressor(decoder->rd_geom,0);
+    }
   }
 }
 
@@ -746,13 +1379,18 @@ int SMreader_smc::decompress_triangle()
   SMvertex* vertices[3];
   SMedge* edges[3];
 
-  if (edge_buffer_size)
+  if (decoder->triangles_per_section && decoder->section_triangles == decoder->triangles_per_section)
   {
-    op = rd_conn_op->decode(rmOp[last_op]);
+    if (!decoder->nextSection()) return 0;
+  }
+
+  if (decoder->edge_buffer_size)
+  {
+    op = decoder->rd_conn_op->decode(decoder->rmOp[decoder->last_op]);
   }
   else
   {
-    if (rd_conn_op->decode(rmDone))
+    if (decoder->rd_conn_op->decode(decoder->rmDone))
     {
       return 0;
     }
@@ -765,29 +1403,23 @@ int SMreader_smc::decompress_triangle()
   if (op == SMC_ADD || op == SMC_JOIN)
   {
     // decode the index of v0 (-> improve with cache of with prediction)
-    lc_pos = rd_conn_cache->decode(rmAJ_Cache[last_op]);
+    lc_pos = decoder->rd_conn_cache->decode(decoder->rmAJ_Cache[decoder->last_op]);
     if (lc_pos == 6)
     {
       lc_pos = -1;
-#ifdef PRINT_CONTROL_OUTPUT
-      add_miss++;
-#endif
-      dv_index = rd_conn_index->decode(dv->size());        
-      vertices[0] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      decoder->stats->count(decoder->stat_add_miss);
+      dv_index = decoder->rd_conn_index->decode(decoder->dv->size());        
+      vertices[0] = decoder->dv->getElementWithRelativeIndex(dv_index);
     }
     else if (lc_pos < 3)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      add_hit[lc_pos]++;
-#endif
-      vertices[0] = (SMvertex*)lc->get(lc_pos);
+      decoder->stats->sample(decoder->stat_add_hit, lc_pos);
+      vertices[0] = (SMvertex*)decoder->lc->get(lc_pos);
     }
     else
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      add_hit[lc_pos]++;
-#endif
-      vertices[1] = (SMvertex*)lc->get(lc_pos-3);
+      decoder->stats->sample(decoder->stat_add_hit, lc_pos);
+      vertices[1] = (SMvertex*)decoder->lc->get(lc_pos-3);
     }
 
     if (lc_pos < 3)
@@ -807,7 +1439,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[0]->list_size; i++)
         {
           if (vertices[0]->list[i]->target == vertices[0])
@@ -843,7 +1475,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[1]->list_size; i++)
         {
           if (vertices[1]->list[i]->origin == vertices[1])
@@ -867,22 +1499,29 @@ int SMreader_smc::decompress_triangle()
     if (op == SMC_JOIN)
     {
       // an old vertex
-      dv_index = rd_conn_index->decode(dv->size());        
-      vertices[2] = (SMvertex*) dv->getElementWithRelativeIndex(dv_index);
-#ifdef PRINT_CONTROL_OUTPUT
-      add_non_manifold++;
-#endif
+      dv_index = decoder->rd_conn_index->decode(decoder->dv->size());        
+      vertices[2] = decoder->dv->getElementWithRelativeIndex(dv_index);
+      decoder->stats->count(decoder->stat_add_non_manifold);
     }
     else
     {
       // a new vertex
-      vertices[2] = allocVertex();
+      vertices[2] = decoder->allocVertex();
       // give it its index
-      vertices[2]->index = v_count + have_new;
+      vertices[2]->index = decoder->v_decoded;
+      decoder->v_decoded++;
       // decode its position
-      decompressVertexPosition(vertices[0]->v, edges[0]->across, vertices[1]->v, vertices[2]->v);
+      if (decoder->pending)
+      {
+        decoder->pending->predict[2] = SMC_PREDICT_ACROSS;
+        decoder->pending->across = edges[0];
+      }
+      else
+      {
+        decoder->decompressVertexPosition(vertices[0]->v, edges[0]->across, vertices[1]->v, vertices[2]->v);
+      }
       // insert it into the indexable data structure
-      dv->addElement(vertices[2]);
+      decoder->dv->addElement(vertices[2]);
       new_vertices[have_new] = 2;
       have_new++;
     }
@@ -891,41 +1530,31 @@ int SMreader_smc::decompress_triangle()
   }
   else if (op == SMC_FILL_END)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_fill_end++;
-#endif
+    decoder->stats->count(decoder->stat_op_fill_end);
 
     // decode which active vertex we use for this triangle
-    lc_pos = rd_conn_cache->decode(rmFE_Cache[last_op]);
+    lc_pos = decoder->rd_conn_cache->decode(decoder->rmFE_Cache[decoder->last_op]);
     if (lc_pos == 9)
     {
       lc_pos = -1;
-#ifdef PRINT_CONTROL_OUTPUT
-      fill_miss++;
-#endif
-      dv_index = rd_conn_index->decode(dv->size());
-      vertices[0] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      decoder->stats->count(decoder->stat_fill_miss);
+      dv_index = decoder->rd_conn_index->decode(decoder->dv->size());
+      vertices[0] = decoder->dv->getElementWithRelativeIndex(dv_index);
     }
     else if (lc_pos < 3)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      fill_hit[lc_pos]++;
-#endif
-      vertices[0] = (SMvertex*)lc->get(lc_pos);
+      decoder->stats->sample(decoder->stat_fill_hit, lc_pos);
+      vertices[0] = (SMvertex*)decoder->lc->get(lc_pos);
     }
     else if (lc_pos < 6)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      fill_hit[lc_pos]++;
-#endif
-      vertices[1] = (SMvertex*)lc->get(lc_pos-3);
+      decoder->stats->sample(decoder->stat_fill_hit, lc_pos);
+      vertices[1] = (SMvertex*)decoder->lc->get(lc_pos-3);
     }
     else
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      fill_hit[lc_pos]++;
-#endif
-      vertices[2] = (SMvertex*)lc->get(lc_pos-6);
+      decoder->stats->sample(decoder->stat_fill_hit, lc_pos);
+      vertices[2] = (SMvertex*)decoder->lc->get(lc_pos-6);
     }
 
     if (lc_pos < 3) // we have v0
@@ -944,7 +1573,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[0]->list_size; i++)
         {
           if (vertices[0]->list[i]->target == vertices[0])
@@ -977,7 +1606,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[0]->list_size; i++)
         {
           if (vertices[0]->list[i]->origin == vertices[0])
@@ -1012,7 +1641,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[1]->list_size; i++)
         {
           if (vertices[1]->list[i]->origin == vertices[1])
@@ -1045,7 +1674,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[0]->list_size; i++)
         {
           if (vertices[0]->list[i]->origin == vertices[0])
@@ -1080,7 +1709,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[2]->list_size; i++)
         {
           if (vertices[2]->list[i]->target == vertices[2])
@@ -1113,7 +1742,7 @@ int SMreader_smc::decompress_triangle()
       // only if there is more than one we need to decode it
       if (candidate_count > 1)
       {
-        candidate = rd_conn->decode(candidate_count);
+        candidate = decoder->rd_conn->decode(candidate_count);
         for (i = 0; i < vertices[0]->list_size; i++)
         {
           if (vertices[0]->list[i]->target == vertices[0])
@@ -1149,12 +1778,10 @@ int SMreader_smc::decompress_triangle()
   }
   else if (op == SMC_START)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_start++;
-#endif
+    decoder->stats->count(decoder->stat_op_start);
 
     // how many non-manifold vertices?
-    use_count = rd_conn_op->decode(rmS_Old);
+    use_count = decoder->rd_conn_op->decode(decoder->rmS_Old);
 
     if (use_count == 4)
     {
@@ -1166,31 +1793,31 @@ int SMreader_smc::decompress_triangle()
     if (use_count)
     {
       // an old vertex
-      lc_pos = rd_conn_cache->decode(rmS_Cache[0]);
+      lc_pos = decoder->rd_conn_cache->decode(decoder->rmS_Cache[0]);
       if (lc_pos == 3)
       {
-        dv_index = rd_conn_index->decode(dv->size());        
-        vertices[0] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+        dv_index = decoder->rd_conn_index->decode(decoder->dv->size());        
+        vertices[0] = decoder->dv->getElementWithRelativeIndex(dv_index);
       }
       else
       {
-        vertices[0] = (SMvertex*)lc->get(lc_pos);
+        vertices[0] = (SMvertex*)decoder->lc->get(lc_pos);
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      start_non_manifold++;
-#endif
+      decoder->stats->count(decoder->stat_start_non_manifold);
       use_count--;
     }
     else
     {
       // a new vertex
-      vertices[0] = allocVertex();
+      vertices[0] = decoder->allocVertex();
       // give it its index
-      vertices[0]->index = v_count + have_new;
+      vertices[0]->index = decoder->v_decoded;
+      decoder->v_decoded++;
       // decode its position
-      decompressVertexPosition(vertices[0]->v);
+      if (decoder->pending) decoder->pending->predict[0] = SMC_PREDICT_NONE;
+      else decoder->decompressVertexPosition(vertices[0]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[0]);
+      decoder->dv->addElement(vertices[0]);
       new_vertices[have_new] = 0;
       have_new++;
     }
@@ -1200,31 +1827,31 @@ int SMreader_smc::decompress_triangle()
     if (use_count)
     {
       // an old vertex
-      lc_pos = rd_conn_cache->decode(rmS_Cache[1]);
+      lc_pos = decoder->rd_conn_cache->decode(decoder->rmS_Cache[1]);
       if (lc_pos == 3)
       {
-        dv_index = rd_conn_index->decode(dv->size());        
-        vertices[1] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+        dv_index = decoder->rd_conn_index->decode(decoder->dv->size());        
+        vertices[1] = decoder->dv->getElementWithRelativeIndex(dv_index);
       }
       else
       {
-        vertices[1] = (SMvertex*)lc->get(lc_pos);
+        vertices[1] = (SMvertex*)decoder->lc->get(lc_pos);
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      start_non_manifold++;
-#endif
+      decoder->stats->count(decoder->stat_start_non_manifold);
       use_count--;
     }
     else
     {
       // a new vertex
-      vertices[1] = allocVertex();
+      vertices[1] = decoder->allocVertex();
       // give it its index
-      vertices[1]->index = v_count + have_new;
+      vertices[1]->index = decoder->v_decoded;
+      decoder->v_decoded++;
       // decode its position
-      decompressVertexPosition(vertices[0]->v, vertices[1]->v);
+      if (decoder->pending) decoder->pending->predict[1] = SMC_PREDICT_LAST;
+      else decoder->decompressVertexPosition(vertices[0]->v, vertices[1]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[1]);
+      decoder->dv->addElement(vertices[1]);
       new_vertices[have_new] = 1;
       have_new++;
     }
@@ -1234,31 +1861,31 @@ int SMreader_smc::decompress_triangle()
     if (use_count)
     {
       // an old vertex
-      lc_pos = rd_conn_cache->decode(rmS_Cache[2]);
+      lc_pos = decoder->rd_conn_cache->decode(decoder->rmS_Cache[2]);
       if (lc_pos == 3)
       {
-        dv_index = rd_conn_index->decode(dv->size());        
-        vertices[2] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+        dv_index = decoder->rd_conn_index->decode(decoder->dv->size());        
+        vertices[2] = decoder->dv->getElementWithRelativeIndex(dv_index);
       }
       else
       {
-        vertices[2] = (SMvertex*)lc->get(lc_pos);
+        vertices[2] = (SMvertex*)decoder->lc->get(lc_pos);
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      start_non_manifold++;
-#endif
+      decoder->stats->count(decoder->stat_start_non_manifold);
       use_count--;
     }
     else
     {
       // a new vertex
-      vertices[2] = allocVertex();
+      vertices[2] = decoder->allocVertex();
       // give it its index
-      vertices[2]->index = v_count + have_new;
+      vertices[2]->index = decoder->v_decoded;
+      decoder->v_decoded++;
       // decode its position
-      decompressVertexPosition(vertices[0]->v, vertices[2]->v);
+      if (decoder->pending) decoder->pending->predict[2] = SMC_PREDICT_LAST;
+      else decoder->decompressVertexPosition(vertices[0]->v, vertices[2]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[2]);
+      decoder->dv->addElement(vertices[2]);
       new_vertices[have_new] = 2;
       have_new++;
     }
@@ -1267,9 +1894,9 @@ int SMreader_smc::decompress_triangle()
     edges[2] = 0;
   }
 
-  lc->put(vertices[0], vertices[1], vertices[2]);
+  decoder->lc->put(vertices[0], vertices[1], vertices[2]);
 
-  last_op = op;
+  decoder->last_op = op;
 
   // copy vertex and triangle data into API
 
@@ -1277,6 +1904,7 @@ int SMreader_smc::decompress_triangle()
   {
     t_idx[i] = vertices[i]->index;
     t_pos_f[i] = vertices[i]->v;
+    if (decoder->pending) decoder->pending->vertices[i] = vertices[i];
   }
 
   // increment vertex use_counts, create edges, and update edge degrees
@@ -1287,15 +1915,17 @@ int SMreader_smc::decompress_triangle()
 
     if (edges[i] == 0)
     {
-      edges[i] = allocEdge(vertices[(i+2)%3]->v);
+      // the geometry thread sets the across position once it is decoded
+      edges[i] = decoder->allocEdge(decoder->pending ? 0 : vertices[(i+2)%3]->v);
       edges[i]->origin = vertices[i];
       edges[i]->target = vertices[(i+1)%3];
       addEdgeToVertices(edges[i]);
+      if (decoder->pending) decoder->pending->edges[i] = edges[i];
     }
     else
     {
       removeEdgeFromVertices(edges[i]);
-      deallocEdge(edges[i]);
+      decoder->deallocEdge(edges[i]);
     }
   }
 
@@ -1314,11 +1944,11 @@ int SMreader_smc::decompress_triangle()
       use_count = MAX_USE_COUNT-1;
     }
     
-    if (rd_conn_final->decode(rmFinalized[degree_one][use_count]))
+    if (decoder->rd_conn_final->decode(decoder->rmFinalized[degree_one][use_count]))
     {
       t_final[i] = true;
       SMvertex* vertex = vertices[i];
-      dv->removeElement(vertex);
+      decoder->dv->removeElement(vertex);
       for (j = 0; j < vertex->list_size; j++)
       {
         SMedge* edge = vertex->list[j];
@@ -1330,9 +1960,9 @@ int SMreader_smc::decompress_triangle()
         {
           removeEdgeFromVertex(edge, edge->origin);
         }
-        deallocEdge(edge);
+        decoder->deallocEdge(edge);
       }
-      deallocVertex(vertex);
+      decoder->deallocVertex(vertex);
       finalized_vertices[have_finalized] = i;
       have_finalized++;
     }
@@ -1341,6 +1971,108 @@ int SMreader_smc::decompress_triangle()
       t_final[i] = false;
     }
   }
+  decoder->section_triangles++;
+  have_triangle = 1;
+  return 1;
+}
+
+// decodes the connectivity of the next block of triangles and hands it to
+// the geometry thread
+
+bool SMreader_smc::fill_block()
+{
+  int i;
+  SMpendingBlock* block = &(decoder->gt->blocks[decoder->gt->fill_block]);
+  block->number = 0;
+  block->eof = false;
+  while (block->number < SMC_PENDING_BLOCK_SIZE)
+  {
+    decoder->pending = &(block->pending[block->number]);
+    decoder->pending->across = 0;
+    decoder->pending->geom_chars = 0;
+    for (i = 0; i < 3; i++)
+    {
+      decoder->pending->edges[i] = 0;
+      decoder->pending->predict[i] = SMC_PREDICT_OLD;
+    }
+    have_new = 0;
+    have_finalized = 0;
+    if (decompress_triangle() == 0)
+    {
+      // the last section may have nothing but the end of the stream
+      if (decoder->pending->geom_chars && decoder->gt->owns_chars) free(decoder->pending->geom_chars);
+      decoder->gt->eof = true;
+      break;
+    }
+    for (i = 0; i < 3; i++)
+    {
+      decoder->pending->t_idx[i] = t_idx[i];
+      decoder->pending->t_final[i] = t_final[i];
+      decoder->pending->new_vertices[i] = new_vertices[i];
+      decoder->pending->finalized_vertices[i] = finalized_vertices[i];
+    }
+    decoder->pending->have_new = have_new;
+    decoder->pending->have_finalized = have_finalized;
+    block->number++;
+  }
+  decoder->pending = 0;
+  have_new = 0;
+  have_finalized = 0;
+  have_triangle = 0;
+  if (block->number == 0) return false;
+  postSemaphore(&(decoder->gt->filled));
+  decoder->gt->fill_block = (decoder->gt->fill_block + 1) % SMC_PENDING_BLOCKS;
+  decoder->gt->in_flight++;
+  return true;
+}
+
+// the next triangle comes either directly from the decoder or from the
+// block that the geometry thread finished first
+
+int SMreader_smc::next_triangle()
+{
+  if (decoder->gt == 0)
+  {
+    return decompress_triangle();
+  }
+
+  SMpendingBlock* block = &(decoder->gt->blocks[decoder->gt->emit_block]);
+
+  if (decoder->gt->emit_next == -1 || decoder->gt->emit_next == block->number)
+  {
+    if (decoder->gt->emit_next != -1)
+    {
+      // all its triangles were read so the block can be filled again
+      decoder->gt->emit_block = (decoder->gt->emit_block + 1) % SMC_PENDING_BLOCKS;
+      decoder->gt->emit_next = -1;
+    }
+    while (!decoder->gt->eof && decoder->gt->in_flight < SMC_PENDING_BLOCKS)
+    {
+      if (!fill_block()) break;
+    }
+    if (decoder->gt->in_flight == 0)
+    {
+      return 0;
+    }
+    waitSemaphore(&(decoder->gt->decoded));
+    decoder->gt->in_flight--;
+    decoder->gt->emit_next = 0;
+    block = &(decoder->gt->blocks[decoder->gt->emit_block]);
+  }
+
+  SMpending* p = &(block->pending[decoder->gt->emit_next]);
+  decoder->gt->emit_next++;
+
+  for (int i = 0; i < 3; i++)
+  {
+    t_idx[i] = p->t_idx[i];
+    t_final[i] = p->t_final[i];
+    t_pos_f[i] = p->pos[i];
+    new_vertices[i] = p->new_vertices[i];
+    finalized_vertices[i] = p->finalized_vertices[i];
+  }
+  have_new = p->have_new;
+  have_finalized = p->have_finalized;
   have_triangle = 1;
   return 1;
 }
@@ -1351,16 +2083,16 @@ SMevent SMreader_smc::read_element()
   {
     next_new = 0;
     have_finalized = next_finalized = 0;
-    if (decompress_triangle() == 0)
+    if (next_triangle() == 0)
     {
       if (nverts != -1 && v_count != nverts)
       {
-        fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
       }
       nverts = v_count;
       if (nfaces != -1 && f_count != nfaces)
       {
-        fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
       }
       nfaces = f_count;
       have_triangle = -1;
@@ -1370,9 +2102,13 @@ SMevent SMreader_smc::read_element()
   if (have_new)
   {
     v_idx = t_idx[new_vertices[next_new]];
-    if (pq)
+    if (decoder->skip_geom)
+    {
+      // v_pos_f is not set
+    }
+    else if (decoder->pq)
     {
-      pq->DeQuantize((int*) t_pos_f[new_vertices[next_new]], v_pos_f);
+      decoder->pq->DeQuantize((int*) t_pos_f[new_vertices[next_new]], v_pos_f);
     }
     else
     {
@@ -1401,16 +2137,16 @@ SMevent SMreader_smc::read_event()
   {
     next_new = 0;
     next_finalized = 0;
-    if (decompress_triangle() == 0)
+    if (next_triangle() == 0)
     {
       if (nverts != -1 && v_count != nverts)
       {
-        fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
       }
       nverts = v_count;
       if (nfaces != -1 && f_count != nfaces)
       {
-        fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
       }
       nfaces = f_count;
       have_triangle = -1;
@@ -1420,9 +2156,13 @@ SMevent SMreader_smc::read_event()
   if (have_new)
   {
     v_idx = t_idx[new_vertices[next_new]];
-    if (pq)
+    if (decoder->skip_geom)
+    {
+      // v_pos_f is not set
+    }
+    else if (decoder->pq)
     {
-      pq->DeQuantize((int*) t_pos_f[new_vertices[next_new]], v_pos_f);
+      decoder->pq->DeQuantize((int*) t_pos_f[new_vertices[next_new]], v_pos_f);
     }
     else
     {
@@ -1471,13 +2211,18 @@ SMreader_smc::SMreader_smc()
 
   // init of SMreader_smc
   nbits = -1;
+  geometry_thread = false;
   have_new = 0; next_new = 0;
   have_triangle = 0;
   have_finalized = 0; next_finalized = 0;
+
+  decoder = new SMCdecoder();
 }
 
 SMreader_smc::~SMreader_smc()
 {
+  delete decoder;
+
   if (comments)
   {
     for (int i = 0; i < ncomments; i++)
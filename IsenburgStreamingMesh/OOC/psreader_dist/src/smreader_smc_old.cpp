@@ -65,7 +65,7 @@ typedef struct SMvertex
   int dynamicvector; // used by dynamicvector data structure
   SMvertex* buffer_next;    // used for efficient memory management
   float v[3];
-  int index;
+  SMidx index;
   int use_count;
   int degree_one;
   int list_size;
@@ -82,7 +82,9 @@ typedef struct SMedge
   float across[3];
 } SMedge;
 
-static DynamicVector* dv;
+typedef DynamicVector<SMvertex,&SMvertex::dynamicvector> my_vertex_vector;
+
+static my_vertex_vector* dv;
 
 static LittleCache* lc;
 
@@ -543,7 +545,7 @@ bool SMreader_smc_old::open(FILE* file)
 
   initVertexBuffer(1024);
   initEdgeBuffer(1024);
-  dv = new DynamicVector();
+  dv = new my_vertex_vector();
   lc = new LittleCache();
   initDecoder(file);
   initModels(0);
@@ -617,14 +619,14 @@ void SMreader_smc_old::read_header()
   if (rd_conn->decode(2))
   {
     nverts = rd_conn->decodeInt();
-    PRINT_CONTROL_OUTPUT(stderr,"nverts: %d\n",nverts);
+    PRINT_CONTROL_OUTPUT(stderr,"nverts: " SM_IDX_FORMAT "\n",nverts);
   }
 
   // read nfaces
   if (rd_conn->decode(2))
   {
     nfaces = rd_conn->decodeInt();
-    PRINT_CONTROL_OUTPUT(stderr,"nfaces: %d\n",nfaces);
+    PRINT_CONTROL_OUTPUT(stderr,"nfaces: " SM_IDX_FORMAT "\n",nfaces);
   }
 
   bool has_bb = true;
@@ -768,7 +770,7 @@ int SMreader_smc_old::decompress_triangle()
     {
       add_miss++;
       dv_index = rd_conn_index->decode(dv->size());        
-      v0 = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      v0 = dv->getElementWithRelativeIndex(dv_index);
       PRINT_DEBUG_OUTPUT(stderr, "m%d ", dv_index);
     }
     else
@@ -854,7 +856,7 @@ int SMreader_smc_old::decompress_triangle()
     {
       // an old vertex
       dv_index = rd_conn_index->decode(dv->size());        
-      v2 = (SMvertex*) dv->getElementWithRelativeIndex(dv_index);
+      v2 = dv->getElementWithRelativeIndex(dv_index);
       add_non_manifold++;
       PRINT_DEBUG_OUTPUT(stderr, "AJNM %d ",dv_index);
     }
@@ -887,7 +889,7 @@ int SMreader_smc_old::decompress_triangle()
     {
       fill_miss++;
       dv_index = rd_conn_index->decode(dv->size());
-      v0 = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      v0 = dv->getElementWithRelativeIndex(dv_index);
       PRINT_DEBUG_OUTPUT(stderr, "m%d ", dv_index);
     }
     else
@@ -1064,7 +1066,7 @@ int SMreader_smc_old::decompress_triangle()
     {
       // an old vertex
       dv_index = rd_conn_index->decode(dv->size());        
-      v0 = (SMvertex*) dv->getElementWithRelativeIndex(dv_index);
+      v0 = dv->getElementWithRelativeIndex(dv_index);
       start_non_manifold++;
       PRINT_DEBUG_OUTPUT(stderr, "SNM0 ");
     }
@@ -1088,7 +1090,7 @@ int SMreader_smc_old::decompress_triangle()
     {
       // an old vertex
       dv_index = rd_conn_index->decode(dv->size());        
-      v1 = (SMvertex*) dv->getElementWithRelativeIndex(dv_index);
+      v1 = dv->getElementWithRelativeIndex(dv_index);
       start_non_manifold++;
       PRINT_DEBUG_OUTPUT(stderr, "SNM1 ");
     }
@@ -1112,7 +1114,7 @@ int SMreader_smc_old::decompress_triangle()
     {
       // an old vertex
       dv_index = rd_conn_index->decode(dv->size());        
-      v2 = (SMvertex*) dv->getElementWithRelativeIndex(dv_index);
+      v2 = dv->getElementWithRelativeIndex(dv_index);
       start_non_manifold++;
       PRINT_DEBUG_OUTPUT(stderr, "SNM2 ");
     }
@@ -1231,12 +1233,12 @@ SMevent SMreader_smc_old::read_element()
     {
       if (nverts != -1 && v_count != nverts)
       {
-        fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
       }
       nverts = v_count;
       if (nfaces != -1 && f_count != nfaces)
       {
-        fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
       }
       nfaces = f_count;
       return SM_EOF;
@@ -1276,12 +1278,12 @@ SMevent SMreader_smc_old::read_event()
     {
       if (nverts != -1 && v_count != nverts)
       {
-        fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
       }
       nverts = v_count;
       if (nfaces != -1 && f_count != nfaces)
       {
-        fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
       }
       nfaces = f_count;
       return SM_EOF;
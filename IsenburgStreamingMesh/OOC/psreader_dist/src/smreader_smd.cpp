@@ -44,6 +44,7 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smstats.h"
 
 #define PRINT_CONTROL_OUTPUT
 #undef PRINT_CONTROL_OUTPUT
@@ -64,9 +65,13 @@ struct SMedge;
 
 typedef struct SMvertex
 {
-  SMvertex* buffer_next;    // used for efficient memory management (and also for the dynamic vector)
+  union
+  {
+    SMvertex* buffer_next;  // used for efficient memory management
+    int dynamicvector;      // used by the dynamic vector
+  };
   float v[3];
-  int index;
+  SMidx index;
   int use_count;
   int list_size;
   int list_alloc;
@@ -75,17 +80,24 @@ typedef struct SMvertex
 
 typedef struct SMedge
 {
-  SMedge* buffer_next; // used for efficient memory management (and also for the dynamic queue)
+  union
+  {
+    SMedge* buffer_next;    // used for efficient memory management
+    int dynamicqueue;       // used by the dynamic queue
+  };
   SMvertex* origin;
   SMvertex* target;
   float across[3];
 } SMedge;
 
+typedef DynamicQueue<SMedge,&SMedge::dynamicqueue> my_edge_queue;
+typedef DynamicVector<SMvertex,&SMvertex::dynamicvector> my_vertex_vector;
+
 static int next_waiting = 100;
-static DynamicQueue* traversal_queue; // for edges on the traversal front
+static my_edge_queue* traversal_queue; // for edges on the traversal front
 static LittleCache* little_cache; // for subsequent traversal front misses?
 
-static DynamicVector* dv;
+static my_vertex_vector* dv;
 
 static PositionQuantizerNew* pq;
 static IntegerCompressorNew* ic[3];
@@ -106,6 +118,11 @@ static RangeDecoder* rd_conn_final;
 
 static RangeDecoder* rd_geom;
 
+// the geometry shares the range decoder with the connectivity, so its
+// correctors must be decoded even when it is skipped. but quantized
+// positions are then neither predicted nor dequantized.
+static bool skip_geom;
+
 // is there more to encode
 static RangeModel* rmDone;
 
@@ -123,14 +140,9 @@ static RangeModel* rmLeft;
 // used for vertex finalization
 static RangeModel*** rmFinalized;
 
-static void initDecoder(FILE* file)
+static void initDecoder(RangeDecoder* rd)
 {
-  if (file == 0)
-  {
-    fprintf(stderr,"FATAL ERROR: file pointer is zero\n");
-    exit(0);
-  }
-  rd_conn = new RangeDecoder(file);
+  rd_conn = rd;
   rd_conn_op = rd_conn;
   rd_conn_rl = rd_conn;
   rd_conn_index = rd_conn;
@@ -220,29 +232,24 @@ static void finishModels()
 
 // statistics
 
-#ifdef PRINT_CONTROL_OUTPUT
-
-static int op_start = 0;
-static int op_add = 0;
-static int op_join = 0;
-static int op_fill = 0;
-static int op_end = 0;
-static int op_skip = 0;
-static int op_border = 0;
-
-static int prediction_none = 0;
-static int prediction_last = 0;
-static int prediction_across = 0;
-
-static int right_confirm = 0;
-static int right_correct = 0;
-static int left_confirm = 0;
-static int left_correct = 0;
-
-static int vertex_buffer_maxsize = 0;
-static int edge_buffer_maxsize = 0;
-
-#endif
+static SMstats stats("SMreader_smd");
+
+static int stat_op_start;
+static int stat_op_add;
+static int stat_op_join;
+static int stat_op_fill;
+static int stat_op_end;
+static int stat_op_skip;
+static int stat_op_border;
+static int stat_prediction_none;
+static int stat_prediction_last;
+static int stat_prediction_across;
+static int stat_right_confirm;
+static int stat_right_correct;
+static int stat_left_confirm;
+static int stat_left_correct;
+static int stat_vertex_buffer;
+static int stat_edge_buffer;
 
 // efficient memory allocation
 
@@ -302,9 +309,7 @@ static SMvertex* allocVertex()
 
   vertex_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_buffer_size > vertex_buffer_maxsize) vertex_buffer_maxsize = vertex_buffer_size;
-#endif
+  stats.level(stat_vertex_buffer, vertex_buffer_size);
 
   return vertex;
 }
@@ -314,6 +319,7 @@ static void deallocVertex(SMvertex* vertex)
   vertex->buffer_next = vertex_buffer_next;
   vertex_buffer_next = vertex;
   vertex_buffer_size--;
+  stats.down(stat_vertex_buffer);
 }
 
 static int edge_buffer_size = 0;
@@ -366,9 +372,7 @@ static SMedge* allocEdge(float* v)
 
   edge_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (edge_buffer_size > edge_buffer_maxsize) edge_buffer_maxsize = edge_buffer_size;
-#endif
+  stats.level(stat_edge_buffer, edge_buffer_size);
 
   return edge;
 }
@@ -378,6 +382,7 @@ static void deallocEdge(SMedge* edge)
   edge->buffer_next = edge_buffer_next;
   edge_buffer_next = edge;
   edge_buffer_size--;
+  stats.down(stat_edge_buffer);
 }
 
 // helper functions
@@ -430,9 +435,17 @@ static void decompressVertexPosition(const float* a, const float* b, const float
     const int* qc = (const int*)c;
     int* qn = (int*)n;
     int pred[3];
-    VecAdd3iv(pred, qa, qc);
-    VecSelfSubtract3iv(pred, qb);
-    pq->Clamp(pred);
+    if (skip_geom)
+    {
+      // only the correctors are needed to stay in sync
+      VecZero3iv(pred);
+    }
+    else
+    {
+      VecAdd3iv(pred, qa, qc);
+      VecSelfSubtract3iv(pred, qb);
+      pq->Clamp(pred);
+    }
     for (int i = 0; i < 3; i++)
     {
       qn[i] = ic[i]->DecompressAcross(pred[i]);
@@ -490,12 +503,13 @@ static void removeEdgeFromVertices(SMedge* edge)
 
 #define SM_VERSION 2 // this is SMD
 
-bool SMreader_smd::open(FILE* file)
+bool SMreader_smd::open(FILE* file, bool skip_geometry)
 {
   if (file == 0)
   {
     return false;
   }
+  skip_geom = skip_geometry;
 
   int input = fgetc(file);
   // read version
@@ -505,15 +519,59 @@ bool SMreader_smd::open(FILE* file)
     exit(0);
   }
 
+  return open(new RangeDecoder(file));
+}
+
+bool SMreader_smd::open(const void* data, size_t nbytes, bool skip_geometry)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  if (bytes == 0 || nbytes < 2)
+  {
+    fprintf(stderr,"ERROR: %.0f bytes are too few for an SMD mesh\n", (double)nbytes);
+    return false;
+  }
+  skip_geom = skip_geometry;
+
+  // read version
+  if (bytes[0] != SM_VERSION)
+  {
+    fprintf(stderr,"ERROR: wrong SMreader (need %d but this is SMreader_smd %d)\n",bytes[0],SM_VERSION);
+    exit(0);
+  }
+
+  return open(new RangeDecoder((unsigned char*)(bytes+1), nbytes-1));
+}
+
+bool SMreader_smd::open(RangeDecoder* rd)
+{
+
+  stat_op_start = stats.add("op_start");
+  stat_op_add = stats.add("op_add");
+  stat_op_join = stats.add("op_join");
+  stat_op_fill = stats.add("op_fill");
+  stat_op_end = stats.add("op_end");
+  stat_op_skip = stats.add("op_skip");
+  stat_op_border = stats.add("op_border");
+  stat_prediction_none = stats.add("prediction_none");
+  stat_prediction_last = stats.add("prediction_last");
+  stat_prediction_across = stats.add("prediction_across");
+  stat_right_confirm = stats.add("right_confirm");
+  stat_right_correct = stats.add("right_correct");
+  stat_left_confirm = stats.add("left_confirm");
+  stat_left_correct = stats.add("left_correct");
+  stat_vertex_buffer = stats.add("vertex_buffer", SM_STATS_LEVEL);
+  stat_edge_buffer = stats.add("edge_buffer", SM_STATS_LEVEL);
+  stats.reset();
+
   initVertexBuffer(1024);
   initEdgeBuffer(1024);
 
-  traversal_queue = new DynamicQueue();
+  traversal_queue = new my_edge_queue();
   little_cache = new LittleCache();
 
-  dv = new DynamicVector();
+  dv = new my_vertex_vector();
 
-  initDecoder(file);
+  initDecoder(rd);
   initModels(0);
 
   // read precision
@@ -574,12 +632,17 @@ void SMreader_smd::close()
   have_finalized = 0; next_finalized = 0;
 
 #ifdef PRINT_CONTROL_OUTPUT
-  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize %d\n",edge_buffer_size,edge_buffer_maxsize);
-  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize %d\n",vertex_buffer_size,vertex_buffer_maxsize);
-  fprintf(stderr,"start %d add %d join %d fill %d end %d skip %d border %d\n",op_start,op_add,op_join,op_fill,op_end,op_skip,op_border);
+  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize " SM_COUNT_FORMAT "\n",edge_buffer_size,stats.max(stat_edge_buffer));
+  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize " SM_COUNT_FORMAT "\n",vertex_buffer_size,stats.max(stat_vertex_buffer));
+  fprintf(stderr,"start " SM_COUNT_FORMAT " add " SM_COUNT_FORMAT " join " SM_COUNT_FORMAT " fill " SM_COUNT_FORMAT " end " SM_COUNT_FORMAT " skip " SM_COUNT_FORMAT " border " SM_COUNT_FORMAT "\n",stats.value(stat_op_start),stats.value(stat_op_add),stats.value(stat_op_join),stats.value(stat_op_fill),stats.value(stat_op_end),stats.value(stat_op_skip),stats.value(stat_op_border));
 #endif
 }
 
+const SMstats* SMreader_smd::get_stats() const
+{
+  return &stats;
+}
+
 void SMreader_smd::read_header()
 {
   // read nverts
@@ -712,9 +775,7 @@ bool SMreader_smd::decompress_triangle_waiting()
 
   if (op == SMC_START)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_start++;
-#endif
+    stats.count(stat_op_start);
 
     candidate = rd_conn_op->decode(rmWhichStart);
 
@@ -725,7 +786,7 @@ bool SMreader_smd::decompress_triangle_waiting()
       // decode v0's relative index 
       dv_index = rd_conn_index->decode(dv->size());
       // get v0 among all active vertices
-      vertices[0] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      vertices[0] = dv->getElementWithRelativeIndex(dv_index);
       // decrement non-manifold start vertex counter
       candidate--;
     }
@@ -750,7 +811,7 @@ bool SMreader_smd::decompress_triangle_waiting()
       // decode v1's relative index 
       dv_index = rd_conn_index->decode(dv->size());
       // get v1 among all active vertices
-      vertices[1] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      vertices[1] = dv->getElementWithRelativeIndex(dv_index);
       // decrement non-manifold start vertex counter
       candidate--;
     }
@@ -775,7 +836,7 @@ bool SMreader_smd::decompress_triangle_waiting()
       // decode v2's relative index 
       dv_index = rd_conn_index->decode(dv->size());
       // get v1 among all active vertices
-      vertices[2] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      vertices[2] = dv->getElementWithRelativeIndex(dv_index);
       // statistics
       candidate--;
     }
@@ -806,7 +867,7 @@ bool SMreader_smd::decompress_triangle_waiting()
     // decode v0's relative index 
     dv_index = rd_conn_index->decode(dv->size());
     // get v0 among all active vertices
-    vertices[0] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+    vertices[0] = dv->getElementWithRelativeIndex(dv_index);
 
     // decode e0
 
@@ -846,9 +907,7 @@ bool SMreader_smd::decompress_triangle_waiting()
 
     if (op == SMC_ADD)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_add++;
-#endif
+      stats.count(stat_op_add);
       // allocate new vertex
       vertices[2] = allocVertex();
       // give it its index
@@ -866,13 +925,11 @@ bool SMreader_smd::decompress_triangle_waiting()
     }
     else if (op == SMC_JOIN)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_join++;
-#endif
+      stats.count(stat_op_join);
        // decode v2's relative index 
       dv_index = rd_conn_index->decode(dv->size());
       // get v1 among all active vertices
-      vertices[2] = (SMvertex*)dv->getElementWithRelativeIndex(dv_index);
+      vertices[2] = dv->getElementWithRelativeIndex(dv_index);
       // two edges are not known
       edges[1] = 0;
       edges[2] = 0;
@@ -925,16 +982,14 @@ bool SMreader_smd::decompress_triangle_waiting()
           break;
         }
       }
-#ifdef PRINT_CONTROL_OUTPUT
       if (edges[1])
       {
-        op_end++;
+        stats.count(stat_op_end);
       }
       else
       {
-        op_fill++;
+        stats.count(stat_op_fill);
       }
-#endif
     }
   }
 
@@ -963,7 +1018,7 @@ bool SMreader_smd::decompress_triangle_waiting()
     }
     else
     {
-      if (((int*)edges[i])[0] >= 0)
+      if (edges[i]->dynamicqueue >= 0)
       {
         traversal_queue->removeElement(edges[i]);
       }
@@ -1009,7 +1064,7 @@ bool SMreader_smd::decompress_triangle_waiting()
         {
           removeEdgeFromVertex(edge, edge->origin);
         }
-        if (((int*)edge)[0] >= 0) traversal_queue->removeElement(edge);
+        if (edge->dynamicqueue >= 0) traversal_queue->removeElement(edge);
         deallocEdge(edge);
       }
       finalized_vertices[have_finalized] = i;
@@ -1034,7 +1089,7 @@ bool SMreader_smd::decompress_triangle_traversal()
   SMedge* edges[3];
   SMvertex* vertices[3];
 
-  edges[0] = (SMedge*)traversal_queue->getAndRemoveFirstElement();
+  edges[0] = traversal_queue->getAndRemoveFirstElement();
 
   vertices[0] = edges[0]->target;
   vertices[1] = edges[0]->origin;
@@ -1050,9 +1105,7 @@ bool SMreader_smd::decompress_triangle_traversal()
 
   if (op == SMC_ADD)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_add++;
-#endif
+    stats.count(stat_op_add);
     // allocate new vertex
     vertices[2] = allocVertex();
     // give it its index
@@ -1071,17 +1124,13 @@ bool SMreader_smd::decompress_triangle_traversal()
       if (rd_conn_rl->decode(rmRight) == 0) // confirm
       {
         PRINT_DEBUG_OUTPUT(stderr, "r0 ");
-#ifdef PRINT_CONTROL_OUTPUT
-        right_confirm++;
-#endif
+        stats.count(stat_right_confirm);
         i = 1;
       }
       else // correct
       {
         PRINT_DEBUG_OUTPUT(stderr, "r1 ");
-#ifdef PRINT_CONTROL_OUTPUT
-        right_correct++;
-#endif
+        stats.count(stat_right_correct);
         i = 0;
       }
     }
@@ -1090,17 +1139,13 @@ bool SMreader_smd::decompress_triangle_traversal()
       if (rd_conn_rl->decode(rmLeft) == 0) // confirm
       {
         PRINT_DEBUG_OUTPUT(stderr, "l0 ");
-#ifdef PRINT_CONTROL_OUTPUT
-        left_confirm++;
-#endif
+        stats.count(stat_left_confirm);
         i = 0;
       }
       else // correct
       {
         PRINT_DEBUG_OUTPUT(stderr, "l1 ");
-#ifdef PRINT_CONTROL_OUTPUT
-        left_correct++;
-#endif
+        stats.count(stat_left_correct);
         i = 1;
       }
     }
@@ -1149,16 +1194,14 @@ bool SMreader_smd::decompress_triangle_traversal()
           break;
         }
       }
-#ifdef PRINT_CONTROL_OUTPUT
       if (edges[2])
       {
-        op_end++;
+        stats.count(stat_op_end);
       }
       else
       {
-        op_fill++;
+        stats.count(stat_op_fill);
       }
-#endif
     }
     else if (i == 0)
     {
@@ -1204,33 +1247,27 @@ bool SMreader_smd::decompress_triangle_traversal()
           break;
         }
       }
-#ifdef PRINT_CONTROL_OUTPUT
       if (edges[1])
       {
-        op_end++;
+        stats.count(stat_op_end);
       }
       else
       {
-        op_fill++;
+        stats.count(stat_op_fill);
       }
-#endif
     }
   }
   else if (op == SMC_JOIN)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_join++;
-#endif
+    stats.count(stat_op_join);
     // decode v2's relative index
     i = rd_conn_index->decode(dv->size());        
     // get v2 among all active vertices
-    vertices[2] = (SMvertex*)dv->getElementWithRelativeIndex(i);
+    vertices[2] = dv->getElementWithRelativeIndex(i);
   }
   else if (op == SMC_BORDER)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_border++;
-#endif
+    stats.count(stat_op_border);
     removeEdgeFromVertex(edges[0],vertices[0]);
     removeEdgeFromVertex(edges[0],vertices[1]);
     deallocEdge(edges[0]);
@@ -1242,9 +1279,7 @@ bool SMreader_smd::decompress_triangle_traversal()
   }
   else if (op == SMC_SKIP)
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_skip++;
-#endif
+    stats.count(stat_op_skip);
     ((int*)(edges[0]))[0] = -1; // mark edge as no longer being in the queue
     return false;
   }
@@ -1267,7 +1302,7 @@ bool SMreader_smd::decompress_triangle_traversal()
 
   if (edges[1])
   {
-    if (((int*)edges[1])[0] >= 0)
+    if (edges[1]->dynamicqueue >= 0)
     {
       traversal_queue->removeElement(edges[1]);
     }
@@ -1289,7 +1324,7 @@ bool SMreader_smd::decompress_triangle_traversal()
 
   if (edges[2])
   {
-    if (((int*)edges[2])[0] >= 0)
+    if (edges[2]->dynamicqueue >= 0)
     {
       traversal_queue->removeElement(edges[2]);
     }
@@ -1355,7 +1390,7 @@ bool SMreader_smd::decompress_triangle_traversal()
             // this check also needs to occur elsewhere
           }
         }
-        if (((int*)edge)[0] >= 0) traversal_queue->removeElement(edge);
+        if (edge->dynamicqueue >= 0) traversal_queue->removeElement(edge);
         deallocEdge(edge);
       }
       finalized_vertices[have_finalized] = i;
@@ -1404,12 +1439,12 @@ SMevent SMreader_smd::read_element()
     {
       if (nverts != -1 && v_count != nverts)
       {
-        fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
       }
       nverts = v_count;
       if (nfaces != -1 && f_count != nfaces)
       {
-        fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
       }
       nfaces = f_count;
       have_triangle = -1;
@@ -1419,7 +1454,11 @@ SMevent SMreader_smd::read_element()
   if (have_new)
   {
     v_idx = t_idx[new_vertices[next_new]];
-    if (pq)
+    if (skip_geom)
+    {
+      // v_pos_f is not set
+    }
+    else if (pq)
     {
       pq->DeQuantize((int*) t_pos_f[new_vertices[next_new]], v_pos_f);
     }
@@ -1454,12 +1493,12 @@ SMevent SMreader_smd::read_event()
     {
       if (nverts != -1 && v_count != nverts)
       {
-        fprintf(stderr,"WARNING: wrong vertex count: v_count (%d) != nverts (%d)\n", v_count, nverts);
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
       }
       nverts = v_count;
       if (nfaces != -1 && f_count != nfaces)
       {
-        fprintf(stderr,"WARNING: wrong face count: f_count (%d) != nfaces (%d)\n", f_count, nfaces);
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
       }
       nfaces = f_count;
       have_triangle = -1;
@@ -1469,7 +1508,11 @@ SMevent SMreader_smd::read_event()
   if (have_new)
   {
     v_idx = t_idx[new_vertices[next_new]];
-    if (pq)
+    if (skip_geom)
+    {
+      // v_pos_f is not set
+    }
+    else if (pq)
     {
       pq->DeQuantize((int*) t_pos_f[new_vertices[next_new]], v_pos_f);
     }
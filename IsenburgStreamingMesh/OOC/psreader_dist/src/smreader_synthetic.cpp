@@ -0,0 +1,621 @@
+/*
+===============================================================================
+
+  FILE:  SMreader_synthetic.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreader_synthetic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PI 3.141592653589793
+
+// the corners of the triangles of a quad in strip s between vertex row s
+// (BOTTOM) and vertex row s+1 (TOP). column 0 is the column of the quad and
+// column 1 the next column. the optional third triangle is the 'fin' on the
+// diagonal of the quad that makes this diagonal a non-manifold edge.
+//
+//   d---e      t0 = (a,d,b)
+//   |\  |      t1 = (b,d,e)
+//   | \ |      t2 = (d,b,f)
+//   a---b
+
+#define BOTTOM 0
+#define TOP    1
+#define FIN    2
+
+static const int quad_row[3][3] = {{BOTTOM, TOP, BOTTOM}, {BOTTOM, TOP, TOP}, {TOP, BOTTOM, FIN}};
+static const int quad_col[3][3] = {{0, 0, 1}, {1, 0, 1}, {0, 1, 0}};
+
+static unsigned int hash(unsigned int seed, unsigned int a, unsigned int b)
+{
+  unsigned int h = seed ^ (a * 0x9E3779B1u) ^ (b * 0x85EBCA77u);
+  h ^= h >> 16;
+  h *= 0x7FEB352Du;
+  h ^= h >> 15;
+  h *= 0x846CA68Bu;
+  h ^= h >> 16;
+  return h;
+}
+
+static float noise(unsigned int seed, float x, float y)
+{
+  int ix = (int)floor(x);
+  int iy = (int)floor(y);
+  float fx = x - ix;
+  float fy = y - iy;
+  fx = fx*fx*(3.0f-2.0f*fx);
+  fy = fy*fy*(3.0f-2.0f*fy);
+  float v00 = hash(seed, ix, iy) / 4294967295.0f;
+  float v10 = hash(seed, ix+1, iy) / 4294967295.0f;
+  float v01 = hash(seed, ix, iy+1) / 4294967295.0f;
+  float v11 = hash(seed, ix+1, iy+1) / 4294967295.0f;
+  float v0 = v00 + fx*(v10-v00);
+  float v1 = v01 + fx*(v11-v01);
+  return 2.0f*(v0 + fy*(v1-v0)) - 1.0f;
+}
+
+#define TERRAIN_HEIGHT  0.1f
+#define TERRAIN_PERIOD  256
+#define TERRAIN_OCTAVES 5
+
+bool SMreader_synthetic::quad(int s, int c) const
+{
+  return hash(seed, s, c) >= border_threshold;
+}
+
+bool SMreader_synthetic::fin(int s, int c) const
+{
+  return hash(seed ^ 0x5BD1E995u, s, c) < nonmanifold_threshold;
+}
+
+// how often vertex (r,c) is used by the triangles of strip s
+
+int SMreader_synthetic::uses(int r, int c, int s) const
+{
+  int u = 0;
+  int cl = (c ? c-1 : (type == SM_SYNTHETIC_TORUS ? width-1 : -1));
+  if (r == s)
+  {
+    if (c < width && quad(s,c)) u += 1;
+    if (cl != -1 && quad(s,cl)) u += 2 + fin(s,cl);
+  }
+  if (r == (s+1)%vrows)
+  {
+    if (c < width && quad(s,c)) u += 2 + fin(s,c);
+    if (cl != -1 && quad(s,cl)) u += 1;
+  }
+  return u;
+}
+
+SMidx* SMreader_synthetic::indices(int r) const
+{
+  return (r ? row_idx[r%3] : row0_idx);
+}
+
+// how often the vertices of the two rows of strip s are used from now on
+
+void SMreader_synthetic::init_rem(int s)
+{
+  int t = (s+1)%vrows;
+  for (int c = 0; c < vcols; c++)
+  {
+    bottom_rem[c] = uses(s, c, s);
+    if (type == SM_SYNTHETIC_TORUS && s == 0) bottom_rem[c] += uses(0, c, height-1);
+    top_rem[c] = uses(t, c, s);
+    if (s+1 < height) top_rem[c] += uses(t, c, s+1);
+  }
+}
+
+void SMreader_synthetic::position(int r, int c, float* pos) const
+{
+  float sp = 1.0f/width;
+  if (type == SM_SYNTHETIC_TORUS)
+  {
+    double tube = 1.0/(2.0*PI);
+    double ring = (double)height/(2.0*PI*width);
+    if (ring < 2.0*tube) ring = 2.0*tube;
+    double u = 2.0*PI*r/height;
+    double v = 2.0*PI*c/width;
+    pos[0] = (float)((ring + tube*cos(v))*cos(u));
+    pos[1] = (float)((ring + tube*cos(v))*sin(u));
+    pos[2] = (float)(tube*sin(v));
+  }
+  else
+  {
+    pos[0] = c*sp;
+    pos[1] = r*sp;
+    pos[2] = 0.0f;
+    if (type == SM_SYNTHETIC_TERRAIN)
+    {
+      float period = TERRAIN_PERIOD;
+      float amplitude = 0.5f*TERRAIN_HEIGHT;
+      for (int i = 0; i < TERRAIN_OCTAVES; i++)
+      {
+        pos[2] += amplitude*noise(seed+i, c/period, r/period);
+        period = 0.5f*period;
+        amplitude = 0.5f*amplitude;
+      }
+    }
+  }
+}
+
+void SMreader_synthetic::fin_position(int s, int c, float* pos) const
+{
+  float p[3];
+  int t = (s+1)%vrows;
+  int c1 = (c+1)%vcols;
+  position(s, c, pos);
+  position(s, c1, p); pos[0] += p[0]; pos[1] += p[1]; pos[2] += p[2];
+  position(t, c, p); pos[0] += p[0]; pos[1] += p[1]; pos[2] += p[2];
+  position(t, c1, p); pos[0] += p[0]; pos[1] += p[1]; pos[2] += p[2];
+  pos[0] = 0.25f*pos[0];
+  pos[1] = 0.25f*pos[1];
+  pos[2] = 0.25f*pos[2] + 0.5f/width;
+}
+
+// walks over the triangles of strip s in the same order as generate_strip()
+// and numbers the vertices in the order they get finalized. this is the
+// order in which a post-order stream writes them. returns their number.
+
+int SMreader_synthetic::finalize_strip(int s, bool assign)
+{
+  int c, i, k, col;
+  int* rem;
+  int count = 0;
+  SMidx* idx[3];
+
+  init_rem(s);
+  idx[BOTTOM] = indices(s);
+  idx[TOP] = indices((s+1)%vrows);
+  idx[FIN] = fin_idx[s%2];
+
+  for (c = 0; c < width; c++)
+  {
+    if (!quad(s,c)) continue;
+    int n = (fin(s,c) ? 3 : 2);
+    for (i = 0; i < n; i++)
+    {
+      for (k = 0; k < 3; k++)
+      {
+        col = (quad_row[i][k] == FIN ? c : (c + quad_col[i][k])%vcols);
+        if (quad_row[i][k] == FIN)
+        {
+          rem = 0;
+        }
+        else
+        {
+          rem = (quad_row[i][k] == BOTTOM ? &(bottom_rem[col]) : &(top_rem[col]));
+          (*rem)--;
+        }
+        if (rem == 0 || *rem == 0)
+        {
+          if (assign) idx[quad_row[i][k]][col] = next_idx + count;
+          count++;
+        }
+      }
+    }
+  }
+  if (assign) next_idx += count;
+  return count;
+}
+
+void SMreader_synthetic::generate_strip(int s)
+{
+  int c, i, k, col;
+  int* rem;
+  SMidx* idx[3];
+  int t = (s+1)%vrows;
+  SMsyntheticEvent* triangle;
+  SMsyntheticEvent* event;
+
+  init_rem(s);
+  idx[BOTTOM] = indices(s);
+  idx[TOP] = indices(t);
+  idx[FIN] = fin_idx[s%2];
+
+  if (!post_order && t != 0)
+  {
+    for (c = 0; c < vcols; c++) idx[TOP][c] = -1;
+  }
+
+  events_number = 0;
+  events_counter = 0;
+
+  for (c = 0; c < width; c++)
+  {
+    if (!quad(s,c)) continue;
+    int n = (fin(s,c) ? 3 : 2);
+    if (!post_order && n == 3)
+    {
+      idx[FIN][c] = -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+      // in pre-order the vertices come before their first triangle
+      for (k = 0; k < 3; k++)
+      {
+        col = (quad_row[i][k] == FIN ? c : (c + quad_col[i][k])%vcols);
+        if (!post_order && idx[quad_row[i][k]][col] == -1)
+        {
+          idx[quad_row[i][k]][col] = next_idx;
+          next_idx++;
+          event = &(events[events_number++]);
+          event->type = SM_VERTEX;
+          if (quad_row[i][k] == FIN) fin_position(s, c, event->pos);
+          else position((quad_row[i][k] == BOTTOM ? s : t), col, event->pos);
+        }
+      }
+      triangle = &(events[events_number++]);
+      triangle->type = SM_TRIANGLE;
+      for (k = 0; k < 3; k++)
+      {
+        col = (quad_row[i][k] == FIN ? c : (c + quad_col[i][k])%vcols);
+        triangle->idx[k] = idx[quad_row[i][k]][col];
+        if (quad_row[i][k] == FIN)
+        {
+          triangle->final[k] = true;
+        }
+        else
+        {
+          rem = (quad_row[i][k] == BOTTOM ? &(bottom_rem[col]) : &(top_rem[col]));
+          (*rem)--;
+          triangle->final[k] = (*rem == 0);
+        }
+      }
+      // in post-order the vertices come after their last triangle
+      if (post_order)
+      {
+        for (k = 0; k < 3; k++)
+        {
+          if (triangle->final[k])
+          {
+            col = (quad_row[i][k] == FIN ? c : (c + quad_col[i][k])%vcols);
+            event = &(events[events_number++]);
+            event->type = SM_VERTEX;
+            if (quad_row[i][k] == FIN) fin_position(s, c, event->pos);
+            else position((quad_row[i][k] == BOTTOM ? s : t), col, event->pos);
+            triangle->final[k] = false;
+          }
+        }
+      }
+    }
+  }
+}
+
+void SMreader_synthetic::set_seed(unsigned int seed)
+{
+  this->seed = seed;
+}
+
+void SMreader_synthetic::set_post_order(bool post_order)
+{
+  this->post_order = post_order;
+}
+
+void SMreader_synthetic::set_border_fraction(float border_fraction)
+{
+  if (border_fraction <= 0.0f) border_threshold = 0;
+  else if (border_fraction >= 1.0f) border_threshold = 0xFFFFFFFFu;
+  else border_threshold = (unsigned int)(border_fraction*4294967295.0);
+}
+
+void SMreader_synthetic::set_nonmanifold_fraction(float nonmanifold_fraction)
+{
+  if (nonmanifold_fraction <= 0.0f) nonmanifold_threshold = 0;
+  else if (nonmanifold_fraction >= 1.0f) nonmanifold_threshold = 0xFFFFFFFFu;
+  else nonmanifold_threshold = (unsigned int)(nonmanifold_fraction*4294967295.0);
+}
+
+bool SMreader_synthetic::open(int type, int width, int height)
+{
+  int c, s;
+
+  if (type < SM_SYNTHETIC_GRID || type > SM_SYNTHETIC_TORUS)
+  {
+    fprintf(stderr,"ERROR: unknown type %d of synthetic mesh\n", type);
+    return false;
+  }
+  if ((type == SM_SYNTHETIC_TORUS && (width < 3 || height < 3)) || width < 1 || height < 1)
+  {
+    fprintf(stderr,"ERROR: synthetic mesh of size %d x %d is too small\n", width, height);
+    return false;
+  }
+
+  this->type = type;
+  this->width = width;
+  this->height = height;
+
+  if (type == SM_SYNTHETIC_TORUS)
+  {
+    vcols = width;
+    vrows = height;
+  }
+  else
+  {
+    vcols = width + 1;
+    vrows = height + 1;
+  }
+
+  row0_idx = (SMidx*)malloc(sizeof(SMidx)*vcols);
+  row_idx[0] = (SMidx*)malloc(sizeof(SMidx)*vcols);
+  row_idx[1] = (SMidx*)malloc(sizeof(SMidx)*vcols);
+  row_idx[2] = (SMidx*)malloc(sizeof(SMidx)*vcols);
+  fin_idx[0] = (SMidx*)malloc(sizeof(SMidx)*width);
+  fin_idx[1] = (SMidx*)malloc(sizeof(SMidx)*width);
+  bottom_rem = (int*)malloc(sizeof(int)*vcols);
+  top_rem = (int*)malloc(sizeof(int)*vcols);
+  events = (SMsyntheticEvent*)malloc(sizeof(SMsyntheticEvent)*(6*width+2*vcols));
+
+  if (events == 0 || top_rem == 0 || bottom_rem == 0 || fin_idx[1] == 0 || fin_idx[0] == 0 || row_idx[2] == 0 || row_idx[1] == 0 || row_idx[0] == 0 || row0_idx == 0)
+  {
+    fprintf(stderr,"ERROR: cannot allocate buffers for synthetic mesh of width %d\n", width);
+    return false;
+  }
+
+  for (c = 0; c < vcols; c++) row0_idx[c] = -1;
+
+  if (border_threshold == 0 && nonmanifold_threshold == 0)
+  {
+    nverts = (SMidx)vrows*vcols;
+    nfaces = (SMidx)2*width*height;
+  }
+  else
+  {
+    nverts = -1;
+    nfaces = -1;
+  }
+
+  bb_min_f = new float[3];
+  bb_max_f = new float[3];
+  if (type == SM_SYNTHETIC_TORUS)
+  {
+    float tube = (float)(1.0/(2.0*PI));
+    float ring = (float)((double)height/(2.0*PI*width));
+    if (ring < 2.0f*tube) ring = 2.0f*tube;
+    bb_min_f[0] = bb_min_f[1] = -(ring+tube);
+    bb_max_f[0] = bb_max_f[1] = (ring+tube);
+    bb_min_f[2] = -tube;
+    bb_max_f[2] = tube + 0.5f/width;
+  }
+  else
+  {
+    bb_min_f[0] = 0.0f;
+    bb_min_f[1] = 0.0f;
+    bb_max_f[0] = 1.0f;
+    bb_max_f[1] = (float)height/width;
+    bb_min_f[2] = (type == SM_SYNTHETIC_TERRAIN ? -TERRAIN_HEIGHT : 0.0f);
+    bb_max_f[2] = (type == SM_SYNTHETIC_TERRAIN ? TERRAIN_HEIGHT : 0.0f) + 0.5f/width;
+  }
+
+  strip = 0;
+  next_idx = 0;
+
+  if (post_order)
+  {
+    if (type == SM_SYNTHETIC_TORUS)
+    {
+      // the first row of vertices is finalized in the last strip. to know
+      // their indices now we need to know how many vertices come before.
+      SMidx total = 0;
+      if (nverts != -1)
+      {
+        total = nverts;
+      }
+      else
+      {
+        for (s = 0; s < height; s++) total += finalize_strip(s, false);
+      }
+      next_idx = total - finalize_strip(height-1, false);
+      finalize_strip(height-1, true);
+      next_idx = 0;
+    }
+    finalize_strip(0, true);
+  }
+
+  events_number = 0;
+  events_counter = 0;
+
+  v_count = 0;
+  f_count = 0;
+
+  return true;
+}
+
+bool SMreader_synthetic::open(const char* description)
+{
+  int type, width, height;
+  char name[32];
+  const char* option;
+
+  if (description == 0 || sscanf(description, "%31[^,],%d,%d", name, &width, &height) != 3)
+  {
+    fprintf(stderr,"ERROR: synthetic mesh '%s' is not of the form 'type,width,height[,options]'\n", (description ? description : ""));
+    return false;
+  }
+
+  if (strcmp(name, "grid") == 0) type = SM_SYNTHETIC_GRID;
+  else if (strcmp(name, "terrain") == 0) type = SM_SYNTHETIC_TERRAIN;
+  else if (strcmp(name, "torus") == 0) type = SM_SYNTHETIC_TORUS;
+  else
+  {
+    fprintf(stderr,"ERROR: unknown synthetic mesh type '%s' (use grid, terrain, or torus)\n", name);
+    return false;
+  }
+
+  option = strchr(description, ',');
+  option = strchr(option+1, ',');
+  option = strchr(option+1, ',');
+  while (option)
+  {
+    option++;
+    if (strncmp(option, "seed=", 5) == 0) set_seed((unsigned int)strtoul(option+5, 0, 10));
+    else if (strncmp(option, "border=", 7) == 0) set_border_fraction((float)atof(option+7));
+    else if (strncmp(option, "nonmanifold=", 12) == 0) set_nonmanifold_fraction((float)atof(option+12));
+    else if (strncmp(option, "post", 4) == 0) set_post_order(true);
+    else if (strncmp(option, "pre", 3) == 0) set_post_order(false);
+    else
+    {
+      fprintf(stderr,"ERROR: unknown option '%s' for synthetic mesh\n", option);
+      return false;
+    }
+    option = strchr(option, ',');
+  }
+
+  return open(type, width, height);
+}
+
+void SMreader_synthetic::close()
+{
+  // close of SMreader interface
+  v_count = -1;
+  f_count = -1;
+
+  // close of SMreader_synthetic
+  free(row0_idx); row0_idx = 0;
+  free(row_idx[0]); row_idx[0] = 0;
+  free(row_idx[1]); row_idx[1] = 0;
+  free(row_idx[2]); row_idx[2] = 0;
+  free(fin_idx[0]); fin_idx[0] = 0;
+  free(fin_idx[1]); fin_idx[1] = 0;
+  free(bottom_rem); bottom_rem = 0;
+  free(top_rem); top_rem = 0;
+  free(events); events = 0;
+  events_number = 0;
+  events_counter = 0;
+  have_finalized = 0; next_finalized = 0;
+}
+
+SMevent SMreader_synthetic::read_element()
+{
+  while (events_counter == events_number)
+  {
+    if (strip == height)
+    {
+      if (nverts != -1 && v_count != nverts)
+      {
+        fprintf(stderr,"WARNING: wrong vertex count: v_count (" SM_IDX_FORMAT ") != nverts (" SM_IDX_FORMAT ")\n", v_count, nverts);
+      }
+      nverts = v_count;
+      if (nfaces != -1 && f_count != nfaces)
+      {
+        fprintf(stderr,"WARNING: wrong face count: f_count (" SM_IDX_FORMAT ") != nfaces (" SM_IDX_FORMAT ")\n", f_count, nfaces);
+      }
+      nfaces = f_count;
+      return SM_EOF;
+    }
+    if (post_order && strip+1 < height)
+    {
+      finalize_strip(strip+1, true);
+    }
+    generate_strip(strip);
+    strip++;
+  }
+
+  SMsyntheticEvent* event = &(events[events_counter]);
+  events_counter++;
+  have_finalized = next_finalized = 0;
+
+  if (event->type == SM_VERTEX)
+  {
+    v_pos_f[0] = event->pos[0];
+    v_pos_f[1] = event->pos[1];
+    v_pos_f[2] = event->pos[2];
+    v_idx = v_count;
+    v_count++;
+    if (post_order) {finalized_vertices[have_finalized] = v_idx; have_finalized++;}
+    return SM_VERTEX;
+  }
+  else
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      t_idx[i] = event->idx[i];
+      t_final[i] = event->final[i];
+      if (t_final[i]) {finalized_vertices[have_finalized] = t_idx[i]; have_finalized++;}
+    }
+    f_count++;
+    return SM_TRIANGLE;
+  }
+}
+
+SMevent SMreader_synthetic::read_event()
+{
+  if (have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    have_finalized--; next_finalized++;
+    return SM_FINALIZED;
+  }
+  else
+  {
+    return read_element();
+  }
+}
+
+SMreader_synthetic::SMreader_synthetic()
+{
+  // init of SMreader interface
+  ncomments = 0;
+  comments = 0;
+
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreader_synthetic
+  type = SM_SYNTHETIC_GRID;
+  width = 0;
+  height = 0;
+  seed = 0;
+  border_threshold = 0;
+  nonmanifold_threshold = 0;
+
+  row0_idx = 0;
+  row_idx[0] = row_idx[1] = row_idx[2] = 0;
+  fin_idx[0] = fin_idx[1] = 0;
+  bottom_rem = 0;
+  top_rem = 0;
+  events = 0;
+  events_number = 0;
+  events_counter = 0;
+  have_finalized = 0; next_finalized = 0;
+}
+
+SMreader_synthetic::~SMreader_synthetic()
+{
+  if (events) close();
+  if (bb_min_f) delete [] bb_min_f;
+  if (bb_max_f) delete [] bb_max_f;
+}
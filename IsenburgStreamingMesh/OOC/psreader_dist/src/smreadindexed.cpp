@@ -0,0 +1,557 @@
+/*
+===============================================================================
+
+  FILE:  SMreadIndexed.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreadindexed.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "vec3fv.h"
+#include "smstats.h"
+#include "smtrace.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+typedef struct SMvertex
+{
+  SMvertex* buffer_next;  // used for efficient memory management
+  float v[3];
+  SMidx index;            // the index in the output or -1 if not passed on yet
+} SMvertex;
+
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
+
+// the state of the reader is kept per reader so that several of them can
+// be used on one thread and so that its statistics can be queried from
+// another thread
+
+struct SMextractor
+{
+  my_hash* vertex_hash;
+
+  // the vertices that are passed on before the next triangle
+
+  int emit_number;
+  int emit_next;
+  SMidx emit_idx[3];
+  float emit_pos[9];
+
+  bool have_triangle;
+  SMidx out_t_idx[3];
+  bool out_t_final[3];
+
+  // the vertices that are finalized between the chunks of the query
+
+  int final_alloc;
+  int final_number;
+  int final_next;
+  SMidx* final_queue;
+
+  // the vertices that a chunk adds to the front and removes from it
+
+  int add_alloc;
+  SMidx* add_idx;
+  float* add_pos;
+  int remove_alloc;
+  SMidx* remove_idx;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_chunks;
+  int stat_selected_chunks;
+  int stat_elements;
+  int stat_front_vertices;
+  int stat_in_width;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int vertex_blocks_number;
+
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+
+  bool replayDelta(SMindex* smindex, int c);
+  void finalizeVertex(SMidx index);
+
+  SMextractor();
+  ~SMextractor();
+};
+
+SMextractor::SMextractor()
+{
+  vertex_hash = 0;
+
+  emit_number = emit_next = 0;
+  have_triangle = false;
+
+  final_alloc = 1024;
+  final_number = final_next = 0;
+  final_queue = (SMidx*)malloc(sizeof(SMidx)*final_alloc);
+
+  add_alloc = 1024;
+  add_idx = (SMidx*)malloc(sizeof(SMidx)*add_alloc);
+  add_pos = (float*)malloc(sizeof(float)*3*add_alloc);
+  remove_alloc = 1024;
+  remove_idx = (SMidx*)malloc(sizeof(SMidx)*remove_alloc);
+
+  stats = 0;
+
+  vertex_buffer_alloc = 1024;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_number = 0;
+}
+
+SMextractor::~SMextractor()
+{
+  for (int i = 0; i < vertex_blocks_number; i++)
+  {
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  if (vertex_hash) delete vertex_hash;
+  free(final_queue);
+  free(add_idx);
+  free(add_pos);
+  free(remove_idx);
+  if (stats) delete stats;
+}
+
+// efficient memory allocation for vertices. every block is remembered so
+// that the destructor can give it back.
+
+SMvertex* SMextractor::allocVertex()
+{
+  if (vertex_buffer_next == 0)
+  {
+    vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*vertex_buffer_alloc);
+    if (vertex_buffer_next == 0)
+    {
+      fprintf(stderr,"malloc for vertex buffer failed\n");
+      return 0;
+    }
+    vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+    vertex_blocks[vertex_blocks_number] = vertex_buffer_next;
+    vertex_blocks_number++;
+    for (int i = 0; i < vertex_buffer_alloc; i++)
+    {
+      vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
+    }
+    vertex_buffer_next[vertex_buffer_alloc-1].buffer_next = 0;
+    vertex_buffer_alloc = 2*vertex_buffer_alloc;
+  }
+  // get pointer to next available vertex
+  SMvertex* vertex = vertex_buffer_next;
+  vertex_buffer_next = vertex->buffer_next;
+  vertex->index = -1;
+  return vertex;
+}
+
+void SMextractor::deallocVertex(SMvertex* vertex)
+{
+  vertex->buffer_next = vertex_buffer_next;
+  vertex_buffer_next = vertex;
+}
+
+// applies the changes of the front of a chunk that is not part of the
+// query. a vertex that leaves the front and was passed on is finalized.
+
+bool SMextractor::replayDelta(SMindex* smindex, int c)
+{
+  int i;
+  my_hash::iterator hash_element;
+  SMvertex* vertex;
+
+  if (smindex->chunks[c].add_number > add_alloc)
+  {
+    add_alloc = smindex->chunks[c].add_number;
+    add_idx = (SMidx*)realloc(add_idx, sizeof(SMidx)*add_alloc);
+    add_pos = (float*)realloc(add_pos, sizeof(float)*3*add_alloc);
+  }
+  if (smindex->chunks[c].remove_number > remove_alloc)
+  {
+    remove_alloc = smindex->chunks[c].remove_number;
+    remove_idx = (SMidx*)realloc(remove_idx, sizeof(SMidx)*remove_alloc);
+  }
+  if (!smindex->read_delta(c, add_idx, add_pos, remove_idx))
+  {
+    fprintf(stderr,"ERROR: cannot read the front of chunk %d\n", c);
+    return false;
+  }
+  for (i = 0; i < smindex->chunks[c].add_number; i++)
+  {
+    vertex = allocVertex();
+    VecCopy3fv(vertex->v, &(add_pos[3*i]));
+    sm_trace_hash_insert(vertex_hash, my_hash::value_type(add_idx[i], vertex), "SMreadIndexed::vertex_hash");
+  }
+  stats->count(stat_front_vertices, smindex->chunks[c].add_number);
+  for (i = 0; i < smindex->chunks[c].remove_number; i++)
+  {
+    hash_element = vertex_hash->find(remove_idx[i]);
+    if (hash_element == vertex_hash->end())
+    {
+      fprintf(stderr,"ERROR: vertex " SM_IDX_FORMAT " removed by chunk %d is not in the front\n", remove_idx[i], c);
+      return false;
+    }
+    vertex = (*hash_element).second;
+    if (vertex->index != -1) finalizeVertex(vertex->index);
+    vertex_hash->erase(hash_element);
+    deallocVertex(vertex);
+  }
+  return true;
+}
+
+void SMextractor::finalizeVertex(SMidx index)
+{
+  if (final_number == final_alloc)
+  {
+    final_alloc *= 2;
+    final_queue = (SMidx*)realloc(final_queue, sizeof(SMidx)*final_alloc);
+  }
+  final_queue[final_number] = index;
+  final_number++;
+}
+
+bool SMreadIndexed::open(FILE* file_smb, FILE* file_smi, const float* roi_min, const float* roi_max)
+{
+  if (file_smb == 0 || file_smi == 0 || roi_min == 0 || roi_max == 0)
+  {
+    return false;
+  }
+  smindex = new SMindex();
+  if (!smindex->read(file_smi))
+  {
+    delete smindex;
+    smindex = 0;
+    return false;
+  }
+  smreader_smb = new SMreader_smb();
+  smreader_smb->open(file_smb);
+
+  VecCopy3fv(this->roi_min, roi_min);
+  VecCopy3fv(this->roi_max, roi_max);
+
+  selected = (int*)malloc(sizeof(int)*(smindex->nchunks ? smindex->nchunks : 1));
+  nselected = smindex->query(roi_min, roi_max, selected);
+  current = -1;
+  chunk_open = false;
+  elements_left = 0;
+  next_delta = 0;
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = 0;
+  f_count = 0;
+
+  bb_min_f = smreader_smb->bb_min_f;
+  bb_max_f = smreader_smb->bb_max_f;
+
+  post_order = false;
+
+  have_finalized = next_finalized = 0;
+
+  if (extractor->vertex_hash) delete extractor->vertex_hash;
+  extractor->vertex_hash = new my_hash;
+
+  extractor->emit_number = extractor->emit_next = 0;
+  extractor->have_triangle = false;
+
+  extractor->final_number = extractor->final_next = 0;
+
+  if (extractor->stats == 0)
+  {
+    extractor->stats = new SMstats("SMreadIndexed");
+    extractor->stat_chunks = extractor->stats->add("chunks", SM_STATS_COUNTER);
+    extractor->stat_selected_chunks = extractor->stats->add("selected_chunks", SM_STATS_COUNTER);
+    extractor->stat_elements = extractor->stats->add("read_elements", SM_STATS_COUNTER);
+    extractor->stat_front_vertices = extractor->stats->add("front_vertices", SM_STATS_COUNTER);
+    extractor->stat_in_width = extractor->stats->add("in_width", SM_STATS_LEVEL);
+  }
+  extractor->stats->reset();
+  extractor->stats->count(extractor->stat_chunks, smindex->nchunks);
+  extractor->stats->count(extractor->stat_selected_chunks, nselected);
+
+  return true;
+}
+
+void SMreadIndexed::close()
+{
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  my_hash::iterator hash_element;
+  for (hash_element = extractor->vertex_hash->begin(); hash_element != extractor->vertex_hash->end(); hash_element++)
+  {
+    extractor->deallocVertex((*hash_element).second);
+  }
+  delete extractor->vertex_hash;
+  extractor->vertex_hash = 0;
+
+  free(selected);
+  selected = 0;
+
+  smreader_smb->close();
+  delete smreader_smb;
+  smreader_smb = 0;
+  delete smindex;
+  smindex = 0;
+}
+
+const SMstats* SMreadIndexed::get_stats() const
+{
+  return extractor->stats;
+}
+
+// brings the front up to the next chunk of the query by replaying the
+// chunks in between and seeks to its first block
+
+bool SMreadIndexed::start_chunk()
+{
+  int c = selected[current];
+
+  while (next_delta < c)
+  {
+    if (!extractor->replayDelta(smindex, next_delta))
+    {
+      return false;
+    }
+    next_delta++;
+  }
+  extractor->stats->level(extractor->stat_in_width, extractor->vertex_hash->size());
+
+  if (!smreader_smb->seek_block(smindex->chunks[c].offset, smindex->chunks[c].v_start, smindex->chunks[c].f_start))
+  {
+    return false;
+  }
+  elements_left = smindex->chunks[c].v_number + smindex->chunks[c].f_number;
+  // reading the chunk changes the front just like its delta would
+  next_delta = c + 1;
+  return true;
+}
+
+// drops the front after the last chunk of the query. the vertices that
+// were passed on are finalized.
+
+void SMreadIndexed::end_query()
+{
+  SMvertex* vertex;
+  my_hash::iterator hash_element;
+  for (hash_element = extractor->vertex_hash->begin(); hash_element != extractor->vertex_hash->end(); hash_element++)
+  {
+    vertex = (*hash_element).second;
+    if (vertex->index != -1) extractor->finalizeVertex(vertex->index);
+    extractor->deallocVertex(vertex);
+  }
+  extractor->vertex_hash->clear();
+}
+
+SMevent SMreadIndexed::read_element()
+{
+  int i, j;
+  SMvertex* vertices[3];
+  my_hash::iterator hash_elements[3];
+
+  have_finalized = next_finalized = 0;
+
+  while (true)
+  {
+    if (extractor->emit_next < extractor->emit_number)
+    {
+      VecCopy3fv(v_pos_f, &(extractor->emit_pos[3*extractor->emit_next]));
+      v_idx = extractor->emit_idx[extractor->emit_next];
+      extractor->emit_next++;
+      return SM_VERTEX;
+    }
+    if (extractor->have_triangle)
+    {
+      extractor->have_triangle = false;
+      for (i = 0; i < 3; i++)
+      {
+        t_idx[i] = extractor->out_t_idx[i];
+        t_final[i] = extractor->out_t_final[i];
+        if (t_final[i]) finalized_vertices[have_finalized++] = t_idx[i];
+      }
+      f_count++;
+      return SM_TRIANGLE;
+    }
+    if (extractor->final_next < extractor->final_number)
+    {
+      final_idx = extractor->final_queue[extractor->final_next];
+      extractor->final_next++;
+      return SM_FINALIZED;
+    }
+    extractor->final_number = extractor->final_next = 0;
+
+    if (elements_left == 0)
+    {
+      if (current + 1 < nselected)
+      {
+        current++;
+        if (!start_chunk())
+        {
+          return SM_ERROR;
+        }
+        chunk_open = true;
+        continue;
+      }
+      if (chunk_open)
+      {
+        end_query();
+        chunk_open = false;
+        continue;
+      }
+      return SM_EOF;
+    }
+
+    SMevent event = smreader_smb->read_element();
+    elements_left--;
+    extractor->stats->count(extractor->stat_elements);
+
+    if (event == SM_VERTEX)
+    {
+      SMvertex* vertex = extractor->allocVertex();
+      VecCopy3fv(vertex->v, smreader_smb->v_pos_f);
+      sm_trace_hash_insert(extractor->vertex_hash, my_hash::value_type(smreader_smb->v_idx, vertex), "SMreadIndexed::vertex_hash");
+      extractor->stats->level(extractor->stat_in_width, extractor->vertex_hash->size());
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      for (i = 0; i < 3; i++)
+      {
+        hash_elements[i] = extractor->vertex_hash->find(smreader_smb->t_idx[i]);
+        if (hash_elements[i] == extractor->vertex_hash->end())
+        {
+          fprintf(stderr,"FATAL ERROR: vertex " SM_IDX_FORMAT " not in hash. corrupt index or pre-order mesh.\n", smreader_smb->t_idx[i]);
+          return SM_ERROR;
+        }
+        vertices[i] = (*hash_elements[i]).second;
+      }
+      // is the bounding box of the triangle in the box of interest
+      bool inside = true;
+      for (j = 0; j < 3 && inside; j++)
+      {
+        if (vertices[0]->v[j] < roi_min[j] && vertices[1]->v[j] < roi_min[j] && vertices[2]->v[j] < roi_min[j]) inside = false;
+        else if (vertices[0]->v[j] > roi_max[j] && vertices[1]->v[j] > roi_max[j] && vertices[2]->v[j] > roi_max[j]) inside = false;
+      }
+      if (inside)
+      {
+        extractor->emit_number = extractor->emit_next = 0;
+        for (i = 0; i < 3; i++)
+        {
+          if (vertices[i]->index == -1)
+          {
+            vertices[i]->index = v_count;
+            extractor->emit_idx[extractor->emit_number] = v_count;
+            VecCopy3fv(&(extractor->emit_pos[3*extractor->emit_number]), vertices[i]->v);
+            extractor->emit_number++;
+            v_count++;
+          }
+          extractor->out_t_idx[i] = vertices[i]->index;
+          extractor->out_t_final[i] = smreader_smb->t_final[i];
+        }
+        extractor->have_triangle = true;
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader_smb->t_final[i])
+        {
+          if (!inside && vertices[i]->index != -1) extractor->finalizeVertex(vertices[i]->index);
+          extractor->vertex_hash->erase(hash_elements[i]);
+          extractor->deallocVertex(vertices[i]);
+        }
+      }
+    }
+    else
+    {
+      fprintf(stderr,"ERROR: SMB file ended inside chunk %d\n", selected[current]);
+      return SM_ERROR;
+    }
+  }
+}
+
+SMevent SMreadIndexed::read_event()
+{
+  if (next_finalized < have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    next_finalized++;
+    return SM_FINALIZED;
+  }
+  return read_element();
+}
+
+SMreadIndexed::SMreadIndexed()
+{
+  // init of SMreader interface
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreadIndexed
+  smreader_smb = 0;
+  smindex = 0;
+  selected = 0;
+  nselected = 0;
+  current = -1;
+  chunk_open = false;
+  elements_left = 0;
+  next_delta = 0;
+
+  have_finalized = next_finalized = 0;
+
+  extractor = new SMextractor();
+}
+
+SMreadIndexed::~SMreadIndexed()
+{
+  delete extractor;
+}
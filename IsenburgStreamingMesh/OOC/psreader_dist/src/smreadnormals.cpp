@@ -0,0 +1,683 @@
+/*
+===============================================================================
+
+  FILE:  SMreadNormals.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreadnormals.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "vec3fv.h"
+#include "vec3iv.h"
+#include "smstats.h"
+#include "smtrace.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define NORMALS_SSE
+#include <xmmintrin.h>
+#endif
+
+struct SMtriangle;
+
+typedef struct SMvertex
+{
+  SMvertex* buffer_next;        // used for efficient memory management and the output queue
+  float v[4];                   // padded for the SSE registers
+  float n[4];                   // the sum of the normals of its triangles
+  SMidx index;                  // the index in the output
+  bool finalized;
+  int pending;                  // its triangles that were not yet passed on
+  SMtriangle* first_triangle;   // its triangles are linked through their corners
+  int first_corner;
+} SMvertex;
+
+typedef struct SMtriangle
+{
+  SMtriangle* buffer_next;      // used for efficient memory management and the output queue
+  SMvertex* vertices[3];
+  SMtriangle* next_triangle[3]; // the next triangle around vertices[i]
+  int next_corner[3];
+  int ready;                    // how many of its corners are finalized
+} SMtriangle;
+
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
+
+// the state of the filter is kept per reader so that several of them can
+// be used on one thread and so that its statistics can be queried from
+// another thread
+
+struct SMnormalizer
+{
+  my_hash* vertex_hash;
+
+  // vertices and triangles that are ready to be passed on. vertices go first.
+
+  SMvertex* output_vertex_first;
+  SMvertex* output_vertex_last;
+  SMtriangle* output_triangle_first;
+  SMtriangle* output_triangle_last;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_in_width;
+  int stat_vertex_buffer;
+  int stat_triangle_buffer;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int vertex_buffer_size;
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int vertex_blocks_number;
+
+  int triangle_buffer_size;
+  int triangle_buffer_alloc;
+  SMtriangle* triangle_buffer_next;
+  SMtriangle** triangle_blocks;
+  int triangle_blocks_number;
+
+  int initVertexBuffer(int size);
+  SMvertex* allocVertexBlock(int size);
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+  int initTriangleBuffer(int size);
+  SMtriangle* allocTriangleBlock(int size);
+  SMtriangle* allocTriangle();
+  void deallocTriangle(SMtriangle* triangle);
+
+  void finalizeVertex(SMvertex* vertex);
+
+  SMnormalizer();
+  ~SMnormalizer();
+};
+
+SMnormalizer::SMnormalizer()
+{
+  vertex_hash = 0;
+
+  output_vertex_first = output_vertex_last = 0;
+  output_triangle_first = output_triangle_last = 0;
+
+  stats = 0;
+
+  vertex_buffer_size = 0;
+  vertex_buffer_alloc = 1024;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_number = 0;
+
+  triangle_buffer_size = 0;
+  triangle_buffer_alloc = 1024;
+  triangle_buffer_next = 0;
+  triangle_blocks = 0;
+  triangle_blocks_number = 0;
+}
+
+SMnormalizer::~SMnormalizer()
+{
+  int i;
+  for (i = 0; i < vertex_blocks_number; i++)
+  {
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  for (i = 0; i < triangle_blocks_number; i++)
+  {
+    free(triangle_blocks[i]);
+  }
+  if (triangle_blocks) free(triangle_blocks);
+  if (vertex_hash) delete vertex_hash;
+  if (stats) delete stats;
+}
+
+// efficient memory allocation for vertices. every block is remembered so
+// that the destructor can give it back.
+
+SMvertex* SMnormalizer::allocVertexBlock(int size)
+{
+  SMvertex* block = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for vertex buffer failed\n");
+    return 0;
+  }
+  vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+  vertex_blocks[vertex_blocks_number] = block;
+  vertex_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMnormalizer::initVertexBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (vertex_buffer_next)
+  {
+    vertex_buffer_size = 0;
+    return 1;
+  }
+
+  vertex_buffer_next = allocVertexBlock(size);
+
+  if (vertex_buffer_next == 0)
+  {
+    return 0;
+  }
+  vertex_buffer_alloc = size;
+  vertex_buffer_size = 0;
+  return 1;
+}
+
+SMvertex* SMnormalizer::allocVertex()
+{
+  if (vertex_buffer_next == 0)
+  {
+    vertex_buffer_next = allocVertexBlock(vertex_buffer_alloc);
+    if (vertex_buffer_next == 0)
+    {
+      return 0;
+    }
+    vertex_buffer_alloc = 2*vertex_buffer_alloc;
+  }
+  // get pointer to next available vertex
+  SMvertex* vertex = vertex_buffer_next;
+  vertex_buffer_next = vertex->buffer_next;
+
+  vertex->n[0] = vertex->n[1] = vertex->n[2] = vertex->n[3] = 0.0f;
+  vertex->index = -1;
+  vertex->finalized = false;
+  vertex->pending = 0;
+  vertex->first_triangle = 0;
+
+  vertex_buffer_size++;
+
+  stats->level(stat_vertex_buffer, vertex_buffer_size);
+
+  return vertex;
+}
+
+void SMnormalizer::deallocVertex(SMvertex* vertex)
+{
+  vertex->buffer_next = vertex_buffer_next;
+  vertex_buffer_next = vertex;
+  vertex_buffer_size--;
+  stats->down(stat_vertex_buffer);
+}
+
+// efficient memory allocation for triangles
+
+SMtriangle* SMnormalizer::allocTriangleBlock(int size)
+{
+  SMtriangle* block = (SMtriangle*)malloc(sizeof(SMtriangle)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for triangle buffer failed\n");
+    return 0;
+  }
+  triangle_blocks = (SMtriangle**)realloc(triangle_blocks, sizeof(SMtriangle*)*(triangle_blocks_number+1));
+  triangle_blocks[triangle_blocks_number] = block;
+  triangle_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMnormalizer::initTriangleBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (triangle_buffer_next)
+  {
+    triangle_buffer_size = 0;
+    return 1;
+  }
+
+  triangle_buffer_next = allocTriangleBlock(size);
+
+  if (triangle_buffer_next == 0)
+  {
+    return 0;
+  }
+  triangle_buffer_alloc = size;
+  triangle_buffer_size = 0;
+  return 1;
+}
+
+SMtriangle* SMnormalizer::allocTriangle()
+{
+  if (triangle_buffer_next == 0)
+  {
+    triangle_buffer_next = allocTriangleBlock(triangle_buffer_alloc);
+    if (triangle_buffer_next == 0)
+    {
+      return 0;
+    }
+    triangle_buffer_alloc = 2*triangle_buffer_alloc;
+  }
+  // get pointer to next available triangle
+  SMtriangle* triangle = triangle_buffer_next;
+  triangle_buffer_next = triangle->buffer_next;
+
+  triangle->ready = 0;
+
+  triangle_buffer_size++;
+
+  stats->level(stat_triangle_buffer, triangle_buffer_size);
+
+  return triangle;
+}
+
+void SMnormalizer::deallocTriangle(SMtriangle* triangle)
+{
+  triangle->buffer_next = triangle_buffer_next;
+  triangle_buffer_next = triangle;
+  triangle_buffer_size--;
+  stats->down(stat_triangle_buffer);
+}
+
+// a finalized vertex is ready to be passed on and so are those of its
+// triangles whose three corners are now all finalized
+
+void SMnormalizer::finalizeVertex(SMvertex* vertex)
+{
+  vertex->finalized = true;
+
+  vertex->buffer_next = 0;
+  if (output_vertex_last)
+  {
+    output_vertex_last->buffer_next = vertex;
+  }
+  else
+  {
+    output_vertex_first = vertex;
+  }
+  output_vertex_last = vertex;
+
+  SMtriangle* triangle = vertex->first_triangle;
+  int corner = vertex->first_corner;
+  while (triangle)
+  {
+    triangle->ready++;
+    if (triangle->ready == 3)
+    {
+      triangle->buffer_next = 0;
+      if (output_triangle_last)
+      {
+        output_triangle_last->buffer_next = triangle;
+      }
+      else
+      {
+        output_triangle_first = triangle;
+      }
+      output_triangle_last = triangle;
+    }
+    SMtriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+}
+
+bool SMreadNormals::open(SMreader* smreader)
+{
+  if (smreader == 0 || smreader->post_order)
+  {
+    return false;
+  }
+  this->smreader = smreader;
+  eof = false;
+
+  nverts = smreader->nverts;
+  nfaces = smreader->nfaces;
+
+  v_count = 0;
+  f_count = 0;
+
+  bb_min_f = smreader->bb_min_f;
+  bb_max_f = smreader->bb_max_f;
+
+  have_isolated = false;
+  have_finalized = next_finalized = 0;
+
+  if (normalizer->vertex_hash) delete normalizer->vertex_hash;
+  normalizer->vertex_hash = new my_hash;
+
+  normalizer->output_vertex_first = normalizer->output_vertex_last = 0;
+  normalizer->output_triangle_first = normalizer->output_triangle_last = 0;
+
+  if (normalizer->stats == 0)
+  {
+    normalizer->stats = new SMstats("SMreadNormals");
+    normalizer->stat_in_width = normalizer->stats->add("in_width", SM_STATS_LEVEL);
+    normalizer->stat_vertex_buffer = normalizer->stats->add("vertex_buffer", SM_STATS_LEVEL);
+    normalizer->stat_triangle_buffer = normalizer->stats->add("triangle_buffer", SM_STATS_LEVEL);
+  }
+  normalizer->stats->reset();
+
+  if (!normalizer->initVertexBuffer(1024) || !normalizer->initTriangleBuffer(2048))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void SMreadNormals::close()
+{
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  smreader->close();
+
+  // put whatever was not passed on back on the free lists
+
+  my_hash::iterator hash_element;
+  for (hash_element = normalizer->vertex_hash->begin(); hash_element != normalizer->vertex_hash->end(); hash_element++)
+  {
+    normalizer->finalizeVertex((*hash_element).second);
+  }
+  delete normalizer->vertex_hash;
+  normalizer->vertex_hash = 0;
+
+  while (normalizer->output_triangle_first)
+  {
+    SMtriangle* triangle = normalizer->output_triangle_first;
+    normalizer->output_triangle_first = triangle->buffer_next;
+    for (int i = 0; i < 3; i++)
+    {
+      triangle->vertices[i]->pending--;
+      if (triangle->vertices[i]->pending == 0 && triangle->vertices[i]->index != -1)
+      {
+        normalizer->deallocVertex(triangle->vertices[i]);
+      }
+    }
+    normalizer->deallocTriangle(triangle);
+  }
+  while (normalizer->output_vertex_first)
+  {
+    SMvertex* vertex = normalizer->output_vertex_first;
+    normalizer->output_vertex_first = vertex->buffer_next;
+    if (vertex->pending == 0)
+    {
+      normalizer->deallocVertex(vertex);
+    }
+  }
+  normalizer->output_vertex_last = 0;
+  normalizer->output_triangle_last = 0;
+}
+
+const SMstats* SMreadNormals::get_stats() const
+{
+  return normalizer->stats;
+}
+
+// reads from the input until something is ready to be passed on. returns
+// 1 if so, 0 at the end of the input, and -1 on error.
+
+int SMreadNormals::read_input()
+{
+  int i;
+  SMvertex* vertex;
+  SMtriangle* triangle;
+  my_hash::iterator hash_element;
+#ifndef NORMALS_SSE
+  float normal[3];
+#endif
+
+  while (normalizer->output_vertex_first == 0 && normalizer->output_triangle_first == 0)
+  {
+    if (eof)
+    {
+      return 0;
+    }
+
+    SMevent event = smreader->read_element();
+
+    if (event == SM_VERTEX)
+    {
+      vertex = normalizer->allocVertex();
+      VecCopy3fv(vertex->v, smreader->v_pos_f);
+      vertex->v[3] = 0.0f;
+      sm_trace_hash_insert(normalizer->vertex_hash, my_hash::value_type(smreader->v_idx, vertex), "SMreadNormals::vertex_hash");
+      normalizer->stats->level(normalizer->stat_in_width, normalizer->vertex_hash->size());
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      triangle = normalizer->allocTriangle();
+      for (i = 0; i < 3; i++)
+      {
+        hash_element = normalizer->vertex_hash->find(smreader->t_idx[i]);
+        // vertices must preceed triangles in a pre-order mesh
+        if (hash_element == normalizer->vertex_hash->end())
+        {
+          fprintf(stderr, "FATAL ERROR: triangle vertex not in hash. corrupt pre-order mesh.\n");
+          normalizer->deallocTriangle(triangle);
+          return -1;
+        }
+        triangle->vertices[i] = (*hash_element).second;
+      }
+      // the normal is not normalized so that larger triangles count more
+#ifdef NORMALS_SSE
+      __m128 a = _mm_loadu_ps(triangle->vertices[0]->v);
+      __m128 ab = _mm_sub_ps(_mm_loadu_ps(triangle->vertices[1]->v), a);
+      __m128 ac = _mm_sub_ps(_mm_loadu_ps(triangle->vertices[2]->v), a);
+      __m128 normal = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(ab, ab, _MM_SHUFFLE(3,0,2,1)), _mm_shuffle_ps(ac, ac, _MM_SHUFFLE(3,1,0,2))), _mm_mul_ps(_mm_shuffle_ps(ab, ab, _MM_SHUFFLE(3,1,0,2)), _mm_shuffle_ps(ac, ac, _MM_SHUFFLE(3,0,2,1))));
+#else
+      VecCcwNormal3fv(normal, triangle->vertices[0]->v, triangle->vertices[1]->v, triangle->vertices[2]->v);
+#endif
+      for (i = 0; i < 3; i++)
+      {
+        vertex = triangle->vertices[i];
+#ifdef NORMALS_SSE
+        _mm_storeu_ps(vertex->n, _mm_add_ps(_mm_loadu_ps(vertex->n), normal));
+#else
+        VecSelfAdd3fv(vertex->n, normal);
+#endif
+        // link the corner into the list of the vertex
+        triangle->next_triangle[i] = vertex->first_triangle;
+        triangle->next_corner[i] = vertex->first_corner;
+        vertex->first_triangle = triangle;
+        vertex->first_corner = i;
+        vertex->pending++;
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader->t_final[i] && !triangle->vertices[i]->finalized)
+        {
+          normalizer->vertex_hash->erase(smreader->t_idx[i]);
+          normalizer->finalizeVertex(triangle->vertices[i]);
+        }
+      }
+    }
+    else if (event == SM_FINALIZED)
+    {
+      hash_element = normalizer->vertex_hash->find(smreader->final_idx);
+      // vertices must preceed their finalization in a pre-order mesh
+      if (hash_element == normalizer->vertex_hash->end())
+      {
+        fprintf(stderr, "FATAL ERROR: finalized vertex not in hash. corrupt pre-order mesh.\n");
+        return -1;
+      }
+      vertex = (*hash_element).second;
+      normalizer->vertex_hash->erase(hash_element);
+      normalizer->finalizeVertex(vertex);
+    }
+    else if (event == SM_EOF)
+    {
+      // all remaining vertices are implicitely finalized
+      for (hash_element = normalizer->vertex_hash->begin(); hash_element != normalizer->vertex_hash->end(); hash_element++)
+      {
+        normalizer->finalizeVertex((*hash_element).second);
+      }
+      normalizer->vertex_hash->clear();
+      eof = true;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+SMevent SMreadNormals::read_element()
+{
+  int i;
+  SMvertex* vertex;
+
+  if (have_isolated)
+  {
+    have_isolated = false;
+    final_idx = v_idx;
+    return SM_FINALIZED;
+  }
+
+  have_finalized = next_finalized = 0;
+
+  int ok = read_input();
+  if (ok <= 0)
+  {
+    return (ok == 0 ? SM_EOF : SM_ERROR);
+  }
+
+  if (normalizer->output_vertex_first)
+  {
+    vertex = normalizer->output_vertex_first;
+    normalizer->output_vertex_first = vertex->buffer_next;
+    if (normalizer->output_vertex_first == 0) normalizer->output_vertex_last = 0;
+
+    vertex->index = v_count;
+    v_idx = v_count;
+    VecCopy3fv(v_pos_f, vertex->v);
+    float length = VecLength3fv(vertex->n);
+    if (length > 1e-30f)
+    {
+      VecScalarDiv3fv(v_nor_f, vertex->n, length);
+    }
+    else
+    {
+      VecCopy3fv(v_nor_f, vertex->n);
+    }
+    v_count++;
+
+    // a vertex without triangles is finalized right away
+    if (vertex->pending == 0)
+    {
+      normalizer->deallocVertex(vertex);
+      have_isolated = true;
+    }
+    return SM_VERTEX;
+  }
+  else
+  {
+    SMtriangle* triangle = normalizer->output_triangle_first;
+    normalizer->output_triangle_first = triangle->buffer_next;
+    if (normalizer->output_triangle_first == 0) normalizer->output_triangle_last = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+      vertex = triangle->vertices[i];
+      t_idx[i] = vertex->index;
+      vertex->pending--;
+      if (vertex->pending == 0)
+      {
+        t_final[i] = true;
+        finalized_vertices[have_finalized++] = t_idx[i];
+        normalizer->deallocVertex(vertex); // it can still be used until the next vertex is alloced
+      }
+      else
+      {
+        t_final[i] = false;
+      }
+    }
+    normalizer->deallocTriangle(triangle);
+    f_count++;
+    return SM_TRIANGLE;
+  }
+}
+
+SMevent SMreadNormals::read_event()
+{
+  if (next_finalized < have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    next_finalized++;
+    return SM_FINALIZED;
+  }
+  return read_element();
+}
+
+SMreadNormals::SMreadNormals()
+{
+  // init of SMreader interface
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreadNormals
+  smreader = 0;
+  eof = false;
+
+  have_isolated = false;
+  have_finalized = next_finalized = 0;
+
+  normalizer = new SMnormalizer();
+}
+
+SMreadNormals::~SMreadNormals()
+{
+  delete normalizer;
+}
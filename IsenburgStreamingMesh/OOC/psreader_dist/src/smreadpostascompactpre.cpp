@@ -33,8 +33,10 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smtrace.h"
 
 #include <hash_map.h>
+#include "poolallocator.h"
 
 #include "dynamicvector.h"
 
@@ -44,7 +46,7 @@ typedef struct SMvertex
 {
   SMvertex* buffer_next;    // used for efficient memory management
   float v[3];
-  int index;
+  SMidx index;
   int list_size;
   int list_alloc;
   SMtriangle** list;
@@ -58,12 +60,18 @@ typedef struct SMtriangle
   int ready;
 } SMtriangle;
 
-typedef hash_map<int, SMvertex*> my_hash;
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
 
 static my_hash* vertex_hash;
 
-static DynamicVector* waiting_area;
-static DynamicVector* output_triangles;
+typedef DynamicVector<SMtriangle,&SMtriangle::dynamicvector> my_triangle_vector;
+
+static my_triangle_vector* waiting_area;
+static my_triangle_vector* output_triangles;
 
 static int vertex_buffer_size;
 static int triangle_buffer_size;
@@ -262,8 +270,8 @@ bool SMreadPostAsCompactPre::open(SMreader* smreader, bool preserve_order, int l
 
   vertex_hash = new my_hash;
 
-  waiting_area = new DynamicVector();
-  output_triangles = new DynamicVector();
+  waiting_area = new my_triangle_vector();
+  output_triangles = new my_triangle_vector();
 
   initVertexBuffer(1024, 0);
   initTriangleBuffer(2048, limit_buffer_size);
@@ -319,7 +327,7 @@ int SMreadPostAsCompactPre::read_postorder_input()
         // create vertex
         vertex = allocVertex();
         // insert vertex into hash
-        vertex_hash->insert(my_hash::value_type(smreader->t_idx[i], vertex));
+        sm_trace_hash_insert(vertex_hash, my_hash::value_type(smreader->t_idx[i], vertex), "SMreadPostAsCompactPre::vertex_hash");
       }
       else
       {
@@ -369,7 +377,7 @@ int SMreadPostAsCompactPre::read_postorder_input()
 
             while (waiting_area->size())
             {
-              triangle = (SMtriangle*)waiting_area->getFirstElement();
+              triangle = waiting_area->getFirstElement();
               if (triangle->ready == 3)
               {
                 waiting_area->removeFirstElement();
@@ -426,7 +434,7 @@ int SMreadPostAsCompactPre::read_triangle()
 
   // get next output triangle
 
-  triangle = (SMtriangle*)output_triangles->getAndRemoveFirstElement();
+  triangle = output_triangles->getAndRemoveFirstElement();
   have_triangle = 1;
 
   // look for new or finalized vertices and fill in indices, finalization, and positions
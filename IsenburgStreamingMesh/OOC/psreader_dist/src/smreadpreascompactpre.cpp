@@ -33,8 +33,10 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smtrace.h"
 
 #include <hash_map.h>
+#include "poolallocator.h"
 
 #include "dynamicvector.h"
 
@@ -44,7 +46,7 @@ typedef struct SMvertex
 {
   SMvertex* buffer_next;    // used for efficient memory management
   float v[3];
-  int index;
+  SMidx index;
   SMtriangle* last_triangle;
 } SMvertex;
 
@@ -56,12 +58,18 @@ typedef struct SMtriangle
   int ready;
 } SMtriangle;
 
-typedef hash_map<int, SMvertex*> my_hash;
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
 
 static my_hash* vertex_hash;
 
-static DynamicVector* waiting_area;
-static DynamicVector* output_triangles;
+typedef DynamicVector<SMtriangle,&SMtriangle::dynamicvector> my_triangle_vector;
+
+static my_triangle_vector* waiting_area;
+static my_triangle_vector* output_triangles;
 
 static int vertex_buffer_size;
 static int triangle_buffer_size;
@@ -260,8 +268,8 @@ bool SMreadPreAsCompactPre::open(SMreader* smreader, bool preserve_order, int li
 
   vertex_hash = new my_hash;
 
-  waiting_area = new DynamicVector();
-  output_triangles = new DynamicVector();
+  waiting_area = new my_triangle_vector();
+  output_triangles = new my_triangle_vector();
 
   initVertexBuffer(1024, limit_buffer_size/2); // do we want this?
   initTriangleBuffer(2048, limit_buffer_size); // this is our limit
@@ -349,7 +357,7 @@ int SMreadPreAsCompactPre::read_preorder_input()
 
               while (waiting_area->size())
               {
-                SMtriangle* next_triangle = (SMtriangle*)waiting_area->getFirstElement();
+                SMtriangle* next_triangle = waiting_area->getFirstElement();
                 if (next_triangle->ready == 3)
                 {
                   waiting_area->removeFirstElement();
@@ -389,7 +397,7 @@ int SMreadPreAsCompactPre::read_preorder_input()
 
               while (waiting_area->size())
               {
-                triangle = (SMtriangle*)waiting_area->getFirstElement();
+                triangle = waiting_area->getFirstElement();
                 if (triangle->ready == 3)
                 {
                   waiting_area->removeFirstElement();
@@ -425,7 +433,7 @@ int SMreadPreAsCompactPre::read_preorder_input()
     // create vertex
     vertex = allocVertex();
     // insert vertex into hash
-    vertex_hash->insert(my_hash::value_type(smreader->v_idx, vertex));
+    sm_trace_hash_insert(vertex_hash, my_hash::value_type(smreader->v_idx, vertex), "SMreadPreAsCompactPre::vertex_hash");
     // copy vertex coordinates
     VecCopy3fv(vertex->v, smreader->v_pos_f);
   }
@@ -461,7 +469,7 @@ int SMreadPreAsCompactPre::read_preorder_input()
 
             while (waiting_area->size())
             {
-              triangle = (SMtriangle*)waiting_area->getFirstElement();
+              triangle = waiting_area->getFirstElement();
               if (triangle->ready == 3)
               {
                 waiting_area->removeFirstElement();
@@ -507,7 +515,7 @@ int SMreadPreAsCompactPre::read_preorder_input()
       {
         while (waiting_area->size())
         {
-          triangle = (SMtriangle*)waiting_area->getFirstElement();
+          triangle = waiting_area->getFirstElement();
           waiting_area->removeFirstElement();
           output_triangles->addElement(triangle);
         }
@@ -538,7 +546,7 @@ int SMreadPreAsCompactPre::read_triangle()
 
   // get next output triangle
 
-  triangle = (SMtriangle*)output_triangles->getAndRemoveFirstElement();
+  triangle = output_triangles->getAndRemoveFirstElement();
   have_triangle = 1;
 
   // look for new or finalized vertices and fill in indices, finalization, and positions
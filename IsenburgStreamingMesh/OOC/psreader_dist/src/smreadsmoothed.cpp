@@ -0,0 +1,877 @@
+/*
+===============================================================================
+
+  FILE:  SMreadSmoothed.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smreadsmoothed.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "vec3fv.h"
+#include "smstats.h"
+#include "smtrace.h"
+
+#include <hash_map.h>
+#include "poolallocator.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SMOOTHED_SSE
+#include <xmmintrin.h>
+#endif
+
+struct SMtriangle;
+
+typedef struct SMvertex
+{
+  SMvertex* buffer_next;        // used for efficient memory management and the output queue
+  SMvertex* work_next;          // the vertices that may be able to do their next step
+  float p[2][4];                // the positions after the last two steps. p[s&1] is after step s
+  int level;                    // the number of steps done
+  SMidx index;                  // the index in the output
+  bool finalized;
+  bool working;
+  int pending;                  // its triangles that were not yet passed on
+  SMtriangle* first_triangle;   // its triangles are linked through their corners
+  int first_corner;
+} SMvertex;
+
+typedef struct SMtriangle
+{
+  SMtriangle* buffer_next;      // used for efficient memory management and the output queue
+  SMvertex* vertices[3];
+  SMtriangle* next_triangle[3]; // the next triangle around vertices[i]
+  int next_corner[3];
+  int ready;                    // how many of its corners did all steps
+} SMtriangle;
+
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
+
+// the state of the smoothing is kept per reader so that several of them can
+// be chained on one thread and so that its statistics can be queried from
+// another thread
+
+struct SMsmoother
+{
+  my_hash* vertex_hash;
+
+  // vertices and triangles that are ready to be passed on. vertices go first.
+
+  SMvertex* output_vertex_first;
+  SMvertex* output_vertex_last;
+  SMtriangle* output_triangle_first;
+  SMtriangle* output_triangle_last;
+
+  // finalized vertices whose neighbors may have caught up with them
+
+  SMvertex* work_first;
+
+  // finalized vertices that did not do all steps yet
+
+  int delayed_number;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_in_width;
+  int stat_vertex_buffer;
+  int stat_triangle_buffer;
+  int stat_delayed;
+  int stat_steps;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int vertex_buffer_size;
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int vertex_blocks_number;
+
+  int triangle_buffer_size;
+  int triangle_buffer_alloc;
+  SMtriangle* triangle_buffer_next;
+  SMtriangle** triangle_blocks;
+  int triangle_blocks_number;
+
+  int initVertexBuffer(int size);
+  SMvertex* allocVertexBlock(int size);
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+  int initTriangleBuffer(int size);
+  SMtriangle* allocTriangleBlock(int size);
+  SMtriangle* allocTriangle();
+  void deallocTriangle(SMtriangle* triangle);
+
+  void addWork(SMvertex* vertex);
+  bool stepVertex(SMvertex* vertex, const float* factors);
+  void passOnVertex(SMvertex* vertex);
+  void doWork(int steps, const float* factors);
+  void finalizeVertex(SMvertex* vertex, int steps);
+
+  SMsmoother();
+  ~SMsmoother();
+};
+
+SMsmoother::SMsmoother()
+{
+  vertex_hash = 0;
+
+  output_vertex_first = output_vertex_last = 0;
+  output_triangle_first = output_triangle_last = 0;
+  work_first = 0;
+  delayed_number = 0;
+
+  stats = 0;
+
+  vertex_buffer_size = 0;
+  vertex_buffer_alloc = 1024;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_number = 0;
+
+  triangle_buffer_size = 0;
+  triangle_buffer_alloc = 1024;
+  triangle_buffer_next = 0;
+  triangle_blocks = 0;
+  triangle_blocks_number = 0;
+}
+
+SMsmoother::~SMsmoother()
+{
+  int i;
+  for (i = 0; i < vertex_blocks_number; i++)
+  {
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  for (i = 0; i < triangle_blocks_number; i++)
+  {
+    free(triangle_blocks[i]);
+  }
+  if (triangle_blocks) free(triangle_blocks);
+  if (vertex_hash) delete vertex_hash;
+  if (stats) delete stats;
+}
+
+// efficient memory allocation for vertices. every block is remembered so
+// that the destructor can give it back.
+
+SMvertex* SMsmoother::allocVertexBlock(int size)
+{
+  SMvertex* block = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for vertex buffer failed\n");
+    return 0;
+  }
+  vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+  vertex_blocks[vertex_blocks_number] = block;
+  vertex_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMsmoother::initVertexBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (vertex_buffer_next)
+  {
+    vertex_buffer_size = 0;
+    return 1;
+  }
+
+  vertex_buffer_next = allocVertexBlock(size);
+
+  if (vertex_buffer_next == 0)
+  {
+    return 0;
+  }
+  vertex_buffer_alloc = size;
+  vertex_buffer_size = 0;
+  return 1;
+}
+
+SMvertex* SMsmoother::allocVertex()
+{
+  if (vertex_buffer_next == 0)
+  {
+    vertex_buffer_next = allocVertexBlock(vertex_buffer_alloc);
+    if (vertex_buffer_next == 0)
+    {
+      return 0;
+    }
+    vertex_buffer_alloc = 2*vertex_buffer_alloc;
+  }
+  // get pointer to next available vertex
+  SMvertex* vertex = vertex_buffer_next;
+  vertex_buffer_next = vertex->buffer_next;
+
+  vertex->index = -1;
+  vertex->level = 0;
+  vertex->finalized = false;
+  vertex->working = false;
+  vertex->pending = 0;
+  vertex->first_triangle = 0;
+
+  vertex_buffer_size++;
+
+  stats->level(stat_vertex_buffer, vertex_buffer_size);
+
+  return vertex;
+}
+
+void SMsmoother::deallocVertex(SMvertex* vertex)
+{
+  vertex->buffer_next = vertex_buffer_next;
+  vertex_buffer_next = vertex;
+  vertex_buffer_size--;
+  stats->down(stat_vertex_buffer);
+}
+
+// efficient memory allocation for triangles
+
+SMtriangle* SMsmoother::allocTriangleBlock(int size)
+{
+  SMtriangle* block = (SMtriangle*)malloc(sizeof(SMtriangle)*size);
+  if (block == 0)
+  {
+    fprintf(stderr,"malloc for triangle buffer failed\n");
+    return 0;
+  }
+  triangle_blocks = (SMtriangle**)realloc(triangle_blocks, sizeof(SMtriangle*)*(triangle_blocks_number+1));
+  triangle_blocks[triangle_blocks_number] = block;
+  triangle_blocks_number++;
+  for (int i = 0; i < size; i++)
+  {
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMsmoother::initTriangleBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (triangle_buffer_next)
+  {
+    triangle_buffer_size = 0;
+    return 1;
+  }
+
+  triangle_buffer_next = allocTriangleBlock(size);
+
+  if (triangle_buffer_next == 0)
+  {
+    return 0;
+  }
+  triangle_buffer_alloc = size;
+  triangle_buffer_size = 0;
+  return 1;
+}
+
+SMtriangle* SMsmoother::allocTriangle()
+{
+  if (triangle_buffer_next == 0)
+  {
+    triangle_buffer_next = allocTriangleBlock(triangle_buffer_alloc);
+    if (triangle_buffer_next == 0)
+    {
+      return 0;
+    }
+    triangle_buffer_alloc = 2*triangle_buffer_alloc;
+  }
+  // get pointer to next available triangle
+  SMtriangle* triangle = triangle_buffer_next;
+  triangle_buffer_next = triangle->buffer_next;
+
+  triangle->ready = 0;
+
+  triangle_buffer_size++;
+
+  stats->level(stat_triangle_buffer, triangle_buffer_size);
+
+  return triangle;
+}
+
+void SMsmoother::deallocTriangle(SMtriangle* triangle)
+{
+  triangle->buffer_next = triangle_buffer_next;
+  triangle_buffer_next = triangle;
+  triangle_buffer_size--;
+  stats->down(stat_triangle_buffer);
+}
+
+void SMsmoother::addWork(SMvertex* vertex)
+{
+  if (!vertex->working)
+  {
+    vertex->working = true;
+    vertex->work_next = work_first;
+    work_first = vertex;
+  }
+}
+
+// a vertex can do step s+1 once all of its neighbors did step s. none of
+// them is more than one step ahead, so p[s&1] holds its position after s.
+
+bool SMsmoother::stepVertex(SMvertex* vertex, const float* factors)
+{
+  int s = vertex->level;
+  int i0, i1, i2;
+  int number = 0;
+  SMvertex* neighbor1;
+  SMvertex* neighbor2;
+  SMtriangle* triangle = vertex->first_triangle;
+  int corner = vertex->first_corner;
+
+  while (triangle)
+  {
+    i1 = (corner+1)%3;
+    i2 = (corner+2)%3;
+    if (triangle->vertices[i1]->level < s || triangle->vertices[i2]->level < s)
+    {
+      return false;
+    }
+    SMtriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+
+  i0 = s&1;
+  triangle = vertex->first_triangle;
+  corner = vertex->first_corner;
+#ifdef SMOOTHED_SSE
+  __m128 sum = _mm_setzero_ps();
+  while (triangle)
+  {
+    neighbor1 = triangle->vertices[(corner+1)%3];
+    neighbor2 = triangle->vertices[(corner+2)%3];
+    sum = _mm_add_ps(sum, _mm_add_ps(_mm_loadu_ps(neighbor1->p[i0]), _mm_loadu_ps(neighbor2->p[i0])));
+    number += 2;
+    SMtriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+  __m128 position = _mm_loadu_ps(vertex->p[i0]);
+  if (number)
+  {
+    __m128 umbrella = _mm_sub_ps(_mm_mul_ps(sum, _mm_set1_ps(1.0f/number)), position);
+    position = _mm_add_ps(position, _mm_mul_ps(umbrella, _mm_set1_ps(factors[i0])));
+  }
+  _mm_storeu_ps(vertex->p[1-i0], position);
+#else
+  float sum[3];
+  VecZero3fv(sum);
+  while (triangle)
+  {
+    neighbor1 = triangle->vertices[(corner+1)%3];
+    neighbor2 = triangle->vertices[(corner+2)%3];
+    VecSelfAdd3fv(sum, neighbor1->p[i0]);
+    VecSelfAdd3fv(sum, neighbor2->p[i0]);
+    number += 2;
+    SMtriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+  if (number)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      vertex->p[1-i0][i] = vertex->p[i0][i] + factors[i0]*(sum[i]/number - vertex->p[i0][i]);
+    }
+  }
+  else
+  {
+    VecCopy3fv(vertex->p[1-i0], vertex->p[i0]);
+  }
+#endif
+  vertex->level++;
+  stats->count(stat_steps);
+  return true;
+}
+
+// a vertex that did all steps is ready to be passed on and so are those of
+// its triangles whose three corners now all did all steps
+
+void SMsmoother::passOnVertex(SMvertex* vertex)
+{
+  vertex->buffer_next = 0;
+  if (output_vertex_last)
+  {
+    output_vertex_last->buffer_next = vertex;
+  }
+  else
+  {
+    output_vertex_first = vertex;
+  }
+  output_vertex_last = vertex;
+
+  SMtriangle* triangle = vertex->first_triangle;
+  int corner = vertex->first_corner;
+  while (triangle)
+  {
+    triangle->ready++;
+    if (triangle->ready == 3)
+    {
+      triangle->buffer_next = 0;
+      if (output_triangle_last)
+      {
+        output_triangle_last->buffer_next = triangle;
+      }
+      else
+      {
+        output_triangle_first = triangle;
+      }
+      output_triangle_last = triangle;
+    }
+    SMtriangle* next_triangle = triangle->next_triangle[corner];
+    corner = triangle->next_corner[corner];
+    triangle = next_triangle;
+  }
+}
+
+// lets every vertex on the work list do as many steps as it can. whenever
+// a vertex does a step its finalized neighbors may be able to do theirs.
+
+void SMsmoother::doWork(int steps, const float* factors)
+{
+  while (work_first)
+  {
+    SMvertex* vertex = work_first;
+    work_first = vertex->work_next;
+    vertex->working = false;
+
+    if (vertex->level < steps && stepVertex(vertex, factors))
+    {
+      SMtriangle* triangle = vertex->first_triangle;
+      int corner = vertex->first_corner;
+      while (triangle)
+      {
+        for (int i = 1; i < 3; i++)
+        {
+          SMvertex* neighbor = triangle->vertices[(corner+i)%3];
+          if (neighbor->finalized && neighbor->level < steps)
+          {
+            addWork(neighbor);
+          }
+        }
+        SMtriangle* next_triangle = triangle->next_triangle[corner];
+        corner = triangle->next_corner[corner];
+        triangle = next_triangle;
+      }
+      if (vertex->level == steps)
+      {
+        delayed_number--;
+        stats->level(stat_delayed, delayed_number);
+        passOnVertex(vertex);
+      }
+      else
+      {
+        addWork(vertex);
+      }
+    }
+  }
+}
+
+void SMsmoother::finalizeVertex(SMvertex* vertex, int steps)
+{
+  vertex->finalized = true;
+  if (steps == 0)
+  {
+    passOnVertex(vertex);
+  }
+  else
+  {
+    delayed_number++;
+    stats->level(stat_delayed, delayed_number);
+    addWork(vertex);
+  }
+}
+
+bool SMreadSmoothed::open(SMreader* smreader, int iterations, float lambda, float mu)
+{
+  if (smreader == 0 || smreader->post_order)
+  {
+    return false;
+  }
+  if (iterations < 0)
+  {
+    fprintf(stderr,"ERROR: SMreadSmoothed needs a positive number of iterations\n");
+    return false;
+  }
+  if (lambda <= 0.0f || mu >= -lambda)
+  {
+    fprintf(stderr,"ERROR: SMreadSmoothed needs 0 < lambda (%g) < -mu (%g)\n", lambda, -mu);
+    return false;
+  }
+  this->smreader = smreader;
+  eof = false;
+
+  steps = 2*iterations;
+  factors[0] = lambda;
+  factors[1] = mu;
+
+  nverts = smreader->nverts;
+  nfaces = smreader->nfaces;
+
+  v_count = 0;
+  f_count = 0;
+
+  // a step by f moves a vertex to (1-f)*p + f*a where a is the average of
+  // its neighbors. the steps with f outside of [0,1] (e.g. those by mu) can
+  // push a vertex out of the bounding box of the input, and a box that is
+  // enlarged enough for every such step grows with (1+2|f|)^k. that would
+  // waste most of the precision of a quantizing writer. so there is none.
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  have_isolated = false;
+  have_finalized = next_finalized = 0;
+
+  if (smoother->vertex_hash) delete smoother->vertex_hash;
+  smoother->vertex_hash = new my_hash;
+
+  smoother->output_vertex_first = smoother->output_vertex_last = 0;
+  smoother->output_triangle_first = smoother->output_triangle_last = 0;
+  smoother->work_first = 0;
+  smoother->delayed_number = 0;
+
+  if (smoother->stats == 0)
+  {
+    smoother->stats = new SMstats("SMreadSmoothed");
+    smoother->stat_in_width = smoother->stats->add("in_width", SM_STATS_LEVEL);
+    smoother->stat_vertex_buffer = smoother->stats->add("vertex_buffer", SM_STATS_LEVEL);
+    smoother->stat_triangle_buffer = smoother->stats->add("triangle_buffer", SM_STATS_LEVEL);
+    smoother->stat_delayed = smoother->stats->add("delayed_vertices", SM_STATS_LEVEL);
+    smoother->stat_steps = smoother->stats->add("steps", SM_STATS_COUNTER);
+  }
+  smoother->stats->reset();
+
+  if (!smoother->initVertexBuffer(1024) || !smoother->initTriangleBuffer(2048))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+void SMreadSmoothed::close()
+{
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  smreader->close();
+
+  // put whatever was not passed on back on the free lists. the vertices
+  // that are not finalized and those waiting for them are passed on as
+  // they are so that all of their triangles reach the output queue.
+
+  my_hash::iterator hash_element;
+  for (hash_element = smoother->vertex_hash->begin(); hash_element != smoother->vertex_hash->end(); hash_element++)
+  {
+    (*hash_element).second->finalized = true;
+    smoother->addWork((*hash_element).second);
+  }
+  delete smoother->vertex_hash;
+  smoother->vertex_hash = 0;
+  while (smoother->work_first)
+  {
+    SMvertex* vertex = smoother->work_first;
+    smoother->work_first = vertex->work_next;
+    vertex->level = steps;
+    smoother->passOnVertex(vertex);
+    SMtriangle* triangle = vertex->first_triangle;
+    int corner = vertex->first_corner;
+    while (triangle)
+    {
+      for (int i = 1; i < 3; i++)
+      {
+        SMvertex* neighbor = triangle->vertices[(corner+i)%3];
+        if (neighbor->level < steps)
+        {
+          smoother->addWork(neighbor);
+        }
+      }
+      SMtriangle* next_triangle = triangle->next_triangle[corner];
+      corner = triangle->next_corner[corner];
+      triangle = next_triangle;
+    }
+  }
+
+  while (smoother->output_triangle_first)
+  {
+    SMtriangle* triangle = smoother->output_triangle_first;
+    smoother->output_triangle_first = triangle->buffer_next;
+    for (int i = 0; i < 3; i++)
+    {
+      triangle->vertices[i]->pending--;
+      if (triangle->vertices[i]->pending == 0 && triangle->vertices[i]->index != -1)
+      {
+        smoother->deallocVertex(triangle->vertices[i]);
+      }
+    }
+    smoother->deallocTriangle(triangle);
+  }
+  while (smoother->output_vertex_first)
+  {
+    SMvertex* vertex = smoother->output_vertex_first;
+    smoother->output_vertex_first = vertex->buffer_next;
+    if (vertex->pending == 0)
+    {
+      smoother->deallocVertex(vertex);
+    }
+  }
+  smoother->output_vertex_last = 0;
+  smoother->output_triangle_last = 0;
+}
+
+const SMstats* SMreadSmoothed::get_stats() const
+{
+  return smoother->stats;
+}
+
+// reads from the input until something is ready to be passed on. returns
+// 1 if so, 0 at the end of the input, and -1 on error.
+
+int SMreadSmoothed::read_input()
+{
+  int i;
+  SMvertex* vertex;
+  SMtriangle* triangle;
+  my_hash::iterator hash_element;
+
+  while (smoother->output_vertex_first == 0 && smoother->output_triangle_first == 0)
+  {
+    if (eof)
+    {
+      return 0;
+    }
+
+    SMevent event = smreader->read_element();
+
+    if (event == SM_VERTEX)
+    {
+      vertex = smoother->allocVertex();
+      VecCopy3fv(vertex->p[0], smreader->v_pos_f);
+      vertex->p[0][3] = 0.0f;
+      sm_trace_hash_insert(smoother->vertex_hash, my_hash::value_type(smreader->v_idx, vertex), "SMreadSmoothed::vertex_hash");
+      smoother->stats->level(smoother->stat_in_width, smoother->vertex_hash->size());
+    }
+    else if (event == SM_TRIANGLE)
+    {
+      triangle = smoother->allocTriangle();
+      for (i = 0; i < 3; i++)
+      {
+        hash_element = smoother->vertex_hash->find(smreader->t_idx[i]);
+        // vertices must preceed triangles in a pre-order mesh
+        if (hash_element == smoother->vertex_hash->end())
+        {
+          fprintf(stderr, "FATAL ERROR: triangle vertex not in hash. corrupt pre-order mesh.\n");
+          smoother->deallocTriangle(triangle);
+          return -1;
+        }
+        triangle->vertices[i] = (*hash_element).second;
+      }
+      for (i = 0; i < 3; i++)
+      {
+        vertex = triangle->vertices[i];
+        // link the corner into the list of the vertex
+        triangle->next_triangle[i] = vertex->first_triangle;
+        triangle->next_corner[i] = vertex->first_corner;
+        vertex->first_triangle = triangle;
+        vertex->first_corner = i;
+        vertex->pending++;
+      }
+      for (i = 0; i < 3; i++)
+      {
+        if (smreader->t_final[i] && !triangle->vertices[i]->finalized)
+        {
+          smoother->vertex_hash->erase(smreader->t_idx[i]);
+          smoother->finalizeVertex(triangle->vertices[i], steps);
+        }
+      }
+      smoother->doWork(steps, factors);
+    }
+    else if (event == SM_FINALIZED)
+    {
+      hash_element = smoother->vertex_hash->find(smreader->final_idx);
+      // vertices must preceed their finalization in a pre-order mesh
+      if (hash_element == smoother->vertex_hash->end())
+      {
+        fprintf(stderr, "FATAL ERROR: finalized vertex not in hash. corrupt pre-order mesh.\n");
+        return -1;
+      }
+      vertex = (*hash_element).second;
+      smoother->vertex_hash->erase(hash_element);
+      smoother->finalizeVertex(vertex, steps);
+      smoother->doWork(steps, factors);
+    }
+    else if (event == SM_EOF)
+    {
+      // all remaining vertices are implicitely finalized
+      for (hash_element = smoother->vertex_hash->begin(); hash_element != smoother->vertex_hash->end(); hash_element++)
+      {
+        smoother->finalizeVertex((*hash_element).second, steps);
+      }
+      smoother->vertex_hash->clear();
+      smoother->doWork(steps, factors);
+      eof = true;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+  return 1;
+}
+
+SMevent SMreadSmoothed::read_element()
+{
+  int i;
+  SMvertex* vertex;
+
+  if (have_isolated)
+  {
+    have_isolated = false;
+    final_idx = v_idx;
+    return SM_FINALIZED;
+  }
+
+  have_finalized = next_finalized = 0;
+
+  int ok = read_input();
+  if (ok <= 0)
+  {
+    return (ok == 0 ? SM_EOF : SM_ERROR);
+  }
+
+  if (smoother->output_vertex_first)
+  {
+    vertex = smoother->output_vertex_first;
+    smoother->output_vertex_first = vertex->buffer_next;
+    if (smoother->output_vertex_first == 0) smoother->output_vertex_last = 0;
+
+    vertex->index = v_count;
+    v_idx = v_count;
+    VecCopy3fv(v_pos_f, vertex->p[steps&1]);
+    v_count++;
+
+    // a vertex without triangles is finalized right away
+    if (vertex->pending == 0)
+    {
+      smoother->deallocVertex(vertex);
+      have_isolated = true;
+    }
+    return SM_VERTEX;
+  }
+  else
+  {
+    SMtriangle* triangle = smoother->output_triangle_first;
+    smoother->output_triangle_first = triangle->buffer_next;
+    if (smoother->output_triangle_first == 0) smoother->output_triangle_last = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+      vertex = triangle->vertices[i];
+      t_idx[i] = vertex->index;
+      vertex->pending--;
+      if (vertex->pending == 0)
+      {
+        t_final[i] = true;
+        finalized_vertices[have_finalized++] = t_idx[i];
+        smoother->deallocVertex(vertex); // it can still be used until the next vertex is alloced
+      }
+      else
+      {
+        t_final[i] = false;
+      }
+    }
+    smoother->deallocTriangle(triangle);
+    f_count++;
+    return SM_TRIANGLE;
+  }
+}
+
+SMevent SMreadSmoothed::read_event()
+{
+  if (next_finalized < have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    next_finalized++;
+    return SM_FINALIZED;
+  }
+  return read_element();
+}
+
+SMreadSmoothed::SMreadSmoothed()
+{
+  // init of SMreader interface
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  post_order = false;
+
+  // init of SMreadSmoothed
+  smreader = 0;
+  eof = false;
+
+  steps = 0;
+  factors[0] = 0.0f;
+  factors[1] = 0.0f;
+
+  have_isolated = false;
+  have_finalized = next_finalized = 0;
+
+  smoother = new SMsmoother();
+}
+
+SMreadSmoothed::~SMreadSmoothed()
+{
+  delete smoother;
+}
@@ -0,0 +1,172 @@
+/*
+===============================================================================
+
+  FILE:  SMstats.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smstats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char* type_names[] = {"counter", "level", "histogram", "log2"};
+
+int SMstats::add(const char* name, int type, int nbins)
+{
+  int h;
+  for (h = 0; h < nstats; h++)
+  {
+    if (strcmp(stats[h].name, name) == 0)
+    {
+      return h;
+    }
+  }
+  if (nstats == stats_alloc)
+  {
+    stats_alloc = (stats_alloc ? 2*stats_alloc : 16);
+    stats = (SMstat*)realloc(stats, sizeof(SMstat)*stats_alloc);
+    if (stats == 0)
+    {
+      fprintf(stderr,"ERROR: realloc for SMstats failed\n");
+      exit(1);
+    }
+  }
+  h = nstats;
+  nstats++;
+  stats[h].name = name;
+  stats[h].type = type;
+  if (type == SM_STATS_LOG2)
+  {
+    stats[h].nbins = SM_STATS_MAX_BINS;
+  }
+  else if (type == SM_STATS_HISTOGRAM)
+  {
+    stats[h].nbins = (nbins < 1 ? 1 : (nbins > SM_STATS_MAX_BINS ? SM_STATS_MAX_BINS : nbins));
+  }
+  else
+  {
+    stats[h].nbins = 0;
+  }
+  stats[h].value = 0;
+  stats[h].max = 0;
+  memset(stats[h].bins, 0, sizeof(SMcount)*SM_STATS_MAX_BINS);
+  return h;
+}
+
+void SMstats::reset()
+{
+  for (int h = 0; h < nstats; h++)
+  {
+    stats[h].value = 0;
+    stats[h].max = 0;
+    memset(stats[h].bins, 0, sizeof(SMcount)*SM_STATS_MAX_BINS);
+  }
+}
+
+int SMstats::size() const
+{
+  return nstats;
+}
+
+const SMstat* SMstats::get(int i) const
+{
+  if (i < 0 || i >= nstats)
+  {
+    return 0;
+  }
+  return &(stats[i]);
+}
+
+const SMstat* SMstats::find(const char* name) const
+{
+  for (int h = 0; h < nstats; h++)
+  {
+    if (strcmp(stats[h].name, name) == 0)
+    {
+      return &(stats[h]);
+    }
+  }
+  return 0;
+}
+
+bool SMstats::write_json(FILE* file, int indent) const
+{
+  int h, i, n;
+
+  if (file == 0)
+  {
+    return false;
+  }
+
+  fprintf(file, "%*s{\n", indent, "");
+  fprintf(file, "%*s  \"name\": \"%s\",\n", indent, "", name);
+  fprintf(file, "%*s  \"stats\": {", indent, "");
+  for (h = 0; h < nstats; h++)
+  {
+    const SMstat* stat = &(stats[h]);
+    fprintf(file, "%s\n%*s    \"%s\": { \"type\": \"%s\", ", (h ? "," : ""), indent, "", stat->name, type_names[stat->type]);
+    if (stat->type == SM_STATS_COUNTER)
+    {
+      fprintf(file, "\"count\": " SM_COUNT_FORMAT " }", stat->value);
+    }
+    else if (stat->type == SM_STATS_LEVEL)
+    {
+      fprintf(file, "\"size\": " SM_COUNT_FORMAT ", \"maxsize\": " SM_COUNT_FORMAT " }", stat->value, stat->max);
+    }
+    else
+    {
+      // do not write the empty bins at the end
+      for (n = stat->nbins; n > 1 && stat->bins[n-1] == 0; n--);
+      fprintf(file, "\"samples\": " SM_COUNT_FORMAT ", \"max\": " SM_COUNT_FORMAT ", \"bins\": [", stat->value, stat->max);
+      for (i = 0; i < n; i++)
+      {
+        fprintf(file, "%s" SM_COUNT_FORMAT, (i ? ", " : ""), stat->bins[i]);
+      }
+      fprintf(file, "] }");
+    }
+  }
+  if (nstats)
+  {
+    fprintf(file, "\n%*s  }\n", indent, "");
+  }
+  else
+  {
+    fprintf(file, " }\n");
+  }
+  fprintf(file, "%*s}", indent, "");
+  return true;
+}
+
+SMstats::SMstats(const char* name)
+{
+  this->name = name;
+  stats = 0;
+  nstats = 0;
+  stats_alloc = 0;
+}
+
+SMstats::~SMstats()
+{
+  if (stats) free(stats);
+}
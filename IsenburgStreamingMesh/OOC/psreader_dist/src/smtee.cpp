@@ -0,0 +1,647 @@
+/*
+===============================================================================
+
+  FILE:  SMtee.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smtee.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "vec3fv.h"
+#include "smthread.h"
+
+// the elements are passed to the sinks on worker threads in blocks
+
+typedef struct SMteeEvent
+{
+  int event;
+  union
+  {
+    float v[3];
+    SMidx idx[3];
+    SMidx final_idx;
+  };
+  bool final[3];
+} SMteeEvent;
+
+typedef struct SMteeBlock
+{
+  int number;
+  bool eof;
+  SMteeEvent* events;
+} SMteeBlock;
+
+// a bounded queue with the SMtee as the producer and the sink as the
+// consumer. the SMtee fills the blocks in turn and hands each full block
+// to the sink, who gives it back once it has read all of its elements.
+// the header of the input is copied before the worker is started.
+
+typedef struct SMteeQueue
+{
+  int block_size;
+  int blocks;
+  SMteeBlock* block;
+  SMsemaphore full;
+  SMsemaphore empty;
+  int put_block;
+  SMteeBlock* put;
+  int waits;
+  int ncomments;
+  char** comments;
+  SMidx nverts;
+  SMidx nfaces;
+  bool have_bb;
+  float bb_min[3];
+  float bb_max[3];
+  bool post_order;
+} SMteeQueue;
+
+struct SMteeSink
+{
+  SMwriter* smwriter;
+  SMconsumer consumer;
+  void* data;
+  SMteeQueue* queue;
+  int waits;
+  SMthread thread;
+};
+
+static SMteeQueue* allocQueue(int block_size, int blocks)
+{
+  int b;
+  SMteeQueue* queue = (SMteeQueue*)malloc(sizeof(SMteeQueue));
+  queue->block_size = block_size;
+  queue->blocks = blocks;
+  queue->block = (SMteeBlock*)malloc(sizeof(SMteeBlock)*blocks);
+  for (b = 0; b < blocks; b++)
+  {
+    queue->block[b].number = 0;
+    queue->block[b].eof = false;
+    queue->block[b].events = (SMteeEvent*)malloc(sizeof(SMteeEvent)*block_size);
+  }
+  initSemaphore(&(queue->full), 0, blocks);
+  initSemaphore(&(queue->empty), blocks, blocks);
+  queue->put_block = 0;
+  queue->put = 0;
+  queue->waits = 0;
+  return queue;
+}
+
+static void deallocQueue(SMteeQueue* queue)
+{
+  int b;
+  destroySemaphore(&(queue->full));
+  destroySemaphore(&(queue->empty));
+  for (b = 0; b < queue->blocks; b++)
+  {
+    free(queue->block[b].events);
+  }
+  free(queue->block);
+  free(queue);
+}
+
+static void handOver(SMteeQueue* queue)
+{
+  postSemaphore(&(queue->full));
+  queue->put = 0;
+  queue->put_block = (queue->put_block + 1) % queue->blocks;
+}
+
+// a full block is only handed over when the next element is put because
+// the caller fills in the element after it was put
+
+static void nextBlock(SMteeQueue* queue)
+{
+  if (queue->put && queue->put->number == queue->block_size)
+  {
+    handOver(queue);
+  }
+  if (queue->put == 0)
+  {
+    if (waitSemaphore(&(queue->empty))) queue->waits++;
+    queue->put = &(queue->block[queue->put_block]);
+    queue->put->number = 0;
+    queue->put->eof = false;
+  }
+}
+
+static SMteeEvent* putEvent(SMteeQueue* queue, int event)
+{
+  nextBlock(queue);
+  SMteeEvent* tee_event = &(queue->put->events[queue->put->number++]);
+  tee_event->event = event;
+  return tee_event;
+}
+
+static void putEOF(SMteeQueue* queue)
+{
+  nextBlock(queue);
+  queue->put->eof = true;
+  handOver(queue);
+}
+
+// the consumer side of a queue is an smreader so that a sink on a worker
+// thread reads the mesh like any other
+
+class SMreadTeeQueue : public SMreader
+{
+public:
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  bool open(SMteeQueue* queue);
+
+  SMreadTeeQueue();
+  ~SMreadTeeQueue();
+
+private:
+  SMteeQueue* queue;
+  int get_block;
+  SMteeBlock* get;
+  int next;
+  int have_finalized, next_finalized;
+  SMidx finalized_vertices[3];
+
+  bool next_block();
+};
+
+bool SMreadTeeQueue::open(SMteeQueue* queue)
+{
+  this->queue = queue;
+  get_block = 0;
+  get = 0;
+  next = 0;
+  have_finalized = next_finalized = 0;
+
+  ncomments = queue->ncomments;
+  comments = queue->comments;
+  nverts = queue->nverts;
+  nfaces = queue->nfaces;
+  if (queue->have_bb)
+  {
+    bb_min_f = queue->bb_min;
+    bb_max_f = queue->bb_max;
+  }
+  post_order = queue->post_order;
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+// returns false at the end of the mesh
+
+bool SMreadTeeQueue::next_block()
+{
+  while (get == 0 || next == get->number)
+  {
+    if (get)
+    {
+      if (get->eof)
+      {
+        return false;
+      }
+      postSemaphore(&(queue->empty));
+      get_block = (get_block + 1) % queue->blocks;
+    }
+    waitSemaphore(&(queue->full));
+    get = &(queue->block[get_block]);
+    next = 0;
+  }
+  return true;
+}
+
+SMevent SMreadTeeQueue::read_element()
+{
+  int i;
+
+  have_finalized = next_finalized = 0;
+
+  if (queue == 0 || !next_block())
+  {
+    return SM_EOF;
+  }
+
+  SMteeEvent* tee_event = &(get->events[next++]);
+  switch (tee_event->event)
+  {
+  case SM_VERTEX:
+    VecCopy3fv(v_pos_f, tee_event->v);
+    v_idx = v_count;
+    v_count++;
+    if (post_order) {finalized_vertices[have_finalized] = v_idx; have_finalized++;}
+    return SM_VERTEX;
+  case SM_TRIANGLE:
+    for (i = 0; i < 3; i++)
+    {
+      t_idx[i] = tee_event->idx[i];
+      t_final[i] = tee_event->final[i];
+      if (t_final[i])
+      {
+        finalized_vertices[have_finalized] = t_idx[i];
+        have_finalized++;
+      }
+    }
+    f_count++;
+    return SM_TRIANGLE;
+  default:
+    final_idx = tee_event->final_idx;
+    return SM_FINALIZED;
+  }
+}
+
+SMevent SMreadTeeQueue::read_event()
+{
+  if (have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    have_finalized--; next_finalized++;
+    return SM_FINALIZED;
+  }
+  else
+  {
+    return read_element();
+  }
+}
+
+// reads what is left so that the SMtee never waits forever
+
+void SMreadTeeQueue::close()
+{
+  if (queue)
+  {
+    while (next_block()) next = get->number;
+    queue = 0;
+  }
+  bb_min_f = 0;
+  bb_max_f = 0;
+}
+
+SMreadTeeQueue::SMreadTeeQueue()
+{
+  ncomments = 0;
+  comments = 0;
+  nverts = -1;
+  nfaces = -1;
+  v_count = -1;
+  f_count = -1;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  post_order = false;
+  queue = 0;
+}
+
+SMreadTeeQueue::~SMreadTeeQueue()
+{
+  if (queue) close();
+}
+
+// an SMwriter on a worker thread is a consumer that copies the mesh
+
+static void write_mesh(SMreader* smreader, void* data)
+{
+  SMwriter* smwriter = (SMwriter*)data;
+  SMevent event;
+
+  while ((event = smreader->read_element()) > SM_EOF)
+  {
+    switch (event)
+    {
+    case SM_VERTEX:
+      smwriter->write_vertex(smreader->v_pos_f);
+      break;
+    case SM_TRIANGLE:
+      smwriter->write_triangle(smreader->t_idx, smreader->t_final);
+      break;
+    case SM_FINALIZED:
+      smwriter->write_finalized(smreader->final_idx);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+static SM_THREAD_RESULT run_sink(void* arg)
+{
+  SMteeSink* sink = (SMteeSink*)arg;
+  SMreadTeeQueue smreadteequeue;
+  smreadteequeue.open(sink->queue);
+  sink->consumer(&smreadteequeue, sink->data);
+  smreadteequeue.close();
+  return 0;
+}
+
+bool SMtee::open(SMreader* smreader)
+{
+  if (smreader == 0)
+  {
+    fprintf(stderr,"ERROR: no smreader to read from\n");
+    return false;
+  }
+  this->smreader = smreader;
+
+  ncomments = smreader->ncomments;
+  comments = smreader->comments;
+  nverts = smreader->nverts;
+  nfaces = smreader->nfaces;
+  bb_min_f = smreader->bb_min_f;
+  bb_max_f = smreader->bb_max_f;
+  post_order = smreader->post_order;
+
+  if (sinks == 0) sinks = (SMteeSink*)malloc(sizeof(SMteeSink)*SM_TEE_MAX_SINKS);
+  nsinks = 0;
+  finished = false;
+  have_finalized = next_finalized = 0;
+
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+int SMtee::add_sink(SMwriter* smwriter, SMconsumer consumer, void* data, bool thread, int block_size, int blocks)
+{
+  int i;
+
+  if (smreader == 0)
+  {
+    fprintf(stderr,"ERROR: the SMtee is not open\n");
+    return -1;
+  }
+  if (v_count || f_count)
+  {
+    fprintf(stderr,"ERROR: sinks must be added before the first element is read\n");
+    return -1;
+  }
+  if (nsinks == SM_TEE_MAX_SINKS)
+  {
+    fprintf(stderr,"ERROR: cannot have more than %d sinks\n", SM_TEE_MAX_SINKS);
+    return -1;
+  }
+  if (thread && (block_size < 1 || blocks < 1))
+  {
+    fprintf(stderr,"ERROR: %d blocks of size %d cannot hold anything\n", blocks, block_size);
+    return -1;
+  }
+
+  SMteeSink* sink = &(sinks[nsinks]);
+  sink->smwriter = smwriter;
+  sink->consumer = consumer;
+  sink->data = data;
+  sink->queue = 0;
+  sink->waits = 0;
+
+  if (smwriter)
+  {
+    for (i = 0; i < ncomments; i++) smwriter->add_comment(comments[i]);
+    if (nverts != -1) smwriter->set_nverts(nverts);
+    if (nfaces != -1) smwriter->set_nfaces(nfaces);
+    if (bb_min_f && bb_max_f) smwriter->set_boundingbox(bb_min_f, bb_max_f);
+  }
+
+  if (thread)
+  {
+    sink->queue = allocQueue(block_size, blocks);
+    sink->queue->ncomments = ncomments;
+    sink->queue->comments = comments;
+    sink->queue->nverts = nverts;
+    sink->queue->nfaces = nfaces;
+    sink->queue->have_bb = (bb_min_f && bb_max_f);
+    if (sink->queue->have_bb)
+    {
+      VecCopy3fv(sink->queue->bb_min, bb_min_f);
+      VecCopy3fv(sink->queue->bb_max, bb_max_f);
+    }
+    sink->queue->post_order = post_order;
+    if (!startThread(&(sink->thread), run_sink, sink))
+    {
+      fprintf(stderr,"ERROR: cannot start the thread for sink %d\n", nsinks);
+      deallocQueue(sink->queue);
+      return -1;
+    }
+  }
+
+  nsinks++;
+  return nsinks - 1;
+}
+
+int SMtee::add_writer(SMwriter* smwriter, bool thread, int block_size, int blocks)
+{
+  if (smwriter == 0)
+  {
+    fprintf(stderr,"ERROR: no smwriter to write to\n");
+    return -1;
+  }
+  return add_sink(smwriter, (thread ? write_mesh : 0), smwriter, thread, block_size, blocks);
+}
+
+int SMtee::add_consumer(SMconsumer consumer, void* data, int block_size, int blocks)
+{
+  if (consumer == 0)
+  {
+    fprintf(stderr,"ERROR: no consumer\n");
+    return -1;
+  }
+  return add_sink(0, consumer, data, true, block_size, blocks);
+}
+
+// the sinks on worker threads see the end of the mesh
+
+void SMtee::finish()
+{
+  int s;
+  if (finished) return;
+  for (s = 0; s < nsinks; s++)
+  {
+    if (sinks[s].queue) putEOF(sinks[s].queue);
+  }
+  finished = true;
+}
+
+SMevent SMtee::read_element()
+{
+  int i, s;
+  SMteeEvent* tee_event;
+
+  have_finalized = next_finalized = 0;
+
+  if (smreader == 0 || finished)
+  {
+    return SM_EOF;
+  }
+
+  SMevent event = smreader->read_element();
+  switch (event)
+  {
+  case SM_VERTEX:
+    VecCopy3fv(v_pos_f, smreader->v_pos_f);
+    v_idx = smreader->v_idx;
+    if (post_order) {finalized_vertices[have_finalized] = v_idx; have_finalized++;}
+    break;
+  case SM_TRIANGLE:
+    for (i = 0; i < 3; i++)
+    {
+      t_idx[i] = smreader->t_idx[i];
+      t_final[i] = smreader->t_final[i];
+      if (t_final[i])
+      {
+        finalized_vertices[have_finalized] = t_idx[i];
+        have_finalized++;
+      }
+    }
+    break;
+  case SM_FINALIZED:
+    final_idx = smreader->final_idx;
+    break;
+  default:
+    nverts = smreader->nverts;
+    nfaces = smreader->nfaces;
+    finish();
+    return event;
+  }
+  v_count = smreader->v_count;
+  f_count = smreader->f_count;
+
+  for (s = 0; s < nsinks; s++)
+  {
+    if (sinks[s].queue)
+    {
+      tee_event = putEvent(sinks[s].queue, event);
+      switch (event)
+      {
+      case SM_VERTEX:
+        VecCopy3fv(tee_event->v, v_pos_f);
+        break;
+      case SM_TRIANGLE:
+        tee_event->idx[0] = t_idx[0];
+        tee_event->idx[1] = t_idx[1];
+        tee_event->idx[2] = t_idx[2];
+        tee_event->final[0] = t_final[0];
+        tee_event->final[1] = t_final[1];
+        tee_event->final[2] = t_final[2];
+        break;
+      default:
+        tee_event->final_idx = final_idx;
+        break;
+      }
+    }
+    else
+    {
+      switch (event)
+      {
+      case SM_VERTEX:
+        sinks[s].smwriter->write_vertex(v_pos_f);
+        break;
+      case SM_TRIANGLE:
+        sinks[s].smwriter->write_triangle(t_idx, t_final);
+        break;
+      default:
+        sinks[s].smwriter->write_finalized(final_idx);
+        break;
+      }
+    }
+  }
+  return event;
+}
+
+SMevent SMtee::read_event()
+{
+  if (have_finalized)
+  {
+    final_idx = finalized_vertices[next_finalized];
+    have_finalized--; next_finalized++;
+    return SM_FINALIZED;
+  }
+  else
+  {
+    return read_element();
+  }
+}
+
+int SMtee::get_waits(int sink) const
+{
+  if (sink < 0 || sink >= nsinks) return 0;
+  return (sinks[sink].queue ? sinks[sink].queue->waits : sinks[sink].waits);
+}
+
+void SMtee::close()
+{
+  int s;
+
+  if (smreader == 0) return;
+
+  finish();
+  for (s = 0; s < nsinks; s++)
+  {
+    if (sinks[s].queue)
+    {
+      joinThread(&(sinks[s].thread));
+      sinks[s].waits = sinks[s].queue->waits;
+      deallocQueue(sinks[s].queue);
+      sinks[s].queue = 0;
+    }
+    if (sinks[s].smwriter) sinks[s].smwriter->close();
+  }
+
+  smreader->close();
+  smreader = 0;
+
+  ncomments = 0;
+  comments = 0;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  v_count = -1;
+  f_count = -1;
+}
+
+SMtee::SMtee()
+{
+  // init of SMreader interface
+  ncomments = 0;
+  comments = 0;
+  nverts = -1;
+  nfaces = -1;
+  v_count = -1;
+  f_count = -1;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  post_order = false;
+
+  // init of SMtee
+  smreader = 0;
+  sinks = 0;
+  nsinks = 0;
+  finished = false;
+  have_finalized = next_finalized = 0;
+}
+
+SMtee::~SMtee()
+{
+  if (smreader) close();
+  if (sinks) free(sinks);
+}
@@ -0,0 +1,271 @@
+/*
+===============================================================================
+
+  FILE:  SMtrace.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smtrace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define TRACE_THREAD __declspec(thread)
+#else
+#include <pthread.h>
+#include <time.h>
+#define TRACE_THREAD __thread
+#endif
+
+typedef struct SMtraceEvent
+{
+  const char* name;
+  const char* cat;
+  double ts;
+  char ph;
+} SMtraceEvent;
+
+typedef struct SMtraceRing
+{
+  SMtraceRing* next;
+  int tid;
+  int events_alloc;
+  int events_number; // number of events ever recorded into this ring
+  SMtraceEvent* events;
+} SMtraceRing;
+
+volatile bool sm_trace_on = false;
+
+static char* trace_file_name = 0;
+static int trace_events_per_thread = 0;
+static int trace_generation = 0;
+
+static SMtraceRing* trace_rings = 0;
+static int trace_rings_number = 0;
+
+static TRACE_THREAD SMtraceRing* thread_ring = 0;
+static TRACE_THREAD int thread_generation = 0;
+
+// the lock is only taken when a thread records its first event
+
+#ifdef _WIN32
+static volatile LONG trace_lock = 0;
+static void lock() { while (InterlockedExchange(&trace_lock, 1)) Sleep(0); }
+static void unlock() { InterlockedExchange(&trace_lock, 0); }
+#else
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static void lock() { pthread_mutex_lock(&trace_lock); }
+static void unlock() { pthread_mutex_unlock(&trace_lock); }
+#endif
+
+// time in microseconds
+
+#ifdef _WIN32
+static double trace_frequency = 0.0;
+static LARGE_INTEGER trace_start;
+
+static void init_time()
+{
+  LARGE_INTEGER frequency;
+  QueryPerformanceFrequency(&frequency);
+  trace_frequency = 1000000.0 / (double)frequency.QuadPart;
+  QueryPerformanceCounter(&trace_start);
+}
+
+static inline double get_time()
+{
+  LARGE_INTEGER now;
+  QueryPerformanceCounter(&now);
+  return trace_frequency*(double)(now.QuadPart - trace_start.QuadPart);
+}
+#else
+static struct timespec trace_start;
+
+static void init_time()
+{
+  clock_gettime(CLOCK_MONOTONIC, &trace_start);
+}
+
+static inline double get_time()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return 1000000.0*(now.tv_sec - trace_start.tv_sec) + 0.001*(now.tv_nsec - trace_start.tv_nsec);
+}
+#endif
+
+static SMtraceRing* get_ring()
+{
+  if (thread_ring && thread_generation == trace_generation)
+  {
+    return thread_ring;
+  }
+  SMtraceRing* ring = (SMtraceRing*)malloc(sizeof(SMtraceRing));
+  if (ring == 0)
+  {
+    return 0;
+  }
+  ring->events = (SMtraceEvent*)malloc(sizeof(SMtraceEvent)*trace_events_per_thread);
+  if (ring->events == 0)
+  {
+    free(ring);
+    return 0;
+  }
+  ring->events_alloc = trace_events_per_thread;
+  ring->events_number = 0;
+  lock();
+  ring->tid = trace_rings_number;
+  ring->next = trace_rings;
+  trace_rings = ring;
+  trace_rings_number++;
+  unlock();
+  thread_ring = ring;
+  thread_generation = trace_generation;
+  return ring;
+}
+
+static inline void record(const char* name, const char* cat, char ph)
+{
+  SMtraceRing* ring = get_ring();
+  if (ring == 0)
+  {
+    return;
+  }
+  SMtraceEvent* event = &(ring->events[ring->events_number % ring->events_alloc]);
+  event->name = name;
+  event->cat = cat;
+  event->ph = ph;
+  event->ts = get_time();
+  ring->events_number++;
+}
+
+void sm_trace_begin(const char* name, const char* cat)
+{
+  record(name, cat, 'B');
+}
+
+void sm_trace_end(const char* name, const char* cat)
+{
+  record(name, cat, 'E');
+}
+
+bool sm_trace_open(const char* file_name, int events_per_thread)
+{
+  if (file_name == 0)
+  {
+    fprintf(stderr,"ERROR: no file name for trace\n");
+    return false;
+  }
+  if (events_per_thread < 2)
+  {
+    fprintf(stderr,"ERROR: %d events per thread are too few for a trace\n", events_per_thread);
+    return false;
+  }
+  if (sm_trace_on)
+  {
+    sm_trace_close();
+  }
+  trace_file_name = strdup(file_name);
+  trace_events_per_thread = events_per_thread;
+  trace_generation++;
+  init_time();
+  sm_trace_on = true;
+  return true;
+}
+
+static void write_ring(FILE* file, SMtraceRing* ring, int* count)
+{
+  int i, first, depth;
+  SMtraceEvent* event;
+
+  // if the ring has wrapped around the oldest event is at the current position
+  first = (ring->events_number > ring->events_alloc ? ring->events_number - ring->events_alloc : 0);
+  depth = 0;
+
+  for (i = first; i < ring->events_number; i++)
+  {
+    event = &(ring->events[i % ring->events_alloc]);
+    if (event->ph == 'B')
+    {
+      depth++;
+    }
+    else if (depth)
+    {
+      depth--;
+    }
+    else
+    {
+      continue; // the matching begin was overwritten
+    }
+    fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%d}", ((*count) ? "," : ""), event->name, event->cat, event->ph, event->ts, ring->tid);
+    (*count)++;
+  }
+}
+
+bool sm_trace_close()
+{
+  SMtraceRing* ring;
+  int count = 0;
+
+  if (trace_file_name == 0)
+  {
+    return false;
+  }
+
+  sm_trace_on = false;
+
+  FILE* file = fopen(trace_file_name, "w");
+  if (file == 0)
+  {
+    fprintf(stderr,"ERROR: cannot open '%s' for writing the trace\n", trace_file_name);
+  }
+  else
+  {
+    fprintf(file, "{\"traceEvents\":[");
+    for (ring = trace_rings; ring; ring = ring->next)
+    {
+      write_ring(file, ring, &count);
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(file);
+  }
+
+  lock();
+  while (trace_rings)
+  {
+    ring = trace_rings;
+    trace_rings = ring->next;
+    free(ring->events);
+    free(ring);
+  }
+  trace_rings_number = 0;
+  unlock();
+
+  free(trace_file_name);
+  trace_file_name = 0;
+
+  return (file != 0);
+}
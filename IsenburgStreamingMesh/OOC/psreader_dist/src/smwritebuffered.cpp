@@ -30,11 +30,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smstats.h"
+#include "smtrace.h"
 
 #include <hash_map.h>
+#include "poolallocator.h"
 
 #include "dynamicqueue.h"
 
@@ -48,7 +52,7 @@ struct SMtriangle;
 typedef struct SMvertex
 {
   SMvertex* buffer_next; // used for efficient memory management
-  int index;
+  SMidx index;
   bool finalized;
   float v[3];
   // triangles
@@ -59,73 +63,185 @@ typedef struct SMvertex
 
 typedef struct SMtriangle
 {
-  SMtriangle* buffer_next; // used for efficient memory management (and by the waiting queue)
-  int dirty;               // to dirty triangle in the buffer (so they are only checked once)
+  union
+  {
+    SMtriangle* buffer_next; // used for efficient memory management
+    int dynamicqueue;        // used by the waiting queue
+  };
+  SMidx dirty;             // to dirty triangle in the buffer (so they are only checked once)
   SMvertex* vertices[5];
 } SMtriangle;
 
-typedef hash_map<int, SMvertex*> my_hash;
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
 
-static my_hash* vertex_hash; // for matching vertices
+typedef DynamicQueue<SMtriangle,&SMtriangle::dynamicqueue> my_triangle_queue;
 
-static DynamicQueue* waiting_queue; // for triangles ready for output
+// the state of the re-ordering is kept per writer so that a writer can be
+// opened on one thread and used on another and so that several threads can
+// re-order different meshes at the same time
 
-static SMvertex* cache[6]; // for simulating the cache (and avoid '(i+1)%3'-style computations)
+struct SMreorder
+{
+  my_hash* vertex_hash; // for matching vertices
+  my_triangle_queue* waiting_queue; // for triangles ready for output
 
-// statistics
+  SMvertex* cache[6]; // for simulating the cache (and avoid '(i+1)%3'-style computations)
 
-#ifdef PRINT_CONTROL_OUTPUT
-static int max_in_width = 0;
-static int max_in_span = 0;
-static int cur_out_width = 0;
-static int max_out_width = 0;
-static int max_out_span = 0;
-static int triangle_buffer_maxsize = 0;
-static int vertex_buffer_maxsize = 0;
-#endif
+  SMvertexCache* vertex_cache; // for simulating the cache of a GPU
+
+  // the scores of Forsyth's "Linear-Speed Vertex Cache Optimisation" for a
+  // vertex in cache position p and for a vertex with n triangles left
+
+  float cache_score[SM_CACHE_MAX_SIZE];
+  float valence_score[33];
+
+  // statistics
+
+  SMstats* stats;
 
-// efficient memory allocation for vertices
+  int stat_in_width;
+  int stat_in_span;
+  int stat_out_width;
+  int stat_out_span;
+  int stat_vertex_buffer;
+  int stat_triangle_buffer;
+  int stat_cache_misses;
 
-static int vertex_buffer_size = 0;
-static int vertex_buffer_alloc = 1024;
-static SMvertex* vertex_buffer_next = 0;
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
 
-static int initVertexBuffer(int size)
+  int vertex_buffer_size;
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int* vertex_blocks_size;
+  int vertex_blocks_number;
+
+  int triangle_buffer_size;
+  int triangle_buffer_alloc;
+  SMtriangle* triangle_buffer_next;
+  SMtriangle** triangle_blocks;
+  int triangle_blocks_number;
+
+  int initVertexBuffer(int size);
+  SMvertex* allocVertexBlock(int size);
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+  int initTriangleBuffer(int size);
+  SMtriangle* allocTriangleBlock(int size);
+  SMtriangle* allocTriangle();
+  void deallocTriangle(SMtriangle* triangle);
+
+  SMtriangle* find_triangle(SMidx dirty);
+  SMtriangle* find_triangle_cached(SMidx dirty, int cache_type);
+
+  SMreorder();
+  ~SMreorder();
+};
+
+SMreorder::SMreorder()
 {
-  vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  vertex_hash = 0;
+  waiting_queue = 0;
+  vertex_cache = 0;
+  stats = 0;
 
-  if (vertex_buffer_next == 0)
+  vertex_buffer_size = 0;
+  vertex_buffer_alloc = 1024;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_size = 0;
+  vertex_blocks_number = 0;
+
+  triangle_buffer_size = 0;
+  triangle_buffer_alloc = 1024;
+  triangle_buffer_next = 0;
+  triangle_blocks = 0;
+  triangle_blocks_number = 0;
+}
+
+SMreorder::~SMreorder()
+{
+  int i,j;
+  for (i = 0; i < vertex_blocks_number; i++)
+  {
+    for (j = 0; j < vertex_blocks_size[i]; j++)
+    {
+      if (vertex_blocks[i][j].incoming) free(vertex_blocks[i][j].incoming);
+    }
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  if (vertex_blocks_size) free(vertex_blocks_size);
+  for (i = 0; i < triangle_blocks_number; i++)
+  {
+    free(triangle_blocks[i]);
+  }
+  if (triangle_blocks) free(triangle_blocks);
+  if (vertex_hash) delete vertex_hash;
+  if (waiting_queue) delete waiting_queue;
+  if (vertex_cache) delete vertex_cache;
+  if (stats) delete stats;
+}
+
+// efficient memory allocation for vertices. every block is remembered so
+// that the destructor can give it back.
+
+SMvertex* SMreorder::allocVertexBlock(int size)
+{
+  SMvertex* block = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  if (block == 0)
   {
     fprintf(stderr,"malloc for vertex buffer failed\n");
     return 0;
   }
+  vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+  vertex_blocks_size = (int*)realloc(vertex_blocks_size, sizeof(int)*(vertex_blocks_number+1));
+  vertex_blocks[vertex_blocks_number] = block;
+  vertex_blocks_size[vertex_blocks_number] = size;
+  vertex_blocks_number++;
   for (int i = 0; i < size; i++)
   {
-    vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
-    vertex_buffer_next[i].incoming = 0;
+    block[i].buffer_next = &(block[i+1]);
+    block[i].incoming = 0;
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMreorder::initVertexBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (vertex_buffer_next)
+  {
+    vertex_buffer_size = 0;
+    return 1;
+  }
+
+  vertex_buffer_next = allocVertexBlock(size);
+
+  if (vertex_buffer_next == 0)
+  {
+    return 0;
   }
-  vertex_buffer_next[size-1].buffer_next = 0;
   vertex_buffer_alloc = size;
   vertex_buffer_size = 0;
   return 1;
 }
 
-static SMvertex* allocVertex()
+SMvertex* SMreorder::allocVertex()
 {
   if (vertex_buffer_next == 0)
   {
-    vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*vertex_buffer_alloc);
+    vertex_buffer_next = allocVertexBlock(vertex_buffer_alloc);
     if (vertex_buffer_next == 0)
     {
-      fprintf(stderr,"malloc for vertex buffer failed\n");
       return 0;
     }
-    for (int i = 0; i < vertex_buffer_alloc; i++)
-    {
-      vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
-      vertex_buffer_next[i].incoming = 0;
-    }
-    vertex_buffer_next[vertex_buffer_alloc-1].buffer_next = 0;
     vertex_buffer_alloc = 2*vertex_buffer_alloc;
   }
   // get pointer to next available vertex
@@ -143,81 +259,89 @@ static SMvertex* allocVertex()
 
   vertex_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_buffer_size > vertex_buffer_maxsize) vertex_buffer_maxsize = vertex_buffer_size;
-#endif
+  stats->level(stat_vertex_buffer, vertex_buffer_size);
 
   return vertex;
 }
 
-static void deallocVertex(SMvertex* vertex)
+void SMreorder::deallocVertex(SMvertex* vertex)
 {
   vertex->buffer_next = vertex_buffer_next;
   vertex_buffer_next = vertex;
   vertex_buffer_size--;
+  stats->down(stat_vertex_buffer);
 }
 
 // efficient memory allocation for triangles
 
-static int triangle_buffer_size = 0;
-static int triangle_buffer_alloc = 1024;
-static SMtriangle* triangle_buffer_next = 0;
-
-static int initTriangleBuffer(int alloc)
+SMtriangle* SMreorder::allocTriangleBlock(int size)
 {
-  triangle_buffer_next = (SMtriangle*)malloc(sizeof(SMtriangle)*alloc);
-
-  if (triangle_buffer_next == 0)
+  SMtriangle* block = (SMtriangle*)malloc(sizeof(SMtriangle)*size);
+  if (block == 0)
   {
     fprintf(stderr,"malloc for triangle buffer failed\n");
     return 0;
   }
-  for (int i = 0; i < alloc; i++)
+  triangle_blocks = (SMtriangle**)realloc(triangle_blocks, sizeof(SMtriangle*)*(triangle_blocks_number+1));
+  triangle_blocks[triangle_blocks_number] = block;
+  triangle_blocks_number++;
+  for (int i = 0; i < size; i++)
   {
-    triangle_buffer_next[i].buffer_next = &(triangle_buffer_next[i+1]);
+    block[i].buffer_next = &(block[i+1]);
   }
-  triangle_buffer_next[alloc-1].buffer_next = 0;
-  triangle_buffer_alloc = alloc;
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMreorder::initTriangleBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (triangle_buffer_next)
+  {
+    triangle_buffer_size = 0;
+    return 1;
+  }
+
+  triangle_buffer_next = allocTriangleBlock(size);
+
+  if (triangle_buffer_next == 0)
+  {
+    return 0;
+  }
+  triangle_buffer_alloc = size;
   triangle_buffer_size = 0;
   return 1;
 }
 
-static SMtriangle* allocTriangle()
+SMtriangle* SMreorder::allocTriangle()
 {
   if (triangle_buffer_next == 0)
   {
-    triangle_buffer_next = (SMtriangle*)malloc(sizeof(SMtriangle)*triangle_buffer_alloc);
+    triangle_buffer_next = allocTriangleBlock(triangle_buffer_alloc);
     if (triangle_buffer_next == 0)
     {
-      fprintf(stderr,"malloc for triangle buffer failed\n");
       return 0;
     }
-    for (int i = 0; i < triangle_buffer_alloc; i++)
-    {
-      triangle_buffer_next[i].buffer_next = &(triangle_buffer_next[i+1]);
-    }
-    triangle_buffer_next[triangle_buffer_alloc-1].buffer_next = 0;
     triangle_buffer_alloc = 2*triangle_buffer_alloc;
   }
-  // get pointer to next available vertex
+  // get pointer to next available triangle
   SMtriangle* triangle = triangle_buffer_next;
   triangle_buffer_next = triangle->buffer_next;
 
   triangle->dirty = -1;
   triangle_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (triangle_buffer_size > triangle_buffer_maxsize) triangle_buffer_maxsize = triangle_buffer_size;
-#endif
+  stats->level(stat_triangle_buffer, triangle_buffer_size);
 
   return triangle;
 }
 
-static void deallocTriangle(SMtriangle* triangle)
+void SMreorder::deallocTriangle(SMtriangle* triangle)
 {
   triangle->buffer_next = triangle_buffer_next;
   triangle_buffer_next = triangle;
   triangle_buffer_size--;
+  stats->down(stat_triangle_buffer);
 }
 
 static void addToVertex(SMtriangle* triangle, SMvertex* vertex)
@@ -265,13 +389,13 @@ void SMwriteBuffered::add_comment(const char* comment)
   fprintf(stderr,"WARNING: add_comments not yet implemented\n");
 }
 
-void SMwriteBuffered::set_nverts(int nverts)
+void SMwriteBuffered::set_nverts(SMidx nverts)
 {
   smwriter->set_nverts(nverts);
   this->nverts = smwriter->nverts;
 }
 
-void SMwriteBuffered::set_nfaces(int nfaces)
+void SMwriteBuffered::set_nfaces(SMidx nfaces)
 {
   smwriter->set_nfaces(nfaces);
   this->nfaces = smwriter->nfaces;
@@ -284,14 +408,27 @@ void SMwriteBuffered::set_boundingbox(const float* bb_min_f, const float* bb_max
   this->bb_max_f = smwriter->bb_max_f;
 }
 
-bool SMwriteBuffered::open(SMwriter* smwriter, int max_delay)
+bool SMwriteBuffered::open(SMwriter* smwriter, int max_delay, int cache_type, int cache_size)
 {
+  int i;
+
   if (smwriter == 0 )
   {
     return false;
   }
+  if (cache_type < SM_CACHE_LITTLE || cache_type > SM_CACHE_FORSYTH)
+  {
+    fprintf(stderr,"ERROR: unknown cache type %d\n", cache_type);
+    return false;
+  }
+  if (cache_size < 4 || cache_size > SM_CACHE_MAX_SIZE)
+  {
+    fprintf(stderr,"ERROR: cache size %d is not between 4 and %d\n", cache_size, SM_CACHE_MAX_SIZE);
+    return false;
+  }
   this->smwriter = smwriter;
   this->max_delay = max_delay;
+  this->cache_type = cache_type;
 
 #ifdef PRINT_CONTROL_OUTPUT
   fprintf(stderr,"maximal triangle delay is %d\n",max_delay);
@@ -306,32 +443,66 @@ bool SMwriteBuffered::open(SMwriter* smwriter, int max_delay)
   bb_min_f = smwriter->bb_min_f;
   bb_max_f = smwriter->bb_max_f;
 
-  vertex_hash = new my_hash;
+  reorder->vertex_hash = new my_hash;
 
-  waiting_queue = new DynamicQueue();
+  reorder->waiting_queue = new my_triangle_queue();
 
-  initVertexBuffer(1024);
-  initTriangleBuffer(2048);
+  if (reorder->stats == 0)
+  {
+    reorder->stats = new SMstats("SMwriteBuffered");
+    reorder->stat_in_width = reorder->stats->add("in_width", SM_STATS_LEVEL);
+    reorder->stat_in_span = reorder->stats->add("in_span", SM_STATS_LOG2);
+    reorder->stat_out_width = reorder->stats->add("out_width", SM_STATS_LEVEL);
+    reorder->stat_out_span = reorder->stats->add("out_span", SM_STATS_LOG2);
+    reorder->stat_vertex_buffer = reorder->stats->add("vertex_buffer", SM_STATS_LEVEL);
+    reorder->stat_triangle_buffer = reorder->stats->add("triangle_buffer", SM_STATS_LEVEL);
+    reorder->stat_cache_misses = reorder->stats->add("cache_misses", SM_STATS_COUNTER);
+  }
+  reorder->stats->reset();
+
+  // the little cache is measured against a FIFO of the same size
+  reorder->vertex_cache = new SMvertexCache();
+  reorder->vertex_cache->init(cache_type, cache_size);
 
-  cache[0] = 0;
-  cache[1] = 0;
-  cache[2] = 0;
-  cache[3] = 0;
-  cache[4] = 0;
-  cache[5] = 0;
+  for (i = 0; i < cache_size; i++)
+  {
+    if (i < 3)
+    {
+      reorder->cache_score[i] = 0.75f; // the last triangle. no extra bonus for using it again
+    }
+    else
+    {
+      reorder->cache_score[i] = (float)pow(1.0 - (double)(i - 3) / (cache_size - 3), 1.5);
+    }
+  }
+  reorder->valence_score[0] = 0.0f;
+  for (i = 1; i < 33; i++)
+  {
+    reorder->valence_score[i] = 2.0f * (float)pow((double)i, -0.5);
+  }
+
+  if (!reorder->initVertexBuffer(1024) || !reorder->initTriangleBuffer(2048))
+  {
+    return false;
+  }
+
+  for (i = 0; i < 6; i++)
+  {
+    reorder->cache[i] = 0;
+  }
 
   return true;
 }
 
 void SMwriteBuffered::close()
 {
-  while (waiting_queue->elements() != 0)
+  while (reorder->waiting_queue->elements() != 0)
   {
     write_triangle_delayed();
   }
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
 
   v_count = -1;
   f_count = -1;
@@ -339,22 +510,32 @@ void SMwriteBuffered::close()
   smwriter->close();
 
   #ifdef PRINT_CONTROL_OUTPUT
-  fprintf(stderr,"%d %d max_in_width %d max_out_width %d diff %6.3f\n",vertex_hash->size(),cur_out_width,max_in_width,max_out_width,100.0f*(max_out_width-max_in_width)/max_in_width);
-  fprintf(stderr,"max_in_span %d max_out_span %d diff  %6.3f \n",max_in_span,max_out_span,100.0f*(max_out_span-max_in_span)/max_in_span);
+  fprintf(stderr,"%d " SM_COUNT_FORMAT " max_in_width " SM_COUNT_FORMAT " max_out_width " SM_COUNT_FORMAT " diff %6.3f\n",reorder->vertex_hash->size(),reorder->stats->value(reorder->stat_out_width),reorder->stats->max(reorder->stat_in_width),reorder->stats->max(reorder->stat_out_width),100.0f*(reorder->stats->max(reorder->stat_out_width)-reorder->stats->max(reorder->stat_in_width))/reorder->stats->max(reorder->stat_in_width));
+  fprintf(stderr,"max_in_span " SM_COUNT_FORMAT " max_out_span " SM_COUNT_FORMAT " diff  %6.3f \n",reorder->stats->max(reorder->stat_in_span),reorder->stats->max(reorder->stat_out_span),100.0f*(reorder->stats->max(reorder->stat_out_span)-reorder->stats->max(reorder->stat_in_span))/reorder->stats->max(reorder->stat_in_span));
+  fprintf(stderr,"cache_misses " SM_COUNT_FORMAT " acmr %6.3f\n",reorder->stats->value(reorder->stat_cache_misses),(float)reorder->stats->value(reorder->stat_cache_misses)/f_count);
   #endif
 
-  delete vertex_hash;
-  delete waiting_queue;
+  delete reorder->vertex_hash;
+  reorder->vertex_hash = 0;
+  delete reorder->waiting_queue;
+  reorder->waiting_queue = 0;
+  delete reorder->vertex_cache;
+  reorder->vertex_cache = 0;
 }
 
-SMtriangle* find_triangle(int dirty)
+const SMstats* SMwriteBuffered::get_stats() const
+{
+  return reorder->stats;
+}
+
+SMtriangle* SMreorder::find_triangle(SMidx dirty)
 {
   int i,j,k;
   SMtriangle* triangle;
   SMvertex** verts;
-  int ccx_age = 2000000000;
+  SMidx ccx_age = SM_IDX_MAX;
   SMtriangle* ccx = 0; // triangle with two cache vertices
-  int cax_age = -1;
+  SMidx cax_age = -1;
   SMtriangle* caf = 0; // triangle with one cache vertex and two active vertices of which one will be finalized
   SMtriangle* cax = 0; // triangle with one cache vertex and one active vertex
   SMtriangle* caa = 0; // triangle with one cache vertex and two active vertices
@@ -478,19 +659,94 @@ SMtriangle* find_triangle(int dirty)
   else return 0;
 }
 
+// picks among the triangles around the vertices in the simulated cache of
+// a GPU. for a FIFO or an LRU cache more hits always win, then finalizing a
+// vertex, and then using older entries before they fall out of the cache.
+
+SMtriangle* SMreorder::find_triangle_cached(SMidx dirty, int cache_type)
+{
+  int i,j,k,p;
+  SMtriangle* triangle;
+  SMvertex* vertex;
+  SMvertex** verts;
+  int size = vertex_cache->size;
+  int score, best_score = -1;
+  float forsyth, best_forsyth = -1.0f;
+  SMtriangle* best = 0;
+
+  for (i = 0; i < vertex_cache->elements(); i++)
+  {
+    vertex = (SMvertex*)vertex_cache->get(i);
+    if (vertex == 0) // this vertex was finalized
+    {
+      continue;
+    }
+    for (j = 0; j < vertex->incoming_size; j++)
+    {
+      triangle = vertex->incoming[j];
+      if (triangle->dirty == dirty) // already checked
+      {
+        continue;
+      }
+      triangle->dirty = dirty; // mark as checked
+      verts = triangle->vertices;
+      if (cache_type == SM_CACHE_FORSYTH)
+      {
+        forsyth = 0.0f;
+        for (k = 0; k < 3; k++)
+        {
+          p = (verts[k]->index == -1 ? -1 : vertex_cache->pos(verts[k]->index));
+          if (p != -1) forsyth += cache_score[p];
+          forsyth += valence_score[verts[k]->incoming_size < 32 ? verts[k]->incoming_size : 32];
+        }
+        if (forsyth > best_forsyth)
+        {
+          best_forsyth = forsyth;
+          best = triangle;
+        }
+      }
+      else
+      {
+        score = 0;
+        for (k = 0; k < 3; k++)
+        {
+          p = (verts[k]->index == -1 ? -1 : vertex_cache->pos(verts[k]->index));
+          if (p != -1) score += 8*size + p;
+          if (verts[k]->finalized && verts[k]->incoming_size == 1) score += 4*size;
+        }
+        if (score > best_score)
+        {
+          best_score = score;
+          best = triangle;
+        }
+      }
+    }
+  }
+  return best;
+}
+
 void SMwriteBuffered::write_triangle_delayed()
 {
-  int t_idx[3];
+  SMidx t_idx[3];
   bool t_final[3];
-  SMtriangle* triangle = find_triangle(smwriter->f_count);
+  SMtriangle* triangle;
+
+  if (cache_type == SM_CACHE_LITTLE)
+  {
+    triangle = reorder->find_triangle(smwriter->f_count);
+  }
+  else
+  {
+    triangle = reorder->find_triangle_cached(smwriter->f_count, cache_type);
+  }
 
   if (triangle)
   {
-    waiting_queue->removeElement(triangle);
+    reorder->waiting_queue->removeElement(triangle);
   }
   else
   {
-    triangle = (SMtriangle*)waiting_queue->getAndRemoveFirstElement();
+    triangle = reorder->waiting_queue->getAndRemoveFirstElement();
   }
 
   removeFromVertices(triangle);
@@ -503,64 +759,62 @@ void SMwriteBuffered::write_triangle_delayed()
     {
       vertices[i]->index = smwriter->v_count;
       smwriter->write_vertex(vertices[i]->v);
-#ifdef PRINT_CONTROL_OUTPUT
-      cur_out_width++;
-      if (cur_out_width > max_out_width) max_out_width = cur_out_width;
-#endif
+      reorder->stats->up(reorder->stat_out_width);
     }
     t_idx[i] = vertices[i]->index;
+    if (!reorder->vertex_cache->access(t_idx[i], vertices[i]))
+    {
+      reorder->stats->count(reorder->stat_cache_misses);
+    }
     if (vertices[i]->finalized && vertices[i]->incoming_size == 0)
     {
       t_final[i] = true;
-      deallocVertex(vertices[i]);
-      cache[i] = 0;
-      cache[i+3] = 0;
-#ifdef PRINT_CONTROL_OUTPUT
-      cur_out_width--;
-      if ((smwriter->v_count-t_idx[i]+1) > max_out_span) max_out_span = (smwriter->v_count-t_idx[i]+1);
-#endif
+      reorder->vertex_cache->forget(t_idx[i]);
+      reorder->deallocVertex(vertices[i]);
+      reorder->cache[i] = 0;
+      reorder->cache[i+3] = 0;
+      reorder->stats->down(reorder->stat_out_width);
+      reorder->stats->sample(reorder->stat_out_span, (int)(smwriter->v_count-t_idx[i]+1));
     }
     else
     {
       t_final[i] = false;
-      cache[i] = vertices[i];
-      cache[i+3] = vertices[i];;
+      reorder->cache[i] = vertices[i];
+      reorder->cache[i+3] = vertices[i];;
     }
   }
-  deallocTriangle(triangle);
+  reorder->deallocTriangle(triangle);
 
   smwriter->write_triangle(t_idx, t_final);
 }
 
 void SMwriteBuffered::write_vertex(const float* v_pos_f)
 {
-  SMvertex* vertex = allocVertex();
+  SMvertex* vertex = reorder->allocVertex();
   VecCopy3fv(vertex->v, v_pos_f);
-  vertex_hash->insert(my_hash::value_type(v_count, vertex));
+  sm_trace_hash_insert(reorder->vertex_hash, my_hash::value_type(v_count, vertex), "SMwriteBuffered::vertex_hash");
   v_count++;
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_hash->size() > max_in_width) max_in_width = vertex_hash->size();
-#endif
+  reorder->stats->level(reorder->stat_in_width, reorder->vertex_hash->size());
 }
 
-void SMwriteBuffered::write_triangle(const int* t_idx)
+void SMwriteBuffered::write_triangle(const SMidx* t_idx)
 {
   fprintf(stderr,"FATAL ERROR: need immediate finalization (e.g. a tail-compact pre-order mesh)\n");
   exit(0);
 }
 
-void SMwriteBuffered::write_triangle(const int* t_idx, const bool* t_final)
+void SMwriteBuffered::write_triangle(const SMidx* t_idx, const bool* t_final)
 {
   int i;
   my_hash::iterator hash_elements[3];
 
-  SMtriangle* triangle = allocTriangle();
+  SMtriangle* triangle = reorder->allocTriangle();
 
   // get vertices from hash
   for (i = 0; i < 3; i++)
   {
-    hash_elements[i] = vertex_hash->find(t_idx[i]);
-    if (hash_elements[i] == vertex_hash->end())
+    hash_elements[i] = reorder->vertex_hash->find(t_idx[i]);
+    if (hash_elements[i] == reorder->vertex_hash->end())
     {
       fprintf(stderr,"FATAL ERROR: vertex not in hash. need pre-order mesh\n");
       exit(0);
@@ -582,18 +836,16 @@ void SMwriteBuffered::write_triangle(const int* t_idx, const bool* t_final)
     if (t_final[i])
     {
       triangle->vertices[i]->finalized = true;
-      vertex_hash->erase(hash_elements[i]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if ((v_count - t_idx[i] + 1) > max_in_span) max_in_span = (v_count - t_idx[i] + 1);
-#endif
+      reorder->vertex_hash->erase(hash_elements[i]);
+      reorder->stats->sample(reorder->stat_in_span, (int)(v_count - t_idx[i] + 1));
     }
   }
 
   // add triangle to buffer
-  waiting_queue->addElement(triangle);
+  reorder->waiting_queue->addElement(triangle);
 
   // compress a triangle if the buffer is full
-  while (waiting_queue->size() == max_delay)
+  while (reorder->waiting_queue->size() == max_delay)
   {
     write_triangle_delayed();
   }
@@ -601,7 +853,7 @@ void SMwriteBuffered::write_triangle(const int* t_idx, const bool* t_final)
   f_count++;
 }
 
-void SMwriteBuffered::write_finalized(int final_idx)
+void SMwriteBuffered::write_finalized(SMidx final_idx)
 {
   fprintf(stderr,"FATAL ERROR: need immediate finalization (e.g. a tail-compact pre-order mesh)\n");
   exit(0);
@@ -622,8 +874,11 @@ SMwriteBuffered::SMwriteBuffered()
   // init of SMwriteBuffered
   smwriter = 0;
   max_delay = -1;
+  cache_type = SM_CACHE_LITTLE;
+  reorder = new SMreorder();
 }
 
 SMwriteBuffered::~SMwriteBuffered()
 {
+  delete reorder;
 }
@@ -0,0 +1,147 @@
+/*
+===============================================================================
+
+  FILE:  SMwriteIndexed.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smwriteindexed.h"
+
+#include <stdlib.h>
+
+void SMwriteIndexed::add_comment(const char* comment)
+{
+  smwriter_smb->add_comment(comment);
+}
+
+void SMwriteIndexed::set_nverts(SMidx nverts)
+{
+  smwriter_smb->set_nverts(nverts);
+  this->nverts = smwriter_smb->nverts;
+}
+
+void SMwriteIndexed::set_nfaces(SMidx nfaces)
+{
+  smwriter_smb->set_nfaces(nfaces);
+  this->nfaces = smwriter_smb->nfaces;
+}
+
+void SMwriteIndexed::set_boundingbox(const float* bb_min_f, const float* bb_max_f)
+{
+  smwriter_smb->set_boundingbox(bb_min_f, bb_max_f);
+  this->bb_min_f = smwriter_smb->bb_min_f;
+  this->bb_max_f = smwriter_smb->bb_max_f;
+}
+
+bool SMwriteIndexed::open(SMwriter_smb* smwriter_smb, FILE* file_smb, FILE* file_smi, int chunk_size)
+{
+  if (smwriter_smb == 0 || file_smb == 0)
+  {
+    return false;
+  }
+  smindex = new SMindex();
+  if (!smindex->open_write(file_smi, chunk_size))
+  {
+    delete smindex;
+    smindex = 0;
+    return false;
+  }
+  this->smwriter_smb = smwriter_smb;
+  this->file_smb = file_smb;
+
+  nverts = smwriter_smb->nverts;
+  nfaces = smwriter_smb->nfaces;
+
+  v_count = 0;
+  f_count = 0;
+
+  bb_min_f = smwriter_smb->bb_min_f;
+  bb_max_f = smwriter_smb->bb_max_f;
+
+  return true;
+}
+
+void SMwriteIndexed::close()
+{
+  smwriter_smb->close();
+  smindex->close_write();
+  delete smindex;
+  smindex = 0;
+
+  v_count = -1;
+  f_count = -1;
+}
+
+// the first element of a chunk is still in the buffer of the SMB writer
+// right after it was written. so the file is at the start of its block.
+
+void SMwriteIndexed::write_vertex(const float* v_pos_f)
+{
+  smwriter_smb->write_vertex(v_pos_f);
+  if (smindex->chunk_full()) smindex->set_offset(sm_ftell(file_smb));
+  smindex->add_vertex(v_pos_f);
+  v_count++;
+}
+
+void SMwriteIndexed::write_triangle(const SMidx* t_idx, const bool* t_final)
+{
+  smwriter_smb->write_triangle(t_idx, t_final);
+  if (smindex->chunk_full()) smindex->set_offset(sm_ftell(file_smb));
+  smindex->add_triangle(t_idx, t_final);
+  f_count++;
+}
+
+void SMwriteIndexed::write_triangle(const SMidx* t_idx)
+{
+  fprintf(stderr, "ERROR: write_triangle(const SMidx* t_idx) not supported by SMwriteIndexed\n");
+  exit(0);
+}
+
+void SMwriteIndexed::write_finalized(SMidx final_idx)
+{
+  fprintf(stderr, "ERROR: write_finalized(SMidx final_idx) not supported by SMwriteIndexed\n");
+  exit(0);
+}
+
+SMwriteIndexed::SMwriteIndexed()
+{
+  // init of SMwriter interface
+  nfaces = -1;
+  nverts = -1;
+
+  f_count = -1;
+  v_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  // init of SMwriteIndexed
+  smwriter_smb = 0;
+  file_smb = 0;
+  smindex = 0;
+}
+
+SMwriteIndexed::~SMwriteIndexed()
+{
+  if (smindex) delete smindex;
+}
@@ -0,0 +1,614 @@
+/*
+===============================================================================
+
+  FILE:  SMwriteLOD.cpp
+
+  CONTENTS:
+
+    see corresponding header file
+
+  PROGRAMMERS:
+
+    agent@local
+
+  COPYRIGHT:
+
+    copyright (C) 2026  agent@local
+
+    This software is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+  CHANGE HISTORY:
+
+    see corresponding header file
+
+===============================================================================
+*/
+#include "smwritelod.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "vec3fv.h"
+#include "smreader.h"
+#include "smreadclustered.h"
+#include "smstats.h"
+#include "smthread.h"
+
+#define SM_LOD_BLOCK_SIZE 4096
+#define SM_LOD_BLOCKS 4
+
+// the events are passed between the threads in blocks
+
+typedef struct SMlodEvent
+{
+  int event;
+  union
+  {
+    float v[3];
+    SMidx idx[3];
+    SMidx final_idx;
+  };
+  bool final[3];
+} SMlodEvent;
+
+typedef struct SMlodBlock
+{
+  int number;
+  bool eof;
+  SMlodEvent events[SM_LOD_BLOCK_SIZE];
+} SMlodBlock;
+
+// a bounded queue with one producer and one consumer. the producer fills
+// the blocks in turn and hands each full block to the consumer, who gives
+// it back once it has read all of its events. the header is set before
+// the first block is handed over.
+
+typedef struct SMlodQueue
+{
+  SMlodBlock blocks[SM_LOD_BLOCKS];
+  SMsemaphore full;
+  SMsemaphore empty;
+  int put_block;
+  SMlodBlock* put;
+  int waits;
+  SMidx nverts;
+  SMidx nfaces;
+  bool have_bb;
+  float bb_min[3];
+  float bb_max[3];
+} SMlodQueue;
+
+struct SMlodLevel
+{
+  SMwriter* smwriter;
+  int resolution;
+  int ncomments;
+  char** comments;
+  SMlodQueue* input;
+  SMlodQueue* output;
+  bool ok;
+  SMidx v_count;
+  SMidx f_count;
+  SMthread thread;
+};
+
+static const char* name_vertices[SM_LOD_MAX_LEVELS] = {"level0_vertices", "level1_vertices", "level2_vertices", "level3_vertices", "level4_vertices", "level5_vertices", "level6_vertices", "level7_vertices"};
+static const char* name_triangles[SM_LOD_MAX_LEVELS] = {"level0_triangles", "level1_triangles", "level2_triangles", "level3_triangles", "level4_triangles", "level5_triangles", "level6_triangles", "level7_triangles"};
+static const char* name_waits[SM_LOD_MAX_LEVELS] = {"level0_waits", "level1_waits", "level2_waits", "level3_waits", "level4_waits", "level5_waits", "level6_waits", "level7_waits"};
+
+static SMlodQueue* allocQueue()
+{
+  SMlodQueue* queue = (SMlodQueue*)malloc(sizeof(SMlodQueue));
+  initSemaphore(&(queue->full), 0, SM_LOD_BLOCKS);
+  initSemaphore(&(queue->empty), SM_LOD_BLOCKS, SM_LOD_BLOCKS);
+  queue->put_block = 0;
+  queue->put = 0;
+  queue->waits = 0;
+  queue->nverts = -1;
+  queue->nfaces = -1;
+  queue->have_bb = false;
+  return queue;
+}
+
+static void deallocQueue(SMlodQueue* queue)
+{
+  destroySemaphore(&(queue->full));
+  destroySemaphore(&(queue->empty));
+  free(queue);
+}
+
+static void handOver(SMlodQueue* queue)
+{
+  postSemaphore(&(queue->full));
+  queue->put = 0;
+  queue->put_block = (queue->put_block + 1) % SM_LOD_BLOCKS;
+}
+
+// a full block is only handed over when the next event is put because
+// the caller fills in the event after it was put
+
+static void nextBlock(SMlodQueue* queue)
+{
+  if (queue->put && queue->put->number == SM_LOD_BLOCK_SIZE)
+  {
+    handOver(queue);
+  }
+  if (queue->put == 0)
+  {
+    if (waitSemaphore(&(queue->empty))) queue->waits++;
+    queue->put = &(queue->blocks[queue->put_block]);
+    queue->put->number = 0;
+    queue->put->eof = false;
+  }
+}
+
+static SMlodEvent* putEvent(SMlodQueue* queue, int event)
+{
+  nextBlock(queue);
+  SMlodEvent* lod_event = &(queue->put->events[queue->put->number++]);
+  lod_event->event = event;
+  return lod_event;
+}
+
+static void putEOF(SMlodQueue* queue)
+{
+  nextBlock(queue);
+  queue->put->eof = true;
+  handOver(queue);
+}
+
+// the consumer side of a queue is an smreader so that the clustering of a
+// level can read from it
+
+class SMreadLODqueue : public SMreader
+{
+public:
+  void close();
+
+  SMevent read_element();
+  SMevent read_event();
+
+  bool open(SMlodQueue* queue);
+
+  SMreadLODqueue();
+  ~SMreadLODqueue();
+
+private:
+  SMlodQueue* queue;
+  int get_block;
+  SMlodBlock* get;
+  int next;
+};
+
+bool SMreadLODqueue::open(SMlodQueue* queue)
+{
+  this->queue = queue;
+  get_block = 0;
+  next = 0;
+
+  // the header is known once the first block was handed over
+
+  waitSemaphore(&(queue->full));
+  get = &(queue->blocks[0]);
+
+  nverts = queue->nverts;
+  nfaces = queue->nfaces;
+  if (queue->have_bb)
+  {
+    bb_min_f = queue->bb_min;
+    bb_max_f = queue->bb_max;
+  }
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+SMevent SMreadLODqueue::read_event()
+{
+  while (next == get->number)
+  {
+    if (get->eof)
+    {
+      return SM_EOF;
+    }
+    postSemaphore(&(queue->empty));
+    get_block = (get_block + 1) % SM_LOD_BLOCKS;
+    waitSemaphore(&(queue->full));
+    get = &(queue->blocks[get_block]);
+    next = 0;
+  }
+
+  SMlodEvent* lod_event = &(get->events[next++]);
+  switch (lod_event->event)
+  {
+  case SM_VERTEX:
+    VecCopy3fv(v_pos_f, lod_event->v);
+    v_idx = v_count;
+    v_count++;
+    return SM_VERTEX;
+  case SM_TRIANGLE:
+    t_idx[0] = lod_event->idx[0];
+    t_idx[1] = lod_event->idx[1];
+    t_idx[2] = lod_event->idx[2];
+    t_final[0] = lod_event->final[0];
+    t_final[1] = lod_event->final[1];
+    t_final[2] = lod_event->final[2];
+    f_count++;
+    return SM_TRIANGLE;
+  default:
+    final_idx = lod_event->final_idx;
+    return SM_FINALIZED;
+  }
+}
+
+SMevent SMreadLODqueue::read_element()
+{
+  SMevent event;
+  while ((event = read_event()) == SM_FINALIZED);
+  return event;
+}
+
+// reads what is left so that the producer never waits forever
+
+void SMreadLODqueue::close()
+{
+  if (queue)
+  {
+    while (read_event() > SM_EOF);
+    postSemaphore(&(queue->empty));
+    queue = 0;
+  }
+  bb_min_f = 0;
+  bb_max_f = 0;
+}
+
+SMreadLODqueue::SMreadLODqueue()
+{
+  nverts = -1;
+  nfaces = -1;
+  v_count = -1;
+  f_count = -1;
+  bb_min_f = 0;
+  bb_max_f = 0;
+  post_order = false;
+  queue = 0;
+}
+
+SMreadLODqueue::~SMreadLODqueue()
+{
+  if (queue) close();
+}
+
+// the worker of a level clusters its input, writes the result, and passes
+// it on to the next level
+
+static SM_THREAD_RESULT run_level(void* arg)
+{
+  SMlodLevel* level = (SMlodLevel*)arg;
+  SMreadLODqueue smreadlodqueue;
+  SMreadClustered smreadclustered;
+  SMwriter* smwriter = level->smwriter;
+  SMlodEvent* lod_event;
+  SMevent event;
+  int i;
+
+  for (i = 0; i < level->ncomments; i++)
+  {
+    smwriter->add_comment(level->comments[i]);
+  }
+
+  smreadlodqueue.open(level->input);
+  level->ok = smreadclustered.open(&smreadlodqueue, level->resolution);
+
+  if (level->ok)
+  {
+    smwriter->set_boundingbox(smreadclustered.bb_min_f, smreadclustered.bb_max_f);
+    if (level->output)
+    {
+      VecCopy3fv(level->output->bb_min, smreadclustered.bb_min_f);
+      VecCopy3fv(level->output->bb_max, smreadclustered.bb_max_f);
+      level->output->have_bb = true;
+    }
+    while ((event = smreadclustered.read_element()) > SM_EOF)
+    {
+      if (event == SM_VERTEX)
+      {
+        smwriter->write_vertex(smreadclustered.v_pos_f);
+        if (level->output)
+        {
+          lod_event = putEvent(level->output, SM_VERTEX);
+          VecCopy3fv(lod_event->v, smreadclustered.v_pos_f);
+        }
+      }
+      else
+      {
+        smwriter->write_triangle(smreadclustered.t_idx, smreadclustered.t_final);
+        if (level->output)
+        {
+          lod_event = putEvent(level->output, SM_TRIANGLE);
+          lod_event->idx[0] = smreadclustered.t_idx[0];
+          lod_event->idx[1] = smreadclustered.t_idx[1];
+          lod_event->idx[2] = smreadclustered.t_idx[2];
+          lod_event->final[0] = smreadclustered.t_final[0];
+          lod_event->final[1] = smreadclustered.t_final[1];
+          lod_event->final[2] = smreadclustered.t_final[2];
+        }
+      }
+    }
+    level->ok = (event == SM_EOF);
+    level->v_count = smreadclustered.v_count;
+    level->f_count = smreadclustered.f_count;
+    smreadclustered.close();
+  }
+  else
+  {
+    fprintf(stderr,"ERROR: cannot cluster level with resolution %d\n", level->resolution);
+  }
+
+  smwriter->close();
+  smreadlodqueue.close();
+  if (level->output) putEOF(level->output);
+  return 0;
+}
+
+// the comments are passed on to the smwriters of the levels when their
+// workers start
+
+void SMwriteLOD::add_comment(const char* comment)
+{
+  if (comments == 0)
+  {
+    comments = (char**)malloc(sizeof(char*)*10);
+    comments[9] = (char*)-1;
+  }
+  else if (comments[ncomments] == (char*)-1)
+  {
+    comments = (char**)realloc(comments,sizeof(char*)*ncomments*2);
+    comments[ncomments*2-1] = (char*)-1;
+  }
+  comments[ncomments] = strdup(comment);
+  ncomments++;
+}
+
+void SMwriteLOD::set_nverts(SMidx nverts)
+{
+  this->nverts = nverts;
+  if (levels) lod_levels[0].input->nverts = nverts;
+}
+
+void SMwriteLOD::set_nfaces(SMidx nfaces)
+{
+  this->nfaces = nfaces;
+  if (levels) lod_levels[0].input->nfaces = nfaces;
+}
+
+void SMwriteLOD::set_boundingbox(const float* bb_min_f, const float* bb_max_f)
+{
+  if (this->bb_min_f == 0) this->bb_min_f = new float[3];
+  if (this->bb_max_f == 0) this->bb_max_f = new float[3];
+  VecCopy3fv(this->bb_min_f, bb_min_f);
+  VecCopy3fv(this->bb_max_f, bb_max_f);
+  if (levels)
+  {
+    VecCopy3fv(lod_levels[0].input->bb_min, bb_min_f);
+    VecCopy3fv(lod_levels[0].input->bb_max, bb_max_f);
+    lod_levels[0].input->have_bb = true;
+  }
+}
+
+// the workers are started with the first event because the clustering
+// needs the bounding box
+
+bool SMwriteLOD::start()
+{
+  int l;
+
+  started = true;
+
+  if (bb_min_f == 0 || bb_max_f == 0)
+  {
+    fprintf(stderr,"ERROR: SMwriteLOD needs the bounding box before the first vertex\n");
+    failed = true;
+    return false;
+  }
+
+  for (l = 0; l < levels; l++)
+  {
+    lod_levels[l].ncomments = ncomments;
+    lod_levels[l].comments = comments;
+    if (!startThread(&(lod_levels[l].thread), run_level, &(lod_levels[l])))
+    {
+      fprintf(stderr,"ERROR: cannot start the thread for level %d\n", l);
+      // the levels that run do not see their output before the first block
+      if (l) lod_levels[l-1].output = 0;
+      failed = true;
+      return false;
+    }
+    threads++;
+  }
+  return true;
+}
+
+void SMwriteLOD::write_vertex(const float* v_pos_f)
+{
+  if (!started) start();
+  if (failed) return;
+  SMlodEvent* lod_event = putEvent(lod_levels[0].input, SM_VERTEX);
+  VecCopy3fv(lod_event->v, v_pos_f);
+  v_count++;
+}
+
+void SMwriteLOD::write_triangle(const SMidx* t_idx, const bool* t_final)
+{
+  if (!started) start();
+  if (failed) return;
+  SMlodEvent* lod_event = putEvent(lod_levels[0].input, SM_TRIANGLE);
+  lod_event->idx[0] = t_idx[0];
+  lod_event->idx[1] = t_idx[1];
+  lod_event->idx[2] = t_idx[2];
+  lod_event->final[0] = t_final[0];
+  lod_event->final[1] = t_final[1];
+  lod_event->final[2] = t_final[2];
+  f_count++;
+}
+
+// without finalization the clustering can only retire cells at the end
+
+void SMwriteLOD::write_triangle(const SMidx* t_idx)
+{
+  bool t_final[3] = {false, false, false};
+  write_triangle(t_idx, t_final);
+}
+
+void SMwriteLOD::write_finalized(SMidx final_idx)
+{
+  if (!started) start();
+  if (failed) return;
+  SMlodEvent* lod_event = putEvent(lod_levels[0].input, SM_FINALIZED);
+  lod_event->final_idx = final_idx;
+}
+
+void SMwriteLOD::close()
+{
+  int l;
+
+  if (!started) start();
+
+  if (threads)
+  {
+    putEOF(lod_levels[0].input);
+    for (l = 0; l < threads; l++)
+    {
+      joinThread(&(lod_levels[l].thread));
+    }
+  }
+
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
+
+  stats->count(stat_input_waits, lod_levels[0].input->waits);
+  for (l = 0; l < levels; l++)
+  {
+    stats->count(stat_vertices[l], (int)lod_levels[l].v_count);
+    stats->count(stat_triangles[l], (int)lod_levels[l].f_count);
+    if (lod_levels[l].output) stats->count(stat_waits[l], lod_levels[l].output->waits);
+    if (!lod_levels[l].ok) fprintf(stderr,"WARNING: level %d is incomplete\n", l);
+    deallocQueue(lod_levels[l].input);
+  }
+
+  free(lod_levels);
+  lod_levels = 0;
+  levels = 0;
+  threads = 0;
+
+  v_count = -1;
+  f_count = -1;
+}
+
+const SMstats* SMwriteLOD::get_stats() const
+{
+  return stats;
+}
+
+bool SMwriteLOD::open(int levels, SMwriter** smwriters, int resolution)
+{
+  int l;
+
+  if (smwriters == 0)
+  {
+    return false;
+  }
+  if (levels < 1 || levels > SM_LOD_MAX_LEVELS)
+  {
+    fprintf(stderr,"ERROR: the number of levels %d is not between 1 and %d\n", levels, SM_LOD_MAX_LEVELS);
+    return false;
+  }
+  if (resolution < 2 || resolution > SM_CLUSTERED_MAX_RESOLUTION)
+  {
+    fprintf(stderr,"ERROR: the resolution %d is not between 2 and %d\n", resolution, SM_CLUSTERED_MAX_RESOLUTION);
+    return false;
+  }
+
+  for (l = 0; l < levels; l++)
+  {
+    if (smwriters[l] == 0)
+    {
+      fprintf(stderr,"ERROR: there is no smwriter for level %d\n", l);
+      return false;
+    }
+  }
+
+  if (stats) delete stats;
+  stats = new SMstats("SMwriteLOD");
+  stat_input_waits = stats->add("input_waits", SM_STATS_COUNTER);
+  for (l = 0; l < levels; l++)
+  {
+    stat_vertices[l] = stats->add(name_vertices[l], SM_STATS_COUNTER);
+    stat_triangles[l] = stats->add(name_triangles[l], SM_STATS_COUNTER);
+    stat_waits[l] = stats->add(name_waits[l], SM_STATS_COUNTER);
+  }
+  stats->reset();
+
+  this->levels = levels;
+  this->resolution = resolution;
+
+  lod_levels = (SMlodLevel*)malloc(sizeof(SMlodLevel)*SM_LOD_MAX_LEVELS);
+  memset(lod_levels, 0, sizeof(SMlodLevel)*SM_LOD_MAX_LEVELS);
+  for (l = 0; l < levels; l++)
+  {
+    lod_levels[l].smwriter = smwriters[l];
+    lod_levels[l].resolution = (resolution >> l > 1 ? resolution >> l : 1);
+    lod_levels[l].input = allocQueue();
+    if (l) lod_levels[l-1].output = lod_levels[l].input;
+  }
+
+  threads = 0;
+  started = false;
+  failed = false;
+
+  v_count = 0;
+  f_count = 0;
+
+  return true;
+}
+
+SMwriteLOD::SMwriteLOD()
+{
+  // init of SMwriter interface
+  ncomments = 0;
+  comments = 0;
+
+  nverts = -1;
+  nfaces = -1;
+
+  v_count = -1;
+  f_count = -1;
+
+  bb_min_f = 0;
+  bb_max_f = 0;
+
+  // init of SMwriteLOD
+  levels = 0;
+  resolution = 0;
+  lod_levels = 0;
+  threads = 0;
+  started = false;
+  failed = false;
+  stats = 0;
+}
+
+SMwriteLOD::~SMwriteLOD()
+{
+  int i;
+  for (i = 0; i < ncomments; i++)
+  {
+    free(comments[i]);
+  }
+  if (comments) free(comments);
+  if (bb_min_f) delete [] bb_min_f;
+  if (bb_max_f) delete [] bb_max_f;
+  if (stats) delete stats;
+}
@@ -51,17 +51,17 @@ void SMwriter_off::add_comment(const char* comment)
   ncomments++;
 }
 
-void SMwriter_off::set_nverts(int nverts)
+void SMwriter_off::set_nverts(SMidx nverts)
 {
   this->nverts = nverts;
   vertex_buffer = (float*)realloc(vertex_buffer, sizeof(float)*3*nverts);
   vertex_buffer_alloc = nverts;
 }
 
-void SMwriter_off::set_nfaces(int nfaces)
+void SMwriter_off::set_nfaces(SMidx nfaces)
 {
   this->nfaces = nfaces;
-  triangle_buffer = (int*)realloc(triangle_buffer, sizeof(int)*3*nfaces);
+  triangle_buffer = (SMidx*)realloc(triangle_buffer, sizeof(SMidx)*3*nfaces);
   triangle_buffer_alloc = nfaces;
 }
 
@@ -86,7 +86,7 @@ bool SMwriter_off::open(FILE* file)
   vertex_buffer_alloc = 1024;
   vertex_buffer = (float*)malloc(sizeof(float)*3*vertex_buffer_alloc);
   triangle_buffer_alloc = 2048;
-  triangle_buffer = (int*)malloc(sizeof(int)*3*triangle_buffer_alloc);
+  triangle_buffer = (SMidx*)malloc(sizeof(SMidx)*3*triangle_buffer_alloc);
   return (vertex_buffer != 0) && (triangle_buffer != 0);
 }
 
@@ -102,41 +102,45 @@ void SMwriter_off::write_vertex(const float* v_pos_f)
   v_count++;
 }
 
-void SMwriter_off::write_triangle(const int* t_idx)
+void SMwriter_off::write_triangle(const SMidx* t_idx)
 {
   if (f_count == triangle_buffer_alloc)
   {
-    triangle_buffer = (int*)realloc(triangle_buffer, sizeof(float)*3*triangle_buffer_alloc*2);
+    triangle_buffer = (SMidx*)realloc(triangle_buffer, sizeof(SMidx)*3*triangle_buffer_alloc*2);
     triangle_buffer_alloc = triangle_buffer_alloc * 2;
   }
-  VecCopy3iv(&(triangle_buffer[f_count*3]),t_idx);
+  triangle_buffer[f_count*3+0] = t_idx[0];
+  triangle_buffer[f_count*3+1] = t_idx[1];
+  triangle_buffer[f_count*3+2] = t_idx[2];
 
   f_count++;
 }
 
-void SMwriter_off::write_triangle(const int* t_idx, const bool* t_final)
+void SMwriter_off::write_triangle(const SMidx* t_idx, const bool* t_final)
 {
   if (f_count == triangle_buffer_alloc)
   {
-    triangle_buffer = (int*)realloc(triangle_buffer, sizeof(float)*3*triangle_buffer_alloc*2);
+    triangle_buffer = (SMidx*)realloc(triangle_buffer, sizeof(SMidx)*3*triangle_buffer_alloc*2);
     triangle_buffer_alloc = triangle_buffer_alloc * 2;
   }
-  VecCopy3iv(&(triangle_buffer[f_count*3]),t_idx);
+  triangle_buffer[f_count*3+0] = t_idx[0];
+  triangle_buffer[f_count*3+1] = t_idx[1];
+  triangle_buffer[f_count*3+2] = t_idx[2];
 
   f_count++;
 }
 
-void SMwriter_off::write_finalized(int final_idx)
+void SMwriter_off::write_finalized(SMidx final_idx)
 {
 }
 
 void SMwriter_off::close()
 {
-  int i;
+  SMidx i;
 
   // write header
   fprintf(file, "OFF\012",v_count,f_count);
-  fprintf(file, "%d %d 0\012",v_count,f_count);
+  fprintf(file, SM_IDX_FORMAT " " SM_IDX_FORMAT " 0\012",v_count,f_count);
 
   // write vertices
   for(i = 0; i < v_count; i++)
@@ -147,7 +151,7 @@ void SMwriter_off::close()
   // write triangles
   for(i = 0; i < f_count; i++)
   {
-    fprintf(file, "3 %d %d %d\012",triangle_buffer[3*i+0],triangle_buffer[3*i+1],triangle_buffer[3*i+2]);
+    fprintf(file, "3 " SM_IDX_FORMAT " " SM_IDX_FORMAT " " SM_IDX_FORMAT "\012",triangle_buffer[3*i+0],triangle_buffer[3*i+1],triangle_buffer[3*i+2]);
   }
 
   file = 0;
@@ -163,8 +167,8 @@ void SMwriter_off::close()
     comments = 0;
   }
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
 
   v_count = -1;
   f_count = -1;
@@ -187,8 +191,8 @@ void SMwriter_off::write_header()
       fprintf(file, "# %s\012",comments[i]);
     }
   }
-  if (nverts != -1) fprintf(file, "# nverts %d\012",nverts);
-  if (nfaces != -1) fprintf(file, "# nfaces %d\012",nfaces);
+  if (nverts != -1) fprintf(file, "# nverts " SM_IDX_FORMAT "\012",nverts);
+  if (nfaces != -1) fprintf(file, "# nfaces " SM_IDX_FORMAT "\012",nfaces);
   if (bb_min_f) fprintf(file, "# bb_min %f %f %f\012",bb_min_f[0],bb_min_f[1],bb_min_f[2]);
   if (bb_max_f) fprintf(file, "# bb_max %f %f %f\012",bb_max_f[0],bb_max_f[1],bb_max_f[2]);
 }
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
 
 #include "vec3fv.h"
 #include "vec3iv.h"
@@ -51,12 +52,12 @@ void SMwriter_sma::add_comment(const char* comment)
   ncomments++;
 }
 
-void SMwriter_sma::set_nverts(int nverts)
+void SMwriter_sma::set_nverts(SMidx nverts)
 {
   this->nverts = nverts;
 }
 
-void SMwriter_sma::set_nfaces(int nfaces)
+void SMwriter_sma::set_nfaces(SMidx nfaces)
 {
   this->nfaces = nfaces;
 }
@@ -82,45 +83,103 @@ bool SMwriter_sma::open(FILE* file)
   return true;
 }
 
+bool SMwriter_sma::open(unsigned char** bytes, size_t* nbytes)
+{
+  if (!memory.open(bytes, nbytes)) return false;
+  file = 0;
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+bool SMwriter_sma::open(void* bytes, size_t nalloc, size_t* nbytes)
+{
+  if (!memory.open(bytes, nalloc, nbytes)) return false;
+  file = 0;
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+bool SMwriter_sma::open(unsigned char** bytes, int* nbytes)
+{
+  if (!memory.open(bytes, nbytes)) return false;
+  file = 0;
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+bool SMwriter_sma::open(unsigned char* bytes, int nalloc, int* nbytes)
+{
+  if (!memory.open(bytes, nalloc, nbytes)) return false;
+  file = 0;
+  v_count = 0;
+  f_count = 0;
+  return true;
+}
+
+void SMwriter_sma::output(const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  if (file)
+  {
+    vfprintf(file, format, args);
+  }
+  else
+  {
+    char line[256];
+#ifdef _WIN32
+    int n = _vsnprintf(line, 256, format, args);
+#else
+    int n = vsnprintf(line, 256, format, args);
+#endif
+    memory.write(line, ((n < 0 || n > 255) ? 255 : n));
+  }
+  va_end(args);
+}
+
 void SMwriter_sma::write_vertex(const float* v_pos_f)
 {
   if (v_count + f_count == 0) write_header();
 
-  fprintf(file, "v %f %f %f\012",v_pos_f[0],v_pos_f[1],v_pos_f[2]);
+  output("v %f %f %f\012",v_pos_f[0],v_pos_f[1],v_pos_f[2]);
   v_count++;
 }
 
-void SMwriter_sma::write_triangle(const int* t_idx)
+void SMwriter_sma::write_triangle(const SMidx* t_idx)
 {
   if (v_count + f_count == 0) write_header();
 
-  fprintf(file, "f %d %d %d\012",t_idx[0]+1,t_idx[1]+1,t_idx[2]+1);
+  output("f " SM_IDX_FORMAT " " SM_IDX_FORMAT " " SM_IDX_FORMAT "\012",t_idx[0]+1,t_idx[1]+1,t_idx[2]+1);
   f_count++;
 }
 
-void SMwriter_sma::write_triangle(const int* t_idx, const bool* t_final)
+void SMwriter_sma::write_triangle(const SMidx* t_idx, const bool* t_final)
 {
   if (v_count + f_count == 0) write_header();
 
-  fprintf(file, "f %d %d %d\012",(t_final[0] ? t_idx[0]-v_count : t_idx[0]+1),(t_final[1] ? t_idx[1]-v_count : t_idx[1]+1), (t_final[2] ? t_idx[2]-v_count : t_idx[2]+1));
+  output("f " SM_IDX_FORMAT " " SM_IDX_FORMAT " " SM_IDX_FORMAT "\012",(t_final[0] ? t_idx[0]-v_count : t_idx[0]+1),(t_final[1] ? t_idx[1]-v_count : t_idx[1]+1), (t_final[2] ? t_idx[2]-v_count : t_idx[2]+1));
   f_count++;
 }
 
-void SMwriter_sma::write_finalized(int final_idx)
+void SMwriter_sma::write_finalized(SMidx final_idx)
 {
   if (final_idx < 0)
   {
-    fprintf(file, "x %d\012",final_idx);
+    output("x " SM_IDX_FORMAT "\012",final_idx);
   }
   else
   {
-    fprintf(file, "x %d\012",final_idx+1);
+    output("x " SM_IDX_FORMAT "\012",final_idx+1);
   }
 }
 
 void SMwriter_sma::close()
 {
   file = 0;
+  memory.close();
 
   if (comments)
   {
@@ -133,8 +192,8 @@ void SMwriter_sma::close()
     comments = 0;
   }
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
 
   v_count = -1;
   f_count = -1;
@@ -146,13 +205,23 @@ void SMwriter_sma::write_header()
   {
     for (int i = 0; i < ncomments; i++)
     {
-      fprintf(file, "# %s\012",comments[i]);
+      if (file)
+      {
+        fprintf(file, "# %s\012",comments[i]);
+      }
+      else
+      {
+        // comments can be longer than a line of output()
+        memory.write("# ", 2);
+        memory.write(comments[i], (int)strlen(comments[i]));
+        memory.put_byte('\012');
+      }
     }
   }
-  if (nverts != -1) fprintf(file, "# nverts %d\012",nverts);
-  if (nfaces != -1) fprintf(file, "# nfaces %d\012",nfaces);
-  if (bb_min_f) fprintf(file, "# bb_min %f %f %f\012",bb_min_f[0],bb_min_f[1],bb_min_f[2]);
-  if (bb_max_f) fprintf(file, "# bb_max %f %f %f\012",bb_max_f[0],bb_max_f[1],bb_max_f[2]);
+  if (nverts != -1) output("# nverts " SM_IDX_FORMAT "\012",nverts);
+  if (nfaces != -1) output("# nfaces " SM_IDX_FORMAT "\012",nfaces);
+  if (bb_min_f) output("# bb_min %f %f %f\012",bb_min_f[0],bb_min_f[1],bb_min_f[2]);
+  if (bb_max_f) output("# bb_max %f %f %f\012",bb_max_f[0],bb_max_f[1],bb_max_f[2]);
 }
 
 SMwriter_sma::SMwriter_sma()
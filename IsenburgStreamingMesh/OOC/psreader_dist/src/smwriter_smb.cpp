@@ -33,8 +33,13 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smtrace.h"
+#include "mydefs.h"
 
 #define SM_VERSION 0 // this is SMB
+#define SM_VERSION_64 4 // this is SMB with 64 bit counts
+#define SMB_FAR_CORNER ((int)0x80000000) // its index follows the block
+#define SMB_PADDING ((int)0x80000001) // fills up the last block
 
 bool SMwriter_smb::open(FILE* file)
 {
@@ -45,23 +50,84 @@ bool SMwriter_smb::open(FILE* file)
   }
 
   this->file = file;
-  // write version
-  fputc(SM_VERSION, file);
 
   v_count = 0;
   f_count = 0;
 
   element_number = 0;
   element_descriptor = 0;
+  escape_number = 0;
+
+  return true;
+}
+
+bool SMwriter_smb::open(unsigned char** bytes, size_t* nbytes)
+{
+  if (!memory.open(bytes, nbytes)) return false;
+  file = 0;
+
+  v_count = 0;
+  f_count = 0;
+
+  element_number = 0;
+  element_descriptor = 0;
+  escape_number = 0;
+
+  return true;
+}
+
+bool SMwriter_smb::open(void* bytes, size_t nalloc, size_t* nbytes)
+{
+  if (!memory.open(bytes, nalloc, nbytes)) return false;
+  file = 0;
+
+  v_count = 0;
+  f_count = 0;
+
+  element_number = 0;
+  element_descriptor = 0;
+  escape_number = 0;
+
+  return true;
+}
+
+bool SMwriter_smb::open(unsigned char** bytes, int* nbytes)
+{
+  if (!memory.open(bytes, nbytes)) return false;
+  file = 0;
+
+  v_count = 0;
+  f_count = 0;
+
+  element_number = 0;
+  element_descriptor = 0;
+  escape_number = 0;
+
+  return true;
+}
+
+bool SMwriter_smb::open(unsigned char* bytes, int nalloc, int* nbytes)
+{
+  if (!memory.open(bytes, nalloc, nbytes)) return false;
+  file = 0;
+
+  v_count = 0;
+  f_count = 0;
+
+  element_number = 0;
+  element_descriptor = 0;
+  escape_number = 0;
 
   return true;
 }
 
 void SMwriter_smb::close()
 {
+  if (v_count + f_count == 0) write_header();
   write_buffer_remaining();
 
   file = 0;
+  memory.close();
 
   if (comments)
   {
@@ -74,8 +140,8 @@ void SMwriter_smb::close()
     comments = 0;
   }
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
 
   v_count = -1;
   f_count = -1;
@@ -98,12 +164,12 @@ void SMwriter_smb::add_comment(const char* comment)
   ncomments++;
 }
 
-void SMwriter_smb::set_nverts(int nverts)
+void SMwriter_smb::set_nverts(SMidx nverts)
 {
   this->nverts = nverts;
 }
 
-void SMwriter_smb::set_nfaces(int nfaces)
+void SMwriter_smb::set_nfaces(SMidx nfaces)
 {
   this->nfaces = nfaces;
 }
@@ -139,18 +205,43 @@ void SMwriter_smb::write_vertex(const float* v_pos_f)
   v_count++;
 }
 
-void SMwriter_smb::write_triangle(const int* t_idx)
+void SMwriter_smb::write_triangle(const SMidx* t_idx)
 {
-  fprintf(stderr, "ERROR: write_triangle(const int* t_idx) not supported by SMwriter_smb\n");
+  fprintf(stderr, "ERROR: write_triangle(const SMidx* t_idx) not supported by SMwriter_smb\n");
   exit(0);
 }
 
-void SMwriter_smb::write_triangle(const int* t_idx, const bool* t_final)
+// in the SMB version with 64 bit counts a corner is stored as twice how
+// many vertices it goes back from the last vertex plus one if it is final.
+// a corner that is too far away is stored as SMB_FAR_CORNER and its index
+// goes into the escapes that are written after the block.
+
+static int relative_index(SMidx idx, bool final, SMidx v_count, SMidx* escapes, int* escape_number)
+{
+  SMidx back = v_count - 1 - idx;
+  if (back <= -0x40000000 || back > 0x3FFFFFFF)
+  {
+    escapes[*escape_number] = 2*idx + (final ? 1 : 0);
+    (*escape_number)++;
+    return SMB_FAR_CORNER;
+  }
+  return (int)(2*back + (final ? 1 : 0));
+}
+
+void SMwriter_smb::write_triangle(const SMidx* t_idx, const bool* t_final)
 {
   if (v_count + f_count == 0) write_header();
 
-  if (endian_swap) VecSet3iv_swap_endian((int*)&(element_buffer[element_number*3]), (t_final[0] ? t_idx[0]-v_count : t_idx[0]+1),(t_final[1] ? t_idx[1]-v_count : t_idx[1]+1), (t_final[2] ? t_idx[2]-v_count : t_idx[2]+1));
-  else VecSet3iv((int*)&(element_buffer[element_number*3]), (t_final[0] ? t_idx[0]-v_count : t_idx[0]+1),(t_final[1] ? t_idx[1]-v_count : t_idx[1]+1), (t_final[2] ? t_idx[2]-v_count : t_idx[2]+1));
+  if (index_64)
+  {
+    int* element = &(element_buffer[element_number*3]);
+    int corner[3];
+    for (int i = 0; i < 3; i++) corner[i] = relative_index(t_idx[i], t_final[i], v_count, escape_buffer, &escape_number);
+    if (endian_swap) VecCopy3iv_swap_endian(element, corner);
+    else VecCopy3iv(element, corner);
+  }
+  else if (endian_swap) VecSet3iv_swap_endian((int*)&(element_buffer[element_number*3]), (int)(t_final[0] ? t_idx[0]-v_count : t_idx[0]+1), (int)(t_final[1] ? t_idx[1]-v_count : t_idx[1]+1), (int)(t_final[2] ? t_idx[2]-v_count : t_idx[2]+1));
+  else VecSet3iv((int*)&(element_buffer[element_number*3]), (int)(t_final[0] ? t_idx[0]-v_count : t_idx[0]+1), (int)(t_final[1] ? t_idx[1]-v_count : t_idx[1]+1), (int)(t_final[2] ? t_idx[2]-v_count : t_idx[2]+1));
   element_descriptor = (element_descriptor >> 1);
   element_number++;
 
@@ -159,9 +250,9 @@ void SMwriter_smb::write_triangle(const int* t_idx, const bool* t_final)
   f_count++;
 }
 
-void SMwriter_smb::write_finalized(int final_idx)
+void SMwriter_smb::write_finalized(SMidx final_idx)
 {
-  fprintf(stderr, "ERROR: write_finalized(int final_idx) not supported by SMwriter_smb\n");
+  fprintf(stderr, "ERROR: write_finalized(SMidx final_idx) not supported by SMwriter_smb\n");
   exit(0);
 }
 
@@ -185,6 +276,16 @@ static unsigned int swap_endian_uint(unsigned int input)
   return output;
 }
 
+static I64 swap_endian_int64(I64 input)
+{
+  I64 output;
+  for (int i = 0; i < 8; i++)
+  {
+    ((char*)&output)[i] = ((char*)&input)[7-i];
+  }
+  return output;
+}
+
 #define SM_LITTLE_ENDIAN 0
 #define SM_BIG_ENDIAN 1
 #define SM_COMPRESSION 0
@@ -192,79 +293,122 @@ static unsigned int swap_endian_uint(unsigned int input)
 void SMwriter_smb::write_header()
 {
   int output;
+  I64 output64;
+  // streams that have or may have more than 2^31 elements need 64 bit counts
+#ifdef SM_64BIT_INDICES
+  index_64 = (nverts == -1 || nfaces == -1 || nverts > 0x7FFFFFFF || nfaces > 0x7FFFFFFF);
+#else
+  index_64 = false;
+#endif
+  // version
+  put_byte((index_64 ? SM_VERSION_64 : SM_VERSION));
   // endianness
 #if (defined(i386) || defined(WIN32))   // if little endian machine
-  if (endian_swap) fputc(SM_BIG_ENDIAN, file);
-  else fputc(SM_LITTLE_ENDIAN, file);
+  if (endian_swap) put_byte(SM_BIG_ENDIAN);
+  else put_byte(SM_LITTLE_ENDIAN);
 #else                                    // else big endian machine
-  if (endian_swap) fputc(SM_LITTLE_ENDIAN, file);
-  else fputc(SM_BIG_ENDIAN, file);
+  if (endian_swap) put_byte(SM_LITTLE_ENDIAN);
+  else put_byte(SM_BIG_ENDIAN);
 #endif
   // compression
-  fputc(SM_COMPRESSION, file);
-  fputc(SM_COMPRESSION, file);
+  put_byte(SM_COMPRESSION);
+  put_byte(SM_COMPRESSION);
   // write comments
   if (endian_swap) output = swap_endian_int(ncomments);
   else output = ncomments;
-  fwrite(&output, sizeof(int), 1, file);
+  put(&output, sizeof(int), 1);
   if (ncomments)
   {
     for (int i = 0; i < ncomments; i++)
     {
       if (endian_swap) output = swap_endian_int(strlen(comments[i]));
       else output = strlen(comments[i]);
-      fwrite(&output, sizeof(int), 1, file);
-      fwrite(comments[i], sizeof(char), output, file);
+      put(&output, sizeof(int), 1);
+      put(comments[i], sizeof(char), output);
     }
   }
-  // write nverts
-  if (endian_swap) output = swap_endian_int(nverts);
-  else output = nverts;
-  fwrite(&output, sizeof(int), 1, file);
-  // write nfaces
-  if (endian_swap) output = swap_endian_int(nfaces);
-  else output = nfaces;
-  fwrite(&output, sizeof(int), 1, file);
+  // write nverts and nfaces
+  if (index_64)
+  {
+    if (endian_swap) output64 = swap_endian_int64(nverts);
+    else output64 = nverts;
+    put(&output64, sizeof(I64), 1);
+    if (endian_swap) output64 = swap_endian_int64(nfaces);
+    else output64 = nfaces;
+    put(&output64, sizeof(I64), 1);
+  }
+  else
+  {
+    if (endian_swap) output = swap_endian_int((int)nverts);
+    else output = (int)nverts;
+    put(&output, sizeof(int), 1);
+    if (endian_swap) output = swap_endian_int((int)nfaces);
+    else output = (int)nfaces;
+    put(&output, sizeof(int), 1);
+  }
   // write bounding box
   if (bb_min_f && bb_max_f)
   {
-    fputc(1, file);
+    put_byte(1);
     if (endian_swap)
     {
       float temp[3];
       VecCopy3fv_swap_endian(temp, bb_min_f);
-      fwrite(temp, sizeof(float), 3, file);
+      put(temp, sizeof(float), 3);
       VecCopy3fv_swap_endian(temp, bb_max_f);
-      fwrite(temp, sizeof(float), 3, file);
+      put(temp, sizeof(float), 3);
     }
     else
     {
-      fwrite(bb_min_f, sizeof(float), 3, file);
-      fwrite(bb_max_f, sizeof(float), 3, file);
+      put(bb_min_f, sizeof(float), 3);
+      put(bb_max_f, sizeof(float), 3);
     }
   }
   else
   {
-    fputc(0, file);
+    put_byte(0);
   }
 }
 
 void SMwriter_smb::write_buffer()
 {
+  SM_TRACE_BEGIN("SMwriter_smb::write_buffer", "io");
   if (endian_swap) element_descriptor = swap_endian_uint(element_descriptor);
-  fwrite(&element_descriptor, sizeof(unsigned int), 1, file);
+  put(&element_descriptor, sizeof(unsigned int), 1);
   element_descriptor = 0;
-  fwrite(element_buffer, sizeof(int), 32*3, file);
+  put(element_buffer, sizeof(int), 32*3);
   element_number = 0;
+  for (int i = 0; i < escape_number; i++)
+  {
+    I64 output64 = escape_buffer[i];
+    if (endian_swap) output64 = swap_endian_int64(output64);
+    put(&output64, sizeof(I64), 1);
+  }
+  escape_number = 0;
+  SM_TRACE_END("SMwriter_smb::write_buffer", "io");
 }
 
 void SMwriter_smb::write_buffer_remaining()
 {
+  // a reader knows how many escapes follow a block only from its corners,
+  // so a last block that has escapes is filled up to a full block
+  if (escape_number)
+  {
+    while (element_number < 32)
+    {
+      if (endian_swap) VecSet3iv_swap_endian(&(element_buffer[element_number*3]), SMB_PADDING, SMB_PADDING, SMB_PADDING);
+      else VecSet3iv(&(element_buffer[element_number*3]), SMB_PADDING, SMB_PADDING, SMB_PADDING);
+      element_descriptor = (element_descriptor >> 1);
+      element_number++;
+    }
+    write_buffer();
+    return;
+  }
   element_descriptor = element_descriptor >> (32 - element_number);
   if (endian_swap) element_descriptor = swap_endian_uint(element_descriptor);
-  fwrite(&element_descriptor, sizeof(unsigned int), 1, file);
+  put(&element_descriptor, sizeof(unsigned int), 1);
   element_descriptor = 0;
-  fwrite(element_buffer, sizeof(int), element_number*3, file);
+  put(element_buffer, sizeof(int), element_number*3);
   element_number = 0;
 }
 
@@ -286,7 +430,10 @@ SMwriter_smb::SMwriter_smb()
   // init of SMwriter_smb interface
   file = 0;
   element_buffer = (int*)malloc(sizeof(int)*3*32);
+  escape_buffer = (SMidx*)malloc(sizeof(SMidx)*3*32);
+  escape_number = 0;
   endian_swap = false;
+  index_64 = false;
 }
 
 SMwriter_smb::~SMwriter_smb()
@@ -305,4 +452,5 @@ SMwriter_smb::~SMwriter_smb()
 
   // clean-up for SMwriter_smb interface
   free(element_buffer);
+  free(escape_buffer);
 }
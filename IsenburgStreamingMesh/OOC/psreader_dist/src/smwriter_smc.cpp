@@ -43,8 +43,13 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smstats.h"
+#include "smtrace.h"
+#include "smmemory.h"
+#include "mydefs.h"
 
 #include <hash_map.h>
+#include "poolallocator.h"
 
 #define PRINT_CONTROL_OUTPUT
 //#undef PRINT_CONTROL_OUTPUT
@@ -53,6 +58,9 @@
 
 #define SM_VERSION_SME 1
 #define SM_VERSION_SME_NON_FINALIZED_EOF 3
+#define SM_VERSION_SME_64 5
+#define SM_VERSION_SME_64_NON_FINALIZED_EOF 7
+#define SM_VERSION_SECTIONS 8 // added to any of the above
 
 #define SMC_START 0
 #define SMC_ADD 1
@@ -67,9 +75,13 @@ struct SMedge;
 
 typedef struct SMvertex
 {
-  SMvertex* buffer_next;    // used for efficient memory management and by dynamicvector data structure
+  union
+  {
+    SMvertex* buffer_next;  // used for efficient memory management
+    int dynamicvector;      // used by dynamicvector data structure
+  };
   float v[3];
-  int index;
+  SMidx index;
   int use_count;
   int list_size;
   int list_alloc;
@@ -84,88 +96,223 @@ typedef struct SMedge
   float across[3];
 } SMedge;
 
-typedef hash_map<int, SMvertex*> my_vertex_hash;
-
-static my_vertex_hash* vertex_hash;
-
-static DynamicVector* dv;
-
-static LittleCache* lc;
-
-static FloatCompressor* fc[3];
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_vertex_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_vertex_hash;
+#endif
 
-static PositionQuantizerNew* pq;
-static IntegerCompressorNew* ic[3];
+typedef DynamicVector<SMvertex,&SMvertex::dynamicvector> my_vertex_vector;
 
 // rangecoder and probability tables
 
 #define MAX_DEGREE_ONE 4
 #define MAX_USE_COUNT 15
 
-static RangeEncoder* re_conn;
-static RangeEncoder* re_conn_op;
-static RangeEncoder* re_conn_cache;
-static RangeEncoder* re_conn_index;
-static RangeEncoder* re_conn_final;
-
-static RangeEncoder* re_geom;
-
-// is there more to encode
-static RangeModel* rmDone;
-
-// what was the last operation
-static int last_op;
-
-// codes next operation
-static RangeModel** rmOp;
-
-// codes non-manifoldness of start operations
-static RangeModel* rmS_Old;
-
-// codes cache hits for start operations
-static RangeModel** rmS_Cache;
-
-// codes cache hits for add/join operations
-static RangeModel** rmAJ_Cache;
+// the state of the compressor. every SMwriter_smc has its own so that any
+// number of them can compress different meshes at the same time and in
+// any thread.
 
-// codes cache hits fill/end operations
-static RangeModel** rmFE_Cache;
-
-// codes vertex finalization
-static RangeModel*** rmFinalized;
-
-// statistics
+struct SMCencoder
+{
+  my_vertex_hash* vertex_hash;
+  my_vertex_vector* dv;
+  LittleCache* lc;
+
+  FloatCompressor* fc[3];
+
+  PositionQuantizerNew* pq;
+  IntegerCompressorNew* ic[3];
+
+  RangeEncoder* re_conn;
+  RangeEncoder* re_conn_op;
+  RangeEncoder* re_conn_cache;
+  RangeEncoder* re_conn_index;
+  RangeEncoder* re_conn_final;
+
+  RangeEncoder* re_geom;
+
+  // where the bytes go when compressing into memory
+  SMmemoryOutput* memory;
+
+  // with sections the connectivity and the geometry are coded by two range
+  // encoders that are finished every triangles_per_section triangles. the
+  // bytes of both go to the file or to the memory.
+  int triangles_per_section;
+  FILE* section_file;
+
+  // the version byte is written with the header because streams that have
+  // or may have more than 2^31 elements need the version with 64 bit counts
+  FILE* version_file;
+  bool index_64;
+
+  // where to report the indices that the decoder will give to the vertices
+  SMidx* index_map;
+  int index_map_size;
+  SMidx index_map_count;
+
+  // is there more to encode
+  RangeModel* rmDone;
+
+  // what was the last operation
+  int last_op;
+
+  // codes next operation
+  RangeModel** rmOp;
+
+  // codes non-manifoldness of start operations
+  RangeModel* rmS_Old;
+
+  // codes cache hits for start operations
+  RangeModel** rmS_Cache;
+
+  // codes cache hits for add/join operations
+  RangeModel** rmAJ_Cache;
+
+  // codes cache hits fill/end operations
+  RangeModel** rmFE_Cache;
+
+  // codes vertex finalization
+  RangeModel*** rmFinalized;
+
+  // statistics
+
+  SMstats* stats;
+
+  int stat_op_start;
+  int stat_op_add;
+  int stat_op_join;
+  int stat_op_fill_end;
+  int stat_op_fill;
+  int stat_op_end;
+  int stat_used_index;
+  int stat_used_cache;
+  int stat_add_miss;
+  int stat_add_hit;
+  int stat_fill_miss;
+  int stat_fill_hit;
+  int stat_prediction_none;
+  int stat_prediction_last;
+  int stat_prediction_across;
+  int stat_vertex_buffer;
+  int stat_edge_buffer;
+
+  // efficient memory allocation. the blocks are kept for the next open()
+  // and only returned to the heap by the destructor.
+
+  int vertex_buffer_size;
+  int vertex_buffer_alloc;
+  SMvertex* vertex_buffer_next;
+  SMvertex** vertex_blocks;
+  int* vertex_blocks_size;
+  int vertex_blocks_number;
+
+  int edge_buffer_size;
+  int edge_buffer_alloc;
+  SMedge* edge_buffer_next;
+  SMedge** edge_blocks;
+  int edge_blocks_number;
+
+  void initEncoder(FILE* file);
+  void finishEncoder(SMidx nverts);
+  int version();
+  void outputSectionBytes(const unsigned char* bytes, int nbytes);
+  void outputSectionInt(int i);
+  void outputSection();
+  void initModels(int compress);
+  void finishModels();
+
+  int initVertexBuffer(int size);
+  SMvertex* allocVertexBlock(int size);
+  SMvertex* allocVertex();
+  void deallocVertex(SMvertex* vertex);
+  int initEdgeBuffer(int size);
+  SMedge* allocEdgeBlock(int size);
+  SMedge* allocEdge(float* v);
+  void deallocEdge(SMedge* edge);
+
+  void compressVertexPosition(float* n);
+  void compressVertexPosition(const float* l, float* n);
+  void compressVertexPosition(const float* a, const float* b, const float* c, float* n);
+  inline void addVertex(SMvertex* vertex);
+
+  void compressTriangle(const SMidx* t_idx, const bool* t_final);
 
 #ifdef PRINT_CONTROL_OUTPUT
-static int op_start = 0;
-static int op_add = 0;
-static int op_join = 0;
-static int op_fill_end = 0;
-static int op_fill = 0;
-static int op_end = 0;
+  void printStats(SMidx nfaces, SMidx f_count);
+#endif
 
-static int used_index = 0;
-static int used_cache = 0;
+  SMCencoder();
+  ~SMCencoder();
+};
 
-static int add_miss = 0;
-static int add_hit[] = {0,0,0,0,0,0};
+SMCencoder::SMCencoder()
+{
+  vertex_hash = 0;
+  dv = 0;
+  lc = 0;
+  pq = 0;
+  memory = 0;
+  triangles_per_section = 0;
+  section_file = 0;
+  version_file = 0;
+  index_64 = false;
+  index_map = 0;
+  index_map_size = 0;
+  index_map_count = 0;
+  stats = 0;
 
-static int fill_miss = 0;
-static int fill_hit[] = {0,0,0,0,0,0,0,0,0};
+  vertex_buffer_size = 0;
+  vertex_buffer_alloc = 16;
+  vertex_buffer_next = 0;
+  vertex_blocks = 0;
+  vertex_blocks_size = 0;
+  vertex_blocks_number = 0;
 
-static int prediction_none = 0;
-static int prediction_last = 0;
-static int prediction_across = 0;
+  edge_buffer_size = 0;
+  edge_buffer_alloc = 16;
+  edge_buffer_next = 0;
+  edge_blocks = 0;
+  edge_blocks_number = 0;
+}
 
-static int vertex_buffer_maxsize = 0;
-static int edge_buffer_maxsize = 0;
-#endif
+SMCencoder::~SMCencoder()
+{
+  int i,j;
+  for (i = 0; i < vertex_blocks_number; i++)
+  {
+    for (j = 0; j < vertex_blocks_size[i]; j++)
+    {
+      if (vertex_blocks[i][j].list) free(vertex_blocks[i][j].list);
+    }
+    free(vertex_blocks[i]);
+  }
+  if (vertex_blocks) free(vertex_blocks);
+  if (vertex_blocks_size) free(vertex_blocks_size);
+  for (i = 0; i < edge_blocks_number; i++)
+  {
+    free(edge_blocks[i]);
+  }
+  if (edge_blocks) free(edge_blocks);
+  if (memory) delete memory;
+  if (stats) delete stats;
+}
 
-static void initEncoder(FILE* file)
+void SMCencoder::initEncoder(FILE* file)
 {
-  if (file)
+  if (triangles_per_section)
+  {
+    section_file = file;
+    re_conn = new RangeEncoder(0);
+    re_conn_op = re_conn;
+    re_conn_cache = re_conn;
+    re_conn_index = re_conn;
+    re_conn_final = re_conn;
+    re_geom = new RangeEncoder(0);
+  }
+  else if (file || memory)
   {
-    re_conn = new RangeEncoder(file);
+    re_conn = (memory ? new RangeEncoder(*memory) : new RangeEncoder(file));
     re_conn_op = re_conn;
     re_conn_cache = re_conn;
     re_conn_index = re_conn;
@@ -183,9 +330,67 @@ static void initEncoder(FILE* file)
   }
 }
 
-static void finishEncoder(int nverts)
+int SMCencoder::version()
 {
-  if (re_conn != re_conn_op)
+#ifdef ALLOW_NON_FINALIZED_EOF
+  return (index_64 ? SM_VERSION_SME_64_NON_FINALIZED_EOF : SM_VERSION_SME_NON_FINALIZED_EOF) | (triangles_per_section ? SM_VERSION_SECTIONS : 0);
+#else
+  return (index_64 ? SM_VERSION_SME_64 : SM_VERSION_SME) | (triangles_per_section ? SM_VERSION_SECTIONS : 0);
+#endif
+}
+
+void SMCencoder::outputSectionBytes(const unsigned char* bytes, int nbytes)
+{
+  if (section_file)
+  {
+    fwrite(bytes, sizeof(unsigned char), nbytes, section_file);
+  }
+  else
+  {
+    memory->write(bytes, nbytes);
+  }
+}
+
+// the numbers of the section layout are 4 byte little endian integers
+
+void SMCencoder::outputSectionInt(int i)
+{
+  unsigned char bytes[4];
+  bytes[0] = (unsigned char)(i & 0xFF);
+  bytes[1] = (unsigned char)((i >> 8) & 0xFF);
+  bytes[2] = (unsigned char)((i >> 16) & 0xFF);
+  bytes[3] = (unsigned char)((i >> 24) & 0xFF);
+  outputSectionBytes(bytes, 4);
+}
+
+// a section is the number of connectivity bytes, the number of geometry
+// bytes, and then these bytes. both range encoders start over after it.
+
+void SMCencoder::outputSection()
+{
+  re_conn->done();
+  re_geom->done();
+  outputSectionInt(re_conn->getNumberChars());
+  outputSectionInt(re_geom->getNumberChars());
+  outputSectionBytes(re_conn->getChars(), re_conn->getNumberChars());
+  outputSectionBytes(re_geom->getChars(), re_geom->getNumberChars());
+  re_conn->restart();
+  re_geom->restart();
+}
+
+void SMCencoder::finishEncoder(SMidx nverts)
+{
+  if (triangles_per_section)
+  {
+    outputSection();
+
+    section_file = 0;
+    triangles_per_section = 0;
+
+    delete re_conn;
+    delete re_geom;
+  }
+  else if (re_conn != re_conn_op)
   {
     re_conn_op->done();
     re_conn_cache->done();
@@ -209,7 +414,7 @@ static void finishEncoder(int nverts)
     fprintf(stderr,"total:\t%6.3f bpv\n", 8.0f/nverts*(re_geom->getNumberBytes()+re_conn_op->getNumberBytes()+re_conn_cache->getNumberBytes()+re_conn_index->getNumberBytes()+re_conn_final->getNumberBytes()+re_conn->getNumberBytes()));
 
 #ifdef PRINT_CONTROL_OUTPUT
-    fprintf(stderr,"none: %d last %d across %d\n", prediction_none, prediction_last, prediction_across);
+    fprintf(stderr,"none: " SM_COUNT_FORMAT " last " SM_COUNT_FORMAT " across " SM_COUNT_FORMAT "\n", stats->value(stat_prediction_none), stats->value(stat_prediction_last), stats->value(stat_prediction_across));
     if (pq)
     {
       fprintf(stderr,"small %d %d %d %f\n", ic[0]->num_predictions_small, ic[1]->num_predictions_small, ic[2]->num_predictions_small, 100.0f*(ic[0]->num_predictions_small+ic[1]->num_predictions_small+ic[2]->num_predictions_small)/3/nverts);
@@ -233,9 +438,16 @@ static void finishEncoder(int nverts)
 
     delete re_conn;
   }
+
+  if (memory)
+  {
+    memory->close();
+    delete memory;
+    memory = 0;
+  }
 }
 
-static void initModels(int compress)
+void SMCencoder::initModels(int compress)
 {
   int i,j;
 
@@ -290,7 +502,7 @@ static void initModels(int compress)
   }
 }
 
-static void finishModels()
+void SMCencoder::finishModels()
 {
   int i,j;
 
@@ -341,48 +553,60 @@ static void finishModels()
   free(rmFinalized);
 }
 
-// efficient memory allocation
+// efficient memory allocation. every block is remembered so that the
+// destructor can give it back.
 
-static int vertex_buffer_size = 0;
-static int vertex_buffer_alloc = 16;
-static SMvertex* vertex_buffer_next = 0;
-
-static int initVertexBuffer(int size)
+SMvertex* SMCencoder::allocVertexBlock(int size)
 {
-  vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*size);
-
-  if (vertex_buffer_next == 0)
+  SMvertex* block = (SMvertex*)malloc(sizeof(SMvertex)*size);
+  if (block == 0)
   {
     fprintf(stderr,"malloc for vertex buffer failed\n");
     return 0;
   }
+  vertex_blocks = (SMvertex**)realloc(vertex_blocks, sizeof(SMvertex*)*(vertex_blocks_number+1));
+  vertex_blocks_size = (int*)realloc(vertex_blocks_size, sizeof(int)*(vertex_blocks_number+1));
+  vertex_blocks[vertex_blocks_number] = block;
+  vertex_blocks_size[vertex_blocks_number] = size;
+  vertex_blocks_number++;
   for (int i = 0; i < size; i++)
   {
-    vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
-    vertex_buffer_next[i].list = 0;
+    block[i].buffer_next = &(block[i+1]);
+    block[i].list = 0;
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMCencoder::initVertexBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (vertex_buffer_next)
+  {
+    vertex_buffer_size = 0;
+    return 1;
+  }
+
+  vertex_buffer_next = allocVertexBlock(size);
+
+  if (vertex_buffer_next == 0)
+  {
+    return 0;
   }
-  vertex_buffer_next[size-1].buffer_next = 0;
   vertex_buffer_alloc = size;
   vertex_buffer_size = 0;
   return 1;
 }
 
-static SMvertex* allocVertex()
+SMvertex* SMCencoder::allocVertex()
 {
   if (vertex_buffer_next == 0)
   {
-    vertex_buffer_next = (SMvertex*)malloc(sizeof(SMvertex)*vertex_buffer_alloc);
+    vertex_buffer_next = allocVertexBlock(vertex_buffer_alloc);
     if (vertex_buffer_next == 0)
     {
-      fprintf(stderr,"malloc for vertex buffer failed\n");
       return 0;
     }
-    for (int i = 0; i < vertex_buffer_alloc; i++)
-    {
-      vertex_buffer_next[i].buffer_next = &(vertex_buffer_next[i+1]);
-      vertex_buffer_next[i].list = 0;
-    }
-    vertex_buffer_next[vertex_buffer_alloc-1].buffer_next = 0;
     vertex_buffer_alloc = 2*vertex_buffer_alloc;
   }
   // get pointer to next available vertex
@@ -399,58 +623,67 @@ static SMvertex* allocVertex()
 
   vertex_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_buffer_size > vertex_buffer_maxsize) vertex_buffer_maxsize = vertex_buffer_size;
-#endif
+  stats->level(stat_vertex_buffer, vertex_buffer_size);
 
   return vertex;
 }
 
-static void deallocVertex(SMvertex* vertex)
+void SMCencoder::deallocVertex(SMvertex* vertex)
 {
   vertex->buffer_next = vertex_buffer_next;
   vertex_buffer_next = vertex;
   vertex_buffer_size--;
+  stats->down(stat_vertex_buffer);
 }
 
-static int edge_buffer_size = 0;
-static int edge_buffer_alloc = 16;
-static SMedge* edge_buffer_next = 0;
-
-static int initEdgeBuffer(int size)
+SMedge* SMCencoder::allocEdgeBlock(int size)
 {
-  edge_buffer_next = (SMedge*)malloc(sizeof(SMedge)*size);
-
-  if (edge_buffer_next == 0)
+  SMedge* block = (SMedge*)malloc(sizeof(SMedge)*size);
+  if (block == 0)
   {
     fprintf(stderr,"malloc for edge buffer failed\n");
     return 0;
   }
+  edge_blocks = (SMedge**)realloc(edge_blocks, sizeof(SMedge*)*(edge_blocks_number+1));
+  edge_blocks[edge_blocks_number] = block;
+  edge_blocks_number++;
   for (int i = 0; i < size; i++)
   {
-    edge_buffer_next[i].buffer_next = &(edge_buffer_next[i+1]);
+    block[i].buffer_next = &(block[i+1]);
+  }
+  block[size-1].buffer_next = 0;
+  return block;
+}
+
+int SMCencoder::initEdgeBuffer(int size)
+{
+  // reuse what a previous open() left on the free list
+  if (edge_buffer_next)
+  {
+    edge_buffer_size = 0;
+    return 1;
+  }
+
+  edge_buffer_next = allocEdgeBlock(size);
+
+  if (edge_buffer_next == 0)
+  {
+    return 0;
   }
-  edge_buffer_next[size-1].buffer_next = 0;
   edge_buffer_alloc = size;
   edge_buffer_size = 0;
   return 1;
 }
 
-static SMedge* allocEdge(float* v)
+SMedge* SMCencoder::allocEdge(float* v)
 {
   if (edge_buffer_next == 0)
   {
-    edge_buffer_next = (SMedge*)malloc(sizeof(SMedge)*edge_buffer_alloc);
+    edge_buffer_next = allocEdgeBlock(edge_buffer_alloc);
     if (edge_buffer_next == 0)
     {
-      fprintf(stderr,"malloc for edge buffer failed\n");
       return 0;
     }
-    for (int i = 0; i < edge_buffer_alloc; i++)
-    {
-      edge_buffer_next[i].buffer_next = &(edge_buffer_next[i+1]);
-    }
-    edge_buffer_next[edge_buffer_alloc-1].buffer_next = 0;
     edge_buffer_alloc = 2*edge_buffer_alloc;
   }
   // get index of next available vertex
@@ -463,27 +696,37 @@ static SMedge* allocEdge(float* v)
 
   edge_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (edge_buffer_size > edge_buffer_maxsize) edge_buffer_maxsize = edge_buffer_size;
-#endif
+  stats->level(stat_edge_buffer, edge_buffer_size);
 
   return edge;
 }
 
-static void deallocEdge(SMedge* edge)
+void SMCencoder::deallocEdge(SMedge* edge)
 {
   edge->buffer_next = edge_buffer_next;
   edge_buffer_next = edge;
   edge_buffer_size--;
+  stats->down(stat_edge_buffer);
+}
+
+#ifdef PRINT_CONTROL_OUTPUT
+void SMCencoder::printStats(SMidx nfaces, SMidx f_count)
+{
+  fprintf(stderr,"nfaces " SM_IDX_FORMAT " f_count " SM_IDX_FORMAT " ops " SM_COUNT_FORMAT "\n",nfaces,f_count,stats->value(stat_op_start)+stats->value(stat_op_add)+stats->value(stat_op_join)+stats->value(stat_op_fill_end));
+  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize " SM_COUNT_FORMAT "\n",edge_buffer_size,stats->max(stat_edge_buffer));
+  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize " SM_COUNT_FORMAT "\n",vertex_buffer_size,stats->max(stat_vertex_buffer));
+  fprintf(stderr,"op_start " SM_COUNT_FORMAT " (%4.2f) op_add " SM_COUNT_FORMAT " (%4.2f) od_join " SM_COUNT_FORMAT " (%4.2f) op_fill " SM_COUNT_FORMAT " (%4.2f) op_end " SM_COUNT_FORMAT " (%4.2f)\n",stats->value(stat_op_start),100.0f*stats->value(stat_op_start)/(stats->value(stat_op_start)+stats->value(stat_op_add)+stats->value(stat_op_join)+stats->value(stat_op_fill_end)),stats->value(stat_op_add),100.0f*stats->value(stat_op_add)/(stats->value(stat_op_start)+stats->value(stat_op_add)+stats->value(stat_op_join)+stats->value(stat_op_fill_end)),stats->value(stat_op_join),100.0f*stats->value(stat_op_join)/(stats->value(stat_op_start)+stats->value(stat_op_add)+stats->value(stat_op_join)+stats->value(stat_op_fill_end)),stats->value(stat_op_fill),100.0f*stats->value(stat_op_fill)/(stats->value(stat_op_start)+stats->value(stat_op_add)+stats->value(stat_op_join)+stats->value(stat_op_fill_end)),stats->value(stat_op_end),100.0f*stats->value(stat_op_end)/(stats->value(stat_op_start)+stats->value(stat_op_add)+stats->value(stat_op_join)+stats->value(stat_op_fill_end)));
+  fprintf(stderr,"add_miss " SM_COUNT_FORMAT " add_hit " SM_COUNT_FORMAT " (" SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT ")\n",stats->value(stat_add_miss),stats->value(stat_add_hit),stats->get(stat_add_hit)->bins[0],stats->get(stat_add_hit)->bins[1],stats->get(stat_add_hit)->bins[2],stats->get(stat_add_hit)->bins[3],stats->get(stat_add_hit)->bins[4],stats->get(stat_add_hit)->bins[5]);
+  fprintf(stderr,"fill_miss " SM_COUNT_FORMAT " fill_hit " SM_COUNT_FORMAT " (" SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT " " SM_COUNT_FORMAT ")\n",stats->value(stat_fill_miss),stats->value(stat_fill_hit),stats->get(stat_fill_hit)->bins[0],stats->get(stat_fill_hit)->bins[1],stats->get(stat_fill_hit)->bins[2],stats->get(stat_fill_hit)->bins[3],stats->get(stat_fill_hit)->bins[4],stats->get(stat_fill_hit)->bins[5],stats->get(stat_fill_hit)->bins[6],stats->get(stat_fill_hit)->bins[7],stats->get(stat_fill_hit)->bins[8]);
+  fprintf(stderr,"used_index " SM_COUNT_FORMAT " (%4.2f) used_cache " SM_COUNT_FORMAT "  (%4.2f)\n",stats->value(stat_used_index),100.0f*stats->value(stat_used_index)/(stats->value(stat_used_index)+stats->value(stat_used_cache)),stats->value(stat_used_cache),100.0f*stats->value(stat_used_cache)/(stats->value(stat_used_index)+stats->value(stat_used_cache)));
 }
+#endif
 
 // helper functions
 
-static void compressVertexPosition(float* n)
+void SMCencoder::compressVertexPosition(float* n)
 {
-#ifdef PRINT_CONTROL_OUTPUT
-  prediction_none++;
-#endif
+  stats->count(stat_prediction_none);
 
   if (pq)
   {
@@ -502,11 +745,9 @@ static void compressVertexPosition(float* n)
   }
 }
 
-static void compressVertexPosition(const float* l, float* n)
+void SMCencoder::compressVertexPosition(const float* l, float* n)
 {
-#ifdef PRINT_CONTROL_OUTPUT
-  prediction_last++;
-#endif
+  stats->count(stat_prediction_last);
 
   if (pq)
   {
@@ -525,11 +766,9 @@ static void compressVertexPosition(const float* l, float* n)
   }
 }
 
-static void compressVertexPosition(const float* a, const float* b, const float* c, float* n)
+void SMCencoder::compressVertexPosition(const float* a, const float* b, const float* c, float* n)
 {
-#ifdef PRINT_CONTROL_OUTPUT
-  prediction_across++;
-#endif
+  stats->count(stat_prediction_across);
 
   if (pq)
   {
@@ -561,6 +800,17 @@ static void compressVertexPosition(const float* a, const float* b, const float*
   }
 }
 
+// the decoder numbers the vertices in the order they are added here
+
+inline void SMCencoder::addVertex(SMvertex* vertex)
+{
+  if (index_map)
+  {
+    index_map[index_map_size ? vertex->index % index_map_size : vertex->index] = index_map_count++;
+  }
+  dv->addElement(vertex);
+}
+
 static void addEdgeToVertex(SMedge* edge, SMvertex* vertex)
 {
   if (vertex->list_size == vertex->list_alloc)
@@ -604,12 +854,12 @@ void SMwriter_smc::add_comment(const char* comment)
   fprintf(stderr,"ERROR: add_comment not implemented\n");
 }
 
-void SMwriter_smc::set_nverts(int nverts)
+void SMwriter_smc::set_nverts(SMidx nverts)
 {
   this->nverts = nverts;
 }
 
-void SMwriter_smc::set_nfaces(int nfaces)
+void SMwriter_smc::set_nfaces(SMidx nfaces)
 {
   this->nfaces = nfaces;
 }
@@ -626,23 +876,21 @@ void SMwriter_smc::write_vertex(const float* v_pos_f)
 {
   if (v_count + f_count == 0) write_header();
 
-  SMvertex* vertex = allocVertex();
+  SMvertex* vertex = encoder->allocVertex();
   vertex->index = v_count;
   VecCopy3fv(vertex->v, v_pos_f);
-  vertex_hash->insert(my_vertex_hash::value_type(v_count, vertex));
+  sm_trace_hash_insert(encoder->vertex_hash, my_vertex_hash::value_type(v_count, vertex), "SMwriter_smc::vertex_hash");
   v_count++;
 }
 
-void SMwriter_smc::write_triangle(const int* t_idx)
+void SMwriter_smc::write_triangle(const SMidx* t_idx)
 {
-  fprintf(stderr, "ERROR: write_triangle(const int* t_idx) not supported by SMwriter_smc\n");
+  fprintf(stderr, "ERROR: write_triangle(const SMidx* t_idx) not supported by SMwriter_smc\n");
   exit(0);
 }
 
-void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
+void SMCencoder::compressTriangle(const SMidx* t_idx, const bool* t_final)
 {
-  if (v_count + f_count == 0) write_header();
-
   int i,j;
   int dv_index;
   int lc_pos;
@@ -667,7 +915,7 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
     hash_elements[i] = vertex_hash->find(t_idx[i]);
     if (hash_elements[i] == vertex_hash->end())
     {
-      fprintf(stderr,"ERROR: vertex %d not in hash\n",t_idx[i]);
+      fprintf(stderr,"ERROR: vertex " SM_IDX_FORMAT " not in hash\n",t_idx[i]);
       exit(0);
     }
 
@@ -718,9 +966,7 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
 
   if (num_e_visited == 0) // start
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_start++;
-#endif
+    stats->count(stat_op_start);
 
     if (edge_buffer_size)
     {
@@ -769,16 +1015,12 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
         // encode its index among all active vertices
         dv_index = dv->getRelativeIndex(vertices[0]);
         re_conn_index->encode(dv->size(),dv_index);        
-#ifdef PRINT_CONTROL_OUTPUT
-        used_index++;
-#endif
+        stats->count(stat_used_index);
       }
       else
       {
         re_conn_cache->encode(rmS_Cache[0],lc_pos);        
-#ifdef PRINT_CONTROL_OUTPUT
-        used_cache++;
-#endif
+        stats->count(stat_used_cache);
       }
     }
     else
@@ -786,7 +1028,7 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
       // encode its position
       compressVertexPosition(vertices[0]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[0]);
+      addVertex(vertices[0]);
     }
 
     // encode vertex v1
@@ -801,16 +1043,12 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
         // encode its index among all active vertices
         dv_index = dv->getRelativeIndex(vertices[1]);
         re_conn_index->encode(dv->size(),dv_index);        
-#ifdef PRINT_CONTROL_OUTPUT
-        used_index++;
-#endif
+        stats->count(stat_used_index);
       }
       else
       {
         re_conn_cache->encode(rmS_Cache[1],lc_pos);        
-#ifdef PRINT_CONTROL_OUTPUT
-        used_cache++;
-#endif
+        stats->count(stat_used_cache);
       }
     }
     else
@@ -818,7 +1056,7 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
       // encode its position
       compressVertexPosition(vertices[0]->v, vertices[1]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[1]);
+      addVertex(vertices[1]);
     }
 
     // encode vertex v2
@@ -833,16 +1071,12 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
         // encode its index among all active vertices
         dv_index = dv->getRelativeIndex(vertices[2]);
         re_conn_index->encode(dv->size(),dv_index);        
-#ifdef PRINT_CONTROL_OUTPUT
-        used_index++;
-#endif
+        stats->count(stat_used_index);
       }
       else
       {
         re_conn_cache->encode(rmS_Cache[2],lc_pos);        
-#ifdef PRINT_CONTROL_OUTPUT
-        used_cache++;
-#endif
+        stats->count(stat_used_cache);
       }
     }
     else
@@ -850,23 +1084,19 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
       // encode its position
       compressVertexPosition(vertices[0]->v, vertices[2]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[2]);
+      addVertex(vertices[2]);
     }
   }
   else if (num_e_visited == 1) // add or join)
   {
     if (num_v_visited == 2) // add
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_add++;
-#endif
+      stats->count(stat_op_add);
       re_conn_op->encode(rmOp[last_op], SMC_ADD);
     }
     else
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_join++;
-#endif
+      stats->count(stat_op_join);
       re_conn_op->encode(rmOp[last_op], SMC_JOIN);
     }
 
@@ -895,28 +1125,22 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
         re_conn_cache->encode(rmAJ_Cache[last_op],6);        
         dv_index = dv->getRelativeIndex(vertices[0]);
         re_conn_index->encode(dv->size(),dv_index);        
-#ifdef PRINT_CONTROL_OUTPUT
-        add_miss++;
-        used_index++;
-#endif
+        stats->count(stat_add_miss);
+        stats->count(stat_used_index);
       }
       else
       {
         lc_pos += 3;
         re_conn_cache->encode(rmAJ_Cache[last_op],lc_pos);
-#ifdef PRINT_CONTROL_OUTPUT
-        add_hit[lc_pos]++;
-        used_cache++;
-#endif
+        stats->sample(stat_add_hit, lc_pos);
+        stats->count(stat_used_cache);
       }
     }
     else
     {
       re_conn_cache->encode(rmAJ_Cache[last_op],lc_pos);        
-#ifdef PRINT_CONTROL_OUTPUT
-      add_hit[lc_pos]++;
-      used_cache++;
-#endif
+      stats->sample(stat_add_hit, lc_pos);
+      stats->count(stat_used_cache);
     }
 
     if (lc_pos < 3)
@@ -966,9 +1190,7 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
       // encode its index among all active vertices
       dv_index = dv->getRelativeIndex(vertices[2]);
       re_conn_index->encode(dv->size(),dv_index);        
-#ifdef PRINT_CONTROL_OUTPUT
-      used_index++;
-#endif
+      stats->count(stat_used_index);
       last_op = SMC_JOIN;
     }
     else // add
@@ -976,15 +1198,13 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
       // encode its position
       compressVertexPosition(vertices[0]->v, edges[0]->across, vertices[1]->v, vertices[2]->v);
       // insert it into the indexable data structure
-      dv->addElement(vertices[2]);
+      addVertex(vertices[2]);
       last_op = SMC_ADD;
     }
   }
   else // fill or end
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_fill_end++;
-#endif
+    stats->count(stat_op_fill_end);
     re_conn_op->encode(rmOp[last_op], SMC_FILL_END);
 
     // rotate triangle if necessary
@@ -1030,38 +1250,30 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
           re_conn_cache->encode(rmFE_Cache[last_op],9);
           dv_index = dv->getRelativeIndex(vertices[0]);
           re_conn_index->encode(dv->size(),dv_index);
-#ifdef PRINT_CONTROL_OUTPUT
-          fill_miss++;
-          used_index++;
-#endif
+          stats->count(stat_fill_miss);
+          stats->count(stat_used_index);
         }
         else
         {
           lc_pos += 6;
           re_conn_cache->encode(rmFE_Cache[last_op],lc_pos);
-#ifdef PRINT_CONTROL_OUTPUT
-          fill_hit[lc_pos]++;
-          used_cache++;
-#endif
+          stats->sample(stat_fill_hit, lc_pos);
+          stats->count(stat_used_cache);
         }
       }
       else
       {
         lc_pos += 3;
         re_conn_cache->encode(rmFE_Cache[last_op],lc_pos);        
-#ifdef PRINT_CONTROL_OUTPUT
-        fill_hit[lc_pos]++;
-        used_cache++;
-#endif
+        stats->sample(stat_fill_hit, lc_pos);
+        stats->count(stat_used_cache);
       }
     }
     else
     {
       re_conn_cache->encode(rmFE_Cache[last_op],lc_pos);        
-#ifdef PRINT_CONTROL_OUTPUT
-      fill_hit[lc_pos]++;
-      used_cache++;
-#endif
+      stats->sample(stat_fill_hit, lc_pos);
+      stats->count(stat_used_cache);
     }
 
     if (lc_pos < 3) // we have v0
@@ -1187,16 +1399,12 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
 
     if (num_e_visited == 2)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_fill++;
-#endif
+      stats->count(stat_op_fill);
       last_op = SMC_FILL;
     }
     else
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_end++;
-#endif
+      stats->count(stat_op_end);
       last_op = SMC_END;
 
       // make sure that the decoder uses the same edges[1]
@@ -1274,41 +1482,127 @@ void SMwriter_smc::write_triangle(const int* t_idx, const bool* t_final)
       deallocVertex(vertex);
     }
   }
+}
+
+void SMwriter_smc::write_triangle(const SMidx* t_idx, const bool* t_final)
+{
+  if (v_count + f_count == 0) write_header();
+
+  encoder->compressTriangle(t_idx, t_final);
+
   f_count++;
+
+  if (encoder->triangles_per_section && (f_count % encoder->triangles_per_section) == 0)
+  {
+    encoder->outputSection();
+  }
 }
 
-void SMwriter_smc::write_finalized(int final_idx)
+void SMwriter_smc::write_finalized(SMidx final_idx)
 {
-  fprintf(stderr, "ERROR: write_finalized(int final_idx) not supported by SMwriter_smc\n");
+  fprintf(stderr, "ERROR: write_finalized(SMidx final_idx) not supported by SMwriter_smc\n");
   exit(0);
 }
 
-bool SMwriter_smc::open(FILE* file, int bits)
+bool SMwriter_smc::open(unsigned char** bytes, size_t* nbytes, int bits, int section_size)
 {
-  // write version
-  if (file)
+  encoder->memory = new SMmemoryOutput();
+  if (!encoder->memory->open(bytes, nbytes))
   {
-#ifdef ALLOW_NON_FINALIZED_EOF
-    fputc(SM_VERSION_SME_NON_FINALIZED_EOF, file);
-#else
-    fputc(SM_VERSION_SME, file);
-#endif
+    delete encoder->memory;
+    encoder->memory = 0;
+    return false;
   }
+  return open((FILE*)0, bits, section_size);
+}
 
-  initVertexBuffer(1024);
-  initEdgeBuffer(1024);
+bool SMwriter_smc::open(void* bytes, size_t nalloc, size_t* nbytes, int bits, int section_size)
+{
+  encoder->memory = new SMmemoryOutput();
+  if (!encoder->memory->open(bytes, nalloc, nbytes))
+  {
+    delete encoder->memory;
+    encoder->memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, section_size);
+}
+
+bool SMwriter_smc::open(unsigned char** bytes, int* nbytes, int bits, int section_size)
+{
+  encoder->memory = new SMmemoryOutput();
+  if (!encoder->memory->open(bytes, nbytes))
+  {
+    delete encoder->memory;
+    encoder->memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, section_size);
+}
+
+bool SMwriter_smc::open(unsigned char* bytes, int nalloc, int* nbytes, int bits, int section_size)
+{
+  encoder->memory = new SMmemoryOutput();
+  if (!encoder->memory->open(bytes, nalloc, nbytes))
+  {
+    delete encoder->memory;
+    encoder->memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, section_size);
+}
 
-  vertex_hash = new my_vertex_hash;
-  dv = new DynamicVector();
-  lc = new LittleCache();
+bool SMwriter_smc::open(FILE* file, int bits, int section_size)
+{
+  if (section_size < 0)
+  {
+    fprintf(stderr,"ERROR: %d triangles per section is not possible\n", section_size);
+    if (encoder->memory) delete encoder->memory;
+    encoder->memory = 0;
+    return false;
+  }
 
-  initEncoder(file);
-  initModels(1);
+  encoder->version_file = file;
+  // sections are only written when the bytes go somewhere
+  encoder->triangles_per_section = ((file || encoder->memory) ? section_size : 0);
 
-  last_op = 0;
+  if (encoder->stats == 0)
+  {
+    encoder->stats = new SMstats("SMwriter_smc");
+  }
+  encoder->stat_op_start = encoder->stats->add("op_start");
+  encoder->stat_op_add = encoder->stats->add("op_add");
+  encoder->stat_op_join = encoder->stats->add("op_join");
+  encoder->stat_op_fill_end = encoder->stats->add("op_fill_end");
+  encoder->stat_op_fill = encoder->stats->add("op_fill");
+  encoder->stat_op_end = encoder->stats->add("op_end");
+  encoder->stat_used_index = encoder->stats->add("used_index");
+  encoder->stat_used_cache = encoder->stats->add("used_cache");
+  encoder->stat_add_miss = encoder->stats->add("add_miss");
+  encoder->stat_add_hit = encoder->stats->add("add_hit", SM_STATS_HISTOGRAM, 6);
+  encoder->stat_fill_miss = encoder->stats->add("fill_miss");
+  encoder->stat_fill_hit = encoder->stats->add("fill_hit", SM_STATS_HISTOGRAM, 9);
+  encoder->stat_prediction_none = encoder->stats->add("prediction_none");
+  encoder->stat_prediction_last = encoder->stats->add("prediction_last");
+  encoder->stat_prediction_across = encoder->stats->add("prediction_across");
+  encoder->stat_vertex_buffer = encoder->stats->add("vertex_buffer", SM_STATS_LEVEL);
+  encoder->stat_edge_buffer = encoder->stats->add("edge_buffer", SM_STATS_LEVEL);
+  encoder->stats->reset();
+
+  encoder->initVertexBuffer(1024);
+  encoder->initEdgeBuffer(1024);
+
+  encoder->vertex_hash = new my_vertex_hash;
+  encoder->dv = new my_vertex_vector();
+  encoder->lc = new LittleCache();
+
+  encoder->initEncoder(file);
+  encoder->initModels(1);
+
+  encoder->last_op = 0;
 
   // write precision
-  re_conn->encode(25,bits);
+  encoder->re_conn->encode(25,bits);
 
   // store precision 
   nbits = bits;
@@ -1321,106 +1615,146 @@ bool SMwriter_smc::open(FILE* file, int bits)
 
 void SMwriter_smc::close()
 {
-  if (edge_buffer_size == 0)
+  if (v_count + f_count == 0) write_header();
+  if (encoder->edge_buffer_size == 0)
   {
-    re_conn_op->encode(rmDone, 1); // done
+    encoder->re_conn_op->encode(encoder->rmDone, 1); // done
   }
   else
   {
 #ifdef ALLOW_NON_FINALIZED_EOF
-    re_conn_op->encode(rmOp[last_op], SMC_START);
-    re_conn_op->encode(rmS_Old, 4);
+    encoder->re_conn_op->encode(encoder->rmOp[encoder->last_op], SMC_START);
+    encoder->re_conn_op->encode(encoder->rmS_Old, 4);
 #else
-    if (dv->size()) fprintf(stderr,"WARNING: the decoder will fail to decompress this mesh.\n");
+    if (encoder->dv->size()) fprintf(stderr,"WARNING: the decoder will fail to decompress this mesh.\n");
 #endif
   }
-  finishEncoder(v_count);
-  finishModels();
-  if (pq)
+  encoder->finishEncoder(v_count);
+  encoder->finishModels();
+  if (encoder->pq)
   {
-    ic[0]->FinishCompressor();
-    ic[1]->FinishCompressor();
-    ic[2]->FinishCompressor();
+    encoder->ic[0]->FinishCompressor();
+    encoder->ic[1]->FinishCompressor();
+    encoder->ic[2]->FinishCompressor();
+    delete encoder->ic[0];
+    delete encoder->ic[1];
+    delete encoder->ic[2];
+    delete encoder->pq;
   }
   else
   {
-    fc[0]->FinishCompressor(0);
-    fc[1]->FinishCompressor(0);
-    fc[2]->FinishCompressor(0);
+    encoder->fc[0]->FinishCompressor(0);
+    encoder->fc[1]->FinishCompressor(0);
+    encoder->fc[2]->FinishCompressor(0);
+    delete encoder->fc[0];
+    delete encoder->fc[1];
+    delete encoder->fc[2];
   }
 
-  if (dv->size()) fprintf(stderr,"WARNING: there are %d unfinalized vertices\n",dv->size());
-  if (vertex_hash->size()-dv->size()) fprintf(stderr,"WARNING: %d unused vertices have not been compressed\n",vertex_hash->size()-dv->size());
+  if (encoder->dv->size()) fprintf(stderr,"WARNING: there are %d unfinalized vertices\n",encoder->dv->size());
+  if (encoder->vertex_hash->size()-encoder->dv->size()) fprintf(stderr,"WARNING: %d unused vertices have not been compressed\n",encoder->vertex_hash->size()-encoder->dv->size());
 
-  delete dv;
-  delete vertex_hash;
+  delete encoder->dv;
+  delete encoder->vertex_hash;
+  delete encoder->lc;
 
 #ifdef PRINT_CONTROL_OUTPUT
-  fprintf(stderr,"nfaces %d f_count %d ops %d\n",nfaces,f_count,op_start+op_add+op_join+op_fill_end);
-  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize %d\n",edge_buffer_size,edge_buffer_maxsize);
-  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize %d\n",vertex_buffer_size,vertex_buffer_maxsize);
-  fprintf(stderr,"op_start %d (%4.2f) op_add %d (%4.2f) od_join %d (%4.2f) op_fill %d (%4.2f) op_end %d (%4.2f)\n",op_start,100.0f*op_start/(op_start+op_add+op_join+op_fill_end),op_add,100.0f*op_add/(op_start+op_add+op_join+op_fill_end),op_join,100.0f*op_join/(op_start+op_add+op_join+op_fill_end),op_fill,100.0f*op_fill/(op_start+op_add+op_join+op_fill_end),op_end,100.0f*op_end/(op_start+op_add+op_join+op_fill_end));
-  fprintf(stderr,"add_miss %d add_hit %d (%d %d %d %d %d %d)\n",add_miss,add_hit[0]+add_hit[1]+add_hit[2]+add_hit[3]+add_hit[4]+add_hit[5],add_hit[0],add_hit[1],add_hit[2],add_hit[3],add_hit[4],add_hit[5]);
-  fprintf(stderr,"fill_miss %d fill_hit %d (%d %d %d %d %d %d %d %d %d)\n",fill_miss,fill_hit[0]+fill_hit[1]+fill_hit[2]+fill_hit[3]+fill_hit[4]+fill_hit[5]+fill_hit[6]+fill_hit[7]+fill_hit[8],fill_hit[0],fill_hit[1],fill_hit[2],fill_hit[3],fill_hit[4],fill_hit[5],fill_hit[6],fill_hit[7],fill_hit[8]);
-  fprintf(stderr,"used_index %d (%4.2f) used_cache %d  (%4.2f)\n",used_index,100.0f*used_index/(used_index+used_cache),used_cache,100.0f*used_cache/(used_index+used_cache));
+  encoder->printStats(nfaces, f_count);
 #endif
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
+
+  encoder->index_map = 0;
 
   v_count = -1;
   f_count = -1;
 }
 
+void SMwriter_smc::set_index_map(SMidx* map, int size)
+{
+  encoder->index_map = map;
+  encoder->index_map_size = size;
+  encoder->index_map_count = 0;
+}
+
+const SMstats* SMwriter_smc::get_stats() const
+{
+  return encoder->stats;
+}
+
 void SMwriter_smc::write_header()
 {
+#ifdef SM_64BIT_INDICES
+  encoder->index_64 = (nverts == -1 || nfaces == -1 || nverts > 0x7FFFFFFF || nfaces > 0x7FFFFFFF);
+#else
+  encoder->index_64 = false;
+#endif
+  // write version. the range encoder has not output anything yet
+  if (encoder->version_file)
+  {
+    fputc(encoder->version(), encoder->version_file);
+  }
+  else if (encoder->memory)
+  {
+    encoder->memory->put_byte(encoder->version());
+  }
+  // the header of the section layout is how many triangles each section has
+  if (encoder->triangles_per_section)
+  {
+    encoder->outputSectionInt(encoder->triangles_per_section);
+  }
   // write nverts
   if (nverts == -1)
   {
-    re_conn->encode(2,0);
+    encoder->re_conn->encode(2,0);
   }
   else
   {
-    re_conn->encode(2,1);
-    re_conn->encodeInt(nverts);
+    encoder->re_conn->encode(2,1);
+    encoder->re_conn->encodeInt((unsigned int)nverts);
+    if (encoder->index_64) encoder->re_conn->encodeInt((unsigned int)(((I64)nverts) >> 32));
   }
   // write nfaces
   if (nfaces == -1)
   {
-    re_conn->encode(2,0);
+    encoder->re_conn->encode(2,0);
   }
   else
   {
-    re_conn->encode(2,1);
-    re_conn->encodeInt(nfaces);
+    encoder->re_conn->encode(2,1);
+    encoder->re_conn->encodeInt((unsigned int)nfaces);
+    if (encoder->index_64) encoder->re_conn->encodeInt((unsigned int)(((I64)nfaces) >> 32));
   }
-  // write bounding box
+  // write bounding box. with sections it goes with the connectivity so
+  // that it is there for readers that skip the geometry
+  RangeEncoder* re_bb = (encoder->triangles_per_section ? encoder->re_conn : encoder->re_geom);
   if (bb_min_f == 0)
   {
-    re_geom->encode(2,0);
+    re_bb->encode(2,0);
   }
   else
   {
-    re_geom->encode(2,1);
-    re_geom->encodeFloat(bb_min_f[0]);
-    re_geom->encodeFloat(bb_min_f[1]);
-    re_geom->encodeFloat(bb_min_f[2]);
+    re_bb->encode(2,1);
+    re_bb->encodeFloat(bb_min_f[0]);
+    re_bb->encodeFloat(bb_min_f[1]);
+    re_bb->encodeFloat(bb_min_f[2]);
   }
   if (bb_max_f == 0)
   {
-    re_geom->encode(2,0);
+    re_bb->encode(2,0);
   }
   else
   {
-    re_geom->encode(2,1);
-    re_geom->encodeFloat(bb_max_f[0]);
-    re_geom->encodeFloat(bb_max_f[1]);
-    re_geom->encodeFloat(bb_max_f[2]);
+    re_bb->encode(2,1);
+    re_bb->encodeFloat(bb_max_f[0]);
+    re_bb->encodeFloat(bb_max_f[1]);
+    re_bb->encodeFloat(bb_max_f[2]);
   }
   // write comments
   if (true) // if have no comments
   {
-    re_conn->encode(2,0);
+    encoder->re_conn->encode(2,0);
   }
   else
   {
@@ -1433,7 +1767,7 @@ void SMwriter_smc::write_header()
   {
     if (true) // if want to use integer quantization
     {
-      re_conn->encode(2,0);
+      encoder->re_conn->encode(2,0);
     }
     else
     {
@@ -1444,25 +1778,25 @@ void SMwriter_smc::write_header()
     fprintf(stderr,"the bounding box is quantized to %d bits\n",nbits);
 #endif
 
-    pq = new PositionQuantizerNew();
-    pq->SetMinMax(bb_min_f, bb_max_f);
-    pq->SetPrecision(nbits);
-    pq->SetupQuantizer();
-
-    ic[0] = new IntegerCompressorNew();
-    ic[0]->SetRange(pq->m_aiQuantRange[0]);
-    ic[0]->SetPrecision(nbits);
-    ic[0]->SetupCompressor(re_geom);
-
-    ic[1] = new IntegerCompressorNew();
-    ic[1]->SetRange(pq->m_aiQuantRange[1]);
-    ic[1]->SetPrecision(nbits);
-    ic[1]->SetupCompressor(re_geom);
-
-    ic[2] = new IntegerCompressorNew();
-    ic[2]->SetRange(pq->m_aiQuantRange[2]);
-    ic[2]->SetPrecision(nbits);
-    ic[2]->SetupCompressor(re_geom);
+    encoder->pq = new PositionQuantizerNew();
+    encoder->pq->SetMinMax(bb_min_f, bb_max_f);
+    encoder->pq->SetPrecision(nbits);
+    encoder->pq->SetupQuantizer();
+
+    encoder->ic[0] = new IntegerCompressorNew();
+    encoder->ic[0]->SetRange(encoder->pq->m_aiQuantRange[0]);
+    encoder->ic[0]->SetPrecision(nbits);
+    encoder->ic[0]->SetupCompressor(encoder->re_geom);
+
+    encoder->ic[1] = new IntegerCompressorNew();
+    encoder->ic[1]->SetRange(encoder->pq->m_aiQuantRange[1]);
+    encoder->ic[1]->SetPrecision(nbits);
+    encoder->ic[1]->SetupCompressor(encoder->re_geom);
+
+    encoder->ic[2] = new IntegerCompressorNew();
+    encoder->ic[2]->SetRange(encoder->pq->m_aiQuantRange[2]);
+    encoder->ic[2]->SetPrecision(nbits);
+    encoder->ic[2]->SetupCompressor(encoder->re_geom);
   }
   else
   {
@@ -1471,18 +1805,18 @@ void SMwriter_smc::write_header()
     fprintf(stderr,"no bounding box! adaptive to %d bits\n",nbits);
 #endif
 
-    pq = 0;
-    fc[0] = new FloatCompressor();
-    fc[0]->SetPrecision(nbits);
-    fc[0]->SetupCompressor(re_geom,0);
+    encoder->pq = 0;
+    encoder->fc[0] = new FloatCompressor();
+    encoder->fc[0]->SetPrecision(nbits);
+    encoder->fc[0]->SetupCompressor(encoder->re_geom,0);
 
-    fc[1] = new FloatCompressor();
-    fc[1]->SetPrecision(nbits);
-    fc[1]->SetupCompressor(re_geom,0);
+    encoder->fc[1] = new FloatCompressor();
+    encoder->fc[1]->SetPrecision(nbits);
+    encoder->fc[1]->SetupCompressor(encoder->re_geom,0);
 
-    fc[2] = new FloatCompressor();
-    fc[2]->SetPrecision(nbits);
-    fc[2]->SetupCompressor(re_geom,0);
+    encoder->fc[2] = new FloatCompressor();
+    encoder->fc[2]->SetPrecision(nbits);
+    encoder->fc[2]->SetupCompressor(encoder->re_geom,0);
   }
 }
 
@@ -1500,10 +1834,14 @@ SMwriter_smc::SMwriter_smc()
 
   bb_min_f = 0;
   bb_max_f = 0;
+
+  encoder = new SMCencoder();
 }
 
 SMwriter_smc::~SMwriter_smc()
 {
+  delete encoder;
+
   // clean-up for SMwriter interface
   if (comments)
   {
@@ -46,6 +46,7 @@
 #include "vec3iv.h"
 
 #include <hash_map.h>
+#include "poolallocator.h"
 
 //#define PRINT_CONTROL_OUTPUT fprintf
 #define PRINT_DEBUG_OUTPUT if (0) fprintf
@@ -66,7 +67,7 @@ typedef struct SMvertex
   int dynamicvector; // used by dynamicvector data structure
   SMvertex* buffer_next;    // used for efficient memory management
   float v[3];
-  int index;
+  SMidx index;
   int use_count;
   int degree_one;
   int list_size;
@@ -83,11 +84,17 @@ typedef struct SMedge
   float across[3];
 } SMedge;
 
-typedef hash_map<int, SMvertex*> my_vertex_hash;
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_vertex_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_vertex_hash;
+#endif
 
 static my_vertex_hash* vertex_hash;
 
-static DynamicVector* dv;
+typedef DynamicVector<SMvertex,&SMvertex::dynamicvector> my_vertex_vector;
+
+static my_vertex_vector* dv;
 
 static LittleCache* lc;
  
@@ -171,7 +178,7 @@ static void initEncoder(FILE* file)
   }
 }
 
-static void finishEncoder(int nverts)
+static void finishEncoder(SMidx nverts)
 {
   if (re_conn != re_conn_op)
   {
@@ -542,12 +549,12 @@ void SMwriter_smc_old::add_comment(const char* comment)
   fprintf(stderr,"ERROR: add_comment not implemented\n");
 }
 
-void SMwriter_smc_old::set_nverts(int nverts)
+void SMwriter_smc_old::set_nverts(SMidx nverts)
 {
   this->nverts = nverts;
 }
 
-void SMwriter_smc_old::set_nfaces(int nfaces)
+void SMwriter_smc_old::set_nfaces(SMidx nfaces)
 {
   this->nfaces = nfaces;
 }
@@ -571,13 +578,13 @@ void SMwriter_smc_old::write_vertex(const float* v_pos_f)
   v_count++;
 }
 
-void SMwriter_smc_old::write_triangle(const int* t_idx)
+void SMwriter_smc_old::write_triangle(const SMidx* t_idx)
 {
-  fprintf(stderr, "ERROR: write_triangle(const int* t_idx) not supported by SMwriter_smc_old\n");
+  fprintf(stderr, "ERROR: write_triangle(const SMidx* t_idx) not supported by SMwriter_smc_old\n");
   exit(0);
 }
 
-void SMwriter_smc_old::write_triangle(const int* t_idx, const bool* t_final)
+void SMwriter_smc_old::write_triangle(const SMidx* t_idx, const bool* t_final)
 {
   if (v_count + f_count == 0) write_header();
 
@@ -592,7 +599,7 @@ void SMwriter_smc_old::write_triangle(const int* t_idx, const bool* t_final)
     hash_elements[i] = vertex_hash->find(t_idx[i]);
     if (hash_elements[i] == vertex_hash->end())
     {
-      fprintf(stderr,"ERROR: vertex %d not in hash\n",t_idx[i]);
+      fprintf(stderr,"ERROR: vertex " SM_IDX_FORMAT " not in hash\n",t_idx[i]);
       exit(0);
     }
     else
@@ -1202,9 +1209,9 @@ void SMwriter_smc_old::write_triangle(const int* t_idx, const bool* t_final)
   f_count++;
 }
 
-void SMwriter_smc_old::write_finalized(int final_idx)
+void SMwriter_smc_old::write_finalized(SMidx final_idx)
 {
-  fprintf(stderr, "ERROR: write_finalized(int final_idx) not supported by SMwriter_smc_old\n");
+  fprintf(stderr, "ERROR: write_finalized(SMidx final_idx) not supported by SMwriter_smc_old\n");
   exit(0);
 }
 
@@ -1213,7 +1220,7 @@ bool SMwriter_smc_old::open(FILE* file, int bits)
   initVertexBuffer(1024);
   initEdgeBuffer(1024);
   vertex_hash = new my_vertex_hash;
-  dv = new DynamicVector();
+  dv = new my_vertex_vector();
   lc = new LittleCache();
 
   initEncoder(file);
@@ -1261,8 +1268,8 @@ void SMwriter_smc_old::close()
   delete dv;
   delete vertex_hash;
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
 
   v_count = -1;
   f_count = -1;
@@ -1270,6 +1277,11 @@ void SMwriter_smc_old::close()
 
 void SMwriter_smc_old::write_header()
 {
+  if (nverts > 0x7FFFFFFF || nfaces > 0x7FFFFFFF)
+  {
+    fprintf(stderr,"ERROR: old SMC has 32 bit counts. use SMC or SMB for " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles\n", nverts, nfaces);
+    exit(1);
+  }
   // write nverts
   if (nverts == -1)
   {
@@ -1278,7 +1290,7 @@ void SMwriter_smc_old::write_header()
   else
   {
     re_conn->encode(2,1);
-    re_conn->encodeInt(nverts);
+    re_conn->encodeInt((unsigned int)nverts);
   }
   // write nfaces
   if (nfaces == -1)
@@ -1288,7 +1300,7 @@ void SMwriter_smc_old::write_header()
   else
   {
     re_conn->encode(2,1);
-    re_conn->encodeInt(nfaces);
+    re_conn->encodeInt((unsigned int)nfaces);
   }
   // write bounding box
   if (bb_min_f == 0)
@@ -44,8 +44,12 @@
 
 #include "vec3fv.h"
 #include "vec3iv.h"
+#include "smstats.h"
+#include "smtrace.h"
+#include "smmemory.h"
 
 #include <hash_map.h>
+#include "poolallocator.h"
 
 #define PRINT_DEBUG_OUTPUT if (0) fprintf
 #define PRINT_CONTROL_OUTPUT
@@ -65,9 +69,13 @@ struct SMtriangle;
 
 typedef struct SMvertex
 {
-  SMvertex* buffer_next;    // used for efficient memory management (and also for the dynamic vector)
+  union
+  {
+    SMvertex* buffer_next;  // used for efficient memory management
+    int dynamicvector;      // used by the dynamic vector
+  };
   // geometry
-  int index;
+  SMidx index;
   int use_total;
   float v[3];
   // incoming triangles
@@ -83,28 +91,44 @@ typedef struct SMvertex
 
 typedef struct SMtriangle
 {
-  SMtriangle* buffer_next;    // used for efficient memory management
+  union
+  {
+    SMtriangle* buffer_next;  // used for efficient memory management
+    int dynamicqueue;         // used by the waiting queue
+  };
   SMvertex* vertices[3];
 } SMtriangle;
 
 typedef struct SMedge
 {
-  SMedge* buffer_next;    // used for efficient memory management
+  union
+  {
+    SMedge* buffer_next;    // used for efficient memory management
+    int dynamicqueue;       // used by the traversal queue
+  };
   SMvertex* origin;
   SMvertex* target;
   float across[3];
 } SMedge;
 
-typedef hash_map<int, SMvertex*> my_hash;
+#ifdef _WIN32
+typedef hash_map<SMidx, SMvertex*> my_hash;
+#else
+typedef hash_map<SMidx, SMvertex*, __gnu_cxx::hash<SMidx>, std::equal_to<SMidx>, PoolAllocator<SMvertex*> > my_hash;
+#endif
 
 static my_hash* vertex_hash;
 
+typedef DynamicQueue<SMtriangle,&SMtriangle::dynamicqueue> my_triangle_queue;
+typedef DynamicQueue<SMedge,&SMedge::dynamicqueue> my_edge_queue;
+typedef DynamicVector<SMvertex,&SMvertex::dynamicvector> my_vertex_vector;
+
 static int next_waiting = 100;
-static DynamicQueue* waiting_queue; // for triangles ready to be encoded
-static DynamicQueue* traversal_queue; // for edges on the traversal front
+static my_triangle_queue* waiting_queue; // for triangles ready to be encoded
+static my_edge_queue* traversal_queue; // for edges on the traversal front
 static LittleCache* little_cache; // for subsequent traversal front misses?
 
-static DynamicVector* dv;
+static my_vertex_vector* dv;
 
 static PositionQuantizerNew* pq;
 static IntegerCompressorNew* ic[3];
@@ -125,6 +149,9 @@ static RangeEncoder* re_conn_final;
 
 static RangeEncoder* re_geom;
 
+// where the bytes go when compressing into memory
+static SMmemoryOutput* memory = 0;
+
 // is there more to encode
 static RangeModel* rmDone;
 
@@ -144,9 +171,9 @@ static RangeModel*** rmFinalized;
 
 static void initEncoder(FILE* file)
 {
-  if (file)
+  if (file || memory)
   {
-    re_conn = new RangeEncoder(file);
+    re_conn = (memory ? new RangeEncoder(*memory) : new RangeEncoder(file));
     re_conn_rl = re_conn;
     re_conn_op = re_conn;
     re_conn_index = re_conn;
@@ -164,7 +191,7 @@ static void initEncoder(FILE* file)
   }
 }
 
-static void finishEncoder(int nverts)
+static void finishEncoder(SMidx nverts)
 {
   if (re_conn != re_conn_op)
   {
@@ -204,6 +231,13 @@ static void finishEncoder(int nverts)
 #endif
     delete re_conn;
   }
+
+  if (memory)
+  {
+    memory->close();
+    delete memory;
+    memory = 0;
+  }
 }
 
 static void initModels(int compress)
@@ -279,36 +313,32 @@ static void finishModels()
 
 // statistics
 
-#ifdef PRINT_CONTROL_OUTPUT
-static int op_start = 0;
-static int op_add = 0;
-static int op_join = 0;
-static int op_fill = 0;
-static int op_end = 0;
-static int op_skip = 0;
-static int op_border = 0;
-
-static int used_index = 0;
-
-static int prediction_none = 0;
-static int prediction_last = 0;
-static int prediction_across = 0;
-
-static int right_confirm = 0;
-static int right_correct = 0;
-static int left_confirm = 0;
-static int left_correct = 0;
-
-static int max_in_width = 0;
-static int max_in_span = 0;
-static int max_out_width = 0;
-static int max_out_span = 0;
-static int v_out_count = 0;
-
-static int vertex_buffer_maxsize = 0;
-static int edge_buffer_maxsize = 0;
-static int triangle_buffer_maxsize = 0;
-#endif
+static SMstats stats("SMwriter_smd");
+
+static int stat_op_start;
+static int stat_op_add;
+static int stat_op_join;
+static int stat_op_fill;
+static int stat_op_end;
+static int stat_op_skip;
+static int stat_op_border;
+static int stat_used_index;
+static int stat_prediction_none;
+static int stat_prediction_last;
+static int stat_prediction_across;
+static int stat_right_confirm;
+static int stat_right_correct;
+static int stat_left_confirm;
+static int stat_left_correct;
+static int stat_vertex_buffer;
+static int stat_edge_buffer;
+static int stat_triangle_buffer;
+static int stat_in_width;
+static int stat_out_width;
+static int stat_in_span;
+static int stat_out_span;
+
+static SMidx v_out_count = 0;
 
 // efficient memory allocation
 
@@ -377,9 +407,7 @@ static SMvertex* allocVertex()
 
   vertex_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_buffer_size > vertex_buffer_maxsize) vertex_buffer_maxsize = vertex_buffer_size;
-#endif
+  stats.level(stat_vertex_buffer, vertex_buffer_size);
 
   return vertex;
 }
@@ -389,6 +417,7 @@ static void deallocVertex(SMvertex* vertex)
   vertex->buffer_next = vertex_buffer_next;
   vertex_buffer_next = vertex;
   vertex_buffer_size--;
+  stats.down(stat_vertex_buffer);
 }
 
 static int edge_buffer_size = 0;
@@ -441,9 +470,7 @@ static SMedge* allocEdge(float* v)
 
   edge_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (edge_buffer_size > edge_buffer_maxsize) edge_buffer_maxsize = edge_buffer_size;
-#endif
+  stats.level(stat_edge_buffer, edge_buffer_size);
 
   return edge;
 }
@@ -453,6 +480,7 @@ static void deallocEdge(SMedge* edge)
   edge->buffer_next = edge_buffer_next;
   edge_buffer_next = edge;
   edge_buffer_size--;
+  stats.down(stat_edge_buffer);
 }
 
 static int triangle_buffer_size = 0;
@@ -501,9 +529,7 @@ static SMtriangle* allocTriangle()
 
   triangle_buffer_size++;
   
-#ifdef PRINT_CONTROL_OUTPUT
-  if (triangle_buffer_size > triangle_buffer_maxsize) triangle_buffer_maxsize = triangle_buffer_size;
-#endif
+  stats.level(stat_triangle_buffer, triangle_buffer_size);
 
   return triangle;
 }
@@ -513,15 +539,14 @@ static void deallocTriangle(SMtriangle* triangle)
   triangle->buffer_next = triangle_buffer_next;
   triangle_buffer_next = triangle;
   triangle_buffer_size--;
+  stats.down(stat_triangle_buffer);
 }
 
 // helper functions
 
 static void compressVertexPosition(float* n)
 {
-#ifdef PRINT_CONTROL_OUTPUT
-  prediction_none++;
-#endif
+  stats.count(stat_prediction_none);
 
   if (pq)
   {
@@ -542,9 +567,7 @@ static void compressVertexPosition(float* n)
 
 static void compressVertexPosition(float* l, float* n)
 {
-#ifdef PRINT_CONTROL_OUTPUT
-  prediction_last++;
-#endif
+  stats.count(stat_prediction_last);
 
   if (pq)
   {
@@ -565,9 +588,7 @@ static void compressVertexPosition(float* l, float* n)
 
 static void compressVertexPosition(const float* a, const float* b, const float* c, float* n)
 {
-#ifdef PRINT_CONTROL_OUTPUT
-  prediction_across++;
-#endif
+  stats.count(stat_prediction_across);
 
   if (pq)
   {
@@ -663,12 +684,12 @@ void SMwriter_smd::add_comment(const char* comment)
   fprintf(stderr,"WARNING: add_comments not yet implemented\n");
 }
 
-void SMwriter_smd::set_nverts(int nverts)
+void SMwriter_smd::set_nverts(SMidx nverts)
 {
   this->nverts = nverts;
 }
 
-void SMwriter_smd::set_nfaces(int nfaces)
+void SMwriter_smd::set_nfaces(SMidx nfaces)
 {
   this->nfaces = nfaces;
 }
@@ -699,11 +720,9 @@ void SMwriter_smd::write_vertex(const float* v_pos_f)
 {
   SMvertex* vertex = allocVertex();
   VecCopy3fv(vertex->v, v_pos_f);
-  vertex_hash->insert(my_hash::value_type(v_count, vertex));
+  sm_trace_hash_insert(vertex_hash, my_hash::value_type(v_count, vertex), "SMwriter_smd::vertex_hash");
   v_count++;
-#ifdef PRINT_CONTROL_OUTPUT
-  if (vertex_hash->size() > max_in_width) max_in_width = vertex_hash->size();
-#endif
+  stats.level(stat_in_width, vertex_hash->size());
 }
 
 bool SMwriter_smd::compress_triangle_waiting()
@@ -718,7 +737,7 @@ bool SMwriter_smd::compress_triangle_waiting()
   SMvertex* vertex;
   SMvertex* vertices[3];
 
-  SMtriangle* triangle = (SMtriangle*)waiting_queue->getAndRemoveFirstElement();
+  SMtriangle* triangle = waiting_queue->getAndRemoveFirstElement();
 
   // are vertices already visited
   int num_v_visited = 0;
@@ -773,9 +792,7 @@ bool SMwriter_smd::compress_triangle_waiting()
 
   if (num_e_visited == 0) // start
   {
-#ifdef PRINT_CONTROL_OUTPUT
-    op_start++;
-#endif
+    stats.count(stat_op_start);
 
     if (dv->size() == 0)
     {
@@ -820,9 +837,7 @@ bool SMwriter_smd::compress_triangle_waiting()
       // encode its index among all active vertices
       i = dv->getRelativeIndex(vertices[0]);
       re_conn_index->encode(dv->size(),i);
-#ifdef PRINT_CONTROL_OUTPUT
-      used_index++;
-#endif
+      stats.count(stat_used_index);
       PRINT_DEBUG_OUTPUT(stderr, "SNM0 ");
     }
     else
@@ -831,11 +846,9 @@ bool SMwriter_smd::compress_triangle_waiting()
       compressVertexPosition(vertices[0]->v);
       // insert it into the indexable data structure
       dv->addElement(vertices[0]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if (dv->size() > max_out_width) max_out_width = dv->size();
+      stats.level(stat_out_width, dv->size());
       vertices[0]->index = v_out_count;
       v_out_count++;
-#endif
     }
 
     // encode vertex v1
@@ -845,9 +858,7 @@ bool SMwriter_smd::compress_triangle_waiting()
       // encode its index among all active vertices
       i = dv->getRelativeIndex(vertices[1]);
       re_conn_index->encode(dv->size(),i);        
-#ifdef PRINT_CONTROL_OUTPUT
-      used_index++;
-#endif
+      stats.count(stat_used_index);
       PRINT_DEBUG_OUTPUT(stderr, "SNM1 ");
     }
     else
@@ -856,11 +867,9 @@ bool SMwriter_smd::compress_triangle_waiting()
       compressVertexPosition(vertices[0]->v, vertices[1]->v);
       // insert it into the indexable data structure
       dv->addElement(vertices[1]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if (dv->size() > max_out_width) max_out_width = dv->size();
+      stats.level(stat_out_width, dv->size());
       vertices[1]->index = v_out_count;
       v_out_count++;
-#endif
     }
 
     // encode vertex v2
@@ -870,9 +879,7 @@ bool SMwriter_smd::compress_triangle_waiting()
       // encode its index among all active vertices
       i = dv->getRelativeIndex(vertices[2]);
       re_conn_index->encode(dv->size(),i);        
-#ifdef PRINT_CONTROL_OUTPUT
-      used_index++;
-#endif
+      stats.count(stat_used_index);
       PRINT_DEBUG_OUTPUT(stderr, "SNM2 ");
     }
     else
@@ -881,28 +888,22 @@ bool SMwriter_smd::compress_triangle_waiting()
       compressVertexPosition(vertices[0]->v, vertices[2]->v);
       // insert it into the indexable data structure
       dv->addElement(vertices[2]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if (dv->size() > max_out_width) max_out_width = dv->size();
+      stats.level(stat_out_width, dv->size());
       vertices[2]->index = v_out_count;
       v_out_count++;
-#endif
     }
   }
   else if (num_e_visited == 1) // add or join
   {
     if (num_v_visited == 2) // add
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_add++;
-#endif
+      stats.count(stat_op_add);
       re_conn_op->encode(rmWaitingOp, SMC_ADD);
       PRINT_DEBUG_OUTPUT(stderr, "w%d ", SMC_ADD);
     }
     else
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_join++;
-#endif
+      stats.count(stat_op_join);
       re_conn_op->encode(rmWaitingOp, SMC_JOIN);
       PRINT_DEBUG_OUTPUT(stderr, "w%d ", SMC_JOIN);
     }
@@ -924,9 +925,7 @@ bool SMwriter_smd::compress_triangle_waiting()
     // encode the index of v0
     i = dv->getRelativeIndex(vertices[0]);
     re_conn_index->encode(dv->size(),i);        
-#ifdef PRINT_CONTROL_OUTPUT
-    used_index++;
-#endif
+    stats.count(stat_used_index);
     PRINT_DEBUG_OUTPUT(stderr, "m%d ", i);
 
     // encode which of the edges incident to v0 is e0
@@ -955,9 +954,7 @@ bool SMwriter_smd::compress_triangle_waiting()
       // encode its index among all active vertices
       i = dv->getRelativeIndex(vertices[2]);
       re_conn_index->encode(dv->size(),i);        
-#ifdef PRINT_CONTROL_OUTPUT
-      used_index++;
-#endif
+      stats.count(stat_used_index);
       PRINT_DEBUG_OUTPUT(stderr, "J %d ",i);
     }
     else // add
@@ -966,11 +963,9 @@ bool SMwriter_smd::compress_triangle_waiting()
       compressVertexPosition(vertices[0]->v, edges[0]->across, vertices[1]->v, vertices[2]->v);
       // insert it into the indexable data structure
       dv->addElement(vertices[2]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if (dv->size() > max_out_width) max_out_width = dv->size();
+      stats.level(stat_out_width, dv->size());
       vertices[2]->index = v_out_count;
       v_out_count++;
-#endif
     }
   }
   else // fill or end
@@ -999,9 +994,7 @@ bool SMwriter_smd::compress_triangle_waiting()
     // encode the index of v0
     i = dv->getRelativeIndex(vertices[0]);
     re_conn_index->encode(dv->size(),i);
-#ifdef PRINT_CONTROL_OUTPUT
-    used_index++;
-#endif
+    stats.count(stat_used_index);
     PRINT_DEBUG_OUTPUT(stderr, "m%d ", i);
 
     // encode edge e0 (e.g. the edge from v0 to v1)
@@ -1044,16 +1037,14 @@ bool SMwriter_smd::compress_triangle_waiting()
       PRINT_DEBUG_OUTPUT(stderr, "c%d:%d ",candidate_count,candidate);
     }
 
-#ifdef PRINT_CONTROL_OUTPUT
     if (num_e_visited == 2)
     {
-      op_fill++;
+      stats.count(stat_op_fill);
     }
     else
     {
-      op_end++;
+      stats.count(stat_op_end);
     }
-#endif
   }
 
   // increment vertex use_counts, create edges, and update edge degrees
@@ -1073,7 +1064,7 @@ bool SMwriter_smd::compress_triangle_waiting()
     }
     else
     {
-      if (((int*)edges[i])[0] >= 0)
+      if (edges[i]->dynamicqueue >= 0)
       {
         traversal_queue->removeElement(edges[i]);
       }
@@ -1114,12 +1105,10 @@ bool SMwriter_smd::compress_triangle_waiting()
         {
           removeEdgeFromVertex(edge, edge->origin);
         }
-        if (((int*)edge)[0] >= 0) traversal_queue->removeElement(edge);
+        if (edge->dynamicqueue >= 0) traversal_queue->removeElement(edge);
         deallocEdge(edge);
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      if ((v_out_count-vertex->index+1) > max_out_span) max_out_span = (v_out_count-vertex->index+1);
-#endif
+      stats.sample(stat_out_span, (int)(v_out_count-vertex->index+1));
       deallocVertex(vertex);
     }
     else
@@ -1142,7 +1131,7 @@ bool SMwriter_smd::compress_triangle_traversal()
 
   SMtriangle* triangle;
   SMvertex* vertex;
-  SMedge* edge = (SMedge*)traversal_queue->getAndRemoveFirstElement();
+  SMedge* edge = traversal_queue->getAndRemoveFirstElement();
 
   // check if there is a triangle for us to compress
   vertices[0] = edge->target;
@@ -1171,9 +1160,7 @@ bool SMwriter_smd::compress_triangle_traversal()
   {
     if ((vertices[0]->use_total > 0) && (vertices[1]->use_total > 0)) // because it is a border edge
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_border++;
-#endif
+      stats.count(stat_op_border);
       i = (vertices[0]->use_count < MAX_USE_COUNT_OP)?vertices[0]->use_count:MAX_USE_COUNT_OP-1;
       j = (vertices[1]->use_count < MAX_USE_COUNT_OP)?vertices[1]->use_count:MAX_USE_COUNT_OP-1;
       re_conn_op->encode(rmTraversalOp[i][j], SMC_BORDER); 
@@ -1188,13 +1175,11 @@ bool SMwriter_smd::compress_triangle_traversal()
     }
     else // because it may come later 
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_skip++;
-#endif
+      stats.count(stat_op_skip);
       i = (vertices[0]->use_count < MAX_USE_COUNT_OP)?vertices[0]->use_count:MAX_USE_COUNT_OP-1;
       j = (vertices[1]->use_count < MAX_USE_COUNT_OP)?vertices[1]->use_count:MAX_USE_COUNT_OP-1;
       re_conn_op->encode(rmTraversalOp[i][j], SMC_SKIP); 
-      ((int*)edge)[0] = -1; // mark element as no longer being in the queue
+      edge->dynamicqueue = -1; // mark element as no longer being in the queue
       PRINT_DEBUG_OUTPUT(stderr, "t%d:%d:%d ",i,j,SMC_SKIP);
       return false;
     }
@@ -1238,22 +1223,16 @@ bool SMwriter_smd::compress_triangle_traversal()
         i = 1;
         PRINT_DEBUG_OUTPUT(stderr, "r0 ");
         re_conn_rl->encode(rmRight, 0); // confirm
-#ifdef PRINT_CONTROL_OUTPUT
-        right_confirm++;
-#endif
+        stats.count(stat_right_confirm);
       }
       else
       {
         i = 0;
         PRINT_DEBUG_OUTPUT(stderr, "l0 ");
         re_conn_rl->encode(rmLeft, 0); // confirm
-#ifdef PRINT_CONTROL_OUTPUT
-        left_confirm++;
-#endif
+        stats.count(stat_left_confirm);
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      op_end++;
-#endif
+      stats.count(stat_op_end);
     }
     else
     {
@@ -1264,18 +1243,14 @@ bool SMwriter_smd::compress_triangle_traversal()
           i = 1;
           PRINT_DEBUG_OUTPUT(stderr, "r0 ");
           re_conn_rl->encode(rmRight, 0); // confirm
-#ifdef PRINT_CONTROL_OUTPUT
-          right_confirm++;
-#endif
+          stats.count(stat_right_confirm);
         }
         else
         {
           i = 0;
           PRINT_DEBUG_OUTPUT(stderr, "r1 ");
           re_conn_rl->encode(rmRight, 1); // correct
-#ifdef PRINT_CONTROL_OUTPUT
-          right_correct++;
-#endif
+          stats.count(stat_right_correct);
         }
       }
       else
@@ -1285,23 +1260,17 @@ bool SMwriter_smd::compress_triangle_traversal()
           i = 0;
           PRINT_DEBUG_OUTPUT(stderr, "l0 ");
           re_conn_rl->encode(rmLeft, 0); // confirm
-#ifdef PRINT_CONTROL_OUTPUT
-          left_confirm++;
-#endif
+          stats.count(stat_left_confirm);
         }
         else
         {
           i = 1;
           PRINT_DEBUG_OUTPUT(stderr, "l1 ");
           re_conn_rl->encode(rmLeft, 1); // correct
-#ifdef PRINT_CONTROL_OUTPUT
-          left_correct++;
-#endif
+          stats.count(stat_left_correct);
         }
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      op_fill++;
-#endif
+      stats.count(stat_op_fill);
     }
 
     if (i == 1)
@@ -1351,9 +1320,7 @@ bool SMwriter_smd::compress_triangle_traversal()
     // encode v2
     if (vertices[2]->use_count)
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_join++;
-#endif
+      stats.count(stat_op_join);
       i = (vertices[0]->use_count < MAX_USE_COUNT_OP)?vertices[0]->use_count:MAX_USE_COUNT_OP-1;
       j = (vertices[1]->use_count < MAX_USE_COUNT_OP)?vertices[1]->use_count:MAX_USE_COUNT_OP-1;
       re_conn_op->encode(rmTraversalOp[i][j], SMC_JOIN); 
@@ -1366,9 +1333,7 @@ bool SMwriter_smd::compress_triangle_traversal()
     }
     else
     {
-#ifdef PRINT_CONTROL_OUTPUT
-      op_add++;
-#endif
+      stats.count(stat_op_add);
       i = (vertices[0]->use_count < MAX_USE_COUNT_OP)?vertices[0]->use_count:MAX_USE_COUNT_OP-1;
       j = (vertices[1]->use_count < MAX_USE_COUNT_OP)?vertices[1]->use_count:MAX_USE_COUNT_OP-1;
       re_conn_op->encode(rmTraversalOp[i][j], SMC_ADD); 
@@ -1378,11 +1343,9 @@ bool SMwriter_smd::compress_triangle_traversal()
       compressVertexPosition(vertices[0]->v, edges[0]->across, vertices[1]->v, vertices[2]->v);
       // insert it into the indexable data structure
       dv->addElement(vertices[2]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if (dv->size() > max_out_width) max_out_width = dv->size();
+      stats.level(stat_out_width, dv->size());
       vertices[2]->index = v_out_count;
       v_out_count++;
-#endif
     }
   }
 
@@ -1406,10 +1369,10 @@ bool SMwriter_smd::compress_triangle_traversal()
     }
     else
     {
-      if (((int*)edges[i])[0] >= 0)
+      if (edges[i]->dynamicqueue >= 0)
       {
         traversal_queue->removeElement(edges[i]);
-        ((int*)edges[i])[0] = -1;
+        edges[i]->dynamicqueue = -1;
       }
       removeEdgeFromVertices(edges[i]);
       deallocEdge(edges[i]);
@@ -1452,12 +1415,10 @@ bool SMwriter_smd::compress_triangle_traversal()
         {
           removeEdgeFromVertex(edge, edge->origin);
         }
-        if (((int*)edge)[0] >= 0) traversal_queue->removeElement(edge);
+        if (edge->dynamicqueue >= 0) traversal_queue->removeElement(edge);
         deallocEdge(edge);
       }
-#ifdef PRINT_CONTROL_OUTPUT
-      if ((v_out_count-vertex->index+1) > max_out_span) max_out_span = (v_out_count-vertex->index+1);
-#endif
+      stats.sample(stat_out_span, (int)(v_out_count-vertex->index+1));
       deallocVertex(vertex);
     }
     else
@@ -1497,13 +1458,13 @@ bool SMwriter_smd::compress_triangle()
   return false;
 }
 
-void SMwriter_smd::write_triangle(const int* t_idx)
+void SMwriter_smd::write_triangle(const SMidx* t_idx)
 {
   bool t_final[] = {false, false, false};
   write_triangle(t_idx, t_final);
 }
 
-void SMwriter_smd::write_triangle(const int* t_idx, const bool* t_final)
+void SMwriter_smd::write_triangle(const SMidx* t_idx, const bool* t_final)
 {
   if (f_count == 0) write_header();
 
@@ -1518,7 +1479,7 @@ void SMwriter_smd::write_triangle(const int* t_idx, const bool* t_final)
     if (hash_elements[i] == vertex_hash->end())
     {
       triangle->vertices[i] = allocVertex();
-      vertex_hash->insert(my_hash::value_type(t_idx[i], triangle->vertices[i]));
+      sm_trace_hash_insert(vertex_hash, my_hash::value_type(t_idx[i], triangle->vertices[i]), "SMwriter_smd::vertex_hash");
     }
     else
     {
@@ -1534,9 +1495,7 @@ void SMwriter_smd::write_triangle(const int* t_idx, const bool* t_final)
     {
       triangle->vertices[i]->use_total *= -1;
       vertex_hash->erase(hash_elements[i]);
-#ifdef PRINT_CONTROL_OUTPUT
-      if ((v_count - t_idx[i] + 1) > max_in_span) max_in_span = (v_count - t_idx[i] + 1);
-#endif
+      stats.sample(stat_in_span, (int)(v_count - t_idx[i] + 1));
     }
   }
 
@@ -1562,12 +1521,12 @@ void SMwriter_smd::write_triangle(const int* t_idx, const bool* t_final)
   f_count++;
 }
 
-void SMwriter_smd::write_finalized(int final_idx)
+void SMwriter_smd::write_finalized(SMidx final_idx)
 {
   my_hash::iterator hash_element = vertex_hash->find(final_idx);
   if (hash_element == vertex_hash->end())
   {
-    fprintf(stderr,"FATAL ERROR: finalized vertex %d not in hash\n",final_idx);
+    fprintf(stderr,"FATAL ERROR: finalized vertex " SM_IDX_FORMAT " not in hash\n",final_idx);
     exit(0);
   }
   (*hash_element).second->use_total *= -1;
@@ -1576,6 +1535,54 @@ void SMwriter_smd::write_finalized(int final_idx)
 
 #define SM_VERSION 2 // this is SMD
 
+bool SMwriter_smd::open(unsigned char** bytes, size_t* nbytes, int bits, int delay)
+{
+  memory = new SMmemoryOutput();
+  if (!memory->open(bytes, nbytes))
+  {
+    delete memory;
+    memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, delay);
+}
+
+bool SMwriter_smd::open(void* bytes, size_t nalloc, size_t* nbytes, int bits, int delay)
+{
+  memory = new SMmemoryOutput();
+  if (!memory->open(bytes, nalloc, nbytes))
+  {
+    delete memory;
+    memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, delay);
+}
+
+bool SMwriter_smd::open(unsigned char** bytes, int* nbytes, int bits, int delay)
+{
+  memory = new SMmemoryOutput();
+  if (!memory->open(bytes, nbytes))
+  {
+    delete memory;
+    memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, delay);
+}
+
+bool SMwriter_smd::open(unsigned char* bytes, int nalloc, int* nbytes, int bits, int delay)
+{
+  memory = new SMmemoryOutput();
+  if (!memory->open(bytes, nalloc, nbytes))
+  {
+    delete memory;
+    memory = 0;
+    return false;
+  }
+  return open((FILE*)0, bits, delay);
+}
+
 bool SMwriter_smd::open(FILE* file, int bits, int delay)
 {
   // write version
@@ -1583,16 +1590,45 @@ bool SMwriter_smd::open(FILE* file, int bits, int delay)
   {
     fputc(SM_VERSION, file);
   }
+  else if (memory)
+  {
+    memory->put_byte(SM_VERSION);
+  }
+
+  stat_op_start = stats.add("op_start");
+  stat_op_add = stats.add("op_add");
+  stat_op_join = stats.add("op_join");
+  stat_op_fill = stats.add("op_fill");
+  stat_op_end = stats.add("op_end");
+  stat_op_skip = stats.add("op_skip");
+  stat_op_border = stats.add("op_border");
+  stat_used_index = stats.add("used_index");
+  stat_prediction_none = stats.add("prediction_none");
+  stat_prediction_last = stats.add("prediction_last");
+  stat_prediction_across = stats.add("prediction_across");
+  stat_right_confirm = stats.add("right_confirm");
+  stat_right_correct = stats.add("right_correct");
+  stat_left_confirm = stats.add("left_confirm");
+  stat_left_correct = stats.add("left_correct");
+  stat_vertex_buffer = stats.add("vertex_buffer", SM_STATS_LEVEL);
+  stat_edge_buffer = stats.add("edge_buffer", SM_STATS_LEVEL);
+  stat_triangle_buffer = stats.add("triangle_buffer", SM_STATS_LEVEL);
+  stat_in_width = stats.add("in_width", SM_STATS_LEVEL);
+  stat_out_width = stats.add("out_width", SM_STATS_LEVEL);
+  stat_in_span = stats.add("in_span", SM_STATS_LOG2);
+  stat_out_span = stats.add("out_span", SM_STATS_LOG2);
+  stats.reset();
+  v_out_count = 0;
 
   initVertexBuffer(1024);
   initEdgeBuffer(1024);
   initTriangleBuffer(1024);
 
-  waiting_queue = new DynamicQueue();
-  traversal_queue = new DynamicQueue();
+  waiting_queue = new my_triangle_queue();
+  traversal_queue = new my_edge_queue();
   little_cache = new LittleCache();
 
-  dv = new DynamicVector();
+  dv = new my_vertex_vector();
   vertex_hash = new my_hash;
 
   initEncoder(file);
@@ -1656,30 +1692,40 @@ void SMwriter_smd::close()
   if (vertex_hash->size()-dv->size()) fprintf(stderr,"WARNING: there are %d unused vertices\n         these vertices have not been compressed\n",vertex_hash->size()-dv->size());
 
 #ifdef PRINT_CONTROL_OUTPUT
-  fprintf(stderr,"none: %d last %d across %d\n", prediction_none, prediction_last, prediction_across);
-  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize %d\n",edge_buffer_size,edge_buffer_maxsize);
-  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize %d\n",vertex_buffer_size,vertex_buffer_maxsize);
-  fprintf(stderr,"triangle_buffer_size %d triangle_buffer_maxsize %d\n",triangle_buffer_size,triangle_buffer_maxsize);
-  fprintf(stderr,"right_confirm %d right_correct %d left_confirm %d left_correct %d\n",right_confirm,right_correct,left_confirm, left_correct);
-  fprintf(stderr,"op_start %d op_add %d op_join %d op_fill %d op_end %d op_skip %d op_border %d\n",op_start,op_add,op_join,op_fill,op_end,op_skip,op_border);
-  fprintf(stderr,"op_skip f_count *100 = %6.4f \n",100.0f*(float)op_skip/(float)f_count);
-
-  fprintf(stderr,"%d %d max_in_width %d max_out_width %d diff %6.3f\n",vertex_hash->size(),dv->size(),max_in_width,max_out_width,100.0f*(max_out_width-max_in_width)/max_in_width);
-  fprintf(stderr,"max_in_span %d max_out_span %d diff  %6.3f \n",max_in_span,max_out_span,100.0f*(max_out_span-max_in_span)/max_in_span);
+  fprintf(stderr,"none: " SM_COUNT_FORMAT " last " SM_COUNT_FORMAT " across " SM_COUNT_FORMAT "\n", stats.value(stat_prediction_none), stats.value(stat_prediction_last), stats.value(stat_prediction_across));
+  fprintf(stderr,"edge_buffer_size %d edge_buffer_maxsize " SM_COUNT_FORMAT "\n",edge_buffer_size,stats.max(stat_edge_buffer));
+  fprintf(stderr,"vertex_buffer_size %d vertex_buffer_maxsize " SM_COUNT_FORMAT "\n",vertex_buffer_size,stats.max(stat_vertex_buffer));
+  fprintf(stderr,"triangle_buffer_size %d triangle_buffer_maxsize " SM_COUNT_FORMAT "\n",triangle_buffer_size,stats.max(stat_triangle_buffer));
+  fprintf(stderr,"right_confirm " SM_COUNT_FORMAT " right_correct " SM_COUNT_FORMAT " left_confirm " SM_COUNT_FORMAT " left_correct " SM_COUNT_FORMAT "\n",stats.value(stat_right_confirm),stats.value(stat_right_correct),stats.value(stat_left_confirm), stats.value(stat_left_correct));
+  fprintf(stderr,"op_start " SM_COUNT_FORMAT " op_add " SM_COUNT_FORMAT " op_join " SM_COUNT_FORMAT " op_fill " SM_COUNT_FORMAT " op_end " SM_COUNT_FORMAT " op_skip " SM_COUNT_FORMAT " op_border " SM_COUNT_FORMAT "\n",stats.value(stat_op_start),stats.value(stat_op_add),stats.value(stat_op_join),stats.value(stat_op_fill),stats.value(stat_op_end),stats.value(stat_op_skip),stats.value(stat_op_border));
+  fprintf(stderr,"op_skip f_count *100 = %6.4f \n",100.0f*(float)stats.value(stat_op_skip)/(float)f_count);
+
+  fprintf(stderr,"%d %d max_in_width " SM_COUNT_FORMAT " max_out_width " SM_COUNT_FORMAT " diff %6.3f\n",vertex_hash->size(),dv->size(),stats.max(stat_in_width),stats.max(stat_out_width),100.0f*(stats.max(stat_out_width)-stats.max(stat_in_width))/stats.max(stat_in_width));
+  fprintf(stderr,"max_in_span " SM_COUNT_FORMAT " max_out_span " SM_COUNT_FORMAT " diff  %6.3f \n",stats.max(stat_in_span),stats.max(stat_out_span),100.0f*(stats.max(stat_out_span)-stats.max(stat_in_span))/stats.max(stat_in_span));
 #endif
 
   delete dv;
   delete vertex_hash;
 
-  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts %d but v_count %d\n",nverts,v_count);
-  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces %d but f_count %d\n",nfaces,f_count);
+  if (nverts != -1) if (nverts != v_count)  fprintf(stderr,"WARNING: set nverts " SM_IDX_FORMAT " but v_count " SM_IDX_FORMAT "\n",nverts,v_count);
+  if (nfaces != -1) if (nfaces != f_count)  fprintf(stderr,"WARNING: set nfaces " SM_IDX_FORMAT " but f_count " SM_IDX_FORMAT "\n",nfaces,f_count);
 
   v_count = -1;
   f_count = -1;
 }
 
+const SMstats* SMwriter_smd::get_stats() const
+{
+  return &stats;
+}
+
 void SMwriter_smd::write_header()
 {
+  if (nverts > 0x7FFFFFFF || nfaces > 0x7FFFFFFF)
+  {
+    fprintf(stderr,"ERROR: SMD has 32 bit counts. use SMC or SMB for " SM_IDX_FORMAT " vertices and " SM_IDX_FORMAT " triangles\n", nverts, nfaces);
+    exit(1);
+  }
   // write nverts
   if (nverts == -1)
   {
@@ -1688,7 +1734,7 @@ void SMwriter_smd::write_header()
   else
   {
     re_conn->encode(2,1);
-    re_conn->encodeInt(nverts);
+    re_conn->encodeInt((unsigned int)nverts);
   }
   // write nfaces
   if (nfaces == -1)
@@ -1698,7 +1744,7 @@ void SMwriter_smd::write_header()
   else
   {
     re_conn->encode(2,1);
-    re_conn->encodeInt(nfaces);
+    re_conn->encodeInt((unsigned int)nfaces);
   }
   // write bounding box
   if (bb_min_f == 0)
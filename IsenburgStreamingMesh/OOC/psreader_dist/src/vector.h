@@ -2,65 +2,272 @@
 ===============================================================================
 
   FILE:  tscvector.h
-  
+
   CONTENTS:
-  
+
     Triangle Strip Compression - GI 2000 demonstration software
-  
+
+    a growable vector of pointers. it is templated on the element type so that
+    all operations can be inlined and the callers do not need to cast.
+
   PROGRAMMERS:
-  
+
     Martin Isenburg@cs.unc.edu
-  
+
   COPYRIGHT:
-  
+
     Copyright (C) 2000  Martin Isenburg (isenburg@cs.unc.edu)
-    
+
     This software is distributed in the hope that it will be useful,
     but WITHOUT ANY WARRANTY; without even the implied warranty of
     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
-  
+
   CHANGE HISTORY:
-  
+
+    19 October 2026 -- templated on element type, now inlined
     28 June 2000 -- Martin - finalized for GI submission.
-  
+
 ===============================================================================
 */
 #ifndef TSC_VECTOR_H
 #define TSC_VECTOR_H
 
+#include <stdio.h>
+#include <stdlib.h>
+
+template <class T>
 class TSCvector
 {
 public:
   TSCvector();
   ~TSCvector();
 
-  int isEmpty();
-  int isElement(void *);
-  
+  inline int isEmpty() const;
+  int isElement(const T*) const;
+
   void ensureCapacity(int);
-  
-  int size() const;
-  void setSize(int s);
-  
-  void* elementAt(int) const;
-  void* lastElement();
-  
-  void addElement(void*);
-  void setElementAt(void*, int);
-  void insertElementAt(void*, int);
-  
-  void removeElement(void*);
+
+  inline int size() const;
+  inline void setSize(int s);
+
+  inline T* elementAt(int) const;
+  inline T* lastElement() const;
+
+  inline void addElement(T*);
+  inline void setElementAt(T*, int);
+  void insertElementAt(T*, int);
+
+  void removeElement(const T*);
   void removeElementAt(int);
-  void removeLastElement();
-  void removeAllElements();
+  inline void removeLastElement();
+  inline void removeAllElements();
 
   // should be private
-  
-  void** data;
+
+  T** data;
   int current_capacity;
   int current_size;
-  
-  void checkCapacity();
+
+  inline void checkCapacity();
 };
 
+template <class T>
+TSCvector<T>::TSCvector()
+{
+  current_size = 0;
+  current_capacity = 1000;
+  data = (T**) malloc(sizeof(T*)*1000);
+}
+
+template <class T>
+TSCvector<T>::~TSCvector()
+{
+  free(data);
+}
+
+template <class T>
+inline int TSCvector<T>::isEmpty() const
+{
+  if (current_size == 0)
+  {
+    return 1;
+  }
+  else
+  {
+    return 0;
+  }
+}
+
+template <class T>
+int TSCvector<T>::isElement(const T* e) const
+{
+  for (int i = 0; i < current_size; i++)
+  {
+    if (data[i] == e)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+template <class T>
+void TSCvector<T>::ensureCapacity(int c)
+{
+  if (current_capacity < c)
+  {
+    T** temp = (T**) malloc(sizeof(T*)*c);
+    for (int i = 0; i < current_size; i++)
+    {
+      temp[i] = data[i];
+    }
+    current_capacity = c;
+    free(data);
+    data = temp;
+  }
+}
+
+template <class T>
+inline int TSCvector<T>::size() const
+{
+  return current_size;
+}
+
+template <class T>
+inline void TSCvector<T>::setSize(int s)
+{
+  ensureCapacity(s);
+  current_size = s;
+}
+
+template <class T>
+inline T* TSCvector<T>::elementAt(int p) const
+{
+  if ((p < 0) || (p >= current_size))
+  {
+    return 0;
+  }
+  else
+  {
+    return data[p];
+  }
+}
+
+template <class T>
+inline T* TSCvector<T>::lastElement() const
+{
+  if (current_size == 0)
+  {
+    return 0;
+  }
+  else
+  {
+    return data[current_size-1];
+  }
+}
+
+template <class T>
+inline void TSCvector<T>::addElement(T* e)
+{
+  checkCapacity();
+  data[current_size] = e;
+  current_size++;
+}
+
+template <class T>
+inline void TSCvector<T>::setElementAt(T* e, int p)
+{
+  if ((p < 0) || (p >= current_size))
+  {
+    fprintf(stderr,"ERROR in TSCvector::setElementAt\n");
+  }
+  else
+  {
+    data[p] = e;
+  }
+}
+
+template <class T>
+void TSCvector<T>::insertElementAt(T* e, int p)
+{
+  if ((p < 0) || (p > current_size))
+  {
+    fprintf(stderr,"ERROR in TSCvector::insertElementAt\n");
+  }
+  else
+  {
+    checkCapacity();
+    for (int i = current_size; i > p; i--)
+    {
+      data[i] = data[i-1];
+    }
+    data[p] = e;
+    current_size++;
+  }
+}
+
+template <class T>
+void TSCvector<T>::removeElement(const T* e)
+{
+  int i, p = -1;
+  for (i = current_size-1; i >= 0; i--)
+  {
+    if (e == data[i])
+    {
+      p = i;
+      break;
+    }
+  }
+
+  if (p == -1)
+  {
+    return;
+  }
+
+  for (i = p; i < current_size-1; i++)
+  {
+    data[i] = data[i+1];
+  }
+  current_size--;
+}
+
+template <class T>
+void TSCvector<T>::removeElementAt(int p)
+{
+  if ((p < 0) || (p >= current_size))
+  {
+    return;
+  }
+
+  for (int i = p; i < current_size-1; i++)
+  {
+    data[i] = data[i+1];
+  }
+  current_size--;
+}
+
+template <class T>
+inline void TSCvector<T>::removeLastElement()
+{
+  if (current_size > 0)
+  {
+    current_size--;
+  }
+}
+
+template <class T>
+inline void TSCvector<T>::removeAllElements()
+{
+  current_size = 0;
+}
+
+template <class T>
+inline void TSCvector<T>::checkCapacity()
+{
+  if (current_capacity == current_size)
+  {
+    ensureCapacity(current_capacity*2);
+  }
+}
+
 #endif